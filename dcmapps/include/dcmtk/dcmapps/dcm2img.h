@@ -722,12 +722,15 @@ int main(int argc, char *argv[])
     DiTIFFCompression   opt_tiffCompression = E_tiffLZWCompression;
     DiTIFFLZWPredictor  opt_lzwPredictor = E_tiffLZWPredictorDefault;
     OFCmdUnsignedInt    opt_rowsPerStrip = 0;
+    OFCmdUnsignedInt    opt_tiffCompressionLevel = 0;     /* default: TIFF library default */
 #endif
 
 #ifdef WITH_LIBPNG
     // PNG parameters
     DiPNGInterlace      opt_interlace = E_pngInterlaceAdam7;
     DiPNGMetainfo       opt_metainfo  = E_pngFileMetainfo;
+    OFCmdSignedInt      opt_pngCompressionLevel = -1;     /* default: zlib default */
+    DiPNGFilter         opt_pngFilter = E_pngFilterDefault;
 #endif
 
     // JPEG parameters
@@ -757,6 +760,11 @@ int main(int argc, char *argv[])
 #endif /* WITH_OPENJPEG */
 #endif /* BUILD_DCM2IMG_AS_DCM2KIMG */
 
+#ifdef WITH_THREADS
+    // multi-threading parameters
+    OFCmdUnsignedInt opt_renderThreads = 1;
+#endif
+
     // other parameters
     int                 opt_Overlay[16];
     int                 opt_O_used = 0;                   /* flag for +O parameter */
@@ -825,7 +833,7 @@ int main(int argc, char *argv[])
       cmd.addOption("--recognize-aspect",   "+a",      "recognize pixel aspect ratio when scaling (def.)");
       cmd.addOption("--ignore-aspect",      "-a",      "ignore pixel aspect ratio when scaling");
       cmd.addOption("--interpolate",        "+i",   1, "[n]umber of algorithm: integer",
-                                                       "use interpolation when scaling (1..4, def: 1)");
+                                                       "use interpolation when scaling (1..7, def: 1)");
       cmd.addOption("--no-interpolation",   "-i",      "no interpolation when scaling");
       cmd.addOption("--no-scaling",         "-S",      "no scaling, ignore pixel aspect ratio (default)");
       cmd.addOption("--scale-x-factor",     "+Sxf", 1, "[f]actor: float",
@@ -918,9 +926,12 @@ int main(int argc, char *argv[])
       cmd.addOption("--compr-lzw",          "+Tl",     "LZW compression (default)");
       cmd.addOption("--compr-rle",          "+Tr",     "RLE compression");
       cmd.addOption("--compr-none",         "+Tn",     "uncompressed");
-      cmd.addOption("--predictor-default",  "+Pd",     "no LZW predictor (default)");
-      cmd.addOption("--predictor-none",     "+Pn",     "LZW predictor 1 (no prediction)");
-      cmd.addOption("--predictor-horz",     "+Ph",     "LZW predictor 2 (horizontal differencing)");
+      cmd.addOption("--compr-deflate",      "+Td",     "deflate (zlib) compression");
+      cmd.addOption("--compression-level",  "+Tc",  1, "[l]evel: integer (1..9, default: 0)",
+                                                       "deflate compression level,\ndefault: TIFF library default");
+      cmd.addOption("--predictor-default",  "+Pd",     "no LZW/deflate predictor (default)");
+      cmd.addOption("--predictor-none",     "+Pn",     "LZW/deflate predictor 1 (no prediction)");
+      cmd.addOption("--predictor-horz",     "+Ph",     "LZW/deflate predictor 2 (horizontal\ndifferencing)");
       cmd.addOption("--rows-per-strip",     "+Rs",  1, "[r]ows: integer (default: 0)",
                                                        "rows per strip, default 8K per strip");
 #endif
@@ -931,6 +942,10 @@ int main(int argc, char *argv[])
       cmd.addOption("--nointerlace",        "-il",     "create non-interlaced file");
       cmd.addOption("--meta-file",          "+mf",     "create PNG file meta information (default)");
       cmd.addOption("--meta-none",          "-mf",     "no PNG file meta information");
+      cmd.addOption("--png-compression-level", "+pl", 1, "[l]evel: integer (0..9, default: -1)",
+                                                       "zlib compression level (0 = no compression,\n1 = best speed, 9 = best compression),\ndefault: zlib default");
+      cmd.addOption("--png-filter",         "+pf",  1, "[f]ilter: none/sub/up/average/paeth/adaptive",
+                                                       "row filter applied before compression,\ndefault: PNG library default");
 #endif
 
      cmd.addSubGroup("JPEG format:");
@@ -979,6 +994,11 @@ int main(int argc, char *argv[])
       cmd.addOption("--change-polarity",    "+P",      "change polarity (invert pixel output)");
       cmd.addOption("--clip-region",        "+C",   4, "[l]eft [t]op [w]idth [h]eight: integer",
                                                        "clip image region (l, t, w, h)");
+#ifdef WITH_THREADS
+     cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--render-threads",     "+rt",  1, "[t]hreads: integer (default: 1)",
+                                                       "use up to t threads for processing large images\nand for writing multiple PNG/TIFF frames");
+#endif
 
     cmd.addGroup("output options:");
      cmd.addSubGroup("general:");
@@ -1131,6 +1151,13 @@ int main(int argc, char *argv[])
             opt_useClip = 1;
         }
 
+#ifdef WITH_THREADS
+        /* image processing options: multi-threading */
+
+        if (cmd.findOption("--render-threads"))
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_renderThreads, 1, 1024));
+#endif
+
         /* image processing options: rotation */
 
         cmd.beginOptionBlock();
@@ -1164,7 +1191,7 @@ int main(int argc, char *argv[])
 
         cmd.beginOptionBlock();
         if (cmd.findOption("--interpolate"))
-            app.checkValue(cmd.getValueAndCheckMinMax(opt_useInterpolation, 1, 4));
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_useInterpolation, 1, 7));
         if (cmd.findOption("--no-interpolation"))
             opt_useInterpolation = 0;
         cmd.endOptionBlock();
@@ -1373,8 +1400,15 @@ int main(int argc, char *argv[])
         if (cmd.findOption("--compr-lzw")) opt_tiffCompression = E_tiffLZWCompression;
         if (cmd.findOption("--compr-rle")) opt_tiffCompression = E_tiffPackBitsCompression;
         if (cmd.findOption("--compr-none")) opt_tiffCompression = E_tiffNoCompression;
+        if (cmd.findOption("--compr-deflate")) opt_tiffCompression = E_tiffDeflateCompression;
         cmd.endOptionBlock();
 
+        if (cmd.findOption("--compression-level"))
+        {
+            app.checkDependence("--compression-level", "--compr-deflate", opt_tiffCompression == E_tiffDeflateCompression);
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_tiffCompressionLevel, 1, 9));
+        }
+
         cmd.beginOptionBlock();
         if (cmd.findOption("--predictor-default")) opt_lzwPredictor = E_tiffLZWPredictorDefault;
         if (cmd.findOption("--predictor-none")) opt_lzwPredictor = E_tiffLZWPredictorNoPrediction;
@@ -1397,6 +1431,28 @@ int main(int argc, char *argv[])
         if (cmd.findOption("--meta-none"))    opt_metainfo = E_pngNoMetainfo;
         if (cmd.findOption("--meta-file"))    opt_metainfo = E_pngFileMetainfo;
         cmd.endOptionBlock();
+
+        if (cmd.findOption("--png-compression-level"))
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_pngCompressionLevel, 0, 9));
+        if (cmd.findOption("--png-filter"))
+        {
+            OFString str;
+            app.checkValue(cmd.getValue(str));
+            if (str == "none")
+                opt_pngFilter = E_pngFilterNone;
+            else if (str == "sub")
+                opt_pngFilter = E_pngFilterSub;
+            else if (str == "up")
+                opt_pngFilter = E_pngFilterUp;
+            else if (str == "average")
+                opt_pngFilter = E_pngFilterAverage;
+            else if (str == "paeth")
+                opt_pngFilter = E_pngFilterPaeth;
+            else if (str == "adaptive")
+                opt_pngFilter = E_pngFilterAdaptive;
+            else
+                app.printError("known --png-filter types are none, sub, up, average, paeth or adaptive");
+        }
 #endif
 
         /* image processing options: JPEG options */
@@ -1668,6 +1724,11 @@ int main(int argc, char *argv[])
 #endif /* WITH_OPENJPEG */
 #endif /* BUILD_DCM2IMG_AS_DCM2KIMG */
 
+#ifdef WITH_THREADS
+    // process the pixel data of large images in parallel
+    DicomImageClass::setNumberOfThreads(opt_renderThreads);
+#endif
+
     DcmDataset *dataset = NULL;
     DicomImage *di = NULL;
     DiDisplayFunction *disp = NULL;
@@ -1838,6 +1899,58 @@ int main(int argc, char *argv[])
                 << fcount << " frames");
         }
 
+        /* initialize plugins for PNG and TIFF output */
+#ifdef WITH_LIBTIFF
+        DiTIFFPlugin tiffPlugin;
+        tiffPlugin.setCompressionType(opt_tiffCompression);
+        tiffPlugin.setLZWPredictor(opt_lzwPredictor);
+        tiffPlugin.setRowsPerStrip(OFstatic_cast(unsigned long, opt_rowsPerStrip));
+        tiffPlugin.setCompressionLevel(OFstatic_cast(int, opt_tiffCompressionLevel));
+#endif
+#ifdef WITH_LIBPNG
+        DiPNGPlugin pngPlugin;
+        pngPlugin.setInterlaceType(opt_interlace);
+        pngPlugin.setMetainfoType(opt_metainfo);
+        pngPlugin.setCompressionLevel(OFstatic_cast(int, opt_pngCompressionLevel));
+        pngPlugin.setFilterType(opt_pngFilter);
+        if (opt_fileType == EFT_16bitPNG)
+            pngPlugin.setBitsPerSample(16);
+#endif
+
+#ifdef WITH_THREADS
+        /* render multiple frames in the calling thread and encode them in parallel */
+        const DiPluginFormat *framesPlugin = NULL;
+#ifdef WITH_LIBTIFF
+        if (opt_fileType == EFT_TIFF)
+            framesPlugin = &tiffPlugin;
+#endif
+#ifdef WITH_LIBPNG
+        if ((opt_fileType == EFT_PNG) || (opt_fileType == EFT_16bitPNG))
+            framesPlugin = &pngPlugin;
+#endif
+        if ((framesPlugin != NULL) && opt_ofname && opt_multiFrame && (opt_renderThreads > 1) && (fcount > 1))
+        {
+            /* generate output filename pattern, '%' in the given filename has to be escaped */
+            OFString pattern;
+            for (const char *c = opt_ofname; *c != '\0'; ++c)
+            {
+                if (*c == '%') pattern += '%';
+                pattern += *c;
+            }
+            pattern += (opt_useFrameNumber) ? ".f%lu." : ".%lu.";
+            pattern += ofext;
+            OFLOG_INFO(dcm2imgLogger, "writing frames " << opt_frame << "-" << (opt_frame + fcount - 1) << " to "
+                << opt_ofname << ((opt_useFrameNumber) ? ".f*." : ".*.") << ofext << " using " << opt_renderThreads << " threads");
+            if (!di->writePluginFormat(framesPlugin, pattern.c_str(), 0, fcount, (opt_useFrameNumber) ? opt_frame : 0))
+            {
+                OFLOG_FATAL(dcm2imgLogger, "cannot write frames");
+                exitCode = 1;
+                goto cleanup;
+            }
+            fcount = 0;
+        }
+#endif
+
         for (unsigned int frame = 0; frame < fcount; frame++)
         {
             if (opt_ofname)
@@ -1970,11 +2083,6 @@ int main(int argc, char *argv[])
                 case EFT_TIFF:
                     {
                         OFLOG_INFO(dcm2imgLogger, (di->isMonochrome() ? "writing 8-bit monochrome TIFF" : "writing 24-bit color TIFF"));
-                        /* initialize TIFF plugin */
-                        DiTIFFPlugin tiffPlugin;
-                        tiffPlugin.setCompressionType(opt_tiffCompression);
-                        tiffPlugin.setLZWPredictor(opt_lzwPredictor);
-                        tiffPlugin.setRowsPerStrip(OFstatic_cast(unsigned long, opt_rowsPerStrip));
                         result = di->writePluginFormat(&tiffPlugin, ofile, frame);
                     }
                     break;
@@ -1985,12 +2093,6 @@ int main(int argc, char *argv[])
                     {
                         if (opt_fileType == EFT_PNG) OFLOG_INFO(dcm2imgLogger, (di->isMonochrome() ? "writing 8-bit monochrome PNG" : "writing 24-bit color PNG"));
                             else OFLOG_INFO(dcm2imgLogger, (di->isMonochrome() ? "writing 16-bit monochrome PNG" : "writing 48-bit color PNG"));
-                        /* initialize PNG plugin */
-                        DiPNGPlugin pngPlugin;
-                        pngPlugin.setInterlaceType(opt_interlace);
-                        pngPlugin.setMetainfoType(opt_metainfo);
-                        if (opt_fileType == EFT_16bitPNG)
-                            pngPlugin.setBitsPerSample(16);
                         result = di->writePluginFormat(&pngPlugin, ofile, frame);
                     }
                     break;
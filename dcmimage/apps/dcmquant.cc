@@ -84,7 +84,7 @@ int main(int argc, char *argv[])
 
     OFBool              opt_palette_ow = OFTrue;
     OFBool              opt_entries_word = OFFalse;
-    OFBool              opt_palette_fs = OFFalse;
+    DcmDitheringType    opt_dithering = DcmDitheringType_none;
     OFCmdUnsignedInt    opt_palette_col = 256;
 
     DcmLargestDimensionType opt_largeType = DcmLargestDimensionType_default;
@@ -93,6 +93,10 @@ int main(int argc, char *argv[])
     OFBool              opt_secondarycapture = OFFalse;
     OFBool              opt_uidcreation = OFTrue;
 
+#ifdef WITH_THREADS
+    OFCmdUnsignedInt    opt_threads = 1;                  /* default: single-threaded */
+#endif
+
 #ifdef BUILD_WITH_DCMJPEG_SUPPORT
     // JPEG parameters, currently not used
 # if 0
@@ -166,9 +170,16 @@ int main(int argc, char *argv[])
      cmd.addSubGroup("color palette creation:");
       cmd.addOption("--lut-entries-word",    "+pe",    "write Palette LUT with 16-bit entries");
       cmd.addOption("--floyd-steinberg",     "+pf",    "use Floyd-Steinberg error diffusion");
+      cmd.addOption("--ordered-dither",      "+po",    "use ordered dithering (8x8 Bayer matrix)");
       cmd.addOption("--colors",              "+pc", 1, "number of colors: 2..65536 (default 256)",
                                                        "number of colors to quantize to");
 
+#ifdef WITH_THREADS
+     cmd.addSubGroup("multi-threading:");
+      cmd.addOption("--threads",             "+th", 1, "[t]hreads: integer (default: 1)",
+                                                       "use up to t threads for processing large images\n(mapping with Floyd-Steinberg is single-threaded)");
+#endif
+
      cmd.addSubGroup("SOP Class UID:");
       cmd.addOption("--class-default",       "+cd",    "keep SOP Class UID (default)");
       cmd.addOption("--class-sc",            "+cs",    "convert to Secondary Capture Image\n(implies --uid-always)");
@@ -300,7 +311,10 @@ int main(int argc, char *argv[])
       cmd.endOptionBlock();
 
       if (cmd.findOption("--lut-entries-word")) opt_entries_word = OFTrue;
-      if (cmd.findOption("--floyd-steinberg")) opt_palette_fs = OFTrue;
+      cmd.beginOptionBlock();
+      if (cmd.findOption("--floyd-steinberg")) opt_dithering = DcmDitheringType_floydSteinberg;
+      if (cmd.findOption("--ordered-dither")) opt_dithering = DcmDitheringType_ordered;
+      cmd.endOptionBlock();
       if (cmd.findOption("--colors")) cmd.getValueAndCheckMinMax(opt_palette_col, 2, 65536);
 
       cmd.beginOptionBlock();
@@ -314,6 +328,11 @@ int main(int argc, char *argv[])
       if (cmd.findOption("--mc-color-center")) opt_repType = DcmRepresentativeColorType_centerOfBox;
       cmd.endOptionBlock();
 
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+          app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 1024));
+#endif
+
       cmd.beginOptionBlock();
       if (cmd.findOption("--class-default")) opt_secondarycapture = OFFalse;
       if (cmd.findOption("--class-sc")) opt_secondarycapture = OFTrue;
@@ -435,6 +454,11 @@ int main(int argc, char *argv[])
 
     OFLOG_INFO(dcmquantLogger, "preparing pixel data.");
 
+#ifdef WITH_THREADS
+    // process the pixel data of large images in parallel
+    DicomImageClass::setNumberOfThreads(opt_threads);
+#endif
+
     // create DicomImage object
     DicomImage di(dataset, opt_oxfer, opt_compatibilityMode, opt_frame - 1, opt_frameCount);
     if (di.getStatus() != EIS_Normal)
@@ -453,7 +477,7 @@ int main(int argc, char *argv[])
 
     // create palette color image
     error = DcmQuant::createPaletteColorImage(
-      di, *dataset, opt_palette_ow, opt_entries_word, opt_palette_fs, opt_palette_col,
+      di, *dataset, opt_palette_ow, opt_entries_word, opt_dithering, opt_palette_col,
       derivationDescription, opt_largeType, opt_repType);
 
     // update image type
@@ -28,6 +28,7 @@
 #include "dcmtk/dcmimage/dicoopx.h"
 #include "dcmtk/dcmimage/dicopx.h"
 #include "dcmtk/dcmimgle/dipxrept.h"
+#include "dcmtk/dcmimgle/dithread.h"
 
 #include "dcmtk/ofstd/ofbmanip.h"
 
@@ -36,6 +37,262 @@
  *  class declaration  *
  *---------------------*/
 
+/** Template class to convert a band of color pixels to output format
+ */
+template<class T1, class T2>
+class DiColorOutputLoopTemplate
+  : public DiThreadedLoop
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  pixel      pointer to intermediate pixel representation (color)
+     *  @param  start      offset to first pixel to be converted
+     *  @param  data       pointer to the output data
+     *  @param  frameSize  number of pixels per frame (of the output data)
+     *  @param  bits1      bit depth of input data (intermediate)
+     *  @param  bits2      bit depth of output data
+     *  @param  planar     flag indicating whether data shall be stored color-by-pixel or color-by-plane
+     *  @param  inverse    invert pixel data if true (0/0/0 = white)
+     */
+    DiColorOutputLoopTemplate(const T1 **pixel,
+                              const unsigned long start,
+                              T2 *data,
+                              const unsigned long frameSize,
+                              const int bits1,
+                              const int bits2,
+                              const int planar,
+                              const int inverse)
+      : DiThreadedLoop(),
+        Pixel(pixel),
+        Start(start),
+        Data(data),
+        FrameSize(frameSize),
+        Bits1(bits1),
+        Bits2(bits2),
+        Planar(planar),
+        Inverse(inverse)
+    {
+    }
+
+    /** destructor
+     */
+    virtual ~DiColorOutputLoopTemplate()
+    {
+    }
+
+    /** convert a band of pixels to output format
+     *
+     ** @param  first  index of the first pixel of the band (relative to 'start')
+     *  @param  count  number of pixels of the band
+     */
+    virtual void processBand(const unsigned long first,
+                             const unsigned long count)
+    {
+        const T1 **pixel = Pixel;
+        const unsigned long start = Start + first;
+        const int bits1 = Bits1;
+        const int bits2 = Bits2;
+        const int planar = Planar;
+        const int inverse = Inverse;
+        T2 *q = Data + 3 * first;                                       // first pixel of the band (color-by-pixel)
+        unsigned long i;
+        const T2 max2 = OFstatic_cast(T2, DicomImageClass::maxval(bits2));
+        if (planar)
+        {
+            const T1 *p;
+            if (bits1 == bits2)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    p = pixel[j] + start;
+                    q = Data + j * FrameSize + first;
+                    /* invert output data */
+                    if (inverse)
+                    {
+                        for (i = count; i != 0; --i)                        // copy inverted data
+                            *(q++) = max2 - OFstatic_cast(T2, *(p++));
+                    } else {
+                        for (i = count; i != 0; --i)                        // copy
+                            *(q++) = OFstatic_cast(T2, *(p++));
+                    }
+                }
+            }
+            else if (bits1 < bits2)                                     // optimization possible using LUT
+            {
+                const double gradient1 = OFstatic_cast(double, DicomImageClass::maxval(bits2)) /
+                                         OFstatic_cast(double, DicomImageClass::maxval(bits1));
+                const T2 gradient2 = OFstatic_cast(T2, gradient1);
+                for (int j = 0; j < 3; ++j)
+                {
+                    p = pixel[j] + start;
+                    q = Data + j * FrameSize + first;
+                    if (gradient1 == OFstatic_cast(double, gradient2))  // integer multiplication?
+                    {
+                        /* invert output data */
+                        if (inverse)
+                        {
+                            for (i = count; i != 0; --i)                            // expand depth & invert
+                                *(q++) = max2 - OFstatic_cast(T2, *(p++)) * gradient2;
+                        } else {
+                            for (i = count; i != 0; --i)                            // expand depth
+                                *(q++) = OFstatic_cast(T2, *(p++)) * gradient2;
+                        }
+                    } else {
+                        /* invert output data */
+                        if (inverse)
+                        {
+                            for (i = count; i != 0; --i)                            // expand depth & invert
+                                *(q++) = max2 - OFstatic_cast(T2, OFstatic_cast(double, *(p++)) * gradient1);
+                        } else {
+                            for (i = count; i != 0; --i)                            // expand depth
+                                *(q++) = OFstatic_cast(T2, OFstatic_cast(double, *(p++)) * gradient1);
+                        }
+                    }
+                }                                                       // ... to be enhanced !
+            }
+            else /* bits1 > bits2 */
+            {
+                const int shift = bits1 - bits2;
+                for (int j = 0; j < 3; ++j)
+                {
+                    p = pixel[j] + start;
+                    q = Data + j * FrameSize + first;
+                    /* invert output data */
+                    if (inverse)
+                    {
+                        for (i = count; i != 0; --i)                            // reduce depth & invert
+                            *(q++) = max2 - OFstatic_cast(T2, *(p++) >> shift);
+                    } else {
+                        for (i = count; i != 0; --i)                            // reduce depth
+                            *(q++) = OFstatic_cast(T2, *(p++) >> shift);
+                    }
+                }
+            }
+        }
+        else /* not planar */
+        {
+            /* use local pointers, the output might alias the plane pointers (at least in the eyes of the compiler) */
+            const T1 *r = pixel[0] + start;
+            const T1 *g = pixel[1] + start;
+            const T1 *b = pixel[2] + start;
+            if (bits1 == bits2)
+            {
+                /* invert output data */
+                if (inverse)
+                {
+                    for (i = 0; i < count; ++i, q += 3)                 // copy inverted data
+                    {
+                        q[0] = max2 - OFstatic_cast(T2, r[i]);
+                        q[1] = max2 - OFstatic_cast(T2, g[i]);
+                        q[2] = max2 - OFstatic_cast(T2, b[i]);
+                    }
+                } else {
+                    for (i = 0; i < count; ++i, q += 3)                 // copy
+                    {
+                        q[0] = OFstatic_cast(T2, r[i]);
+                        q[1] = OFstatic_cast(T2, g[i]);
+                        q[2] = OFstatic_cast(T2, b[i]);
+                    }
+                }
+            }
+            else if (bits1 < bits2)                                     // optimization possible using LUT
+            {
+                const double gradient1 = OFstatic_cast(double, DicomImageClass::maxval(bits2)) /
+                                         OFstatic_cast(double, DicomImageClass::maxval(bits1));
+                const T2 gradient2 = OFstatic_cast(T2, gradient1);
+                if (gradient1 == OFstatic_cast(double, gradient2))      // integer multiplication?
+                {
+                    /* invert output data */
+                    if (inverse)
+                    {
+                        for (i = 0; i < count; ++i, q += 3)                     // expand depth & invert
+                        {
+                            q[0] = max2 - OFstatic_cast(T2, r[i]) * gradient2;
+                            q[1] = max2 - OFstatic_cast(T2, g[i]) * gradient2;
+                            q[2] = max2 - OFstatic_cast(T2, b[i]) * gradient2;
+                        }
+                    } else {
+                        for (i = 0; i < count; ++i, q += 3)                     // expand depth
+                        {
+                            q[0] = OFstatic_cast(T2, r[i]) * gradient2;
+                            q[1] = OFstatic_cast(T2, g[i]) * gradient2;
+                            q[2] = OFstatic_cast(T2, b[i]) * gradient2;
+                        }
+                    }
+                } else {
+                    /* invert output data */
+                    if (inverse)
+                    {
+                        for (i = 0; i < count; ++i, q += 3)                     // expand depth & invert
+                        {
+                            q[0] = max2 - OFstatic_cast(T2, OFstatic_cast(double, r[i]) * gradient1);
+                            q[1] = max2 - OFstatic_cast(T2, OFstatic_cast(double, g[i]) * gradient1);
+                            q[2] = max2 - OFstatic_cast(T2, OFstatic_cast(double, b[i]) * gradient1);
+                        }
+                    } else {
+                        for (i = 0; i < count; ++i, q += 3)                     // expand depth
+                        {
+                            q[0] = OFstatic_cast(T2, OFstatic_cast(double, r[i]) * gradient1);
+                            q[1] = OFstatic_cast(T2, OFstatic_cast(double, g[i]) * gradient1);
+                            q[2] = OFstatic_cast(T2, OFstatic_cast(double, b[i]) * gradient1);
+                        }
+                    }
+                }
+            }
+            else /* bits1 > bits2 */
+            {
+                const int shift = bits1 - bits2;
+                /* invert output data */
+                if (inverse)
+                {
+                    for (i = 0; i < count; ++i, q += 3)                         // reduce depth & invert
+                    {
+                        q[0] = max2 - OFstatic_cast(T2, r[i] >> shift);
+                        q[1] = max2 - OFstatic_cast(T2, g[i] >> shift);
+                        q[2] = max2 - OFstatic_cast(T2, b[i] >> shift);
+                    }
+                } else {
+                    for (i = 0; i < count; ++i, q += 3)                         // reduce depth
+                    {
+                        q[0] = OFstatic_cast(T2, r[i] >> shift);
+                        q[1] = OFstatic_cast(T2, g[i] >> shift);
+                        q[2] = OFstatic_cast(T2, b[i] >> shift);
+                    }
+                }
+            }
+        }
+    }
+
+
+ private:
+
+    /// pointer to intermediate pixel representation (color)
+    const T1 **Pixel;
+    /// offset to first pixel to be converted
+    const unsigned long Start;
+    /// pointer to the output data
+    T2 *Data;
+    /// number of pixels per frame (of the output data)
+    const unsigned long FrameSize;
+    /// bit depth of input data (intermediate)
+    const int Bits1;
+    /// bit depth of output data
+    const int Bits2;
+    /// flag indicating whether data shall be stored color-by-pixel or color-by-plane
+    const int Planar;
+    /// invert pixel data if true
+    const int Inverse;
+
+ // --- declarations to avoid compiler warnings
+
+    DiColorOutputLoopTemplate(const DiColorOutputLoopTemplate<T1,T2> &);
+    DiColorOutputLoopTemplate<T1,T2> &operator=(const DiColorOutputLoopTemplate<T1,T2> &);
+};
+
+
 /** Template class to create color output data
  */
 template<class T1, class T2>
@@ -243,159 +500,15 @@ class DiColorOutputPixelTemplate
             if (Data != NULL)
             {
                 DCMIMAGE_DEBUG("converting color pixel data to output format");
-                T2 *q = Data;
-                unsigned long i;
-                const T2 max2 = OFstatic_cast(T2, DicomImageClass::maxval(bits2));
-                if (planar)
+                DiColorOutputLoopTemplate<T1, T2>(pixel, start, Data, FrameSize, bits1, bits2, planar, inverse).process(Count);
+                if (Count < FrameSize)
                 {
-                    const T1 *p;
-                    if (bits1 == bits2)
-                    {
-                        for (int j = 0; j < 3; ++j)
-                        {
-                            p = pixel[j] + start;
-                            /* invert output data */
-                            if (inverse)
-                            {
-                                for (i = Count; i != 0; --i)                        // copy inverted data
-                                    *(q++) = max2 - OFstatic_cast(T2, *(p++));
-                            } else {
-                                for (i = Count; i != 0; --i)                        // copy
-                                    *(q++) = OFstatic_cast(T2, *(p++));
-                            }
-                            if (Count < FrameSize)
-                            {
-                                OFBitmanipTemplate<T2>::zeroMem(q, FrameSize - Count);  // set remaining pixels of frame to zero
-                                q += (FrameSize - Count);
-                            }
-                        }
-                    }
-                    else if (bits1 < bits2)                                     // optimization possible using LUT
-                    {
-                        const double gradient1 = OFstatic_cast(double, DicomImageClass::maxval(bits2)) /
-                                                 OFstatic_cast(double, DicomImageClass::maxval(bits1));
-                        const T2 gradient2 = OFstatic_cast(T2, gradient1);
-                        for (int j = 0; j < 3; ++j)
-                        {
-                            p = pixel[j] + start;
-                            if (gradient1 == OFstatic_cast(double, gradient2))  // integer multiplication?
-                            {
-                                /* invert output data */
-                                if (inverse)
-                                {
-                                    for (i = Count; i != 0; --i)                            // expand depth & invert
-                                        *(q++) = max2 - OFstatic_cast(T2, *(p++)) * gradient2;
-                                } else {
-                                    for (i = Count; i != 0; --i)                            // expand depth
-                                        *(q++) = OFstatic_cast(T2, *(p++)) * gradient2;
-                                }
-                            } else {
-                                /* invert output data */
-                                if (inverse)
-                                {
-                                    for (i = Count; i != 0; --i)                            // expand depth & invert
-                                        *(q++) = max2 - OFstatic_cast(T2, OFstatic_cast(double, *(p++)) * gradient1);
-                                } else {
-                                    for (i = Count; i != 0; --i)                            // expand depth
-                                        *(q++) = OFstatic_cast(T2, OFstatic_cast(double, *(p++)) * gradient1);
-                                }
-                            }
-                            if (Count < FrameSize)
-                            {
-                                OFBitmanipTemplate<T2>::zeroMem(q, FrameSize - Count);  // set remaining pixels of frame to zero
-                                q += (FrameSize - Count);
-                            }
-                        }                                                       // ... to be enhanced !
-                    }
-                    else /* bits1 > bits2 */
+                    if (planar)
                     {
-                        const int shift = bits1 - bits2;
                         for (int j = 0; j < 3; ++j)
-                        {
-                            p = pixel[j] + start;
-                            /* invert output data */
-                            if (inverse)
-                            {
-                                for (i = Count; i != 0; --i)                            // reduce depth & invert
-                                    *(q++) = max2 - OFstatic_cast(T2, *(p++) >> shift);
-                            } else {
-                                for (i = Count; i != 0; --i)                            // reduce depth
-                                    *(q++) = OFstatic_cast(T2, *(p++) >> shift);
-                            }
-                            if (Count < FrameSize)
-                            {
-                                OFBitmanipTemplate<T2>::zeroMem(q, FrameSize - Count);  // set remaining pixels of frame to zero
-                                q += (FrameSize - Count);
-                            }
-                        }
-                    }
-                }
-                else /* not planar */
-                {
-                    int j;
-                    if (bits1 == bits2)
-                    {
-                        /* invert output data */
-                        if (inverse)
-                        {
-                            for (i = start; i < start + Count; ++i)
-                                for (j = 0; j < 3; ++j)                         // copy inverted data
-                                    *(q++) = max2 - OFstatic_cast(T2, pixel[j][i]);
-                        } else {
-                            for (i = start; i < start + Count; ++i)
-                                for (j = 0; j < 3; ++j)                         // copy
-                                    *(q++) = OFstatic_cast(T2, pixel[j][i]);
-                        }
-                    }
-                    else if (bits1 < bits2)                                     // optimization possible using LUT
-                    {
-                        const double gradient1 = OFstatic_cast(double, DicomImageClass::maxval(bits2)) /
-                                                 OFstatic_cast(double, DicomImageClass::maxval(bits1));
-                        const T2 gradient2 = OFstatic_cast(T2, gradient1);
-                        if (gradient1 == OFstatic_cast(double, gradient2))      // integer multiplication?
-                        {
-                            /* invert output data */
-                            if (inverse)
-                            {
-                                for (i = start; i < start + Count; ++i)                 // expand depth & invert
-                                    for (j = 0; j < 3; ++j)
-                                        *(q++) = max2 - OFstatic_cast(T2, pixel[j][i]) * gradient2;
-                            } else {
-                                for (i = start; i < start + Count; ++i)
-                                    for (j = 0; j < 3; ++j)                             // expand depth
-                                        *(q++) = OFstatic_cast(T2, pixel[j][i]) * gradient2;
-                            }
-                        } else {
-                            /* invert output data */
-                            if (inverse)
-                            {
-                                for (i = start; i < start + Count; ++i)
-                                    for (j = 0; j < 3; ++j)                             // expand depth & invert
-                                        *(q++) = max2 - OFstatic_cast(T2, OFstatic_cast(double, pixel[j][i]) * gradient1);
-                            } else {
-                                for (i = start; i < start + Count; ++i)
-                                    for (j = 0; j < 3; ++j)                             // expand depth
-                                        *(q++) = OFstatic_cast(T2, OFstatic_cast(double, pixel[j][i]) * gradient1);
-                            }
-                        }
-                    }
-                    else /* bits1 > bits2 */
-                    {
-                        const int shift = bits1 - bits2;
-                        /* invert output data */
-                        if (inverse)
-                        {
-                            for (i = start; i < start + Count; ++i)
-                                for (j = 0; j < 3; ++j)                                 // reduce depth & invert
-                                    *(q++) = max2 - OFstatic_cast(T2, pixel[j][i] >> shift);
-                        } else {
-                            for (i = start; i < start + Count; ++i)
-                                for (j = 0; j < 3; ++j)                                 // reduce depth
-                                    *(q++) = OFstatic_cast(T2, pixel[j][i] >> shift);
-                        }
-                    }
-                    if (Count < FrameSize)
-                        OFBitmanipTemplate<T2>::zeroMem(q, 3 * (FrameSize - Count));  // set remaining pixels of frame to zero
+                            OFBitmanipTemplate<T2>::zeroMem(Data + j * FrameSize + Count, FrameSize - Count);  // set remaining pixels of frame to zero
+                    } else
+                        OFBitmanipTemplate<T2>::zeroMem(Data + 3 * Count, 3 * (FrameSize - Count));        // set remaining pixels of frame to zero
                 }
             }
         } else
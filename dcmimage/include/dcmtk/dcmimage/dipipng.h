@@ -72,6 +72,34 @@ enum DiPNGMetainfo
   E_pngFileMetainfo
 };
 
+/** describes the row filters used by the PNG plugin before compression.
+ *  @remark this enum is only available if DCMTK is compiled with
+ *  PNG (libpng) support enabled.
+ */
+enum DiPNGFilter
+{
+  /// default filter selection of the PNG library
+  E_pngFilterDefault,
+
+  /// no filter
+  E_pngFilterNone,
+
+  /// sub filter (difference to the left pixel)
+  E_pngFilterSub,
+
+  /// up filter (difference to the pixel above)
+  E_pngFilterUp,
+
+  /// average filter (difference to the mean of the left pixel and the pixel above)
+  E_pngFilterAverage,
+
+  /// Paeth filter (difference to the best predictor of left, above and upper left pixel)
+  E_pngFilterPaeth,
+
+  /// adaptive filtering, i.e. choose the best of the above filters for each row
+  E_pngFilterAdaptive
+};
+
 
 /*---------------------*
  *  class declaration  *
@@ -105,6 +133,17 @@ class DCMTK_DCMIMAGE_EXPORT DiPNGPlugin
                       FILE *stream,
                       const unsigned long frame = 0) const;
 
+    /** encode an already rendered frame and write it to a file stream (PNG format).
+     *  Non-interlaced images are passed to the PNG library row by row.
+     *  @param image pointer to DICOM image object the frame has been rendered from
+     *  @param data pixel data rendered with the bits per sample set by setBitsPerSample()
+     *  @param stream stream to which the image is written (open in binary mode!)
+     *  @return true if successful, false otherwise
+     */
+    virtual int encode(const DiImage *image,
+                       const void *data,
+                       FILE *stream) const;
+
     /** set interlace type for PNG creation
      *  @param inter interlace type
      */
@@ -120,6 +159,17 @@ class DCMTK_DCMIMAGE_EXPORT DiPNGPlugin
      */
     void setBitsPerSample(const int bpp);
 
+    /** set compression level for PNG creation
+     *  @param level zlib compression level (0 = no compression, 1 = best speed,
+     *    9 = best compression, -1 = default of the zlib library)
+     */
+    void setCompressionLevel(const int level);
+
+    /** set row filter type for PNG creation
+     *  @param ftype filter type
+     */
+    void setFilterType(DiPNGFilter ftype);
+
     /** get version information of the PNG library.
      *  Typical output format: "LIBPNG, Version 3.5.7"
      *  @return name and version number of the PNG library
@@ -127,6 +177,14 @@ class DCMTK_DCMIMAGE_EXPORT DiPNGPlugin
     static OFString getLibraryVersionString();
 
 
+ protected:
+
+    /** get number of bits per sample of the pixel data passed to encode()
+     *  @return number of bits per sample (8 or 16)
+     */
+    virtual int getBitsPerSample() const;
+
+
  private:
 
     /// PNG interlace type
@@ -137,6 +195,12 @@ class DCMTK_DCMIMAGE_EXPORT DiPNGPlugin
 
     /// bits per sample (8 or 16, default: 8)
     int bitsPerSample;
+
+    /// zlib compression level (0..9, default: -1 = zlib default)
+    int compressionLevel;
+
+    /// PNG row filter type
+    DiPNGFilter filterType;
 };
 
 #endif
@@ -60,10 +60,13 @@ enum DiTIFFCompression
   E_tiffLZWCompression,
 
   /// uncompressed
-  E_tiffNoCompression
+  E_tiffNoCompression,
+
+  /// deflate compression (zlib)
+  E_tiffDeflateCompression
 };
 
-/** describes the optional predictor used with TIFF LZW compression
+/** describes the optional predictor used with TIFF LZW and deflate compression
  *  @remark this enum is only available if DCMTK is compiled with
  *  TIFF (libtiff) support enabled.
  */
@@ -112,12 +115,23 @@ class DCMTK_DCMIMAGE_EXPORT DiTIFFPlugin
                       FILE *stream,
                       const unsigned long frame = 0) const;
 
+    /** encode an already rendered frame and write it to a file stream (TIFF format).
+     *  The image is written strip by strip.
+     *  @param image pointer to DICOM image object the frame has been rendered from
+     *  @param data pixel data rendered with 8 bits per sample
+     *  @param stream stream to which the image is written (open in binary mode!)
+     *  @return true if successful, false otherwise
+     */
+    virtual int encode(const DiImage *image,
+                       const void *data,
+                       FILE *stream) const;
+
     /** set compression type for TIFF creation
      *  @param ctype compression type
      */
     void setCompressionType(DiTIFFCompression ctype);
 
-    /** set predictor type for LZW compression
+    /** set predictor type for LZW and deflate compression
      *  @param pred predictor type
      */
     void setLZWPredictor(DiTIFFLZWPredictor pred);
@@ -129,6 +143,12 @@ class DCMTK_DCMIMAGE_EXPORT DiTIFFPlugin
      */
     void setRowsPerStrip(unsigned long rows = 0);
 
+    /** set compression level for deflate compression
+     *  @param level zlib compression level (1 = best speed, 9 = best compression,
+     *    0 = default of the TIFF library)
+     */
+    void setCompressionLevel(const int level = 0);
+
     /** get version information of the TIFF library.
      *  Typical output format: "LIBTIFF, Version 3.5.7"
      *  @return name and version number of the TIFF library
@@ -136,6 +156,14 @@ class DCMTK_DCMIMAGE_EXPORT DiTIFFPlugin
     static OFString getLibraryVersionString();
 
 
+ protected:
+
+    /** get number of bits per sample of the pixel data passed to encode()
+     *  @return number of bits per sample (always 8)
+     */
+    virtual int getBitsPerSample() const;
+
+
  private:
 
     /// TIFF compression type
@@ -146,6 +174,9 @@ class DCMTK_DCMIMAGE_EXPORT DiTIFFPlugin
 
     /// TIFF rows per strip
     unsigned long rowsPerStrip;
+
+    /// deflate compression level (1..9, default: 0 = TIFF library default)
+    int compressionLevel;
 };
 
 #endif
@@ -30,6 +30,13 @@
 #include "dcmtk/dcmimage/diqtpix.h"   /* gcc 3.4 needs this */
 #include "dcmtk/dcmimage/diqthash.h"  /* gcc 3.4 needs this */
 #include "dcmtk/dcmimage/diqtctab.h"  /* gcc 3.4 needs this */
+#include "dcmtk/dcmimgle/dithread.h"  /* for DiThreadedLoop */
+
+/** number of bits of the index into the direct-mapped cache that is used
+ *  in front of the color hash table while mapping an image, i.e. the cache
+ *  has 2^DcmQuantColorCacheBits entries.
+ */
+#define DcmQuantColorCacheBits 16
 
 class DicomImage;
 class DcmQuantColorHashTable;
@@ -38,6 +45,177 @@ class DcmQuantPixel;
 class DcmQuantScaleTable;
 
 
+/** helper template class that maps the rows of a color image into a palette
+ *  color image band by band, i.e. in parallel if configured (see
+ *  DicomImageClass::setNumberOfThreads()).  Each band uses its own copy of
+ *  the error diffusion object and its own color hash table.  Therefore, this
+ *  class can only be used with error diffusion classes that process the rows
+ *  independently of each other, i.e. DcmQuantIdent and DcmQuantOrderedDither.
+ *  The template parameters are the same as for class DcmQuantColorMapping.
+ */
+template <class T1, class T2>
+class DcmQuantColorMappingLoop: public DiThreadedLoop
+{
+public:
+
+  /** constructor
+   *  @param data pointer to the color image data (interleaved R, G, B components)
+   *  @param cols number of columns of the image
+   *  @param maxval maximum pixel value to which all color samples are down-sampled
+   *  @param scaletable scale table used for down-sampling the color samples
+   *  @param colormap color LUT to which the color image is mapped.
+   *  @param fs error diffusion object, copied for each band
+   *  @param tp pointer to an array to which the palette color image data is written.
+   */
+  DcmQuantColorMappingLoop(
+    const DcmQuantComponent *data,
+    unsigned long cols,
+    unsigned long maxval,
+    const DcmQuantScaleTable& scaletable,
+    const DcmQuantColorTable& colormap,
+    const T1& fs,
+    T2 *tp)
+  : DiThreadedLoop()
+  , data_(data)
+  , columns_(cols)
+  , maxval_(maxval)
+  , scaletable_(scaletable)
+  , colormap_(colormap)
+  , fs_(fs)
+  , tp_(tp)
+  {
+  }
+
+  /// destructor
+  virtual ~DcmQuantColorMappingLoop()
+  {
+  }
+
+  /** maps a band of rows
+   *  @param first index of the first row of the band
+   *  @param count number of rows of the band
+   */
+  virtual void processBand(const unsigned long first, const unsigned long count)
+  {
+    T1 fs(fs_);
+    fs.setRow(first);
+    DcmQuantColorHashTable cht;
+    mapRows(data_ + first * columns_ * 3, columns_, count, maxval_, scaletable_, cht, colormap_, fs, tp_ + first * columns_);
+  }
+
+  /** maps the given rows of a color image into a palette color image.
+   *  @param cp pointer to the color image data of the first row
+   *  @param cols number of columns of the image
+   *  @param rows number of rows to be mapped
+   *  @param maxval maximum pixel value to which all color samples are down-sampled
+   *  @param scaletable scale table used for down-sampling the color samples
+   *  @param cht color hash table caching the result of the color LUT look-ups
+   *  @param colormap color LUT to which the color image is mapped.
+   *  @param fs error diffusion object
+   *  @param tp pointer to an array to which the palette color image data is written.
+   */
+  static void mapRows(
+    const DcmQuantComponent *cp,
+    unsigned long cols,
+    unsigned long rows,
+    unsigned long maxval,
+    const DcmQuantScaleTable& scaletable,
+    DcmQuantColorHashTable& cht,
+    const DcmQuantColorTable& colormap,
+    T1& fs,
+    T2 *tp)
+  {
+    DcmQuantPixel px;
+    long limitcol;
+    long col; // must be signed!
+    long maxval_l = OFstatic_cast(long, maxval);
+    int ind;
+    const DcmQuantComponent *currentpixel;
+    DcmQuantComponent cr, cg, cb;
+
+    // small direct-mapped cache in front of the hash table, which is rather slow if
+    // the colors are scattered (e.g. because of dithering)
+    const unsigned long cacheSize = 1UL << DcmQuantColorCacheBits;
+    const Uint32 scale = OFstatic_cast(Uint32, maxval) + 1;
+    Uint32 *cacheKey = new Uint32[cacheSize];
+    int *cacheIndex = new int[cacheSize];
+    Uint32 key;
+    unsigned long slot;
+    for (slot = 0; slot < cacheSize; ++slot) cacheKey[slot] = 0xffffffffUL;  // no valid key
+
+    for (unsigned long row = 0; row < rows; ++row)
+    {
+      fs.startRow(col, limitcol);
+      do
+      {
+          currentpixel = cp + col + col + col;
+          cr = *currentpixel++;
+          cg = *currentpixel++;
+          cb = *currentpixel;
+          px.scale(cr, cg, cb, scaletable);
+
+          fs.adjust(px, col, maxval_l);
+
+          key = (OFstatic_cast(Uint32, px.getRed()) * scale + px.getGreen()) * scale + px.getBlue();
+          slot = OFstatic_cast(Uint32, key * 2654435761UL) >> (32 - DcmQuantColorCacheBits);
+          if (cacheKey[slot] == key)
+            ind = cacheIndex[slot];
+          else
+          {
+            // Check hash table to see if we have already matched this color.
+            ind = cht.lookup(px);
+            if (ind < 0)
+            {
+              ind = colormap.computeIndex(px);
+              cht.add(px, ind);
+            }
+            cacheKey[slot] = key;
+            cacheIndex[slot] = ind;
+          }
+
+          fs.propagate(px, colormap.getPixel(ind), col);
+          tp[col] = OFstatic_cast(T2, ind);
+          fs.nextCol(col);
+      } while ( col != limitcol );
+      fs.finishRow();
+      cp += (cols * 3); // advance source pointer by one row
+      tp += cols;  // advance target pointer by one row
+    } // for all rows
+    delete[] cacheKey;
+    delete[] cacheIndex;
+  }
+
+private:
+
+  /// private undefined copy constructor
+  DcmQuantColorMappingLoop(const DcmQuantColorMappingLoop<T1, T2>& src);
+
+  /// private undefined copy assignment operator
+  DcmQuantColorMappingLoop<T1, T2>& operator=(const DcmQuantColorMappingLoop<T1, T2>& src);
+
+  /// pointer to the color image data
+  const DcmQuantComponent *data_;
+
+  /// number of columns of the image
+  unsigned long columns_;
+
+  /// maximum pixel value to which all color samples are down-sampled
+  unsigned long maxval_;
+
+  /// scale table used for down-sampling the color samples
+  const DcmQuantScaleTable& scaletable_;
+
+  /// color LUT to which the color image is mapped
+  const DcmQuantColorTable& colormap_;
+
+  /// error diffusion object, copied for each band
+  const T1& fs_;
+
+  /// pointer to the palette color image data
+  T2 *tp_;
+};
+
+
 /** template class that maps a color image into a palette color image
  *  with given color palette.  The two template parameters define the
  *  error diffusion class used to implement e.g. Floyd-Steinberg error
@@ -78,13 +256,6 @@ public:
     unsigned long cols = sourceImage.getWidth();
     unsigned long rows = sourceImage.getHeight();
     const int bits = sizeof(DcmQuantComponent)*8;
-    DcmQuantPixel px;
-    long limitcol;
-    long col; // must be signed!
-    long maxval_l = OFstatic_cast(long, maxval);
-    int ind;
-    const DcmQuantComponent *currentpixel;
-    DcmQuantComponent cr, cg, cb;
 
     // create scale table
     DcmQuantScaleTable scaletable;
@@ -94,35 +265,47 @@ public:
     if (data)
     {
       const DcmQuantComponent *cp = OFstatic_cast(const DcmQuantComponent *, data);
-      for (unsigned long row = 0; row < rows; ++row)
-      {
-        fs.startRow(col, limitcol);
-        do
-        {
-            currentpixel = cp + col + col + col;
-            cr = *currentpixel++;
-            cg = *currentpixel++;
-            cb = *currentpixel;
-            px.scale(cr, cg, cb, scaletable);
+      DcmQuantColorMappingLoop<T1, T2>::mapRows(cp, cols, rows, maxval, scaletable, cht, colormap, fs, tp);
+    } // if (data)
+  }
 
-            fs.adjust(px, col, maxval_l);
+  /** converts a single frame of a color image into a palette color image.
+   *  Large images are processed in parallel if configured (see
+   *  DicomImageClass::setNumberOfThreads()), see class DcmQuantColorMappingLoop
+   *  for the error diffusion classes supported by this method.
+   *  @param sourceImage color image
+   *  @param frameNumber number of frame (in sourceImage) that is converted
+   *  @param maxval maximum pixel value to which all color samples
+   *    were down-sampled during computation of the histogram on which
+   *    the color LUT is based.
+   *  @param colormap color LUT to which the color image is mapped.
+   *  @param fs error diffusion object, e.g. an instance of class DcmQuantIdent
+   *    or class DcmQuantOrderedDither, depending on the template instantiation.
+   *  @param tp pointer to an array to which the palette color image data
+   *    is written.  The array must be large enough to store sourceImage.getWidth()
+   *    times sourceImage.getHeight() values of type T2.
+   */
+  static void createInParallel(
+    DicomImage& sourceImage,
+    unsigned long frameNumber,
+    unsigned long maxval,
+    const DcmQuantColorTable& colormap,
+    const T1& fs,
+    T2 *tp)
+  {
+    unsigned long cols = sourceImage.getWidth();
+    unsigned long rows = sourceImage.getHeight();
+    const int bits = sizeof(DcmQuantComponent)*8;
 
-            // Check hash table to see if we have already matched this color.
-            ind = cht.lookup(px);
-            if (ind < 0)
-            {
-              ind = colormap.computeIndex(px);
-              cht.add(px, ind);
-            }
+    // create scale table
+    DcmQuantScaleTable scaletable;
+    scaletable.createTable(OFstatic_cast(DcmQuantComponent, -1), maxval);
 
-            fs.propagate(px, colormap.getPixel(ind), col);
-            tp[col] = OFstatic_cast(T2, ind);
-            fs.nextCol(col);
-        } while ( col != limitcol );
-        fs.finishRow();
-        cp += (cols * 3); // advance source pointer by one row
-        tp += cols;  // advance target pointer by one row
-      } // for all rows
+    const void *data = sourceImage.getOutputData(bits, frameNumber, 0);
+    if (data)
+    {
+      const DcmQuantComponent *cp = OFstatic_cast(const DcmQuantComponent *, data);
+      DcmQuantColorMappingLoop<T1, T2>(cp, cols, maxval, scaletable, colormap, fs, tp).process(rows, (cols > 0) ? DI_MINIMUM_BAND_SIZE / cols + 1 : 1);
     } // if (data)
   }
 };
@@ -28,6 +28,7 @@
 #include "dcmtk/ofstd/ofcond.h"       /* for OFCondition */
 #include "dcmtk/dcmimage/diqtpix.h"   /* for DcmQuantPixel */
 #include "dcmtk/dcmimage/diqthash.h"  /* for DcmQuantHistogramItem */
+#include "dcmtk/dcmimage/diqtkdtr.h"  /* for DcmQuantKDTree */
 #include "dcmtk/ofstd/ofstring.h"     /* for class OFString */
 
 
@@ -157,32 +158,14 @@ public:
     DcmRepresentativeColorType repType);
 
   /** determines for a given color the closest match in the color LUT.
+   *  If several entries have the same distance to the given color, the one
+   *  with the lowest index is returned.
    *  @param px color to look up in LUT
    *  @return index of closest match in LUT, -1 if look-up table empty
    */
   inline int computeIndex(const DcmQuantPixel& px) const
   {
-    int result = -1;
-    int r2, g2, b2;
-    long newdist;
-    int r1 = OFstatic_cast(int, px.getRed());
-    int g1 = OFstatic_cast(int, px.getGreen());
-    int b1 = OFstatic_cast(int, px.getBlue());
-    long dist = 2000000000;
-    for (unsigned long i = 0; i < numColors; ++i)
-    {
-        r2 = r1 - OFstatic_cast(int, array[i]->getRed());
-        g2 = g1 - OFstatic_cast(int, array[i]->getGreen());
-        b2 = b1 - OFstatic_cast(int, array[i]->getBlue());
-        newdist = r2*r2 + g2*g2 + b2*b2;
-        if (newdist < dist)
-        {
-            result = OFstatic_cast(int, i);
-            dist = newdist;
-            if (dist < array[i]->getValue()) i=numColors; // break out of for loop
-        }
-    }
-    return result;
+    return tree.findNearest(px);
   }
 
   /** writes the current color table into a DICOM object, encoded as
@@ -202,14 +185,6 @@ public:
 
 private:
 
-  /** after a call to medianCut(), this method computes for each entry in
-   *  the color map the minimum of the euclidean distances to any other
-   *  of the entries.  Any color which has an euclidean distance of less
-   *  than half of this distance is necessarily mapped to this entry.
-   *  This data is used by computeIndex()
-   */
-  void computeClusters();
-
   /// private undefined copy constructor
   DcmQuantColorTable(const DcmQuantColorTable& src);
 
@@ -227,6 +202,9 @@ private:
    */
   unsigned long maxval;
 
+  /// k-d tree on the colors of the color LUT, used by computeIndex()
+  DcmQuantKDTree tree;
+
 };
 
 #endif
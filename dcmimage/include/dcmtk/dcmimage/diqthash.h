@@ -71,6 +71,8 @@ public:
    *  color image) to the hash table.  The counter (integer value associated
    *  to each color) counts the occurrence of the color in the image.
    *  If more than maxcolors colors are found, the function returns zero.
+   *  Large images are processed in parallel if configured (see
+   *  DicomImageClass::setNumberOfThreads()).
    *  @param image image in which colors are to be counted
    *  @param newmaxval maximum pixel value to which the contents of the
    *    image are scaled down (see documentation of class DcmQuantScaleTable)
@@ -85,6 +87,32 @@ public:
     unsigned long newmaxval,
     unsigned long maxcolors);
 
+  /** adds the given pixels to the hash table.  The counter (integer value
+   *  associated to each color) counts the occurrence of the color.
+   *  @param data pointer to the pixels (interleaved R, G, B components)
+   *  @param count number of pixels to be added
+   *  @param scaletable scale table applied to the color components before
+   *    counting colors
+   *  @param numcolors number of colors already contained in the hash table
+   *  @param maxcolors maximum number of colors allowed.  If more colors are found,
+   *    the method immediately returns.
+   *  @return number of colors contained in the hash table, greater than maxcolors
+   *    if too many colors have been found.
+   */
+  unsigned long addPixels(
+    const DcmQuantComponent *data,
+    unsigned long count,
+    const DcmQuantScaleTable& scaletable,
+    unsigned long numcolors,
+    unsigned long maxcolors);
+
+  /** moves the contents of the given hash table into this table.
+   *  The counters of colors contained in both tables are added.
+   *  @param other hash table to be merged into this table, empty upon return
+   *  @return number of colors not yet contained in this table
+   */
+  unsigned long merge(DcmQuantColorHashTable& other);
+
   /** counts the number of entries in the hash table
    *  @return number of entries in hash table
    */
@@ -93,6 +93,16 @@ public:
     return 1;
   }
 
+  /** moves the contents of the given list into this list.  Entries that
+   *  are already contained in this list are not moved, instead their integer
+   *  values (counters) are added.  The resulting list is the same as if the
+   *  pixels counted in the given list had been added to this list after the
+   *  ones already counted here.
+   *  @param other list to be merged into this list, empty upon return
+   *  @return number of entries not yet contained in this list
+   */
+  unsigned long merge(DcmQuantHistogramItemList& other);
+
   /** inserts a new DcmQuantHistogramItem at the beginning of the list.
    *  @param colorP pixel value assigned to the new object in the list
    *  @param value integer value assigned to the new object in the list
@@ -94,8 +94,7 @@ private:
    *  the instances of the current color.
    *  In a color hash table, it contains the index value from the color LUT
    *  assigned to this color.
-   *  In a color LUT, it is the cluster value, i.e. the radius in which all
-   *  color are guaranteed to be mapped to this palette color.
+   *  In a color LUT, it is not used.
    */
   int value;
 
@@ -89,6 +89,11 @@ public:
     ++col;
   }
 
+  /// dummy method needed for API compatibility with DcmQuantOrderedDither
+  inline void setRow(unsigned long)
+  {
+  }
+
 private:
 
   /// number of columns in image
@@ -0,0 +1,127 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimage
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmQuantKDTree
+ *
+ */
+
+
+#ifndef DIQTKDTR_H
+#define DIQTKDTR_H
+
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmimage/diqtpix.h"   /* for DcmQuantPixel */
+#include "dcmtk/dcmimage/diqthitm.h"  /* for DcmQuantHistogramItemPointer */
+
+
+/// maximum number of colors in a leaf of the k-d tree, which is searched linearly
+#define DcmQuantKDTreeBucketSize 8
+
+
+/** helper structure for class DcmQuantKDTree.
+ *  Each object of this structure represents one color of the color LUT.
+ */
+struct DCMTK_DCMIMAGE_EXPORT DcmQuantKDTreeNode
+{
+  /// red, green and blue color component
+  int color[3];
+
+  /// index of the color in the color LUT
+  int index;
+};
+
+
+/** this class implements a k-d tree (with k = 3) on the colors of a color LUT.
+ *  It is used to determine the closest match for a given color in the color LUT
+ *  in logarithmic instead of linear time.  The tree is stored implicitly in a
+ *  single array: the index range [lo, hi) of a subtree is split at the median
+ *  (lo + hi) / 2 into the ranges [lo, mid) and [mid, hi), the color component
+ *  and value used for the split are stored at index mid of two separate arrays.
+ *  Ranges with at most
+ *  DcmQuantKDTreeBucketSize elements are not split any further.
+ */
+class DCMTK_DCMIMAGE_EXPORT DcmQuantKDTree
+{
+public:
+
+  /// constructor
+  DcmQuantKDTree();
+
+  /// destructor
+  ~DcmQuantKDTree();
+
+  /// resets the object to default-constructed state
+  void clear();
+
+  /** creates the tree for the given color LUT
+   *  @param array array of colors
+   *  @param numColors number of colors in array
+   */
+  void build(const DcmQuantHistogramItemPointer *array, unsigned long numColors);
+
+  /** determines for a given color the closest match in the color LUT,
+   *  i.e. the entry with the smallest euclidean distance.  If there are
+   *  several entries with the same distance, the one with the lowest
+   *  index is returned.
+   *  @param px color to look up in LUT
+   *  @return index of closest match in LUT, -1 if tree is empty
+   */
+  inline int findNearest(const DcmQuantPixel& px) const
+  {
+    int color[3];
+    color[0] = OFstatic_cast(int, px.getRed());
+    color[1] = OFstatic_cast(int, px.getGreen());
+    color[2] = OFstatic_cast(int, px.getBlue());
+    return search(color);
+  }
+
+private:
+
+  /** creates the subtree for the given index range
+   *  @param lo index of the first node of the subtree
+   *  @param hi index of the last node of the subtree + 1
+   */
+  void buildSubtree(unsigned long lo, unsigned long hi);
+
+  /** searches the tree for the closest match
+   *  @param color red, green and blue color component to look up
+   *  @return index of closest match in LUT, -1 if tree is empty
+   */
+  int search(const int *color) const;
+
+  /// private undefined copy constructor
+  DcmQuantKDTree(const DcmQuantKDTree& src);
+
+  /// private undefined copy assignment operator
+  DcmQuantKDTree& operator=(const DcmQuantKDTree& src);
+
+  /// array of tree nodes
+  DcmQuantKDTreeNode *nodes;
+
+  /// color component (0..2) by which the range split at a given index is split
+  int *splitAxis;
+
+  /// value of the color component at which the range split at a given index is split
+  int *splitValue;
+
+  /// number of nodes in array
+  unsigned long numNodes;
+};
+
+
+#endif
@@ -0,0 +1,158 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimage
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmQuantOrderedDither
+ *
+ */
+
+
+#ifndef DIQTOD_H
+#define DIQTOD_H
+
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmimage/diqtpix.h"   /* for DcmQuantPixel */
+
+#include "dcmtk/ofstd/ofstdinc.h"
+#include <cmath>
+
+
+/** this class implements ordered dithering with an 8x8 Bayer matrix.
+ *  It implements the same public API as class DcmQuantFloydSteinberg.
+ *  Since the adjustment of a pixel only depends on its position, the rows
+ *  of an image can be processed independently of each other, i.e. in
+ *  parallel (see setRow()).
+ */
+class DCMTK_DCMIMAGE_EXPORT DcmQuantOrderedDither
+{
+public:
+
+  /** constructor
+   *  @param cols number of columns in image
+   *  @param maxval maximum value for each color component
+   *  @param numberOfColors number of colors in the color LUT.  The amplitude
+   *    of the dither pattern is the mean distance between two color LUT
+   *    entries, assuming they are evenly distributed over the color cube.
+   */
+  DcmQuantOrderedDither(unsigned long cols, unsigned long maxval, unsigned long numberOfColors)
+  : columns(cols)
+  , row(0)
+  {
+    // create Bayer matrix recursively, the matrix of size 2n consists of
+    // four copies of the matrix of size n, multiplied by 4 and increased by 0, 2, 3 and 1
+    int bayer[64];
+    bayer[0] = 0;
+    for (int size = 1; size < 8; size *= 2)
+    {
+      for (int y = size - 1; y >= 0; --y)
+      {
+        for (int x = size - 1; x >= 0; --x)
+        {
+          const int v = bayer[y * 8 + x] * 4;
+          bayer[y * 8 + x] = v;
+          bayer[y * 8 + x + size] = v + 2;
+          bayer[(y + size) * 8 + x] = v + 3;
+          bayer[(y + size) * 8 + x + size] = v + 1;
+        }
+      }
+    }
+    const double spread = (numberOfColors > 1) ? OFstatic_cast(double, maxval) / pow(OFstatic_cast(double, numberOfColors), 1.0 / 3.0) : 0.0;
+    for (int i = 0; i < 64; ++i)
+      offsets[i] = OFstatic_cast(long, floor((OFstatic_cast(double, bayer[i]) + 0.5) / 64.0 * spread - spread / 2.0 + 0.5));
+  }
+
+  /// destructor
+  ~DcmQuantOrderedDither()
+  {
+  }
+
+  /** adds the value of the dither matrix at the position of the current
+   *  image pixel to each color component.
+   *  @param px the original image pixel is passed in this parameter. Upon return, the pixel
+   *    value contains the new value after dithering.
+   *  @param col column in which the current pixel is located, must be [0..columns-1]
+   *  @param maxval maximum value for each color component.
+   */
+  inline void adjust(DcmQuantPixel& px, long col, long maxval)
+  {
+    const long offset = offsets[((row & 7) << 3) | (col & 7)];
+    long sr = px.getRed()   + offset;
+    long sg = px.getGreen() + offset;
+    long sb = px.getBlue()  + offset;
+    if ( sr < 0 ) sr = 0;
+    else if ( sr > maxval ) sr = maxval;
+    if ( sg < 0 ) sg = 0;
+    else if ( sg > maxval ) sg = maxval;
+    if ( sb < 0 ) sb = 0;
+    else if ( sb > maxval ) sb = maxval;
+    px.assign(OFstatic_cast(DcmQuantComponent, sr), OFstatic_cast(DcmQuantComponent, sg), OFstatic_cast(DcmQuantComponent, sb));
+  }
+
+  /// dummy method needed for API compatibility with DcmQuantFloydSteinberg
+  inline void propagate(const DcmQuantPixel&, const DcmQuantPixel&, long)
+  {
+  }
+
+  /** starts a new row. The initial and last column of the current row are determined.
+   *  @param col initial column for the current row returned in this parameter
+   *  @param limitcol limit column (one past the last valid column) for the
+   *    current row returned in this parameter.
+   */
+  inline void startRow(long& col, long& limitcol)
+  {
+     col = 0;
+     limitcol = columns;
+  }
+
+  /// finishes the current row, i.e. increases the row number
+  inline void finishRow()
+  {
+    ++row;
+  }
+
+  /** increases the column number
+   *  @param col column number
+   */
+  inline void nextCol(long& col) const
+  {
+    ++col;
+  }
+
+  /** sets the number of the next row to be processed.  This is needed if the
+   *  rows of an image are not processed in sequence starting with the first row.
+   *  @param r row number
+   */
+  inline void setRow(unsigned long r)
+  {
+    row = r;
+  }
+
+private:
+
+  /// number of columns in image
+  unsigned long columns;
+
+  /// number of the current row
+  unsigned long row;
+
+  /// values of the dither matrix, already scaled to the range of the color components
+  long offsets[64];
+
+};
+
+
+#endif
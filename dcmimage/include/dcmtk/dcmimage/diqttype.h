@@ -78,4 +78,20 @@ enum DcmRepresentativeColorType
 
 };
 
+
+/** defines the dithering algorithm used when mapping a color image
+ *  to the colors of the palette
+ */
+enum DcmDitheringType
+{
+  /// no dithering, map each pixel to the closest palette color (default)
+  DcmDitheringType_none,
+
+  /// Floyd-Steinberg error diffusion (sequential, i.e. not multi-threaded)
+  DcmDitheringType_floydSteinberg,
+
+  /// ordered dithering with an 8x8 Bayer matrix (supports multi-threading)
+  DcmDitheringType_ordered
+};
+
 #endif
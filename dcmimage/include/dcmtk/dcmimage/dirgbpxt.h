@@ -113,18 +113,24 @@ class DiRGBPixelTemplate
                     for (int j = 0; j < 3; ++j)
                     {
                         /* convert a single plane */
+                        T2 *q = this->Data[j];
                         for (l = planeSize, i = iStart; (l != 0) && (i < count); --l, ++i)
-                            this->Data[j][i] = removeSign(*(p++), offset);
+                            q[i] = removeSign(*(p++), offset);
                     }
                 }
             }
             else
             {
-                int j;
+                T2 *r = this->Data[0];
+                T2 *g = this->Data[1];
+                T2 *b = this->Data[2];
                 unsigned long i;
                 for (i = 0; i < count; ++i)                             /* for all pixel ... */
-                    for (j = 0; j < 3; ++j)
-                        this->Data[j][i] = removeSign(*(p++), offset);  /* ... copy planes */
+                {
+                    r[i] = removeSign(p[3 * i], offset);                /* ... copy planes */
+                    g[i] = removeSign(p[3 * i + 1], offset);
+                    b[i] = removeSign(p[3 * i + 2], offset);
+                }
             }
         }
     }
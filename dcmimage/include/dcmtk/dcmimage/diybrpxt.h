@@ -27,12 +27,274 @@
 
 #include "dcmtk/dcmimage/dicopxt.h"
 #include "dcmtk/dcmimgle/diinpx.h"  /* gcc 3.4 needs this */
+#include "dcmtk/dcmimgle/dithread.h"
 
 
 /*---------------------*
  *  class declaration  *
  *---------------------*/
 
+/** Template class to convert a band of YCbCr pixels to RGB.
+ *  Unpacking the input samples and converting them is done in a single pass. The values
+ *  are clipped without branches, so that the loops are not slowed down by unpredictable
+ *  jumps. Unsigned 8 bit samples are converted using lookup tables (integer arithmetic),
+ *  all others using floating point arithmetic.
+ */
+template<class T1, class T2>
+class DiYBRConversionLoopTemplate
+  : public DiThreadedLoop
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  pixel      pointer to input pixel data (YCbCr)
+     *  @param  data       pointer to the three planes of the output data (RGB)
+     *  @param  planeSize  number of pixels in a plane (only used for color-by-plane input)
+     *  @param  bits       number of bits per sample
+     *  @param  mode       layout of the input data: 0 = color-by-pixel, 1 = color-by-plane (frame
+     *                     by frame), 2 = YBR_FULL_422 (two luminance values sharing one pair of
+     *                     chrominance values, the loop counts pairs of pixels in this case)
+     */
+    DiYBRConversionLoopTemplate(const T1 *pixel,
+                                T2 *const *data,
+                                const unsigned long planeSize,
+                                const int bits,
+                                const int mode)
+      : DiThreadedLoop(),
+        Pixel(pixel),
+        Red(data[0]),
+        Green(data[1]),
+        Blue(data[2]),
+        PlaneSize(planeSize),
+        Mode(mode),
+        Offset(OFstatic_cast(T1, DicomImageClass::maxval(bits - 1))),
+        MaxValue(OFstatic_cast(T2, DicomImageClass::maxval(bits))),
+        UseTables(OFFalse)
+    {
+        DiPixelRepresentationTemplate<T1> rep;
+        if (bits == 8 && !rep.isSigned())          // only for unsigned 8 bit
+        {
+            const double r_const = 0.7010 * OFstatic_cast(double, MaxValue);
+            const double g_const = 0.5291 * OFstatic_cast(double, MaxValue);
+            const double b_const = 0.8859 * OFstatic_cast(double, MaxValue);
+            for (unsigned long l = 0; l < 256; ++l)
+            {
+                RCrTable[l] = OFstatic_cast(Sint16, 1.4020 * OFstatic_cast(double, l) - r_const);
+                GCbTable[l] = OFstatic_cast(Sint16, 0.3441 * OFstatic_cast(double, l));
+                GCrTable[l] = OFstatic_cast(Sint16, 0.7141 * OFstatic_cast(double, l) - g_const);
+                BCbTable[l] = OFstatic_cast(Sint16, 1.7720 * OFstatic_cast(double, l) - b_const);
+            }
+            UseTables = OFTrue;
+        }
+    }
+
+    /** destructor
+     */
+    virtual ~DiYBRConversionLoopTemplate()
+    {
+    }
+
+    /** convert a band of pixels (or pairs of pixels in case of YBR_FULL_422)
+     *
+     ** @param  first  index of the first pixel (pair) of the band
+     *  @param  count  number of pixels (pairs) of the band
+     */
+    virtual void processBand(const unsigned long first,
+                             const unsigned long count)
+    {
+        if (Mode == 2)
+            convertPairs(Pixel + 4 * first, Red + 2 * first, Green + 2 * first, Blue + 2 * first, count);
+        else if (Mode == 1)
+        {
+            /* each frame consists of three planes */
+            unsigned long pos = first % PlaneSize;
+            const T1 *y = Pixel + 3 * (first - pos) + pos;
+            unsigned long i = first;
+            unsigned long n = count;
+            while (n != 0)
+            {
+                /* convert (the rest of) a single frame */
+                const unsigned long l = (PlaneSize - pos < n) ? PlaneSize - pos : n;
+                convertPixels(y, y + PlaneSize, y + 2 * PlaneSize, 1, Red + i, Green + i, Blue + i, l);
+                /* jump to next frame start (skip 2 planes) */
+                y += l + 2 * PlaneSize;
+                i += l;
+                n -= l;
+                pos = 0;
+            }
+        } else {
+            const T1 *p = Pixel + 3 * first;
+            convertPixels(p, p + 1, p + 2, 3, Red + first, Green + first, Blue + first, count);
+        }
+    }
+
+
+ private:
+
+    /** clip an integer value to the range of the output samples
+     *
+     ** @param  value     value to be clipped
+     *  @param  maxvalue  maximum output value
+     *
+     ** @return clipped value
+     */
+    static inline T2 clipValue(Sint32 value,
+                               const Sint32 maxvalue)
+    {
+        value = (value < 0) ? 0 : value;
+        return OFstatic_cast(T2, (value > maxvalue) ? maxvalue : value);
+    }
+
+    /** clip a floating point value to the range of the output samples
+     *
+     ** @param  value     value to be clipped
+     *  @param  maxvalue  maximum output value
+     *
+     ** @return clipped value
+     */
+    static inline T2 clipValue(double value,
+                               const double maxvalue)
+    {
+        value = (value < 0.0) ? 0.0 : value;
+        return OFstatic_cast(T2, (value > maxvalue) ? maxvalue : value);
+    }
+
+    /** convert a number of pixels
+     *
+     ** @param  y      pointer to first luminance value
+     *  @param  cb     pointer to first blue chrominance value
+     *  @param  cr     pointer to first red chrominance value
+     *  @param  step   distance between two input values of the same component
+     *  @param  r      pointer to first red output value
+     *  @param  g      pointer to first green output value
+     *  @param  b      pointer to first blue output value
+     *  @param  count  number of pixels to be converted
+     */
+    void convertPixels(const T1 *y,
+                       const T1 *cb,
+                       const T1 *cr,
+                       const unsigned long step,
+                       T2 *r,
+                       T2 *g,
+                       T2 *b,
+                       const unsigned long count) const
+    {
+        unsigned long i;
+        if (UseTables)
+        {
+            const Sint32 maxvalue = OFstatic_cast(Sint32, MaxValue);
+            for (i = 0; i < count; ++i)
+            {
+                const Sint32 sy = OFstatic_cast(Sint32, y[i * step]);
+                const Uint32 scb = OFstatic_cast(Uint32, cb[i * step]);
+                const Uint32 scr = OFstatic_cast(Uint32, cr[i * step]);
+                r[i] = clipValue(sy + OFstatic_cast(Sint32, RCrTable[scr]), maxvalue);
+                g[i] = clipValue(sy - OFstatic_cast(Sint32, GCbTable[scb]) - OFstatic_cast(Sint32, GCrTable[scr]), maxvalue);
+                b[i] = clipValue(sy + OFstatic_cast(Sint32, BCbTable[scb]), maxvalue);
+            }
+        } else {
+            const double maxvalue = OFstatic_cast(double, MaxValue);
+            for (i = 0; i < count; ++i)
+            {
+                const double dy = OFstatic_cast(double, removeSign(y[i * step], Offset));
+                const double dcb = OFstatic_cast(double, removeSign(cb[i * step], Offset));
+                const double dcr = OFstatic_cast(double, removeSign(cr[i * step], Offset));
+                r[i] = clipValue(dy + 1.4020 * dcr - 0.7010 * maxvalue, maxvalue);
+                g[i] = clipValue(dy - 0.3441 * dcb - 0.7141 * dcr + 0.5291 * maxvalue, maxvalue);
+                b[i] = clipValue(dy + 1.7720 * dcb - 0.8859 * maxvalue, maxvalue);
+            }
+        }
+    }
+
+    /** convert a number of pixel pairs (YBR_FULL_422)
+     *
+     ** @param  p      pointer to first input value
+     *  @param  r      pointer to first red output value
+     *  @param  g      pointer to first green output value
+     *  @param  b      pointer to first blue output value
+     *  @param  count  number of pixel pairs to be converted
+     */
+    void convertPairs(const T1 *p,
+                      T2 *r,
+                      T2 *g,
+                      T2 *b,
+                      const unsigned long count) const
+    {
+        unsigned long i;
+        if (UseTables)
+        {
+            const Sint32 maxvalue = OFstatic_cast(Sint32, MaxValue);
+            for (i = 0; i < count; ++i)
+            {
+                const Sint32 y1 = OFstatic_cast(Sint32, p[4 * i]);
+                const Sint32 y2 = OFstatic_cast(Sint32, p[4 * i + 1]);
+                const Uint32 cb = OFstatic_cast(Uint32, p[4 * i + 2]);
+                const Uint32 cr = OFstatic_cast(Uint32, p[4 * i + 3]);
+                const Sint32 rd = OFstatic_cast(Sint32, RCrTable[cr]);
+                const Sint32 gd = OFstatic_cast(Sint32, GCbTable[cb]) + OFstatic_cast(Sint32, GCrTable[cr]);
+                const Sint32 bd = OFstatic_cast(Sint32, BCbTable[cb]);
+                r[2 * i] = clipValue(y1 + rd, maxvalue);
+                g[2 * i] = clipValue(y1 - gd, maxvalue);
+                b[2 * i] = clipValue(y1 + bd, maxvalue);
+                r[2 * i + 1] = clipValue(y2 + rd, maxvalue);
+                g[2 * i + 1] = clipValue(y2 - gd, maxvalue);
+                b[2 * i + 1] = clipValue(y2 + bd, maxvalue);
+            }
+        } else {
+            const double maxvalue = OFstatic_cast(double, MaxValue);
+            for (i = 0; i < count; ++i)
+            {
+                const double y1 = OFstatic_cast(double, removeSign(p[4 * i], Offset));
+                const double y2 = OFstatic_cast(double, removeSign(p[4 * i + 1], Offset));
+                const double cb = OFstatic_cast(double, removeSign(p[4 * i + 2], Offset));
+                const double cr = OFstatic_cast(double, removeSign(p[4 * i + 3], Offset));
+                r[2 * i] = clipValue(y1 + 1.4020 * cr - 0.7010 * maxvalue, maxvalue);
+                g[2 * i] = clipValue(y1 - 0.3441 * cb - 0.7141 * cr + 0.5291 * maxvalue, maxvalue);
+                b[2 * i] = clipValue(y1 + 1.7720 * cb - 0.8859 * maxvalue, maxvalue);
+                r[2 * i + 1] = clipValue(y2 + 1.4020 * cr - 0.7010 * maxvalue, maxvalue);
+                g[2 * i + 1] = clipValue(y2 - 0.3441 * cb - 0.7141 * cr + 0.5291 * maxvalue, maxvalue);
+                b[2 * i + 1] = clipValue(y2 + 1.7720 * cb - 0.8859 * maxvalue, maxvalue);
+            }
+        }
+    }
+
+    /// pointer to input pixel data
+    const T1 *Pixel;
+    /// pointer to red output plane
+    T2 *Red;
+    /// pointer to green output plane
+    T2 *Green;
+    /// pointer to blue output plane
+    T2 *Blue;
+    /// number of pixels in a plane
+    const unsigned long PlaneSize;
+    /// layout of the input data
+    const int Mode;
+    /// offset used to remove the sign of signed input values
+    const T1 Offset;
+    /// maximum output value
+    const T2 MaxValue;
+    /// use lookup tables for the conversion (unsigned 8 bit only)
+    OFBool UseTables;
+
+    /// lookup table for the red part of Cr
+    Sint16 RCrTable[256];
+    /// lookup table for the green part of Cb
+    Sint16 GCbTable[256];
+    /// lookup table for the green part of Cr
+    Sint16 GCrTable[256];
+    /// lookup table for the blue part of Cb
+    Sint16 BCbTable[256];
+
+ // --- declarations to avoid compiler warnings
+
+    DiYBRConversionLoopTemplate(const DiYBRConversionLoopTemplate<T1,T2> &);
+    DiYBRConversionLoopTemplate<T1,T2> &operator=(const DiYBRConversionLoopTemplate<T1,T2> &);
+};
+
+
 /** Template class to handle YCbCr pixel data
  */
 template<class T1, class T2>
@@ -92,137 +354,7 @@ class DiYBRPixelTemplate
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
             if (rgb)    /* convert to RGB model */
             {
-                T2 *r = this->Data[0];
-                T2 *g = this->Data[1];
-                T2 *b = this->Data[2];
-                const T2 maxvalue = OFstatic_cast(T2, DicomImageClass::maxval(bits));
-                DiPixelRepresentationTemplate<T1> rep;
-                if (bits == 8 && !rep.isSigned())          // only for unsigned 8 bit
-                {
-                    Sint16 rcr_tab[256];
-                    Sint16 gcb_tab[256];
-                    Sint16 gcr_tab[256];
-                    Sint16 bcb_tab[256];
-                    const double r_const = 0.7010 * OFstatic_cast(double, maxvalue);
-                    const double g_const = 0.5291 * OFstatic_cast(double, maxvalue);
-                    const double b_const = 0.8859 * OFstatic_cast(double, maxvalue);
-                    unsigned long l;
-                    for (l = 0; l < 256; ++l)
-                    {
-                        rcr_tab[l] = OFstatic_cast(Sint16, 1.4020 * OFstatic_cast(double, l) - r_const);
-                        gcb_tab[l] = OFstatic_cast(Sint16, 0.3441 * OFstatic_cast(double, l));
-                        gcr_tab[l] = OFstatic_cast(Sint16, 0.7141 * OFstatic_cast(double, l) - g_const);
-                        bcb_tab[l] = OFstatic_cast(Sint16, 1.7720 * OFstatic_cast(double, l) - b_const);
-                    }
-                    Sint32 sr;
-                    Sint32 sg;
-                    Sint32 sb;
-                    if (this->PlanarConfiguration)
-                    {
-/*
-                        const T1 *y = pixel;
-                        const T1 *cb = y + this->InputCount;
-                        const T1 *cr = cb + this->InputCount;
-                        for (i = count; i != 0; --i, ++y, ++cb, ++cr)
-                        {
-                            sr = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, rcr_tab[*cr]);
-                            sg = OFstatic_cast(Sint32, *y) - OFstatic_cast(Sint32, gcb_tab[*cb]) - OFstatic_cast(Sint32, gcr_tab[*cr]);
-                            sb = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, bcb_tab[*cb]);
-                            *(r++) = (sr < 0) ? 0 : (sr > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sr);
-                            *(g++) = (sg < 0) ? 0 : (sg > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sg);
-                            *(b++) = (sb < 0) ? 0 : (sb > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sb);
-                        }
-*/
-                        const T1 *y = pixel;
-                        const T1 *cb = y + planeSize;
-                        const T1 *cr = cb + planeSize;
-                        unsigned long i = count;
-                        while (i != 0)
-                        {
-                            /* convert a single frame */
-                            for (l = planeSize; (l != 0) && (i != 0); --l, --i, ++y, ++cb, ++cr)
-                            {
-                                sr = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, rcr_tab[OFstatic_cast(Uint32, *cr)]);
-                                sg = OFstatic_cast(Sint32, *y) - OFstatic_cast(Sint32, gcb_tab[OFstatic_cast(Uint32, *cb)]) - OFstatic_cast(Sint32, gcr_tab[OFstatic_cast(Uint32, *cr)]);
-                                sb = OFstatic_cast(Sint32, *y) + OFstatic_cast(Sint32, bcb_tab[OFstatic_cast(Uint32, *cb)]);
-                                *(r++) = (sr < 0) ? 0 : (sr > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sr);
-                                *(g++) = (sg < 0) ? 0 : (sg > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sg);
-                                *(b++) = (sb < 0) ? 0 : (sb > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sb);
-                            }
-                            /* jump to next frame start (skip 2 planes) */
-                            y += 2 * planeSize;
-                            cb += 2 * planeSize;
-                            cr += 2 * planeSize;
-                        }
-                    }
-                    else
-                    {
-                        const T1 *p = pixel;
-                        T1 y;
-                        T1 cb;
-                        T1 cr;
-                        unsigned long i;
-                        for (i = count; i != 0; --i)
-                        {
-                            y  = *(p++);
-                            cb = *(p++);
-                            cr = *(p++);
-                            sr = OFstatic_cast(Sint32, y) + OFstatic_cast(Sint32, rcr_tab[OFstatic_cast(Uint32, cr)]);
-                            sg = OFstatic_cast(Sint32, y) - OFstatic_cast(Sint32, gcb_tab[OFstatic_cast(Uint32, cb)]) - OFstatic_cast(Sint32, gcr_tab[OFstatic_cast(Uint32, cr)]);
-                            sb = OFstatic_cast(Sint32, y) + OFstatic_cast(Sint32, bcb_tab[OFstatic_cast(Uint32, cb)]);
-                            *(r++) = (sr < 0) ? 0 : (sr > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sr);
-                            *(g++) = (sg < 0) ? 0 : (sg > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sg);
-                            *(b++) = (sb < 0) ? 0 : (sb > OFstatic_cast(Sint32, maxvalue)) ? maxvalue : OFstatic_cast(T2, sb);
-                        }
-                    }
-                }
-                else
-                {
-                    if (this->PlanarConfiguration)
-                    {
-/*
-                        const T1 *y = pixel;
-                        const T1 *cb = y + this->InputCount;
-                        const T1 *cr = cb + this->InputCount;
-                        for (i = count; i != 0; --i)
-                            convertValue(*(r++), *(g++), *(b++), removeSign(*(y++), offset), removeSign(*(cb++), offset),
-                                removeSign(*(cr++), offset), maxvalue);
-*/
-                        unsigned long l;
-                        unsigned long i = count;
-                        const T1 *y = pixel;
-                        const T1 *cb = y + planeSize;
-                        const T1 *cr = cb + planeSize;
-                        while (i != 0)
-                        {
-                            /* convert a single frame */
-                            for (l = planeSize; (l != 0) && (i != 0); --l, --i)
-                            {
-                                convertValue(*(r++), *(g++), *(b++), removeSign(*(y++), offset), removeSign(*(cb++), offset),
-                                    removeSign(*(cr++), offset), maxvalue);
-                            }
-                            /* jump to next frame start (skip 2 planes) */
-                            y += 2 * planeSize;
-                            cb += 2 * planeSize;
-                            cr += 2 * planeSize;
-                        }
-                    }
-                    else
-                    {
-                        const T1 *p = pixel;
-                        T2 y;
-                        T2 cb;
-                        T2 cr;
-                        unsigned long i;
-                        for (i = count; i != 0; --i)
-                        {
-                            y = removeSign(*(p++), offset);
-                            cb = removeSign(*(p++), offset);
-                            cr = removeSign(*(p++), offset);
-                            convertValue(*(r++), *(g++), *(b++), y, cb, cr, maxvalue);
-                        }
-                    }
-                }
+                DiYBRConversionLoopTemplate<T1, T2>(pixel, this->Data, planeSize, bits, (this->PlanarConfiguration) ? 1 : 0).process(count);
             } else {    /* retain YCbCr model */
                 const T1 *p = pixel;
                 if (this->PlanarConfiguration)
@@ -250,41 +382,28 @@ class DiYBRPixelTemplate
                         for (int j = 0; j < 3; ++j)
                         {
                             /* convert a single plane */
+                            T2 *q = this->Data[j];
                             for (l = planeSize, i = iStart; (l != 0) && (i < count); --l, ++i)
-                                this->Data[j][i] = removeSign(*(p++), offset);
+                                q[i] = removeSign(*(p++), offset);
                         }
                     }
                 }
                 else
                 {
-                    int j;
+                    T2 *r = this->Data[0];
+                    T2 *g = this->Data[1];
+                    T2 *b = this->Data[2];
                     unsigned long i;
                     for (i = 0; i < count; ++i)                             /* for all pixel ... */
-                        for (j = 0; j < 3; ++j)
-                            this->Data[j][i] = removeSign(*(p++), offset);  /* ... copy planes */
+                    {
+                        r[i] = removeSign(p[3 * i], offset);                /* ... copy planes */
+                        g[i] = removeSign(p[3 * i + 1], offset);
+                        b[i] = removeSign(p[3 * i + 2], offset);
+                    }
                 }
             }
         }
     }
-
-    /** convert a single YCbCr value to RGB
-     *  @param red the red part of the RGB value
-     *  @param green the green part of the RGB value
-     *  @param blue the blue part of the RGB value
-     *  @param y the luma part of the YCbCr value
-     *  @param cb the blue-difference part of the YCbCr value
-     *  @param cr the red-difference part of the YCbCr value
-     *  @param maxvalue the maximum value of the RGB parts
-     */
-    inline void convertValue(T2 &red, T2 &green, T2 &blue, const T2 y, const T2 cb, const T2 cr, const T2 maxvalue)
-    {
-        double dr = OFstatic_cast(double, y) + 1.4020 * OFstatic_cast(double, cr) - 0.7010 * OFstatic_cast(double, maxvalue);
-        double dg = OFstatic_cast(double, y) - 0.3441 * OFstatic_cast(double, cb) - 0.7141 * OFstatic_cast(double, cr) + 0.5291 * OFstatic_cast(double, maxvalue);
-        double db = OFstatic_cast(double, y) + 1.7720 * OFstatic_cast(double, cb) - 0.8859 * OFstatic_cast(double, maxvalue);
-        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
-        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
-        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
-    }
 };
 
 
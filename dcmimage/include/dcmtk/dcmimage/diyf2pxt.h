@@ -26,6 +26,7 @@
 #include "dcmtk/config/osconfig.h"
 
 #include "dcmtk/dcmimage/dicopxt.h"
+#include "dcmtk/dcmimage/diybrpxt.h"
 #include "dcmtk/dcmimgle/diinpx.h"  /* gcc 3.4 needs this */
 
 
@@ -105,16 +106,7 @@ class DiYBR422PixelTemplate
             const unsigned long count = (this->InputCount < this->Count) ? this->InputCount : this->Count;
             if (rgb)    /* convert to RGB model */
             {
-                const T2 maxvalue = OFstatic_cast(T2, DicomImageClass::maxval(bits));
-                for (i = count / 2; i != 0; --i)
-                {
-                    y1 = removeSign(*(p++), offset);
-                    y2 = removeSign(*(p++), offset);
-                    cb = removeSign(*(p++), offset);
-                    cr = removeSign(*(p++), offset);
-                    convertValue(*(r++), *(g++), *(b++), y1, cb, cr, maxvalue);
-                    convertValue(*(r++), *(g++), *(b++), y2, cb, cr, maxvalue);
-                }
+                DiYBRConversionLoopTemplate<T1, T2>(pixel, this->Data, 0, bits, 2 /* 4:2:2 */).process(count / 2);
             } else {    /* retain YCbCr model: YCbCr_422_full -> YCbCr_full */
                 for (i = count / 2; i != 0; --i)
                 {
@@ -132,31 +124,6 @@ class DiYBR422PixelTemplate
             }
         }
     }
-
-    /** convert a single YCbCr value to RGB
-     *  @param red the red part of the RGB value
-     *  @param green the green part of the RGB value
-     *  @param blue the blue part of the RGB value
-     *  @param y the luma part of the YCbCr value
-     *  @param cb the blue-difference part of the YCbCr value
-     *  @param cr the red-difference part of the YCbCr value
-     *  @param maxvalue the maximum value of the RGB parts
-     */
-    inline void convertValue(T2 &red,
-                             T2 &green,
-                             T2 &blue,
-                             const T2 y,
-                             const T2 cb,
-                             const T2 cr,
-                             const T2 maxvalue)
-    {
-        double dr = OFstatic_cast(double, y) + 1.4020 * OFstatic_cast(double, cr) - 0.7010 * OFstatic_cast(double, maxvalue);
-        double dg = OFstatic_cast(double, y) - 0.3441 * OFstatic_cast(double, cb) - 0.7141 * OFstatic_cast(double, cr) + 0.5291 * OFstatic_cast(double, maxvalue);
-        double db = OFstatic_cast(double, y) + 1.7720 * OFstatic_cast(double, cb) - 0.8859 * OFstatic_cast(double, maxvalue);
-        red   = (dr < 0.0) ? 0 : (dr > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dr);
-        green = (dg < 0.0) ? 0 : (dg > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, dg);
-        blue  = (db < 0.0) ? 0 : (db > OFstatic_cast(double, maxvalue)) ? maxvalue : OFstatic_cast(T2, db);
-    }
 };
 
 
@@ -45,6 +45,8 @@ DiPNGPlugin::DiPNGPlugin()
 , interlaceType(E_pngInterlaceAdam7)
 , metainfoType(E_pngFileMetainfo)
 , bitsPerSample(8)
+, compressionLevel(-1)
+, filterType(E_pngFilterDefault)
 {
 }
 
@@ -61,17 +63,32 @@ int DiPNGPlugin::write(
   FILE *stream,
   const unsigned long frame) const
 {
-  volatile int result = 0;  // gcc -W requires volatile here because of longjmp
+  int result = 0;
   if ((image != NULL) && (stream != NULL))
   {
     /* create bitmap with 8 or 16 bits per sample */
-    const int bit_depth = bitsPerSample;
-    const void *data = image->getOutputData(frame, bit_depth /*bits*/, 0 /*planar*/);
+    const void *data = image->getOutputData(frame, bitsPerSample /*bits*/, 0 /*planar*/);
+    if (data != NULL)
+      result = encode(image, data, stream);
+  }
+  return result;
+}
+
+
+int DiPNGPlugin::encode(
+  const DiImage *image,
+  const void *data,
+  FILE *stream) const
+{
+  volatile int result = 0;  // gcc -W requires volatile here because of longjmp
+  if ((image != NULL) && (stream != NULL))
+  {
     if (data != NULL)
     {
+      const int bit_depth = bitsPerSample;
       png_struct *png_ptr = NULL;
       png_info *info_ptr = NULL;
-      png_byte *pix_ptr = NULL;
+      const png_byte *pix_ptr = NULL;
 
       png_byte ** volatile row_ptr = NULL;
       volatile png_textp  text_ptr = NULL;
@@ -128,6 +145,32 @@ int DiPNGPlugin::write(
       // init png io structure
       png_init_io( png_ptr, stream );
 
+      // set compression level and row filters
+      if( compressionLevel >= 0 )
+        png_set_compression_level( png_ptr, compressionLevel );
+      switch (filterType) {
+        case E_pngFilterDefault:
+          break;
+        case E_pngFilterNone:
+          png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE );
+          break;
+        case E_pngFilterSub:
+          png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB );
+          break;
+        case E_pngFilterUp:
+          png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_UP );
+          break;
+        case E_pngFilterAverage:
+          png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_AVG );
+          break;
+        case E_pngFilterPaeth:
+          png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_PAETH );
+          break;
+        case E_pngFilterAdaptive:
+          png_set_filter( png_ptr, PNG_FILTER_TYPE_BASE, PNG_ALL_FILTERS );
+          break;
+      }
+
       // set write mode
       png_set_IHDR( png_ptr, info_ptr, width, height, bit_depth, color_type,
                     opt_interlace, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
@@ -161,32 +204,39 @@ int DiPNGPlugin::write(
 
       // write header
       png_write_info( png_ptr, info_ptr );
-      row_ptr = new png_bytep[height];
-      if( row_ptr == NULL ) {
-        png_destroy_write_struct( &png_ptr, NULL );
-        if( text_ptr ) delete[] text_ptr;
-        return result;
-      }
-      for( row=0, pix_ptr=OFstatic_cast(png_byte*, OFconst_cast(void*, data));
-        row<height;
-        row++, pix_ptr+=width*bpp )
-      {
-        row_ptr[row] = pix_ptr;
-      }
 
       // swap bytes (if needed)
       if ( (bit_depth == 16) && (gLocalByteOrder != EBO_BigEndian) )
         png_set_swap( png_ptr );
 
-      // write image
-      png_write_image( png_ptr, row_ptr );
+      pix_ptr = OFstatic_cast(const png_byte*, data);
+      if( opt_interlace == PNG_INTERLACE_NONE ) {
+        // write image row by row, i.e. compress each row as soon as it is passed to the library
+        for( row=0; row<height; row++, pix_ptr+=width*bpp )
+          png_write_row( png_ptr, OFconst_cast(png_byte*, pix_ptr) );
+      } else {
+        // interlaced images are written in several passes, which requires all rows at once
+        row_ptr = new png_bytep[height];
+        if( row_ptr == NULL ) {
+          png_destroy_write_struct( &png_ptr, NULL );
+          if( text_ptr ) delete[] text_ptr;
+          return result;
+        }
+        for( row=0; row<height; row++, pix_ptr+=width*bpp )
+        {
+          row_ptr[row] = OFconst_cast(png_byte*, pix_ptr);
+        }
+
+        // write image
+        png_write_image( png_ptr, row_ptr );
+      }
 
       // write additional chunks
       png_write_end( png_ptr, info_ptr );
 
       // finish
       png_destroy_write_struct( &png_ptr, &info_ptr );
-      delete[] row_ptr;
+      if( row_ptr ) delete[] row_ptr;
       if( text_ptr ) delete[] text_ptr;
       result = 1;
     }
@@ -217,6 +267,25 @@ void DiPNGPlugin::setBitsPerSample(const int bpp)
 }
 
 
+int DiPNGPlugin::getBitsPerSample() const
+{
+  return bitsPerSample;
+}
+
+
+void DiPNGPlugin::setCompressionLevel(const int level)
+{
+  if( (level >= -1) && (level <= 9) )
+    compressionLevel = level;
+}
+
+
+void DiPNGPlugin::setFilterType(DiPNGFilter ftype)
+{
+  filterType = ftype;
+}
+
+
 OFString DiPNGPlugin::getLibraryVersionString()
 {
   OFString versionStr = "LIBPNG, Version ";
@@ -46,6 +46,7 @@ DiTIFFPlugin::DiTIFFPlugin()
 , compressionType(E_tiffLZWCompression)
 , predictor(E_tiffLZWPredictorDefault)
 , rowsPerStrip(0)
+, compressionLevel(0)
 {
 }
 
@@ -59,6 +60,26 @@ int DiTIFFPlugin::write(
   DiImage *image,
   FILE *stream,
   const unsigned long frame) const
+{
+  int result = 0;
+  if ((image != NULL) && (stream != NULL))
+  {
+    /* create bitmap with 8 bits per sample */
+    const void *data = image->getOutputData(frame, 8 /*bits*/, 0 /*planar*/);
+    if (data != NULL)
+      result = encode(image, data, stream);
+
+    /* delete pixel data */
+    image->deleteOutputData();
+  }
+  return result;
+}
+
+
+int DiTIFFPlugin::encode(
+  const DiImage *image,
+  const void *data,
+  FILE *stream) const
 {
   int result = 0;
   if ((image != NULL) && (stream != NULL))
@@ -88,8 +109,6 @@ int DiTIFFPlugin::write(
 
 #endif /* _WIN32 */
 
-    /* create bitmap with 8 bits per sample */
-    void *data = OFconst_cast(void *, image->getOutputData(frame, 8 /*bits*/, 0 /*planar*/));
     if (data != NULL)
     {
       OFBool isMono = (image->getInternalColorModel() == EPI_Monochrome1) || (image->getInternalColorModel() == EPI_Monochrome2);
@@ -127,6 +146,9 @@ int DiTIFFPlugin::write(
           case E_tiffNoCompression:
             opt_compression = COMPRESSION_NONE;
             break;
+          case E_tiffDeflateCompression:
+            opt_compression = COMPRESSION_ADOBE_DEFLATE;
+            break;
         }
 
         long opt_rowsperstrip = OFstatic_cast(long, rowsPerStrip);
@@ -134,7 +156,7 @@ int DiTIFFPlugin::write(
         if (opt_rowsperstrip == 0) opt_rowsperstrip++;
 
         OFBool OK = OFTrue;
-        unsigned char *bytedata = OFstatic_cast(unsigned char *, data);
+        unsigned char *bytedata = OFstatic_cast(unsigned char *, OFconst_cast(void *, data));
         TIFF *tif = TIFFFdOpen(stream_fd, "TIFF", "w");
         if (tif)
         {
@@ -144,8 +166,10 @@ int DiTIFFPlugin::write(
           TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 8);
           TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
           TIFFSetField(tif, TIFFTAG_COMPRESSION, opt_compression);
-          if (opt_compression == COMPRESSION_LZW && opt_predictor != 0)
+          if ((opt_compression == COMPRESSION_LZW || opt_compression == COMPRESSION_ADOBE_DEFLATE) && opt_predictor != 0)
           TIFFSetField(tif, TIFFTAG_PREDICTOR, opt_predictor);
+          if (opt_compression == COMPRESSION_ADOBE_DEFLATE && compressionLevel > 0)
+          TIFFSetField(tif, TIFFTAG_ZIPQUALITY, compressionLevel);
           TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, photometric);
           TIFFSetField(tif, TIFFTAG_FILLORDER, FILLORDER_MSB2LSB);
           TIFFSetField(tif, TIFFTAG_DOCUMENTNAME, "unnamed");
@@ -156,12 +180,16 @@ int DiTIFFPlugin::write(
           /* TIFFSetField(tif, TIFFTAG_STRIPBYTECOUNTS, rows / opt_rowsperstrip); */
           TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
 
-          /* Now write the TIFF data. */
+          /* Now write the TIFF data strip by strip, i.e. each strip is
+           * compressed as a whole without copying it row by row.
+           */
           unsigned long offset = 0;
-          for (Uint16 i=0; (i < rows) && OK; i++)
+          tstrip_t strip = 0;
+          for (unsigned long i = 0; (i < rows) && OK; i += opt_rowsperstrip)
           {
-            if (TIFFWriteScanline(tif, bytedata + offset, i, 0) < 0) OK = OFFalse;
-            offset += bytesperrow;
+            const unsigned long striprows = (rows - i < OFstatic_cast(unsigned long, opt_rowsperstrip)) ? rows - i : opt_rowsperstrip;
+            if (TIFFWriteEncodedStrip(tif, strip++, bytedata + offset, striprows * bytesperrow) < 0) OK = OFFalse;
+            offset += striprows * bytesperrow;
           }
           TIFFFlushData(tif);
 
@@ -174,9 +202,6 @@ int DiTIFFPlugin::write(
         if (OK) result = 1;
       }
     }
-
-    /* delete pixel data */
-    image->deleteOutputData();
   }
   return result;
 }
@@ -200,6 +225,19 @@ void DiTIFFPlugin::setRowsPerStrip(unsigned long rows)
 }
 
 
+void DiTIFFPlugin::setCompressionLevel(const int level)
+{
+  if ((level >= 0) && (level <= 9))
+    compressionLevel = level;
+}
+
+
+int DiTIFFPlugin::getBitsPerSample() const
+{
+  return 8;
+}
+
+
 OFString DiTIFFPlugin::getLibraryVersionString()
 {
     /* use first line only, omit copyright information */
@@ -66,6 +66,7 @@ DcmQuantColorTable::DcmQuantColorTable()
 : array(NULL)
 , numColors(0)
 , maxval(0)
+, tree()
 {
 }
 
@@ -86,6 +87,7 @@ void DcmQuantColorTable::clear()
   }
   numColors = 0;
   maxval = 0;
+  tree.clear();
 }
 
 
@@ -319,51 +321,12 @@ OFCondition DcmQuantColorTable::medianCut(
       }
   }
 
-  // All done, now compute clusters
-  computeClusters();
+  // All done, now create the search tree used by computeIndex()
+  tree.build(array, numColors);
   return EC_Normal;
 }
 
 
-void DcmQuantColorTable::computeClusters()
-{
-  unsigned long i;
-  unsigned long j;
-  unsigned long k=0;
-  int cluster;
-  int newdist;
-  int r1, g1, b1;
-  int r2, g2, b2;
-
-  // initialize clusters
-  for (i = 0; i < numColors; ++i) array[i]->setValue(2000000000);
-
-  for (i = 0; i < numColors-1; ++i)
-  {
-    cluster = array[i]->getValue();
-    r1 = OFstatic_cast(int, array[i]->getRed());
-    g1 = OFstatic_cast(int, array[i]->getGreen());
-    b1 = OFstatic_cast(int, array[i]->getBlue());
-
-    for (j = i+1; j < numColors; ++j)
-    {
-      // compute euclidean distance between i and j
-      r2 = r1 - OFstatic_cast(int, array[j]->getRed());
-      g2 = g1 - OFstatic_cast(int, array[j]->getGreen());
-      b2 = b1 - OFstatic_cast(int, array[j]->getBlue());
-      newdist = (r2*r2 + g2*g2 + b2*b2)/2;
-      if (newdist < cluster)
-      {
-        cluster = newdist;
-        k = j;
-      }
-    }
-    array[i]->setValue(cluster);
-    array[k]->setValue(cluster);
-  }
-}
-
-
 OFCondition DcmQuantColorTable::write(
   DcmItem& target,
   OFBool writeAsOW,
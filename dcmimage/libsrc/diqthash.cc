@@ -24,6 +24,175 @@
 #include "dcmtk/dcmimage/diqthash.h"
 #include "dcmtk/dcmdata/dcxfer.h"      /* for E_TransferSyntax */
 #include "dcmtk/dcmimgle/dcmimage.h"    /* for DicomImage */
+#include "dcmtk/dcmimgle/dithread.h"    /* for DiThreadedLoop */
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"      /* for OFMutex */
+#endif
+
+
+/** helper class counting the colors of a single frame band by band.
+ *  The first band is added to the given hash table directly, all other
+ *  bands are counted in separate hash tables, which are merged into the
+ *  given hash table (in the order of the bands) by finish().  This way,
+ *  the resulting histogram is the same as if the pixels had been counted
+ *  sequentially.
+ */
+class DcmQuantHistogramLoop: public DiThreadedLoop
+{
+public:
+
+  /** constructor
+   *  @param table hash table to which the colors are added
+   *  @param data pointer to the pixels of the frame
+   *  @param cols number of columns of the frame
+   *  @param scaletable scale table applied to the color components
+   *  @param numcolors number of colors already contained in the hash table
+   *  @param maxcolors maximum number of colors allowed
+   */
+  DcmQuantHistogramLoop(
+    DcmQuantColorHashTable& table,
+    const DcmQuantComponent *data,
+    unsigned long cols,
+    const DcmQuantScaleTable& scaletable,
+    unsigned long numcolors,
+    unsigned long maxcolors)
+  : DiThreadedLoop()
+  , table_(table)
+  , data_(data)
+  , columns_(cols)
+  , scaletable_(scaletable)
+  , numcolors_(numcolors)
+  , maxcolors_(maxcolors)
+  , aborted_(OFFalse)
+  , bands_()
+#ifdef WITH_THREADS
+  , mutex_()
+#endif
+  {
+  }
+
+  /// destructor
+  virtual ~DcmQuantHistogramLoop()
+  {
+    for (size_t i = 0; i < bands_.size(); ++i) delete bands_[i].table;
+  }
+
+  /** counts the colors of a band of rows
+   *  @param first index of the first row of the band
+   *  @param count number of rows of the band
+   */
+  virtual void processBand(const unsigned long first, const unsigned long count)
+  {
+    DcmQuantColorHashTable *table = (first == 0) ? &table_ : new DcmQuantColorHashTable();
+    unsigned long colors = (first == 0) ? numcolors_ : 0;
+    const DcmQuantComponent *cp = data_ + first * columns_ * 3;
+    // stop as soon as any band has found too many colors
+    for (unsigned long row = 0; (row < count) && (colors <= maxcolors_) && !isAborted(); ++row)
+    {
+      colors = table->addPixels(cp, columns_, scaletable_, colors, maxcolors_);
+      cp += columns_ * 3;
+    }
+#ifdef WITH_THREADS
+    mutex_.lock();
+#endif
+    if (colors > maxcolors_) aborted_ = OFTrue;
+    if (first == 0)
+      numcolors_ = colors;
+    else
+    {
+      Band band;
+      band.first = first;
+      band.table = table;
+      bands_.push_back(band);
+    }
+#ifdef WITH_THREADS
+    mutex_.unlock();
+#endif
+  }
+
+  /** merges the colors counted by the other bands into the hash table.
+   *  Must be called after process().
+   *  @return number of colors contained in the hash table, greater than
+   *    maxcolors if too many colors have been found.
+   */
+  unsigned long finish()
+  {
+    if (aborted_) numcolors_ = maxcolors_ + 1;
+    while ((numcolors_ <= maxcolors_) && !bands_.empty())
+    {
+      // find the next band in order
+      size_t next = 0;
+      for (size_t i = 1; i < bands_.size(); ++i)
+        if (bands_[i].first < bands_[next].first) next = i;
+      numcolors_ += table_.merge(*bands_[next].table);
+      delete bands_[next].table;
+      bands_.erase(bands_.begin() + next);
+    }
+    return numcolors_;
+  }
+
+private:
+
+  /// helper structure for a band counted in a separate hash table
+  struct Band
+  {
+    /// index of the first row of the band
+    unsigned long first;
+    /// hash table containing the colors of the band
+    DcmQuantColorHashTable *table;
+  };
+
+  /** checks whether any band has found too many colors
+   *  @return OFTrue if too many colors have been found, OFFalse otherwise
+   */
+  OFBool isAborted()
+  {
+#ifdef WITH_THREADS
+    mutex_.lock();
+    const OFBool result = aborted_;
+    mutex_.unlock();
+    return result;
+#else
+    return aborted_;
+#endif
+  }
+
+  /// private undefined copy constructor
+  DcmQuantHistogramLoop(const DcmQuantHistogramLoop& src);
+
+  /// private undefined copy assignment operator
+  DcmQuantHistogramLoop& operator=(const DcmQuantHistogramLoop& src);
+
+  /// hash table to which the colors are added
+  DcmQuantColorHashTable& table_;
+
+  /// pointer to the pixels of the frame
+  const DcmQuantComponent *data_;
+
+  /// number of columns of the frame
+  unsigned long columns_;
+
+  /// scale table applied to the color components
+  const DcmQuantScaleTable& scaletable_;
+
+  /// number of colors contained in the hash table
+  unsigned long numcolors_;
+
+  /// maximum number of colors allowed
+  unsigned long maxcolors_;
+
+  /// flag indicating that a band has found too many colors
+  OFBool aborted_;
+
+  /// bands counted in separate hash tables
+  OFVector<Band> bands_;
+
+#ifdef WITH_THREADS
+  /// mutex protecting access to aborted_ and bands_
+  OFMutex mutex_;
+#endif
+};
 
 
 DcmQuantColorHashTable::DcmQuantColorHashTable()
@@ -62,6 +231,56 @@ unsigned long DcmQuantColorHashTable::createHistogram(DcmQuantHistogramItemPoint
 }
 
 
+unsigned long DcmQuantColorHashTable::merge(DcmQuantColorHashTable& other)
+{
+  unsigned long result = 0;
+  for (size_t i = 0; i < m_Table.size(); ++i)
+  {
+    if (other.m_Table[i])
+    {
+      if (m_Table[i])
+      {
+        result += m_Table[i]->merge(*other.m_Table[i]);
+        delete other.m_Table[i];
+      }
+      else
+      {
+        // take over the complete list
+        m_Table[i] = other.m_Table[i];
+        result += OFstatic_cast(unsigned long, m_Table[i]->size());
+      }
+      other.m_Table[i] = NULL;
+    }
+  }
+  return result;
+}
+
+
+unsigned long DcmQuantColorHashTable::addPixels(
+  const DcmQuantComponent *data,
+  unsigned long count,
+  const DcmQuantScaleTable& scaletable,
+  unsigned long numcolors,
+  unsigned long maxcolors)
+{
+  DcmQuantPixel px;
+  DcmQuantComponent r, g, b;
+  for (unsigned long i = 0; i < count; ++i)
+  {
+    // get pixel
+    r = *data++;
+    g = *data++;
+    b = *data++;
+    px.scale(r, g, b, scaletable);
+
+    // lookup and increase if already in hash table
+    numcolors += item(px).add(px);
+    if (numcolors > maxcolors) break;
+  }
+  return numcolors;
+}
+
+
 unsigned long DcmQuantColorHashTable::addToHashTable(
   DicomImage& image,
   unsigned long newmaxval,
@@ -73,9 +292,6 @@ unsigned long DcmQuantColorHashTable::addToHashTable(
   const int bits = sizeof(DcmQuantComponent)*8;
 
   unsigned long numcolors = 0;
-  unsigned long j, k;
-  const DcmQuantComponent *cp;
-  DcmQuantPixel px;
   const void *data = NULL;
 
   // compute maxval
@@ -85,29 +301,18 @@ unsigned long DcmQuantColorHashTable::addToHashTable(
   DcmQuantScaleTable scaletable;
   scaletable.createTable(maxval, newmaxval);
 
-  DcmQuantComponent r, g, b;
+  // minimum number of rows processed by a single thread
+  const unsigned long minrows = (cols > 0) ? DI_MINIMUM_BAND_SIZE / cols + 1 : 1;
 
   for (unsigned long ff=0; ff<frames; ff++)
   {
     data = image.getOutputData(bits, ff, 0);
     if (data)
     {
-      cp = OFstatic_cast(const DcmQuantComponent *, data);
-      for (j = 0; j < rows; j++)
-      {
-        for (k = 0; k < cols; k++)
-        {
-          // get pixel
-          r = *cp++;
-          g = *cp++;
-          b = *cp++;
-          px.scale(r, g, b, scaletable);
-
-          // lookup and increase if already in hash table
-          numcolors += item(px).add(px);
-          if (numcolors > maxcolors) return 0;
-        }
-      }
+      DcmQuantHistogramLoop loop(*this, OFstatic_cast(const DcmQuantComponent *, data), cols, scaletable, numcolors, maxcolors);
+      loop.process(rows, minrows);
+      numcolors = loop.finish();
+      if (numcolors > maxcolors) return 0;
     }
   }
   return numcolors;
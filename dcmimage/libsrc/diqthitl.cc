@@ -51,3 +51,29 @@ void DcmQuantHistogramItemList::moveto(DcmQuantHistogramItemPointer *array, unsi
     first = list_.erase(first);
   }
 }
+
+
+unsigned long DcmQuantHistogramItemList::merge(DcmQuantHistogramItemList& other)
+{
+  unsigned long result = 0;
+  // process the other list from the back, i.e. in the order the entries were created
+  OFListIterator(DcmQuantHistogramItem *) current = other.list_.end();
+  while (current != other.list_.begin())
+  {
+    --current;
+    first = list_.begin();
+    while ((first != last) && !(*first)->equals(**current)) ++first;
+    if (first != last)
+    {
+      (*first)->setValue((*first)->getValue() + (*current)->getValue());
+      delete *current;
+    }
+    else
+    {
+      list_.push_front(*current);
+      ++result;
+    }
+  }
+  other.list_.clear();
+  return result;
+}
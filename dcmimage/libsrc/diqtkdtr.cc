@@ -0,0 +1,199 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimage
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmQuantKDTree
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/ofstd/ofcast.h"
+#include "dcmtk/dcmimage/diqtkdtr.h"  /* for DcmQuantKDTree */
+#include "dcmtk/ofstd/ofstdinc.h"
+
+// Solaris defines qsort() in namespace std, other compilers don't...
+using STD_NAMESPACE qsort;
+
+/* ------------------------------------------------------------ */
+
+// static comparison functions for qsort
+
+BEGIN_EXTERN_C
+static int redcompare(const void *x1, const void *x2)
+{
+  return OFstatic_cast(const DcmQuantKDTreeNode *, x1)->color[0]
+       - OFstatic_cast(const DcmQuantKDTreeNode *, x2)->color[0];
+}
+
+static int greencompare(const void *x1, const void *x2)
+{
+  return OFstatic_cast(const DcmQuantKDTreeNode *, x1)->color[1]
+       - OFstatic_cast(const DcmQuantKDTreeNode *, x2)->color[1];
+}
+
+static int bluecompare(const void *x1, const void *x2)
+{
+  return OFstatic_cast(const DcmQuantKDTreeNode *, x1)->color[2]
+       - OFstatic_cast(const DcmQuantKDTreeNode *, x2)->color[2];
+}
+END_EXTERN_C
+
+/* ------------------------------------------------------------ */
+
+DcmQuantKDTree::DcmQuantKDTree()
+: nodes(NULL)
+, splitAxis(NULL)
+, splitValue(NULL)
+, numNodes(0)
+{
+}
+
+
+DcmQuantKDTree::~DcmQuantKDTree()
+{
+  clear();
+}
+
+
+void DcmQuantKDTree::clear()
+{
+  delete[] nodes;
+  delete[] splitAxis;
+  delete[] splitValue;
+  nodes = NULL;
+  splitAxis = NULL;
+  splitValue = NULL;
+  numNodes = 0;
+}
+
+
+void DcmQuantKDTree::build(const DcmQuantHistogramItemPointer *array, unsigned long numColors)
+{
+  clear();
+  if (array && (numColors > 0))
+  {
+    nodes = new DcmQuantKDTreeNode[numColors];
+    splitAxis = new int[numColors];
+    splitValue = new int[numColors];
+    numNodes = numColors;
+    for (unsigned long i = 0; i < numColors; ++i)
+    {
+      nodes[i].color[0] = OFstatic_cast(int, array[i]->getRed());
+      nodes[i].color[1] = OFstatic_cast(int, array[i]->getGreen());
+      nodes[i].color[2] = OFstatic_cast(int, array[i]->getBlue());
+      nodes[i].index = OFstatic_cast(int, i);
+      splitAxis[i] = 0;
+      splitValue[i] = 0;
+    }
+    buildSubtree(0, numNodes);
+  }
+}
+
+
+void DcmQuantKDTree::buildSubtree(unsigned long lo, unsigned long hi)
+{
+  if (hi - lo <= DcmQuantKDTreeBucketSize) return;
+
+  // find the color component with the largest range, and sort by that component
+  int minc[3], maxc[3];
+  int c;
+  for (c = 0; c < 3; ++c) minc[c] = maxc[c] = nodes[lo].color[c];
+  for (unsigned long i = lo + 1; i < hi; ++i)
+  {
+    for (c = 0; c < 3; ++c)
+    {
+      if (nodes[i].color[c] < minc[c]) minc[c] = nodes[i].color[c];
+      if (nodes[i].color[c] > maxc[c]) maxc[c] = nodes[i].color[c];
+    }
+  }
+  int axis = 0;
+  if (maxc[1] - minc[1] > maxc[axis] - minc[axis]) axis = 1;
+  if (maxc[2] - minc[2] > maxc[axis] - minc[axis]) axis = 2;
+  if (axis == 0)
+    qsort(OFreinterpret_cast(char *, nodes + lo), hi - lo, sizeof(DcmQuantKDTreeNode), redcompare);
+  else if (axis == 1)
+    qsort(OFreinterpret_cast(char *, nodes + lo), hi - lo, sizeof(DcmQuantKDTreeNode), greencompare);
+  else
+    qsort(OFreinterpret_cast(char *, nodes + lo), hi - lo, sizeof(DcmQuantKDTreeNode), bluecompare);
+
+  // the median splits the range into two subtrees
+  const unsigned long mid = (lo + hi) / 2;
+  splitAxis[mid] = axis;
+  splitValue[mid] = nodes[mid].color[axis];
+  buildSubtree(lo, mid);
+  buildSubtree(mid, hi);
+}
+
+
+int DcmQuantKDTree::search(const int *color) const
+{
+  // subtrees still to be searched, with the squared distance of the color to the subtree
+  unsigned long stackLo[64];
+  unsigned long stackHi[64];
+  long stackDist[64];
+  int depth = 0;
+  long dist = 2000000000;
+  int index = -1;
+
+  stackLo[0] = 0;
+  stackHi[0] = numNodes;
+  stackDist[0] = 0;
+  ++depth;
+  while (depth > 0)
+  {
+    --depth;
+    // skip the subtree if it cannot contain a closer match (on equal distance, the lower index wins)
+    if (stackDist[depth] > dist) continue;
+    unsigned long lo = stackLo[depth];
+    unsigned long hi = stackHi[depth];
+
+    // descend to the bucket containing the color, remember the other halves
+    while (hi - lo > DcmQuantKDTreeBucketSize)
+    {
+      const unsigned long mid = (lo + hi) / 2;
+      const long diff = color[splitAxis[mid]] - splitValue[mid];
+      if (diff < 0)
+      {
+        stackLo[depth] = mid;
+        stackHi[depth] = hi;
+        hi = mid;
+      }
+      else
+      {
+        stackLo[depth] = lo;
+        stackHi[depth] = mid;
+        lo = mid;
+      }
+      stackDist[depth++] = diff * diff;
+    }
+
+    // search the bucket linearly
+    for (unsigned long i = lo; i < hi; ++i)
+    {
+      const long r = color[0] - nodes[i].color[0];
+      const long g = color[1] - nodes[i].color[1];
+      const long b = color[2] - nodes[i].color[2];
+      const long newdist = r*r + g*g + b*b;
+      if ((newdist < dist) || ((newdist == dist) && (nodes[i].index < index)))
+      {
+        dist = newdist;
+        index = nodes[i].index;
+      }
+    }
+  }
+  return index;
+}
@@ -29,6 +29,7 @@
 #include "dcmtk/dcmimage/diqthash.h"  /* for DcmQuantColorHashTable */
 #include "dcmtk/dcmimage/diqtctab.h"  /* for DcmQuantColorTable */
 #include "dcmtk/dcmimage/diqtfs.h"    /* for DcmQuantFloydSteinberg */
+#include "dcmtk/dcmimage/diqtod.h"    /* for DcmQuantOrderedDither */
 #include "dcmtk/dcmimage/dilogger.h"  /* for logging macros */
 #include "dcmtk/dcmdata/dcswap.h"     /* for swapIfNecessary() */
 #include "dcmtk/dcmdata/dcitem.h"     /* for DcmItem */
@@ -50,6 +51,23 @@ OFCondition DcmQuant::createPaletteColorImage(
     OFString& description,
     DcmLargestDimensionType largeType,
     DcmRepresentativeColorType repType)
+{
+    return createPaletteColorImage(sourceImage, target, writeAsOW, write16BitEntries,
+      floydSteinberg ? DcmDitheringType_floydSteinberg : DcmDitheringType_none,
+      numberOfColors, description, largeType, repType);
+}
+
+
+OFCondition DcmQuant::createPaletteColorImage(
+    DicomImage& sourceImage,
+    DcmItem& target,
+    OFBool writeAsOW,
+    OFBool write16BitEntries,
+    DcmDitheringType dithering,
+    Uint32 numberOfColors,
+    OFString& description,
+    DcmLargestDimensionType largeType,
+    DcmRepresentativeColorType repType)
 {
     // make sure we're operating on a color image
     if (sourceImage.isMonochrome()) return EC_IllegalCall;
@@ -87,12 +105,13 @@ OFCondition DcmQuant::createPaletteColorImage(
     DCMIMAGE_DEBUG("mapping image data to color table");
 
     DcmQuantFloydSteinberg fs;
-    if (floydSteinberg)
+    if (dithering == DcmDitheringType_floydSteinberg)
     {
       result = fs.initialize(cols);
       if (result.bad()) return result;
     }
     DcmQuantIdent id(cols);
+    DcmQuantOrderedDither od(cols, maxval, colormap.getColors());
 
     OFBool isByteData = (numberOfColors <= 256);
 
@@ -118,15 +137,19 @@ OFCondition DcmQuant::createPaletteColorImage(
             {
               if (isByteData)
               {
-                if (floydSteinberg)
+                if (dithering == DcmDitheringType_floydSteinberg)
                   DcmQuantColorMapping<DcmQuantFloydSteinberg,Uint8>::create(sourceImage, ff, maxval, cht, colormap, fs, imageData8  + cols*rows*ff);
-                  else DcmQuantColorMapping<DcmQuantIdent,    Uint8>::create(sourceImage, ff, maxval, cht, colormap, id, imageData8  + cols*rows*ff);
+                else if (dithering == DcmDitheringType_ordered)
+                  DcmQuantColorMapping<DcmQuantOrderedDither, Uint8>::createInParallel(sourceImage, ff, maxval, colormap, od, imageData8  + cols*rows*ff);
+                  else DcmQuantColorMapping<DcmQuantIdent,    Uint8>::createInParallel(sourceImage, ff, maxval, colormap, id, imageData8  + cols*rows*ff);
               }
               else
               {
-                if (floydSteinberg)
+                if (dithering == DcmDitheringType_floydSteinberg)
                   DcmQuantColorMapping<DcmQuantFloydSteinberg,Uint16>::create(sourceImage, ff, maxval, cht, colormap, fs, imageData16 + cols*rows*ff);
-                  else DcmQuantColorMapping<DcmQuantIdent,    Uint16>::create(sourceImage, ff, maxval, cht, colormap, id, imageData16 + cols*rows*ff);
+                else if (dithering == DcmDitheringType_ordered)
+                  DcmQuantColorMapping<DcmQuantOrderedDither, Uint16>::createInParallel(sourceImage, ff, maxval, colormap, od, imageData16 + cols*rows*ff);
+                  else DcmQuantColorMapping<DcmQuantIdent,    Uint16>::createInParallel(sourceImage, ff, maxval, colormap, id, imageData16 + cols*rows*ff);
              }
             } // for all frames
 
@@ -74,6 +74,32 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
                const unsigned long fstart = 0,
                const unsigned long fcount = 0);
 
+    /** constructor, open a DICOM file and process a region of interest only.
+     *  Only the pixels within the specified region of each frame are converted to the internal
+     *  representation (and read from file if CIF_UsePartialAccessToPixelData is set), i.e. the
+     *  resulting image is the same as the one created by createClippedImage() on the complete
+     *  image but requires less memory and time for large images.  The region is restricted to
+     *  the image area.  For color images, the complete frames are converted and clipped afterwards.
+     *
+     ** @param  filename  the DICOM file specified by its filename
+     *  @param  flags     configuration flags (see diutils.h, CIF_MayDetachPixelData is set automatically)
+     *  @param  fstart    first frame to be processed (0 = 1st frame), all subsequent use
+     *                    of parameters labeled 'frame' in this class refers to this start frame.
+     *  @param  fcount    number of frames (0 = all frames)
+     *  @param  left_pos  x coordinate of the top left corner of the region
+     *  @param  top_pos   y coordinate of the top left corner of the region
+     *  @param  width     width of the region (0 = up to the right image border)
+     *  @param  height    height of the region (0 = up to the bottom image border)
+     */
+    DicomImage(const OFFilename &filename,
+               const unsigned long flags,
+               const unsigned long fstart,
+               const unsigned long fcount,
+               const unsigned long left_pos,
+               const unsigned long top_pos,
+               const unsigned long width,
+               const unsigned long height);
+
 #ifndef STARVIEW
     /** constructor, use a given DcmObject
      *
@@ -94,6 +120,35 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
                const unsigned long fstart = 0,
                const unsigned long fcount = 0);
 
+    /** constructor, use a given DcmObject and process a region of interest only.
+     *  Only the pixels within the specified region of each frame are converted to the internal
+     *  representation, see the corresponding constructor for DICOM files for details.
+     *
+     ** @param  object    pointer to DICOM data structures (fileformat, dataset or item).
+     *                    (do not delete while referenced, i.e. while this image object or any
+     *                     descendant exists; not deleted within dcmimage unless configuration flag
+     *                     CIF_TakeOverExternalDataset is set - in this case do not delete it at all)
+     *  @param  xfer      transfer syntax of the 'object'.
+     *                    (could also be EXS_Unknown in case of fileformat or dataset)
+     *  @param  flags     configuration flags (CIF_xxx, see diutils.h)
+     *  @param  fstart    first frame to be processed (0 = 1st frame), all subsequent use
+     *                    of parameters labeled 'frame' in this class refers to this start frame.
+     *  @param  fcount    number of frames (0 = all frames)
+     *  @param  left_pos  x coordinate of the top left corner of the region
+     *  @param  top_pos   y coordinate of the top left corner of the region
+     *  @param  width     width of the region (0 = up to the right image border)
+     *  @param  height    height of the region (0 = up to the bottom image border)
+     */
+    DicomImage(DcmObject *object,
+               const E_TransferSyntax xfer,
+               const unsigned long flags,
+               const unsigned long fstart,
+               const unsigned long fcount,
+               const unsigned long left_pos,
+               const unsigned long top_pos,
+               const unsigned long width,
+               const unsigned long height);
+
     /** constructor, use a given DcmObject with specified rescale/slope.
      *  NB: This constructor ignores the Photometric Interpretation stored in the DICOM dataset
      *      and always creates a MONOCHROME2 image - useful in combination with Presentation States.
@@ -576,6 +631,37 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
             Image->getMonoImagePtr()->deleteDisplayLUT(bits) : 0;
     }
 
+    /** set maximum size of the render cache.
+     *  The render cache keeps the LUTs used for rendering (combining the VOI, presentation
+     *  and display transformation) as well as the output buffer, so that rendering the image
+     *  again with previously used parameters (e.g. switching between some VOI windows) only
+     *  requires a single lookup pass over the pixel data.  The cache is disabled by default.
+     *  The cached LUTs also depend on the parameters of the display function (e.g. the
+     *  ambient light value), so modifying the display function in place is supported.
+     *  deleteDisplayLUT() and selecting another display function clear the cache.
+     *  Only applicable to monochrome images.
+     *
+     ** @param  size  maximum size of the cached data in bytes (0 = disable cache)
+     *
+     ** @return true if successful, false otherwise
+     */
+    inline int setRenderCacheSize(const unsigned long size)
+    {
+        return ((Image != NULL) && (Image->getMonoImagePtr() != NULL)) ?
+            Image->getMonoImagePtr()->setRenderCacheSize(size) : 0;
+    }
+
+    /** get maximum size of the render cache.
+     *  Only applicable to monochrome images.
+     *
+     ** @return maximum size of the cached data in bytes (0 = cache disabled)
+     */
+    inline unsigned long getRenderCacheSize() const
+    {
+        return ((Image != NULL) && (Image->getMonoImagePtr() != NULL)) ?
+            Image->getMonoImagePtr()->getRenderCacheSize() : 0;
+    }
+
     /** convert P-value to DDL.
      *  conversion uses display LUT if present, linear scaling otherwise.
      *
@@ -1376,7 +1462,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate  specifies whether scaling algorithm should use interpolation (if necessary).
      *                       default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                         1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                         4 = bicubic magnification
+     *                         4 = bicubic magnification, 5 = box filter, 6 = bilinear filter,
+     *                         7 = Lanczos filter
      *  @param  aspect       specifies whether pixel aspect ratio should be taken into consideration
      *                       (if true, width OR height should be 0, i.e. this component will be calculated
      *                        automatically)
@@ -1396,7 +1483,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate  specifies whether scaling algorithm should use interpolation (if necessary).
      *                       default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                         1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                         4 = bicubic magnification
+     *                         4 = bicubic magnification, 5 = box filter, 6 = bilinear filter,
+     *                         7 = Lanczos filter
      *  @param  aspect       specifies whether pixel aspect ratio should be taken into consideration
      *                       (if true, width OR height should be 0, i.e. this component will be calculated
      *                        automatically)
@@ -1422,7 +1510,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
      *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                          4 = bicubic magnification
+     *                          4 = bicubic magnification, 5 = box filter, 6 = bilinear filter,
+     *                          7 = Lanczos filter
      *  @param  aspect        specifies whether pixel aspect ratio should be taken into consideration
      *                        (if true, width OR height should be 0, i.e. this component will be calculated
      *                         automatically)
@@ -1454,7 +1543,8 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      *  @param  interpolate  specifies whether scaling algorithm should use interpolation (if necessary).
      *                       default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                         1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                         4 = bicubic magnification
+     *                         4 = bicubic magnification, 5 = box filter, 6 = bilinear filter,
+     *                         7 = Lanczos filter
      *  @param  aspect       specifies whether pixel aspect ratio should be taken into consideration
      *                       (if true, width OR height should be 0, i.e. this component will be calculated
      *                        automatically)
@@ -1847,6 +1937,24 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
                           const char *filename,
                           const unsigned long frame = 0);
 
+    /** write multiple frames to pluggable image format files (specified by filename).
+     *  Format specific parameters may be set directly in the instantiated 'plugin' class.
+     *  Depending on the plugin, the frames are encoded in parallel (see DiPluginFormat::writeFrames()).
+     *
+     ** @param  plugin    pointer to image format plugin (derived from abstract class DiPluginFormat)
+     *  @param  filename  name of output files (%lu is replaced by frame index plus 'fnumber')
+     *  @param  fstart    index of the first frame used for output
+     *  @param  fcount    number of frames used for output (0 = all remaining frames)
+     *  @param  fnumber   value added to the frame index when generating the filenames
+     *
+     ** @return true if successful, false otherwise
+     */
+    int writePluginFormat(const DiPluginFormat *plugin,
+                          const char *filename,
+                          const unsigned long fstart,
+                          const unsigned long fcount,
+                          const unsigned long fnumber = 0);
+
 
  protected:
 
@@ -1865,6 +1973,20 @@ class DCMTK_DCMIMGLE_EXPORT DicomImage
      */
     void Init();
 
+    /** initialize object for a region of interest.
+     *  set region of the document, create internal image object (see Init()) and clip it to the
+     *  region if the internal image object does not support processing of the region itself.
+     *
+     ** @param  left_pos  x coordinate of the top left corner of the region
+     *  @param  top_pos   y coordinate of the top left corner of the region
+     *  @param  width     width of the region (0 = up to the right image border)
+     *  @param  height    height of the region (0 = up to the bottom image border)
+     */
+    void Init(const unsigned long left_pos,
+              const unsigned long top_pos,
+              const unsigned long width,
+              const unsigned long height);
+
     /** check whether data dictionary is present
      *
      ** @return true if dictionary is present, false otherwise
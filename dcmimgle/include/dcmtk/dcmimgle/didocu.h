@@ -135,6 +135,67 @@ class DCMTK_DCMIMGLE_EXPORT DiDocument
         return FrameCount;
     }
 
+    /** set region of interest, i.e.\ the rectangular area of each frame to be processed.
+     *  The region is restricted to the image area given by the attributes Columns and Rows.
+     *  Please note that the region is only stored for later use.
+     *
+     ** @param  left_pos  x coordinate of the top left corner of the region
+     *  @param  top_pos   y coordinate of the top left corner of the region
+     *  @param  width     width of the region (0 = up to the right image border)
+     *  @param  height    height of the region (0 = up to the bottom image border)
+     *
+     ** @return status, true if successful, false otherwise (e.g. region outside the image)
+     */
+    int setRegion(const unsigned long left_pos,
+                  const unsigned long top_pos,
+                  unsigned long width,
+                  unsigned long height);
+
+    /** check whether a region of interest has been set
+     *
+     ** @return true if a region of interest has been set, false otherwise
+     */
+    inline int hasRegion() const
+    {
+        return (RegionWidth > 0) && (RegionHeight > 0);
+    }
+
+    /** get x coordinate of the top left corner of the region of interest
+     *
+     ** @return x coordinate of the region of interest
+     */
+    inline Uint16 getRegionLeft() const
+    {
+        return RegionLeft;
+    }
+
+    /** get y coordinate of the top left corner of the region of interest
+     *
+     ** @return y coordinate of the region of interest
+     */
+    inline Uint16 getRegionTop() const
+    {
+        return RegionTop;
+    }
+
+    /** get width of the region of interest
+     *
+     ** @return width of the region of interest (0 = no region set)
+     */
+    inline Uint16 getRegionWidth() const
+    {
+        return RegionWidth;
+    }
+
+    /** get height of the region of interest
+     *
+     ** @return height of the region of interest (0 = no region set)
+     */
+    inline Uint16 getRegionHeight() const
+    {
+        return RegionHeight;
+    }
+
     /** get configuration flags
      *
      ** @return configuration flags
@@ -405,6 +466,15 @@ class DCMTK_DCMIMGLE_EXPORT DiDocument
     /// number of frames to be processed
     unsigned long FrameCount;
 
+    /// x coordinate of the region of interest
+    Uint16 RegionLeft;
+    /// y coordinate of the region of interest
+    Uint16 RegionTop;
+    /// width of the region of interest (0 = no region)
+    Uint16 RegionWidth;
+    /// height of the region of interest (0 = no region)
+    Uint16 RegionHeight;
+
     /// configuration flags
     unsigned long Flags;
 
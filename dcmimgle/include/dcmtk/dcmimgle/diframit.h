@@ -0,0 +1,236 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomImageFrameIterator (Header)
+ *
+ */
+
+
+#ifndef DIFRAMIT_H
+#define DIFRAMIT_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmdata/dcxfer.h"
+#include "dcmtk/ofstd/offname.h"
+
+#include "dcmtk/dcmimgle/diutils.h"
+
+
+/*------------------------*
+ *  forward declarations  *
+ *------------------------*/
+
+class DcmObject;
+class DcmFileFormat;
+class DicomImage;
+class DiFramePrefetcher;
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Class iterating over the frames of a (large) multi-frame image.
+ *  Each call of next() returns a DicomImage object that contains the next couple of
+ *  frames (see parameter 'fstep' of the constructors).  The pixel data is accessed
+ *  partially (see CIF_UsePartialAccessToPixelData), i.e. only the frames of the current
+ *  step are read from file and decompressed, so that at most two steps of frames are
+ *  resident at a time: the one returned by next() and the one prepared for the next call.
+ *  If the iterator has been created for a DICOM file and prefetching is enabled, the
+ *  subsequent step is prepared (read, decompressed and converted to the internal
+ *  representation) by a background thread while the caller processes the current one.
+ *  For this purpose, the file is opened twice, so that the two threads never access the
+ *  same DICOM dataset.  Monochrome and color images are supported (the latter requires
+ *  module dcmimage, see diregist.h).
+ *  Please note that functions evaluating the pixel data of all frames (e.g. setMinMaxWindow()
+ *  or setHistogramWindow()) only refer to the frames of the current step.
+ *  NB: The returned DicomImage objects are owned by the iterator.  The DICOM dataset
+ *      referenced by an image must not be accessed while the iterator exists, since it
+ *      might be in use by the background thread.
+ */
+class DCMTK_DCMIMGLE_EXPORT DicomImageFrameIterator
+{
+
+ public:
+
+    /** constructor, open a DICOM file.
+     *  The first step of frames is created immediately, use getStatus() to obtain
+     *  detailed information about any errors.
+     *
+     ** @param  filename  the DICOM file specified by its filename
+     *  @param  flags     configuration flags (CIF_xxx, see diutils.h).  CIF_UsePartialAccessToPixelData
+     *                    is set automatically, CIF_DecompressCompletePixelData and
+     *                    CIF_TakeOverExternalDataset are ignored.
+     *  @param  fstart    first frame to be processed (0 = 1st frame)
+     *  @param  fcount    number of frames to be processed (0 = all subsequent frames)
+     *  @param  fstep     number of frames contained in each image returned by next()
+     *  @param  prefetch  prepare the next step of frames in a background thread if OFTrue
+     *                    (only available if DCMTK has been compiled with thread support)
+     */
+    DicomImageFrameIterator(const OFFilename &filename,
+                            const unsigned long flags = 0,
+                            const unsigned long fstart = 0,
+                            const unsigned long fcount = 0,
+                            const unsigned long fstep = 1,
+                            const OFBool prefetch = OFTrue);
+
+    /** constructor, use a given DcmObject.
+     *  Since the DICOM dataset cannot be shared between threads, the frames are always
+     *  created in the calling thread (i.e. within next()) in this case.
+     *
+     ** @param  object  pointer to DICOM data structures (fileformat or dataset).
+     *                  (do not delete while referenced, i.e. while this iterator exists)
+     *  @param  xfer    transfer syntax of the 'object'.
+     *                  (could also be EXS_Unknown in case of fileformat or dataset)
+     *  @param  flags   configuration flags (see above)
+     *  @param  fstart  first frame to be processed (0 = 1st frame)
+     *  @param  fcount  number of frames to be processed (0 = all subsequent frames)
+     *  @param  fstep   number of frames contained in each image returned by next()
+     */
+    DicomImageFrameIterator(DcmObject *object,
+                            const E_TransferSyntax xfer,
+                            const unsigned long flags = 0,
+                            const unsigned long fstart = 0,
+                            const unsigned long fcount = 0,
+                            const unsigned long fstep = 1);
+
+    /** destructor.
+     *  Waits for the background thread (if any) and deletes all images created by this
+     *  iterator.
+     */
+    virtual ~DicomImageFrameIterator();
+
+    /** get next step of frames.
+     *  The image returned by the previous call of this function is deleted.
+     *
+     ** @return pointer to image containing the next frames (owned by the iterator and valid
+     *          until the next call), NULL if all frames have been processed or an error
+     *          occurred (see getStatus())
+     */
+    DicomImage *next();
+
+    /** get status of the iterator
+     *
+     ** @return status of the iterator (EIS_Normal if no error occurred)
+     */
+    inline EI_Status getStatus() const
+    {
+        return Status;
+    }
+
+    /** get number of frames processed by this iterator.
+     *  This refers to the frames specified by the parameters 'fstart' and 'fcount' of
+     *  the constructor, not to the number of frames stored in the DICOM file/dataset.
+     *
+     ** @return number of frames to be processed
+     */
+    inline unsigned long getFrameCount() const
+    {
+        return EndFrame - StartFrame;
+    }
+
+    /** get index of the first frame that has not been returned by next() yet
+     *
+     ** @return index of the next frame (0..n-1)
+     */
+    inline unsigned long getNextFrame() const
+    {
+        return NextFrame;
+    }
+
+    /** create an image containing the given frames (called by the background thread).
+     *  If required, the DICOM file is loaded into the given slot first.
+     *
+     ** @param  slot    index of the fileformat slot (0 or 1) to be used
+     *  @param  fstart  first frame to be processed
+     *  @param  fcount  number of frames to be processed
+     *
+     ** @return pointer to new image (maybe NULL if the file could not be loaded)
+     */
+    DicomImage *createImage(const int slot,
+                            const unsigned long fstart,
+                            const unsigned long fcount);
+
+
+ protected:
+
+    /** initialize the iterator, i.e. create the first image
+     *
+     ** @param  fstart  first frame to be processed
+     *  @param  fcount  number of frames to be processed (0 = all subsequent frames)
+     */
+    void init(const unsigned long fstart,
+              const unsigned long fcount);
+
+    /** get number of frames for the image starting with the given frame
+     *
+     ** @param  fstart  first frame of the image
+     *
+     ** @return number of frames (at most the step size)
+     */
+    unsigned long getStepCount(const unsigned long fstart) const;
+
+    /** wait for the background thread (if any) and take over the image it created
+     */
+    void waitForPrefetch();
+
+
+ private:
+
+    /// name of the DICOM file (empty if created for a DcmObject)
+    OFFilename Filename;
+    /// fileformat slots used alternately for the images (file-based iterator only)
+    DcmFileFormat *FileFormat[2];
+    /// DICOM object (object-based iterator only)
+    DcmObject *Object;
+    /// transfer syntax of the DICOM object
+    E_TransferSyntax Xfer;
+    /// configuration flags used for the images
+    const unsigned long Flags;
+    /// number of frames per step
+    const unsigned long FrameStep;
+    /// prepare the next step in a background thread
+    const OFBool Prefetch;
+
+    /// index of the first frame to be processed
+    unsigned long StartFrame;
+    /// index of the frame after the last one to be processed
+    unsigned long EndFrame;
+    /// index of the first frame not yet returned by next()
+    unsigned long NextFrame;
+    /// fileformat slot to be used for the next image
+    int Slot;
+
+    /// image returned by the last call of next()
+    DicomImage *CurrentImage;
+    /// image prepared for the next call of next()
+    DicomImage *NextImage;
+    /// background thread preparing the next image (maybe NULL)
+    DiFramePrefetcher *Prefetcher;
+
+    /// status of the iterator
+    EI_Status Status;
+
+ // --- declarations to avoid compiler warnings
+
+    DicomImageFrameIterator(const DicomImageFrameIterator &);
+    DicomImageFrameIterator &operator=(const DicomImageFrameIterator &);
+};
+
+
+#endif
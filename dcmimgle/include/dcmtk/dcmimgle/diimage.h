@@ -72,10 +72,13 @@ class DCMTK_DCMIMGLE_EXPORT DiImage
      ** @param  docu    pointer to the DICOM document
      *  @param  status  status of the image object
      *  @param  spp     samples per pixel
+     *  @param  region  process only the region of interest of the document (if any).
+     *                  Requires one sample per pixel, i.e. is not supported for color images.
      */
     DiImage(const DiDocument *docu,
             const EI_Status status,
-            const int spp);
+            const int spp,
+            const OFBool region = OFFalse);
 
     /** destructor
      */
@@ -354,7 +357,8 @@ class DCMTK_DCMIMGLE_EXPORT DiImage
      *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
      *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                          4 = bicubic magnification
+     *                          4 = bicubic magnification, 5 = box filter, 6 = bilinear filter,
+     *                          7 = Lanczos filter
      *  @param  aspect        specifies whether pixel aspect ratio should be taken into consideration
      *                        (if true, width OR height should be 0, i.e. this component will be calculated
      *                         automatically)
@@ -665,6 +669,15 @@ class DCMTK_DCMIMGLE_EXPORT DiImage
     /// current pixel item fragment (for encapsulated pixel data)
     Uint32 CurrentFragment;
 
+    /// number of rows of the frames stored in the dataset (differs from 'Rows' if a region is processed)
+    Uint16 StoredRows;
+    /// number of columns of the frames stored in the dataset (differs from 'Columns' if a region is processed)
+    Uint16 StoredColumns;
+    /// x coordinate of the processed region within the stored frames
+    Uint16 RegionLeft;
+    /// y coordinate of the processed region within the stored frames
+    Uint16 RegionTop;
+
  // --- declarations to avoid compiler warnings
 
     DiImage(const DiImage &);
@@ -87,6 +87,26 @@ static inline Sint32 expandSign(const Sint32 Value,
 }
 
 
+template<class T>
+static inline void getMinMaxValue(const T *p,
+                                  unsigned long count,
+                                  T &minValue,
+                                  T &maxValue)
+{
+    /* the loop does not contain any branches, so that it can be vectorized by the compiler */
+    T minVal = *p;
+    T maxVal = *p;
+    for (; count != 0; --count)
+    {
+        const T value = *(p++);
+        minVal = (value < minVal) ? value : minVal;
+        maxVal = (value > maxVal) ? value : maxVal;
+    }
+    minValue = minVal;
+    maxValue = maxVal;
+}
+
+
 static Uint32 getPixelData(DcmPixelData *PixelData,
                            Uint8 *&pixel)
 {
@@ -128,6 +148,11 @@ class DiInputPixelTemplate
      *  @param  fsize      number of pixels per frame (frame size)
      *  @param  fileCache  pointer to file cache object used for partial read
      *  @param  fragment   current pixel item fragment (for encapsulated pixel data)
+     *  @param  columns    width of the stored frames (only required if a region is given, one sample per pixel)
+     *  @param  left_pos   x coordinate of the top left corner of the region to be processed
+     *  @param  top_pos    y coordinate of the top left corner of the region to be processed
+     *  @param  src_cols   width of the region to be processed (0 = complete frames)
+     *  @param  src_rows   height of the region to be processed (0 = complete frames)
      */
     DiInputPixelTemplate(const DiDocument *document,
                          const Uint16 alloc,
@@ -137,7 +162,12 @@ class DiInputPixelTemplate
                          const unsigned long number,
                          const unsigned long fsize,
                          DcmFileCache *fileCache,
-                         Uint32 &fragment)
+                         Uint32 &fragment,
+                         const Uint16 columns = 0,
+                         const Uint16 left_pos = 0,
+                         const Uint16 top_pos = 0,
+                         const Uint16 src_cols = 0,
+                         const Uint16 src_rows = 0)
       : DiInputPixel(stored, first, number, fsize),
         Data(NULL)
     {
@@ -154,7 +184,14 @@ class DiInputPixelTemplate
             AbsMaximum = OFstatic_cast(double, DicomImageClass::maxval(Bits));
         }
         if ((document != NULL) && (document->getPixelData() != NULL))
-            convert(document, alloc, stored, high, fileCache, fragment);
+        {
+            if ((columns > 0) && (src_cols > 0) && (src_rows > 0) && (left_pos + src_cols <= columns) &&
+                (OFstatic_cast(unsigned long, top_pos + src_rows) * columns <= fsize))
+            {
+                convertRegion(document, alloc, stored, high, fileCache, fragment, columns, left_pos, top_pos, src_cols, src_rows);
+            } else
+                convert(document, alloc, stored, high, fileCache, fragment);
+        }
         if ((PixelCount == 0) || (PixelStart + PixelCount > Count))         // check for corrupt pixel length
         {
             PixelCount = Count - PixelStart;
@@ -169,10 +206,9 @@ class DiInputPixelTemplate
         operator delete[] (Data, std::nothrow);
     }
 
-#include DCMTK_DIAGNOSTIC_PUSH
-#include DCMTK_DIAGNOSTIC_IGNORE_CONST_EXPRESSION_WARNING
-
-    /** determine minimum and maximum pixel value
+    /** determine minimum and maximum pixel value.
+     *  The pixels before and after the selected range (if any) are only evaluated for
+     *  the global values, i.e. each pixel is accessed once.
      *
      ** @return status, true if successful, false otherwise
      */
@@ -181,111 +217,43 @@ class DiInputPixelTemplate
         if (Data != NULL)
         {
             DCMIMGLE_DEBUG("determining minimum and maximum pixel values for input data");
-            T2 *p = Data;
-            unsigned long i;
-            const double absrange = getAbsMaxRange();
-            const double absmin = getAbsMinimum();
-            const unsigned long ocnt = (absrange <= 10000000.0) ? OFstatic_cast(unsigned long, absrange) : 0 /* no LUT */;
-            Uint8 *lut = NULL;
-            if ((sizeof(T2) <= 2) && (ocnt > 0) && (Count > 3 * ocnt)) // optimization criteria
+            const unsigned long first = (PixelStart < Count) ? PixelStart : Count;
+            const unsigned long last = (PixelCount < Count - first) ? first + PixelCount : Count;
+            if ((first < last) && ((first > 0) || (last < Count)))
             {
-                lut = new Uint8[ocnt];
-                if (lut != NULL)
+                T2 minValue;
+                T2 maxValue;
+                getMinMaxValue(Data + first, last - first, MinValue[1], MaxValue[1]);
+                MinValue[0] = MinValue[1];
+                MaxValue[0] = MaxValue[1];
+                if (first > 0)                                         // pixels before selected range
                 {
-                    DCMIMGLE_DEBUG("using optimized routine with additional LUT");
-                    OFBitmanipTemplate<Uint8>::zeroMem(lut, ocnt);
-                    Uint8 *q = lut - OFstatic_cast(T2, absmin);
-                    for (i = Count; i != 0; --i)                       // fill lookup table
-                        *(q + *(p++)) = 1;
-                    q = lut;
-                    for (i = 0; i < ocnt; ++i)                         // search for minimum
-                    {
-                        if (*(q++) != 0)
-                        {
-                            MinValue[0] = OFstatic_cast(T2, OFstatic_cast(double, i) + absmin);
-                            break;
-                        }
-                    }
-                    q = lut + ocnt;
-                    for (i = ocnt; i != 0; --i)                        // search for maximum
-                    {
-                        if (*(--q) != 0)
-                        {
-                            MaxValue[0] = OFstatic_cast(T2, OFstatic_cast(double, i - 1) + absmin);
-                            break;
-                        }
-                    }
-                    if (Count >= PixelCount)                           // use global min/max value
-                    {
-                        MinValue[1] = MinValue[0];
-                        MaxValue[1] = MaxValue[0];
-                    } else {                                           // calculate min/max for selected range
-                        OFBitmanipTemplate<Uint8>::zeroMem(lut, ocnt);
-                        p = Data + PixelStart;
-                        q = lut - OFstatic_cast(T2, absmin);
-                        for (i = PixelCount; i != 0; --i)              // fill lookup table
-                            *(q + *(p++)) = 1;
-                        q = lut;
-                        for (i = 0; i < ocnt; ++i)                     // search for minimum
-                        {
-                            if (*(q++) != 0)
-                            {
-                                MinValue[1] = OFstatic_cast(T2, OFstatic_cast(double, i) + absmin);
-                                break;
-                            }
-                        }
-                        q = lut + ocnt;
-                        for (i = ocnt; i != 0; --i)                    // search for maximum
-                        {
-                            if (*(--q) != 0)
-                            {
-                                MaxValue[1] = OFstatic_cast(T2, OFstatic_cast(double, i - 1) + absmin);
-                                break;
-                            }
-                        }
-                    }
+                    getMinMaxValue(Data, first, minValue, maxValue);
+                    if (minValue < MinValue[0])
+                        MinValue[0] = minValue;
+                    if (maxValue > MaxValue[0])
+                        MaxValue[0] = maxValue;
                 }
-            }
-            if (lut == NULL)                                           // use conventional method
-            {
-                T2 value = *p;
-                MinValue[0] = value;
-                MaxValue[0] = value;
-                for (i = Count; i > 1; --i)
+                if (last < Count)                                      // pixels after selected range
                 {
-                    value = *(++p);
-                    if (value < MinValue[0])
-                        MinValue[0] = value;
-                    else if (value > MaxValue[0])
-                        MaxValue[0] = value;
-                }
-                if (Count <= PixelCount)                               // use global min/max value
-                {
-                    MinValue[1] = MinValue[0];
-                    MaxValue[1] = MaxValue[0];
-                } else {                                               // calculate min/max for selected range
-                    p = Data + PixelStart;
-                    value = *p;
-                    MinValue[1] = value;
-                    MaxValue[1] = value;
-                    for (i = PixelCount; i > 1; --i)
-                    {
-                        value = *(++p);
-                        if (value < MinValue[1])
-                            MinValue[1] = value;
-                        else if (value > MaxValue[1])
-                            MaxValue[1] = value;
-                    }
+                    getMinMaxValue(Data + last, Count - last, minValue, maxValue);
+                    if (minValue < MinValue[0])
+                        MinValue[0] = minValue;
+                    if (maxValue > MaxValue[0])
+                        MaxValue[0] = maxValue;
                 }
             }
-            delete[] lut;
+            else if (Count > 0)                                        // use global min/max value
+            {
+                getMinMaxValue(Data, Count, MinValue[0], MaxValue[0]);
+                MinValue[1] = MinValue[0];
+                MaxValue[1] = MaxValue[0];
+            }
             return 1;
         }
         return 0;
     }
 
-#include DCMTK_DIAGNOSTIC_POP
-
     /** get pixel representation
      *
      ** @return pixel representation
@@ -347,6 +315,28 @@ class DiInputPixelTemplate
 
  private:
 
+#include DCMTK_DIAGNOSTIC_PUSH
+#include DCMTK_DIAGNOSTIC_IGNORE_CONST_EXPRESSION_WARNING
+
+    /** check whether the raw pixel values can be used as input representation without
+     *  any conversion, i.e. all bits are stored and each value fills exactly one entry of
+     *  type T2.  Values consisting of more than one T1 unit (or vice versa) are composed
+     *  in little endian byte order, which is only the memory layout on such machines.
+     *
+     ** @param  bitsAllocated  number of bits allocated for each pixel
+     *  @param  bitsStored     number of bits stored for each pixel
+     *
+     ** @return true if the raw values can be copied (or used) as is, false otherwise
+     */
+    inline OFBool isRawLayout(const Uint16 bitsAllocated,
+                              const Uint16 bitsStored) const
+    {
+        return (bitsStored == bitsAllocated) && (bitsAllocated == bitsof(T2)) &&
+               ((sizeof(T1) == sizeof(T2)) || (gLocalByteOrder == EBO_LittleEndian));
+    }
+
+#include DCMTK_DIAGNOSTIC_POP
+
     /** convert pixel data from DICOM dataset to input representation
      *
      ** @param  document       pointer to DICOM image object
@@ -368,7 +358,6 @@ class DiInputPixelTemplate
         Uint32 lengthBytes = 0;
         DcmPixelData *pixelData = document->getPixelData();
         const Uint16 bitsof_T1 = bitsof(T1);
-        const Uint16 bitsof_T2 = bitsof(T2);
         const OFBool uncompressed = pixelData->canWriteXfer(EXS_LittleEndianExplicit, EXS_Unknown);
         /* check whether to use partial read */
         if ((document->getFlags() & CIF_UsePartialAccessToPixelData) && (PixelCount > 0) && (bitsAllocated % 8 == 0))
@@ -437,7 +426,232 @@ class DiInputPixelTemplate
             DCMIMGLE_DEBUG("reading uncompressed pixel data completely into memory");
             /* always access complete pixel data */
             lengthBytes = getPixelData(pixelData, pixel);
+            /* the pixel data will be detached anyway, so use it directly if no conversion is needed */
+            if ((pixel != NULL) && (lengthBytes > 0) && (lengthBytes % sizeof(T2) == 0) &&
+                (document->getFlags() & CIF_MayDetachPixelData) && !(document->getFlags() & CIF_UsePartialAccessToPixelData) &&
+                isRawLayout(bitsAllocated, bitsStored) && pixelData->detachValueField().good())
+            {
+                DCMIMGLE_DEBUG("convert input pixel data: taking over buffer of uncompressed pixel data (no copy)");
+                Data = OFreinterpret_cast(T2 *, pixel);
+                Count = lengthBytes / sizeof(T2);
+                return;
+            }
+        }
+        convertValues(pixel, lengthBytes, bitsAllocated, bitsStored, highBit);
+        if (deletePixel)
+        {
+            /* delete temporary buffer */
+            operator delete[] (pixel, std::nothrow);
         }
+    }
+
+    /** convert a region of the pixel data from DICOM dataset to input representation.
+     *  Only the rows of the region are read from the pixel data (using partial access if
+     *  enabled), or decompressed frame by frame in case of compressed pixel data with
+     *  partial access, and only the pixels within the region are converted. The region
+     *  is extracted after converting the complete frames if a stored value might span
+     *  more than one sample (e.g. 12 bits allocated).
+     *
+     ** @param  document       pointer to DICOM image object
+     *  @param  bitsAllocated  number of bits allocated for each pixel
+     *  @param  bitsStored     number of bits stored for each pixel
+     *  @param  highBit        position of high bit within bits allocated
+     *  @param  fileCache      pointer to file cache object used for partial read
+     *  @param  fragment       current pixel item fragment (for encapsulated pixel data)
+     *  @param  columns        width of the stored frames
+     *  @param  left_pos       x coordinate of the top left corner of the region
+     *  @param  top_pos        y coordinate of the top left corner of the region
+     *  @param  src_cols       width of the region
+     *  @param  src_rows       height of the region
+     */
+    void convertRegion(const DiDocument *document,
+                       const Uint16 bitsAllocated,
+                       const Uint16 bitsStored,
+                       const Uint16 highBit,
+                       DcmFileCache *fileCache,
+                       Uint32 &fragment,
+                       const Uint16 columns,
+                       const Uint16 left_pos,
+                       const Uint16 top_pos,
+                       const Uint16 src_cols,
+                       const Uint16 src_rows)
+    {
+        const Uint32 byteFactor = bitsAllocated / 8;
+        /* each sample must consist of one or more complete values of type T1 */
+        if ((bitsAllocated % 8 == 0) && (byteFactor % sizeof(T1) == 0))
+        {
+            DcmPixelData *pixelData = document->getPixelData();
+            const unsigned long factor = byteFactor / sizeof(T1);
+            const unsigned long rowLength = OFstatic_cast(unsigned long, src_cols) * factor;
+            const unsigned long rowOffset = (OFstatic_cast(unsigned long, top_pos) * columns + left_pos) * factor;
+            const unsigned long stride = OFstatic_cast(unsigned long, columns) * factor;
+            const unsigned long frameLength = FrameSize * factor;
+            /* use a non-throwing new here (if available) because the allocated buffer can be huge */
+            T1 *pixel = new (std::nothrow) T1[NumberOfFrames * src_rows * rowLength];
+            if (pixel != NULL)
+            {
+                T1 *q = pixel;
+                unsigned long frame;
+                Uint16 row;
+                if ((document->getFlags() & CIF_UsePartialAccessToPixelData) && !pixelData->canWriteXfer(EXS_LittleEndianExplicit, EXS_Unknown))
+                {
+                    DCMIMGLE_DEBUG("using partial read access to compressed pixel data, converting region of interest only");
+                    const Uint32 fsize = FrameSize * byteFactor;
+                    /* make sure that the buffer always has an even number of bytes as required for getUncompressedFrame() */
+                    const Uint32 bufSize = (fsize & 1) ? fsize + 1 : fsize;
+                    T1 *buffer = new (std::nothrow) T1[(bufSize + sizeof(T1) - 1) / sizeof(T1)];
+                    if (buffer != NULL)
+                    {
+                        OFString decompressedColorModel;
+                        for (frame = 0; frame < NumberOfFrames; ++frame)
+                        {
+                            const OFCondition status = pixelData->getUncompressedFrame(document->getDataset(), FirstFrame + frame,
+                                fragment, buffer, bufSize, decompressedColorModel, fileCache);
+                            if (status.bad())
+                            {
+                                DCMIMGLE_ERROR("can't decompress frame " << FirstFrame + frame << ": " << status.text());
+                                break;
+                            }
+                            DCMIMGLE_TRACE("successfully decompressed frame " << FirstFrame + frame);
+                            const T1 *p = buffer + rowOffset;
+                            for (row = src_rows; row != 0; --row)
+                            {
+                                OFBitmanipTemplate<T1>::copyMem(p, q, rowLength);
+                                p += stride;
+                                q += rowLength;
+                            }
+                        }
+                        /* check whether color model changed during decompression */
+                        if (!decompressedColorModel.empty() && (decompressedColorModel != document->getPhotometricInterpretation()))
+                        {
+                            DCMIMGLE_WARN("Photometric Interpretation of decompressed pixel data deviates from original image: "
+                                << decompressedColorModel);
+                        }
+                        operator delete[] (buffer, std::nothrow);
+                    } else
+                        DCMIMGLE_DEBUG("cannot allocate memory buffer for 'buffer' in DiInputPixelTemplate::convertRegion()");
+                }
+                else if (document->getFlags() & CIF_UsePartialAccessToPixelData)
+                {
+                    DCMIMGLE_DEBUG("using partial read access to uncompressed pixel data, reading region of interest only");
+                    const Uint32 bufSize = OFstatic_cast(Uint32, rowLength * sizeof(T1));
+                    for (frame = 0; frame < NumberOfFrames; ++frame)
+                    {
+                        Uint32 offset = OFstatic_cast(Uint32, ((FirstFrame + frame) * frameLength + rowOffset) * sizeof(T1));
+                        for (row = src_rows; row != 0; --row)
+                        {
+                            const OFCondition status = pixelData->getPartialValue(q, offset, bufSize, fileCache);
+                            if (status.bad())
+                            {
+                                DCMIMGLE_ERROR("can't access partial value from byte offset " << offset << " to "
+                                    << (offset + bufSize - 1) << ": " << status.text());
+                                break;
+                            }
+                            offset += OFstatic_cast(Uint32, stride * sizeof(T1));
+                            q += rowLength;
+                        }
+                        if (row != 0)
+                            break;
+                    }
+                } else {
+                    DCMIMGLE_DEBUG("converting region of interest of uncompressed pixel data only");
+                    T1 *data = NULL;
+                    const unsigned long length = getPixelData(pixelData, data) / sizeof(T1);
+                    if (data != NULL)
+                    {
+                        for (frame = 0; frame < NumberOfFrames; ++frame)
+                        {
+                            unsigned long offset = (FirstFrame + frame) * frameLength + rowOffset;
+                            for (row = src_rows; (row != 0) && (offset + rowLength <= length); --row)
+                            {
+                                OFBitmanipTemplate<T1>::copyMem(data + offset, q, rowLength);
+                                offset += stride;
+                                q += rowLength;
+                            }
+                            if (row != 0)
+                                break;
+                        }
+                    }
+                }
+                /* only the pixels of the region are stored in the input representation */
+                PixelStart = 0;
+                convertValues(pixel, OFstatic_cast(Uint32, (q - pixel) * sizeof(T1)), bitsAllocated, bitsStored, highBit);
+                operator delete[] (pixel, std::nothrow);
+            } else
+                DCMIMGLE_DEBUG("cannot allocate memory buffer for 'pixel' in DiInputPixelTemplate::convertRegion()");
+        } else {
+            DCMIMGLE_DEBUG("converting complete frames, extracting region of interest afterwards");
+            convert(document, bitsAllocated, bitsStored, highBit, fileCache, fragment);
+            extractRegion(columns, left_pos, top_pos, src_cols, src_rows);
+        }
+        /* the frames of the input representation consist of the region only */
+        FrameSize = OFstatic_cast(unsigned long, src_cols) * src_rows;
+        PixelCount = NumberOfFrames * FrameSize;
+        ComputedCount = PixelCount;
+    }
+
+    /** extract a region from the frames of the input representation (to be processed).
+     *  The input representation is replaced by the pixels of the region.
+     *
+     ** @param  columns   width of the stored frames
+     *  @param  left_pos  x coordinate of the top left corner of the region
+     *  @param  top_pos   y coordinate of the top left corner of the region
+     *  @param  src_cols  width of the region
+     *  @param  src_rows  height of the region
+     */
+    void extractRegion(const Uint16 columns,
+                       const Uint16 left_pos,
+                       const Uint16 top_pos,
+                       const Uint16 src_cols,
+                       const Uint16 src_rows)
+    {
+        if (Data != NULL)
+        {
+            /* use a non-throwing new here (if available) because the allocated buffer can be huge */
+            T2 *region = new (std::nothrow) T2[NumberOfFrames * src_rows * src_cols];
+            if (region != NULL)
+            {
+                T2 *q = region;
+                for (unsigned long frame = 0; frame < NumberOfFrames; ++frame)
+                {
+                    unsigned long offset = PixelStart + frame * FrameSize + OFstatic_cast(unsigned long, top_pos) * columns + left_pos;
+                    Uint16 row;
+                    for (row = src_rows; (row != 0) && (offset + src_cols <= Count); --row)
+                    {
+                        OFBitmanipTemplate<T2>::copyMem(Data + offset, q, src_cols);
+                        offset += columns;
+                        q += src_cols;
+                    }
+                    if (row != 0)
+                        break;
+                }
+                Count = OFstatic_cast(unsigned long, q - region);
+            } else {
+                DCMIMGLE_DEBUG("cannot allocate memory buffer for 'region' in DiInputPixelTemplate::extractRegion()");
+                Count = 0;
+            }
+            PixelStart = 0;
+            operator delete[] (Data, std::nothrow);
+            Data = region;
+        }
+    }
+
+    /** convert raw pixel values to input representation
+     *
+     ** @param  pixel          pointer to raw pixel values
+     *  @param  lengthBytes    number of bytes of the raw pixel values
+     *  @param  bitsAllocated  number of bits allocated for each pixel
+     *  @param  bitsStored     number of bits stored for each pixel
+     *  @param  highBit        position of high bit within bits allocated
+     */
+    void convertValues(const T1 *pixel,
+                       const Uint32 lengthBytes,
+                       const Uint16 bitsAllocated,
+                       const Uint16 bitsStored,
+                       const Uint16 highBit)
+    {
+        const Uint16 bitsof_T1 = bitsof(T1);
+        const Uint16 bitsof_T2 = bitsof(T2);
         if ((pixel != NULL) && (lengthBytes > 0))
         {
             const Uint32 length_T1 = lengthBytes / sizeof(T1);
@@ -457,7 +671,20 @@ class DiInputPixelTemplate
                     << " bits (" << (this->isSigned() ? "signed" : "unsigned") << ")");
                 const T1 *p = pixel;
                 T2 *q = Data;
-                if (bitsof_T1 == bitsAllocated)                                             // case 1: equal 8/16 bit
+                if (isRawLayout(bitsAllocated, bitsStored))                                 // case 0: no conversion needed
+                {
+                    DCMIMGLE_DEBUG("convert input pixel data: case 0 (raw copy)");
+                    const size_t bytes = OFstatic_cast(size_t, Count) * sizeof(T2);
+                    Uint8 *r = OFreinterpret_cast(Uint8 *, Data);
+                    if (lengthBytes < bytes)
+                    {
+                        /* fill the incomplete last entry (odd length) with zero bits */
+                        OFBitmanipTemplate<Uint8>::copyMem(OFreinterpret_cast(const Uint8 *, pixel), r, lengthBytes);
+                        OFBitmanipTemplate<Uint8>::zeroMem(r + lengthBytes, bytes - lengthBytes);
+                    } else
+                        OFBitmanipTemplate<Uint8>::copyMem(OFreinterpret_cast(const Uint8 *, pixel), r, bytes);
+                }
+                else if (bitsof_T1 == bitsAllocated)                                        // case 1: equal 8/16 bit
                 {
                     if (bitsStored == bitsAllocated)
                     {
@@ -631,11 +858,6 @@ class DiInputPixelTemplate
             /* in case of error, reset pixel count variable */
             Count = 0;
         }
-        if (deletePixel)
-        {
-            /* delete temporary buffer */
-            operator delete[] (pixel, std::nothrow);
-        }
     }
 
     /// pointer to pixel data
@@ -0,0 +1,256 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomMonochromeRenderCache (Header)
+ *
+ */
+
+
+#ifndef DIMOCACH_H
+#define DIMOCACH_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oflist.h"
+
+#include "dcmtk/dcmimgle/diutils.h"
+
+
+/*------------------------*
+ *  forward declarations  *
+ *------------------------*/
+
+class DiDisplayFunction;
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Class caching data used for rendering a monochrome image repeatedly, e.g. with
+ *  different VOI windows. The cache stores the optimization LUTs that combine the
+ *  VOI, presentation and display transformation (keyed by the rendering parameters)
+ *  as well as the output buffer of the last rendered frame, which is reused for the
+ *  next one. The total size of the cached data is limited; the LUTs that have not
+ *  been used for the longest time are removed first.
+ */
+class DCMTK_DCMIMGLE_EXPORT DiMonoRenderCache
+{
+
+ public:
+
+    /** Rendering parameters an optimization LUT depends on.
+     *  The VOI LUT, presentation LUT and display function are identified by their
+     *  address, i.e. the cache has to be cleared whenever one of them is deleted or
+     *  replaced.  Since the display function is usually modified in place, its
+     *  parameters (ambient light, illumination, min/max density and number of DDLs)
+     *  are also part of the key.
+     */
+    struct DCMTK_DCMIMGLE_EXPORT Key
+    {
+        /** constructor
+         *
+         ** @param  vlut      VOI LUT (maybe NULL)
+         *  @param  plut      presentation LUT (maybe NULL)
+         *  @param  disp      display function (maybe NULL)
+         *  @param  vfunc     VOI LUT function
+         *  @param  center    window center
+         *  @param  width     window width
+         *  @param  low       lowest pixel value for the output data
+         *  @param  high      highest pixel value for the output data
+         *  @param  itemSize  size of an entry of the LUT (in bytes)
+         */
+        Key(const void *vlut = NULL,
+            const void *plut = NULL,
+            const DiDisplayFunction *disp = NULL,
+            const int vfunc = 0,
+            const double center = 0,
+            const double width = 0,
+            const Uint32 low = 0,
+            const Uint32 high = 0,
+            const size_t itemSize = 0);
+
+        /** compare two keys
+         *
+         ** @param  key  key to be compared
+         *
+         ** @return true if equal, false otherwise
+         */
+        OFBool operator==(const Key &key) const;
+
+        /// VOI LUT
+        const void *VoiLut;
+        /// presentation LUT
+        const void *PresLut;
+        /// display function
+        const void *Display;
+        /// ambient light value of the display function
+        double AmbientLight;
+        /// illumination value of the display function
+        double Illumination;
+        /// minimum optical density of the display function
+        double MinDensity;
+        /// maximum optical density of the display function
+        double MaxDensity;
+        /// number of DDLs of the display function
+        unsigned long DDLCount;
+        /// VOI LUT function
+        int VoiFunction;
+        /// window center
+        double Center;
+        /// window width
+        double Width;
+        /// lowest pixel value for the output data
+        Uint32 Low;
+        /// highest pixel value for the output data
+        Uint32 High;
+        /// size of an entry of the LUT (in bytes)
+        size_t ItemSize;
+    };
+
+    /** constructor
+     *
+     ** @param  maxSize  maximum size of the cached data (in bytes)
+     */
+    DiMonoRenderCache(const unsigned long maxSize);
+
+    /** destructor
+     */
+    virtual ~DiMonoRenderCache();
+
+    /** get maximum size of the cached data
+     *
+     ** @return maximum size (in bytes)
+     */
+    inline unsigned long getMaximumSize() const
+    {
+        return MaximumSize;
+    }
+
+    /** set maximum size of the cached data.
+     *  Cached data is removed if the new size is smaller than the current size.
+     *
+     ** @param  maxSize  maximum size (in bytes)
+     */
+    void setMaximumSize(const unsigned long maxSize);
+
+    /** get current size of the cached data
+     *
+     ** @return current size (in bytes)
+     */
+    inline unsigned long getSize() const
+    {
+        return CurrentSize;
+    }
+
+    /** remove all cached data
+     */
+    void clear();
+
+    /** find the optimization LUT for the given rendering parameters
+     *
+     ** @param  key  rendering parameters
+     *
+     ** @return pointer to the LUT if cached (still owned by the cache), NULL otherwise
+     */
+    const void *findLUT(const Key &key);
+
+    /** add an optimization LUT to the cache.
+     *  The LUT is deleted immediately if it does not fit into the cache.
+     *
+     ** @param  key    rendering parameters
+     *  @param  lut    LUT to be added (allocated with new[] using an unsigned integer
+     *                 type of 'key.ItemSize' bytes, ownership is transferred to the cache)
+     *  @param  count  number of entries of the LUT
+     */
+    void addLUT(const Key &key,
+                void *lut,
+                const unsigned long count);
+
+    /** take the cached output buffer if it has the requested size
+     *
+     ** @param  count     number of entries of the buffer
+     *  @param  itemSize  size of an entry of the buffer (in bytes)
+     *
+     ** @return pointer to the buffer (ownership is transferred to the caller) or NULL
+     */
+    void *takeBuffer(const unsigned long count,
+                     const size_t itemSize);
+
+    /** store an output buffer in the cache (replacing the current one).
+     *  The buffer is deleted immediately if it does not fit into the cache.
+     *
+     ** @param  buffer    buffer to be stored (allocated with new[] using an unsigned
+     *                    integer type of 'itemSize' bytes, ownership is transferred
+     *                    to the cache)
+     *  @param  count     number of entries of the buffer
+     *  @param  itemSize  size of an entry of the buffer (in bytes)
+     */
+    void putBuffer(void *buffer,
+                   const unsigned long count,
+                   const size_t itemSize);
+
+
+ private:
+
+    /** A cached optimization LUT.
+     */
+    struct Entry
+    {
+        /// rendering parameters
+        Key LutKey;
+        /// LUT data
+        void *Data;
+        /// size of the LUT (in bytes)
+        unsigned long Size;
+    };
+
+    /** remove cached data until the given size is no longer exceeded
+     *
+     ** @param  maxSize  maximum size (in bytes)
+     */
+    void shrink(const unsigned long maxSize);
+
+    /** delete an array of unsigned integer values
+     *
+     ** @param  data      array to be deleted
+     *  @param  itemSize  size of an entry of the array (in bytes)
+     */
+    static void deleteArray(void *data,
+                            const size_t itemSize);
+
+    /// cached LUTs (most recently used first)
+    OFList<Entry> LUTs;
+    /// cached output buffer (might be NULL)
+    void *Buffer;
+    /// number of entries of the cached output buffer
+    unsigned long BufferCount;
+    /// size of an entry of the cached output buffer
+    size_t BufferItemSize;
+    /// maximum size of the cached data (in bytes)
+    unsigned long MaximumSize;
+    /// current size of the cached data (in bytes)
+    unsigned long CurrentSize;
+
+ // --- declarations to avoid compiler warnings
+
+    DiMonoRenderCache(const DiMonoRenderCache &);
+    DiMonoRenderCache &operator=(const DiMonoRenderCache &);
+};
+
+
+#endif
@@ -38,6 +38,7 @@
  *------------------------*/
 
 class DiColorImage;
+class DiMonoRenderCache;
 
 
 /*---------------------*
@@ -156,9 +157,29 @@ class DCMTK_DCMIMGLE_EXPORT DiMonoImage
      */
     inline int deleteDisplayLUT(const int bits)
     {
+        clearRenderCache();
         return (DisplayFunction != NULL) ? DisplayFunction->deleteLookupTable(bits) : 0;
     }
 
+    /** set maximum size of the render cache.
+     *  The render cache keeps the optimization LUTs used for rendering (combining the VOI,
+     *  presentation and display transformation) as well as the output buffer, so that
+     *  rendering the image again with previously used parameters (e.g. switching between
+     *  some VOI windows) only requires a single lookup pass over the pixel data.
+     *  The cache is disabled by default.
+     *
+     ** @param  size  maximum size of the cached data in bytes (0 = disable cache)
+     *
+     ** @return true if successful, false otherwise
+     */
+    int setRenderCacheSize(const unsigned long size);
+
+    /** get maximum size of the render cache
+     *
+     ** @return maximum size of the cached data in bytes (0 = cache disabled)
+     */
+    unsigned long getRenderCacheSize() const;
+
     /** check whether given output value is unused
      *
      ** @param  value  output value to be checked
@@ -846,7 +867,8 @@ class DCMTK_DCMIMGLE_EXPORT DiMonoImage
      *  @param  interpolate   specifies whether scaling algorithm should use interpolation (if necessary).
      *                        default: no interpolation (0), preferred interpolation algorithm (if applicable):
      *                          1 = pbmplus algorithm, 2 = c't algorithm, 3 = bilinear magnification,
-     *                          4 = bicubic magnification
+     *                          4 = bicubic magnification, 5 = box filter, 6 = bilinear filter,
+     *                          7 = Lanczos filter
      *  @param  aspect        specifies whether pixel aspect ratio should be taken into consideration
      *                        (if true, width OR height should be 0, i.e. this component will be calculated
      *                         automatically)
@@ -1146,6 +1168,13 @@ class DCMTK_DCMIMGLE_EXPORT DiMonoImage
     DiMonoOutputPixel *OutputData;
     /// points to current overlay plane data (pixel array)
     void *OverlayData;
+    /// points to render cache (maybe NULL)
+    DiMonoRenderCache *RenderCache;
+
+    /** remove all data from the render cache (if any).
+     *  Called whenever the cached LUTs might no longer be valid.
+     */
+    void clearRenderCache();
 
  // --- declarations to avoid compiler warnings
 
@@ -32,6 +32,7 @@
 
 #include "dcmtk/dcmimgle/dimopxt.h"
 #include "dcmtk/dcmimgle/diinpx.h"
+#include "dcmtk/dcmimgle/dithread.h"
 
 
 /*---------------------*
@@ -135,7 +136,9 @@ class DiMonoInputPixelTemplate
             const DiLookupTable *mlut = this->Modality->getTableData();
             if (mlut != NULL)
             {
-                const int useInputBuffer = (sizeof(T1) == sizeof(T3)) && (this->Count <= input->getCount());
+                // the LUT is applied in parallel bands, so the input buffer can only be re-used if the
+                // pixel data start at its beginning (otherwise the bands would overlap)
+                const int useInputBuffer = (sizeof(T1) == sizeof(T3)) && (this->Count <= input->getCount()) && (input->getPixelStart() == 0);
                 if (useInputBuffer)                            // do not copy pixel data, reference them!
                 {
                     DCMIMGLE_DEBUG("re-using input buffer, do not copy pixel data");
@@ -171,9 +174,7 @@ class DiMonoInputPixelTemplate
                                 *(q++) = OFstatic_cast(T3, mlut->getValue(value));
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);                 // points to 'zero' entry
-                        q = this->Data;
-                        for (i = this->InputCount; i != 0; --i)                           // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        DiLookupLoopTemplate<T1, T3>(p, this->Data, lut0).process(this->InputCount);  // apply LUT
                     }
                     if (lut == NULL)                                                      // use "normal" transformation
                     {
@@ -252,9 +253,7 @@ class DiMonoInputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);                 // points to 'zero' entry
-                        q = this->Data;
-                        for (i = this->InputCount; i != 0; --i)                           // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        DiLookupLoopTemplate<T1, T3>(p, this->Data, lut0).process(this->InputCount);  // apply LUT
                     }
                     if (lut == NULL)                                                      // use "normal" transformation
                     {
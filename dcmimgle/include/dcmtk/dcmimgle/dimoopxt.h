@@ -36,6 +36,8 @@
 #include "dcmtk/dcmimgle/dipxrept.h"
 #include "dcmtk/dcmimgle/didispfn.h"
 #include "dcmtk/dcmimgle/didislut.h"
+#include "dcmtk/dcmimgle/dithread.h"
+#include "dcmtk/dcmimgle/dimocach.h"
 
 #ifdef PASTEL_COLOR_OUTPUT
 #include "dimcopxt.h"
@@ -76,6 +78,7 @@ class DiMonoOutputPixelTemplate
      *  @param  frame     frame to be rendered
      * (#)param frames    total number of frames present in intermediate representation
      *  @param  pastel    flag indicating whether to use not only 'real' grayscale values (optional, experimental)
+     *  @param  cache     render cache providing the output buffer and optimization LUTs (optional, maybe NULL)
      */
     DiMonoOutputPixelTemplate(void *buffer,
                               const DiMonoPixel *pixel,
@@ -96,12 +99,15 @@ class DiMonoOutputPixelTemplate
 #else
                               const unsigned long /*frames*/,
 #endif
-                              const int pastel = 0)
+                              const int pastel = 0,
+                              DiMonoRenderCache *cache = NULL)
       : DiMonoOutputPixel(pixel, OFstatic_cast(unsigned long, columns) * OFstatic_cast(unsigned long, rows), frame,
                           OFstatic_cast(unsigned long, fabs(OFstatic_cast(double, high - low)))),
         Data(NULL),
         DeleteData(buffer == NULL),
-        ColorData(NULL)
+        ColorData(NULL),
+        Cache(cache),
+        CacheKey(vlut, plut, disp, vfunc, center, width, low, high, sizeof(T3))
     {
         if ((pixel != NULL) && (Count > 0) && (FrameSize >= Count))
         {
@@ -117,7 +123,11 @@ class DiMonoOutputPixelTemplate
                 DCMIMGLE_TRACE("monochrome output values - low: " << OFstatic_cast(unsigned long, low) << ", high: "
                     << OFstatic_cast(unsigned long, high) << ((low > high) ? " (inverted)" : ""));
                 Data = OFstatic_cast(T3 *, buffer);
-                if ((vlut != NULL) && (vlut->isValid()))            // valid VOI LUT ?
+                if (applyCachedLUT(pixel, frame * FrameSize))       // cached LUT for these parameters ?
+                {
+                    DCMIMGLE_DEBUG("using cached LUT for monochrome rendering");
+                }
+                else if ((vlut != NULL) && (vlut->isValid()))       // valid VOI LUT ?
                     voilut(pixel, frame * FrameSize, vlut, plut, disp, OFstatic_cast(T3, low), OFstatic_cast(T3, high));
                 else
                 {
@@ -138,7 +148,12 @@ class DiMonoOutputPixelTemplate
     virtual ~DiMonoOutputPixelTemplate()
     {
         if (DeleteData)
-            delete[] Data;
+        {
+            if ((Cache != NULL) && (Data != NULL))
+                Cache->putBuffer(Data, FrameSize, sizeof(T3));    // reuse output buffer for the next frame
+            else
+                delete[] Data;
+        }
         delete ColorData;
     }
 
@@ -290,18 +305,27 @@ class DiMonoOutputPixelTemplate
 #include DCMTK_DIAGNOSTIC_PUSH
 #include DCMTK_DIAGNOSTIC_IGNORE_CONST_EXPRESSION_WARNING
 
-    /** initialize an optimization LUT if the optimization criteria is fulfilled
+    /** initialize an optimization LUT if the optimization criteria is fulfilled.
+     *  For 32 bit intermediate data, an optimization LUT is only used if the pixel
+     *  values actually present in the image are all covered by the LUT.
      *
-     ** @param  lut   reference to storage area where the optimization LUT should be stored
-     *  @param  ocnt  number of entries for the optimization LUT (0 = never create one)
+     ** @param  lut    reference to storage area where the optimization LUT should be stored
+     *  @param  ocnt   number of entries for the optimization LUT (0 = never create one)
+     *  @param  inter  pointer to intermediate pixel representation
      *
      ** @return status, true if successful, false otherwise
      */
     inline int initOptimizationLUT(T3 *&lut,
-                                   const unsigned long ocnt)
+                                   const unsigned long ocnt,
+                                   const DiMonoPixel *inter)
     {
         int result = 0;
-        if ((sizeof(T1) <= 2) && (ocnt > 0) && (Count > 3 * ocnt))            // optimization criteria
+        double minvalue = 0;
+        double maxvalue = 0;
+        const double absmin = OFstatic_cast(double, OFstatic_cast(T2, inter->getAbsMinimum()));  // 'zero' entry of the LUT
+        if ((ocnt > 0) && (Count > 3 * ocnt) &&                               // optimization criteria
+            ((sizeof(T1) <= 2) || (inter->getMinMaxValues(minvalue, maxvalue) &&
+            (minvalue >= absmin) && (maxvalue - absmin < OFstatic_cast(double, ocnt)))))
         {                                                                     // use LUT for optimization
             lut = new T3[ocnt];
             if (lut != NULL)
@@ -315,6 +339,73 @@ class DiMonoOutputPixelTemplate
 
 #include DCMTK_DIAGNOSTIC_POP
 
+    /** apply the optimization LUT to the pixel data of the current frame
+     *  (in parallel if configured, see DicomImageClass::setNumberOfThreads())
+     *
+     ** @param  p     pointer to the first pixel of the current frame
+     *  @param  lut0  pointer to the 'zero' entry of the optimization LUT
+     */
+    inline void applyOptimizationLUT(const T1 *p,
+                                     const T3 *lut0)
+    {
+        DiLookupLoopTemplate<T1, T3>(p, Data, lut0).process(Count);
+    }
+
+    /** create the output buffer (if not yet done).
+     *  The buffer of the previous call is reused if a render cache is present.
+     */
+    inline void initOutputBuffer()
+    {
+        if ((Data == NULL) && (Cache != NULL))
+            Data = OFstatic_cast(T3 *, Cache->takeBuffer(FrameSize, sizeof(T3)));
+        if (Data == NULL)
+            Data = new T3[FrameSize];
+    }
+
+    /** apply the cached optimization LUT for the current rendering parameters (if any)
+     *
+     ** @param  inter  pointer to intermediate pixel representation
+     *  @param  start  offset of the first pixel to be processed
+     *
+     ** @return status, true if the cached LUT has been applied, false otherwise
+     */
+    int applyCachedLUT(const DiMonoPixel *inter,
+                       const Uint32 start)
+    {
+        if (Cache != NULL)
+        {
+            const T1 *pixel = OFstatic_cast(const T1 *, inter->getData());
+            const T3 *lut = OFstatic_cast(const T3 *, Cache->findLUT(CacheKey));
+            if ((pixel != NULL) && (lut != NULL))
+            {
+                initOutputBuffer();
+                if (Data != NULL)
+                {
+                    const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
+                    applyOptimizationLUT(pixel + start, lut0);
+                    if (Count < FrameSize)
+                        OFBitmanipTemplate<T3>::zeroMem(Data + Count, FrameSize - Count);  // set remaining pixels of frame to zero
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+
+    /** delete the optimization LUT or hand it over to the render cache (if present)
+     *
+     ** @param  lut   optimization LUT (maybe NULL)
+     *  @param  ocnt  number of entries of the optimization LUT
+     */
+    inline void releaseOptimizationLUT(T3 *lut,
+                                       const unsigned long ocnt)
+    {
+        if (Cache != NULL)
+            Cache->addLUT(CacheKey, lut, ocnt);
+        else
+            delete[] lut;
+    }
+
 #ifdef PASTEL_COLOR_OUTPUT
     void color(void *buffer,                               // create true color pastel image
                const DiMonoPixel *inter,
@@ -348,8 +439,7 @@ class DiMonoOutputPixelTemplate
         const T1 *pixel = OFstatic_cast(const T1 *, inter->getData());
         if ((pixel != NULL) && (vlut != NULL))
         {
-            if (Data == NULL)
-                Data = new T3[FrameSize];
+            initOutputBuffer();
             if (Data != NULL)
             {
                 DCMIMGLE_DEBUG("applying VOI transformation with LUT (" << vlut->getCount() << " entries)");
@@ -410,7 +500,7 @@ class DiMonoOutputPixelTemplate
                         const double gradient1 = OFstatic_cast(double, pcnt) / OFstatic_cast(double, vlut->getAbsMaxRange());
                         const Uint32 firstvalue = OFstatic_cast(Uint32, OFstatic_cast(double, vlut->getFirstValue()) * gradient1);
                         const Uint32 lastvalue = OFstatic_cast(Uint32, OFstatic_cast(double, vlut->getLastValue()) * gradient1);
-                        if (initOptimizationLUT(lut, ocnt))
+                        if (initOptimizationLUT(lut, ocnt, inter))
                         {                                                                 // use LUT for optimization
                             q = lut;
                             if (dlut != NULL)                                             // perform display transformation
@@ -459,9 +549,7 @@ class DiMonoOutputPixelTemplate
                                 }
                             }
                             const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
-                            q = Data;
-                            for (i = Count; i != 0; --i)                                  // apply LUT
-                                *(q++) = *(lut0 + (*(p++)));
+                            applyOptimizationLUT(p, lut0);
                         }
                         if (lut == NULL)                                                  // use "normal" transformation
                         {
@@ -516,7 +604,7 @@ class DiMonoOutputPixelTemplate
                         const double gradient = outrange / OFstatic_cast(double, vlut->getAbsMaxRange());
                         const T3 firstvalue = OFstatic_cast(T3, lowvalue + OFstatic_cast(double, vlut->getFirstValue()) * gradient);
                         const T3 lastvalue = OFstatic_cast(T3, lowvalue + OFstatic_cast(double, vlut->getLastValue()) * gradient);
-                        if (initOptimizationLUT(lut, ocnt))
+                        if (initOptimizationLUT(lut, ocnt, inter))
                         {                                                                 // use LUT for optimization
                             q = lut;
                             if (dlut != NULL)                                             // perform display transformation
@@ -559,9 +647,7 @@ class DiMonoOutputPixelTemplate
                                 }
                             }
                             const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());   // points to 'zero' entry
-                            q = Data;
-                            for (i = Count; i != 0; --i)                                  // apply LUT
-                                *(q++) = *(lut0 + (*(p++)));
+                            applyOptimizationLUT(p, lut0);
                         }
                         if (lut == NULL)                                                  // use "normal" transformation
                         {
@@ -606,7 +692,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                     }
-                    delete[] lut;
+                    releaseOptimizationLUT(lut, ocnt);
                 }
                 if (Count < FrameSize)
                     OFBitmanipTemplate<T3>::zeroMem(Data + Count, FrameSize - Count);     // set remaining pixels of frame to zero
@@ -635,8 +721,7 @@ class DiMonoOutputPixelTemplate
         const T1 *pixel = OFstatic_cast(const T1 *, inter->getData());
         if (pixel != NULL)
         {
-            if (Data == NULL)                                                         // create new output buffer
-                Data = new T3[FrameSize];
+            initOutputBuffer();
             if (Data != NULL)
             {
                 DCMIMGLE_DEBUG("applying no VOI transformation (linear scaling)");
@@ -657,7 +742,7 @@ class DiMonoOutputPixelTemplate
                     Uint32 value;                                                     // presentation LUT is always unsigned
                     const double gradient1 = OFstatic_cast(double, plut->getCount()) / inter->getAbsMaxRange();
                     const double gradient2 = outrange / OFstatic_cast(double, plut->getAbsMaxRange() - 1);
-                    if (initOptimizationLUT(lut, ocnt))
+                    if (initOptimizationLUT(lut, ocnt, inter))
                     {                                                                 // use LUT for optimization
                         q = lut;
                         if (dlut != NULL)                                             // perform display transformation
@@ -687,9 +772,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(p, lut0);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -723,7 +806,7 @@ class DiMonoOutputPixelTemplate
                 } else {                                                              // has no presentation LUT
                     createDisplayLUT(dlut, disp, inter->getBits());
                     const double gradient = outrange / (inter->getAbsMaxRange() - 1);
-                    if (initOptimizationLUT(lut, ocnt))
+                    if (initOptimizationLUT(lut, ocnt, inter))
                     {                                                                 // use LUT for optimization
                         q = lut;
                         if (dlut != NULL)                                             // perform display transformation
@@ -743,9 +826,7 @@ class DiMonoOutputPixelTemplate
                                 *(q++) = OFstatic_cast(T3, lowvalue + OFstatic_cast(double, i) * gradient);
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, inter->getAbsMinimum());  // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(p, lut0);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -767,7 +848,7 @@ class DiMonoOutputPixelTemplate
                         }
                     }
                 }
-                delete[] lut;
+                releaseOptimizationLUT(lut, ocnt);
                 if (Count < FrameSize)
                     OFBitmanipTemplate<T3>::zeroMem(Data + Count, FrameSize - Count); // set remaining pixels of frame to zero
             }
@@ -798,8 +879,7 @@ class DiMonoOutputPixelTemplate
         const T1 *pixel = OFstatic_cast(const T1 *, inter->getData());
         if (pixel != NULL)
         {
-            if (Data == NULL)
-                Data = new T3[FrameSize];                                             // create new output buffer
+            initOutputBuffer();
             if (Data != NULL)
             {
                 DCMIMGLE_DEBUG("applying sigmoid VOI transformation with window center = " << center << ", width = " << width);
@@ -820,7 +900,7 @@ class DiMonoOutputPixelTemplate
                     Uint32 value2;                                                    // presentation LUT is always unsigned
                     const double plutcnt_1 = OFstatic_cast(double, plut->getCount() - 1);
                     const double plutmax_1 = OFstatic_cast(double, plut->getAbsMaxRange() - 1);
-                    if (initOptimizationLUT(lut, ocnt))
+                    if (initOptimizationLUT(lut, ocnt, inter))
                     {                                                                 // use LUT for optimization
                         q = lut;
                         if (dlut != NULL)                                             // perform display transformation
@@ -846,9 +926,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(p, lut0);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -877,7 +955,7 @@ class DiMonoOutputPixelTemplate
                     }
                 } else {                                                              // has no presentation LUT
                     createDisplayLUT(dlut, disp, bitsof(T1));
-                    if (initOptimizationLUT(lut, ocnt))
+                    if (initOptimizationLUT(lut, ocnt, inter))
                     {                                                                 // use LUT for optimization
                         q = lut;
                         if (dlut != NULL)                                             // perform display transformation
@@ -900,9 +978,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(p, lut0);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -927,7 +1003,7 @@ class DiMonoOutputPixelTemplate
                         }
                     }
                 }
-                delete[] lut;
+                releaseOptimizationLUT(lut, ocnt);
                 if (Count < FrameSize)
                     OFBitmanipTemplate<T3>::zeroMem(Data + Count, FrameSize - Count);        // set remaining pixels of frame to zero
             }
@@ -958,8 +1034,7 @@ class DiMonoOutputPixelTemplate
         const T1 *pixel = OFstatic_cast(const T1 *, inter->getData());
         if (pixel != NULL)
         {
-            if (Data == NULL)
-                Data = new T3[FrameSize];                                             // create new output buffer
+            initOutputBuffer();
             if (Data != NULL)
             {
                 DCMIMGLE_DEBUG("applying linear VOI transformation with window center = " << center << ", width = " << width);
@@ -984,7 +1059,7 @@ class DiMonoOutputPixelTemplate
                     const Uint32 pcnt = plut->getCount();
                     const double plutmax_1 = OFstatic_cast(double, plut->getAbsMaxRange()) - 1;
                     const double gradient1 = (width_1 == 0) ? 0 : OFstatic_cast(double, pcnt - 1) / width_1;
-                    if (initOptimizationLUT(lut, ocnt))
+                    if (initOptimizationLUT(lut, ocnt, inter))
                     {                                                                 // use LUT for optimization
                         q = lut;
                         if (dlut != NULL)                                             // perform display transformation
@@ -1020,9 +1095,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(p, lut0);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -1061,7 +1134,7 @@ class DiMonoOutputPixelTemplate
                     }
                 } else {                                                              // has no presentation LUT
                     createDisplayLUT(dlut, disp, bitsof(T1));
-                    if (initOptimizationLUT(lut, ocnt))
+                    if (initOptimizationLUT(lut, ocnt, inter))
                     {                                                                 // use LUT for optimization
                         q = lut;
                         if (dlut != NULL)                                             // perform display transformation
@@ -1095,9 +1168,7 @@ class DiMonoOutputPixelTemplate
                             }
                         }
                         const T3 *lut0 = lut - OFstatic_cast(T2, absmin);             // points to 'zero' entry
-                        q = Data;
-                        for (i = Count; i != 0; --i)                                  // apply LUT
-                            *(q++) = *(lut0 + (*(p++)));
+                        applyOptimizationLUT(p, lut0);
                     }
                     if (lut == NULL)                                                  // use "normal" transformation
                     {
@@ -1133,7 +1204,7 @@ class DiMonoOutputPixelTemplate
                         }
                     }
                 }
-                delete[] lut;
+                releaseOptimizationLUT(lut, ocnt);
                 if (Count < FrameSize)
                     OFBitmanipTemplate<T3>::zeroMem(Data + Count, FrameSize - Count);        // set remaining pixels of frame to zero
             }
@@ -1313,6 +1384,11 @@ class DiMonoOutputPixelTemplate
     DiMonoOutputPixel *ColorData;
 #endif
 
+    /// render cache providing the output buffer and optimization LUTs (maybe NULL)
+    DiMonoRenderCache *Cache;
+    /// rendering parameters identifying the optimization LUT in the render cache
+    const DiMonoRenderCache::Key CacheKey;
+
  // --- declarations to avoid compiler warnings
 
     DiMonoOutputPixelTemplate(const DiMonoOutputPixelTemplate<T1,T2,T3> &);
@@ -44,6 +44,9 @@ class DiImage;
  *  This is an abstract base class used as an interface to support multiple
  *  pluggable image output formats for the dcmimle/dcmimage library. An example
  *  implementation can be found in dcmjpeg/libsrc/dipijpeg.cc (JPEG plugin).
+ *  Plugins that separate the encoding from the rendering of a frame (see
+ *  getBitsPerSample() and encode()) can encode multiple frames in parallel,
+ *  see writeFrames().
  */
 class DCMTK_DCMIMGLE_EXPORT DiPluginFormat
 {
@@ -66,11 +69,55 @@ class DCMTK_DCMIMGLE_EXPORT DiPluginFormat
                       FILE *stream,
                       const unsigned long frame = 0) const = 0;
 
+    /** write given frames of an image to separate files.
+     *  If the plugin supports it, the frames are rendered one after the other in
+     *  the calling thread while the rendered frames are encoded in parallel by up
+     *  to DicomImageClass::getNumberOfThreads() threads.  Otherwise, write() is
+     *  called for each frame.
+     *
+     ** @param  image     pointer to DICOM image object to be written
+     *  @param  filename  name of the output files, should contain a format specifier
+     *                    like '%lu' which is replaced by the frame number
+     *  @param  fstart    index of the first frame to be written
+     *  @param  fcount    number of frames to be written (0 = all remaining frames)
+     *  @param  fnumber   value added to the frame index when generating the filename
+     *
+     ** @return true if successful, false otherwise
+     */
+    virtual int writeFrames(DiImage *image,
+                            const char *filename,
+                            const unsigned long fstart,
+                            const unsigned long fcount,
+                            const unsigned long fnumber = 0) const;
+
+    /** encode an already rendered frame and write it to a file stream.
+     *  This method is called by writeFrames() from different threads at the same time,
+     *  therefore, implementations must not modify the plugin or the image object.
+     *  The default implementation does nothing.
+     *
+     ** @param  image   pointer to DICOM image object the frame has been rendered from
+     *  @param  data    pixel data rendered with getBitsPerSample() bits per sample
+     *                  (color images: not planar)
+     *  @param  stream  stream to which the image is written (open in binary mode!)
+     *
+     ** @return true if successful, false otherwise
+     */
+    virtual int encode(const DiImage *image,
+                       const void *data,
+                       FILE *stream) const;
+
   protected:
 
     /** constructor (protected)
      */
     DiPluginFormat() {}
+
+    /** get number of bits per sample of the pixel data passed to encode().
+     *  The default implementation returns 0, i.e. encode() is not supported.
+     *
+     ** @return number of bits per sample, 0 if encode() is not supported
+     */
+    virtual int getBitsPerSample() const;
 };
 
 
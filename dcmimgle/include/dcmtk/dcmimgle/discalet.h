@@ -29,6 +29,9 @@
 
 #include "dcmtk/dcmimgle/ditranst.h"
 #include "dcmtk/dcmimgle/dipxrept.h"
+#include "dcmtk/dcmimgle/dithread.h"
+
+#include <cmath>
 
 
 /*---------------------*
@@ -92,6 +95,315 @@ static inline double cubicValue(const double v1,
  *  class declaration  *
  *---------------------*/
 
+/** Template class for the weights of a separable resampling filter in one dimension.
+ *  For each destination pixel the range of contributing source pixels and their
+ *  normalized weights are computed in advance. When reducing the image size the
+ *  filter is widened by the reduction factor so that all source pixels contribute.
+ */
+template<class TT>
+class DiResampleWeightsTemplate
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  filter     resampling filter (5 = box, 6 = bilinear, 7 = Lanczos-3)
+     *  @param  src_size   number of source pixels
+     *  @param  dest_size  number of destination pixels
+     */
+    DiResampleWeightsTemplate(const int filter,
+                              const Uint16 src_size,
+                              const Uint16 dest_size)
+      : Taps(0),
+        First(NULL),
+        Count(NULL),
+        Weights(NULL)
+    {
+        const double support0 = (filter == 7) ? 3.0 : ((filter == 6) ? 1.0 : 0.5);
+        const double scale = OFstatic_cast(double, src_size) / OFstatic_cast(double, dest_size);
+        const double filterScale = (scale > 1.0) ? scale : 1.0;
+        const double support = support0 * filterScale;
+        // computed as unsigned long since the support exceeds 32767 pixels for large
+        // reductions, but never more than all source pixels contribute
+        Taps = OFstatic_cast(unsigned long, ceil(support)) * 2 + 1;
+        if (Taps > src_size)
+            Taps = src_size;
+        First = new Uint16[dest_size];
+        Count = new Uint16[dest_size];
+        Weights = new TT[OFstatic_cast(unsigned long, dest_size) * Taps];
+        double *w = new double[Taps];
+        for (Uint16 i = 0; i < dest_size; ++i)
+        {
+            const double center = (i + 0.5) * scale;
+            signed long xmin = OFstatic_cast(signed long, center - support + 0.5);
+            signed long xmax = OFstatic_cast(signed long, center + support + 0.5);
+            if (xmin < 0)
+                xmin = 0;
+            if (xmax > OFstatic_cast(signed long, src_size))
+                xmax = src_size;
+            if (xmax - xmin > OFstatic_cast(signed long, Taps))
+                xmax = xmin + Taps;
+            double total = 0;
+            signed long k;
+            for (k = 0; k < xmax - xmin; ++k)
+            {
+                w[k] = filterValue(filter, (k + xmin - center + 0.5) / filterScale);
+                total += w[k];
+            }
+            TT *wp = Weights + OFstatic_cast(unsigned long, i) * Taps;
+            if (total != 0)
+            {
+                for (k = 0; k < xmax - xmin; ++k)
+                    wp[k] = OFstatic_cast(TT, w[k] / total);
+            } else {                                  // should never happen, use nearest neighbor
+                xmin = OFstatic_cast(signed long, center);
+                if (xmin >= OFstatic_cast(signed long, src_size))
+                    xmin = src_size - 1;
+                xmax = xmin + 1;
+                wp[0] = 1;
+            }
+            First[i] = OFstatic_cast(Uint16, xmin);
+            Count[i] = OFstatic_cast(Uint16, xmax - xmin);
+        }
+        delete[] w;
+    }
+
+    /** destructor
+     */
+    ~DiResampleWeightsTemplate()
+    {
+        delete[] First;
+        delete[] Count;
+        delete[] Weights;
+    }
+
+    /// maximum number of source pixels contributing to a destination pixel
+    unsigned long Taps;
+    /// index of the first contributing source pixel (for each destination pixel)
+    Uint16 *First;
+    /// number of contributing source pixels (for each destination pixel)
+    Uint16 *Count;
+    /// normalized weights of the contributing source pixels (Taps entries per destination pixel)
+    TT *Weights;
+
+
+ private:
+
+    /** compute value of the resampling filter
+     *
+     ** @param  filter  resampling filter (5 = box, 6 = bilinear, 7 = Lanczos-3)
+     *  @param  x       distance from the center of the filter (in source pixels)
+     *
+     ** @return filter value
+     */
+    static double filterValue(const int filter,
+                              double x)
+    {
+        if (filter == 5)                              // box
+            return ((x >= -0.5) && (x < 0.5)) ? 1.0 : 0.0;
+        if (x < 0)
+            x = -x;
+        if (filter == 6)                              // triangle
+            return (x < 1.0) ? 1.0 - x : 0.0;
+        if (x >= 3.0)                                 // Lanczos-3
+            return 0.0;
+        if (x < 1e-8)
+            return 1.0;
+        const double px = 3.14159265358979323846 * x;
+        return 3.0 * sin(px) * sin(px / 3.0) / (px * px);
+    }
+
+ // --- declarations to avoid compiler warnings
+
+    DiResampleWeightsTemplate(const DiResampleWeightsTemplate<TT> &);
+    DiResampleWeightsTemplate<TT> &operator=(const DiResampleWeightsTemplate<TT> &);
+};
+
+
+/** Template class to resample a single frame/plane with a separable filter.
+ *  The horizontal pass resamples the source rows into a temporary buffer, the
+ *  vertical pass combines whole rows of this buffer, so that the inner loops of
+ *  both passes can be vectorized by the compiler. Both passes are processed in
+ *  bands of rows by a DiThreadedLoop.
+ */
+template<class T, class TT>
+class DiResampleLoopTemplate
+  : public DiThreadedLoop
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  x_weights  weights of the horizontal pass
+     *  @param  y_weights  weights of the vertical pass
+     *  @param  columns    width of the source image (i.e. distance between two source rows)
+     *  @param  src_rows   number of source rows to be resampled
+     *  @param  dest_cols  width of the destination image
+     *  @param  dest_rows  height of the destination image
+     *  @param  temp       temporary buffer (src_rows * dest_cols entries)
+     *  @param  minVal     minimum output value
+     *  @param  maxVal     maximum output value
+     */
+    DiResampleLoopTemplate(const DiResampleWeightsTemplate<TT> &x_weights,
+                           const DiResampleWeightsTemplate<TT> &y_weights,
+                           const Uint16 columns,
+                           const Uint16 src_rows,
+                           const Uint16 dest_cols,
+                           const Uint16 dest_rows,
+                           TT *temp,
+                           const TT minVal,
+                           const TT maxVal)
+      : DiThreadedLoop(),
+        XWeights(x_weights),
+        YWeights(y_weights),
+        Columns(columns),
+        SrcRows(src_rows),
+        DestCols(dest_cols),
+        DestRows(dest_rows),
+        Temp(temp),
+        MinValue(minVal),
+        MaxValue(maxVal),
+        Source(NULL),
+        Dest(NULL),
+        Horizontal(OFTrue)
+    {
+    }
+
+    /** destructor
+     */
+    virtual ~DiResampleLoopTemplate()
+    {
+    }
+
+    /** resample a single frame/plane
+     *
+     ** @param  src   pointer to the first source pixel
+     *  @param  dest  pointer to the first destination pixel
+     */
+    void resample(const T *src,
+                  T *dest)
+    {
+        const unsigned long minimum = DI_MINIMUM_BAND_SIZE / DestCols;
+        Source = src;
+        Dest = dest;
+        Horizontal = OFTrue;
+        process(SrcRows, (minimum > 0) ? minimum : 1);
+        Horizontal = OFFalse;
+        process(DestRows, (minimum > 0) ? minimum : 1);
+    }
+
+    /** resample a band of rows (of the current pass)
+     *
+     ** @param  first  index of the first row of the band
+     *  @param  count  number of rows of the band
+     */
+    virtual void processBand(const unsigned long first,
+                             const unsigned long count)
+    {
+        if (Horizontal)
+            resampleRows(first, count);
+        else
+            resampleColumns(first, count);
+    }
+
+
+ private:
+
+    /** horizontal pass: resample source rows into the temporary buffer
+     *
+     ** @param  first  index of the first source row
+     *  @param  count  number of source rows
+     */
+    void resampleRows(const unsigned long first,
+                      const unsigned long count)
+    {
+        const unsigned long taps = XWeights.Taps;
+        for (unsigned long y = first; y < first + count; ++y)
+        {
+            const T *p = Source + y * OFstatic_cast(unsigned long, Columns);
+            TT *q = Temp + y * OFstatic_cast(unsigned long, DestCols);
+            for (Uint16 x = 0; x < DestCols; ++x)
+            {
+                const T *s = p + XWeights.First[x];
+                const TT *w = XWeights.Weights + OFstatic_cast(unsigned long, x) * taps;
+                const Uint16 n = XWeights.Count[x];
+                TT sum = 0;
+                for (Uint16 k = 0; k < n; ++k)
+                    sum += w[k] * OFstatic_cast(TT, s[k]);
+                q[x] = sum;
+            }
+        }
+    }
+
+    /** vertical pass: resample the temporary buffer into destination rows
+     *
+     ** @param  first  index of the first destination row
+     *  @param  count  number of destination rows
+     */
+    void resampleColumns(const unsigned long first,
+                         const unsigned long count)
+    {
+        const unsigned long taps = YWeights.Taps;
+        TT *sum = new TT[DestCols];
+        for (unsigned long y = first; y < first + count; ++y)
+        {
+            const TT *w = YWeights.Weights + y * taps;
+            const TT *p = Temp + OFstatic_cast(unsigned long, YWeights.First[y]) * DestCols;
+            const Uint16 n = YWeights.Count[y];
+            Uint16 x;
+            for (x = 0; x < DestCols; ++x)
+                sum[x] = w[0] * p[x];
+            for (Uint16 k = 1; k < n; ++k)
+            {
+                const TT wk = w[k];
+                p += DestCols;
+                for (x = 0; x < DestCols; ++x)
+                    sum[x] += wk * p[x];
+            }
+            T *q = Dest + y * OFstatic_cast(unsigned long, DestCols);
+            for (x = 0; x < DestCols; ++x)
+            {
+                const TT value = (sum[x] < MinValue) ? MinValue : ((sum[x] > MaxValue) ? MaxValue : sum[x]);
+                q[x] = OFstatic_cast(T, (value < 0) ? value - 0.5f : value + 0.5f);
+            }
+        }
+        delete[] sum;
+    }
+
+    /// weights of the horizontal pass
+    const DiResampleWeightsTemplate<TT> &XWeights;
+    /// weights of the vertical pass
+    const DiResampleWeightsTemplate<TT> &YWeights;
+    /// width of the source image
+    const Uint16 Columns;
+    /// number of source rows
+    const Uint16 SrcRows;
+    /// width of the destination image
+    const Uint16 DestCols;
+    /// height of the destination image
+    const Uint16 DestRows;
+    /// temporary buffer storing the result of the horizontal pass
+    TT *Temp;
+    /// minimum output value
+    const TT MinValue;
+    /// maximum output value
+    const TT MaxValue;
+    /// pointer to the first source pixel of the current frame/plane
+    const T *Source;
+    /// pointer to the first destination pixel of the current frame/plane
+    T *Dest;
+    /// status flag indicating the current pass
+    OFBool Horizontal;
+
+ // --- declarations to avoid compiler warnings
+
+    DiResampleLoopTemplate(const DiResampleLoopTemplate<T, TT> &);
+    DiResampleLoopTemplate<T, TT> &operator=(const DiResampleLoopTemplate<T, TT> &);
+};
+
+
 /** Template class to scale images (on pixel data level).
  *  with and without interpolation
  */
@@ -181,7 +493,8 @@ class DiScaleTemplate
      ** @param  src          array of pointers to source image pixels
      *  @param  dest         array of pointers to destination image pixels
      *  @param  interpolate  preferred interpolation algorithm (0 = no interpolation, 1 = pbmplus algorithm,
-     *                         2 = c't algorithm, 3 = bilinear magnification, 4 = bicubic magnification)
+     *                         2 = c't algorithm, 3 = bilinear magnification, 4 = bicubic magnification,
+     *                         5 = box filter, 6 = bilinear filter, 7 = Lanczos filter)
      *  @param  value        value to be set outside the image boundaries (used for clipping, default: 0)
      */
     void scaleData(const T *src[],
@@ -211,6 +524,10 @@ class DiScaleTemplate
                 else
                     clipBorderPixel(src, dest, value);                                // clipping (with border)
             }
+            else if ((interpolate >= 5) && (interpolate <= 7) && (Left >= 0) && (Top >= 0) &&
+                     (OFstatic_cast(unsigned long, Left + this->Src_X) <= Columns) &&
+                     (OFstatic_cast(unsigned long, Top + this->Src_Y) <= Rows))
+                resamplePixel(src, dest, interpolate);                                // separable resampling filter
             else if ((interpolate == 1) && (this->Bits <= MAX_INTERPOLATION_BITS))
                 interpolatePixel(src, dest);                                          // interpolation (pbmplus)
             else if ((interpolate == 4) && (this->Dest_X >= this->Src_X) && (this->Dest_Y >= this->Src_Y) &&
@@ -1234,6 +1551,68 @@ class DiScaleTemplate
         }
         delete[] pTemp;
     }
+
+   /** resampling with a separable filter (box, bilinear or Lanczos-3) for magnification and
+    *  reduction. The weights of the filter are computed in advance for each destination row
+    *  and column. Images with up to 16 bits per sample are resampled with single precision.
+    *
+    ** @param  src          array of pointers to source image pixels
+    *  @param  dest         array of pointers to destination image pixels
+    *  @param  interpolate  resampling filter (5 = box, 6 = bilinear, 7 = Lanczos-3)
+    */
+    void resamplePixel(const T *src[],
+                       T *dest[],
+                       const int interpolate)
+    {
+        if (sizeof(T) <= 2)
+            resampleFrames<float>(src, dest, interpolate);
+        else
+            resampleFrames<double>(src, dest, interpolate);
+    }
+
+   /** resample all frames and planes with a separable filter (helper function)
+    *
+    ** @param  src          array of pointers to source image pixels
+    *  @param  dest         array of pointers to destination image pixels
+    *  @param  interpolate  resampling filter (5 = box, 6 = bilinear, 7 = Lanczos-3)
+    */
+    template<class TT>
+    void resampleFrames(const T *src[],
+                        T *dest[],
+                        const int interpolate)
+    {
+        DCMIMGLE_DEBUG("using separable resampling algorithm with "
+            << ((interpolate == 7) ? "Lanczos" : ((interpolate == 6) ? "bilinear" : "box")) << " filter");
+        const int bits = (this->Bits > 0) ? this->Bits : OFstatic_cast(int, bitsof(T));
+        const TT minVal = (isSigned()) ? -OFstatic_cast(TT, DicomImageClass::maxval(bits - 1, 0)) : 0;
+        const TT maxVal = OFstatic_cast(TT, DicomImageClass::maxval(bits - isSigned()));
+        const unsigned long f_size = OFstatic_cast(unsigned long, Rows) * OFstatic_cast(unsigned long, Columns);
+        const unsigned long d_size = OFstatic_cast(unsigned long, this->Dest_X) * OFstatic_cast(unsigned long, this->Dest_Y);
+        // buffer used for storing temporarily the horizontally resampled rows
+        TT *temp = new (std::nothrow) TT[OFstatic_cast(unsigned long, this->Src_Y) * OFstatic_cast(unsigned long, this->Dest_X)];
+        if (temp == NULL)
+        {
+            DCMIMGLE_ERROR("can't allocate temporary buffer for resampling");
+            this->clearPixel(dest);
+            return;
+        }
+        const DiResampleWeightsTemplate<TT> x_weights(interpolate, this->Src_X, this->Dest_X);
+        const DiResampleWeightsTemplate<TT> y_weights(interpolate, this->Src_Y, this->Dest_Y);
+        DiResampleLoopTemplate<T, TT> loop(x_weights, y_weights, Columns, this->Src_Y, this->Dest_X, this->Dest_Y,
+            temp, minVal, maxVal);
+        for (int j = 0; j < this->Planes; ++j)
+        {
+            const T *p = src[j] + OFstatic_cast(unsigned long, Top) * OFstatic_cast(unsigned long, Columns) + Left;
+            T *q = dest[j];
+            for (unsigned long f = this->Frames; f != 0; --f)
+            {
+                loop.resample(p, q);
+                p += f_size;
+                q += d_size;
+            }
+        }
+        delete[] temp;
+    }
 };
 
 #endif
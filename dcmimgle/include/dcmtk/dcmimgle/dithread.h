@@ -0,0 +1,161 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomThreadedLoop (Header)
+ *
+ */
+
+
+#ifndef DITHREAD_H
+#define DITHREAD_H
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmimgle/didefine.h"
+
+
+/*---------------------*
+ *  macro definitions  *
+ *---------------------*/
+
+/// minimum number of items processed by a single thread of a DiThreadedLoop
+#define DI_MINIMUM_BAND_SIZE 131072
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Abstract base class for loops over a number of independent items (e.g. pixels).
+ *  The items are split into bands, which are processed in parallel by up to
+ *  DicomImageClass::getNumberOfThreads() threads. The calling thread processes the
+ *  first band itself, i.e. no additional thread is started for small loops or if
+ *  only one thread is configured (default).
+ */
+class DCMTK_DCMIMGLE_EXPORT DiThreadedLoop
+{
+
+ public:
+
+    /** constructor
+     */
+    DiThreadedLoop();
+
+    /** destructor
+     */
+    virtual ~DiThreadedLoop();
+
+    /** process all items of the loop and return after all bands have been processed
+     *
+     ** @param  count    number of items to be processed
+     *  @param  minimum  minimum number of items per band (i.e. per thread)
+     */
+    void process(const unsigned long count,
+                 const unsigned long minimum = DI_MINIMUM_BAND_SIZE);
+
+    /** process a band of items (called by the threads)
+     *
+     ** @param  first  index of the first item of the band
+     *  @param  count  number of items of the band
+     */
+    virtual void processBand(const unsigned long first,
+                             const unsigned long count) = 0;
+};
+
+
+/** Template class to apply a lookup table to a number of pixels (band by band).
+ *  In-place processing is supported, i.e. the source and the target might be the
+ *  same memory area.
+ */
+template<class T1, class T3>
+class DiLookupLoopTemplate
+  : public DiThreadedLoop
+{
+
+ public:
+
+    /** constructor
+     *
+     ** @param  source  pointer to the first input pixel
+     *  @param  target  pointer to the first output pixel
+     *  @param  lut0    pointer to the 'zero' entry of the lookup table
+     */
+    DiLookupLoopTemplate(const T1 *source,
+                         T3 *target,
+                         const T3 *lut0)
+      : DiThreadedLoop(),
+        Source(source),
+        Target(target),
+        Lut0(lut0)
+    {
+    }
+
+    /** destructor
+     */
+    virtual ~DiLookupLoopTemplate()
+    {
+    }
+
+    /** apply the lookup table to a band of pixels.
+     *  The loop is unrolled and all pixels of a group are looked up before they
+     *  are stored, since the output buffer might alias the input data (at least
+     *  in the eyes of the compiler) and would otherwise serialize the lookups.
+     *
+     ** @param  first  index of the first pixel of the band
+     *  @param  count  number of pixels of the band
+     */
+    virtual void processBand(const unsigned long first,
+                             const unsigned long count)
+    {
+        const T1 *p = Source + first;
+        T3 *q = Target + first;
+        unsigned long i;
+        for (i = count >> 2; i != 0; --i)
+        {
+            const T3 value0 = *(Lut0 + p[0]);
+            const T3 value1 = *(Lut0 + p[1]);
+            const T3 value2 = *(Lut0 + p[2]);
+            const T3 value3 = *(Lut0 + p[3]);
+            q[0] = value0;
+            q[1] = value1;
+            q[2] = value2;
+            q[3] = value3;
+            p += 4;
+            q += 4;
+        }
+        for (i = count & 3; i != 0; --i)                                      // remaining pixels
+            *(q++) = *(Lut0 + (*(p++)));
+    }
+
+
+ private:
+
+    /// pointer to the first input pixel
+    const T1 *Source;
+    /// pointer to the first output pixel
+    T3 *Target;
+    /// pointer to the 'zero' entry of the lookup table
+    const T3 *Lut0;
+
+ // --- declarations to avoid compiler warnings
+
+    DiLookupLoopTemplate(const DiLookupLoopTemplate<T1, T3> &);
+    DiLookupLoopTemplate<T1, T3> &operator=(const DiLookupLoopTemplate<T1, T3> &);
+};
+
+
+#endif
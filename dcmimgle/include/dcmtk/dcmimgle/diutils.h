@@ -460,6 +460,23 @@ class DCMTK_DCMIMGLE_EXPORT DicomImageClass
     static EP_Representation determineRepresentation(double minvalue,
                                                      double maxvalue);
 
+    /** set the maximum number of threads used for processing the pixel data of a frame.
+     *  The pixel data is split into bands which are processed in parallel, e.g. when
+     *  applying the modality and VOI transformation or when rendering color images.
+     *  Small images are always processed by the calling thread only. This setting is
+     *  global, i.e. it applies to all images, and is ignored if DCMTK has been compiled
+     *  without thread support.
+     *
+     ** @param  threads  maximum number of threads (default: 1, i.e. no parallel processing)
+     */
+    static void setNumberOfThreads(const unsigned long threads);
+
+    /** get the maximum number of threads used for processing the pixel data of a frame
+     *
+     ** @return maximum number of threads (at least 1)
+     */
+    static unsigned long getNumberOfThreads();
+
 };
 
 
@@ -72,6 +72,29 @@ DicomImage::DicomImage(const OFFilename &filename,
 }
 
 
+// --- create 'DicomImage' from 'filename' for the given region of interest
+
+DicomImage::DicomImage(const OFFilename &filename,
+                       const unsigned long flags,
+                       const unsigned long fstart,
+                       const unsigned long fcount,
+                       const unsigned long left_pos,
+                       const unsigned long top_pos,
+                       const unsigned long width,
+                       const unsigned long height)
+  : ImageStatus(EIS_Normal),
+    PhotometricInterpretation(EPI_Unknown),
+    Document(NULL),
+    Image(NULL)
+{
+    if (checkDataDictionary())                  // valid 'dicom.dic' found ?
+    {
+        Document = new DiDocument(filename, flags | CIF_MayDetachPixelData, fstart, fcount);
+        Init(left_pos, top_pos, width, height);
+    }
+}
+
+
 // --- create 'DicomImage' from valid 'DicomObject' with transfer syntax 'xfer'
 
 DicomImage::DicomImage(DcmObject *object,
@@ -92,6 +115,30 @@ DicomImage::DicomImage(DcmObject *object,
 }
 
 
+// --- create 'DicomImage' from valid 'DicomObject' with transfer syntax 'xfer' for the given region of interest
+
+DicomImage::DicomImage(DcmObject *object,
+                       const E_TransferSyntax xfer,
+                       const unsigned long flags,
+                       const unsigned long fstart,
+                       const unsigned long fcount,
+                       const unsigned long left_pos,
+                       const unsigned long top_pos,
+                       const unsigned long width,
+                       const unsigned long height)
+  : ImageStatus(EIS_Normal),
+    PhotometricInterpretation(EPI_Unknown),
+    Document(NULL),
+    Image(NULL)
+{
+    if (checkDataDictionary())                  // valid 'dicom.dic' found ?
+    {
+        Document = new DiDocument(object, xfer, flags, fstart, fcount);
+        Init(left_pos, top_pos, width, height);
+    }
+}
+
+
 // --- create 'DicomImage' from valid 'DicomObject' with given rescale 'slope' and 'intercept'
 
 DicomImage::DicomImage(DcmObject *object,
@@ -262,6 +309,39 @@ void DicomImage::Init()
 }
 
 
+// --- initialize 'DicomImage' object for a region of interest
+
+void DicomImage::Init(const unsigned long left_pos,
+                      const unsigned long top_pos,
+                      const unsigned long width,
+                      const unsigned long height)
+{
+    if ((Document != NULL) && (Document->good()))
+    {
+        if (Document->setRegion(left_pos, top_pos, width, height))
+        {
+            Init();
+            /* clip image if the region has not been processed while converting the pixel data (e.g. color images) */
+            if ((Image != NULL) && (ImageStatus == EIS_Normal) &&
+                ((Image->getColumns() != Document->getRegionWidth()) || (Image->getRows() != Document->getRegionHeight())))
+            {
+                DCMIMGLE_DEBUG("clipping converted image to region of interest");
+                DiImage *image = Image->createScale(Document->getRegionLeft(), Document->getRegionTop(),
+                    Document->getRegionWidth(), Document->getRegionHeight(), Document->getRegionWidth(),
+                    Document->getRegionHeight(), 0, 0, 0);
+                delete Image;
+                Image = image;
+                if (Image == NULL)
+                    ImageStatus = EIS_MemoryFailure;
+            }
+        } else
+            ImageStatus = EIS_InvalidValue;
+    }
+    else
+        ImageStatus = EIS_InvalidDocument;
+}
+
+
 // --- check whether the loadable 'DataDictionary' is present/loaded
 
 int DicomImage::checkDataDictionary()
@@ -782,6 +862,20 @@ int DicomImage::writePluginFormat(const DiPluginFormat *plugin,
 }
 
 
+// --- write 'fcount' frames of image data starting from 'fstart' to 'filename' pluggable image format
+
+int DicomImage::writePluginFormat(const DiPluginFormat *plugin,
+                                  const char *filename,
+                                  const unsigned long fstart,
+                                  const unsigned long fcount,
+                                  const unsigned long fnumber)
+{
+    if ((plugin != NULL) && (filename != NULL) && (Image != NULL))
+        return plugin->writeFrames(Image, filename, fstart, fcount, fnumber);
+    return 0;
+}
+
+
 // --- same for open C 'FILE' in pluggable image format
 
 int DicomImage::writePluginFormat(const DiPluginFormat *plugin,
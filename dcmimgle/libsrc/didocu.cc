@@ -42,6 +42,10 @@ DiDocument::DiDocument(const OFFilename &filename,
     Xfer(EXS_Unknown),
     FrameStart(fstart),
     FrameCount(fcount),
+    RegionLeft(0),
+    RegionTop(0),
+    RegionWidth(0),
+    RegionHeight(0),
     Flags(flags),
     PhotometricInterpretation()
 {
@@ -75,6 +79,10 @@ DiDocument::DiDocument(DcmObject *object,
     Xfer(xfer),
     FrameStart(fstart),
     FrameCount(fcount),
+    RegionLeft(0),
+    RegionTop(0),
+    RegionWidth(0),
+    RegionHeight(0),
     Flags(flags),
     PhotometricInterpretation()
 {
@@ -209,6 +217,35 @@ DiDocument::~DiDocument()
 /********************************************************************/
 
 
+int DiDocument::setRegion(const unsigned long left_pos,
+                          const unsigned long top_pos,
+                          unsigned long width,
+                          unsigned long height)
+{
+    Uint16 columns = 0;
+    Uint16 rows = 0;
+    if ((getValue(DCM_Columns, columns) > 0) && (getValue(DCM_Rows, rows) > 0) && (left_pos < columns) && (top_pos < rows))
+    {
+        if ((width == 0) || (left_pos + width > columns))       // restrict region to the image area
+            width = columns - left_pos;
+        if ((height == 0) || (top_pos + height > rows))
+            height = rows - top_pos;
+        RegionLeft = OFstatic_cast(Uint16, left_pos);
+        RegionTop = OFstatic_cast(Uint16, top_pos);
+        RegionWidth = OFstatic_cast(Uint16, width);
+        RegionHeight = OFstatic_cast(Uint16, height);
+        DCMIMGLE_DEBUG("region of interest: " << RegionWidth << "x" << RegionHeight << " pixels at ("
+            << RegionLeft << "," << RegionTop << ")");
+        return 1;
+    }
+    DCMIMGLE_ERROR("region of interest (" << left_pos << "," << top_pos << ") outside the image area");
+    return 0;
+}
+
+
+/********************************************************************/
+
+
 DcmElement *DiDocument::search(const DcmTagKey &tag,
                                DcmObject *obj) const
 {
@@ -0,0 +1,340 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomImageFrameIterator (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcpixel.h"
+#include "dcmtk/dcmdata/dcpixseq.h"
+#include "dcmtk/dcmdata/dcpxitem.h"
+
+#include "dcmtk/dcmimgle/diframit.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Thread creating the image for the next step of a frame iterator
+ */
+class DiFramePrefetcher
+  : public OFThread
+{
+
+ public:
+
+    DiFramePrefetcher(DicomImageFrameIterator &iterator,
+                      const int slot,
+                      const unsigned long fstart,
+                      const unsigned long fcount)
+      : OFThread(),
+        Iterator(iterator),
+        Slot(slot),
+        First(fstart),
+        Count(fcount),
+        Image(NULL)
+    {
+    }
+
+    virtual void run()
+    {
+        Image = Iterator.createImage(Slot, First, Count);
+    }
+
+    inline DicomImage *getImage() const
+    {
+        return Image;
+    }
+
+
+ private:
+
+    /// iterator the image is created for
+    DicomImageFrameIterator &Iterator;
+    /// fileformat slot to be used
+    const int Slot;
+    /// index of the first frame of the image
+    const unsigned long First;
+    /// number of frames of the image
+    const unsigned long Count;
+    /// image created by the thread (maybe NULL)
+    DicomImage *Image;
+
+ // --- declarations to avoid compiler warnings
+
+    DiFramePrefetcher(const DiFramePrefetcher &);
+    DiFramePrefetcher &operator=(const DiFramePrefetcher &);
+};
+
+#endif
+
+
+/*------------------*
+ *  static helpers  *
+ *------------------*/
+
+/* remove the value of all compressed pixel items that have been loaded from file,
+ * i.e. the fragments of the frames processed so far do not stay in memory
+ */
+static void compactPixelData(DcmObject *object)
+{
+    DcmDataset *dataset = NULL;
+    if (object != NULL)
+    {
+        if (object->ident() == EVR_fileFormat)
+            dataset = OFstatic_cast(DcmFileFormat *, object)->getDataset();
+        else if (object->ident() == EVR_dataset)
+            dataset = OFstatic_cast(DcmDataset *, object);
+    }
+    DcmElement *element = NULL;
+    if ((dataset != NULL) && dataset->findAndGetElement(DCM_PixelData, element).good() && (element != NULL))
+    {
+        DcmPixelData *pixelData = OFstatic_cast(DcmPixelData *, element);
+        E_TransferSyntax repType = EXS_Unknown;
+        const DcmRepresentationParameter *repParam = NULL;
+        pixelData->getOriginalRepresentationKey(repType, repParam);
+        DcmPixelSequence *pixelSeq = NULL;
+        if (DcmXfer(repType).usesEncapsulatedFormat() &&
+            pixelData->getEncapsulatedRepresentation(repType, repParam, pixelSeq).good() && (pixelSeq != NULL))
+        {
+            DcmPixelItem *pixelItem = NULL;
+            const unsigned long count = pixelSeq->card();
+            for (unsigned long i = 0; i < count; ++i)
+            {
+                if (pixelSeq->getItem(pixelItem, i).good() && (pixelItem != NULL))
+                    pixelItem->compact();
+            }
+        }
+    }
+}
+
+
+/*----------------*
+ *  constructors  *
+ *----------------*/
+
+DicomImageFrameIterator::DicomImageFrameIterator(const OFFilename &filename,
+                                                 const unsigned long flags,
+                                                 const unsigned long fstart,
+                                                 const unsigned long fcount,
+                                                 const unsigned long fstep,
+                                                 const OFBool prefetch)
+  : Filename(filename),
+    Object(NULL),
+    Xfer(EXS_Unknown),
+    Flags((flags | CIF_UsePartialAccessToPixelData) & ~(CIF_DecompressCompletePixelData | CIF_TakeOverExternalDataset)),
+    FrameStep((fstep > 0) ? fstep : 1),
+#ifdef WITH_THREADS
+    Prefetch(prefetch),
+#else
+    Prefetch(OFFalse),
+#endif
+    StartFrame(fstart),
+    EndFrame(fstart),
+    NextFrame(fstart),
+    Slot(0),
+    CurrentImage(NULL),
+    NextImage(NULL),
+    Prefetcher(NULL),
+    Status(EIS_Normal)
+{
+    FileFormat[0] = NULL;
+    FileFormat[1] = NULL;
+    init(fstart, fcount);
+}
+
+
+DicomImageFrameIterator::DicomImageFrameIterator(DcmObject *object,
+                                                 const E_TransferSyntax xfer,
+                                                 const unsigned long flags,
+                                                 const unsigned long fstart,
+                                                 const unsigned long fcount,
+                                                 const unsigned long fstep)
+  : Filename(),
+    Object(object),
+    Xfer(xfer),
+    Flags((flags | CIF_UsePartialAccessToPixelData) & ~(CIF_DecompressCompletePixelData | CIF_TakeOverExternalDataset)),
+    FrameStep((fstep > 0) ? fstep : 1),
+    Prefetch(OFFalse),
+    StartFrame(fstart),
+    EndFrame(fstart),
+    NextFrame(fstart),
+    Slot(0),
+    CurrentImage(NULL),
+    NextImage(NULL),
+    Prefetcher(NULL),
+    Status(EIS_Normal)
+{
+    FileFormat[0] = NULL;
+    FileFormat[1] = NULL;
+    if (Object != NULL)
+        init(fstart, fcount);
+    else
+        Status = EIS_InvalidDocument;
+}
+
+
+/*--------------*
+ *  destructor  *
+ *--------------*/
+
+DicomImageFrameIterator::~DicomImageFrameIterator()
+{
+    waitForPrefetch();
+    delete CurrentImage;
+    delete NextImage;
+    delete FileFormat[0];
+    delete FileFormat[1];
+}
+
+
+/********************************************************************/
+
+
+void DicomImageFrameIterator::init(const unsigned long fstart,
+                                   const unsigned long fcount)
+{
+    /* the total number of frames is not known before the first image has been created */
+    EndFrame = fstart + ((fcount > 0) ? fcount : FrameStep);
+    NextImage = createImage(0, fstart, getStepCount(fstart));
+    if (NextImage == NULL)
+    {
+        Status = EIS_InvalidDocument;
+        EndFrame = fstart;
+    }
+    else if (NextImage->getStatus() != EIS_Normal)
+    {
+        Status = NextImage->getStatus();
+        DCMIMGLE_ERROR("can't create image for frame " << fstart << ": " << DicomImage::getString(Status));
+        delete NextImage;
+        NextImage = NULL;
+        EndFrame = fstart;
+    } else {
+        const unsigned long frames = NextImage->getNumberOfFrames();
+        if ((fcount == 0) || (EndFrame > frames))
+            EndFrame = (frames > fstart) ? frames : fstart;
+        DCMIMGLE_DEBUG("iterating over " << (EndFrame - StartFrame) << " frames in steps of " << FrameStep
+            << ((Prefetch) ? " with prefetching" : ""));
+    }
+}
+
+
+unsigned long DicomImageFrameIterator::getStepCount(const unsigned long fstart) const
+{
+    return (EndFrame - fstart < FrameStep) ? EndFrame - fstart : FrameStep;
+}
+
+
+DicomImage *DicomImageFrameIterator::createImage(const int slot,
+                                                 const unsigned long fstart,
+                                                 const unsigned long fcount)
+{
+    DcmObject *object = Object;
+    E_TransferSyntax xfer = Xfer;
+    if (!Filename.isEmpty())
+    {
+        /* each slot uses its own copy of the file, see class documentation */
+        if (FileFormat[slot] == NULL)
+        {
+            FileFormat[slot] = new DcmFileFormat();
+            if (FileFormat[slot]->loadFile(Filename).bad())
+            {
+                DCMIMGLE_ERROR("can't read file '" << Filename << "'");
+                delete FileFormat[slot];
+                FileFormat[slot] = NULL;
+                return NULL;
+            }
+        }
+        object = FileFormat[slot];
+        xfer = FileFormat[slot]->getDataset()->getOriginalXfer();
+    }
+    return new DicomImage(object, xfer, Flags, fstart, fcount);
+}
+
+
+void DicomImageFrameIterator::waitForPrefetch()
+{
+#ifdef WITH_THREADS
+    if (Prefetcher != NULL)
+    {
+        Prefetcher->join();
+        NextImage = Prefetcher->getImage();
+        delete Prefetcher;
+        Prefetcher = NULL;
+    }
+#endif
+}
+
+
+DicomImage *DicomImageFrameIterator::next()
+{
+    if (CurrentImage != NULL)
+    {
+        delete CurrentImage;
+        CurrentImage = NULL;
+        /* the slot of the current image is the one not used for the next image */
+        compactPixelData((Object != NULL) ? Object : FileFormat[(Prefetch) ? 1 - Slot : Slot]);
+    }
+    waitForPrefetch();
+    if ((Status == EIS_Normal) && (NextFrame < EndFrame))
+    {
+        const unsigned long fcount = getStepCount(NextFrame);
+        /* create image in the calling thread if it has not been prefetched */
+        if (NextImage == NULL)
+            NextImage = createImage(Slot, NextFrame, fcount);
+        if (NextImage == NULL)
+            Status = EIS_InvalidDocument;
+        else if (NextImage->getStatus() != EIS_Normal)
+        {
+            Status = NextImage->getStatus();
+            DCMIMGLE_ERROR("can't create image for frame " << NextFrame << ": " << DicomImage::getString(Status));
+            delete NextImage;
+            NextImage = NULL;
+        } else {
+            CurrentImage = NextImage;
+            NextImage = NULL;
+            NextFrame += fcount;
+#ifdef WITH_THREADS
+            if (Prefetch)
+            {
+                Slot = 1 - Slot;
+                if (NextFrame < EndFrame)
+                {
+                    Prefetcher = new DiFramePrefetcher(*this, Slot, NextFrame, getStepCount(NextFrame));
+                    if (Prefetcher->start() != 0)
+                    {
+                        DCMIMGLE_DEBUG("cannot start thread, creating next image in calling thread");
+                        delete Prefetcher;
+                        Prefetcher = NULL;
+                    }
+                }
+            }
+#endif
+        }
+    }
+    return CurrentImage;
+}
@@ -39,7 +39,8 @@
 
 DiImage::DiImage(const DiDocument *docu,
                  const EI_Status status,
-                 const int spp)
+                 const int spp,
+                 const OFBool region)
   : ImageStatus(status),
     Document(docu),
     FirstFrame(0),
@@ -65,7 +66,11 @@ DiImage::DiImage(const DiDocument *docu,
     isOriginal(1),
     InputData(NULL),
     FileCache(),
-    CurrentFragment(0)
+    CurrentFragment(0),
+    StoredRows(0),
+    StoredColumns(0),
+    RegionLeft(0),
+    RegionTop(0)
 {
     if ((Document != NULL) && (ImageStatus == EIS_Normal))
     {
@@ -210,6 +215,16 @@ DiImage::DiImage(const DiDocument *docu,
             }
             if (ok && (Document->getPixelData() != NULL))
             {
+                StoredRows = Rows;
+                StoredColumns = Columns;
+                // restrict image to the region of interest (if any)
+                if (region && Document->hasRegion() && (SamplesPerPixel == 1))
+                {
+                    RegionLeft = Document->getRegionLeft();
+                    RegionTop = Document->getRegionTop();
+                    Columns = Document->getRegionWidth();
+                    Rows = Document->getRegionHeight();
+                }
                 // convert pixel data (if present)
                 convertPixelData();
             } else {
@@ -254,7 +269,11 @@ DiImage::DiImage(const DiDocument *docu,
     isOriginal(1),
     InputData(NULL),
     FileCache(),
-    CurrentFragment(0)
+    CurrentFragment(0),
+    StoredRows(0),
+    StoredColumns(0),
+    RegionLeft(0),
+    RegionTop(0)
 {
 }
 
@@ -287,7 +306,11 @@ DiImage::DiImage(const DiImage *image,
     isOriginal(0),
     InputData(NULL),
     FileCache(),
-    CurrentFragment(0)
+    CurrentFragment(0),
+    StoredRows(0),
+    StoredColumns(0),
+    RegionLeft(0),
+    RegionTop(0)
 {
 }
 
@@ -323,7 +346,11 @@ DiImage::DiImage(const DiImage *image,
     isOriginal(0),
     InputData(NULL),
     FileCache(),
-    CurrentFragment(0)
+    CurrentFragment(0),
+    StoredRows(0),
+    StoredColumns(0),
+    RegionLeft(0),
+    RegionTop(0)
 {
     /* we do not check for "division by zero", this is already done somewhere else */
     const double xfactor = OFstatic_cast(double, Columns) / OFstatic_cast(double, image->Columns);
@@ -390,7 +417,11 @@ DiImage::DiImage(const DiImage *image,
     isOriginal(0),
     InputData(NULL),
     FileCache(),
-    CurrentFragment(0)
+    CurrentFragment(0),
+    StoredRows(0),
+    StoredColumns(0),
+    RegionLeft(0),
+    RegionTop(0)
 {
 }
 
@@ -424,7 +455,11 @@ DiImage::DiImage(const DiImage *image,
     isOriginal(0),
     InputData(NULL),
     FileCache(),
-    CurrentFragment(0)
+    CurrentFragment(0),
+    StoredRows(0),
+    StoredColumns(0),
+    RegionLeft(0),
+    RegionTop(0)
 {
 }
 
@@ -547,8 +582,16 @@ void DiImage::convertPixelData()
     /* check for valid/supported pixel data encoding */
     if ((evr == EVR_OW) || ((evr == EVR_OB) && (compressed || (BitsAllocated <= 16))))
     {
-        const unsigned long fsize = OFstatic_cast(unsigned long, Rows) * OFstatic_cast(unsigned long, Columns) *
+        const unsigned long fsize = OFstatic_cast(unsigned long, StoredRows) * OFstatic_cast(unsigned long, StoredColumns) *
             OFstatic_cast(unsigned long, SamplesPerPixel);
+        /* only convert the pixels within the region of interest (if any) */
+        const Uint16 regionCols = ((Columns != StoredColumns) || (Rows != StoredRows)) ? Columns : 0;
+        const Uint16 regionRows = (regionCols > 0) ? Rows : 0;
+        if (regionCols > 0)
+        {
+            DCMIMGLE_DEBUG("converting region of interest only: " << regionCols << "x" << regionRows << " pixels at ("
+                << RegionLeft << "," << RegionTop << ")");
+        }
         if ((BitsAllocated < 1) || (BitsStored < 1))
         {
             ImageStatus = EIS_InvalidValue;
@@ -569,9 +612,11 @@ void DiImage::convertPixelData()
             if (!compressed && (BitsAllocated > 8))
                 DCMIMGLE_WARN("invalid value for 'BitsAllocated' (" << BitsAllocated << "), > 8 for OB encoded uncompressed 'PixelData'");
             if (hasSignedRepresentation)
-                InputData = new DiInputPixelTemplate<Uint8, Sint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint8, Sint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
             else
-                InputData = new DiInputPixelTemplate<Uint8, Uint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint8, Uint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
         }
         else if ((evr == EVR_OB) && (BitsStored <= 16))
         {
@@ -579,37 +624,47 @@ void DiImage::convertPixelData()
             if (!compressed && (BitsAllocated > 8))
                 DCMIMGLE_WARN("invalid value for 'BitsAllocated' (" << BitsAllocated << "), > 8 for OB encoded uncompressed 'PixelData'");
             if (hasSignedRepresentation)
-                InputData = new DiInputPixelTemplate<Uint8, Sint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint8, Sint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
             else
-                InputData = new DiInputPixelTemplate<Uint8, Uint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint8, Uint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
         }
         else if ((evr == EVR_OB) && compressed && (BitsStored <= 32))
         {
             if (hasSignedRepresentation)
-                InputData = new DiInputPixelTemplate<Uint8, Sint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint8, Sint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
             else
-                InputData = new DiInputPixelTemplate<Uint8, Uint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint8, Uint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
         }
         else if (BitsStored <= 8)
         {
             if (hasSignedRepresentation)
-                InputData = new DiInputPixelTemplate<Uint16, Sint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint16, Sint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
             else
-                InputData = new DiInputPixelTemplate<Uint16, Uint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint16, Uint8>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
         }
         else if (BitsStored <= 16)
         {
             if (hasSignedRepresentation)
-                InputData = new DiInputPixelTemplate<Uint16, Sint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint16, Sint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
             else
-                InputData = new DiInputPixelTemplate<Uint16, Uint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint16, Uint16>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
         }
         else if (BitsStored <= 32)
         {
             if (hasSignedRepresentation)
-                InputData = new DiInputPixelTemplate<Uint16, Sint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint16, Sint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
             else
-                InputData = new DiInputPixelTemplate<Uint16, Uint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment);
+                InputData = new DiInputPixelTemplate<Uint16, Uint32>(Document, BitsAllocated, BitsStored, HighBit, FirstFrame, NumberOfFrames, fsize, &FileCache, CurrentFragment,
+                    StoredColumns, RegionLeft, RegionTop, regionCols, regionRows);
         }
         else    /* BitsStored > 32 !! */
         {
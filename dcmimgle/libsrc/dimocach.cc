@@ -0,0 +1,231 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomMonochromeRenderCache (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmimgle/dimocach.h"
+#include "dcmtk/dcmimgle/didispfn.h"
+
+
+/*----------------*
+ *  constructors  *
+ *----------------*/
+
+DiMonoRenderCache::Key::Key(const void *vlut,
+                            const void *plut,
+                            const DiDisplayFunction *disp,
+                            const int vfunc,
+                            const double center,
+                            const double width,
+                            const Uint32 low,
+                            const Uint32 high,
+                            const size_t itemSize)
+  : VoiLut(vlut),
+    PresLut(plut),
+    Display(disp),
+    AmbientLight((disp != NULL) ? disp->getAmbientLightValue() : 0),
+    Illumination((disp != NULL) ? disp->getIlluminationValue() : 0),
+    MinDensity((disp != NULL) ? disp->getMinDensityValue() : 0),
+    MaxDensity((disp != NULL) ? disp->getMaxDensityValue() : 0),
+    DDLCount((disp != NULL) ? OFstatic_cast(unsigned long, disp->getMaxDDLValue()) + 1 : 0),
+    VoiFunction(vfunc),
+    Center(center),
+    Width(width),
+    Low(low),
+    High(high),
+    ItemSize(itemSize)
+{
+}
+
+
+DiMonoRenderCache::DiMonoRenderCache(const unsigned long maxSize)
+  : LUTs(),
+    Buffer(NULL),
+    BufferCount(0),
+    BufferItemSize(0),
+    MaximumSize(maxSize),
+    CurrentSize(0)
+{
+}
+
+
+/*--------------*
+ *  destructor  *
+ *--------------*/
+
+DiMonoRenderCache::~DiMonoRenderCache()
+{
+    clear();
+}
+
+
+/********************************************************************/
+
+
+OFBool DiMonoRenderCache::Key::operator==(const Key &key) const
+{
+    return (VoiLut == key.VoiLut) && (PresLut == key.PresLut) && (Display == key.Display) &&
+           (AmbientLight == key.AmbientLight) && (Illumination == key.Illumination) &&
+           (MinDensity == key.MinDensity) && (MaxDensity == key.MaxDensity) && (DDLCount == key.DDLCount) &&
+           (VoiFunction == key.VoiFunction) && (Center == key.Center) && (Width == key.Width) &&
+           (Low == key.Low) && (High == key.High) && (ItemSize == key.ItemSize);
+}
+
+
+void DiMonoRenderCache::setMaximumSize(const unsigned long maxSize)
+{
+    MaximumSize = maxSize;
+    shrink(MaximumSize);
+}
+
+
+void DiMonoRenderCache::clear()
+{
+    shrink(0);
+}
+
+
+const void *DiMonoRenderCache::findLUT(const Key &key)
+{
+    OFListIterator(Entry) iter = LUTs.begin();
+    while (iter != LUTs.end())
+    {
+        if ((*iter).LutKey == key)
+        {
+            if (iter != LUTs.begin())
+            {
+                /* move entry to the front of the list (most recently used) */
+                LUTs.push_front(*iter);
+                LUTs.erase(iter);
+            }
+            return LUTs.front().Data;
+        }
+        ++iter;
+    }
+    return NULL;
+}
+
+
+void DiMonoRenderCache::addLUT(const Key &key,
+                               void *lut,
+                               const unsigned long count)
+{
+    if (lut != NULL)
+    {
+        const unsigned long size = count * OFstatic_cast(unsigned long, key.ItemSize);
+        if (size <= MaximumSize)
+        {
+            shrink(MaximumSize - size);
+            Entry entry;
+            entry.LutKey = key;
+            entry.Data = lut;
+            entry.Size = size;
+            LUTs.push_front(entry);
+            CurrentSize += size;
+            DCMIMGLE_TRACE("added LUT (" << count << " entries) to render cache, size is now " << CurrentSize << " bytes");
+        } else
+            deleteArray(lut, key.ItemSize);
+    }
+}
+
+
+void *DiMonoRenderCache::takeBuffer(const unsigned long count,
+                                    const size_t itemSize)
+{
+    void *buffer = NULL;
+    if ((Buffer != NULL) && (BufferCount == count) && (BufferItemSize == itemSize))
+    {
+        buffer = Buffer;
+        CurrentSize -= count * OFstatic_cast(unsigned long, itemSize);
+        Buffer = NULL;
+        BufferCount = 0;
+        BufferItemSize = 0;
+    }
+    return buffer;
+}
+
+
+void DiMonoRenderCache::putBuffer(void *buffer,
+                                  const unsigned long count,
+                                  const size_t itemSize)
+{
+    if (Buffer != NULL)
+    {
+        deleteArray(Buffer, BufferItemSize);
+        CurrentSize -= BufferCount * OFstatic_cast(unsigned long, BufferItemSize);
+        Buffer = NULL;
+        BufferCount = 0;
+        BufferItemSize = 0;
+    }
+    if (buffer != NULL)
+    {
+        const unsigned long size = count * OFstatic_cast(unsigned long, itemSize);
+        if (size <= MaximumSize)
+        {
+            /* the buffer is only removed from the cache if no LUT is left */
+            Buffer = buffer;
+            BufferCount = count;
+            BufferItemSize = itemSize;
+            CurrentSize += size;
+            shrink(MaximumSize);
+        } else
+            deleteArray(buffer, itemSize);
+    }
+}
+
+
+void DiMonoRenderCache::shrink(const unsigned long maxSize)
+{
+    while ((CurrentSize > maxSize) && !LUTs.empty())
+    {
+        Entry &entry = LUTs.back();
+        deleteArray(entry.Data, entry.LutKey.ItemSize);
+        CurrentSize -= entry.Size;
+        LUTs.pop_back();
+    }
+    if ((CurrentSize > maxSize) && (Buffer != NULL))
+    {
+        deleteArray(Buffer, BufferItemSize);
+        CurrentSize -= BufferCount * OFstatic_cast(unsigned long, BufferItemSize);
+        Buffer = NULL;
+        BufferCount = 0;
+        BufferItemSize = 0;
+    }
+}
+
+
+void DiMonoRenderCache::deleteArray(void *data,
+                                    const size_t itemSize)
+{
+    switch (itemSize)
+    {
+        case 1:
+            delete[] OFstatic_cast(Uint8 *, data);
+            break;
+        case 2:
+            delete[] OFstatic_cast(Uint16 *, data);
+            break;
+        default:
+            delete[] OFstatic_cast(Uint32 *, data);
+            break;
+    }
+}
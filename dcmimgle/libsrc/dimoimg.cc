@@ -34,6 +34,7 @@
 #include "dcmtk/dcmimgle/dimoflt.h"
 #include "dcmtk/dcmimgle/dimorot.h"
 #include "dcmtk/dcmimgle/dimoopxt.h"
+#include "dcmtk/dcmimgle/dimocach.h"
 #include "dcmtk/dcmimgle/digsdfn.h"
 #include "dcmtk/dcmimgle/didocu.h"
 #include "dcmtk/dcmimgle/diutils.h"
@@ -59,7 +60,7 @@ const unsigned int Default_Illumination = 2000;
 
 DiMonoImage::DiMonoImage(const DiDocument *docu,
                          const EI_Status status)
-  : DiImage(docu, status, 1),
+  : DiImage(docu, status, 1, OFTrue /*region*/),
     WindowCenter(0),
     WindowWidth(0),
     WindowCount(0),
@@ -77,7 +78,8 @@ DiMonoImage::DiMonoImage(const DiDocument *docu,
     InterData(NULL),
     DisplayFunction(NULL),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -95,7 +97,7 @@ DiMonoImage::DiMonoImage(const DiDocument *docu,
                          const EI_Status status,
                          const double slope,
                          const double intercept)
-  : DiImage(docu, status, 1),
+  : DiImage(docu, status, 1, OFTrue /*region*/),
     WindowCenter(0),
     WindowWidth(0),
     WindowCount(0),
@@ -113,7 +115,8 @@ DiMonoImage::DiMonoImage(const DiDocument *docu,
     InterData(NULL),
     DisplayFunction(NULL),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -132,7 +135,7 @@ DiMonoImage::DiMonoImage(const DiDocument *docu,
                          const DcmUnsignedShort &data,
                          const DcmUnsignedShort &descriptor,
                          const DcmLongString *explanation)
-  : DiImage(docu, status, 1),
+  : DiImage(docu, status, 1, OFTrue /*region*/),
     WindowCenter(0),
     WindowWidth(0),
     WindowCount(0),
@@ -150,7 +153,8 @@ DiMonoImage::DiMonoImage(const DiDocument *docu,
     InterData(NULL),
     DisplayFunction(NULL),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -189,7 +193,8 @@ DiMonoImage::DiMonoImage(const DiDocument *docu,
     InterData(NULL),
     DisplayFunction(NULL),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -221,7 +226,8 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
     InterData(NULL),
     DisplayFunction(image->DisplayFunction),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = image->Overlays[0];
     Overlays[1] = image->Overlays[1];
@@ -289,7 +295,8 @@ DiMonoImage::DiMonoImage(const DiColorImage *image,
     InterData(NULL),
     DisplayFunction(NULL),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -334,7 +341,8 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
     InterData(NULL),
     DisplayFunction(image->DisplayFunction),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -419,7 +427,8 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
     InterData(NULL),
     DisplayFunction(image->DisplayFunction),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -486,7 +495,8 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
     InterData(NULL),
     DisplayFunction(image->DisplayFunction),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -562,7 +572,8 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
     InterData(NULL),
     DisplayFunction(NULL),
     OutputData(NULL),
-    OverlayData(NULL)
+    OverlayData(NULL),
+    RenderCache(NULL)
 {
     Overlays[0] = NULL;
     Overlays[1] = NULL;
@@ -597,7 +608,8 @@ DiMonoImage::DiMonoImage(const DiMonoImage *image,
 DiMonoImage::~DiMonoImage()
 {
     delete InterData;
-    delete OutputData;
+    delete OutputData;                            // might return its buffer to the render cache
+    delete RenderCache;
     delete[] OFstatic_cast(char *, OverlayData);
     if (VoiLutData != NULL)
         VoiLutData->removeReference();            // only delete if object is no longer referenced
@@ -624,6 +636,7 @@ int DiMonoImage::processNextFrames(const unsigned long fcount)
             DiMonoModality *modality = InterData->addReferenceToModality();
             delete InterData;
             InterData = NULL;
+            clearRenderCache();                   // cached LUTs might not cover the new pixel values
             Init(modality, OFTrue /* reuse */);
             return (ImageStatus == EIS_Normal);
         }
@@ -647,6 +660,13 @@ void DiMonoImage::Init(DiMonoModality *modality,
                 Overlays[0]->showAllPlanes();               // default: show all overlays with stored modes
             if ((Overlays[0] == NULL) || (Overlays[0]->getCount() == 0) || (!Overlays[0]->hasEmbeddedData()))
                 detachPixelData();                          // no longer needed, save memory
+            if ((Overlays[0] != NULL) && (Overlays[0]->getCount() > 0) && ((RegionLeft > 0) || (RegionTop > 0)))
+            {
+                /* move overlay origin according to the region of interest */
+                DiOverlay *overlay = Overlays[0];
+                Overlays[0] = new DiOverlay(overlay, OFstatic_cast(signed long, RegionLeft), OFstatic_cast(signed long, RegionTop), 1.0, 1.0);
+                overlay->removeReference();
+            }
         }
         switch (InputData->getRepresentation())
         {
@@ -920,6 +940,29 @@ void DiMonoImage::deleteOutputData()
 }
 
 
+int DiMonoImage::setRenderCacheSize(const unsigned long size)
+{
+    if (RenderCache != NULL)
+        RenderCache->setMaximumSize(size);
+    else if (size > 0)
+        RenderCache = new DiMonoRenderCache(size);
+    return (RenderCache != NULL);
+}
+
+
+unsigned long DiMonoImage::getRenderCacheSize() const
+{
+    return (RenderCache != NULL) ? RenderCache->getMaximumSize() : 0;
+}
+
+
+void DiMonoImage::clearRenderCache()
+{
+    if (RenderCache != NULL)
+        RenderCache->clear();
+}
+
+
 unsigned long DiMonoImage::getOutputDataSize(const int bits) const
 {
     unsigned long result = 0;
@@ -978,6 +1021,8 @@ int DiMonoImage::getMinMaxValues(double &min,
 
 int DiMonoImage::setDisplayFunction(DiDisplayFunction *display)
 {
+    if (display != DisplayFunction)
+        clearRenderCache();
     DisplayFunction = display;
     return (DisplayFunction != NULL) && (DisplayFunction->isValid());
 }
@@ -988,6 +1033,7 @@ int DiMonoImage::setNoDisplayFunction()
     if (DisplayFunction != NULL)
     {
         DisplayFunction = NULL;
+        clearRenderCache();
         return 1;
     }
     return 2;
@@ -1026,6 +1072,7 @@ int DiMonoImage::setNoVoiTransformation()
         if (VoiLutData->isValid())
             old = 1;
         VoiLutData->removeReference();
+        clearRenderCache();
     }
     VoiLutData = NULL;
     VoiExplanation = "";
@@ -1107,7 +1154,10 @@ int DiMonoImage::setWindow(const double center,
                            const char *explanation)
 {
     if (VoiLutData != NULL)
+    {
         VoiLutData->removeReference();
+        clearRenderCache();
+    }
     VoiLutData = NULL;
     if (explanation != NULL)
         VoiExplanation = explanation;
@@ -1160,7 +1210,10 @@ int DiMonoImage::setVoiLut(const DcmUnsignedShort &data,
                            const EL_BitsPerTableEntry descripMode)
 {
     if (VoiLutData != NULL)
+    {
         VoiLutData->removeReference();
+        clearRenderCache();
+    }
     VoiLutData = new DiLookupTable(data, descriptor, explanation, descripMode);
     if (VoiLutData != NULL)
     {
@@ -1178,7 +1231,10 @@ int DiMonoImage::setVoiLut(const unsigned long pos,
     if (!(Document->getFlags() & CIF_UsePresentationState))
     {
         if (VoiLutData != NULL)
+        {
             VoiLutData->removeReference();
+            clearRenderCache();
+        }
         VoiLutData = new DiLookupTable(Document, DCM_VOILUTSequence, DCM_LUTDescriptor, DCM_LUTData,
             DCM_LUTExplanation, descripMode, pos, &VoiLutCount);
         if (VoiLutData != NULL)
@@ -1251,6 +1307,7 @@ int DiMonoImage::setHardcopyParameters(const unsigned int min,
         if ((result == 1) && (PresLutShape == ESP_LinOD) && (PresLutData != NULL))
         {
             PresLutData->removeReference();       // look-up table no longer valid
+            clearRenderCache();
             PresLutData = NULL;
         }
     }
@@ -1267,7 +1324,10 @@ ES_PresentationLut DiMonoImage::getPresentationLutShape() const
 int DiMonoImage::setPresentationLutShape(const ES_PresentationLut shape)
 {
     if (PresLutData != NULL)
+    {
         PresLutData->removeReference();
+        clearRenderCache();
+    }
     PresLutData = NULL;
     if (shape != PresLutShape)
     {
@@ -1284,7 +1344,10 @@ int DiMonoImage::setPresentationLut(const DcmUnsignedShort &data,
                                     const EL_BitsPerTableEntry descripMode)
 {
     if (PresLutData != NULL)
+    {
         PresLutData->removeReference();
+        clearRenderCache();
+    }
     PresLutData = new DiLookupTable(data, descriptor, explanation, descripMode, 0);
     if (PresLutData != NULL)
     {
@@ -1301,7 +1364,10 @@ int DiMonoImage::setInversePresentationLut(const DcmUnsignedShort &data,
 {
     int status = 0;
     if (PresLutData != NULL)
+    {
         PresLutData->removeReference();
+        clearRenderCache();
+    }
     PresLutData = NULL;
     DiLookupTable *lut = new DiLookupTable(data, descriptor, NULL, descripMode, 0);
     if ((lut != NULL) && (lut->isValid()))
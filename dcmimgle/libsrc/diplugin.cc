@@ -0,0 +1,219 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Provides abstract interface to pluggable image output formats
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmimgle/diplugin.h"
+#include "dcmtk/dcmimgle/diimage.h"
+#include "dcmtk/dcmimgle/diutils.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/oflist.h"
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Thread encoding a single rendered frame
+ */
+class DiPluginEncoder
+  : public OFThread
+{
+
+ public:
+
+    DiPluginEncoder(const DiPluginFormat &plugin,
+                    const DiImage &image,
+                    Uint8 *data,
+                    FILE *stream)
+      : OFThread(),
+        Plugin(plugin),
+        Image(image),
+        Data(data),
+        Stream(stream),
+        Result(0)
+    {
+    }
+
+    virtual ~DiPluginEncoder()
+    {
+        delete[] Data;
+    }
+
+    virtual void run()
+    {
+        Result = Plugin.encode(&Image, Data, Stream);
+    }
+
+    /** wait for the thread and close the stream
+     *  @return true if successful, false otherwise
+     */
+    int finish()
+    {
+        join();
+        if (fclose(Stream))
+            Result = 0;
+        return Result;
+    }
+
+
+ private:
+
+    /// plugin used for encoding
+    const DiPluginFormat &Plugin;
+    /// image the frame has been rendered from
+    const DiImage &Image;
+    /// rendered pixel data (deleted by the destructor)
+    Uint8 *Data;
+    /// stream to which the frame is written
+    FILE *Stream;
+    /// result of the encoding
+    int Result;
+
+ // --- declarations to avoid compiler warnings
+
+    DiPluginEncoder(const DiPluginEncoder &);
+    DiPluginEncoder &operator=(const DiPluginEncoder &);
+};
+
+#endif
+
+
+/*------------------*
+ *  static helpers  *
+ *------------------*/
+
+/* replace '%d' etc. in the given filename with the frame number
+ */
+static OFString getFrameFilename(const char *filename,
+                                 const unsigned long frame)
+{
+    char fname[FILENAME_MAX + 1];
+    if (OFStandard::snprintf(fname, sizeof(fname), filename, frame) >= 0)
+        return fname;
+    return filename;
+}
+
+
+/********************************************************************/
+
+
+int DiPluginFormat::writeFrames(DiImage *image,
+                                const char *filename,
+                                const unsigned long fstart,
+                                const unsigned long fcount,
+                                const unsigned long fnumber) const
+{
+    if ((image == NULL) || (filename == NULL) || (fstart >= image->getNumberOfFrames()))
+        return 0;
+    const unsigned long fend = ((fcount == 0) || (fcount > image->getNumberOfFrames() - fstart))
+        ? image->getNumberOfFrames() : fstart + fcount;
+    const int bits = getBitsPerSample();
+    const unsigned long size = (bits > 0) ? image->getOutputDataSize(bits) : 0;
+    int result = 1;
+#ifdef WITH_THREADS
+    /* the calling thread renders the frames, the other threads encode them */
+    unsigned long encoders = DicomImageClass::getNumberOfThreads() - 1;
+    if ((encoders > 0) && (fend - fstart > 1) && (getFrameFilename(filename, fnumber + fstart) == getFrameFilename(filename, fnumber + fstart + 1)))
+    {
+        DCMIMGLE_WARN("filename '" << filename << "' does not depend on the frame number, encoding frames in calling thread");
+        encoders = 0;
+    }
+    OFList<DiPluginEncoder *> running;
+#endif
+    for (unsigned long frame = fstart; (frame < fend) && result; ++frame)
+    {
+        const OFString fname = getFrameFilename(filename, fnumber + frame);
+        FILE *stream = fopen(fname.c_str(), "wb");          // open binary file for writing
+        if (stream == NULL)
+        {
+            DCMIMGLE_ERROR("can't create file '" << fname << "'");
+            result = 0;
+            break;
+        }
+        int ok = 0;
+        if (size == 0)
+        {
+            /* plugin does not support encoding of rendered frames */
+            ok = write(image, stream, frame);
+        } else {
+            Uint8 *data = new Uint8[size];
+            if (image->getOutputData(data, size, frame, bits, 0 /*planar*/))
+            {
+#ifdef WITH_THREADS
+                if (encoders > 0)
+                {
+                    /* wait for the oldest thread if all threads are busy */
+                    if (running.size() >= encoders)
+                    {
+                        if (!running.front()->finish())
+                            result = 0;
+                        delete running.front();
+                        running.pop_front();
+                    }
+                    DiPluginEncoder *encoder = new DiPluginEncoder(*this, *image, data, stream);
+                    if (encoder->start() == 0)
+                    {
+                        running.push_back(encoder);
+                        continue;
+                    }
+                    DCMIMGLE_DEBUG("cannot start thread, encoding frame in calling thread");
+                    ok = encode(image, data, stream);
+                    delete encoder;     // also deletes the pixel data
+                    data = NULL;
+                } else
+#endif
+                ok = encode(image, data, stream);
+            }
+            delete[] data;
+        }
+        if (fclose(stream)) ok = 0;
+        if (!ok) result = 0;
+    }
+#ifdef WITH_THREADS
+    while (!running.empty())
+    {
+        if (!running.front()->finish())
+            result = 0;
+        delete running.front();
+        running.pop_front();
+    }
+#endif
+    return result;
+}
+
+
+int DiPluginFormat::encode(const DiImage * /*image*/,
+                           const void * /*data*/,
+                           FILE * /*stream*/) const
+{
+    return 0;
+}
+
+
+int DiPluginFormat::getBitsPerSample() const
+{
+    return 0;
+}
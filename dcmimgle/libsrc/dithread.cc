@@ -0,0 +1,135 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: DicomThreadedLoop (Source)
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/dcmimgle/dithread.h"
+#include "dcmtk/dcmimgle/diutils.h"
+
+#ifdef WITH_THREADS
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofvector.h"
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** Thread processing a single band of a threaded loop
+ */
+class DiThreadedLoopWorker
+  : public OFThread
+{
+
+ public:
+
+    DiThreadedLoopWorker(DiThreadedLoop &loop,
+                         const unsigned long first,
+                         const unsigned long count)
+      : OFThread(),
+        Loop(loop),
+        First(first),
+        Count(count)
+    {
+    }
+
+    virtual void run()
+    {
+        Loop.processBand(First, Count);
+    }
+
+
+ private:
+
+    /// loop to be processed
+    DiThreadedLoop &Loop;
+    /// index of the first item of the band
+    const unsigned long First;
+    /// number of items of the band
+    const unsigned long Count;
+
+ // --- declarations to avoid compiler warnings
+
+    DiThreadedLoopWorker(const DiThreadedLoopWorker &);
+    DiThreadedLoopWorker &operator=(const DiThreadedLoopWorker &);
+};
+
+#endif
+
+
+/*----------------*
+ *  constructors  *
+ *----------------*/
+
+DiThreadedLoop::DiThreadedLoop()
+{
+}
+
+
+/*--------------*
+ *  destructor  *
+ *--------------*/
+
+DiThreadedLoop::~DiThreadedLoop()
+{
+}
+
+
+/********************************************************************/
+
+
+void DiThreadedLoop::process(const unsigned long count,
+                             const unsigned long minimum)
+{
+    unsigned long bands = DicomImageClass::getNumberOfThreads();
+    if ((minimum > 0) && (count / minimum < bands))
+        bands = count / minimum;
+#ifdef WITH_THREADS
+    if (bands > 1)
+    {
+        const unsigned long size = (count + bands - 1) / bands;
+        OFVector<DiThreadedLoopWorker *> workers;
+        unsigned long first;
+        for (first = size; first < count; first += size)
+        {
+            const unsigned long band = (count - first < size) ? count - first : size;
+            DiThreadedLoopWorker *worker = new DiThreadedLoopWorker(*this, first, band);
+            if (worker->start() == 0)
+                workers.push_back(worker);
+            else
+            {
+                DCMIMGLE_DEBUG("cannot start thread, processing band in calling thread");
+                delete worker;
+                processBand(first, band);
+            }
+        }
+        processBand(0, size);
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            workers[i]->join();
+            delete workers[i];
+        }
+        return;
+    }
+#endif
+    processBand(0, count);
+}
@@ -24,6 +24,7 @@
 
 #include "dcmtk/dcmdata/dctypes.h"
 #include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/ofstd/ofglobal.h"
 
 #include "dcmtk/dcmimgle/diutils.h"
 
@@ -38,6 +39,9 @@
 
 OFLogger DCM_dcmimgleLogger = OFLog::getLogger("dcmtk.dcmimgle");
 
+/// maximum number of threads used for processing the pixel data of a frame
+static OFGlobal<unsigned long> DicomImageNumberOfThreads(1);
+
 
 /*------------------------*
  *  function definitions  *
@@ -137,3 +141,15 @@ EP_Representation DicomImageClass::determineRepresentation(double minvalue,
 #endif
     return EPR_Uint32;
 }
+
+
+void DicomImageClass::setNumberOfThreads(const unsigned long threads)
+{
+    DicomImageNumberOfThreads.set((threads > 0) ? threads : 1);
+}
+
+
+unsigned long DicomImageClass::getNumberOfThreads()
+{
+    return DicomImageNumberOfThreads.get();
+}
@@ -0,0 +1,146 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class DicomImageFrameIterator
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+#include "dcmtk/dcmdata/dcrleerg.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimgle/diframit.h"
+
+#define FRAMES 7
+#define COLUMNS 16
+#define ROWS 16
+
+
+/** create a multi-frame file.
+ *  All pixels of a frame have the value of the frame number multiplied by 10.
+ *  @param filename name of the file
+ *  @param xfer transfer syntax of the file
+ */
+static void createFile(const char *filename, const E_TransferSyntax xfer)
+{
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    OFCHECK(dataset->putAndInsertString(DCM_SOPClassUID, UID_MultiframeGrayscaleByteSecondaryCaptureImageStorage).good());
+    OFCHECK(dataset->putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.4").good());
+    OFCHECK(dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2").good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1).good());
+    OFCHECK(dataset->putAndInsertString(DCM_NumberOfFrames, "7").good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_Rows, ROWS).good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_Columns, COLUMNS).good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_BitsAllocated, 8).good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_BitsStored, 8).good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_HighBit, 7).good());
+    OFCHECK(dataset->putAndInsertUint16(DCM_PixelRepresentation, 0).good());
+    OFVector<Uint8> pixelData(FRAMES * COLUMNS * ROWS);
+    for (size_t i = 0; i < pixelData.size(); ++i)
+        pixelData[i] = OFstatic_cast(Uint8, (i / (COLUMNS * ROWS)) * 10);
+    OFCHECK(dataset->putAndInsertUint8Array(DCM_PixelData, &pixelData[0], OFstatic_cast(unsigned long, pixelData.size())).good());
+    OFCHECK(dataset->chooseRepresentation(xfer, NULL).good());
+    OFCHECK(fileformat.saveFile(filename, xfer).good());
+}
+
+
+/** iterate over the frames of a file and check the frames returned
+ *  @param filename name of the file
+ *  @param fstart first frame to be processed
+ *  @param fcount number of frames to be processed (0 = all subsequent frames)
+ *  @param fstep number of frames per step
+ *  @param prefetch prepare the next step in a background thread if OFTrue
+ */
+static void iterate(const char *filename,
+                    const unsigned long fstart,
+                    const unsigned long fcount,
+                    const unsigned long fstep,
+                    const OFBool prefetch)
+{
+    DicomImageFrameIterator iterator(filename, 0, fstart, fcount, fstep, prefetch);
+    OFCHECK_EQUAL(iterator.getStatus(), EIS_Normal);
+    const unsigned long expectedCount = (fcount > 0) ? fcount : FRAMES - fstart;
+    OFCHECK_EQUAL(iterator.getFrameCount(), expectedCount);
+    unsigned long frame = fstart;
+    DicomImage *image;
+    while ((image = iterator.next()) != NULL)
+    {
+        OFCHECK_EQUAL(image->getStatus(), EIS_Normal);
+        // each step contains the next frames in the order of the file
+        OFCHECK_EQUAL(image->getFirstFrame(), frame);
+        const unsigned long count = image->getFrameCount();
+        OFCHECK(count >= 1);
+        OFCHECK(count <= fstep);
+        OFCHECK(image->setNoVoiTransformation());
+        for (unsigned long i = 0; i < count; ++i)
+        {
+            const Uint8 *data = OFstatic_cast(const Uint8 *, image->getOutputData(8, i));
+            OFCHECK(data != NULL);
+            if (data != NULL)
+            {
+                OFCHECK_EQUAL(OFstatic_cast(unsigned long, data[0]), (frame + i) * 10);
+                OFCHECK_EQUAL(OFstatic_cast(unsigned long, data[COLUMNS * ROWS - 1]), (frame + i) * 10);
+            }
+        }
+        frame += count;
+        OFCHECK_EQUAL(iterator.getNextFrame(), frame);
+    }
+    OFCHECK_EQUAL(iterator.getStatus(), EIS_Normal);
+    OFCHECK_EQUAL(frame, fstart + expectedCount);
+}
+
+
+/** iterate over the frames of a file in several ways
+ *  @param xfer transfer syntax of the file
+ */
+static void checkFrameIterator(const E_TransferSyntax xfer)
+{
+    OFTempFile temp;
+    OFCHECK_MSG(temp.getStatus().good(), temp.getStatus().text());
+    createFile(temp.getFilename(), xfer);
+    for (int prefetch = 0; prefetch < 2; ++prefetch)
+    {
+        iterate(temp.getFilename(), 0, 0, 1, prefetch != 0);
+        // the last step contains fewer frames
+        iterate(temp.getFilename(), 0, 0, 3, prefetch != 0);
+        iterate(temp.getFilename(), 2, 4, 3, prefetch != 0);
+    }
+}
+
+
+OFTEST(dcmimgle_frame_iterator_uncompressed)
+{
+    checkFrameIterator(EXS_LittleEndianExplicit);
+}
+
+
+OFTEST(dcmimgle_frame_iterator_compressed)
+{
+    DcmRLEDecoderRegistration::registerCodecs();
+    DcmRLEEncoderRegistration::registerCodecs();
+    checkFrameIterator(EXS_RLELossless);
+    DcmRLEEncoderRegistration::cleanup();
+    DcmRLEDecoderRegistration::cleanup();
+}
@@ -0,0 +1,105 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmimgle
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class DiMonoRenderCache
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmimgle/dcmimage.h"
+#include "dcmtk/dcmimgle/digsdfn.h"
+
+#define COLUMNS 256
+#define ROWS 256
+
+
+/** create a monochrome image with a horizontal gradient.
+ *  The image is large enough to be rendered with an optimization LUT.
+ *  @param dataset dataset to be filled
+ */
+static void createImage(DcmDataset& dataset)
+{
+    Uint16 *pixels = new Uint16[COLUMNS * ROWS];
+    for (unsigned int i = 0; i < COLUMNS * ROWS; ++i)
+        pixels[i] = OFstatic_cast(Uint16, (i % COLUMNS) * 16);
+    OFCHECK(dataset.putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2").good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_SamplesPerPixel, 1).good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_Rows, ROWS).good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_Columns, COLUMNS).good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_BitsAllocated, 16).good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_BitsStored, 12).good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_HighBit, 11).good());
+    OFCHECK(dataset.putAndInsertUint16(DCM_PixelRepresentation, 0).good());
+    OFCHECK(dataset.putAndInsertUint16Array(DCM_PixelData, pixels, COLUMNS * ROWS).good());
+    delete[] pixels;
+}
+
+
+/** render an image with the given display function
+ *  @param image image to be rendered
+ *  @param disp display function
+ *  @param output rendered 8 bit pixel data
+ */
+static void render(DicomImage& image,
+                   DiDisplayFunction& disp,
+                   OFString& output)
+{
+    OFCHECK(image.setDisplayFunction(&disp));
+    OFCHECK(image.setWindow(2048, 4096));
+    const Uint8 *data = OFstatic_cast(const Uint8 *, image.getOutputData(8));
+    OFCHECK(data != NULL);
+    if (data != NULL)
+        output.assign(OFreinterpret_cast(const char *, data), image.getOutputDataSize(8));
+}
+
+
+OFTEST(dcmimgle_render_cache_display_function)
+{
+    DcmDataset dataset;
+    createImage(dataset);
+    DiGSDFunction disp(0.5, 500.0, 256);
+    OFCHECK(disp.isValid());
+
+    DicomImage image(&dataset, EXS_LittleEndianExplicit);
+    OFCHECK_EQUAL(image.getStatus(), EIS_Normal);
+    OFCHECK(image.setRenderCacheSize(1024 * 1024));
+    OFString first;
+    render(image, disp, first);
+
+    // modify the display function in place, the cached LUT must not be used
+    OFCHECK(disp.setAmbientLightValue(50.0));
+    OFString cached;
+    render(image, disp, cached);
+    OFCHECK(cached != first);
+
+    // compare with the output of an image that never used a render cache
+    DicomImage uncached(&dataset, EXS_LittleEndianExplicit);
+    OFCHECK_EQUAL(uncached.getStatus(), EIS_Normal);
+    OFString expected;
+    render(uncached, disp, expected);
+    OFCHECK(cached == expected);
+
+    // the same parameters as for the first rendering use the cached LUT again
+    OFCHECK(disp.setAmbientLightValue(0.0));
+    render(image, disp, cached);
+    OFCHECK(cached == first);
+}
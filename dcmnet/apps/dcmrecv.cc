@@ -29,6 +29,7 @@
 #include "dcmtk/dcmdata/dcuid.h"     /* for dcmtk version name */
 #include "dcmtk/dcmdata/cmdlnarg.h"  /* for prepareCmdLineArgs */
 #include "dcmtk/dcmnet/dstorscp.h"   /* for DcmStorageSCP */
+#include "dcmtk/dcmnet/dmetrics.h"   /* for DcmNetworkMetrics */
 #include "dcmtk/dcmtls/tlsopt.h"     /* for DcmTLSOptions */
 
 
@@ -126,6 +127,8 @@ int main(int argc, char *argv[])
         cmd.addOption("--max-pdu",             "-pdu", 1, optString2.c_str(),
                                                           optString3.c_str());
         cmd.addOption("--disable-host-lookup", "-dhl",    "disable hostname lookup");
+        cmd.addOption("--metrics-file",                1, "[f]ilename: string",
+                                                          "collect network metrics and write them to file f\n(Prometheus text format, updated after each\nassociation)");
 
     /* add TLS specific command line options if (and only if) we are compiling with OpenSSL */
     tlsOptions.addTLSCommandlineOptions(cmd);
@@ -219,6 +222,13 @@ int main(int argc, char *argv[])
             app.checkValue(cmd.getValueAndCheckMinMax(opt_maxPDULength, ASC_MINIMUMPDUSIZE, ASC_MAXIMUMPDUSIZE));
         if (cmd.findOption("--disable-host-lookup"))
             opt_HostnameLookup = OFFalse;
+        if (cmd.findOption("--metrics-file"))
+        {
+            const char *metricsFile = NULL;
+            app.checkValue(cmd.getValue(metricsFile));
+            DcmNetworkMetrics::setEnabled(OFTrue);
+            DcmNetworkMetrics::setOutputFile(metricsFile);
+        }
 
         /* output options */
         if (cmd.findOption("--output-directory"))
@@ -34,6 +34,9 @@
 #include "dcmtk/dcmjpeg/djdecode.h"  /* for JPEG decoders */
 #include "dcmtk/dcmjpls/djdecode.h"  /* for JPEG-LS decoders */
 #include "dcmtk/dcmdata/dcrledrg.h"  /* for RLE decoder */
+#include "dcmtk/dcmjpeg/djencode.h"  /* for JPEG encoders */
+#include "dcmtk/dcmjpls/djencode.h"  /* for JPEG-LS encoders */
+#include "dcmtk/dcmdata/dcrleerg.h"  /* for RLE encoder */
 #include "dcmtk/dcmjpeg/dipijpeg.h"  /* for dcmimage JPEG plugin */
 
 
@@ -92,6 +95,10 @@ static void cleanup()
     DJLSDecoderRegistration::cleanup();
     // deregister RLE decoder
     DcmRLEDecoderRegistration::cleanup();
+    // deregister encoders (if registered)
+    DJEncoderRegistration::cleanup();
+    DJLSEncoderRegistration::cleanup();
+    DcmRLEEncoderRegistration::cleanup();
 #ifdef DEBUG
     /* useful for debugging with dmalloc */
     dcmDataDict.clear();
@@ -132,6 +139,9 @@ int main(int argc, char *argv[])
     OFBool opt_checkUIDValues = OFTrue;
     OFBool opt_multipleAssociations = OFTrue;
     DcmStorageSCU::E_DecompressionMode opt_decompressionMode = DcmStorageSCU::DM_losslessOnly;
+    OFBool opt_transcoding = OFFalse;
+    OFCmdUnsignedInt opt_transcodingCacheSize = 0;
+    OFBool opt_pipeline = OFFalse;
 
     OFBool opt_dicomDir = OFFalse;
     OFBool opt_scanDir = OFFalse;
@@ -177,6 +187,9 @@ int main(int argc, char *argv[])
         cmd.addOption("--decompress-never",    "-dn",     "never decompress compressed data sets");
         cmd.addOption("--decompress-lossless", "+dls",    "only decompress lossless compression (default)");
         cmd.addOption("--decompress-lossy",    "+dly",    "decompress both lossy and lossless compression");
+        cmd.addOption("--transcode",           "+tc",     "also transcode compressed data sets to other\nlossless compression schemes (if needed)");
+        cmd.addOption("--transcoding-cache",   "+tcc", 1, "[k]bytes: integer (default: 0)",
+                                                          "keep up to k kbytes of transcoded data sets in\nmemory for repeated transmissions (0=disabled)");
 #ifdef WITH_ZLIB
       cmd.addSubGroup("deflate compression level:");
         cmd.addOption("--compression-level",   "+cl",  1, "[l]evel: integer (default: 6)",
@@ -186,6 +199,7 @@ int main(int argc, char *argv[])
         cmd.addOption("--no-halt",             "-nh",     "do not halt on first invalid input file\nor if unsuccessful store encountered");
         cmd.addOption("--no-illegal-proposal", "-nip",    "do not propose any presentation context that\ndoes not contain the default TS (if needed)");
         cmd.addOption("--no-uid-checks",       "-nuc",    "do not check UID values of input files");
+        cmd.addOption("--pipeline",            "+pl",     "load and convert next data set while\nthe current one is being sent");
 
     cmd.addGroup("network options:");
       cmd.addSubGroup("IP protocol version:");
@@ -300,6 +314,9 @@ int main(int argc, char *argv[])
         if (cmd.findOption("--decompress-lossless")) opt_decompressionMode = DcmStorageSCU::DM_losslessOnly;
         if (cmd.findOption("--decompress-lossy")) opt_decompressionMode = DcmStorageSCU::DM_lossyAndLossless;
         cmd.endOptionBlock();
+        if (cmd.findOption("--transcode")) opt_transcoding = OFTrue;
+        if (cmd.findOption("--transcoding-cache"))
+            app.checkValue(cmd.getValueAndCheckMin(opt_transcodingCacheSize, 0));
 #ifdef WITH_ZLIB
         if (cmd.findOption("--compression-level"))
         {
@@ -314,6 +331,7 @@ int main(int argc, char *argv[])
         }
         if (cmd.findOption("--no-illegal-proposal")) opt_allowIllegalProposal = OFFalse;
         if (cmd.findOption("--no-uid-checks")) opt_checkUIDValues = OFFalse;
+        if (cmd.findOption("--pipeline")) opt_pipeline = OFTrue;
 
         /* network options */
         cmd.beginOptionBlock();
@@ -366,6 +384,13 @@ int main(int argc, char *argv[])
     DJLSDecoderRegistration::registerCodecs();
     // register RLE decoder
     DcmRLEDecoderRegistration::registerCodecs();
+    if (opt_transcoding)
+    {
+        // register lossless encoders (only needed for transcoding)
+        DJEncoderRegistration::registerCodecs();
+        DJLSEncoderRegistration::registerCodecs();
+        DcmRLEEncoderRegistration::registerCodecs();
+    }
 
     /* print resource identifier */
     OFLOG_DEBUG(dcmsendLogger, rcsid << OFendl);
@@ -465,6 +490,9 @@ int main(int argc, char *argv[])
     storageSCU.setVerbosePCMode(opt_showPresentationContexts);
     storageSCU.setDatasetConversionMode(opt_decompressionMode != DcmStorageSCU::DM_never);
     storageSCU.setDecompressionMode(opt_decompressionMode);
+    storageSCU.setTranscodingMode(opt_transcoding);
+    storageSCU.setTranscodingCacheSize(OFstatic_cast(size_t, opt_transcodingCacheSize) * 1024);
+    storageSCU.setPipelineMode(opt_pipeline);
     storageSCU.setHaltOnUnsuccessfulStoreMode(opt_haltOnUnsuccessfulStore);
     storageSCU.setAllowIllegalProposalMode(opt_allowIllegalProposal);
     storageSCU.setProtocolVersion(opt_protocolVersion);
@@ -45,6 +45,7 @@ END_EXTERN_C
 #include "dcmtk/dcmnet/dcmtrans.h"      /* for dcmSocketSend/ReceiveTimeout */
 #include "dcmtk/dcmnet/dcasccfg.h"      /* for class DcmAssociationConfiguration */
 #include "dcmtk/dcmnet/dcasccff.h"      /* for class DcmAssociationConfigurationFile */
+#include "dcmtk/dcmnet/dmetrics.h"      /* for class DcmNetworkMetrics */
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmdata/dcuid.h"
 #include "dcmtk/dcmdata/dcdict.h"
@@ -293,6 +294,8 @@ int main(int argc, char *argv[])
       cmd.addOption("--abort-during",                      "abort association during receipt of C-STORE-RQ");
       cmd.addOption("--promiscuous",            "-pm",     "promiscuous mode, accept unknown SOP classes\n(not with --config-file)");
       cmd.addOption("--uid-padding",            "-up",     "silently correct space-padded UIDs");
+      cmd.addOption("--metrics-file",                   1, "[f]ilename: string",
+                                                           "collect network metrics and write them to file f\n(Prometheus text format, updated after each\nassociation, not with --fork)");
 
     // add TLS specific command line options if (and only if) we are compiling with OpenSSL
     tlsOptions.addTLSCommandlineOptions(cmd);
@@ -544,6 +547,15 @@ int main(int argc, char *argv[])
     if (cmd.findOption("--abort-during")) opt_abortDuringStore = OFTrue;
     if (cmd.findOption("--promiscuous")) opt_promiscuous = OFTrue;
     if (cmd.findOption("--uid-padding")) opt_correctUIDPadding = OFTrue;
+    if (cmd.findOption("--metrics-file"))
+    {
+      /* forked child processes would overwrite each other's file with their own totals */
+      app.checkConflict("--metrics-file", "--fork", opt_forkMode);
+      const char *metricsFile = NULL;
+      app.checkValue(cmd.getValue(metricsFile));
+      DcmNetworkMetrics::setEnabled(OFTrue);
+      DcmNetworkMetrics::setOutputFile(metricsFile);
+    }
 
     if (cmd.findOption("--config-file"))
     {
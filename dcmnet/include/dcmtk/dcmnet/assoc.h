@@ -98,6 +98,7 @@
 #include "dcmtk/dcmnet/dicom.h"
 #include "dcmtk/dcmnet/lst.h"
 #include "dcmtk/dcmnet/dul.h"
+#include "dcmtk/dcmnet/dmetrics.h"
 
 /*
 ** Constant Definitions
@@ -135,6 +136,26 @@ struct DCMTK_DCMNET_EXPORT T_ASC_Network
     DUL_NETWORKKEY   *network;
 };
 
+/** network performance profiles, see ASC_setNetworkProfile()
+ */
+enum T_ASC_NetworkProfile
+{
+    /// operating system defaults for the TCP settings (which can be modified
+    /// by the environment variables TCP_BUFFER_LENGTH and TCP_NODELAY) and
+    /// the default maximum PDU size
+    ASC_NP_DEFAULT,
+    /// settings for high-throughput transfers within local networks: largest
+    /// supported PDU size, socket buffers sized from the bandwidth-delay
+    /// product, Nagle algorithm disabled and PDUs sent in full-size segments
+    ASC_NP_HIGHTHROUGHPUT
+};
+
+/* bandwidth (in Mbit/s) and round-trip time (in microseconds) assumed by
+ * default for the high-throughput network profile (10 GbE data center LAN)
+ */
+#define ASC_DEFAULTBANDWIDTH     10000
+#define ASC_DEFAULTROUNDTRIPTIME   500
+
 
 /*
 ** Association negotiation parameters.
@@ -286,6 +307,41 @@ DCMTK_DCMNET_EXPORT OFCondition ASC_initializeNetwork(
  */
 DCMTK_DCMNET_EXPORT OFCondition ASC_dropNetwork(T_ASC_Network ** network);
 
+/** select a network performance profile for all connections that are
+ *  subsequently requested or accepted using the given network. This
+ *  function only changes the TCP settings; the maximum receive PDU size
+ *  recommended for the profile (see ASC_getNetworkProfileMaxPDU()) has
+ *  to be passed to the functions creating the association parameters.
+ *  @param network network instance
+ *  @param profile network profile to be used
+ *  @param bandwidth expected bandwidth of the network link in Mbit/s,
+ *    used to compute the size of the socket buffers
+ *  @param roundTripTime expected round-trip time in microseconds, used to
+ *    compute the size of the socket buffers
+ *  @return EC_Normal if successful, an error code otherwise
+ */
+DCMTK_DCMNET_EXPORT OFCondition ASC_setNetworkProfile(
+    T_ASC_Network *network,
+    T_ASC_NetworkProfile profile,
+    Uint32 bandwidth = ASC_DEFAULTBANDWIDTH,
+    Uint32 roundTripTime = ASC_DEFAULTROUNDTRIPTIME);
+
+/** get the maximum receive PDU size recommended for a network profile
+ *  @param profile network profile
+ *  @return maximum receive PDU size in bytes
+ */
+DCMTK_DCMNET_EXPORT Uint32 ASC_getNetworkProfileMaxPDU(T_ASC_NetworkProfile profile);
+
+/** compute the size of the TCP socket buffers from the bandwidth-delay
+ *  product of a network link. The result is twice the bandwidth-delay
+ *  product (since the operating system also uses the buffer space for
+ *  its own bookkeeping), limited to the range 64 KB to 16 MB.
+ *  @param bandwidth bandwidth of the network link in Mbit/s
+ *  @param roundTripTime round-trip time in microseconds
+ *  @return size of the socket buffers in bytes
+ */
+DCMTK_DCMNET_EXPORT Sint32 ASC_computeTCPBufferLength(Uint32 bandwidth, Uint32 roundTripTime);
+
 /*
  * Building Association parameters
  */
@@ -740,6 +796,18 @@ ASC_destroyAssociation(T_ASC_Association ** association);
  */
 DCMTK_DCMNET_EXPORT void ASC_setParentProcessMode(T_ASC_Association *association);
 
+/** get a copy of the metrics collected so far for the given association.
+ *  Metrics are only collected if enabled by DcmNetworkMetrics::setEnabled()
+ *  before the association was requested or received.
+ *  @param association the association
+ *  @param snapshot returns the metrics of the association
+ *  @return EC_Normal if successful, an error code otherwise (e.g. if metrics
+ *    collection was disabled for this association)
+ */
+DCMTK_DCMNET_EXPORT OFCondition ASC_getAssociationMetrics(
+    T_ASC_Association *association,
+    DcmNetworkMetricsSnapshot &snapshot);
+
 /// @deprecated Please use OFString& ASC_printRejectParameters(OFString&, T_ASC_RejectParameters*) instead.
 OFdeprecated DCMTK_DCMNET_EXPORT void
 ASC_printRejectParameters(
@@ -174,6 +174,16 @@ public:
    */
   virtual OFBool isParentProcessMode() const;
 
+  /** enables or disables the TCP_CORK socket option for this connection.
+   *  While the option is enabled, the operating system only sends full-size
+   *  TCP segments, which allows a caller to combine several write operations
+   *  (e.g. the header and the data of a PDU) into as few segments as possible.
+   *  Disabling the option sends any pending partial segment immediately.
+   *  On systems that do not provide TCP_CORK, this method does nothing.
+   *  @param enable OFTrue to enable, OFFalse to disable the option
+   */
+  void setCorkOption(OFBool enable);
+
   /** prints the characteristics of the current connection
    *  on the given output stream.
    *  @param out output stream
@@ -1163,6 +1163,45 @@ DIMSE_sendMessageUsingMemoryData(T_ASC_Association *association,
                   void *callbackContext,
                   DcmDataset **commandSet=NULL);
 
+/** send a DIMSE command and relay the accompanying data set from another association
+ *  while it is being received, i.e. without decoding or buffering the whole data set.
+ *  This function is meant for store-and-forward applications: after the command has
+ *  been received on the source association with DIMSE_receiveCommand(), the (possibly
+ *  rewritten) command is sent on the target association and the data set PDVs that
+ *  follow on the source association are passed through to the target association.
+ *  The data set is not modified, so the accepted transfer syntax of both presentation
+ *  contexts must be identical.
+ *  @param assoc           The association on which the message shall be sent.
+ *  @param presID          The ID of the presentation context which shall be used for sending.
+ *  @param msg             Structure that represents the DIMSE command which shall be sent.
+ *  @param sourceAssoc     The association from which the data set is received (may be NULL
+ *                         if the message has no data set).
+ *  @param sourcePresID    The ID of the presentation context of the received command.
+ *  @param blocking        The blocking mode for receiving data (either DIMSE_BLOCKING or DIMSE_NONBLOCKING)
+ *  @param timeout         Timeout interval for receiving data (if the blocking mode is DIMSE_NONBLOCKING).
+ *  @param callback        Pointer to a function which shall be called to indicate progress.
+ *  @param callbackContext pointer to opaque object passed to the callback
+ *  @param commandSet      [out] If this parameter is not NULL
+ *                         it will return a copy of the DIMSE command which is sent to the other
+ *                         DICOM application.
+ *  @return EC_Normal if successful, DIMSE_NOVALIDPRESENTATIONCONTEXTID if the transfer
+ *    syntaxes of the two presentation contexts differ (in this case, nothing has been sent
+ *    or received, i.e. the caller can receive the data set itself), another error code
+ *    otherwise. In the latter case, the message on the target association may be incomplete,
+ *    so that association should be aborted.
+ */
+DCMTK_DCMNET_EXPORT OFCondition
+DIMSE_forwardMessage(T_ASC_Association *association,
+                  T_ASC_PresentationContextID presID,
+                  T_DIMSE_Message *msg,
+                  T_ASC_Association *sourceAssoc,
+                  T_ASC_PresentationContextID sourcePresID,
+                  T_DIMSE_BlockingMode blocking,
+                  int timeout,
+                  DIMSE_ProgressCallback callback,
+                  void *callbackContext,
+                  DcmDataset **commandSet=NULL);
+
 /** receive a DIMSE command via network from another DICOM application.
  *  @param assoc        The association (network connection to another DICOM application).
  *  @param blocking     The blocking mode for reading data (either DIMSE_BLOCKING or DIMSE_NONBLOCKING)
@@ -0,0 +1,414 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Collection of latency and throughput metrics for associations
+ *           and DIMSE messages
+ *
+ */
+
+#ifndef DMETRICS_H
+#define DMETRICS_H
+
+#include "dcmtk/config/osconfig.h"  /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/ofcond.h"
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/dcmnet/dndefine.h"
+
+
+/*-------------*
+ *  constants  *
+ *-------------*/
+
+/// number of buckets of a latency histogram (the last one has no upper bound)
+#define DCMNET_METRICS_HISTOGRAM_BUCKETS 15
+
+/// maximum number of outstanding DIMSE requests per association that are tracked
+#define DCMNET_METRICS_MAX_PENDING_REQUESTS 16
+
+
+/*---------------------*
+ *  type declarations  *
+ *---------------------*/
+
+/** association events that are counted
+ */
+enum E_DcmAssociationEvent
+{
+    /// A-ASSOCIATE request sent to a peer
+    DAE_requested,
+    /// A-ASSOCIATE request received from a peer
+    DAE_received,
+    /// association accepted (either by us or by the peer)
+    DAE_accepted,
+    /// association rejected (either by us or by the peer) or negotiation failed
+    DAE_rejected,
+    /// association released
+    DAE_released,
+    /// association aborted by us
+    DAE_aborted,
+    /// number of association events (not a valid event)
+    DAE_NumberOfEvents
+};
+
+/** categories of time that is spent while processing an association
+ */
+enum E_DcmMetricsTimeCategory
+{
+    /// blocked while reading from the network (including waiting for the peer)
+    DMT_networkRead,
+    /// blocked while writing to the network
+    DMT_networkWrite,
+    /// encoding datasets to be sent
+    DMT_datasetEncoding,
+    /// decoding datasets received into memory
+    DMT_datasetDecoding,
+    /// reading datasets from file or writing received datasets to file
+    DMT_fileIO,
+    /// number of time categories (not a valid category)
+    DMT_NumberOfCategories
+};
+
+/** DIMSE services for which messages are counted separately
+ */
+enum E_DcmMetricsCommand
+{
+    /// C-ECHO
+    DMC_CEcho,
+    /// C-STORE
+    DMC_CStore,
+    /// C-FIND
+    DMC_CFind,
+    /// C-GET
+    DMC_CGet,
+    /// C-MOVE
+    DMC_CMove,
+    /// C-CANCEL
+    DMC_CCancel,
+    /// N-EVENT-REPORT
+    DMC_NEventReport,
+    /// N-GET
+    DMC_NGet,
+    /// N-SET
+    DMC_NSet,
+    /// N-ACTION
+    DMC_NAction,
+    /// N-CREATE
+    DMC_NCreate,
+    /// N-DELETE
+    DMC_NDelete,
+    /// number of DIMSE services (not a valid service)
+    DMC_NumberOfCommands
+};
+
+
+/*---------------------*
+ *  class declaration  *
+ *---------------------*/
+
+/** histogram of durations (in seconds) with fixed bucket boundaries that are suitable
+ *  for network latencies, i.e.\ from 0.5 milliseconds to 10 seconds
+ */
+struct DCMTK_DCMNET_EXPORT DcmNetworkHistogram
+{
+    /** reset all values to zero
+     */
+    void clear();
+
+    /** add a single observation to the histogram
+     *  @param  seconds  duration to be added (in seconds)
+     */
+    void add(const double seconds);
+
+    /** add all observations of another histogram to this one
+     *  @param  histogram  histogram to be merged into this one
+     */
+    void merge(const DcmNetworkHistogram &histogram);
+
+    /** get upper bound of a particular bucket
+     *  @param  idx  index of the bucket (0..DCMNET_METRICS_HISTOGRAM_BUCKETS-2)
+     *  @return upper bound of the bucket (in seconds), a negative value for the last bucket
+     *    (which has no upper bound) or if the index is invalid
+     */
+    static double getUpperBound(const size_t idx);
+
+    /// number of observations
+    Uint64 Count;
+    /// sum of all observations (in seconds)
+    double Sum;
+    /// number of observations per bucket (not cumulative)
+    Uint64 Buckets[DCMNET_METRICS_HISTOGRAM_BUCKETS];
+};
+
+
+/** counters for a single DIMSE service
+ */
+struct DCMTK_DCMNET_EXPORT DcmDIMSEMetrics
+{
+    /// number of request messages sent
+    Uint64 RequestsSent;
+    /// number of request messages received
+    Uint64 RequestsReceived;
+    /// number of response messages sent (including pending responses)
+    Uint64 ResponsesSent;
+    /// number of response messages received (including pending responses)
+    Uint64 ResponsesReceived;
+    /// time between a request and the corresponding final response (in both directions)
+    DcmNetworkHistogram Latency;
+};
+
+
+/** snapshot of all counters and histograms that are collected for associations.  The
+ *  same structure is used for a single association and for the accumulated values of
+ *  all associations of the current process.
+ */
+struct DCMTK_DCMNET_EXPORT DcmNetworkMetricsSnapshot
+{
+    /** reset all values to zero
+     */
+    void clear();
+
+    /** add all values of another snapshot to this one
+     *  @param  snapshot  snapshot to be merged into this one
+     */
+    void merge(const DcmNetworkMetricsSnapshot &snapshot);
+
+    /** get average number of bytes sent per second while being blocked in the network
+     *  @return throughput in bytes per second (0 if not determined)
+     */
+    double getSendThroughput() const;
+
+    /** get average number of bytes received per second while being blocked in the network
+     *  @return throughput in bytes per second (0 if not determined)
+     */
+    double getReceiveThroughput() const;
+
+    /** get name of a DIMSE service, e.g.\ "C-STORE"
+     *  @param  command  DIMSE service
+     *  @return name of the DIMSE service, "unknown" if invalid
+     */
+    static const char *getCommandName(const E_DcmMetricsCommand command);
+
+    /** get name of an association event, e.g.\ "accepted"
+     *  @param  event  association event
+     *  @return name of the association event, "unknown" if invalid
+     */
+    static const char *getEventName(const E_DcmAssociationEvent event);
+
+    /** get name of a time category, e.g.\ "network_read"
+     *  @param  category  time category
+     *  @return name of the time category, "unknown" if invalid
+     */
+    static const char *getTimeCategoryName(const E_DcmMetricsTimeCategory category);
+
+    /// period of time covered by this snapshot (in seconds)
+    double Duration;
+    /// number of association events (see E_DcmAssociationEvent)
+    Uint64 AssociationEvents[DAE_NumberOfEvents];
+    /// duration of the association negotiation (requestor: round-trip, acceptor: processing)
+    DcmNetworkHistogram NegotiationTime;
+    /// number of PDUs sent
+    Uint64 PDUsSent;
+    /// number of PDUs received
+    Uint64 PDUsReceived;
+    /// number of bytes sent (including PDU headers)
+    Uint64 BytesSent;
+    /// number of bytes received (including PDU headers)
+    Uint64 BytesReceived;
+    /// time spent per category (in seconds, see E_DcmMetricsTimeCategory)
+    double Time[DMT_NumberOfCategories];
+    /// counters per DIMSE service (see E_DcmMetricsCommand)
+    DcmDIMSEMetrics DIMSE[DMC_NumberOfCommands];
+};
+
+
+/** metrics collected for a single association.  An instance of this class is created
+ *  by the DICOM upper layer for each association if the collection of metrics is enabled
+ *  (see DcmNetworkMetrics::setEnabled()) and accessed by the ASC and DIMSE layers.  When
+ *  the association is destroyed, the values are added to the process-wide totals.
+ *  An association and, therefore, an instance of this class should only be used by a
+ *  single thread at a time, so there is no locking.
+ */
+class DCMTK_DCMNET_EXPORT DcmAssociationMetrics
+{
+
+  public:
+
+    /** default constructor
+     */
+    DcmAssociationMetrics();
+
+    /** get a copy of the current values
+     *  @param  snapshot  reference to variable that receives the current values
+     */
+    void getSnapshot(DcmNetworkMetricsSnapshot &snapshot) const;
+
+    /** count an association event
+     *  @param  event             association event
+     *  @param  negotiationTime   duration of the negotiation in seconds (only used for the
+     *                            events DAE_accepted and DAE_rejected, negative = unknown)
+     */
+    void addAssociationEvent(const E_DcmAssociationEvent event,
+                             const double negotiationTime = -1);
+
+    /** remember when the negotiation of an incoming association request started
+     */
+    void startNegotiation();
+
+    /** get duration of the negotiation of an incoming association request
+     *  @return duration in seconds (negative if startNegotiation() has not been called)
+     */
+    double getNegotiationTime() const;
+
+    /** count a PDU that has been sent
+     *  @param  bytes    number of bytes sent (including the PDU header)
+     *  @param  seconds  time spent writing to the network
+     */
+    void addPDUSent(const unsigned long bytes,
+                    const double seconds);
+
+    /** count a PDU that has been received
+     *  @param  bytes    number of bytes received (including the PDU header)
+     *  @param  seconds  time spent reading from the network
+     */
+    void addPDUReceived(const unsigned long bytes,
+                        const double seconds);
+
+    /** add time to a particular category
+     *  @param  category  time category
+     *  @param  seconds   time to be added (negative values are ignored)
+     */
+    void addTime(const E_DcmMetricsTimeCategory category,
+                 const double seconds);
+
+    /** get time spent in a particular category so far
+     *  @param  category  time category
+     *  @return time in seconds
+     */
+    double getTime(const E_DcmMetricsTimeCategory category) const;
+
+    /** count a DIMSE command that has been sent or received.  For requests, the start time
+     *  is remembered, so that the latency can be determined when the final response (i.e.
+     *  a response with a status that is not "pending") arrives or is sent.
+     *  @param  commandField  value of the Command Field (0000,0100)
+     *  @param  messageID     value of the Message ID (0000,0110) for requests or of the
+     *                        Message ID Being Responded To (0000,0120) for responses
+     *  @param  status        value of the Status (0000,0900), only used for responses
+     *  @param  outgoing      OFTrue if the command has been sent, OFFalse if received
+     */
+    void addCommand(const Uint16 commandField,
+                    const Uint16 messageID,
+                    const Uint16 status,
+                    const OFBool outgoing);
+
+  private:
+
+    /// entry of the table of outstanding requests
+    struct PendingRequest
+    {
+        /// DIMSE service of the request (DMC_NumberOfCommands = unused entry)
+        E_DcmMetricsCommand Command;
+        /// message ID of the request
+        Uint16 MessageID;
+        /// flag indicating whether the request has been sent (OFTrue) or received
+        OFBool Outgoing;
+        /// time when the request has been sent or received
+        double StartTime;
+    };
+
+    /// current values
+    DcmNetworkMetricsSnapshot Counters;
+    /// time when this object was created
+    double StartTime;
+    /// time when the negotiation of an incoming association request started
+    double NegotiationStart;
+    /// table of outstanding requests
+    PendingRequest Pending[DCMNET_METRICS_MAX_PENDING_REQUESTS];
+};
+
+
+/** process-wide collection of network metrics.  The collection is disabled by default.
+ *  If enabled, the values of each association are added to the totals when the association
+ *  is destroyed.  The totals can be retrieved as a snapshot or written in the text-based
+ *  exposition format of Prometheus.
+ *  @note If associations are handled by separate processes (e.g.\ using fork()), each
+ *    process has its own totals.
+ */
+class DCMTK_DCMNET_EXPORT DcmNetworkMetrics
+{
+
+  public:
+
+    /** enable or disable the collection of metrics.  Only associations that are created
+     *  after the collection has been enabled are taken into account.
+     *  @param  enabled  OFTrue to enable the collection, OFFalse to disable it
+     */
+    static void setEnabled(const OFBool enabled);
+
+    /** check whether the collection of metrics is enabled
+     *  @return OFTrue if enabled, OFFalse otherwise
+     */
+    static OFBool isEnabled();
+
+    /** set name of a file to which the totals are written in Prometheus format each time an
+     *  association has been destroyed.  The file is replaced atomically (if supported by the
+     *  operating system), so it can be used with the "textfile collector" of an exporter.
+     *  @note The totals are kept per process.  A child process created by fork() inherits
+     *    the totals of its parent, so it must not write to the same file.
+     *  @param  filename  name of the output file (empty = do not write to a file)
+     */
+    static void setOutputFile(const OFFilename &filename);
+
+    /** get a copy of the totals of all associations destroyed so far
+     *  @param  snapshot  reference to variable that receives the totals
+     */
+    static void getSnapshot(DcmNetworkMetricsSnapshot &snapshot);
+
+    /** reset the totals to zero
+     */
+    static void reset();
+
+    /** add the values of a single association (or any other snapshot) to the totals
+     *  @param  snapshot  values to be added
+     */
+    static void merge(const DcmNetworkMetricsSnapshot &snapshot);
+
+    /** finish collection of metrics for a particular association, i.e.\ add its values to
+     *  the totals, write the output file (if any) and delete the given object
+     *  @param  metrics  metrics of the association to be finished (might be NULL)
+     */
+    static void finishAssociation(DcmAssociationMetrics *metrics);
+
+    /** write a snapshot in the text-based exposition format of Prometheus
+     *  @param  stream    output stream
+     *  @param  snapshot  values to be written
+     *  @param  prefix    prefix used for the name of all metrics
+     */
+    static void writePrometheus(STD_NAMESPACE ostream &stream,
+                                const DcmNetworkMetricsSnapshot &snapshot,
+                                const char *prefix = "dcmtk_net_");
+
+    /** write the current totals in the text-based exposition format of Prometheus to a file
+     *  @param  filename  name of the output file
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    static OFCondition writePrometheusFile(const OFFilename &filename);
+};
+
+#endif // DMETRICS_H
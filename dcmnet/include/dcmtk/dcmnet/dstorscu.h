@@ -25,6 +25,14 @@
 #include "dcmtk/config/osconfig.h"  /* make sure OS specific configuration is included first */
 
 #include "dcmtk/dcmnet/scu.h"       /* for base class DcmSCU */
+#include "dcmtk/ofstd/ofmap.h"      /* for class OFMap */
+
+
+/*------------------------*
+ *  forward declarations  *
+ *------------------------*/
+
+class DcmStorageSCUInstanceLoader;
 
 
 /*---------------------*
@@ -50,9 +58,11 @@
  *        Transfer Syntax" in case of compression.  According to the DICOM standard, the
  *        default transfer syntax for "Lossless JPEG Compression", "Lossy JPEG Compression"
  *        and so on has to be proposed in at least one presentation context for the particular
- *        SOP class.  This is not (yet) implemented since the re-encoding of compressed
- *        datasets is not supported.  Nevertheless, depending on the options used, the default
- *        transfer syntax for the uncompressed case is always proposed (if possible).
+ *        SOP class.  This is not (yet) implemented.  Nevertheless, depending on the options
+ *        used, the default transfer syntax for the uncompressed case is always proposed (if
+ *        possible).  If the transcoding mode is enabled (see setTranscodingMode()), further
+ *        lossless compressed transfer syntaxes are proposed for compressed SOP instances if
+ *        the registered codecs allow for re-encoding the pixel data accordingly.
  *    \li Also the handling of the encapsulated uncompressed transfer syntax is still rather
  *        limited, mainly because transcoding to the other uncompressed transfer syntaxes,
  *        which use native format, is not yet implemented by "dcmdata".
@@ -129,6 +139,23 @@ class DCMTK_DCMNET_EXPORT DcmStorageSCU
      */
     E_DecompressionMode getDecompressionMode() const;
 
+    /** get mode that specifies whether or not compressed datasets are transcoded to another
+     *  (lossless) compressed transfer syntax if the peer does not accept the original one.
+     *  @return mode indicating whether to transcode compressed datasets or not
+     */
+    OFBool getTranscodingMode() const;
+
+    /** get mode that specifies whether to load (and transcode) the next SOP instance in a
+     *  background thread while the current one is being sent.
+     *  @return mode indicating whether to prepare SOP instances in a pipeline or not
+     */
+    OFBool getPipelineMode() const;
+
+    /** get maximum size of the cache for transcoded datasets
+     *  @return maximum number of bytes stored in the cache (0 = cache disabled)
+     */
+    size_t getTranscodingCacheSize() const;
+
     /** get mode that specifies whether to halt if an invalid file is encountered during batch
      *  processing (e.g.\ when adding SOP instances from a DICOMDIR) or whether to continue
      *  with the next SOP instance.
@@ -172,6 +199,39 @@ class DCMTK_DCMNET_EXPORT DcmStorageSCU
      */
     void setDecompressionMode(const E_DecompressionMode decompressionMode);
 
+    /** set mode that specifies whether or not compressed datasets are transcoded to another
+     *  compressed transfer syntax if needed.  If enabled, all lossless compressed transfer
+     *  syntaxes that the currently registered codecs can create from the original transfer
+     *  syntax of a SOP instance are proposed in addition to the original one.  If the peer
+     *  accepts one of them but not the original transfer syntax, the dataset is re-encoded
+     *  before it is sent.  Lossy compressed datasets are only transcoded if the decompression
+     *  mode is DM_lossyAndLossless.
+     *  @param  transcodingMode  mode indicating whether to transcode compressed datasets or
+     *                           not (default: OFFalse, i.e.\ do not transcode)
+     */
+    void setTranscodingMode(const OFBool transcodingMode);
+
+    /** set mode that specifies whether to load (and transcode) the next SOP instance in a
+     *  background thread while the current one is being sent to the peer.  This way, reading
+     *  and re-encoding of the datasets overlaps with the network transfer.  If the toolkit
+     *  has been compiled without thread support, this mode has no effect.
+     *  @param  pipelineMode  mode indicating whether to prepare SOP instances in a pipeline
+     *                        or not (default: OFFalse, i.e.\ prepare sequentially)
+     */
+    void setPipelineMode(const OFBool pipelineMode);
+
+    /** set maximum size of the cache for transcoded datasets.  If enabled, each dataset that
+     *  has been loaded from file and re-encoded for network transmission is kept in memory
+     *  (identified by its SOP Instance UID and the network transfer syntax), so that it does
+     *  not need to be transcoded again when the same SOP instance is sent a second time, e.g.
+     *  after resetSentStatus() has been called.  If the cache is full, the oldest entries are
+     *  removed.  Datasets that are added with addDataset() are never cached, since the
+     *  decoded and encoded representations are kept by the dataset anyway.
+     *  @param  maxBytes  maximum number of bytes stored in the cache (default: 0, i.e.\ the
+     *                    cache is disabled).  Setting a new value clears the cache.
+     */
+    void setTranscodingCacheSize(const size_t maxBytes);
+
     /** set mode that specifies whether to halt if an invalid file is encountered during batch
      *  processing (e.g.\ when adding SOP instances from a DICOMDIR) or whether to continue
      *  with the next SOP instance.
@@ -510,15 +570,59 @@ class DCMTK_DCMNET_EXPORT DcmStorageSCU
      */
     virtual OFBool shouldStopAfterCurrentSOPInstance();
 
+    /** load the dataset of a given SOP instance to be sent (if required) and convert it to
+     *  the transfer syntax that has been negotiated for its presentation context.  The
+     *  conversion only takes place if the transcoding mode or the dataset conversion mode is
+     *  enabled.  If available, a previously transcoded dataset is taken from the cache.
+     *  This method might be called from a background thread (see setPipelineMode()).
+     *  @param  transferEntry  transfer entry of the SOP instance to be prepared
+     *  @param  fileformat     file format object used to load the SOP instance from file
+     *  @param  dataset        reference to variable that receives the dataset to be sent
+     *  @param  transcoded     reference to variable that is set to OFTrue if the dataset has
+     *                         been loaded from file and its pixel data has been re-encoded
+     *  @return status, EC_Normal if successful, an error code otherwise
+     */
+    virtual OFCondition prepareSOPInstance(const TransferEntry &transferEntry,
+                                           DcmFileFormat &fileformat,
+                                           DcmDataset *&dataset,
+                                           OFBool &transcoded);
+
 
   private:
 
+    /// the instance loader calls prepareSOPInstance() from a background thread
+    friend class DcmStorageSCUInstanceLoader;
+
+    /** add a copy of a transcoded dataset to the cache.  If needed, the oldest entries are
+     *  removed from the cache in order to keep the size below the given limit.
+     *  @param  transferEntry  transfer entry of the SOP instance that has been transcoded
+     *  @param  dataset        transcoded dataset to be added to the cache
+     */
+    void addToTranscodingCache(const TransferEntry &transferEntry,
+                               DcmDataset &dataset);
+
+    /** remove all datasets from the cache for transcoded datasets
+     */
+    void clearTranscodingCache();
+
     /// association counter
     unsigned long AssociationCounter;
     /// presentation context counter
     unsigned long PresentationContextCounter;
     /// decompression mode, i.e.\ whether a dataset is decompressed for transmission
     E_DecompressionMode DecompressionMode;
+    /// flag indicating whether to transcode compressed datasets (if needed)
+    OFBool TranscodingMode;
+    /// flag indicating whether to prepare the next SOP instance in a background thread
+    OFBool PipelineMode;
+    /// maximum number of bytes stored in the cache for transcoded datasets (0 = disabled)
+    size_t TranscodingCacheSize;
+    /// number of bytes currently stored in the cache for transcoded datasets
+    size_t TranscodingCacheUsage;
+    /// cache for transcoded datasets (key is SOP Instance UID and Transfer Syntax UID)
+    OFMap<OFString, DcmDataset *> TranscodingCache;
+    /// keys of the cached datasets in the order they were added (oldest first)
+    OFList<OFString> TranscodingCacheOrder;
     /// flag indicating whether to halt on invalid file
     OFBool HaltOnInvalidFileMode;
     /// flag indicating whether to halt on unsuccessful store
@@ -0,0 +1,192 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Pool of threads handling associations accepted by the main
+ *           thread of an SCP
+ *
+ */
+
+#ifndef DTHRPOOL_H
+#define DTHRPOOL_H
+
+#include "dcmtk/config/osconfig.h"  /* make sure OS specific configuration is included first */
+
+#ifdef WITH_THREADS
+
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/dcmnet/assoc.h"
+
+
+class DcmAssociationThreadPoolWorker;
+
+/** Handler of the associations assigned to a single thread of a
+ *  DcmAssociationThreadPool. Each thread of the pool has its own handler,
+ *  so it can keep state that must not be shared between threads (e.g.\ a
+ *  database handle) from one association to the next.
+ */
+class DCMTK_DCMNET_EXPORT DcmAssociationHandler
+{
+public:
+
+  /** Destructor. Called by the thread of the handler when the pool is
+   *  shut down.
+   */
+  virtual ~DcmAssociationHandler();
+
+  /** Handle an association, i.e.\ receive and answer all DIMSE messages
+   *  until the association is released or aborted
+   *  @param assoc [in] The association, which has already been acknowledged.
+   *    The handler takes over ownership, i.e.\ it has to drop and destroy
+   *    the association.
+   */
+  virtual void handleAssociation(T_ASC_Association* assoc) = 0;
+};
+
+
+/** Pool of threads handling the associations accepted by the main thread of
+ *  an SCP that implements its own accept loop (e.g.\ dcmqrscp and wlmscpfs
+ *  in threaded mode). Threads are started on demand, up to the maximum number
+ *  of concurrent associations, and then wait for further associations.
+ *  <p>
+ *  The associations are numbered with negative numbers, so that they can be
+ *  entered into a process table instead of process IDs. The process table is
+ *  only accessed by the main thread, i.e.\ in addAssociation() and
+ *  cleanFinishedAssociations().
+ *  </p>
+ */
+class DCMTK_DCMNET_EXPORT DcmAssociationThreadPool
+{
+public:
+
+  /** Constructor
+   *  @param maxThreads [in] The maximum number of threads, i.e.\ concurrent
+   *    associations (at least 1)
+   */
+  DcmAssociationThreadPool(const size_t maxThreads);
+
+  /** Destructor. Waits until all associations have been handled.
+   */
+  virtual ~DcmAssociationThreadPool();
+
+  /** Hand an acknowledged association over to the pool. Starts another
+   *  thread if no thread is idle and the maximum number of threads has not
+   *  been reached yet. Must only be called by the main thread.
+   *  @param assoc [in] The association. The pool takes over ownership in
+   *    case of success.
+   *  @return EC_Normal if the association has been handed over, the error
+   *    returned by createHandler() or EC_IllegalCall if no thread could be
+   *    started otherwise
+   */
+  OFCondition addAssociation(T_ASC_Association* assoc);
+
+  /** Remove the associations that have been handled completely from the
+   *  process table by calling removeProcess(). Must only be called by the
+   *  main thread.
+   */
+  void cleanFinishedAssociations();
+
+  /** Get the maximum number of threads
+   *  @return The maximum number of threads
+   */
+  size_t getMaxThreads() const;
+
+protected:
+
+  /** Create the handler for a new thread. Called by the main thread.
+   *  @param cond [out] The error code if the handler cannot be created
+   *  @return The handler, NULL in case of error. The pool takes over
+   *    ownership.
+   */
+  virtual DcmAssociationHandler* createHandler(OFCondition& cond) = 0;
+
+  /** Add an association to the process table. Called by the main thread
+   *  before the association is handed over to a thread.
+   *  @param id [in] The (negative) number of the association
+   *  @param assoc [in] The association
+   */
+  virtual void addProcess(const int id, T_ASC_Association* assoc) = 0;
+
+  /** Remove an association that has been handled completely from the
+   *  process table. Called by the main thread.
+   *  @param id [in] The number of the association
+   */
+  virtual void removeProcess(const int id) = 0;
+
+private:
+
+  friend class DcmAssociationThreadPoolWorker;
+
+  /** Wait for the next association
+   *  @param assoc [out] The association
+   *  @param id [out] The number of the association
+   *  @return OFTrue if an association was returned, OFFalse if the pool is
+   *    shut down
+   */
+  OFBool nextAssociation(T_ASC_Association*& assoc, int& id);
+
+  /** Handle associations until the pool is shut down, called by the threads
+   *  @param handler [in] The handler of the calling thread
+   */
+  void handleAssociations(DcmAssociationHandler& handler);
+
+  /** Private undefined copy-constructor. Shall never be called.
+   *  @param src Source object
+   */
+  DcmAssociationThreadPool(const DcmAssociationThreadPool& src);
+
+  /** Private undefined operator=. Shall never be called.
+   *  @param src Source object
+   *  @return Reference to this
+   */
+  DcmAssociationThreadPool& operator=(const DcmAssociationThreadPool& src);
+
+  /// Maximum number of threads
+  size_t m_maxThreads;
+
+  /// Threads started so far
+  OFVector<DcmAssociationThreadPoolWorker*> m_workers;
+
+  /// Number of threads waiting for an association
+  size_t m_idleWorkers;
+
+  /// Associations waiting to be handled
+  OFList<T_ASC_Association*> m_pending;
+
+  /// Numbers of the associations waiting to be handled
+  OFList<int> m_pendingIds;
+
+  /// Numbers of the associations handled completely
+  OFList<int> m_finishedIds;
+
+  /// Number of the association added last
+  int m_lastId;
+
+  /// OFTrue if the pool is being shut down
+  OFBool m_shutdown;
+
+  /// Mutex protecting the members of this object
+  OFMutex m_mutex;
+
+  /// Semaphore counting the pending associations and shutdown requests
+  OFSemaphore m_available;
+};
+
+#endif // WITH_THREADS
+
+#endif // DTHRPOOL_H
@@ -76,6 +76,7 @@
 
 class DcmTransportConnection;
 class DcmTransportLayer;
+class DcmAssociationMetrics;
 class LST_HEAD;
 
 // include this file in doxygen documentation
@@ -526,10 +527,21 @@ DCMTK_DCMNET_EXPORT DcmTransportConnection *DUL_getTransportConnection(DUL_ASSOC
 /* change transport layer */
 DCMTK_DCMNET_EXPORT OFCondition DUL_setTransportLayer(DUL_NETWORKKEY *callerNetworkKey, DcmTransportLayer *newLayer, int takeoverOwnership);
 
+/* set TCP options for all connections of a network. A buffer length of 0 selects
+ * the system default. The environment variables TCP_BUFFER_LENGTH and TCP_NODELAY
+ * still take precedence over these settings. If corkPDUs is true, the header and
+ * data of each outgoing P-DATA-TF PDU are coalesced into full-size TCP segments
+ * (only supported on systems providing the TCP_CORK socket option).
+ */
+DCMTK_DCMNET_EXPORT OFCondition DUL_setTCPOptions(DUL_NETWORKKEY *callerNetworkKey, Sint32 bufferLength, OFBool noDelay, OFBool corkPDUs);
+
 /* activate compatibility mode and callback */
 DCMTK_DCMNET_EXPORT void DUL_activateCompatibilityMode(DUL_ASSOCIATIONKEY *dulassoc, unsigned long mode);
 DCMTK_DCMNET_EXPORT void DUL_activateCallback(DUL_ASSOCIATIONKEY *dulassoc, DUL_ModeCallback *cb);
 
+/* get pointer to the metrics collected for an association (NULL if collection is disabled) */
+DCMTK_DCMNET_EXPORT DcmAssociationMetrics *DUL_getAssociationMetrics(DUL_ASSOCIATIONKEY *dulassoc);
+
 /*
  * function allowing to retrieve the peer certificate from the DUL layer
  */
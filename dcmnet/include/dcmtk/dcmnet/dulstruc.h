@@ -79,6 +79,7 @@
 
 class DcmTransportConnection;
 class DcmTransportLayer;
+class DcmAssociationMetrics;
 
 #define NETWORK_DISCONNECTED  2
 #define NETWORK_CONNECTED 3
@@ -102,6 +103,9 @@ typedef struct {
     int protocolState;
     int timeout;
     unsigned long options;
+    Sint32 tcpBufferLength;
+    OFBool tcpNoDelay;
+    OFBool tcpCorkPDUs;
     union {
   struct {
       int port;
@@ -152,6 +156,8 @@ typedef struct {
     unsigned long fragmentBufferLength;
     unsigned char *fragmentBuffer;
     DUL_ModeCallback *modeCallback;
+    DcmAssociationMetrics *metrics;
+    OFBool tcpCorkPDUs;
 }   PRIVATE_ASSOCIATIONKEY;
 
 #define KEY_NETWORK "KEY NETWORK"
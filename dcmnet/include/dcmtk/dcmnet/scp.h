@@ -32,6 +32,8 @@
 #include "dcmtk/dcmnet/scpcfg.h"
 #include "dcmtk/oflog/oflog.h"
 
+class DcmSCU;
+
 // include this file in doxygen documentation
 
 /** @file scp.h
@@ -288,6 +290,14 @@ public:
      */
     void setMaxReceivePDULength(const Uint32 maxRecPDU);
 
+    /** Set the network profile to be used for incoming connections. The profile
+     *  ASC_NP_HIGHTHROUGHPUT enables TCP_NODELAY, enlarges the socket buffers and
+     *  uses the largest supported PDU size. Calling this method also resets the
+     *  maximum receive PDU length to the value of the profile.
+     *  @param profile [in] The network profile to be used
+     */
+    void setNetworkProfile(const T_ASC_NetworkProfile profile);
+
     /** Set whether waiting for a TCP/IP connection should be blocking or non-blocking.
      *  In non-blocking mode, the networking routines will wait for specified connection
      *  timeout, see setConnectionTimeout() function. In blocking mode, no timeout is set
@@ -389,6 +399,11 @@ public:
      */
     Uint32 getMaxReceivePDULength() const;
 
+    /** Returns the network profile configured for incoming connections
+     *  @return The network profile configured
+     */
+    T_ASC_NetworkProfile getNetworkProfile() const;
+
     /** Returns whether receiving of TCP/IP connection requests is done in blocking or
      *  unblocking mode
      *  @return DUL_BLOCK if in blocking mode, otherwise DUL_NOBLOCK
@@ -711,6 +726,27 @@ protected:
                                             const T_ASC_PresentationContextID presID,
                                             const OFString& filename);
 
+    /** Forward a C-STORE request to another application using the given (connected) SCU.
+     *  The dataset is not received completely before it is sent; instead, each incoming
+     *  P-DATA fragment is relayed as soon as it arrives, so the end-to-end latency is
+     *  roughly the maximum of receive and send time instead of their sum. After the
+     *  response has been received from the other application, the C-STORE response with
+     *  the same status is sent back on this association.
+     *  @param reqMessage [in] The C-STORE request message that was received
+     *  @param presID     [in] The presentation context of the request
+     *  @param scu        [in] The SCU connected to the application the request should be
+     *                         forwarded to. A presentation context with the same SOP class
+     *                         and transfer syntax as the incoming one must have been accepted.
+     *  @return EC_Normal if the request was forwarded and the response was sent,
+     *          DIMSE_NOVALIDPRESENTATIONCONTEXTID if the request cannot be forwarded
+     *          (the dataset has not been read yet, so receiveSTORERequest() can be used
+     *          instead), another error code otherwise. In the latter case, the outgoing
+     *          association has been aborted.
+     */
+    virtual OFCondition forwardSTORERequest(T_DIMSE_C_StoreRQ& reqMessage,
+                                            const T_ASC_PresentationContextID presID,
+                                            DcmSCU& scu);
+
     /** Respond to the C-STORE request (with details from the request message)
      *  @param presID        [in] The presentation context ID to respond to
      *  @param reqMessage    [in] The C-STORE request that should be responded to
@@ -153,6 +153,14 @@ public:
    */
   void setMaxReceivePDULength(const Uint32 maxRecPDU);
 
+  /** Set the network profile to be used for incoming connections. The profile
+   *  ASC_NP_HIGHTHROUGHPUT enables TCP_NODELAY, enlarges the socket buffers and
+   *  uses the largest supported PDU size. Calling this method also resets the
+   *  maximum receive PDU length to the value of the profile.
+   *  @param profile [in] The network profile to be used
+   */
+  void setNetworkProfile(const T_ASC_NetworkProfile profile);
+
   /** Set whether waiting for a TCP/IP connection should be blocking or non-blocking.
    *  In non-blocking mode, the networking routines will wait for specified connection
    *  timeout, see setConnectionTimeout() function. In blocking mode, no timeout is set
@@ -255,6 +263,11 @@ public:
    */
   Uint32 getMaxReceivePDULength() const;
 
+  /** Returns the network profile configured for incoming connections
+   *  @return The network profile configured
+   */
+  T_ASC_NetworkProfile getNetworkProfile() const;
+
   /** Returns whether receiving of TCP/IP connection requests is done in blocking or
    *  unblocking mode
    *  @return DUL_BLOCK if in blocking mode, otherwise DUL_NOBLOCK
@@ -377,6 +390,10 @@ protected:
   /// association negotiation.
   Uint32 m_maxReceivePDULength;
 
+  /// Network profile determining the TCP tuning of the listen socket and all
+  /// accepted connections (default: ASC_NP_DEFAULT)
+  T_ASC_NetworkProfile m_networkProfile;
+
   /// Blocking mode for TCP/IP connection requests. If non-blocking mode is enabled, the SCP is
   /// waiting for new DIMSE data a specific (m_connectionTimeout) amount of time and then returns
   /// if not data arrives. In blocking mode, the SCP is calling the underlying operating
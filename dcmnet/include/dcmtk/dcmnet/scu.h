@@ -301,6 +301,31 @@ public:
                                          const OFString& moveOriginatorAETitle = "",
                                          const Uint16 moveOriginatorMsgID      = 0);
 
+    /** Forwards a C-STORE request that has been received on another association (e.g.\ by
+     *  a DcmSCP) to the peer of this SCU. The dataset is not received completely before
+     *  it is sent; instead, each incoming P-DATA fragment is relayed as soon as it arrives
+     *  (see DIMSE_forwardMessage()). The command set is taken over from the incoming
+     *  request, only the message ID is replaced. Since the dataset is passed through
+     *  unchanged, a presentation context with the same SOP class and transfer syntax as
+     *  the one of the incoming request must have been accepted on this association.
+     *  Both associations are read and written with this SCU's DIMSE blocking mode and
+     *  timeout.
+     *  @param sourceAssoc   [in]  The association the C-STORE request was received on. The
+     *                             command must have been received, the dataset not yet.
+     *  @param sourcePresID  [in]  The presentation context ID of the received request
+     *  @param request       [in]  The received C-STORE request
+     *  @param rspStatusCode [out] The response status code received from the peer
+     *  @return EC_Normal if the request was forwarded and a response was received,
+     *          DIMSE_NOVALIDPRESENTATIONCONTEXTID if no suitable presentation context is
+     *          available (in this case, the dataset has not been read from the source
+     *          association), error code otherwise. In the latter case, the dataset may
+     *          have been forwarded partially, so both associations should be aborted.
+     */
+    virtual OFCondition forwardSTORERequest(T_ASC_Association* sourceAssoc,
+                                            const T_ASC_PresentationContextID sourcePresID,
+                                            const T_DIMSE_C_StoreRQ& request,
+                                            Uint16& rspStatusCode);
+
     /** Sends a C-MOVE Request on given presentation context and receives list of responses.
      *  The function receives the first response and then calls the function handleMOVEResponse()
      *  which gets the relevant presentation context together with the response dataset and
@@ -641,6 +666,17 @@ public:
      */
     void setMaxReceivePDULength(const Uint32 maxRecPDU);
 
+    /** Set the network profile to be used for the connection. The profile
+     *  ASC_NP_HIGHTHROUGHPUT enables TCP_NODELAY, enlarges the socket buffers
+     *  according to the bandwidth-delay product and uses the largest supported
+     *  PDU size. Calling this method also resets the maximum receive PDU length
+     *  to the value of the profile, so call setMaxReceivePDULength() afterwards
+     *  if a different value is desired. The setting takes effect with the next
+     *  call of initNetwork().
+     *  @param profile [in] The network profile to be used
+     */
+    void setNetworkProfile(const T_ASC_NetworkProfile profile);
+
     /** Set whether to send in DIMSE blocking or non-blocking mode
      *  @param blockingMode [in] Either blocking or non-blocking mode
      */
@@ -746,6 +782,11 @@ public:
      */
     Uint32 getMaxReceivePDULength() const;
 
+    /** Returns the network profile configured for the connection
+     *  @return The network profile configured
+     */
+    T_ASC_NetworkProfile getNetworkProfile() const;
+
     /** Returns whether DIMSE messaging is configured to be blocking or unblocking
      *  @return The blocking mode configured
      */
@@ -984,6 +1025,13 @@ protected:
     virtual OFCondition
     sendSTOREResponse(T_ASC_PresentationContextID presID, Uint16 status, const T_DIMSE_C_StoreRQ& request);
 
+    /** Receives the response to a C-STORE request that was sent before
+     *  @param presID        [in]  The presentation context ID the request was sent on
+     *  @param rspStatusCode [out] The response status code received from the peer
+     *  @return EC_Normal if a C-STORE response was received, error code otherwise
+     */
+    virtual OFCondition receiveSTOREResponse(T_ASC_PresentationContextID presID, Uint16& rspStatusCode);
+
     /** Helper function that generates a storage filename by extracting SOP Class and SOP
      *  Instance UID from a dataset and combining that with the configured storage directory.
      *  The SOP class is used to create an initial two letter abbreviation for the
@@ -1024,6 +1072,9 @@ protected:
     static void callbackRECEIVEProgress(void* callbackContext, unsigned long byteCount);
 
 private:
+    /// The association pool takes over and hands out the association of an SCU
+    friend class DcmSCUAssociationPool;
+
     /** Private undefined copy-constructor. Shall never be called.
      *  @param src Source object
      */
@@ -1082,6 +1133,9 @@ private:
     /// Maximum PDU size (default: 16384 bytes)
     Uint32 m_maxReceivePDULength;
 
+    /// Network profile (default: ASC_NP_DEFAULT)
+    T_ASC_NetworkProfile m_networkProfile;
+
     /// DIMSE blocking mode (default: blocking)
     T_DIMSE_BlockingMode m_blockMode;
 
@@ -0,0 +1,260 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class keeping negotiated SCU associations alive in order to
+ *           hand them over to DcmSCU instances with the same configuration
+ *
+ */
+
+#ifndef SCUPOOL_H
+#define SCUPOOL_H
+
+#include "dcmtk/config/osconfig.h"  /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofmap.h"
+#include "dcmtk/ofstd/ofstring.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/dcmnet/scu.h"
+
+
+/** Pool of outgoing associations that can be shared by any number of DcmSCU
+ *  (or derived) instances. Instead of calling initNetwork() and
+ *  negotiateAssociation() on the SCU, a client calls connect(), which hands
+ *  over an idle association that was negotiated with the same parameters
+ *  before, or negotiates a new one if none is available. When the client is
+ *  done, it calls release() instead of releaseAssociation(), which takes the
+ *  association back into the pool. This way, the TCP connection setup, the
+ *  A-ASSOCIATE negotiation and (if enabled) the TLS handshake are only
+ *  performed once for a series of operations with the same peer.
+ *  <p>
+ *  Associations are identified by the calling and called AE title, the peer
+ *  host and port, the maximum receive PDU length, the network profile, the
+ *  transport layer passed to connect() and the list of proposed presentation contexts (or the association
+ *  configuration file and profile), i.e. all parameters that are sent in the
+ *  A-ASSOCIATE request. Idle associations are released after the idle timeout.
+ *  Before an association that has been idle longer than the validation timeout
+ *  is handed out, it is checked with a C-ECHO request (if a presentation
+ *  context for the Verification SOP Class was accepted).
+ *  </p>
+ *  <p>
+ *  Idle associations are only expired when the pool is accessed or when
+ *  closeIdleAssociations() is called, i.e. there is no background thread.
+ *  All methods may be called from different threads at the same time.
+ *  </p>
+ *  @remark If a TLS transport layer is used, it must remain valid as long as
+ *    the pool holds associations that were negotiated with that layer.
+ */
+class DCMTK_DCMNET_EXPORT DcmSCUAssociationPool
+{
+public:
+
+  /** Constructor
+   */
+  DcmSCUAssociationPool();
+
+  /** Destructor. Releases all idle associations.
+   */
+  virtual ~DcmSCUAssociationPool();
+
+  /** Connect the given SCU, i.e.\ hand over an idle association with matching
+   *  parameters or negotiate a new association using initNetwork() and
+   *  negotiateAssociation(). The SCU must be fully configured (peer, AE titles,
+   *  presentation contexts, etc.) and not be connected. If a transport layer
+   *  is given, a newly negotiated association uses it, i.e.\ useSecureConnection()
+   *  is called between initNetwork() and negotiateAssociation(). Associations
+   *  negotiated with different transport layers are never handed over to
+   *  each other.
+   *  @param scu [inout] The SCU to be connected
+   *  @param tlayer [in] The secure transport layer (e.g.\ DcmTLSTransportLayer)
+   *    to be used, or NULL for an unencrypted connection. The pool does not
+   *    take over ownership.
+   *  @return EC_Normal if the SCU is connected, error code otherwise
+   */
+  virtual OFCondition connect(DcmSCU& scu,
+                              DcmTransportLayer* tlayer = NULL);
+
+  /** Take back the association of the given SCU into the pool. Afterwards,
+   *  the SCU is no longer connected. If the pool already holds the maximum
+   *  number of idle associations, the association is released instead. The
+   *  configuration of the SCU must not have been changed since connect(). An
+   *  SCU that was not connected by this pool is treated as unencrypted.
+   *  @param scu [inout] The connected SCU whose association should be kept
+   *  @return EC_Normal if the association was taken over or released,
+   *          DIMSE_ILLEGALASSOCIATION if the SCU is not connected
+   */
+  virtual OFCondition release(DcmSCU& scu);
+
+  /** Release all idle associations that have exceeded the idle timeout
+   */
+  void closeIdleAssociations();
+
+  /** Release all idle associations
+   */
+  void clear();
+
+  /** Set the number of seconds after which an idle association is released.
+   *  The default is 60 seconds.
+   *  @param seconds [in] The idle timeout in seconds
+   */
+  void setIdleTimeout(const Uint32 seconds);
+
+  /** Set the number of seconds after which an idle association is validated
+   *  with a C-ECHO request before it is handed out. 0 means that each
+   *  association is validated. The default is 5 seconds.
+   *  @param seconds [in] The validation timeout in seconds
+   */
+  void setValidationTimeout(const Uint32 seconds);
+
+  /** Set the maximum number of idle associations kept by the pool. The
+   *  default is 10.
+   *  @param maxIdle [in] The maximum number of idle associations
+   */
+  void setMaxIdleAssociations(const size_t maxIdle);
+
+  /** Get the idle timeout
+   *  @return The idle timeout in seconds
+   */
+  Uint32 getIdleTimeout() const;
+
+  /** Get the validation timeout
+   *  @return The validation timeout in seconds
+   */
+  Uint32 getValidationTimeout() const;
+
+  /** Get the maximum number of idle associations
+   *  @return The maximum number of idle associations
+   */
+  size_t getMaxIdleAssociations() const;
+
+  /** Get the number of associations that are currently idle in the pool
+   *  @return The number of idle associations
+   */
+  size_t getNumberOfIdleAssociations();
+
+  /** Get the number of associations negotiated by connect()
+   *  @return The number of newly negotiated associations
+   */
+  unsigned long getNumberOfCreatedAssociations();
+
+  /** Get the number of times an idle association was handed out by connect()
+   *  @return The number of reused associations
+   */
+  unsigned long getNumberOfReusedAssociations();
+
+  /** Create the key that identifies associations of the given SCU, i.e.\ a
+   *  string containing all parameters of the A-ASSOCIATE request and the
+   *  transport layer
+   *  @param scu [in] The SCU
+   *  @param tlayer [in] The transport layer passed to connect(), or NULL
+   *  @return The key
+   */
+  static OFString createKey(const DcmSCU& scu,
+                            const DcmTransportLayer* tlayer = NULL);
+
+protected:
+
+  /// Association kept by the pool
+  struct DCMTK_DCMNET_EXPORT IdleAssociation
+  {
+    /** Default constructor
+     */
+    IdleAssociation()
+      : key()
+      , network(NULL)
+      , association(NULL)
+      , parameters(NULL)
+      , lastUsed(0)
+    {
+    }
+    /// Key identifying the association parameters
+    OFString key;
+    /// Network the association is based on
+    T_ASC_Network* network;
+    /// The association
+    T_ASC_Association* association;
+    /// The association parameters
+    T_ASC_Parameters* parameters;
+    /// Time when the association was taken back into the pool
+    double lastUsed;
+  };
+
+  /** Check whether the association handed over to the given SCU can be used,
+   *  i.e.\ the peer has not sent anything (e.g.\ an A-RELEASE request or an
+   *  A-ABORT) and, if the association has been idle for too long, answers a
+   *  C-ECHO request
+   *  @param scu [in] The SCU holding the association
+   *  @param idleTime [in] The number of seconds the association has been idle
+   *  @return OFTrue if the association can be used, OFFalse otherwise
+   */
+  virtual OFBool isUsable(DcmSCU& scu, const double idleTime);
+
+private:
+
+  /** Remove the most recently used idle association with the given key
+   *  from the list
+   *  @param key [in] The key of the association
+   *  @param entry [out] The association removed from the list
+   *  @return OFTrue if an association was found, OFFalse otherwise
+   */
+  OFBool takeIdleAssociation(const OFString& key, IdleAssociation& entry);
+
+  /** Release (or abort if this fails) an idle association and free all
+   *  related network structures
+   *  @param entry [inout] The association to be closed
+   */
+  static void closeAssociation(IdleAssociation& entry);
+
+  /** Private undefined copy-constructor. Shall never be called.
+   *  @param src Source object
+   */
+  DcmSCUAssociationPool(const DcmSCUAssociationPool& src);
+
+  /** Private undefined operator=. Shall never be called.
+   *  @param src Source object
+   *  @return Reference to this
+   */
+  DcmSCUAssociationPool& operator=(const DcmSCUAssociationPool& src);
+
+#ifdef WITH_THREADS
+  /// Mutex protecting the list of idle associations and the counters
+  OFMutex m_mutex;
+#endif
+
+  /// Transport layers of the SCUs connected by connect() and not yet released
+  OFMap<const DcmSCU*, DcmTransportLayer*> m_connected;
+
+  /// Idle associations, most recently used first
+  OFList<IdleAssociation> m_idle;
+
+  /// Idle timeout in seconds
+  Uint32 m_idleTimeout;
+
+  /// Validation timeout in seconds
+  Uint32 m_validationTimeout;
+
+  /// Maximum number of idle associations
+  size_t m_maxIdle;
+
+  /// Number of associations negotiated by connect()
+  unsigned long m_numCreated;
+
+  /// Number of associations handed out again by connect()
+  unsigned long m_numReused;
+};
+
+#endif // SCUPOOL_H
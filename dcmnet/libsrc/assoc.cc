@@ -117,6 +117,8 @@
 #include "dcmtk/ofstd/ofstd.h"
 #include "dcmtk/dcmnet/dcmtrans.h"
 #include "dcmtk/dcmnet/helpers.h"
+#include "dcmtk/dcmnet/dmetrics.h"
+#include "dcmtk/ofstd/oftimer.h"
 
 /*
 ** Constant Definitions
@@ -265,6 +267,44 @@ ASC_dropNetwork(T_ASC_Network ** network)
 }
 
 
+OFCondition
+ASC_setNetworkProfile(T_ASC_Network *network,
+                      T_ASC_NetworkProfile profile,
+                      Uint32 bandwidth,
+                      Uint32 roundTripTime)
+{
+    if (network == NULL) return ASC_NULLKEY;
+    if (profile == ASC_NP_HIGHTHROUGHPUT)
+    {
+        const Sint32 bufferLength = ASC_computeTCPBufferLength(bandwidth, roundTripTime);
+        DCMNET_DEBUG("ASSOC: using high-throughput network profile (TCP buffer length "
+            << bufferLength << " bytes)");
+        return DUL_setTCPOptions(network->network, bufferLength, OFTrue, OFTrue);
+    }
+    return DUL_setTCPOptions(network->network, 0, OFFalse, OFFalse);
+}
+
+Uint32
+ASC_getNetworkProfileMaxPDU(T_ASC_NetworkProfile profile)
+{
+    return (profile == ASC_NP_HIGHTHROUGHPUT) ? ASC_MAXIMUMPDUSIZE : ASC_DEFAULTMAXPDU;
+}
+
+Sint32
+ASC_computeTCPBufferLength(Uint32 bandwidth, Uint32 roundTripTime)
+{
+    /* bandwidth-delay product in bytes (Mbit/s * us / 8) */
+    const double bdp = OFstatic_cast(double, bandwidth) * OFstatic_cast(double, roundTripTime) / 8.0;
+    double bufferLength = 2.0 * bdp;
+    if (bufferLength < 65536.0)
+        bufferLength = 65536.0;
+    else if (bufferLength > 16777216.0)
+        bufferLength = 16777216.0;
+    /* round up to a multiple of 4 KB */
+    return OFstatic_cast(Sint32, ((OFstatic_cast(Uint32, bufferLength) + 4095) / 4096) * 4096);
+}
+
+
 /*
  * Building Association parameters
  */
@@ -1795,6 +1835,17 @@ ASC_receiveAssociation(T_ASC_Network * network,
 
     (*assoc)->DULassociation = DULassociation;
 
+    if (cond.good())
+    {
+        /* the negotiation time is measured until the association is acknowledged or rejected */
+        DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(DULassociation);
+        if (metrics)
+        {
+            metrics->addAssociationEvent(DAE_received);
+            metrics->startNegotiation();
+        }
+    }
+
     if (retrieveRawPDU && DULassociation)
     {
       DUL_returnAssociatePDUStorage((*assoc)->DULassociation, *associatePDU, *associatePDUlength);
@@ -1927,11 +1978,34 @@ ASC_requestAssociation(T_ASC_Network * network,
     OFStandard::strlcpy(params->DULparams.callingImplementationVersionName,
         params->ourImplementationVersionName, 16+1);
 
+    const double negotiationStart = OFTimer::getTime();
     cond = DUL_RequestAssociation(&network->network, block, timeout,
                                   &(*assoc)->params->DULparams,
                                   &(*assoc)->DULassociation,
                                   retrieveRawPDU);
 
+    if (DcmNetworkMetrics::isEnabled())
+    {
+        /* if the association could not be established, the DUL layer has already
+         * destroyed the association key. In this case, the events are directly
+         * added to the process-wide metrics.
+         */
+        DcmAssociationMetrics *metrics = DUL_getAssociationMetrics((*assoc)->DULassociation);
+        DcmAssociationMetrics failedAssociation;
+        if (metrics == NULL) metrics = &failedAssociation;
+        metrics->addAssociationEvent(DAE_requested);
+        if (cond.good())
+            metrics->addAssociationEvent(DAE_accepted, OFTimer::getDiff(negotiationStart));
+        else if (cond == DUL_ASSOCIATIONREJECTED)
+            metrics->addAssociationEvent(DAE_rejected, OFTimer::getDiff(negotiationStart));
+        if (metrics == &failedAssociation)
+        {
+            DcmNetworkMetricsSnapshot snapshot;
+            failedAssociation.getSnapshot(snapshot);
+            DcmNetworkMetrics::merge(snapshot);
+        }
+    }
+
 
     if (retrieveRawPDU && assoc && ((*assoc)->DULassociation))
     {
@@ -2041,6 +2115,9 @@ ASC_acknowledgeAssociation(
 
     if (cond.good())
     {
+        DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(assoc->DULassociation);
+        if (metrics) metrics->addAssociationEvent(DAE_accepted, metrics->getNegotiationTime());
+
         /* create a sendPDVBuffer */
         sendLen = assoc->params->theirMaxPDUReceiveSize;
         if (sendLen < 1) {
@@ -2101,6 +2178,9 @@ ASC_rejectAssociation(
     l_abort.source = (unsigned char)(rejectParameters->source & 0xff);
     l_abort.reason = (unsigned char)(rejectParameters->reason & 0xff);
 
+    DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(association->DULassociation);
+    if (metrics) metrics->addAssociationEvent(DAE_rejected, metrics->getNegotiationTime());
+
     OFCondition cond = DUL_RejectAssociationRQ(
         &association->DULassociation,
         &l_abort,
@@ -2119,7 +2199,13 @@ ASC_releaseAssociation(T_ASC_Association * association)
 {
     if (association == NULL) return ASC_NULLKEY;
     if (association->DULassociation == NULL) return ASC_NULLKEY;
-    return DUL_ReleaseAssociation(&association->DULassociation);
+    OFCondition cond = DUL_ReleaseAssociation(&association->DULassociation);
+    if (cond.good())
+    {
+        DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(association->DULassociation);
+        if (metrics) metrics->addAssociationEvent(DAE_released);
+    }
+    return cond;
 }
 
 OFCondition ASC_acknowledgeRelease(T_ASC_Association *association)
@@ -2128,6 +2214,11 @@ OFCondition ASC_acknowledgeRelease(T_ASC_Association *association)
     if (association->DULassociation == NULL) return ASC_NULLKEY;
 
     OFCondition cond = DUL_AcknowledgeRelease(&association->DULassociation);
+    if (cond.good())
+    {
+        DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(association->DULassociation);
+        if (metrics) metrics->addAssociationEvent(DAE_released);
+    }
 
     return cond;
 }
@@ -2139,6 +2230,9 @@ ASC_abortAssociation(T_ASC_Association * association)
     if (association == NULL) return ASC_NULLKEY;
     if (association->DULassociation == NULL) return ASC_NULLKEY;
 
+    DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(association->DULassociation);
+    if (metrics) metrics->addAssociationEvent(DAE_aborted);
+
     OFCondition cond = DUL_AbortAssociation(&association->DULassociation);
     return cond;
 }
@@ -2289,3 +2383,13 @@ void ASC_setParentProcessMode(T_ASC_Association *association)
 {
   if (association) DUL_setParentProcessMode(association->DULassociation);
 }
+
+OFCondition ASC_getAssociationMetrics(T_ASC_Association *association, DcmNetworkMetricsSnapshot &snapshot)
+{
+  snapshot.clear();
+  if (association == NULL) return ASC_NULLKEY;
+  DcmAssociationMetrics *metrics = DUL_getAssociationMetrics(association->DULassociation);
+  if (metrics == NULL) return makeDcmnetCondition(ASCC_CODINGERROR, OF_error, "ASC Coding error in ASC_getAssociationMetrics: metrics collection disabled");
+  metrics->getSnapshot(snapshot);
+  return EC_Normal;
+}
@@ -42,6 +42,12 @@ BEGIN_EXTERN_C
 #ifdef HAVE_SYS_SELECT_H
 #include <sys/select.h>
 #endif
+#ifdef HAVE_NETINET_IN_H
+#include <netinet/in.h>         /* prerequisite for netinet/tcp.h */
+#endif
+#ifdef HAVE_NETINET_TCP_H
+#include <netinet/tcp.h>        /* for TCP_CORK */
+#endif
 END_EXTERN_C
 
 #ifdef DCMTK_HAVE_POLL
@@ -307,6 +313,19 @@ OFBool DcmTransportConnection::isParentProcessMode() const
   return isForkedParent;
 }
 
+void DcmTransportConnection::setCorkOption(OFBool enable)
+{
+#ifdef TCP_CORK
+  if (theSocket != DCMNET_INVALID_SOCKET)
+  {
+    int cork = enable ? 1 : 0;
+    (void) setsockopt(theSocket, IPPROTO_TCP, TCP_CORK, (char *) &cork, sizeof(cork));
+  }
+#else
+  (void) enable;
+#endif
+}
+
 /* ================================================ */
 
 DcmTCPConnection::DcmTCPConnection(DcmNativeSocketType openSocket)
@@ -100,6 +100,8 @@
 #include "dcmtk/dcmdata/dcwcache.h"    /* for class DcmWriteCache */
 #include "dcmtk/dcmdata/dcvrui.h"      /* for class DcmUniqueIdentifier */
 #include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/oftimer.h"
+#include "dcmtk/dcmnet/dmetrics.h"
 
 /*
  * Global variables, mutex protected
@@ -139,6 +141,74 @@ static unsigned long g_dimse_dataCounter = 0;
 ** Private Functions Bodies
 */
 
+/* helper class measuring the time spent in a DIMSE function apart from
+ * the time spent reading from or writing to the network, which is already
+ * measured by the DUL layer. The difference is assigned to the given time
+ * category of the association metrics when the object is destroyed.
+ */
+class DIMSE_MetricsTimer
+{
+public:
+    DIMSE_MetricsTimer(T_ASC_Association *assoc, E_DcmMetricsTimeCategory category)
+    : metrics_((assoc != NULL) ? DUL_getAssociationMetrics(assoc->DULassociation) : NULL)
+    , category_(category)
+    , startTime_(0)
+    , networkTime_(0)
+    {
+        if (metrics_)
+        {
+            startTime_ = OFTimer::getTime();
+            networkTime_ = getNetworkTime();
+        }
+    }
+
+    ~DIMSE_MetricsTimer()
+    {
+        if (metrics_)
+        {
+            const double elapsed = OFTimer::getTime() - startTime_;
+            metrics_->addTime(category_, elapsed - (getNetworkTime() - networkTime_));
+        }
+    }
+
+private:
+    double getNetworkTime() const
+    {
+        return metrics_->getTime(DMT_networkRead) + metrics_->getTime(DMT_networkWrite);
+    }
+
+    /* private undefined copy constructor and assignment operator */
+    DIMSE_MetricsTimer(const DIMSE_MetricsTimer&);
+    DIMSE_MetricsTimer& operator=(const DIMSE_MetricsTimer&);
+
+    DcmAssociationMetrics *metrics_;
+    E_DcmMetricsTimeCategory category_;
+    double startTime_;
+    double networkTime_;
+};
+
+/* add a DIMSE command that has been sent or received to the association metrics */
+static void addCommandToMetrics(T_ASC_Association *assoc, DcmDataset *cmdObj, OFBool outgoing)
+{
+    DcmAssociationMetrics *metrics = (assoc != NULL) ? DUL_getAssociationMetrics(assoc->DULassociation) : NULL;
+    if (metrics && cmdObj)
+    {
+        Uint16 commandField = 0;
+        Uint16 messageID = 0;
+        Uint16 status = 0;
+        cmdObj->findAndGetUint16(DCM_CommandField, commandField);
+        /* responses refer to the message ID of the request */
+        if (commandField & 0x8000)
+        {
+            cmdObj->findAndGetUint16(DCM_MessageIDBeingRespondedTo, messageID);
+            cmdObj->findAndGetUint16(DCM_Status, status);
+        }
+        else
+            cmdObj->findAndGetUint16(DCM_MessageID, messageID);
+        metrics->addCommand(commandField, messageID, status, outgoing);
+    }
+}
+
 static void saveDimseFragment(
         DcmDataset *dset,
         OFBool isCommand,
@@ -918,6 +988,7 @@ DIMSE_sendMessage(
       /* to create a data object with the actual instance data that shall be sent */
       else if ((dataObject == NULL)&&(dataFileName != NULL))
       {
+        DIMSE_MetricsTimer metricsTimer(assoc, DMT_fileIO);
         if (! dcmff.loadFile(dataFileName, EXS_Unknown).good())
         {
           DCMNET_WARN(DIMSE_warn_str(assoc) << "sendMessage: cannot open DICOM file ("
@@ -981,6 +1052,9 @@ DIMSE_sendMessage(
 
       /* Send the DIMSE command. DIMSE commands are always little endian implicit. */
       cond = sendDcmDataset(assoc, cmdObj, presID, EXS_LittleEndianImplicit, DUL_COMMANDPDV, NULL, NULL);
+
+      /* add the DIMSE command to the association metrics (if enabled) */
+      if (cond.good()) addCommandToMetrics(assoc, cmdObj, OFTrue);
     }
 
     /* Then we still have to send the actual instance data if the DIMSE command information variable */
@@ -991,6 +1065,7 @@ DIMSE_sendMessage(
       if (g_dimse_save_dimse_data) saveDimseFragment(dataObject, OFFalse, OFFalse);
 
       /* Send the instance data set using the corresponding transfer syntax */
+      DIMSE_MetricsTimer metricsTimer(assoc, DMT_datasetEncoding);
       cond = sendDcmDataset(assoc, dataObject, presID, xferSyntax,
           DUL_DATASETPDV, callback, callbackContext);
     }
@@ -1032,6 +1107,165 @@ DIMSE_sendMessageUsingMemoryData(
     return DIMSE_sendMessage(assoc, presID, msg, statusDetail, dataObject, NULL, callback, callbackContext, commandSet);
 }
 
+static OFCondition
+forwardDataSet(
+        T_ASC_Association *assoc,
+        T_ASC_PresentationContextID presID,
+        T_ASC_Association *sourceAssoc,
+        T_ASC_PresentationContextID sourcePresID,
+        T_DIMSE_BlockingMode blocking,
+        int timeout,
+        DIMSE_ProgressCallback callback,
+        void *callbackContext)
+    /*
+     * This function reads the PDVs of a data set from one association and sends them on another
+     * association as soon as they arrive, i.e. without decoding or buffering the whole data set.
+     * PDVs that are larger than the maximum PDV size of the outgoing association are split.
+     *
+     * Parameters:
+     *   assoc           - [in] The association on which the data set shall be sent.
+     *   presID          - [in] The ID of the presentation context which shall be used for sending.
+     *   sourceAssoc     - [in] The association from which the data set is received.
+     *   sourcePresID    - [in] The ID of the presentation context of the incoming command.
+     *   blocking        - [in] The blocking mode for receiving data (DIMSE_BLOCKING or DIMSE_NONBLOCKING)
+     *   timeout         - [in] Timeout interval for receiving data (if the blocking mode is DIMSE_NONBLOCKING).
+     *   callback        - [in] Pointer to a function which shall be called to indicate progress.
+     *   callbackContext - []
+     */
+{
+    OFCondition cond = EC_Normal;
+    DUL_PDV pdv;
+    DUL_PDV outPDV;
+    DUL_PDVLIST pdvList;
+    OFBool last = OFFalse;
+    unsigned long bytesForwarded = 0;
+
+    /* determine the maximum PDV size on the outgoing association (see sendDcmDataset) */
+    unsigned long bufLen = assoc->sendPDVLength;
+    Uint32 maxpdulen = dcmMaxOutgoingPDUSize.get();
+    if (bufLen + 12 > maxpdulen)
+    {
+      bufLen = maxpdulen - 12;
+    }
+    /* keep the fragments even-sized */
+    bufLen &= ~OFstatic_cast(unsigned long, 1);
+
+    while (!last)
+    {
+        /* get the next PDV of the incoming data set */
+        cond = DIMSE_readNextPDV(sourceAssoc, blocking, timeout, &pdv);
+        if (cond.bad())
+        {
+            if (cond == DIMSE_READPDVFAILED)
+                return makeDcmnetSubCondition(DIMSEC_RECEIVEFAILED, OF_error, "DIMSE Failed to receive message", cond);
+            return cond; /* it was an abort or release request */
+        }
+        if (pdv.pdvType != DUL_DATASETPDV)
+            return DIMSE_UNEXPECTEDPDVTYPE;
+        if (pdv.presentationContextID != sourcePresID)
+        {
+            char buf[256];
+            OFStandard::snprintf(buf, sizeof(buf), "DIMSE: Different PresIDs inside Data Set: %d != %d", sourcePresID, pdv.presentationContextID);
+            OFCondition subCond = makeDcmnetCondition(DIMSEC_INVALIDPRESENTATIONCONTEXTID, OF_error, buf);
+            return makeDcmnetSubCondition(DIMSEC_RECEIVEFAILED, OF_error, "DIMSE Failed to receive message", subCond);
+        }
+
+        /* relay the fragment, split into pieces that fit into an outgoing PDV */
+        unsigned long offset = 0;
+        do
+        {
+            unsigned long length = pdv.fragmentLength - offset;
+            if (length > bufLen) length = bufLen;
+            outPDV.fragmentLength = length;
+            outPDV.presentationContextID = presID;
+            outPDV.pdvType = DUL_DATASETPDV;
+            outPDV.lastPDV = pdv.lastPDV && (offset + length == pdv.fragmentLength);
+            outPDV.data = OFstatic_cast(char *, pdv.data) + offset;
+            pdvList.count = 1;
+            pdvList.pdv = &outPDV;
+
+            DCMNET_TRACE("DIMSE forwardDataSet: sending " << outPDV.fragmentLength << " bytes");
+            cond = DUL_WritePDVs(&assoc->DULassociation, &pdvList);
+            if (cond.bad())
+                return makeDcmnetSubCondition(DIMSEC_SENDFAILED, OF_error, "DIMSE Failed to send message", cond);
+            offset += length;
+        } while (offset < pdv.fragmentLength);
+
+        bytesForwarded += pdv.fragmentLength;
+        last = pdv.lastPDV;
+
+        /* execute callback function to indicate progress */
+        if (callback) {
+            callback(callbackContext, bytesForwarded);
+        }
+    }
+
+    return EC_Normal;
+}
+
+OFCondition
+DIMSE_forwardMessage(
+        T_ASC_Association *assoc,
+        T_ASC_PresentationContextID presID,
+        T_DIMSE_Message *msg,
+        T_ASC_Association *sourceAssoc,
+        T_ASC_PresentationContextID sourcePresID,
+        T_DIMSE_BlockingMode blocking,
+        int timeout,
+        DIMSE_ProgressCallback callback,
+        void *callbackContext,
+        DcmDataset **commandSet)
+{
+    E_TransferSyntax xferSyntax;
+    DcmDataset *cmdObj = NULL;
+    OFCondition cond = EC_Normal;
+
+    if (commandSet) *commandSet = NULL;
+
+    /* check if the data dictionary is available. If not return an error */
+    if (!isDataDictPresent()) return DIMSE_NODATADICT;
+
+    /* validate the message and the outgoing presentation context (see DIMSE_sendMessage) */
+    if (EC_Normal != (cond = validateMessage(assoc, msg))) return cond;
+    if (EC_Normal != (cond = checkPresentationContextForMessage(assoc, msg, presID, &xferSyntax))) return cond;
+
+    /* the data set is passed through unchanged, so both presentation contexts */
+    /* must use the same transfer syntax */
+    if (DIMSE_isDataSetPresent(msg))
+    {
+        if (sourceAssoc == NULL) return DIMSE_NULLKEY;
+        T_ASC_PresentationContext sourcePC;
+        T_ASC_PresentationContext targetPC;
+        cond = ASC_findAcceptedPresentationContext(sourceAssoc->params, sourcePresID, &sourcePC);
+        if (cond.good()) cond = ASC_findAcceptedPresentationContext(assoc->params, presID, &targetPC);
+        if (cond.bad() || (strcmp(sourcePC.acceptedTransferSyntax, targetPC.acceptedTransferSyntax) != 0))
+        {
+            DCMNET_WARN(DIMSE_warn_str(assoc) << "forwardMessage: transfer syntax of incoming and outgoing "
+                << "presentation context differ, cannot forward data set");
+            return DIMSE_NOVALIDPRESENTATIONCONTEXTID;
+        }
+    }
+
+    /* create and send the command object */
+    cond = DIMSE_buildCmdObject(msg, &cmdObj);
+    if (cond.good())
+    {
+      if (g_dimse_save_dimse_data) saveDimseFragment(cmdObj, OFTrue, OFFalse);
+      if (commandSet) *commandSet = new DcmDataset(*cmdObj);
+      DCMNET_TRACE("DIMSE Command to be forwarded on Presentation Context ID: " << OFstatic_cast(Uint16, presID));
+      DCMNET_TRACE("DIMSE Command to send:" << OFendl << DcmObject::PrintHelper(*cmdObj));
+      cond = sendDcmDataset(assoc, cmdObj, presID, EXS_LittleEndianImplicit, DUL_COMMANDPDV, NULL, NULL);
+      if (cond.good()) addCommandToMetrics(assoc, cmdObj, OFTrue);
+    }
+
+    /* relay the data set while it is being received */
+    if (cond.good() && DIMSE_isDataSetPresent(msg))
+      cond = forwardDataSet(assoc, presID, sourceAssoc, sourcePresID, blocking, timeout, callback, callbackContext);
+
+    delete cmdObj;
+    return cond;
+}
+
 /*
  * Message Receive
  */
@@ -1229,6 +1463,9 @@ DIMSE_receiveCommand(
     /* dump some more information if required */
     DCMNET_TRACE("DIMSE Command Received:" << OFendl << DcmObject::PrintHelper(*cmdSet));
 
+    /* add the DIMSE command to the association metrics (if enabled) */
+    addCommandToMetrics(assoc, cmdSet, OFFalse);
+
     /* parse the information in cmdSet and create a corresponding T_DIMSE_Message */
     /* structure which represents the the DIMSE message which was received */
     cond = DIMSE_parseCmdObject(msg, cmdSet);
@@ -1419,6 +1656,9 @@ DIMSE_receiveDataSetInFile(
 
     if ((assoc == NULL) || (presID==NULL) || (filestream==NULL)) return DIMSE_NULLKEY;
 
+    /* the time not spent in the network layer is attributed to file I/O */
+    DIMSE_MetricsTimer metricsTimer(assoc, DMT_fileIO);
+
     *presID = 0;        /* invalid value */
     offile_off_t written = 0;
     while (!last)
@@ -1553,6 +1793,9 @@ DIMSE_receiveDataSetInMemory(
         return cond;
     }
 
+    /* the time not spent in the network layer is attributed to dataset decoding */
+    DIMSE_MetricsTimer metricsTimer(assoc, DMT_datasetDecoding);
+
     /* create a buffer variable which can be used to store the received information */
     DcmInputBufferStream dataBuf;
 
@@ -0,0 +1,619 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Collection of latency and throughput metrics for associations
+ *           and DIMSE messages
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmnet/dmetrics.h"
+#include "dcmtk/dcmnet/dimse.h"
+#include "dcmtk/dcmnet/diutil.h"
+#include "dcmtk/dcmdata/dcerror.h"
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/oftimer.h"
+
+
+// upper bounds of the histogram buckets (in seconds)
+static const double HistogramUpperBounds[DCMNET_METRICS_HISTOGRAM_BUCKETS - 1] =
+{
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0
+};
+
+
+// process-wide state of the metrics collection
+
+static OFBool MetricsEnabled = OFFalse;
+static double MetricsStartTime = 0;
+static DcmNetworkMetricsSnapshot MetricsTotals;
+static OFFilename MetricsOutputFile;
+#ifdef WITH_THREADS
+static OFMutex MetricsMutex;
+#endif
+
+
+// helper functions
+
+static E_DcmMetricsCommand getMetricsCommand(const Uint16 commandField)
+{
+    // the response bit is not relevant for the DIMSE service
+    switch (commandField & ~0x8000)
+    {
+        case DIMSE_C_ECHO_RQ:
+            return DMC_CEcho;
+        case DIMSE_C_STORE_RQ:
+            return DMC_CStore;
+        case DIMSE_C_FIND_RQ:
+            return DMC_CFind;
+        case DIMSE_C_GET_RQ:
+            return DMC_CGet;
+        case DIMSE_C_MOVE_RQ:
+            return DMC_CMove;
+        case DIMSE_C_CANCEL_RQ:
+            return DMC_CCancel;
+        case DIMSE_N_EVENT_REPORT_RQ:
+            return DMC_NEventReport;
+        case DIMSE_N_GET_RQ:
+            return DMC_NGet;
+        case DIMSE_N_SET_RQ:
+            return DMC_NSet;
+        case DIMSE_N_ACTION_RQ:
+            return DMC_NAction;
+        case DIMSE_N_CREATE_RQ:
+            return DMC_NCreate;
+        case DIMSE_N_DELETE_RQ:
+            return DMC_NDelete;
+        default:
+            return DMC_NumberOfCommands;
+    }
+}
+
+
+static void writePrometheusHistogram(STD_NAMESPACE ostream &stream,
+                                     const OFString &name,
+                                     const OFString &labels,
+                                     const DcmNetworkHistogram &histogram)
+{
+    // buckets are cumulative in the Prometheus format
+    Uint64 count = 0;
+    const OFString separator = labels.empty() ? "" : ",";
+    for (size_t i = 0; i < DCMNET_METRICS_HISTOGRAM_BUCKETS - 1; ++i)
+    {
+        count += histogram.Buckets[i];
+        stream << name << "_bucket{" << labels << separator << "le=\"" << HistogramUpperBounds[i] << "\"} " << count << OFendl;
+    }
+    stream << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << histogram.Count << OFendl;
+    if (labels.empty())
+    {
+        stream << name << "_sum " << histogram.Sum << OFendl;
+        stream << name << "_count " << histogram.Count << OFendl;
+    } else {
+        stream << name << "_sum{" << labels << "} " << histogram.Sum << OFendl;
+        stream << name << "_count{" << labels << "} " << histogram.Count << OFendl;
+    }
+}
+
+
+// implementation of the histogram
+
+void DcmNetworkHistogram::clear()
+{
+    Count = 0;
+    Sum = 0;
+    for (size_t i = 0; i < DCMNET_METRICS_HISTOGRAM_BUCKETS; ++i)
+        Buckets[i] = 0;
+}
+
+
+void DcmNetworkHistogram::add(const double seconds)
+{
+    size_t idx = 0;
+    // determine the first bucket that covers the given value
+    while ((idx < DCMNET_METRICS_HISTOGRAM_BUCKETS - 1) && (seconds > HistogramUpperBounds[idx]))
+        ++idx;
+    ++Buckets[idx];
+    ++Count;
+    Sum += seconds;
+}
+
+
+void DcmNetworkHistogram::merge(const DcmNetworkHistogram &histogram)
+{
+    Count += histogram.Count;
+    Sum += histogram.Sum;
+    for (size_t i = 0; i < DCMNET_METRICS_HISTOGRAM_BUCKETS; ++i)
+        Buckets[i] += histogram.Buckets[i];
+}
+
+
+double DcmNetworkHistogram::getUpperBound(const size_t idx)
+{
+    return (idx < DCMNET_METRICS_HISTOGRAM_BUCKETS - 1) ? HistogramUpperBounds[idx] : -1;
+}
+
+
+// implementation of the snapshot
+
+void DcmNetworkMetricsSnapshot::clear()
+{
+    Duration = 0;
+    for (size_t i = 0; i < DAE_NumberOfEvents; ++i)
+        AssociationEvents[i] = 0;
+    NegotiationTime.clear();
+    PDUsSent = 0;
+    PDUsReceived = 0;
+    BytesSent = 0;
+    BytesReceived = 0;
+    for (size_t i = 0; i < DMT_NumberOfCategories; ++i)
+        Time[i] = 0;
+    for (size_t i = 0; i < DMC_NumberOfCommands; ++i)
+    {
+        DIMSE[i].RequestsSent = 0;
+        DIMSE[i].RequestsReceived = 0;
+        DIMSE[i].ResponsesSent = 0;
+        DIMSE[i].ResponsesReceived = 0;
+        DIMSE[i].Latency.clear();
+    }
+}
+
+
+void DcmNetworkMetricsSnapshot::merge(const DcmNetworkMetricsSnapshot &snapshot)
+{
+    // the duration is not merged since the periods of time usually overlap
+    for (size_t i = 0; i < DAE_NumberOfEvents; ++i)
+        AssociationEvents[i] += snapshot.AssociationEvents[i];
+    NegotiationTime.merge(snapshot.NegotiationTime);
+    PDUsSent += snapshot.PDUsSent;
+    PDUsReceived += snapshot.PDUsReceived;
+    BytesSent += snapshot.BytesSent;
+    BytesReceived += snapshot.BytesReceived;
+    for (size_t i = 0; i < DMT_NumberOfCategories; ++i)
+        Time[i] += snapshot.Time[i];
+    for (size_t i = 0; i < DMC_NumberOfCommands; ++i)
+    {
+        DIMSE[i].RequestsSent += snapshot.DIMSE[i].RequestsSent;
+        DIMSE[i].RequestsReceived += snapshot.DIMSE[i].RequestsReceived;
+        DIMSE[i].ResponsesSent += snapshot.DIMSE[i].ResponsesSent;
+        DIMSE[i].ResponsesReceived += snapshot.DIMSE[i].ResponsesReceived;
+        DIMSE[i].Latency.merge(snapshot.DIMSE[i].Latency);
+    }
+}
+
+
+double DcmNetworkMetricsSnapshot::getSendThroughput() const
+{
+    return (Time[DMT_networkWrite] > 0) ? OFstatic_cast(double, BytesSent) / Time[DMT_networkWrite] : 0;
+}
+
+
+double DcmNetworkMetricsSnapshot::getReceiveThroughput() const
+{
+    return (Time[DMT_networkRead] > 0) ? OFstatic_cast(double, BytesReceived) / Time[DMT_networkRead] : 0;
+}
+
+
+const char *DcmNetworkMetricsSnapshot::getCommandName(const E_DcmMetricsCommand command)
+{
+    switch (command)
+    {
+        case DMC_CEcho:
+            return "C-ECHO";
+        case DMC_CStore:
+            return "C-STORE";
+        case DMC_CFind:
+            return "C-FIND";
+        case DMC_CGet:
+            return "C-GET";
+        case DMC_CMove:
+            return "C-MOVE";
+        case DMC_CCancel:
+            return "C-CANCEL";
+        case DMC_NEventReport:
+            return "N-EVENT-REPORT";
+        case DMC_NGet:
+            return "N-GET";
+        case DMC_NSet:
+            return "N-SET";
+        case DMC_NAction:
+            return "N-ACTION";
+        case DMC_NCreate:
+            return "N-CREATE";
+        case DMC_NDelete:
+            return "N-DELETE";
+        default:
+            return "unknown";
+    }
+}
+
+
+const char *DcmNetworkMetricsSnapshot::getEventName(const E_DcmAssociationEvent event)
+{
+    switch (event)
+    {
+        case DAE_requested:
+            return "requested";
+        case DAE_received:
+            return "received";
+        case DAE_accepted:
+            return "accepted";
+        case DAE_rejected:
+            return "rejected";
+        case DAE_released:
+            return "released";
+        case DAE_aborted:
+            return "aborted";
+        default:
+            return "unknown";
+    }
+}
+
+
+const char *DcmNetworkMetricsSnapshot::getTimeCategoryName(const E_DcmMetricsTimeCategory category)
+{
+    switch (category)
+    {
+        case DMT_networkRead:
+            return "network_read";
+        case DMT_networkWrite:
+            return "network_write";
+        case DMT_datasetEncoding:
+            return "dataset_encoding";
+        case DMT_datasetDecoding:
+            return "dataset_decoding";
+        case DMT_fileIO:
+            return "file_io";
+        default:
+            return "unknown";
+    }
+}
+
+
+// implementation of the metrics for a single association
+
+DcmAssociationMetrics::DcmAssociationMetrics()
+  : Counters(),
+    StartTime(OFTimer::getTime()),
+    NegotiationStart(-1)
+{
+    Counters.clear();
+    for (size_t i = 0; i < DCMNET_METRICS_MAX_PENDING_REQUESTS; ++i)
+    {
+        Pending[i].Command = DMC_NumberOfCommands;
+        Pending[i].MessageID = 0;
+        Pending[i].Outgoing = OFFalse;
+        Pending[i].StartTime = 0;
+    }
+}
+
+
+void DcmAssociationMetrics::getSnapshot(DcmNetworkMetricsSnapshot &snapshot) const
+{
+    snapshot = Counters;
+    snapshot.Duration = OFTimer::getDiff(StartTime);
+}
+
+
+void DcmAssociationMetrics::addAssociationEvent(const E_DcmAssociationEvent event,
+                                                const double negotiationTime)
+{
+    if (event < DAE_NumberOfEvents)
+    {
+        ++Counters.AssociationEvents[event];
+        if (((event == DAE_accepted) || (event == DAE_rejected)) && (negotiationTime >= 0))
+            Counters.NegotiationTime.add(negotiationTime);
+    }
+}
+
+
+void DcmAssociationMetrics::startNegotiation()
+{
+    NegotiationStart = OFTimer::getTime();
+}
+
+
+double DcmAssociationMetrics::getNegotiationTime() const
+{
+    return (NegotiationStart >= 0) ? OFTimer::getDiff(NegotiationStart) : -1;
+}
+
+
+void DcmAssociationMetrics::addPDUSent(const unsigned long bytes,
+                                       const double seconds)
+{
+    ++Counters.PDUsSent;
+    Counters.BytesSent += bytes;
+    addTime(DMT_networkWrite, seconds);
+}
+
+
+void DcmAssociationMetrics::addPDUReceived(const unsigned long bytes,
+                                           const double seconds)
+{
+    ++Counters.PDUsReceived;
+    Counters.BytesReceived += bytes;
+    addTime(DMT_networkRead, seconds);
+}
+
+
+void DcmAssociationMetrics::addTime(const E_DcmMetricsTimeCategory category,
+                                    const double seconds)
+{
+    if ((category < DMT_NumberOfCategories) && (seconds > 0))
+        Counters.Time[category] += seconds;
+}
+
+
+double DcmAssociationMetrics::getTime(const E_DcmMetricsTimeCategory category) const
+{
+    return (category < DMT_NumberOfCategories) ? Counters.Time[category] : 0;
+}
+
+
+void DcmAssociationMetrics::addCommand(const Uint16 commandField,
+                                       const Uint16 messageID,
+                                       const Uint16 status,
+                                       const OFBool outgoing)
+{
+    const E_DcmMetricsCommand command = getMetricsCommand(commandField);
+    if (command == DMC_NumberOfCommands)
+        return;
+    DcmDIMSEMetrics &counters = Counters.DIMSE[command];
+    if (commandField & 0x8000)
+    {
+        // response message
+        if (outgoing)
+            ++counters.ResponsesSent;
+        else
+            ++counters.ResponsesReceived;
+        // the latency is determined for the final response only
+        if (!DICOM_PENDING_STATUS(status))
+        {
+            for (size_t i = 0; i < DCMNET_METRICS_MAX_PENDING_REQUESTS; ++i)
+            {
+                // the request must have been transferred in the opposite direction
+                if ((Pending[i].Command == command) && (Pending[i].MessageID == messageID) && (Pending[i].Outgoing != outgoing))
+                {
+                    counters.Latency.add(OFTimer::getDiff(Pending[i].StartTime));
+                    Pending[i].Command = DMC_NumberOfCommands;
+                    break;
+                }
+            }
+        }
+    } else {
+        // request message
+        if (outgoing)
+            ++counters.RequestsSent;
+        else
+            ++counters.RequestsReceived;
+        // C-CANCEL has no response
+        if (command != DMC_CCancel)
+        {
+            // remember start time (if there is a free entry)
+            for (size_t i = 0; i < DCMNET_METRICS_MAX_PENDING_REQUESTS; ++i)
+            {
+                if (Pending[i].Command == DMC_NumberOfCommands)
+                {
+                    Pending[i].Command = command;
+                    Pending[i].MessageID = messageID;
+                    Pending[i].Outgoing = outgoing;
+                    Pending[i].StartTime = OFTimer::getTime();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+
+// implementation of the process-wide collection
+
+void DcmNetworkMetrics::setEnabled(const OFBool enabled)
+{
+#ifdef WITH_THREADS
+    MetricsMutex.lock();
+#endif
+    // start measuring the time when enabled for the first time
+    if (enabled && (MetricsStartTime == 0))
+    {
+        MetricsTotals.clear();
+        MetricsStartTime = OFTimer::getTime();
+    }
+    MetricsEnabled = enabled;
+#ifdef WITH_THREADS
+    MetricsMutex.unlock();
+#endif
+}
+
+
+OFBool DcmNetworkMetrics::isEnabled()
+{
+    // reading a boolean flag does not require locking
+    return MetricsEnabled;
+}
+
+
+void DcmNetworkMetrics::setOutputFile(const OFFilename &filename)
+{
+#ifdef WITH_THREADS
+    MetricsMutex.lock();
+#endif
+    MetricsOutputFile = filename;
+#ifdef WITH_THREADS
+    MetricsMutex.unlock();
+#endif
+}
+
+
+void DcmNetworkMetrics::getSnapshot(DcmNetworkMetricsSnapshot &snapshot)
+{
+#ifdef WITH_THREADS
+    MetricsMutex.lock();
+#endif
+    snapshot = MetricsTotals;
+    snapshot.Duration = (MetricsStartTime > 0) ? OFTimer::getDiff(MetricsStartTime) : 0;
+#ifdef WITH_THREADS
+    MetricsMutex.unlock();
+#endif
+}
+
+
+void DcmNetworkMetrics::reset()
+{
+#ifdef WITH_THREADS
+    MetricsMutex.lock();
+#endif
+    MetricsTotals.clear();
+    MetricsStartTime = OFTimer::getTime();
+#ifdef WITH_THREADS
+    MetricsMutex.unlock();
+#endif
+}
+
+
+void DcmNetworkMetrics::merge(const DcmNetworkMetricsSnapshot &snapshot)
+{
+#ifdef WITH_THREADS
+    MetricsMutex.lock();
+#endif
+    MetricsTotals.merge(snapshot);
+#ifdef WITH_THREADS
+    MetricsMutex.unlock();
+#endif
+}
+
+
+void DcmNetworkMetrics::finishAssociation(DcmAssociationMetrics *metrics)
+{
+    if (metrics != NULL)
+    {
+        DcmNetworkMetricsSnapshot snapshot;
+        metrics->getSnapshot(snapshot);
+        delete metrics;
+        merge(snapshot);
+        // write current totals to file (if enabled)
+        OFFilename filename;
+#ifdef WITH_THREADS
+        MetricsMutex.lock();
+#endif
+        filename = MetricsOutputFile;
+#ifdef WITH_THREADS
+        MetricsMutex.unlock();
+#endif
+        if (!filename.isEmpty())
+        {
+            OFCondition status = writePrometheusFile(filename);
+            if (status.bad())
+                DCMNET_WARN("cannot write network metrics to file: " << filename << ": " << status.text());
+        }
+    }
+}
+
+
+void DcmNetworkMetrics::writePrometheus(STD_NAMESPACE ostream &stream,
+                                        const DcmNetworkMetricsSnapshot &snapshot,
+                                        const char *prefix)
+{
+    const OFString name = (prefix != NULL) ? prefix : "";
+    // association events
+    stream << "# HELP " << name << "associations_total Number of association events." << OFendl;
+    stream << "# TYPE " << name << "associations_total counter" << OFendl;
+    for (size_t i = 0; i < DAE_NumberOfEvents; ++i)
+    {
+        stream << name << "associations_total{event=\"" << DcmNetworkMetricsSnapshot::getEventName(OFstatic_cast(E_DcmAssociationEvent, i))
+               << "\"} " << snapshot.AssociationEvents[i] << OFendl;
+    }
+    stream << "# HELP " << name << "association_negotiation_seconds Duration of the association negotiation." << OFendl;
+    stream << "# TYPE " << name << "association_negotiation_seconds histogram" << OFendl;
+    writePrometheusHistogram(stream, name + "association_negotiation_seconds", "", snapshot.NegotiationTime);
+    // PDUs and bytes
+    stream << "# HELP " << name << "pdus_total Number of PDUs transferred." << OFendl;
+    stream << "# TYPE " << name << "pdus_total counter" << OFendl;
+    stream << name << "pdus_total{direction=\"sent\"} " << snapshot.PDUsSent << OFendl;
+    stream << name << "pdus_total{direction=\"received\"} " << snapshot.PDUsReceived << OFendl;
+    stream << "# HELP " << name << "bytes_total Number of bytes transferred (including PDU headers)." << OFendl;
+    stream << "# TYPE " << name << "bytes_total counter" << OFendl;
+    stream << name << "bytes_total{direction=\"sent\"} " << snapshot.BytesSent << OFendl;
+    stream << name << "bytes_total{direction=\"received\"} " << snapshot.BytesReceived << OFendl;
+    // time spent per category
+    stream << "# HELP " << name << "time_seconds_total Time spent per processing category." << OFendl;
+    stream << "# TYPE " << name << "time_seconds_total counter" << OFendl;
+    for (size_t i = 0; i < DMT_NumberOfCategories; ++i)
+    {
+        stream << name << "time_seconds_total{category=\"" << DcmNetworkMetricsSnapshot::getTimeCategoryName(OFstatic_cast(E_DcmMetricsTimeCategory, i))
+               << "\"} " << snapshot.Time[i] << OFendl;
+    }
+    // DIMSE messages (only services that have been used at all)
+    stream << "# HELP " << name << "dimse_messages_total Number of DIMSE messages transferred." << OFendl;
+    stream << "# TYPE " << name << "dimse_messages_total counter" << OFendl;
+    for (size_t i = 0; i < DMC_NumberOfCommands; ++i)
+    {
+        const DcmDIMSEMetrics &counters = snapshot.DIMSE[i];
+        if (counters.RequestsSent + counters.RequestsReceived + counters.ResponsesSent + counters.ResponsesReceived > 0)
+        {
+            const OFString label = OFString("command=\"") + DcmNetworkMetricsSnapshot::getCommandName(OFstatic_cast(E_DcmMetricsCommand, i)) + "\"";
+            stream << name << "dimse_messages_total{" << label << ",type=\"request\",direction=\"sent\"} " << counters.RequestsSent << OFendl;
+            stream << name << "dimse_messages_total{" << label << ",type=\"request\",direction=\"received\"} " << counters.RequestsReceived << OFendl;
+            stream << name << "dimse_messages_total{" << label << ",type=\"response\",direction=\"sent\"} " << counters.ResponsesSent << OFendl;
+            stream << name << "dimse_messages_total{" << label << ",type=\"response\",direction=\"received\"} " << counters.ResponsesReceived << OFendl;
+        }
+    }
+    stream << "# HELP " << name << "dimse_latency_seconds Time between a DIMSE request and its final response." << OFendl;
+    stream << "# TYPE " << name << "dimse_latency_seconds histogram" << OFendl;
+    for (size_t i = 0; i < DMC_NumberOfCommands; ++i)
+    {
+        if (snapshot.DIMSE[i].Latency.Count > 0)
+        {
+            const OFString label = OFString("command=\"") + DcmNetworkMetricsSnapshot::getCommandName(OFstatic_cast(E_DcmMetricsCommand, i)) + "\"";
+            writePrometheusHistogram(stream, name + "dimse_latency_seconds", label, snapshot.DIMSE[i].Latency);
+        }
+    }
+    stream << "# HELP " << name << "collection_seconds Period of time covered by the metrics." << OFendl;
+    stream << "# TYPE " << name << "collection_seconds gauge" << OFendl;
+    stream << name << "collection_seconds " << snapshot.Duration << OFendl;
+}
+
+
+OFCondition DcmNetworkMetrics::writePrometheusFile(const OFFilename &filename)
+{
+    OFCondition status = EC_Normal;
+    DcmNetworkMetricsSnapshot snapshot;
+    getSnapshot(snapshot);
+    // write to a temporary file first, so that readers never see a partial file
+    OFFilename tempFilename;
+    OFStandard::appendFilenameExtension(tempFilename, filename, ".tmp");
+    STD_NAMESPACE ofstream stream(tempFilename.getCharPointer());
+    if (stream.good())
+    {
+        writePrometheus(stream, snapshot);
+        stream.close();
+        if (stream.fail())
+            status = makeOFCondition(OFM_dcmdata, 19 /* file write */, OF_error, "Cannot write metrics file");
+        else if (!OFStandard::renameFile(tempFilename, filename))
+        {
+            // the target file might exist (e.g. on Windows), so try again after deleting it
+            OFStandard::deleteFile(filename);
+            if (!OFStandard::renameFile(tempFilename, filename))
+                status = makeOFCondition(OFM_dcmdata, 19 /* file write */, OF_error, "Cannot rename metrics file");
+        }
+    } else
+        status = EC_InvalidFilename;
+    return status;
+}
@@ -23,6 +23,7 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 
 #include "dcmtk/ofstd/ofdatime.h"
+#include "dcmtk/ofstd/ofthread.h"
 #include "dcmtk/dcmdata/dccodec.h"
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmdata/dcdatutl.h"
@@ -37,6 +38,17 @@
 #define STATUS_STORE_Pending_InvalidDatasetPointer 0xfffe
 
 
+// lossless compressed transfer syntaxes that are proposed in transcoding mode
+
+static const char *TranscodingTransferSyntaxes[] =
+{
+    UID_JPEGProcess14SV1TransferSyntax,
+    UID_JPEGLSLosslessTransferSyntax,
+    UID_JPEG2000LosslessOnlyTransferSyntax,
+    UID_RLELosslessTransferSyntax
+};
+
+
 // helper functions
 
 static const OFString &dicomToHostFilename(const OFString &dicomFilename,
@@ -134,6 +146,104 @@ void DcmStorageSCU::TransferEntry::Init()
 }
 
 
+// internal class that loads (and transcodes) a SOP instance, optionally in a background thread
+
+class DcmStorageSCUInstanceLoader
+#ifdef WITH_THREADS
+  : public OFThread
+#endif
+{
+
+  public:
+
+    DcmStorageSCUInstanceLoader(DcmStorageSCU &storageSCU,
+                                const DcmStorageSCU::TransferEntry *transferEntry)
+#ifdef WITH_THREADS
+      : OFThread(),
+        StorageSCU(storageSCU),
+#else
+      : StorageSCU(storageSCU),
+#endif
+        Entry(transferEntry),
+        FileFormat(),
+        Dataset(NULL),
+        Transcoded(OFFalse),
+        Status(EC_Normal),
+        Running(OFFalse)
+    {
+    }
+
+    ~DcmStorageSCUInstanceLoader()
+    {
+        // make sure that the background thread (if any) has finished
+        wait();
+    }
+
+    /// load the SOP instance in the calling thread
+    void load()
+    {
+        Status = StorageSCU.prepareSOPInstance(*Entry, FileFormat, Dataset, Transcoded);
+    }
+
+    /// load the SOP instance in a background thread (if possible)
+    void loadInBackground()
+    {
+#ifdef WITH_THREADS
+        if (start() == 0)
+        {
+            Running = OFTrue;
+            return;
+        }
+        DCMNET_DEBUG("cannot start background thread, loading SOP instance sequentially");
+#endif
+        load();
+    }
+
+    /// wait until the background thread (if any) has finished
+    void wait()
+    {
+#ifdef WITH_THREADS
+        if (Running)
+        {
+            join();
+            Running = OFFalse;
+        }
+#endif
+    }
+
+    /// reference to the storage SCU that owns the transfer entry
+    DcmStorageSCU &StorageSCU;
+    /// transfer entry of the SOP instance to be loaded
+    const DcmStorageSCU::TransferEntry *Entry;
+    /// file format object used to load the SOP instance from file
+    DcmFileFormat FileFormat;
+    /// dataset to be sent (owned by one of the above objects or the cache)
+    DcmDataset *Dataset;
+    /// flag indicating whether the dataset has been loaded from file and transcoded
+    OFBool Transcoded;
+    /// status of the load operation
+    OFCondition Status;
+
+  private:
+
+#ifdef WITH_THREADS
+    virtual void run()
+    {
+        load();
+    }
+#endif
+
+    /// flag indicating whether the background thread is running
+    OFBool Running;
+
+    // private undefined copy constructor
+    DcmStorageSCUInstanceLoader(const DcmStorageSCUInstanceLoader &);
+
+    // private undefined assignment operator
+    DcmStorageSCUInstanceLoader &operator=(const DcmStorageSCUInstanceLoader &);
+};
+
+
 // implementation of the main interface class
 
 DcmStorageSCU::DcmStorageSCU()
@@ -141,6 +251,12 @@ DcmStorageSCU::DcmStorageSCU()
     AssociationCounter(0),
     PresentationContextCounter(0),
     DecompressionMode(DM_default),
+    TranscodingMode(OFFalse),
+    PipelineMode(OFFalse),
+    TranscodingCacheSize(0),
+    TranscodingCacheUsage(0),
+    TranscodingCache(),
+    TranscodingCacheOrder(),
     HaltOnInvalidFileMode(OFTrue),
     HaltOnUnsuccessfulStoreMode(OFTrue),
     AllowIllegalProposalMode(OFTrue),
@@ -167,6 +283,10 @@ void DcmStorageSCU::clear()
     AssociationCounter = 0;
     PresentationContextCounter = 0;
     DecompressionMode = DM_default;
+    TranscodingMode = OFFalse;
+    PipelineMode = OFFalse;
+    TranscodingCacheSize = 0;
+    clearTranscodingCache();
     HaltOnInvalidFileMode = OFTrue;
     HaltOnUnsuccessfulStoreMode = OFTrue;
     AllowIllegalProposalMode = OFTrue;
@@ -212,6 +332,24 @@ DcmStorageSCU::E_DecompressionMode DcmStorageSCU::getDecompressionMode() const
 }
 
 
+OFBool DcmStorageSCU::getTranscodingMode() const
+{
+    return TranscodingMode;
+}
+
+
+OFBool DcmStorageSCU::getPipelineMode() const
+{
+    return PipelineMode;
+}
+
+
+size_t DcmStorageSCU::getTranscodingCacheSize() const
+{
+    return TranscodingCacheSize;
+}
+
+
 OFBool DcmStorageSCU::getHaltOnInvalidFileMode() const
 {
     return HaltOnInvalidFileMode;
@@ -251,6 +389,25 @@ void DcmStorageSCU::setDecompressionMode(const E_DecompressionMode decompression
 }
 
 
+void DcmStorageSCU::setTranscodingMode(const OFBool transcodingMode)
+{
+    TranscodingMode = transcodingMode;
+}
+
+
+void DcmStorageSCU::setPipelineMode(const OFBool pipelineMode)
+{
+    PipelineMode = pipelineMode;
+}
+
+
+void DcmStorageSCU::setTranscodingCacheSize(const size_t maxBytes)
+{
+    clearTranscodingCache();
+    TranscodingCacheSize = maxBytes;
+}
+
+
 void DcmStorageSCU::setHaltOnInvalidFileMode(const OFBool haltMode)
 {
     HaltOnInvalidFileMode = haltMode;
@@ -643,6 +800,25 @@ OFCondition DcmStorageSCU::addPresentationContexts()
                         // create list of proposed transfer syntaxes
                         transferSyntaxes.clear();
                         transferSyntaxes.push_back((*transferEntry)->TransferSyntaxUID.c_str());
+                        // check whether we should also propose other compressed transfer syntaxes
+                        if (TranscodingMode && xfer.isPixelDataCompressed() &&
+                            (xfer.isLosslessCompressed() || (DecompressionMode == DM_lossyAndLossless)) &&
+                            DcmCodecList::canChangeCoding(xfer.getXfer(), EXS_LittleEndianExplicit))
+                        {
+                            const size_t numXfers = sizeof(TranscodingTransferSyntaxes) / sizeof(TranscodingTransferSyntaxes[0]);
+                            for (size_t i = 0; i < numXfers; ++i)
+                            {
+                                const DcmXfer newXfer(TranscodingTransferSyntaxes[i]);
+                                // the pixel data is decoded first and then encoded again
+                                if ((newXfer != xfer.getXfer()) &&
+                                    DcmCodecList::canChangeCoding(EXS_LittleEndianExplicit, newXfer.getXfer()))
+                                {
+                                    DCMNET_DEBUG("also propose " << newXfer.getXferName()
+                                        << ", because we can transcode the SOP instance (if required)");
+                                    transferSyntaxes.push_back(TranscodingTransferSyntaxes[i]);
+                                }
+                            }
+                        }
                         // check whether compression is lossless and we can decompress it
                         if (xfer.isLosslessCompressed())
                         {
@@ -818,6 +994,8 @@ OFCondition DcmStorageSCU::sendSOPInstances()
     if (!TransferList.empty())
     {
         DcmDataset *dataset = NULL;
+        // loader for the SOP instance that has been prepared in advance (pipeline mode)
+        DcmStorageSCUInstanceLoader *nextLoader = NULL;
         // iterate over the list of SOP instances to be transferred
         // (continue with next SOP instance if there already was a transmission)
         OFListConstIterator(TransferEntry *) lastEntry = TransferList.end();
@@ -826,7 +1004,6 @@ OFCondition DcmStorageSCU::sendSOPInstances()
             // check whether SOP instance has already been sent
             if (!(*CurrentTransferEntry)->RequestSent)
             {
-                DcmFileFormat fileformat;
                 // check whether SOP instance can be sent on this association
                 // (i.e. whether it has been negotiated for this association)
                 if ((*CurrentTransferEntry)->PresentationContextID == 0)
@@ -836,39 +1013,35 @@ OFCondition DcmStorageSCU::sendSOPInstances()
                 }
                 // output debug information on the SOP instance to be sent
                 if ((*CurrentTransferEntry)->Filename.isEmpty())
-                {
-                    if ((*CurrentTransferEntry)->Dataset != NULL)
-                    {
-                        DCMNET_DEBUG("sending SOP instance with UID: " << (*CurrentTransferEntry)->SOPInstanceUID);
-                        dataset = (*CurrentTransferEntry)->Dataset;
-                    } else {
-                        DCMNET_ERROR("cannot send SOP instance with UID: " << (*CurrentTransferEntry)->SOPInstanceUID
-                            << ": invalid dataset pointer");
-                        // mark the SOP instance as being sent with an error that is not defined for C-STORE;
-                        // the DIMSE status indicates "pending" (see above)
-                        (*CurrentTransferEntry)->RequestSent = OFTrue;
-                        (*CurrentTransferEntry)->ResponseStatusCode = STATUS_STORE_Pending_InvalidDatasetPointer;
-                        // return with an error
-                        status = NET_EC_InvalidDatasetPointer;
-                    }
-                } else {
+                    DCMNET_DEBUG("sending SOP instance with UID: " << (*CurrentTransferEntry)->SOPInstanceUID);
+                else
                     DCMNET_DEBUG("sending SOP instance from file: " << (*CurrentTransferEntry)->Filename);
-                    // load SOP instance from DICOM file
-                    status = fileformat.loadFile((*CurrentTransferEntry)->Filename, EXS_Unknown, EGL_noChange,
-                        DCM_MaxReadLength, (*CurrentTransferEntry)->FileReadMode);
-                    if (status.good())
-                    {
-                        // do not store the dataset pointer in the transfer entry, because this pointer
-                        // will become invalid for the next iteration of this while-loop.
-                        dataset = fileformat.getDataset();
-                    } else {
-                        DCMNET_ERROR("cannot send SOP instance from file: " << (*CurrentTransferEntry)->Filename
-                            << ": " << status.text());
-                    }
+                // use the SOP instance that has been prepared in advance (if any) ...
+                DcmStorageSCUInstanceLoader *loader = nextLoader;
+                nextLoader = NULL;
+                if ((loader != NULL) && (loader->Entry == *CurrentTransferEntry))
+                    loader->wait();
+                else {
+                    delete loader;
+                    // ... or load (and transcode) it now
+                    loader = new DcmStorageSCUInstanceLoader(*this, *CurrentTransferEntry);
+                    loader->load();
+                }
+                status = loader->Status;
+                dataset = loader->Dataset;
+                if (status == NET_EC_InvalidDatasetPointer)
+                {
+                    // mark the SOP instance as being sent with an error that is not defined for C-STORE;
+                    // the DIMSE status indicates "pending" (see above)
+                    (*CurrentTransferEntry)->RequestSent = OFTrue;
+                    (*CurrentTransferEntry)->ResponseStatusCode = STATUS_STORE_Pending_InvalidDatasetPointer;
                 }
                 // send SOP instance to the peer using a C-STORE request message
                 if (status.good())
                 {
+                    // keep a copy of the transcoded dataset (if enabled)
+                    if (loader->Transcoded)
+                        addToTranscodingCache(**CurrentTransferEntry, *dataset);
                     // check whether UIDs in dataset are consistent with transfer list
                     if (DCM_dcmnetLogger.isEnabledFor(OFLogger::WARN_LOG_LEVEL) && (dataset != NULL))
                     {
@@ -893,6 +1066,21 @@ OFCondition DcmStorageSCU::sendSOPInstances()
                     }
                     // determine size of the dataset (in bytes) based on the original transfer syntax
                     (*CurrentTransferEntry)->DatasetSize = dataset->calcElementLength(dataset->getOriginalXfer(), g_dimse_send_sequenceType_encoding);
+                    // start preparing the next SOP instance while the current one is being sent
+                    if (PipelineMode)
+                    {
+                        OFListIterator(TransferEntry *) nextEntry = CurrentTransferEntry;
+                        while ((++nextEntry != lastEntry) && (*nextEntry)->RequestSent)
+                            /* skip SOP instances that have already been sent */;
+                        // (the same dataset must not be modified while it is being sent)
+                        if ((nextEntry != lastEntry) && ((*nextEntry)->PresentationContextID != 0) &&
+                            (((*nextEntry)->Dataset == NULL) || ((*nextEntry)->Dataset != (*CurrentTransferEntry)->Dataset)))
+                        {
+                            DCMNET_DEBUG("preparing next SOP instance in a background thread");
+                            nextLoader = new DcmStorageSCUInstanceLoader(*this, *nextEntry);
+                            nextLoader->loadInBackground();
+                        }
+                    }
                     // notify user of this class that the current SOP instance is to be sent
                     notifySOPInstanceToBeSent(**CurrentTransferEntry);
                     // call the inherited method from the base class doing the real work
@@ -902,6 +1090,8 @@ OFCondition DcmStorageSCU::sendSOPInstances()
                     (*CurrentTransferEntry)->AssociationNumber = AssociationCounter;
                     (*CurrentTransferEntry)->NetworkTransferSyntax = dataset->getCurrentXfer();
                 }
+                // the dataset loaded from file (if any) is no longer needed
+                delete loader;
                 // if it was successful (i.e. even if DIMSE status is not 0x0000 = success) ...
                 if (status.good())
                 {
@@ -944,6 +1134,9 @@ OFCondition DcmStorageSCU::sendSOPInstances()
             if (shouldStopAfterCurrentSOPInstance())
                 break;
         }
+        // discard the SOP instance that has been prepared in advance but not been sent
+        // (this also waits for the background thread to finish)
+        delete nextLoader;
     } else {
         // report an error to the caller
         status = NET_EC_NoSOPInstancesToSend;
@@ -971,6 +1164,131 @@ OFBool DcmStorageSCU::shouldStopAfterCurrentSOPInstance()
 }
 
 
+OFCondition DcmStorageSCU::prepareSOPInstance(const TransferEntry &transferEntry,
+                                              DcmFileFormat &fileformat,
+                                              DcmDataset *&dataset,
+                                              OFBool &transcoded)
+{
+    OFCondition status = EC_Normal;
+    dataset = NULL;
+    transcoded = OFFalse;
+    // determine the transfer syntax that has been negotiated for this SOP instance
+    E_TransferSyntax networkXfer = EXS_Unknown;
+    if (TranscodingMode || getDatasetConversionMode())
+    {
+        OFString abstractSyntax, transferSyntax;
+        findPresentationContext(transferEntry.PresentationContextID, abstractSyntax, transferSyntax);
+        if (!transferSyntax.empty())
+            networkXfer = DcmXfer(transferSyntax.c_str()).getXfer();
+    }
+    if (transferEntry.Filename.isEmpty())
+    {
+        if (transferEntry.Dataset != NULL)
+            dataset = transferEntry.Dataset;
+        else {
+            DCMNET_ERROR("cannot send SOP instance with UID: " << transferEntry.SOPInstanceUID
+                << ": invalid dataset pointer");
+            // return with an error
+            status = NET_EC_InvalidDatasetPointer;
+        }
+    } else {
+        // check whether the SOP instance has already been transcoded before
+        if ((networkXfer != EXS_Unknown) && (TranscodingCacheSize > 0))
+        {
+            OFMap<OFString, DcmDataset *>::const_iterator cached =
+                TranscodingCache.find(transferEntry.SOPInstanceUID + "\\" + DcmXfer(networkXfer).getXferID());
+            if (cached != TranscodingCache.end())
+            {
+                DCMNET_DEBUG("using transcoded dataset from cache for SOP instance with UID: " << transferEntry.SOPInstanceUID);
+                dataset = cached->second;
+                return status;
+            }
+        }
+        // load SOP instance from DICOM file
+        status = fileformat.loadFile(transferEntry.Filename, EXS_Unknown, EGL_noChange,
+            DCM_MaxReadLength, transferEntry.FileReadMode);
+        if (status.good())
+        {
+            // do not store the dataset pointer in the transfer entry, because this pointer
+            // will become invalid as soon as the file format object is deleted
+            dataset = fileformat.getDataset();
+        } else {
+            DCMNET_ERROR("cannot send SOP instance from file: " << transferEntry.Filename
+                << ": " << status.text());
+        }
+    }
+    // convert dataset to the network transfer syntax (if required)
+    if (status.good() && (networkXfer != EXS_Unknown) && (dataset->getCurrentXfer() != networkXfer))
+    {
+        const DcmXfer orgXfer(dataset->getCurrentXfer());
+        const DcmXfer netXfer(networkXfer);
+        DCMNET_DEBUG("converting transfer syntax: " << orgXfer.getXferName() << " -> " << netXfer.getXferName());
+        status = dataset->chooseRepresentation(networkXfer, NULL);
+        if (status.good())
+        {
+            // only datasets loaded from file with re-encoded pixel data are worth caching
+            transcoded = !transferEntry.Filename.isEmpty() && (orgXfer.usesEncapsulatedFormat() || netXfer.usesEncapsulatedFormat());
+        } else {
+            DCMNET_ERROR("cannot convert SOP instance with UID " << transferEntry.SOPInstanceUID
+                << " to transfer syntax " << netXfer.getXferName() << ": " << status.text());
+        }
+    }
+    return status;
+}
+
+
+void DcmStorageSCU::addToTranscodingCache(const TransferEntry &transferEntry,
+                                          DcmDataset &dataset)
+{
+    if (TranscodingCacheSize > 0)
+    {
+        const E_TransferSyntax xfer = dataset.getCurrentXfer();
+        const OFString key = transferEntry.SOPInstanceUID + "\\" + DcmXfer(xfer).getXferID();
+        const size_t size = dataset.calcElementLength(xfer, EET_ExplicitLength);
+        // datasets that do not fit into the cache at all are ignored
+        if ((size <= TranscodingCacheSize) && (TranscodingCache.find(key) == TranscodingCache.end()))
+        {
+            // remove the oldest entries until there is enough space
+            while (!TranscodingCacheOrder.empty() && (TranscodingCacheUsage + size > TranscodingCacheSize))
+            {
+                OFMap<OFString, DcmDataset *>::iterator oldest = TranscodingCache.find(TranscodingCacheOrder.front());
+                if (oldest != TranscodingCache.end())
+                {
+                    const size_t oldSize = oldest->second->calcElementLength(oldest->second->getCurrentXfer(), EET_ExplicitLength);
+                    TranscodingCacheUsage -= (oldSize < TranscodingCacheUsage) ? oldSize : TranscodingCacheUsage;
+                    delete oldest->second;
+                    TranscodingCache.erase(oldest);
+                }
+                TranscodingCacheOrder.pop_front();
+            }
+            DcmDataset *copy = new DcmDataset(dataset);
+            // only keep the transcoded representation of the pixel data
+            copy->removeAllButCurrentRepresentations();
+            copy->updateOriginalXfer();
+            TranscodingCache[key] = copy;
+            TranscodingCacheOrder.push_back(key);
+            TranscodingCacheUsage += size;
+            DCMNET_DEBUG("added transcoded dataset to cache (" << TranscodingCache.size() << " entries, "
+                << TranscodingCacheUsage << " bytes)");
+        }
+    }
+}
+
+
+void DcmStorageSCU::clearTranscodingCache()
+{
+    OFMap<OFString, DcmDataset *>::iterator iter = TranscodingCache.begin();
+    while (iter != TranscodingCache.end())
+    {
+        delete iter->second;
+        ++iter;
+    }
+    TranscodingCache.clear();
+    TranscodingCacheOrder.clear();
+    TranscodingCacheUsage = 0;
+}
+
+
 void DcmStorageSCU::getStatusSummary(OFString &summary) const
 {
     OFOStringStream stream;
@@ -0,0 +1,226 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Pool of threads handling associations accepted by the main
+ *           thread of an SCP
+ *
+ */
+
+#include "dcmtk/config/osconfig.h" /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmnet/dthrpool.h"
+
+#ifdef WITH_THREADS
+
+#include "dcmtk/dcmnet/diutil.h"
+
+// ----------------------------------------------------------------------------
+
+/** Thread of the pool, owning the handler of the thread
+ */
+class DcmAssociationThreadPoolWorker : public OFThread
+{
+public:
+
+  DcmAssociationThreadPoolWorker(DcmAssociationThreadPool& pool,
+                                 DcmAssociationHandler* handler)
+    : OFThread()
+    , m_pool(pool)
+    , m_handler(handler)
+  {
+  }
+
+  virtual ~DcmAssociationThreadPoolWorker()
+  {
+    delete m_handler;
+  }
+
+private:
+
+  virtual void run()
+  {
+    m_pool.handleAssociations(*m_handler);
+    // state kept by the handler (e.g. database handles) is released by the thread that used it
+    delete m_handler;
+    m_handler = NULL;
+  }
+
+  /// The thread pool
+  DcmAssociationThreadPool& m_pool;
+
+  /// The handler of this thread
+  DcmAssociationHandler* m_handler;
+
+  // private undefined copy constructor
+  DcmAssociationThreadPoolWorker(const DcmAssociationThreadPoolWorker&);
+
+  // private undefined assignment operator
+  DcmAssociationThreadPoolWorker& operator=(const DcmAssociationThreadPoolWorker&);
+};
+
+// ----------------------------------------------------------------------------
+
+DcmAssociationHandler::~DcmAssociationHandler()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+// On some platforms, the initial value of a semaphore is also its maximum
+// value, so the semaphore is created with the maximum value and decreased to
+// zero afterwards. The number of pending associations is limited by the
+// size of the process table of the main thread (i.e. the maximum number of
+// concurrent associations), the number of shutdown requests by the number
+// of threads.
+DcmAssociationThreadPool::DcmAssociationThreadPool(const size_t maxThreads)
+  : m_maxThreads(maxThreads > 0 ? maxThreads : 1)
+  , m_workers()
+  , m_idleWorkers(0)
+  , m_pending()
+  , m_pendingIds()
+  , m_finishedIds()
+  , m_lastId(0)
+  , m_shutdown(OFFalse)
+  , m_mutex()
+  , m_available(OFstatic_cast(unsigned int, 2 * m_maxThreads + 1))
+{
+  for (size_t i = 0; i <= 2 * m_maxThreads; ++i)
+    m_available.wait();
+}
+
+// ----------------------------------------------------------------------------
+
+DcmAssociationThreadPool::~DcmAssociationThreadPool()
+{
+  m_mutex.lock();
+  m_shutdown = OFTrue;
+  m_mutex.unlock();
+  size_t i;
+  for (i = 0; i < m_workers.size(); ++i)
+    m_available.post();
+  for (i = 0; i < m_workers.size(); ++i)
+  {
+    m_workers[i]->join();
+    delete m_workers[i];
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition DcmAssociationThreadPool::addAssociation(T_ASC_Association* assoc)
+{
+  m_mutex.lock();
+  if ((m_idleWorkers <= m_pending.size()) && (m_workers.size() < m_maxThreads))
+  {
+    OFCondition cond = EC_Normal;
+    DcmAssociationHandler* handler = createHandler(cond);
+    if (handler == NULL)
+    {
+      m_mutex.unlock();
+      if (cond.good())
+        cond = EC_IllegalCall;
+      DCMNET_ERROR("Cannot create handler for association thread: " << cond.text());
+      return cond;
+    }
+    DcmAssociationThreadPoolWorker* worker = new DcmAssociationThreadPoolWorker(*this, handler);
+    if (worker->start() != 0)
+    {
+      delete worker;
+      // the association is handled as soon as another thread is idle
+      if (m_workers.empty())
+      {
+        m_mutex.unlock();
+        DCMNET_ERROR("Cannot create association thread");
+        return EC_IllegalCall;
+      }
+    }
+    else
+    {
+      m_workers.push_back(worker);
+      ++m_idleWorkers;
+    }
+  }
+  const int id = --m_lastId;
+  addProcess(id, assoc);
+  m_pending.push_back(assoc);
+  m_pendingIds.push_back(id);
+  m_mutex.unlock();
+  m_available.post();
+  return EC_Normal;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmAssociationThreadPool::cleanFinishedAssociations()
+{
+  m_mutex.lock();
+  OFList<int> finished(m_finishedIds);
+  m_finishedIds.clear();
+  m_mutex.unlock();
+  OFListIterator(int) it = finished.begin();
+  while (it != finished.end())
+  {
+    removeProcess(*it);
+    ++it;
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+size_t DcmAssociationThreadPool::getMaxThreads() const
+{
+  return m_maxThreads;
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool DcmAssociationThreadPool::nextAssociation(T_ASC_Association*& assoc,
+                                                 int& id)
+{
+  m_available.wait();
+  OFBool result = OFFalse;
+  m_mutex.lock();
+  if (!m_pending.empty())
+  {
+    assoc = m_pending.front();
+    m_pending.pop_front();
+    id = m_pendingIds.front();
+    m_pendingIds.pop_front();
+    --m_idleWorkers;
+    result = OFTrue;
+  }
+  m_mutex.unlock();
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmAssociationThreadPool::handleAssociations(DcmAssociationHandler& handler)
+{
+  T_ASC_Association* assoc = NULL;
+  int id = 0;
+  while (nextAssociation(assoc, id))
+  {
+    handler.handleAssociation(assoc);
+    m_mutex.lock();
+    m_finishedIds.push_back(id);
+    ++m_idleWorkers;
+    m_mutex.unlock();
+  }
+}
+
+#endif // WITH_THREADS
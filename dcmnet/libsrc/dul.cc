@@ -127,6 +127,7 @@ END_EXTERN_C
 #include "dulfsm.h"
 #include "dcmtk/dcmnet/dcmtrans.h"
 #include "dcmtk/dcmnet/dcmlayer.h"
+#include "dcmtk/dcmnet/dmetrics.h"
 #include "dcmtk/ofstd/ofstd.h"
 
 OFGlobal<OFBool> dcmDisableGethostbyaddr(OFFalse);
@@ -171,9 +172,9 @@ get_association_parameter(void *paramAddress,
   DUL_DATA_TYPE outputType, void *outputAddress, size_t outputLength);
 
 #ifdef _WIN32
-static void setTCPBufferLength(SOCKET sock);
+static void setTCPBufferLength(SOCKET sock, Sint32 bufferLength);
 #else
-static void setTCPBufferLength(int sock);
+static void setTCPBufferLength(int sock, Sint32 bufferLength);
 #endif
 
 static OFCondition checkNetwork(PRIVATE_NETWORKKEY ** networkKey);
@@ -282,6 +283,16 @@ void DUL_activateCallback(DUL_ASSOCIATIONKEY *dulassoc, DUL_ModeCallback *cb)
   }
 }
 
+DcmAssociationMetrics *DUL_getAssociationMetrics(DUL_ASSOCIATIONKEY *dulassoc)
+{
+  if (dulassoc)
+  {
+    PRIVATE_ASSOCIATIONKEY *assoc = (PRIVATE_ASSOCIATIONKEY *)dulassoc;
+    return assoc->metrics;
+  }
+  return NULL;
+}
+
 void DUL_returnAssociatePDUStorage(DUL_ASSOCIATIONKEY *dulassoc, void *& pdu, unsigned long& pdusize)
 {
   if (dulassoc)
@@ -1915,7 +1926,7 @@ receiveTransportConnectionTCP(PRIVATE_NETWORKKEY ** network,
         msg += OFStandard::getLastNetworkErrorCode().message();
         return makeDcmnetCondition(DULC_TCPINITERROR, OF_error, msg.c_str());
     }
-    setTCPBufferLength(sock);
+    setTCPBufferLength(sock, (*network)->tcpBufferLength);
 
     /*
      * Disable the so-called Nagle algorithm (if requested).
@@ -1945,6 +1956,9 @@ receiveTransportConnectionTCP(PRIVATE_NETWORKKEY ** network,
       {
         DCMNET_WARN("DUL: cannot parse environment variable TCP_NODELAY=" << tcpNoDelayString);
       }
+    } else if ((*network)->tcpNoDelay) {
+      DCMNET_TRACE("  environment variable TCP_NODELAY not set, disabling Nagle algorithm as configured for the network");
+      tcpNoDelay = 1;
     } else
       DCMNET_TRACE("  environment variable TCP_NODELAY not set, using the default value (" << tcpNoDelay << ")");
     if (tcpNoDelay) {
@@ -2112,6 +2126,9 @@ createNetworkKey(const char *mode,
         (*key)->timeout = DEFAULT_TIMEOUT;
 
     (*key)->options = opt;
+    (*key)->tcpBufferLength = 0;
+    (*key)->tcpNoDelay = OFFalse;
+    (*key)->tcpCorkPDUs = OFFalse;
 
     return EC_Normal;
 }
@@ -2340,6 +2357,8 @@ createAssociationKey(PRIVATE_NETWORKKEY ** networkKey,
     key->logHandle = NULL;
     key->connection = NULL;
     key->modeCallback = NULL;
+    key->metrics = DcmNetworkMetrics::isEnabled() ? new DcmAssociationMetrics() : NULL;
+    key->tcpCorkPDUs = (*networkKey)->tcpCorkPDUs;
     *associationKey = key;
     return EC_Normal;
 }
@@ -2365,6 +2384,8 @@ static void
 destroyAssociationKey(PRIVATE_ASSOCIATIONKEY ** key)
 {
     if (*key && (*key)->connection) delete (*key)->connection;
+    /* add the metrics of this association to the process-wide totals */
+    if (*key) DcmNetworkMetrics::finishAssociation((*key)->metrics);
     free(*key);
     *key = NULL;
 }
@@ -2418,7 +2439,8 @@ get_association_parameter(void *paramAddress,
 **      Initialize the length of the buffer.
 **
 ** Parameter Dictionary:
-**      sock  Socket descriptor.
+**      sock          Socket descriptor.
+**      bufferLength  Buffer length configured for the network (0 = system default).
 **
 ** Return Values:
 **      None
@@ -2430,9 +2452,9 @@ get_association_parameter(void *paramAddress,
 **      Description of the algorithm (optional) and any other notes.
 */
 #ifdef _WIN32
-static void setTCPBufferLength(SOCKET sock)
+static void setTCPBufferLength(SOCKET sock, Sint32 bufferLength)
 #else
-static void setTCPBufferLength(int sock)
+static void setTCPBufferLength(int sock, Sint32 bufferLength)
 #endif
 {
     char *TCPBufferLength;
@@ -2458,6 +2480,14 @@ static void setTCPBufferLength(int sock)
 #endif // SO_SNDBUF and SO_RCVBUF
         } else
             DCMNET_WARN("DUL: cannot parse environment variable TCP_BUFFER_LENGTH=" << TCPBufferLength);
+    } else if (bufferLength > 0) {
+        DCMNET_TRACE("  environment variable TCP_BUFFER_LENGTH not set, using the value configured for the network");
+#if defined(SO_SNDBUF) && defined(SO_RCVBUF)
+        int bufLen = OFstatic_cast(int, bufferLength);
+        DCMNET_DEBUG("DUL: setting TCP buffer length to " << bufLen << " bytes");
+        (void) setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (char *) &bufLen, sizeof(bufLen));
+        (void) setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *) &bufLen, sizeof(bufLen));
+#endif // SO_SNDBUF and SO_RCVBUF
     } else
         DCMNET_TRACE("  environment variable TCP_BUFFER_LENGTH not set, using the system defaults");
 }
@@ -2830,6 +2860,24 @@ OFCondition DUL_setTransportLayer(DUL_NETWORKKEY *callerNetworkKey, DcmTransport
   return DUL_NULLKEY;
 }
 
+OFCondition DUL_setTCPOptions(DUL_NETWORKKEY *callerNetworkKey, Sint32 bufferLength, OFBool noDelay, OFBool corkPDUs)
+{
+  if (callerNetworkKey == NULL) return DUL_NULLKEY;
+  if (bufferLength < 0) return makeDcmnetCondition(DULC_ILLEGALPARAMETER, OF_error, "DUL Illegal parameter (bufferLength) in function DUL_setTCPOptions");
+  PRIVATE_NETWORKKEY * key = (PRIVATE_NETWORKKEY *) callerNetworkKey;
+  key->tcpBufferLength = bufferLength;
+  key->tcpNoDelay = noDelay;
+  key->tcpCorkPDUs = corkPDUs;
+#ifndef TCP_CORK
+  if (corkPDUs) DCMNET_DEBUG("DUL: TCP_CORK socket option not available on this system, ignoring");
+#endif
+  /* the receive buffer size has to be set on the listening socket in order to
+   * take effect for the window scaling negotiated for accepted connections */
+  if ((bufferLength > 0) && (key->networkSpecific.TCP.listenSocket != DCMNET_INVALID_SOCKET))
+    setTCPBufferLength(key->networkSpecific.TCP.listenSocket, bufferLength);
+  return EC_Normal;
+}
+
 OFString& DUL_DumpConnectionParameters(OFString& str, DUL_ASSOCIATIONKEY *association)
 {
   if (association)
@@ -111,8 +111,10 @@ END_EXTERN_C
 #include "dcmtk/dcmnet/dcmlayer.h"
 #include "dcmtk/dcmnet/diutil.h"
 #include "dcmtk/dcmnet/helpers.h"
+#include "dcmtk/dcmnet/dmetrics.h"
 #include "dcmtk/ofstd/ofsockad.h" /* for class OFSockAddr and SOCK_CLOEXEC */
 #include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/oftimer.h"
 #include <ctime>
 #include <climits>
 #include <cstdlib>
@@ -321,9 +323,9 @@ defragmentTCP(DcmTransportConnection *connection, DUL_BLOCKOPTIONS block, time_t
 static OFString dump_pdu(const char *type, void *buffer, unsigned long length);
 
 #ifdef _WIN32
-static void setTCPBufferLength(SOCKET sock);
+static void setTCPBufferLength(SOCKET sock, Sint32 bufferLength);
 #else
-static void setTCPBufferLength(int sock);
+static void setTCPBufferLength(int sock, Sint32 bufferLength);
 #endif
 
 OFCondition
@@ -2357,6 +2359,10 @@ requestAssociationTCP(PRIVATE_NETWORKKEY ** network,
       return makeDcmnetCondition(DULC_TCPINITERROR, OF_error, msg.c_str());
     }
 
+    // set the socket buffer lengths before connecting, so that
+    // they are taken into account for the TCP window scaling
+    setTCPBufferLength(s, (*network)->tcpBufferLength);
+
     if (connectTimeout >= 0)
     {
       // user has specified a timeout, switch socket to non-blocking mode
@@ -2533,7 +2539,6 @@ requestAssociationTCP(PRIVATE_NETWORKKEY ** network,
           msg += OFStandard::getLastNetworkErrorCode().message();
           return makeDcmnetCondition(DULC_TCPINITERROR, OF_error, msg.c_str());
         }
-        setTCPBufferLength(s);
 
         /*
          * Disable the so-called Nagle algorithm (if requested).
@@ -2563,6 +2568,9 @@ requestAssociationTCP(PRIVATE_NETWORKKEY ** network,
           {
             DCMNET_WARN("DULFSM: cannot parse environment variable TCP_NODELAY=" << tcpNoDelayString);
           }
+        } else if ((*network)->tcpNoDelay) {
+          DCMNET_TRACE("  environment variable TCP_NODELAY not set, disabling Nagle algorithm as configured for the network");
+          tcpNoDelay = 1;
         } else
           DCMNET_TRACE("  environment variable TCP_NODELAY not set, using the default value (" << tcpNoDelay << ")");
         if (tcpNoDelay) {
@@ -2662,6 +2670,8 @@ sendAssociationRQTCP(PRIVATE_NETWORKKEY ** /*network*/,
       msg += ") occurred in routine: sendAssociationRQTCP";
       return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
     }
+    if ((*association)->metrics)
+        (*association)->metrics->addPDUSent(associateRequest.length + 6, 0);
     return EC_Normal;
 }
 
@@ -2739,6 +2749,8 @@ sendAssociationACTCP(PRIVATE_NETWORKKEY ** /*network*/,
       msg += ") occurred in routine: sendAssociationACTCP";
       return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
     }
+    if ((*association)->metrics)
+        (*association)->metrics->addPDUSent(associateReply.length + 6, 0);
     return EC_Normal;
 }
 
@@ -2807,6 +2819,8 @@ sendAssociationRJTCP(PRIVATE_NETWORKKEY ** /*network*/,
           msg += ") occurred in routine: sendAssociationRJTCP";
           return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
         }
+        if ((*association)->metrics)
+            (*association)->metrics->addPDUSent(pdu.length + 6, 0);
     }
     return cond;
 }
@@ -2861,6 +2875,8 @@ sendAbortTCP(DUL_ABORTITEMS * abortItems,
           msg += ") occurred in routine: sendAbortTCP";
           return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
         }
+        if ((*association)->metrics)
+            (*association)->metrics->addPDUSent(pdu.length + 6, 0);
     }
 
     return cond;
@@ -2915,6 +2931,8 @@ sendReleaseRQTCP(PRIVATE_ASSOCIATIONKEY ** association)
           msg += ") occurred in routine: sendReleaseRQTCP";
           return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
         }
+        if ((*association)->metrics)
+            (*association)->metrics->addPDUSent(pdu.length + 6, 0);
     }
 
     return cond;
@@ -2970,6 +2988,8 @@ sendReleaseRPTCP(PRIVATE_ASSOCIATIONKEY ** association)
           msg += ") occurred in routine: sendReleaseRPTCP";
           return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
         }
+        if ((*association)->metrics)
+            (*association)->metrics->addPDUSent(pdu.length + 6, 0);
     }
 
     return cond;
@@ -3073,6 +3093,27 @@ sendPDataTCP(PRIVATE_ASSOCIATIONKEY ** association,
     return cond;
 }
 
+/* setTCPCork
+**
+** Purpose:
+**      Enable or disable the TCP_CORK socket option for the connection of an
+**      association, if this has been configured for the network. While the
+**      option is enabled, the operating system only sends full-size segments.
+**
+** Parameter Dictionary:
+**      association     Handle to the association
+**      cork            1 to enable, 0 to disable the option
+**
+** Return Values:
+**      None
+*/
+static void
+setTCPCork(PRIVATE_ASSOCIATIONKEY ** association, int cork)
+{
+    if ((*association)->tcpCorkPDUs && (*association)->connection)
+        (*association)->connection->setCorkOption(cork != 0);
+}
+
 /* writeDataPDU
 **
 ** Purpose:
@@ -3110,6 +3151,12 @@ writeDataPDU(PRIVATE_ASSOCIATIONKEY ** association,
     OFCondition cond = streamDataPDUHead(pdu, head, sizeof(head), &length);
     if (cond.bad()) return cond;
 
+    /* measure the time spent in the network layer if metrics are collected */
+    const double startTime = (*association)->metrics ? OFTimer::getTime() : 0;
+
+    /* hold back partial TCP segments until the complete PDU has been written (if configured) */
+    setTCPCork(association, 1);
+
     /* send the PDU head information (see above) */
     do
     {
@@ -3119,6 +3166,7 @@ writeDataPDU(PRIVATE_ASSOCIATIONKEY ** association,
     /* if not all head information was sent, return an error */
     if ((unsigned long) nbytes != length)
     {
+        setTCPCork(association, 0);
         OFString msg = "TCP I/O Error (";
         msg += OFStandard::getLastNetworkErrorCode().message();
         msg += ") occurred in routine: writeDataPDU";
@@ -3132,6 +3180,9 @@ writeDataPDU(PRIVATE_ASSOCIATIONKEY ** association,
         size_t(pdu->presentationDataValue.length - 2)) : 0;
     } while (nbytes == -1 && OFStandard::getLastNetworkErrorCode().value() == DCMNET_EINTR);
 
+    /* send the remaining data of the PDU immediately */
+    setTCPCork(association, 0);
+
         /* if not all head information was sent, return an error */
     if ((unsigned long) nbytes != pdu->presentationDataValue.length - 2)
     {
@@ -3141,6 +3192,12 @@ writeDataPDU(PRIVATE_ASSOCIATIONKEY ** association,
         return makeDcmnetCondition(DULC_TCPIOERROR, OF_error, msg.c_str());
     }
 
+    if ((*association)->metrics)
+    {
+        (*association)->metrics->addPDUSent(length + pdu->presentationDataValue.length - 2,
+            OFTimer::getTime() - startTime);
+    }
+
     /* return ok */
     return EC_Normal;
 }
@@ -3634,9 +3691,17 @@ readPDUBodyTCP(PRIVATE_ASSOCIATIONKEY ** association,
       /* PDVs of the current PDU are (*association)->nextPDULength bytes long. Hence, in detail */
       /* we want to try to receive (*association)->nextPDULength bytes of data on the network) */
       /* The information that was received will be available through the buffer variable. */
+      /* (the time spent waiting for the PDU head is not included in the metrics */
+      /* since this is mostly idle time of the association) */
+      const double startTime = (*association)->metrics ? OFTimer::getTime() : 0;
       cond = defragmentTCP((*association)->connection,
                          block, (*association)->timerStart, timeout,
                          buffer, (*association)->nextPDULength, &length);
+      if (cond.good() && (*association)->metrics)
+      {
+        (*association)->metrics->addPDUReceived((*association)->nextPDULength + 6,
+            OFTimer::getTime() - startTime);
+      }
     }
 
     /* return result value */
@@ -3829,9 +3894,9 @@ dump_pdu(const char *type, void *buffer, unsigned long length)
 */
 
 #ifdef _WIN32
-static void setTCPBufferLength(SOCKET sock)
+static void setTCPBufferLength(SOCKET sock, Sint32 bufferLength)
 #else
-static void setTCPBufferLength(int sock)
+static void setTCPBufferLength(int sock, Sint32 bufferLength)
 #endif
 {
     char *TCPBufferLength;
@@ -3857,6 +3922,14 @@ static void setTCPBufferLength(int sock)
 #endif // SO_SNDBUF and SO_RCVBUF
         } else
             DCMNET_WARN("DULFSM: cannot parse environment variable TCP_BUFFER_LENGTH=" << TCPBufferLength);
+    } else if (bufferLength > 0) {
+        DCMNET_TRACE("  environment variable TCP_BUFFER_LENGTH not set, using the value configured for the network");
+#if defined(SO_SNDBUF) && defined(SO_RCVBUF)
+        int bufLen = OFstatic_cast(int, bufferLength);
+        DCMNET_DEBUG("DULFSM: setting TCP buffer length to " << bufLen << " bytes");
+        (void) setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (char *) &bufLen, sizeof(bufLen));
+        (void) setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *) &bufLen, sizeof(bufLen));
+#endif // SO_SNDBUF and SO_RCVBUF
     } else
         DCMNET_TRACE("  environment variable TCP_BUFFER_LENGTH not set, using the system defaults");
 }
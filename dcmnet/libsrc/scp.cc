@@ -24,6 +24,7 @@
 #include "dcmtk/dcmdata/dcostrmf.h" /* for class DcmOutputFileStream */
 #include "dcmtk/dcmnet/assoc.h"
 #include "dcmtk/dcmnet/scp.h"
+#include "dcmtk/dcmnet/scu.h"
 #include "dcmtk/dcmtls/tlslayer.h"
 
 // ----------------------------------------------------------------------------
@@ -121,6 +122,17 @@ OFCondition DcmSCP::openListenPort()
         return cond;
     }
 
+    // Apply TCP tuning of the selected network profile (if any)
+    if (m_cfg->getNetworkProfile() != ASC_NP_DEFAULT)
+    {
+        cond = ASC_setNetworkProfile(m_network, m_cfg->getNetworkProfile());
+        if (cond.bad())
+        {
+            ASC_dropNetwork(&m_network);
+            return cond;
+        }
+    }
+
     // Update config with assigned port if client requested it
     if (port == 0)
     {
@@ -900,6 +912,48 @@ Uint16 DcmSCP::checkSTORERequest(T_DIMSE_C_StoreRQ& /*reqMessage*/, DcmDataset*
 
 // ----------------------------------------------------------------------------
 
+OFCondition DcmSCP::forwardSTORERequest(T_DIMSE_C_StoreRQ& reqMessage,
+                                        const T_ASC_PresentationContextID presID,
+                                        DcmSCU& scu)
+{
+    // Do some basic validity checks
+    if (m_assoc == NULL)
+        return DIMSE_ILLEGALASSOCIATION;
+
+    OFString tempStr;
+    // Dump debug information
+    if (DCM_dcmnetLogger.isEnabledFor(OFLogger::DEBUG_LOG_LEVEL))
+        DCMNET_INFO("Received C-STORE Request");
+    else
+        DCMNET_INFO("Received C-STORE Request (MsgID " << reqMessage.MessageID << ")");
+    DCMNET_DEBUG(DIMSE_dumpMessage(tempStr, reqMessage, DIMSE_INCOMING, NULL, presID));
+
+    // Check if dataset is announced correctly
+    if (reqMessage.DataSetType == DIMSE_DATASET_NULL)
+    {
+        DCMNET_ERROR("Received C-STORE request but no dataset announced, aborting");
+        return DIMSE_BADMESSAGE;
+    }
+
+    // Relay the request (and its dataset) to the other application
+    Uint16 rspStatusCode = 0;
+    OFCondition cond = scu.forwardSTORERequest(m_assoc, presID, reqMessage, rspStatusCode);
+    if (cond == DIMSE_NOVALIDPRESENTATIONCONTEXTID)
+        return cond;
+    if (cond.bad())
+    {
+        // The outgoing message may be incomplete, so the outgoing association cannot be used anymore
+        if (scu.isConnected())
+            scu.abortAssociation();
+        return cond;
+    }
+
+    // Send back the response received from the other application
+    return sendSTOREResponse(presID, reqMessage, rspStatusCode);
+}
+
+// ----------------------------------------------------------------------------
+
 // -- C-FIND --
 
 OFCondition DcmSCP::receiveFINDRequest(T_DIMSE_C_FindRQ& reqMessage,
@@ -1786,6 +1840,13 @@ void DcmSCP::setMaxReceivePDULength(const Uint32 maxRecPDU)
 
 // ----------------------------------------------------------------------------
 
+void DcmSCP::setNetworkProfile(const T_ASC_NetworkProfile profile)
+{
+    m_cfg->setNetworkProfile(profile);
+}
+
+// ----------------------------------------------------------------------------
+
 OFCondition DcmSCP::setEnableVerification(const OFString& profile)
 {
 
@@ -1924,6 +1985,13 @@ Uint32 DcmSCP::getMaxReceivePDULength() const
 
 // ----------------------------------------------------------------------------
 
+T_ASC_NetworkProfile DcmSCP::getNetworkProfile() const
+{
+    return m_cfg->getNetworkProfile();
+}
+
+// ----------------------------------------------------------------------------
+
 Uint16 DcmSCP::getPort() const
 {
     return m_cfg->getPort();
@@ -32,6 +32,7 @@ DcmSCPConfig::DcmSCPConfig() :
   m_aetitle("DCMTK_SCP"),
   m_refuseAssociation(OFFalse),
   m_maxReceivePDULength(ASC_DEFAULTMAXPDU),
+  m_networkProfile(ASC_NP_DEFAULT),
   m_connectionBlockingMode(DUL_BLOCK),
   m_dimseBlockingMode(DIMSE_BLOCKING),
   m_dimseTimeout(0),
@@ -60,6 +61,7 @@ DcmSCPConfig::DcmSCPConfig(const DcmSCPConfig &old) :
   m_aetitle(old.m_aetitle),
   m_refuseAssociation(old.m_refuseAssociation),
   m_maxReceivePDULength(old.m_maxReceivePDULength),
+  m_networkProfile(old.m_networkProfile),
   m_connectionBlockingMode(old.m_connectionBlockingMode),
   m_dimseBlockingMode(old.m_dimseBlockingMode),
   m_dimseTimeout(old.m_dimseTimeout),
@@ -86,6 +88,7 @@ DcmSCPConfig& DcmSCPConfig::operator=(const DcmSCPConfig &obj)
     m_aetitle = obj.m_aetitle;
     m_refuseAssociation = obj.m_refuseAssociation;
     m_maxReceivePDULength = obj.m_maxReceivePDULength;
+    m_networkProfile = obj.m_networkProfile;
     m_connectionBlockingMode = obj.m_connectionBlockingMode;
     m_dimseBlockingMode = obj.m_dimseBlockingMode;
     m_dimseTimeout = obj.m_dimseTimeout;
@@ -122,6 +125,14 @@ void DcmSCPConfig::setMaxReceivePDULength(const Uint32 maxRecPDU)
 
 // ----------------------------------------------------------------------------
 
+void DcmSCPConfig::setNetworkProfile(const T_ASC_NetworkProfile profile)
+{
+  m_networkProfile = profile;
+  m_maxReceivePDULength = ASC_getNetworkProfileMaxPDU(profile);
+}
+
+// ----------------------------------------------------------------------------
+
 void DcmSCPConfig::setPort(const Uint16 port)
 {
   m_port = port;
@@ -222,6 +233,13 @@ Uint32 DcmSCPConfig::getMaxReceivePDULength() const
 
 // ----------------------------------------------------------------------------
 
+T_ASC_NetworkProfile DcmSCPConfig::getNetworkProfile() const
+{
+  return m_networkProfile;
+}
+
+// ----------------------------------------------------------------------------
+
 Uint16 DcmSCPConfig::getPort() const
 {
   return m_port;
@@ -293,6 +293,15 @@ void DcmBaseSCPPool::notifyThreadExit(DcmBaseSCPPool::DcmBaseSCPWorker* thread,
 OFCondition DcmBaseSCPPool::initializeNework(T_ASC_Network** network)
 {
     OFCondition cond = ASC_initializeNetwork(NET_ACCEPTOR, OFstatic_cast(int, m_cfg.getPort()), m_cfg.getACSETimeout(), network);
+    if (cond.good() && (m_cfg.getNetworkProfile() != ASC_NP_DEFAULT))
+    {
+      cond = ASC_setNetworkProfile(*network, m_cfg.getNetworkProfile());
+      if (cond.bad())
+      {
+        DCMNET_ERROR("DcmBaseSCPPool: Error setting network profile: " << cond.text());
+        ASC_dropNetwork(network);
+      }
+    }
     if (cond.good())
     {
       if (m_cfg.transportLayerEnabled())
@@ -43,6 +43,7 @@ DcmSCU::DcmSCU()
     , m_assocConfigFile()
     , m_openDIMSERequest(NULL)
     , m_maxReceivePDULength(ASC_DEFAULTMAXPDU)
+    , m_networkProfile(ASC_NP_DEFAULT)
     , m_blockMode(DIMSE_BLOCKING)
     , m_ourAETitle("ANY-SCU")
     , m_peer()
@@ -123,6 +124,17 @@ OFCondition DcmSCU::initNetwork()
         return cond;
     }
 
+    /* apply TCP tuning of the selected network profile (if any) */
+    if (m_networkProfile != ASC_NP_DEFAULT)
+    {
+        cond = ASC_setNetworkProfile(m_net, m_networkProfile);
+        if (cond.bad())
+        {
+            DCMNET_ERROR(DimseCondition::dump(tempStr, cond));
+            return cond;
+        }
+    }
+
     /* initialize association parameters, i.e. create an instance of T_ASC_Parameters*. */
     cond = ASC_createAssociationParameters(&m_params, m_maxReceivePDULength, m_tcpConnectTimeout);
     if (cond.bad())
@@ -702,7 +714,6 @@ OFCondition DcmSCU::sendSTORERequest(const T_ASC_PresentationContextID presID,
     OFCondition cond;
     OFString tempStr;
     T_ASC_PresentationContextID pcid = presID;
-    DcmDataset* statusDetail         = NULL;
     T_DIMSE_Message msg;
     // Make sure everything is zeroed (especially options)
     memset((char*)&msg, 0, sizeof(msg));
@@ -842,6 +853,77 @@ OFCondition DcmSCU::sendSTORERequest(const T_ASC_PresentationContextID presID,
     }
 
     /* Receive response */
+    return receiveSTOREResponse(pcid, rspStatusCode);
+}
+
+OFCondition DcmSCU::forwardSTORERequest(T_ASC_Association* sourceAssoc,
+                                        const T_ASC_PresentationContextID sourcePresID,
+                                        const T_DIMSE_C_StoreRQ& request,
+                                        Uint16& rspStatusCode)
+{
+    // Do some basic validity checks
+    if (!isConnected() || (sourceAssoc == NULL))
+        return DIMSE_ILLEGALASSOCIATION;
+
+    OFCondition cond;
+    OFString tempStr;
+
+    /* The dataset is passed through, so find a presentation context with the same
+       abstract syntax and transfer syntax as on the incoming association */
+    T_ASC_PresentationContext sourcePC;
+    cond = ASC_findAcceptedPresentationContext(sourceAssoc->params, sourcePresID, &sourcePC);
+    if (cond.bad())
+        return DIMSE_NOVALIDPRESENTATIONCONTEXTID;
+    T_ASC_PresentationContextID pcid = findPresentationContextID(request.AffectedSOPClassUID, sourcePC.acceptedTransferSyntax);
+    if (pcid == 0)
+    {
+        OFString sopClassName = dcmFindNameOfUID(request.AffectedSOPClassUID, request.AffectedSOPClassUID);
+        OFString xferName     = DcmXfer(sourcePC.acceptedTransferSyntax).getXferName();
+        DCMNET_DEBUG("No presentation context found for forwarding C-STORE with SOP Class / Transfer Syntax: "
+                     << sopClassName << " / " << xferName);
+        return DIMSE_NOVALIDPRESENTATIONCONTEXTID;
+    }
+
+    /* Rewrite the command set: everything but the message ID is taken over */
+    T_DIMSE_Message msg;
+    // Make sure everything is zeroed (especially options)
+    memset((char*)&msg, 0, sizeof(msg));
+    msg.CommandField = DIMSE_C_STORE_RQ;
+    msg.msg.CStoreRQ = request;
+    msg.msg.CStoreRQ.MessageID = nextMessageID();
+    msg.msg.CStoreRQ.DataSetType = DIMSE_DATASET_PRESENT;
+
+    /* Send request and relay the dataset while it is being received */
+    if (DCM_dcmnetLogger.isEnabledFor(OFLogger::DEBUG_LOG_LEVEL))
+    {
+        DCMNET_INFO("Forwarding C-STORE Request");
+        DCMNET_DEBUG(DIMSE_dumpMessage(tempStr, msg, DIMSE_OUTGOING, NULL, pcid));
+    }
+    else
+    {
+        DCMNET_INFO("Forwarding C-STORE Request (MsgID " << request.MessageID << " -> " << msg.msg.CStoreRQ.MessageID << ", "
+                                                         << dcmSOPClassUIDToModality(request.AffectedSOPClassUID, "OT") << ")");
+    }
+    cond = DIMSE_forwardMessage(m_assoc, pcid, &msg, sourceAssoc, sourcePresID, m_blockMode, m_dimseTimeout,
+                                m_progressNotificationMode ? callbackSENDProgress : NULL /*callback*/,
+                                this /*callbackContext*/);
+    if (cond.bad())
+    {
+        if (cond != DIMSE_NOVALIDPRESENTATIONCONTEXTID)
+            DCMNET_ERROR("Failed forwarding C-STORE request: " << DimseCondition::dump(tempStr, cond));
+        return cond;
+    }
+
+    /* Receive response */
+    return receiveSTOREResponse(pcid, rspStatusCode);
+}
+
+OFCondition DcmSCU::receiveSTOREResponse(T_ASC_PresentationContextID pcid,
+                                         Uint16& rspStatusCode)
+{
+    OFCondition cond;
+    OFString tempStr;
+    DcmDataset* statusDetail = NULL;
     T_DIMSE_Message rsp;
     // Make sure everything is zeroed (especially options)
     memset((char*)&rsp, 0, sizeof(rsp));
@@ -2531,6 +2613,12 @@ void DcmSCU::setMaxReceivePDULength(const Uint32 maxRecPDU)
     m_maxReceivePDULength = maxRecPDU;
 }
 
+void DcmSCU::setNetworkProfile(const T_ASC_NetworkProfile profile)
+{
+    m_networkProfile = profile;
+    m_maxReceivePDULength = ASC_getNetworkProfileMaxPDU(profile);
+}
+
 void DcmSCU::setDIMSEBlockingMode(const T_DIMSE_BlockingMode blockingMode)
 {
     m_blockMode = blockingMode;
@@ -2619,6 +2707,11 @@ Uint32 DcmSCU::getMaxReceivePDULength() const
     return m_maxReceivePDULength;
 }
 
+T_ASC_NetworkProfile DcmSCU::getNetworkProfile() const
+{
+    return m_networkProfile;
+}
+
 OFBool DcmSCU::getTLSEnabled() const
 {
     return m_secureConnectionEnabled;
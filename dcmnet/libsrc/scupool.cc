@@ -0,0 +1,393 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class keeping negotiated SCU associations alive in order to
+ *           hand them over to DcmSCU instances with the same configuration
+ *
+ */
+
+#include "dcmtk/config/osconfig.h" /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmnet/scupool.h"
+#include "dcmtk/dcmnet/diutil.h"
+#include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/ofstd/oftimer.h"
+
+// ----------------------------------------------------------------------------
+
+DcmSCUAssociationPool::DcmSCUAssociationPool()
+  :
+#ifdef WITH_THREADS
+    m_mutex(),
+#endif
+    m_connected(),
+    m_idle(),
+    m_idleTimeout(60),
+    m_validationTimeout(5),
+    m_maxIdle(10),
+    m_numCreated(0),
+    m_numReused(0)
+{
+}
+
+// ----------------------------------------------------------------------------
+
+DcmSCUAssociationPool::~DcmSCUAssociationPool()
+{
+  clear();
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition DcmSCUAssociationPool::connect(DcmSCU& scu,
+                                           DcmTransportLayer* tlayer)
+{
+  if (scu.isConnected())
+    return NET_EC_AlreadyConnected;
+
+  // get rid of expired associations first so that they are not handed out
+  closeIdleAssociations();
+
+  const OFString key = createKey(scu, tlayer);
+  IdleAssociation entry;
+  while (takeIdleAssociation(key, entry))
+  {
+    const double idleTime = OFTimer::getTime() - entry.lastUsed;
+    // hand over the association (and the network it is based on) to the SCU
+    scu.freeNetwork();
+    scu.m_net = entry.network;
+    scu.m_assoc = entry.association;
+    scu.m_params = entry.parameters;
+    scu.m_secureConnectionEnabled = (tlayer != NULL);
+    if (isUsable(scu, idleTime))
+    {
+      DCMNET_DEBUG("DcmSCUAssociationPool: Reusing association to " << scu.getPeerAETitle()
+        << " (idle for " << idleTime << " seconds)");
+#ifdef WITH_THREADS
+      m_mutex.lock();
+#endif
+      m_connected[&scu] = tlayer;
+      ++m_numReused;
+#ifdef WITH_THREADS
+      m_mutex.unlock();
+#endif
+      return EC_Normal;
+    }
+    DCMNET_DEBUG("DcmSCUAssociationPool: Discarding stale association to " << scu.getPeerAETitle());
+    // also frees the network structures
+    scu.abortAssociation();
+  }
+
+  // no usable association available, negotiate a new one
+  OFCondition cond = scu.initNetwork();
+  // the transport layer can only be set once the network has been initialized
+  if (cond.good() && (tlayer != NULL))
+    cond = scu.useSecureConnection(tlayer);
+  if (cond.good())
+    cond = scu.negotiateAssociation();
+  if (cond.good())
+  {
+#ifdef WITH_THREADS
+    m_mutex.lock();
+#endif
+    m_connected[&scu] = tlayer;
+    ++m_numCreated;
+#ifdef WITH_THREADS
+    m_mutex.unlock();
+#endif
+  }
+  return cond;
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition DcmSCUAssociationPool::release(DcmSCU& scu)
+{
+  if (!scu.isConnected())
+    return DIMSE_ILLEGALASSOCIATION;
+
+  IdleAssociation entry;
+  entry.network = scu.m_net;
+  entry.association = scu.m_assoc;
+  entry.parameters = scu.m_params;
+  entry.lastUsed = OFTimer::getTime();
+
+  DcmTransportLayer* tlayer = NULL;
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  OFMap<const DcmSCU*, DcmTransportLayer*>::iterator conn = m_connected.find(&scu);
+  if (conn != m_connected.end())
+  {
+    tlayer = (*conn).second;
+    m_connected.erase(conn);
+  }
+  entry.key = createKey(scu, tlayer);
+  const OFBool keep = (m_idle.size() < m_maxIdle);
+  if (keep)
+  {
+    m_idle.push_front(entry);
+    // the SCU no longer owns the association
+    scu.m_net = NULL;
+    scu.m_assoc = NULL;
+    scu.m_params = NULL;
+  }
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+
+  if (keep)
+  {
+    // an outstanding request (if any) does not belong to the pooled association
+    scu.freeNetwork();
+    DCMNET_DEBUG("DcmSCUAssociationPool: Keeping association to " << scu.getPeerAETitle() << " for reuse");
+  }
+  else
+    scu.releaseAssociation();
+  closeIdleAssociations();
+  return EC_Normal;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmSCUAssociationPool::closeIdleAssociations()
+{
+  OFList<IdleAssociation> expired;
+  const double now = OFTimer::getTime();
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  OFListIterator(IdleAssociation) it = m_idle.begin();
+  while (it != m_idle.end())
+  {
+    if (now - (*it).lastUsed >= m_idleTimeout)
+    {
+      expired.push_back(*it);
+      it = m_idle.erase(it);
+    }
+    else
+      ++it;
+  }
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+  // close the associations without holding the lock
+  for (it = expired.begin(); it != expired.end(); ++it)
+  {
+    DCMNET_DEBUG("DcmSCUAssociationPool: Releasing association that exceeded the idle timeout");
+    closeAssociation(*it);
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmSCUAssociationPool::clear()
+{
+  OFList<IdleAssociation> idle;
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  idle.splice(idle.end(), m_idle);
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+  for (OFListIterator(IdleAssociation) it = idle.begin(); it != idle.end(); ++it)
+    closeAssociation(*it);
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmSCUAssociationPool::setIdleTimeout(const Uint32 seconds)
+{
+  m_idleTimeout = seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmSCUAssociationPool::setValidationTimeout(const Uint32 seconds)
+{
+  m_validationTimeout = seconds;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmSCUAssociationPool::setMaxIdleAssociations(const size_t maxIdle)
+{
+  m_maxIdle = maxIdle;
+}
+
+// ----------------------------------------------------------------------------
+
+Uint32 DcmSCUAssociationPool::getIdleTimeout() const
+{
+  return m_idleTimeout;
+}
+
+// ----------------------------------------------------------------------------
+
+Uint32 DcmSCUAssociationPool::getValidationTimeout() const
+{
+  return m_validationTimeout;
+}
+
+// ----------------------------------------------------------------------------
+
+size_t DcmSCUAssociationPool::getMaxIdleAssociations() const
+{
+  return m_maxIdle;
+}
+
+// ----------------------------------------------------------------------------
+
+size_t DcmSCUAssociationPool::getNumberOfIdleAssociations()
+{
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  const size_t result = m_idle.size();
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long DcmSCUAssociationPool::getNumberOfCreatedAssociations()
+{
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  const unsigned long result = m_numCreated;
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+unsigned long DcmSCUAssociationPool::getNumberOfReusedAssociations()
+{
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  const unsigned long result = m_numReused;
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+OFString DcmSCUAssociationPool::createKey(const DcmSCU& scu,
+                                          const DcmTransportLayer* tlayer)
+{
+  // backslashes are not allowed in AE titles and UIDs, so use them as separator
+  OFOStringStream stream;
+  stream << scu.m_ourAETitle << "\\" << scu.m_peerAETitle << "\\" << scu.m_peer << "\\"
+         << scu.m_peerPort << "\\" << scu.m_maxReceivePDULength << "\\"
+         << OFstatic_cast(int, scu.m_networkProfile) << "\\" << OFstatic_cast(int, scu.m_protocolVersion)
+         << "\\" << OFstatic_cast(const void*, tlayer) << "\\";
+  if (!scu.m_assocConfigFilename.empty())
+    stream << scu.m_assocConfigFilename << "\\" << scu.m_assocConfigProfile;
+  else
+  {
+    OFListConstIterator(DcmSCU::DcmSCUPresContext) pc = scu.m_presContexts.begin();
+    while (pc != scu.m_presContexts.end())
+    {
+      stream << (*pc).abstractSyntaxName << "=" << OFstatic_cast(int, (*pc).roleSelect);
+      OFListConstIterator(OFString) ts = (*pc).transferSyntaxes.begin();
+      while (ts != (*pc).transferSyntaxes.end())
+      {
+        stream << "," << *ts;
+        ++ts;
+      }
+      stream << "\\";
+      ++pc;
+    }
+  }
+  stream << OFStringStream_ends;
+  OFSTRINGSTREAM_GETOFSTRING(stream, result)
+  return result;
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool DcmSCUAssociationPool::isUsable(DcmSCU& scu, const double idleTime)
+{
+  if (!scu.isConnected())
+    return OFFalse;
+  // the peer must not send anything on an idle association, so incoming data
+  // is either an A-RELEASE request, an A-ABORT or a closed connection
+  if (ASC_dataWaiting(scu.m_assoc, 0))
+    return OFFalse;
+  if (idleTime >= m_validationTimeout)
+  {
+    const T_ASC_PresentationContextID presID = scu.findAnyPresentationContextID(UID_VerificationSOPClass, UID_LittleEndianImplicitTransferSyntax);
+    if (presID != 0)
+    {
+      DCMNET_DEBUG("DcmSCUAssociationPool: Validating idle association with C-ECHO");
+      return scu.sendECHORequest(presID).good();
+    }
+  }
+  return OFTrue;
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool DcmSCUAssociationPool::takeIdleAssociation(const OFString& key,
+                                                  IdleAssociation& entry)
+{
+  OFBool found = OFFalse;
+#ifdef WITH_THREADS
+  m_mutex.lock();
+#endif
+  for (OFListIterator(IdleAssociation) it = m_idle.begin(); it != m_idle.end(); ++it)
+  {
+    if ((*it).key == key)
+    {
+      entry = *it;
+      m_idle.erase(it);
+      found = OFTrue;
+      break;
+    }
+  }
+#ifdef WITH_THREADS
+  m_mutex.unlock();
+#endif
+  return found;
+}
+
+// ----------------------------------------------------------------------------
+
+void DcmSCUAssociationPool::closeAssociation(IdleAssociation& entry)
+{
+  if (entry.association != NULL)
+  {
+    OFCondition cond = ASC_releaseAssociation(entry.association);
+    if (cond.bad())
+      ASC_abortAssociation(entry.association);
+    // also destroys the association parameters
+    ASC_destroyAssociation(&entry.association);
+  }
+  else if (entry.parameters != NULL)
+    ASC_destroyAssociationParameters(&entry.parameters);
+  entry.parameters = NULL;
+  ASC_dropNetwork(&entry.network);
+}
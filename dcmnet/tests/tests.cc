@@ -25,6 +25,9 @@
 
 OFTEST_REGISTER(dcmnet_dimseDump_nullByte);
 OFTEST_REGISTER(dcmnet_dimseStatusClass);
+OFTEST_REGISTER(dcmnet_metrics_histogram);
+OFTEST_REGISTER(dcmnet_metrics_association);
+OFTEST_REGISTER(dcmnet_metrics_prometheus);
 
 #ifdef WITH_THREADS
 OFTEST_REGISTER(dcmnet_scp_pool);
@@ -37,7 +40,11 @@ OFTEST_REGISTER(dcmnet_scp_no_stop_wo_request_noblock);
 OFTEST_REGISTER(dcmnet_scp_no_stop_wo_request_block);
 OFTEST_REGISTER(dcmnet_scp_no_term_notify_without_association);
 OFTEST_REGISTER(dcmnet_scp_role_selection);
+OFTEST_REGISTER(dcmnet_scp_forward_store_request);
+OFTEST_REGISTER(dcmnet_storescu_transcoding_cache);
 OFTEST_REGISTER(dcmnet_scu_session_handler);
+OFTEST_REGISTER(dcmnet_scu_network_profile_throughput);
+OFTEST_REGISTER(dcmnet_scu_association_pool);
 
 OFTEST_REGISTER(dcmnet_scu_setConectionTimeout_does_not_change_global_dcmConnectionTimeout_parameter);
 OFTEST_REGISTER(dcmnet_scu_getConectionTimeout_returns_scu_tcp_connection_timeout);
@@ -0,0 +1,115 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmnet
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the network metrics classes
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofstream.h"
+#include "dcmtk/dcmnet/dmetrics.h"
+#include "dcmtk/dcmnet/dimse.h"
+
+
+OFTEST(dcmnet_metrics_histogram)
+{
+    DcmNetworkHistogram histogram;
+    histogram.clear();
+    histogram.add(0.0001);
+    histogram.add(0.5);
+    histogram.add(1e9);
+    OFCHECK_EQUAL(histogram.Count, 3);
+    OFCHECK_EQUAL(histogram.Buckets[0], 1);
+    // very large values end up in the last bucket (+Inf)
+    OFCHECK_EQUAL(histogram.Buckets[DCMNET_METRICS_HISTOGRAM_BUCKETS - 1], 1);
+    OFCHECK(DcmNetworkHistogram::getUpperBound(DCMNET_METRICS_HISTOGRAM_BUCKETS - 1) < 0);
+
+    DcmNetworkHistogram other;
+    other.clear();
+    other.add(0.5);
+    histogram.merge(other);
+    OFCHECK_EQUAL(histogram.Count, 4);
+    OFCHECK(histogram.Sum > 1.0);
+}
+
+
+OFTEST(dcmnet_metrics_association)
+{
+    DcmAssociationMetrics metrics;
+    metrics.addAssociationEvent(DAE_received);
+    metrics.addAssociationEvent(DAE_accepted, 0.01);
+    metrics.addPDUSent(1000, 0.1);
+    metrics.addPDUReceived(2000, 0.2);
+    // C-STORE request received and final response sent
+    metrics.addCommand(DIMSE_C_STORE_RQ, 1, 0, OFFalse);
+    metrics.addCommand(DIMSE_C_STORE_RSP, 1, STATUS_Success, OFTrue);
+    // C-FIND request sent, pending and final response received
+    metrics.addCommand(DIMSE_C_FIND_RQ, 7, 0, OFTrue);
+    metrics.addCommand(DIMSE_C_FIND_RSP, 7, STATUS_FIND_Pending_MatchesAreContinuing, OFFalse);
+    metrics.addCommand(DIMSE_C_FIND_RSP, 7, STATUS_Success, OFFalse);
+    metrics.addAssociationEvent(DAE_released);
+
+    DcmNetworkMetricsSnapshot snapshot;
+    metrics.getSnapshot(snapshot);
+    OFCHECK_EQUAL(snapshot.AssociationEvents[DAE_received], 1);
+    OFCHECK_EQUAL(snapshot.AssociationEvents[DAE_accepted], 1);
+    OFCHECK_EQUAL(snapshot.AssociationEvents[DAE_released], 1);
+    OFCHECK_EQUAL(snapshot.AssociationEvents[DAE_aborted], 0);
+    OFCHECK_EQUAL(snapshot.NegotiationTime.Count, 1);
+    OFCHECK_EQUAL(snapshot.PDUsSent, 1);
+    OFCHECK_EQUAL(snapshot.BytesSent, 1000);
+    OFCHECK_EQUAL(snapshot.PDUsReceived, 1);
+    OFCHECK_EQUAL(snapshot.BytesReceived, 2000);
+    OFCHECK(snapshot.Time[DMT_networkWrite] > 0.09);
+    OFCHECK(snapshot.Time[DMT_networkRead] > 0.19);
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CStore].RequestsReceived, 1);
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CStore].ResponsesSent, 1);
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CStore].Latency.Count, 1);
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CFind].RequestsSent, 1);
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CFind].ResponsesReceived, 2);
+    // the latency is only determined for the final response
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CFind].Latency.Count, 1);
+    OFCHECK_EQUAL(snapshot.DIMSE[DMC_CEcho].RequestsSent, 0);
+}
+
+
+OFTEST(dcmnet_metrics_prometheus)
+{
+    DcmAssociationMetrics metrics;
+    metrics.addAssociationEvent(DAE_requested);
+    metrics.addAssociationEvent(DAE_accepted, 0.02);
+    metrics.addPDUSent(4096, 0.001);
+    metrics.addCommand(DIMSE_C_ECHO_RQ, 1, 0, OFTrue);
+    metrics.addCommand(DIMSE_C_ECHO_RSP, 1, STATUS_Success, OFFalse);
+
+    DcmNetworkMetricsSnapshot snapshot;
+    metrics.getSnapshot(snapshot);
+    OFOStringStream stream;
+    DcmNetworkMetrics::writePrometheus(stream, snapshot, "test_");
+    stream << OFStringStream_ends;
+    OFSTRINGSTREAM_GETOFSTRING(stream, result)
+    OFCHECK(result.find("# TYPE test_associations_total counter") != OFString_npos);
+    OFCHECK(result.find("test_associations_total{event=\"accepted\"} 1") != OFString_npos);
+    OFCHECK(result.find("test_bytes_total{direction=\"sent\"} 4096") != OFString_npos);
+    OFCHECK(result.find("test_dimse_messages_total{command=\"C-ECHO\",type=\"request\",direction=\"sent\"} 1") != OFString_npos);
+    OFCHECK(result.find("test_dimse_latency_seconds_count{command=\"C-ECHO\"} 1") != OFString_npos);
+    // services that have not been used are not listed
+    OFCHECK(result.find("C-STORE") == OFString_npos);
+}
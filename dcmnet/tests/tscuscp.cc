@@ -26,8 +26,14 @@
 #include "dcmtk/ofstd/oftest.h"
 #include "dcmtk/ofstd/oftimer.h"
 #include "dcmtk/ofstd/ofrand.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/oftempf.h"
+#include "dcmtk/dcmdata/dcrledrg.h"
+#include "dcmtk/dcmdata/dcrleerg.h"
 #include "dcmtk/dcmnet/scp.h"
 #include "dcmtk/dcmnet/scu.h"
+#include "dcmtk/dcmnet/scupool.h"
+#include "dcmtk/dcmnet/dstorscu.h"
 
 
 /** SCP derived from DcmSCP in order to test two types of virtual methods:
@@ -1113,4 +1119,390 @@ OFTEST_FLAGS(dcmnet_scu_sendNSETRequest_succeeds_and_sets_responsestatuscode_fro
 }
 
 
+/** Test SCP that accepts C-STORE requests and keeps the received datasets in memory */
+struct TestSCPWithStoreSupport : TestSCP
+{
+    TestSCPWithStoreSupport(const T_ASC_NetworkProfile profile)
+        : TestSCP()
+        , m_numReceived(0)
+        , m_lastPixelDataLength(0)
+        , m_keepPixelData(OFFalse)
+        , m_pixelData()
+    {
+        DcmSCPConfig& config = getConfig();
+        config.setAETitle("STORE_SCP");
+        config.setConnectionBlockingMode(DUL_BLOCK);
+        config.setHostLookupEnabled(OFFalse);
+        config.setNetworkProfile(profile);
+        configure_scp_for_echo(config, 0);
+        OFList<OFString> xfers;
+        xfers.push_back(UID_LittleEndianExplicitTransferSyntax);
+        OFCHECK(config.addPresentationContext(UID_SecondaryCaptureImageStorage, xfers).good());
+        OFCHECK(openListenPort().good());
+        m_set_stop_after_assoc = OFTrue;
+    }
+
+    /** Overloads base class to add support for C-STORE requests. */
+    OFCondition handleIncomingCommand(T_DIMSE_Message* incomingMsg, const DcmPresentationContextInfo& presInfo) /* override */
+    {
+        if (incomingMsg->CommandField == DIMSE_C_STORE_RQ)
+        {
+            T_DIMSE_C_StoreRQ& storeReq = incomingMsg->msg.CStoreRQ;
+            DcmDataset* dataset = NULL;
+            OFCondition result = receiveSTORERequest(storeReq, presInfo.presentationContextID, dataset);
+            if (result.good())
+            {
+                DcmElement* pixelData = NULL;
+                if (dataset->findAndGetElement(DCM_PixelData, pixelData).good())
+                {
+                    m_lastPixelDataLength = pixelData->getLength();
+                    Uint8* data = NULL;
+                    if (m_keepPixelData && pixelData->getUint8Array(data).good() && (data != NULL))
+                        m_pixelData.push_back(OFString(OFreinterpret_cast(const char*, data), m_lastPixelDataLength));
+                }
+                delete dataset;
+                ++m_numReceived;
+                result = sendSTOREResponse(presInfo.presentationContextID, storeReq, STATUS_Success);
+            }
+            return result;
+        }
+        return DcmSCP::handleIncomingCommand(incomingMsg, presInfo);
+    }
+
+    /// Number of C-STORE requests that have been received successfully
+    size_t m_numReceived;
+    /// Length of the pixel data of the last dataset received
+    Uint32 m_lastPixelDataLength;
+    /// If set, the (uncompressed) pixel data of each dataset received is kept
+    OFBool m_keepPixelData;
+    /// Pixel data of the datasets received if m_keepPixelData is set
+    OFVector<OFString> m_pixelData;
+};
+
+
+/** Send a number of large C-STORE requests over the loopback interface using
+ *  the given network profile on both sides and return the throughput
+ *  @param profile The network profile to be used by SCU and SCP
+ *  @param numObjects The number of objects to be sent
+ *  @param objectSize The size of the pixel data of each object in bytes
+ *  @return The throughput in MB/s
+ */
+static double measure_store_throughput(const T_ASC_NetworkProfile profile,
+                                       const size_t numObjects,
+                                       const Uint32 objectSize)
+{
+    TestSCPWithStoreSupport scp(profile);
+    scp.start();
+    OFStandard::forceSleep(1);
+
+    DcmDataset dataset;
+    OFCHECK(dataset.putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage).good());
+    OFCHECK(dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.1").good());
+    OFVector<Uint8> pixelData(objectSize, 0x5a);
+    OFCHECK(dataset.putAndInsertUint8Array(DCM_PixelData, &pixelData[0], objectSize).good());
+
+    DcmSCU scu;
+    scu.setAETitle("STORE_SCU");
+    scu.setPeerAETitle("STORE_SCP");
+    scu.setPeerHostName("localhost");
+    scu.setPeerPort(scp.getConfig().getPort());
+    scu.setNetworkProfile(profile);
+    OFList<OFString> xfers;
+    xfers.push_back(UID_LittleEndianExplicitTransferSyntax);
+    OFCondition result;
+    OFCHECK_MSG((result = scu.addPresentationContext(UID_SecondaryCaptureImageStorage, xfers)).good(), result.text());
+    OFCHECK_MSG((result = scu.initNetwork()).good(), result.text());
+    OFCHECK_MSG((result = scu.negotiateAssociation()).good(), result.text());
+    const T_ASC_PresentationContextID presID = scu.findPresentationContextID(UID_SecondaryCaptureImageStorage, UID_LittleEndianExplicitTransferSyntax);
+    OFCHECK(presID != 0);
+
+    OFTimer timer;
+    for (size_t i = 0; i < numObjects; ++i)
+    {
+        Uint16 status = 0;
+        OFCHECK_MSG((result = scu.sendSTORERequest(presID, "", &dataset, status)).good(), result.text());
+        OFCHECK_EQUAL(status, STATUS_Success);
+    }
+    const double seconds = timer.getDiff();
+    OFCHECK_MSG((result = scu.releaseAssociation()).good(), result.text());
+    OFCHECK(scp.join() != OFThread::busy);
+    OFCHECK_EQUAL(scp.m_numReceived, numObjects);
+    return (seconds > 0) ? (OFstatic_cast(double, numObjects) * objectSize / (1024.0 * 1024.0)) / seconds : 0;
+}
+
+
+// Loopback benchmark comparing the default and the high-throughput network
+// profile. Only checks that both profiles work; the throughput is logged.
+OFTEST_FLAGS(dcmnet_scu_network_profile_throughput, EF_Slow)
+{
+    OFCHECK_EQUAL(ASC_getNetworkProfileMaxPDU(ASC_NP_DEFAULT), ASC_DEFAULTMAXPDU);
+    OFCHECK_EQUAL(ASC_getNetworkProfileMaxPDU(ASC_NP_HIGHTHROUGHPUT), ASC_MAXIMUMPDUSIZE);
+    OFCHECK(ASC_computeTCPBufferLength(ASC_DEFAULTBANDWIDTH, ASC_DEFAULTROUNDTRIPTIME) > 0);
+    const double defaultRate = measure_store_throughput(ASC_NP_DEFAULT, 20, 16 * 1024 * 1024);
+    const double tunedRate = measure_store_throughput(ASC_NP_HIGHTHROUGHPUT, 20, 16 * 1024 * 1024);
+    DCMNET_INFO("loopback C-STORE throughput: default profile " << defaultRate
+        << " MB/s, high-throughput profile " << tunedRate << " MB/s");
+}
+
+
+
+/** Configure SCU for sending C-ECHO to the given port
+ *  @param scu The SCU to configure
+ *  @param port The port of the SCP
+ */
+static void configure_scu_for_echo(DcmSCU& scu, const Uint16 port)
+{
+    scu.setAETitle("POOL_SCU");
+    scu.setPeerAETitle("POOL_SCP");
+    scu.setPeerHostName("localhost");
+    scu.setPeerPort(port);
+    OFList<OFString> xfers;
+    xfers.push_back(UID_LittleEndianImplicitTransferSyntax);
+    OFCHECK(scu.addPresentationContext(UID_VerificationSOPClass, xfers).good());
+}
+
+
+// Test case that checks whether the association pool hands over an idle
+// association to another SCU with the same configuration, i.e. the SCP only
+// sees a single association
+OFTEST_FLAGS(dcmnet_scu_association_pool, EF_Slow)
+{
+    TestSCP scp;
+    DcmSCPConfig& config = scp.getConfig();
+    config.setPort(0);
+    config.setAETitle("POOL_SCP");
+    config.setConnectionBlockingMode(DUL_BLOCK);
+    scp.setEnableVerification();
+    // the SCP does not accept a second association
+    scp.m_set_stop_after_assoc = OFTrue;
+    OFCHECK(scp.openListenPort().good());
+    const Uint16 port = config.getPort();
+    scp.start();
+    OFStandard::forceSleep(1);
+
+    DcmSCUAssociationPool pool;
+    OFCondition result;
+    {
+        DcmSCU scu;
+        configure_scu_for_echo(scu, port);
+        OFCHECK_MSG((result = pool.connect(scu)).good(), result.text());
+        OFCHECK_MSG((result = scu.sendECHORequest(0)).good(), result.text());
+        OFCHECK_MSG((result = pool.release(scu)).good(), result.text());
+        OFCHECK(!scu.isConnected());
+    }
+    OFCHECK_EQUAL(pool.getNumberOfIdleAssociations(), 1);
+
+    // a different configuration does not match the idle association
+    DcmSCU other;
+    configure_scu_for_echo(other, port);
+    other.setAETitle("OTHER_SCU");
+    OFCHECK(DcmSCUAssociationPool::createKey(other) != "");
+    {
+        DcmSCU scu;
+        configure_scu_for_echo(scu, port);
+        OFCHECK(DcmSCUAssociationPool::createKey(scu) != DcmSCUAssociationPool::createKey(other));
+        // validate the association with C-ECHO before it is handed out
+        pool.setValidationTimeout(0);
+        OFCHECK_MSG((result = pool.connect(scu)).good(), result.text());
+        OFCHECK(scu.isConnected());
+        OFCHECK_EQUAL(pool.getNumberOfIdleAssociations(), 0);
+        OFCHECK_MSG((result = scu.sendECHORequest(0)).good(), result.text());
+        OFCHECK_MSG((result = pool.release(scu)).good(), result.text());
+    }
+    OFCHECK_EQUAL(pool.getNumberOfCreatedAssociations(), 1);
+    OFCHECK_EQUAL(pool.getNumberOfReusedAssociations(), 1);
+
+    // releasing the idle association ends the SCP
+    pool.clear();
+    OFCHECK_EQUAL(pool.getNumberOfIdleAssociations(), 0);
+    OFStandard::forceSleep(1);
+    OFCHECK(scp.m_listen_result == NET_EC_StopAfterAssociation);
+    scp.join();
+}
+
+
+
+/** Test SCP that forwards all C-STORE requests to another SCP */
+struct TestForwardingSCP : TestSCP
+{
+    TestForwardingSCP(const Uint16 targetPort)
+        : TestSCP()
+        , m_scu()
+    {
+        DcmSCPConfig& config = getConfig();
+        config.setAETitle("ROUTER_SCP");
+        config.setConnectionBlockingMode(DUL_BLOCK);
+        config.setHostLookupEnabled(OFFalse);
+        // use larger PDUs than the target in order to split fragments
+        config.setNetworkProfile(ASC_NP_HIGHTHROUGHPUT);
+        config.setPort(0);
+        OFList<OFString> xfers;
+        xfers.push_back(UID_LittleEndianExplicitTransferSyntax);
+        OFCHECK(config.addPresentationContext(UID_SecondaryCaptureImageStorage, xfers).good());
+        OFCHECK(openListenPort().good());
+        m_set_stop_after_assoc = OFTrue;
+
+        m_scu.setAETitle("ROUTER_SCU");
+        m_scu.setPeerAETitle("STORE_SCP");
+        m_scu.setPeerHostName("localhost");
+        m_scu.setPeerPort(targetPort);
+        OFCHECK(m_scu.addPresentationContext(UID_SecondaryCaptureImageStorage, xfers).good());
+    }
+
+    /** Overloads base class to forward C-STORE requests. */
+    OFCondition handleIncomingCommand(T_DIMSE_Message* incomingMsg, const DcmPresentationContextInfo& presInfo) /* override */
+    {
+        if (incomingMsg->CommandField == DIMSE_C_STORE_RQ)
+        {
+            OFCondition result;
+            if (!m_scu.isConnected())
+            {
+                result = m_scu.initNetwork();
+                if (result.good())
+                    result = m_scu.negotiateAssociation();
+                if (result.bad())
+                    return result;
+            }
+            return forwardSTORERequest(incomingMsg->msg.CStoreRQ, presInfo.presentationContextID, m_scu);
+        }
+        return DcmSCP::handleIncomingCommand(incomingMsg, presInfo);
+    }
+
+    /** Overloads base class to release the outgoing association. */
+    void notifyAssociationTermination() /* override */
+    {
+        if (m_scu.isConnected())
+            m_scu.releaseAssociation();
+        TestSCP::notifyAssociationTermination();
+    }
+
+    /// SCU connected to the target SCP
+    DcmSCU m_scu;
+};
+
+
+// Test case that checks whether C-STORE requests can be forwarded through
+// a DcmSCP to another SCP while the dataset is being received
+OFTEST_FLAGS(dcmnet_scp_forward_store_request, EF_Slow)
+{
+    TestSCPWithStoreSupport target(ASC_NP_DEFAULT);
+    target.start();
+    TestForwardingSCP router(target.getConfig().getPort());
+    router.start();
+    OFStandard::forceSleep(1);
+
+    const Uint32 objectSize = 1024 * 1024 + 2;
+    DcmDataset dataset;
+    OFCHECK(dataset.putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage).good());
+    OFCHECK(dataset.putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.2").good());
+    OFVector<Uint8> pixelData(objectSize, 0xa5);
+    OFCHECK(dataset.putAndInsertUint8Array(DCM_PixelData, &pixelData[0], objectSize).good());
+
+    DcmSCU scu;
+    scu.setAETitle("STORE_SCU");
+    scu.setPeerAETitle("ROUTER_SCP");
+    scu.setPeerHostName("localhost");
+    scu.setPeerPort(router.getConfig().getPort());
+    scu.setNetworkProfile(ASC_NP_HIGHTHROUGHPUT);
+    OFList<OFString> xfers;
+    xfers.push_back(UID_LittleEndianExplicitTransferSyntax);
+    OFCondition result;
+    OFCHECK_MSG((result = scu.addPresentationContext(UID_SecondaryCaptureImageStorage, xfers)).good(), result.text());
+    OFCHECK_MSG((result = scu.initNetwork()).good(), result.text());
+    OFCHECK_MSG((result = scu.negotiateAssociation()).good(), result.text());
+    const T_ASC_PresentationContextID presID = scu.findPresentationContextID(UID_SecondaryCaptureImageStorage, UID_LittleEndianExplicitTransferSyntax);
+    OFCHECK(presID != 0);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        Uint16 status = 0;
+        OFCHECK_MSG((result = scu.sendSTORERequest(presID, "", &dataset, status)).good(), result.text());
+        OFCHECK_EQUAL(status, STATUS_Success);
+    }
+    OFCHECK_MSG((result = scu.releaseAssociation()).good(), result.text());
+
+    OFCHECK(router.join() != OFThread::busy);
+    OFCHECK(target.join() != OFThread::busy);
+    OFCHECK_EQUAL(target.m_numReceived, 3);
+    OFCHECK_EQUAL(target.m_lastPixelDataLength, objectSize);
+}
+
+
+// Test case that checks whether DcmStorageSCU transcodes a compressed file
+// only once when it is sent twice, i.e. the second C-STORE request is served
+// from the transcoding cache and transfers the same pixel data
+OFTEST_FLAGS(dcmnet_storescu_transcoding_cache, EF_Slow)
+{
+    DcmRLEDecoderRegistration::registerCodecs();
+    DcmRLEEncoderRegistration::registerCodecs();
+
+    // create an RLE compressed image, the SCP only accepts uncompressed data
+    OFTempFile temp;
+    OFCHECK_MSG(temp.getStatus().good(), temp.getStatus().text());
+    {
+        DcmFileFormat fileformat;
+        DcmDataset* dataset = fileformat.getDataset();
+        OFCHECK(dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage).good());
+        OFCHECK(dataset->putAndInsertString(DCM_SOPInstanceUID, "1.2.276.0.7230010.3.1.4.0.3").good());
+        OFCHECK(dataset->putAndInsertString(DCM_StudyInstanceUID, "1.2.276.0.7230010.3.1.2.0.3").good());
+        OFCHECK(dataset->putAndInsertString(DCM_SeriesInstanceUID, "1.2.276.0.7230010.3.1.3.0.3").good());
+        OFCHECK(dataset->putAndInsertString(DCM_PhotometricInterpretation, "MONOCHROME2").good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_SamplesPerPixel, 1).good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_Rows, 64).good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_Columns, 64).good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_BitsAllocated, 8).good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_BitsStored, 8).good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_HighBit, 7).good());
+        OFCHECK(dataset->putAndInsertUint16(DCM_PixelRepresentation, 0).good());
+        OFVector<Uint8> pixelData(64 * 64);
+        for (size_t i = 0; i < pixelData.size(); ++i)
+            pixelData[i] = OFstatic_cast(Uint8, i / 16);
+        OFCHECK(dataset->putAndInsertUint8Array(DCM_PixelData, &pixelData[0], OFstatic_cast(unsigned long, pixelData.size())).good());
+        OFCHECK(dataset->chooseRepresentation(EXS_RLELossless, NULL).good());
+        OFCondition result;
+        OFCHECK_MSG((result = fileformat.saveFile(temp.getFilename(), EXS_RLELossless)).good(), result.text());
+    }
+
+    TestSCPWithStoreSupport scp(ASC_NP_DEFAULT);
+    scp.m_keepPixelData = OFTrue;
+    scp.start();
+    OFStandard::forceSleep(1);
+
+    DcmStorageSCU scu;
+    scu.setAETitle("STORE_SCU");
+    scu.setPeerAETitle("STORE_SCP");
+    scu.setPeerHostName("localhost");
+    scu.setPeerPort(scp.getConfig().getPort());
+    scu.setTranscodingMode(OFTrue);
+    scu.setTranscodingCacheSize(1024 * 1024);
+    OFCondition result;
+    OFCHECK_MSG((result = scu.addDicomFile(temp.getFilename())).good(), result.text());
+    OFCHECK_MSG((result = scu.addPresentationContexts()).good(), result.text());
+    OFCHECK_MSG((result = scu.initNetwork()).good(), result.text());
+    OFCHECK_MSG((result = scu.negotiateAssociation()).good(), result.text());
+    OFCHECK_MSG((result = scu.sendSOPInstances()).good(), result.text());
+    OFCHECK_EQUAL(scu.getNumberOfSOPInstancesToBeSent(), 0);
+
+    // the file cannot be loaded again, so the second C-STORE request can only
+    // succeed if the transcoded dataset is taken from the cache
+    OFCHECK(OFStandard::deleteFile(temp.getFilename()));
+    scu.resetSentStatus(OFTrue /* sameAssociation */);
+    OFCHECK_EQUAL(scu.getNumberOfSOPInstancesToBeSent(), 1);
+    OFCHECK_MSG((result = scu.sendSOPInstances()).good(), result.text());
+    OFCHECK_EQUAL(scu.getNumberOfSOPInstancesToBeSent(), 0);
+    OFCHECK_MSG((result = scu.releaseAssociation()).good(), result.text());
+    OFCHECK(scp.join() != OFThread::busy);
+
+    OFCHECK_EQUAL(scp.m_numReceived, 2);
+    OFCHECK_EQUAL(scp.m_pixelData.size(), 2);
+    if (scp.m_pixelData.size() == 2)
+    {
+        OFCHECK_EQUAL(scp.m_pixelData[0].length(), 64 * 64);
+        OFCHECK(scp.m_pixelData[0] == scp.m_pixelData[1]);
+    }
+
+    DcmRLEEncoderRegistration::cleanup();
+    DcmRLEDecoderRegistration::cleanup();
+}
+
+
 #endif // WITH_THREADS
@@ -32,6 +32,10 @@
 #include "dcmtk/dcmnet/dcompat.h"
 #include "dcmtk/dcmqrdb/dcmqrdbs.h"
 #include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/dcmqrdb/dcmqrdbx.h"
+#include "dcmtk/dcmqrdb/dcmqrdbc.h"
+
+#include "dcmtk/ofstd/oflist.h"
 
 #ifdef WITH_ZLIB
 #include <zlib.h>        /* for zlibVersion() */
@@ -51,6 +55,17 @@ static char rcsid[] = "$dcmtk: " OFFIS_CONSOLE_APPLICATION " v"
 #define SHORTCOL 3
 #define LONGCOL  12
 
+/* check whether a file found in a directory belongs to the database index */
+static OFBool isIndexFile(const OFString& filename)
+{
+    OFString name;
+    OFStandard::getFilenameFromPath(name, filename);
+    if ((name.length() > 4) && (name.compare(name.length() - 4, 4, ".tmp") == 0))
+        name.erase(name.length() - 4);
+    return (name == DBINDEXFILE) || (name == DBSTRINGPOOLFILE) ||
+           (name == DBKEYINDEXFILE) || (name == DBSUMMARYFILE);
+}
+
 
 int main (int argc, char *argv[])
 {
@@ -64,6 +79,9 @@ int main (int argc, char *argv[])
     const char *opt_storageArea = NULL;
     OFBool opt_print = OFFalse;
     OFBool opt_isNewFlag = OFTrue;
+    OFBool opt_upgrade = OFFalse;
+    OFBool opt_rebuild = OFFalse;
+    OFCmdUnsignedInt opt_threads = 4;
 
 #ifdef WITH_TCPWRAPPER
     // this code makes sure that the linker cannot optimize away
@@ -78,7 +96,7 @@ int main (int argc, char *argv[])
     cmd.setParamColumn(LONGCOL + SHORTCOL + 2);
 
     cmd.addParam("index-out",  "storage area for the index file (directory)");
-    cmd.addParam("dcmfile-in", "DICOM image file to be registered in the index file", OFCmdParam::PM_MultiOptional);
+    cmd.addParam("dcmfile-in", "DICOM image file to be registered in the index file\n(or directory to be scanned with --rebuild)", OFCmdParam::PM_MultiOptional);
 
     cmd.addGroup("options:", LONGCOL, SHORTCOL);
      cmd.addOption("--help",    "-h", "print this help text and exit", OFCommandLine::AF_Exclusive);
@@ -86,6 +104,12 @@ int main (int argc, char *argv[])
      OFLog::addOptions(cmd);
      cmd.addOption("--print",   "-p", "list contents of database index file");
      cmd.addOption("--not-new", "-n", "set instance reviewed status to 'not new'");
+     cmd.addOption("--upgrade", "-u", "upgrade index file to current version, compact\nstring pool file and rebuild secondary and summary\nindex file");
+     cmd.addOption("--rebuild", "-r", "replace all records of the index file by the\ngiven files, parsed in parallel and written in\none pass");
+#ifdef WITH_THREADS
+     cmd.addOption("--threads", "-t", 1, "[n]umber of threads: integer (1..64, default: 4)",
+                                         "number of threads parsing files with --rebuild");
+#endif
 
     /* evaluate command line */
     prepareCmdLineArgs(argc, argv, OFFIS_CONSOLE_APPLICATION);
@@ -123,6 +147,20 @@ int main (int argc, char *argv[])
 
         if (cmd.findOption("--not-new"))
             opt_isNewFlag = OFFalse;
+
+        if (cmd.findOption("--upgrade"))
+            opt_upgrade = OFTrue;
+
+        if (cmd.findOption("--rebuild"))
+            opt_rebuild = OFTrue;
+
+#ifdef WITH_THREADS
+        if (cmd.findOption("--threads"))
+        {
+            app.checkDependence("--threads", "--rebuild", opt_rebuild);
+            app.checkValue(cmd.getValueAndCheckMinMax(opt_threads, 1, 64));
+        }
+#endif
     }
 
     /* print resource identifier */
@@ -136,11 +174,57 @@ int main (int argc, char *argv[])
     }
 
     OFCondition cond;
+    if (opt_upgrade)
+    {
+        OFLOG_INFO(dcmqridxLogger, "upgrading index file in: " << opt_storageArea);
+        cond = DcmQueryRetrieveIndexDatabaseHandle::upgradeIndexFile(opt_storageArea);
+        if (cond.bad())
+        {
+            OFLOG_ERROR(dcmqridxLogger, "cannot upgrade index file: " << cond.text());
+            return 1;
+        }
+    }
+
+    if (opt_rebuild)
+    {
+        /* directories are scanned recursively, skipping the index files */
+        OFList<OFString> files;
+        OFList<OFString> dirFiles;
+        int paramCount = cmd.getParamCount();
+        for (int param = 2; param <= paramCount; param++)
+        {
+            const char *opt_imageFile = NULL;
+            cmd.getParam(param, opt_imageFile);
+            if (OFStandard::dirExists(opt_imageFile))
+            {
+                dirFiles.clear();
+                OFStandard::searchDirectoryRecursively(opt_imageFile, dirFiles);
+                for (OFListIterator(OFString) it = dirFiles.begin(); it != dirFiles.end(); ++it)
+                {
+                    if (!isIndexFile(*it))
+                        files.push_back(*it);
+                }
+            }
+            else if (access(opt_imageFile, R_OK) < 0)
+                OFLOG_ERROR(dcmqridxLogger, "cannot access: " << opt_imageFile);
+            else
+                files.push_back(opt_imageFile);
+        }
+        OFLOG_INFO(dcmqridxLogger, "rebuilding index file in: " << opt_storageArea << " from " << files.size() << " files");
+        cond = DcmQueryRetrieveIndexDatabaseHandle::rebuildIndexFile(opt_storageArea, files, opt_isNewFlag, opt_threads);
+        if (cond.bad())
+        {
+            OFLOG_ERROR(dcmqridxLogger, "cannot rebuild index file: " << cond.text());
+            return 1;
+        }
+    }
+
     DcmQueryRetrieveIndexDatabaseHandle hdl(opt_storageArea, DB_UpperMaxStudies, DB_UpperMaxBytesPerStudy, cond);
     if (cond.good())
     {
         hdl.enableQuotaSystem(OFFalse); /* disable deletion of images */
-        int paramCount = cmd.getParamCount();
+        /* the files have already been registered by the rebuild */
+        int paramCount = opt_rebuild ? 1 : cmd.getParamCount();
         for (int param = 2; param <= paramCount; param++)
         {
             const char *opt_imageFile = NULL;
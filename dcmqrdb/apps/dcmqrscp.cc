@@ -47,6 +47,7 @@ END_EXTERN_C
 #include "dcmtk/dcmnet/dicom.h"
 #include "dcmtk/dcmnet/dimse.h"
 #include "dcmtk/dcmnet/dcasccff.h"
+#include "dcmtk/dcmnet/dmetrics.h"
 #include "dcmtk/dcmqrdb/dcmqropt.h"
 #include "dcmtk/dcmqrdb/dcmqrcnf.h"
 #include "dcmtk/dcmqrdb/dcmqrsrv.h"
@@ -122,7 +123,7 @@ main(int argc, char *argv[])
 
   char tempstr[20];
   OFString temp_str;
-#ifdef HAVE_FORK
+#if defined(HAVE_FORK) || defined(WITH_THREADS)
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "DICOM image archive (central test node)", rcsid);
 #else
   OFConsoleApplication app(OFFIS_CONSOLE_APPLICATION, "DICOM image archive (central test node)\nThis version of dcmqrscp supports only single process mode.", rcsid);
@@ -152,10 +153,15 @@ main(int argc, char *argv[])
         cmd.addOption("--config",               "-c",   1, opt5.c_str(),
                                                            "use specific configuration file");
     }
-#ifdef HAVE_FORK
+#if defined(HAVE_FORK) || defined(WITH_THREADS)
   cmd.addGroup("multi-process options:", LONGCOL, SHORTCOL + 2);
     cmd.addOption("--single-process",           "-s",      "single process mode");
+#ifdef HAVE_FORK
     cmd.addOption("--fork",                                "fork child process for each assoc. (default)");
+#endif
+#ifdef WITH_THREADS
+    cmd.addOption("--threads",                  "-th",     "handle associations in a pool of threads");
+#endif
 #endif
 
   cmd.addGroup("database options:");
@@ -268,6 +274,13 @@ main(int argc, char *argv[])
       cmd.addOption("--reject",                            "reject association if no implement. class UID");
       cmd.addOption("--ignore",                            "ignore store data, receive but do not store");
       cmd.addOption("--uid-padding",            "-up",     "silently correct space-padded UIDs");
+      cmd.addOption("--metrics-file",                   1, "[f]ilename: string",
+                                                           "collect network metrics and write them to file f\n(Prometheus text format, updated after each\nassociation, requires --single-process or\n--threads)");
+    cmd.addSubGroup("retrieve sub-operations:");
+      cmd.addOption("--max-sub-assoc",          "-msa", 1, "[n]umber of associations: integer (1..16)",
+                                                           "send C-MOVE sub-operations over up to n\nparallel sub-associations (default: 1)");
+      cmd.addOption("--prefetch",               "-pf",  1, "[n]umber of files: integer (0..64)",
+                                                           "load the files of the next n C-MOVE/C-GET\nsub-operations in advance (default: 0)");
 
 #ifdef DCMTK_ENABLE_CHARSET_CONVERSION
   cmd.addGroup("processing options:");
@@ -380,10 +393,27 @@ main(int argc, char *argv[])
       OFLog::configureFromCommandLine(cmd, app);
 
       if (cmd.findOption("--config")) app.checkValue(cmd.getValue(opt_configFileName));
-#ifdef HAVE_FORK
+#if defined(HAVE_FORK) || defined(WITH_THREADS)
       cmd.beginOptionBlock();
-      if (cmd.findOption("--single-process")) options.singleProcess_ = OFTrue;
-      if (cmd.findOption("--fork")) options.singleProcess_ = OFFalse;
+      if (cmd.findOption("--single-process"))
+      {
+        options.singleProcess_ = OFTrue;
+        options.threadedMode_ = OFFalse;
+      }
+#ifdef HAVE_FORK
+      if (cmd.findOption("--fork"))
+      {
+        options.singleProcess_ = OFFalse;
+        options.threadedMode_ = OFFalse;
+      }
+#endif
+#ifdef WITH_THREADS
+      if (cmd.findOption("--threads"))
+      {
+        options.singleProcess_ = OFFalse;
+        options.threadedMode_ = OFTrue;
+      }
+#endif
       cmd.endOptionBlock();
 #endif
 
@@ -514,6 +544,28 @@ main(int argc, char *argv[])
       if (cmd.findOption("--reject")) options.rejectWhenNoImplementationClassUID_ = OFTrue;
       if (cmd.findOption("--ignore")) options.ignoreStoreData_ = OFTrue;
       if (cmd.findOption("--uid-padding")) options.correctUIDPadding_ = OFTrue;
+      if (cmd.findOption("--metrics-file"))
+      {
+        const char *metricsFile = NULL;
+        app.checkValue(cmd.getValue(metricsFile));
+        /* forked child processes would overwrite each other's file with their own totals */
+        if (!options.singleProcess_ && !options.threadedMode_)
+          app.printError("--metrics-file requires --single-process or --threads");
+        DcmNetworkMetrics::setEnabled(OFTrue);
+        DcmNetworkMetrics::setOutputFile(metricsFile);
+      }
+      if (cmd.findOption("--max-sub-assoc"))
+      {
+        app.checkValue(cmd.getValueAndCheckMinMax(options.maxSubAssociations_, 1, 16));
+#ifndef WITH_THREADS
+        if (options.maxSubAssociations_ > 1)
+        {
+          OFLOG_WARN(dcmqrscpLogger, "parallel sub-associations require thread support, option --max-sub-assoc ignored");
+          options.maxSubAssociations_ = 1;
+        }
+#endif
+      }
+      if (cmd.findOption("--prefetch")) app.checkValue(cmd.getValueAndCheckMinMax(options.prefetchCount_, 0, 64));
 
       if (cmd.findOption("--assoc-config-file"))
       {
@@ -25,13 +25,17 @@
 #include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
 #include "dcmtk/dcmnet/dimse.h"
 #include "dcmtk/dcmqrdb/qrdefine.h"
+#include "dcmtk/dcmqrdb/dcmqrdbs.h"
 
 class DcmQueryRetrieveDatabaseHandle;
 class DcmQueryRetrieveOptions;
-class DcmQueryRetrieveDatabaseStatus;
+class DcmQueryRetrieveSubOperation;
+class DcmQueryRetrieveSubOperationQueue;
 
 /** this class maintains the context information that is passed to the
  *  callback function called by DIMSE_getProvider.
+ *  The files of the next C-STORE sub-operations can be loaded in advance
+ *  by background threads (see DcmQueryRetrieveOptions::prefetchCount_).
  */
 class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveGetContext
 {
@@ -69,10 +73,18 @@ public:
     , nFailed(0)
     , nWarning(0)
     , getCancelled(OFFalse)
+    , nRemainingInDB(0)
+    , nOutstanding(0)
+    , dbFinished(OFFalse)
+    , dbFinalStatus()
+    , subOps(NULL)
     {
       origHostName[0] = '\0';
     }
 
+    /// destructor
+    ~DcmQueryRetrieveGetContext();
+
     /** set the AEtitle under which this application operates
      *  @param ae AEtitle, is copied into this object.
      */
@@ -107,7 +119,8 @@ private:
     DcmQueryRetrieveGetContext& operator=(const DcmQueryRetrieveGetContext& other);
 
     void addFailedUIDInstance(const char *sopInstance);
-    OFCondition performGetSubOp(DIC_UI sopClass, DIC_UI sopInstance, char *fname);
+    OFCondition performGetSubOp(DcmQueryRetrieveSubOperation *subOp);
+    void fillSubOperationQueue();
     void getNextImage(DcmQueryRetrieveDatabaseStatus * dbStatus);
     void buildFailedInstanceList(DcmDataset ** rspIds);
 
@@ -163,6 +176,21 @@ private:
     /// true if the get sub-operations have been cancelled
     OFBool getCancelled;
 
+    /// number of remaining sub-operations not yet retrieved from the database
+    DIC_US nRemainingInDB;
+
+    /// number of sub-operations retrieved from the database but not yet performed
+    size_t nOutstanding;
+
+    /// true if the database has returned all instances to be sent
+    OFBool dbFinished;
+
+    /// final status of the database operation, valid if dbFinished is true
+    DcmQueryRetrieveDatabaseStatus dbFinalStatus;
+
+    /// queue of sub-operations retrieved from the database, NULL if not started
+    DcmQueryRetrieveSubOperationQueue *subOps;
+
 };
 
 #endif
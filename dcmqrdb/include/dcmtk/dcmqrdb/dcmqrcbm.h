@@ -26,14 +26,27 @@
 #include "dcmtk/dcmnet/dimse.h"
 #include "dcmtk/dcmnet/dcasccfg.h"
 #include "dcmtk/dcmqrdb/qrdefine.h"
+#include "dcmtk/dcmqrdb/dcmqrdbs.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofvector.h"
 
 class DcmQueryRetrieveDatabaseHandle;
 class DcmQueryRetrieveOptions;
 class DcmQueryRetrieveConfig;
-class DcmQueryRetrieveDatabaseStatus;
+class DcmQueryRetrieveSubOperation;
+class DcmQueryRetrieveSubOperationQueue;
+class DcmQueryRetrieveMoveSubAssociation;
 
 /** this class maintains the context information that is passed to the
  *  callback function called by DIMSE_moveProvider.
+ *  <p>
+ *  The C-STORE sub-operations are pipelined: the instances to be sent are
+ *  retrieved from the database ahead of time, their files can be loaded in
+ *  advance by background threads (see DcmQueryRetrieveOptions::prefetchCount_),
+ *  and they can be sent over several parallel sub-associations to the move
+ *  destination (see DcmQueryRetrieveOptions::maxSubAssociations_). A pending
+ *  C-MOVE response is still sent for each completed sub-operation.
+ *  </p>
  */
 class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveMoveContext
 {
@@ -75,12 +88,26 @@ public:
     , nCompleted(0)
     , nFailed(0)
     , nWarning(0)
+    , nRemainingInDB(0)
+    , nOutstanding(0)
+    , nUnprocessed(0)
+    , nCancelled(0)
+    , dbFinished(OFFalse)
+    , dbFinalStatus()
+    , subOps(NULL)
+    , subAssocThreads()
+#ifdef WITH_THREADS
+    , mutex()
+#endif
     {
       origAETitle[0] = '\0';
       origHostName[0] = '\0';
       dstAETitle[0] = '\0';
     }
 
+    /// destructor, stops all sub-operations and releases the sub-associations
+    ~DcmQueryRetrieveMoveContext();
+
     /** callback handler called by the DIMSE_storeProvider callback function.
      *  @param cancelled (in) flag indicating whether a C-CANCEL was received
      *  @param request original move request (in)
@@ -115,9 +142,17 @@ private:
     DcmQueryRetrieveMoveContext& operator=(const DcmQueryRetrieveMoveContext& other);
 
     void addFailedUIDInstance(const char *sopInstance);
-    OFCondition performMoveSubOp(DIC_UI sopClass, DIC_UI sopInstance, char *fname);
+    OFCondition performMoveSubOp(T_ASC_Association *assoc, DcmQueryRetrieveSubOperation *subOp);
     OFCondition buildSubAssociation(T_DIMSE_C_MoveRQ *request);
+    OFCondition requestSubAssociation(const char *dstPeerAddress, T_ASC_Association **assoc);
     OFCondition closeSubAssociation();
+    void releaseSubAssociation(T_ASC_Association **assoc);
+    void startSubOperations(const char *dstPeerAddress);
+    void fillSubOperationQueue();
+    void performSubOperations(T_ASC_Association *assoc);
+    void finishSubOperations(OFBool cancel);
+    void lockCounters();
+    void unlockCounters();
     void moveNextImage(DcmQueryRetrieveDatabaseStatus * dbStatus);
     void failAllSubOperations(DcmQueryRetrieveDatabaseStatus * dbStatus);
     void buildFailedInstanceList(DcmDataset ** rspIds);
@@ -183,6 +218,36 @@ private:
     /// number of completed sub-operations that causes warnings
     DIC_US nWarning;
 
+    /// number of remaining sub-operations not yet retrieved from the database
+    DIC_US nRemainingInDB;
+
+    /// number of sub-operations whose completion has not yet been awaited by callbackHandler()
+    size_t nOutstanding;
+
+    /// number of sub-operations that are queued or being performed
+    size_t nUnprocessed;
+
+    /// number of queued sub-operations that were dropped due to a C-CANCEL
+    DIC_US nCancelled;
+
+    /// true if the database has returned all instances to be moved
+    OFBool dbFinished;
+
+    /// final status of the database operation, valid if dbFinished is true
+    DcmQueryRetrieveDatabaseStatus dbFinalStatus;
+
+    /// queue of sub-operations retrieved from the database, NULL if not started
+    DcmQueryRetrieveSubOperationQueue *subOps;
+
+    /// threads performing sub-operations on parallel sub-associations
+    OFVector<DcmQueryRetrieveMoveSubAssociation *> subAssocThreads;
+
+#ifdef WITH_THREADS
+    /// mutex protecting the sub-operation counters and the list of failed instances
+    OFMutex mutex;
+#endif
+
+    friend class DcmQueryRetrieveMoveSubAssociation;
 };
 
 #endif
@@ -0,0 +1,385 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: classes DcmQueryRetrieveUIDTable, DcmQueryRetrieveSummaryIndex
+ *
+ */
+
+#ifndef DCMQRDBC_H
+#define DCMQRDBC_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/ofstd/ofstring.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmqrdb/qrdefine.h"
+
+struct IdxRecord;
+
+/* ENSURE THAT DBSUMMARYVERSION IS INCREMENTED WHENEVER ONE OF THE SUMMARY INDEX FILE STRUCTS IS MODIFIED */
+
+#define DBSUMMARYFILE       "index.sum"
+#define DBSUMMARYMAGIC      "QRSI"
+#define DBSUMMARYVERSION    1
+
+/// maximum length of a UID stored in the summary index file
+#define DB_SUMMARY_UID_LENGTH       64
+
+/// maximum length of the (list of) modalities stored in the summary index file
+#define DB_SUMMARY_MODALITY_LENGTH  64
+
+/// kind of an unused entry of the summary index file
+#define DB_SUMMARY_UNUSED   0
+
+/// kind of an entry describing a study
+#define DB_SUMMARY_STUDY    1
+
+/// kind of an entry describing a series
+#define DB_SUMMARY_SERIES   2
+
+/** this struct defines the header of the summary index file, which is
+ *  followed by "count" entries of type DB_SummaryRecord
+ */
+struct DCMTK_DCMQRDB_EXPORT DB_SummaryHeader
+{
+    /// magic word, see DBSUMMARYMAGIC
+    char magic[4] ;
+
+    /// version of the file format, see DBSUMMARYVERSION
+    Uint32 version ;
+
+    /// nonzero while the summary file (or the index.dat file) is being modified
+    Uint32 dirty ;
+
+    /// incremented whenever the file is modified, used to detect changes
+    Uint32 generation ;
+
+    /// number of entries (including unused ones) following the header
+    Uint32 count ;
+};
+
+/** this struct defines an entry of the summary index file, i.e.\ the
+ *  aggregated information on one study or one series of the database
+ */
+struct DCMTK_DCMQRDB_EXPORT DB_SummaryRecord
+{
+    /// kind of entry (DB_SUMMARY_UNUSED, DB_SUMMARY_STUDY or DB_SUMMARY_SERIES)
+    Uint32 kind ;
+
+    /** number of the record in the index.dat file that represents the study
+     *  or series (the instance stored last), -1 if unknown
+     */
+    Sint32 idx ;
+
+    /// number of series of the study (only used for studies)
+    Uint32 numberOfSeries ;
+
+    /// number of instances of the study or series
+    Uint32 numberOfInstances ;
+
+    /// Study Instance UID
+    char StudyInstanceUID [DB_SUMMARY_UID_LENGTH+1] ;
+
+    /// Series Instance UID (only used for series)
+    char SeriesInstanceUID [DB_SUMMARY_UID_LENGTH+1] ;
+
+    /// modality of a series, or the distinct modalities of a study separated by backslashes
+    char Modality [DB_SUMMARY_MODALITY_LENGTH+1] ;
+};
+
+
+/** This class implements a simple hash table that maps strings (usually UIDs
+ *  or combinations of UIDs) to numbers. It is used to look up the entries of
+ *  the summary index and to remember the matches already returned by a
+ *  C-FIND operation in constant time.
+ */
+class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveUIDTable
+{
+public:
+
+  /// default constructor, creates an empty table
+  DcmQueryRetrieveUIDTable();
+
+  /// remove all entries
+  void clear();
+
+  /** get the number of entries
+   *  @return number of entries
+   */
+  size_t size() const;
+
+  /** add an entry unless the table already contains the key
+   *  @param key key of the entry
+   *  @param value value of the entry
+   *  @return OFTrue if the entry was added, OFFalse if the key already exists
+   *    (in which case the existing value is not modified)
+   */
+  OFBool insert(const OFString& key, Sint32 value = 0);
+
+  /** look up a key
+   *  @param key key to be looked up
+   *  @param value returns the value of the entry if found
+   *  @return OFTrue if the key was found, OFFalse otherwise
+   */
+  OFBool find(const OFString& key, Sint32& value) const;
+
+  /** check whether the table contains a key
+   *  @param key key to be looked up
+   *  @return OFTrue if the key was found, OFFalse otherwise
+   */
+  OFBool contains(const OFString& key) const;
+
+  /** remove an entry
+   *  @param key key of the entry
+   *  @return OFTrue if the entry was removed, OFFalse if the key was not found
+   */
+  OFBool erase(const OFString& key);
+
+private:
+
+  /// entry of the table
+  struct Entry
+  {
+    /// key
+    OFString key;
+    /// value
+    Sint32 value;
+  };
+
+  /** compute the bucket of a key
+   *  @param key the key
+   *  @return bucket number
+   */
+  size_t bucket(const OFString& key) const;
+
+  /// double the number of buckets and redistribute the entries
+  void grow();
+
+  /// buckets, each containing the entries with the same hash value
+  OFVector<OFVector<Entry> > buckets_;
+
+  /// number of entries
+  size_t size_;
+};
+
+
+/** This class maintains the summary index file of a storage area, which
+ *  contains one entry for each study and each series of the database with
+ *  the number of related series and instances, the modalities and the
+ *  number of the record that represents the study or series, i.e.\ the
+ *  instance stored last. This allows for answering C-FIND requests at study
+ *  and series level by comparing one record per study or series instead of
+ *  all records of the index.dat file, and for returning the Number of Study
+ *  Related Series/Instances, the Number of Series Related Instances and the
+ *  Modalities in Study.
+ *  <p>
+ *  The complete summary is kept in memory and only read again if the file
+ *  has been modified in the meantime. Like the secondary index, the file is
+ *  only accessed while the index.dat file is locked, and it is marked as
+ *  dirty while the index.dat file is modified, so that an interrupted update
+ *  is detected and the summary is rebuilt by the next store operation. If
+ *  the record representing a study or series is removed, the summary cannot
+ *  be used for queries until a record of the same study or series is added
+ *  or the summary is rebuilt.
+ *  </p>
+ */
+class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveSummaryIndex
+{
+public:
+
+  /** constructor
+   *  @param storageArea name of storage area (directory of the summary file)
+   */
+  DcmQueryRetrieveSummaryIndex(const char *storageArea);
+
+  /// destructor, closes the summary file
+  ~DcmQueryRetrieveSummaryIndex();
+
+  /** open the summary file and read its entries unless they are already
+   *  up-to-date in memory. The caller must hold a lock on the index.dat file.
+   *  @param forUpdate open the file for modifications if true
+   *  @return OFTrue if the summary file exists, is consistent and can be used,
+   *    OFFalse otherwise
+   */
+  OFBool open(OFBool forUpdate);
+
+  /** close the summary file. The entries remain available in memory, i.e.\
+   *  the methods retrieving information still report the state of the file
+   *  at the time it was opened.
+   */
+  void close();
+
+  /** check whether the entries in memory are consistent, i.e.\ the summary
+   *  file was opened (or written) successfully
+   *  @return OFTrue if the summary is usable, OFFalse otherwise
+   */
+  OFBool isValid() const;
+
+  /** check whether an update started by beginUpdate() is in progress
+   *  @return OFTrue if the summary is being updated, OFFalse otherwise
+   */
+  OFBool isUpdating() const;
+
+  /** mark the (open) summary file as being modified. Must be called before
+   *  the index.dat file is modified. Calls may be nested, the file is only
+   *  written by the outermost call of endUpdate().
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition beginUpdate();
+
+  /** write the entries modified since beginUpdate() to the summary file and
+   *  clear the mark set by beginUpdate(), unless the update was cancelled.
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition endUpdate();
+
+  /** cancel the current update, i.e.\ the summary file remains marked as
+   *  being modified and is rebuilt by the next store operation
+   */
+  void cancelUpdate();
+
+  /** account for a record that has been added to the index.dat file
+   *  @param idx number of the record in the index.dat file
+   *  @param record the record
+   */
+  void addRecord(Sint32 idx, const IdxRecord& record);
+
+  /** account for a record that is removed from the index.dat file
+   *  @param idx number of the record in the index.dat file
+   *  @param record the record
+   */
+  void removeRecord(Sint32 idx, const IdxRecord& record);
+
+  /** check whether the records representing all studies and series are known
+   *  @return OFTrue if no study or series lacks its representative record
+   */
+  OFBool isComplete() const;
+
+  /** remove all entries, e.g.\ before the summary is rebuilt using
+   *  addRecord() and writeIndex()
+   */
+  void clear();
+
+  /** write a new summary file containing all entries in memory. The caller
+   *  must hold an exclusive lock on the index.dat file.
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition writeIndex();
+
+  /** determine the records representing all studies, or all series of the
+   *  given studies
+   *  @param seriesLevel get the series instead of the studies if true
+   *  @param studyUIDs restrict the series to these studies, all series if empty
+   *  @param records returns the numbers of the representative records in
+   *    ascending order
+   *  @return OFTrue if the summary is valid and complete, OFFalse otherwise
+   */
+  OFBool getRepresentatives(OFBool seriesLevel, const OFVector<OFString>& studyUIDs, OFVector<Sint32>& records) const;
+
+  /** get the entry of a study
+   *  @param studyUID Study Instance UID
+   *  @return pointer to the entry, NULL if not found
+   */
+  const DB_SummaryRecord *findStudy(const char *studyUID) const;
+
+  /** get the entry of a series
+   *  @param seriesUID Series Instance UID
+   *  @return pointer to the entry, NULL if not found
+   */
+  const DB_SummaryRecord *findSeries(const char *seriesUID) const;
+
+  /** get the name of the summary file
+   *  @return name of the summary file
+   */
+  const OFString& getFilename() const;
+
+private:
+
+  /// private undefined copy constructor
+  DcmQueryRetrieveSummaryIndex(const DcmQueryRetrieveSummaryIndex& other);
+
+  /// private undefined assignment operator
+  DcmQueryRetrieveSummaryIndex& operator=(const DcmQueryRetrieveSummaryIndex& other);
+
+  /** determine the entry of a study or series, create it if requested
+   *  @param kind DB_SUMMARY_STUDY or DB_SUMMARY_SERIES
+   *  @param studyUID Study Instance UID
+   *  @param seriesUID Series Instance UID (only used for series)
+   *  @param create create a new entry if none exists
+   *  @return number of the entry, -1 if not found
+   */
+  Sint32 lookup(Uint32 kind, const char *studyUID, const char *seriesUID, OFBool create);
+
+  /** mark an entry as unused
+   *  @param entry number of the entry
+   */
+  void release(Sint32 entry);
+
+  /** determine the distinct modalities of the series of a study again
+   *  @param study number of the entry of the study
+   */
+  void updateModalities(Sint32 study);
+
+  /** remember that an entry has to be written by endUpdate()
+   *  @param entry number of the entry
+   */
+  void touch(Sint32 entry);
+
+  /// rebuild the hash tables and the list of unused entries from the entries
+  void buildTables();
+
+  /** write the header to the (open) summary file
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition writeHeader();
+
+  /// name of the summary file
+  OFString filename_;
+
+  /// summary file
+  OFFile file_;
+
+  /// header of the summary file as last read or written
+  DB_SummaryHeader header_;
+
+  /// all entries of the summary file
+  OFVector<DB_SummaryRecord> entries_;
+
+  /// numbers of the study entries, indexed by Study Instance UID
+  DcmQueryRetrieveUIDTable studies_;
+
+  /// numbers of the series entries, indexed by Series Instance UID
+  DcmQueryRetrieveUIDTable series_;
+
+  /// numbers of unused entries
+  OFVector<Sint32> unused_;
+
+  /// numbers of the entries modified during the current update
+  OFVector<Sint32> modified_;
+
+  /// nesting depth of beginUpdate() calls
+  int updateDepth_;
+
+  /// true if the current update was cancelled
+  OFBool cancelled_;
+
+  /// true if the entries in memory are consistent
+  OFBool valid_;
+};
+
+#endif
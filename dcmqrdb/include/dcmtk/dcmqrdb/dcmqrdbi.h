@@ -28,21 +28,30 @@
 #include "dcmtk/dcmnet/dicom.h"
 #include "dcmtk/dcmnet/dimse.h"
 #include "dcmtk/ofstd/offname.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/oflist.h"
 
 struct StudyDescRecord;
 struct DB_Private_Handle;
 struct DB_SmallDcmElmt;
 struct IdxRecord;
 struct DB_ElementList;
+struct ImagesofStudyArray;
 class DcmQueryRetrieveConfig;
+class DcmQueryRetrieveSecondaryIndex;
+class DcmQueryRetrieveSummaryIndex;
 
 /* ENSURE THAT DBVERSION IS INCREMENTED WHENEVER ONE OF THE INDEX FILE STRUCTS IS MODIFIED */
 
 #define DBINDEXFILE  "index.dat"
 #define DBMAGIC      "QRDB"
-#define DBVERSION    5
+#define DBVERSION    7
 #define DBHEADERSIZE 6
 
+/* the string pool file has a header of the same size, containing its own magic word and DBVERSION */
+#define DBSTRINGPOOLFILE  "index.str"
+#define DBSTRINGPOOLMAGIC "QRDS"
+
 #if DBVERSION > 0xFF
 #error maximum database version reached, you have to invent a new mechanism
 #endif
@@ -275,6 +284,56 @@ public:
   */
   OFBool findSOPInstance(const char *storeArea, const OFString &sopClassUID,const OFString &sopInstanceUID);
 
+  /** rebuild the secondary index file (index.key) from the records of the
+   *  database index file, e.g.\ after it was removed or damaged.
+   *  @return EC_Normal upon normal completion, or some other OFCondition code upon failure.
+   */
+  OFCondition rebuildSecondaryIndex();
+
+  /** rebuild the summary index file (index.sum), which contains the number
+   *  of related series and instances of each study and series, from the
+   *  records of the database index file. The database must be locked
+   *  exclusively.
+   *  @return EC_Normal upon normal completion, or some other OFCondition code upon failure.
+   */
+  OFCondition rebuildSummaryIndex();
+
+  /** upgrade the database index file of the given storage area from a
+   *  previous version of the file format (5 or 6) to the current one and
+   *  rebuild the secondary and summary index files. The records are converted into the
+   *  compact format, keeping their record numbers, and all string values are
+   *  written to a new string pool file without duplicates. A database index
+   *  file that already has the current format is compacted the same way,
+   *  which removes the strings of deleted records from the string pool file.
+   *  Must not be called while other processes access the storage area.
+   *  @param storeArea name of storage area, must not be NULL
+   *  @return EC_Normal upon normal completion, or some other OFCondition code upon failure.
+   */
+  static OFCondition upgradeIndexFile(const char *storeArea);
+
+  /** write a new database index file for the given storage area that
+   *  registers the given DICOM files, replacing all existing records, and
+   *  rebuild the secondary and summary index files. The files are parsed in
+   *  parallel, sorted by study and series in memory and written in one
+   *  sequential pass. The result is the same as registering the files one
+   *  by one with storeRequest() and the quota system disabled, i.e. a later
+   *  file replaces an earlier one with the same SOP Instance UID and only
+   *  the most recent DB_UpperMaxStudies studies of at most
+   *  DB_UpperMaxBytesPerStudy bytes each are kept.
+   *  Must not be called while other processes access the storage area.
+   *  @param storeArea name of storage area, must not be NULL
+   *  @param files names of the DICOM files to be registered
+   *  @param isNew instance status of the new records, see storeRequest()
+   *  @param numThreads number of threads parsing the files, ignored if
+   *    DCMTK is compiled without thread support
+   *  @return EC_Normal upon normal completion, or some other OFCondition code upon failure.
+   */
+  static OFCondition rebuildIndexFile(
+    const char *storeArea,
+    const OFList<OFString>& files,
+    OFBool isNew = OFTrue,
+    size_t numThreads = 1);
+
   /** deletes the given file only if the quota mechanism is enabled.
    *  The image is not de-registered from the database by this routine.
    *  @param imgFile file name (path) to the file to be deleted.
@@ -299,6 +358,16 @@ public:
    */
   OFCondition DB_IdxGetNext(int *idx, IdxRecord *idxRec);
 
+  /** Get next Index record that is in use and may match the current query.
+   *  If the secondary index could be used for the current query, only the
+   *  candidate records determined by the index are returned, otherwise this
+   *  method behaves like DB_IdxGetNext().
+   *  @param idx pointer to index number, updated upon successful return
+   *  @param idxRec pointer to index record structure
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition DB_IdxGetNextCandidate(int *idx, IdxRecord *idxRec);
+
   /** seek to beginning of image records in index file
    *  @param idx initialized to -1
    *  @return EC_Normal upon success, an error code otherwise
@@ -325,6 +394,7 @@ public:
   OFCondition DB_StudyDescChange(StudyDescRecord *pStudyDesc);
 
   /** deactivate index record at given index by setting an empty filename
+   *  and update the summary index accordingly
    *  @param idx index
    *  @return EC_Normal upon success, an error code otherwise
    */
@@ -398,9 +468,86 @@ private:
       DB_LEVEL        infLevel,
       DB_LEVEL        lowestLevel);
 
+  /** determine the candidate records for the current find or move request
+   *  using the secondary index. Must be called after the database has been
+   *  locked and before the loop over DB_IdxGetNextCandidate().
+   *  @param infLevel highest legal query level of the information model
+   */
+  void selectCandidates(DB_LEVEL infLevel);
+
+  /** search the records of the given SOP instance or study using the
+   *  secondary index. Must be called while the database is locked.
+   *  @param tag DCM_SOPInstanceUID or DCM_StudyInstanceUID
+   *  @param uid SOP Instance UID or Study Instance UID to search for
+   *  @param candidates returns the numbers of the records that may belong to
+   *    the SOP instance or study
+   *  @return OFTrue if the secondary index could be used, OFFalse otherwise
+   */
+  OFBool findUIDCandidates(const DcmTagKey& tag, const char *uid, OFVector<Sint32>& candidates);
+
+  /** determine the records of all images of the given study. Only the
+   *  records listed for the study in the secondary index are read, all
+   *  records are only scanned if the secondary index cannot be used.
+   *  Must be called while the database is locked.
+   *  @param StudyUID Study Instance UID
+   *  @param images returns record number, date and size of each image
+   */
+  void findStudyImages(const char *StudyUID, OFVector<ImagesofStudyArray>& images);
+
+  /** search a record of the same series (or, if there is none, of the same
+   *  study) as the given record using the secondary index, so that the new
+   *  record can share the string values they have in common. Must be called
+   *  while the database is locked and the secondary index file is open.
+   *  @param idxRec record to be added to the database
+   *  @return number of a record that may have values in common, -1 if none
+   */
+  int findSimilarRecord(const IdxRecord *idxRec);
+
+  /** use the records representing the studies or series in the summary
+   *  index as candidates of a find request at study or series level, unless
+   *  the secondary index yields fewer candidates. Only used if the request
+   *  has no matching keys other than the UIDs, Patient ID and Modalities in
+   *  Study, since all records of a study or series are compared otherwise.
+   *  Must be called after selectCandidates().
+   */
+  void selectSummaryCandidates();
+
+  /** compare a key of the query level that is not stored in the index
+   *  records. Only the Modalities in Study can be used for matching, it is
+   *  compared with the modalities of all series of the study.
+   *  @param plist query key
+   *  @param idxRec index record
+   *  @return OFTrue if the key matches, OFFalse otherwise
+   */
+  OFBool matchAggregateKey(DB_ElementList *plist, const IdxRecord *idxRec);
+
+  /** determine the value of a key that is not stored in the index records
+   *  from the summary index, i.e.\ the number of related series and
+   *  instances or the modalities in study
+   *  @param tag attribute tag
+   *  @param idxRec index record
+   *  @param value returns the value, empty if not available
+   *  @return OFTrue if the key is provided by the summary index, OFFalse otherwise
+   */
+  OFBool getAggregateValue(const DcmTagKey& tag, const IdxRecord *idxRec, OFString& value);
+
+  /// open the summary index for an update of the index file
+  void beginSummaryUpdate();
+
+  /** finish the update of the summary index, rebuild it if it could not be
+   *  updated or lacks the record representing a study or series
+   */
+  void endSummaryUpdate();
+
   /// database handle
   DB_Private_Handle *handle_;
 
+  /// secondary index of the database
+  DcmQueryRetrieveSecondaryIndex *secondaryIndex_;
+
+  /// summary index of the studies and series of the database
+  DcmQueryRetrieveSummaryIndex *summaryIndex_;
+
   /// flag indicating whether or not the quota system is enabled
   OFBool quotaSystemEnabled;
 
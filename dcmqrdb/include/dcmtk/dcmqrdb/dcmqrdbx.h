@@ -0,0 +1,343 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmQueryRetrieveSecondaryIndex
+ *
+ */
+
+#ifndef DCMQRDBX_H
+#define DCMQRDBX_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/offile.h"
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofstring.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dctagkey.h"
+#include "dcmtk/dcmqrdb/qrdefine.h"
+
+struct IdxRecord;
+
+/* ENSURE THAT DBKEYINDEXVERSION IS INCREMENTED WHENEVER ONE OF THE KEY INDEX FILE STRUCTS IS MODIFIED */
+
+#define DBKEYINDEXFILE      "index.key"
+#define DBKEYINDEXMAGIC     "QRKX"
+#define DBKEYINDEXVERSION   1
+
+/// number of tables (i.e. indexed attributes) in the secondary index file
+#define DB_KEYINDEX_TABLES          8
+
+/// maximum number of bytes of a value that are stored in the secondary index
+#define DB_KEYINDEX_MAX_KEY_LENGTH  64
+
+/// number of delta entries after which the secondary index should be rebuilt
+#define DB_KEYINDEX_MAX_DELTAS      4096
+
+/** this struct describes one table of the secondary index file,
+ *  i.e.\ the sorted list of values of one indexed attribute
+ */
+struct DCMTK_DCMQRDB_EXPORT DB_KeyIndexTable
+{
+    /// group number of the indexed attribute
+    Uint16 group ;
+
+    /// element number of the indexed attribute
+    Uint16 element ;
+
+    /// number of entries in the sorted part of the table
+    Uint32 count ;
+};
+
+/** this struct defines the header of the secondary index file. The header is
+ *  followed by the sorted entries of all tables (in the order of the table
+ *  descriptions) and by the unsorted delta entries added since the file
+ *  was last rebuilt.
+ */
+struct DCMTK_DCMQRDB_EXPORT DB_KeyIndexHeader
+{
+    /// magic word, see DBKEYINDEXMAGIC
+    char magic[4] ;
+
+    /// version of the file format, see DBKEYINDEXVERSION
+    Uint32 version ;
+
+    /// nonzero while the index file (or the index.dat file) is being modified
+    Uint32 dirty ;
+
+    /// number of delta entries following the sorted tables
+    Uint32 deltaCount ;
+
+    /// table descriptions
+    DB_KeyIndexTable tables[DB_KEYINDEX_TABLES] ;
+};
+
+/** this struct defines an entry of the secondary index file, i.e.\ the
+ *  (possibly truncated) value of an indexed attribute and the number of the
+ *  record in the index.dat file it was taken from
+ */
+struct DCMTK_DCMQRDB_EXPORT DB_KeyIndexEntry
+{
+    /// number of the record in the index.dat file
+    Sint32 idx ;
+
+    /// table the entry belongs to (only used for delta entries)
+    Uint16 table ;
+
+    /// reserved, always zero
+    Uint16 reserved ;
+
+    /// value, padded with zero bytes and not necessarily zero terminated
+    char key[DB_KEYINDEX_MAX_KEY_LENGTH] ;
+};
+
+
+/** This class maintains the secondary index file of a storage area, which
+ *  contains sorted tables of the values of the attributes that are most
+ *  commonly used in C-FIND and C-MOVE requests (Patient ID, Patient's Name,
+ *  the Study, Series and SOP Instance UID, Study Date and Modality). Each
+ *  table entry refers to a record of the index.dat file, so that matching
+ *  records can be located by binary search instead of reading the complete
+ *  index.dat file.
+ *  <p>
+ *  New entries are appended to the end of the file. Once more than
+ *  DB_KEYINDEX_MAX_DELTAS entries have been collected, the index file is
+ *  rebuilt from the index.dat file. Entries of deleted records are not
+ *  removed before, i.e. the index only delivers candidates that still have
+ *  to be compared with the query. The index file
+ *  is only accessed while the index.dat file is locked, and it is marked as
+ *  dirty while the index.dat file is modified, so that an interrupted update
+ *  is detected and the index is rebuilt by the next store operation.
+ *  </p>
+ */
+class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveSecondaryIndex
+{
+public:
+
+  /// query key to be looked up in the secondary index
+  struct DCMTK_DCMQRDB_EXPORT QueryKey
+  {
+    /** constructor
+     *  @param t attribute tag
+     *  @param v attribute value (query)
+     */
+    QueryKey(const DcmTagKey& t, const OFString& v) : tag(t), value(v) {}
+
+    /// attribute tag
+    DcmTagKey tag;
+
+    /// attribute value, possibly containing wildcards, a date range or a list of UIDs
+    OFString value;
+  };
+
+  /** constructor
+   *  @param storageArea name of storage area (directory of the index file)
+   */
+  DcmQueryRetrieveSecondaryIndex(const char *storageArea);
+
+  /// destructor, closes the index file
+  ~DcmQueryRetrieveSecondaryIndex();
+
+  /** open the index file and read its header and the delta entries.
+   *  The caller must hold a lock on the index.dat file.
+   *  @param forUpdate open the file for modifications if true
+   *  @return OFTrue if the index file exists, is consistent and can be used,
+   *    OFFalse otherwise
+   */
+  OFBool open(OFBool forUpdate);
+
+  /// close the index file
+  void close();
+
+  /** check whether the index file is open and can be used
+   *  @return OFTrue if the index is usable, OFFalse otherwise
+   */
+  OFBool isValid() const;
+
+  /** check whether the values of the given attribute are indexed
+   *  @param tag attribute tag
+   *  @return OFTrue if the attribute is indexed, OFFalse otherwise
+   */
+  static OFBool isIndexedKey(const DcmTagKey& tag);
+
+  /** determine the records that may match all of the given query keys.
+   *  Only the most selective key that can be evaluated using the index is
+   *  actually used, i.e.\ the candidates still have to be compared with all
+   *  keys of the query.
+   *  @param keys list of query keys, keys that are not indexed are ignored
+   *  @param candidates returns the numbers of the candidate records in
+   *    ascending order and without duplicates
+   *  @return OFTrue if the index could be used, OFFalse if all records have
+   *    to be compared with the query
+   */
+  OFBool findCandidates(const OFList<QueryKey>& keys, OFVector<Sint32>& candidates);
+
+  /** mark the (open) index file as being modified. Must be called before the
+   *  index.dat file is modified; addRecord() clears the mark again.
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition beginUpdate();
+
+  /** add the values of a record that has been written to the index.dat file
+   *  to the (open) index file and finish the update started by beginUpdate().
+   *  @param idx number of the record in the index.dat file
+   *  @param record the record
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition addRecord(Sint32 idx, const IdxRecord& record);
+
+  /** check whether the (open) index file has collected so many delta entries
+   *  that it should be rebuilt using insertRecord() and writeIndex()
+   *  @return OFTrue if the index file should be rebuilt, OFFalse otherwise
+   */
+  OFBool isRebuildRecommended() const;
+
+  /** remove all entries collected by insertRecord()
+   */
+  void clear();
+
+  /** collect the values of a record in memory for writeIndex()
+   *  @param idx number of the record in the index.dat file
+   *  @param record the record
+   */
+  void insertRecord(Sint32 idx, const IdxRecord& record);
+
+  /** write a new index file containing all entries collected by
+   *  insertRecord(). The caller must hold an exclusive lock on the index.dat
+   *  file. The index file must not be open.
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition writeIndex();
+
+  /** get the name of the index file
+   *  @return name of the index file
+   */
+  const OFString& getFilename() const;
+
+private:
+
+  /// private undefined copy constructor
+  DcmQueryRetrieveSecondaryIndex(const DcmQueryRetrieveSecondaryIndex& other);
+
+  /// private undefined assignment operator
+  DcmQueryRetrieveSecondaryIndex& operator=(const DcmQueryRetrieveSecondaryIndex& other);
+
+  /// range of keys in a table, compared on the first "length" bytes
+  struct KeyRange
+  {
+    /// lowest key in the range
+    char lower[DB_KEYINDEX_MAX_KEY_LENGTH];
+    /// highest key in the range
+    char upper[DB_KEYINDEX_MAX_KEY_LENGTH];
+    /// number of bytes to be compared
+    size_t length;
+  };
+
+  /// query key converted into ranges of a table
+  struct TableLookup
+  {
+    /// table number
+    int table;
+    /// key ranges
+    OFVector<KeyRange> ranges;
+    /// first matching entry in the sorted table, per range
+    OFVector<Uint32> first;
+    /// entry behind the last matching entry in the sorted table, per range
+    OFVector<Uint32> last;
+    /// include records with code extensions (ISO 2022) in the result
+    OFBool codeExtensions;
+    /// number of candidates
+    size_t count;
+  };
+
+  /** determine the table of an attribute
+   *  @param tag attribute tag
+   *  @return table number, -1 if the attribute is not indexed
+   */
+  static int findTable(const DcmTagKey& tag);
+
+  /** create the key of a value stored in the given table
+   *  @param table table number
+   *  @param value attribute value
+   *  @param key returns the key, padded with zero bytes
+   *  @return OFTrue if a key was created, OFFalse if the value is not indexed
+   */
+  static OFBool makeKey(int table, const char *value, char *key);
+
+  /** convert a query key into key ranges
+   *  @param key query key
+   *  @param lookup returns the table and the ranges
+   *  @return OFTrue if the key can be looked up, OFFalse otherwise
+   */
+  static OFBool makeLookup(const QueryKey& key, TableLookup& lookup);
+
+  /** add the values of a record to a list of entries
+   *  @param idx number of the record in the index.dat file
+   *  @param record the record
+   *  @param entries list the entries are appended to
+   */
+  static void makeEntries(Sint32 idx, const IdxRecord& record, OFVector<DB_KeyIndexEntry>& entries);
+
+  /** determine the range of entries of the sorted table that match a key range
+   *  @param table table number
+   *  @param range key range
+   *  @param first returns the first matching entry
+   *  @param last returns the entry behind the last matching entry
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition findRange(int table, const KeyRange& range, Uint32& first, Uint32& last);
+
+  /** read entries of the sorted part of a table
+   *  @param table table number
+   *  @param first number of the first entry within the table
+   *  @param count number of entries to be read
+   *  @param entries list the entries are appended to
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition readEntries(int table, Uint32 first, Uint32 count, OFVector<DB_KeyIndexEntry>& entries);
+
+  /** write an index file consisting of the given sorted tables
+   *  @param tables sorted entries of all tables
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition writeFile(OFVector<DB_KeyIndexEntry> *tables);
+
+  /** write the header to the (open) index file
+   *  @return EC_Normal upon success, an error code otherwise
+   */
+  OFCondition writeHeader();
+
+  /// name of the index file
+  OFString filename_;
+
+  /// index file
+  OFFile file_;
+
+  /// header of the open index file
+  DB_KeyIndexHeader header_;
+
+  /// delta entries of the open index file
+  OFVector<DB_KeyIndexEntry> deltas_;
+
+  /// true if the open index file is consistent
+  OFBool valid_;
+
+  /// entries collected by insertRecord(), one list per table
+  OFVector<DB_KeyIndexEntry> pending_[DB_KEYINDEX_TABLES];
+};
+
+#endif
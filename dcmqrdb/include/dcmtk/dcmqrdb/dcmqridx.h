@@ -31,6 +31,7 @@
 #include "dcmtk/dcmdata/dcdeftag.h"
 #include "dcmtk/dcmdata/dcspchrs.h"
 #include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/dcmqrdb/dcmqrdbc.h"
 
 BEGIN_EXTERN_C
 #ifdef HAVE_IO_H
@@ -113,6 +114,7 @@ enum DB_QUERY_CLASS
 #define MAX_NUMBER_OF_IMAGES    10000
 #define SIZEOF_IDXRECORD        (sizeof (IdxRecord))
 #define SIZEOF_STUDYDESC        (sizeof (StudyDescRecord) * MAX_MAX_STUDIES)
+#define SIZEOF_COMPACTRECORD    (sizeof (DB_CompactRecord))
 
 /* ENSURE THAT DBVERSION IS INCREMENTED WHENEVER ONE OF THESE STRUCTS IS MODIFIED */
 
@@ -204,17 +206,6 @@ private:
 
 /* ENSURE THAT DBVERSION IS INCREMENTED WHENEVER ONE OF THESE STRUCTS IS MODIFIED */
 
-struct DCMTK_DCMQRDB_EXPORT DB_UidList
-{
-    char *patient ;
-    char *study ;
-    char *serie ;
-    char *image ;
-    struct DB_UidList *next ;
-};
-
-/* ENSURE THAT DBVERSION IS INCREMENTED WHENEVER ONE OF THESE STRUCTS IS MODIFIED */
-
 struct DCMTK_DCMQRDB_EXPORT DB_CounterList
 {
     int idxCounter ;
@@ -252,7 +243,18 @@ struct DCMTK_DCMQRDB_EXPORT DB_Private_Handle
     DB_CounterList *moveCounterList ;
     int NumberRemainOperations ;
     DB_QUERY_CLASS rootLevel ;
-    DB_UidList *uidList ;
+    DcmQueryRetrieveUIDTable uidTable ;
+    OFVector<Sint32> candidateList ;
+    size_t candidateCounter ;
+    OFBool useCandidateList ;
+    char *mappedIndex ;
+    size_t mappedSize ;
+    OFBool mappingEnabled ;
+    int pstr ;
+    char *poolData ;
+    size_t poolSize ;
+    OFBool poolMapped ;
+    int lockMode ;
 
     DB_Private_Handle()
     : pidx(0)
@@ -269,7 +271,18 @@ struct DCMTK_DCMQRDB_EXPORT DB_Private_Handle
     , moveCounterList(NULL)
     , NumberRemainOperations(0)
     , rootLevel(STUDY_ROOT)
-    , uidList(NULL)
+    , uidTable()
+    , candidateList()
+    , candidateCounter(0)
+    , useCandidateList(OFFalse)
+    , mappedIndex(NULL)
+    , mappedSize(0)
+    , mappingEnabled(OFFalse)
+    , pstr(-1)
+    , poolData(NULL)
+    , poolSize(0)
+    , poolMapped(OFFalse)
+    , lockMode(0)
     {
     }
 };
@@ -359,8 +372,8 @@ struct DCMTK_DCMQRDB_EXPORT ImagesofStudyArray
 /* ENSURE THAT DBVERSION IS INCREMENTED WHENEVER ONE OF THESE STRUCTS IS MODIFIED */
 
 /** this class manages an instance entry of the index file.
- *  Each instance/image record within the index.dat file is
- *  a direct (binary) copy of this structure.
+ *  Within the index.dat file, each instance/image record is stored
+ *  as a DB_CompactRecord, see there.
  */
 struct DCMTK_DCMQRDB_EXPORT IdxRecord
 {
@@ -431,5 +444,37 @@ private:
     /* undefined */ IdxRecord& operator=(const IdxRecord& copy);
 };
 
+/// number of string values of an IdxRecord: filename, SOPClassUID, InstanceDescription and all parameters
+#define DB_COMPACT_STRINGS                      (NBPARAMETERS + 3)
+
+/* ENSURE THAT DBVERSION IS INCREMENTED WHENEVER ONE OF THESE STRUCTS IS MODIFIED */
+
+/** this struct defines the structure of each instance/image record in the
+ *  index.dat file. A record is a direct binary copy of this struct, which
+ *  contains the numeric values of an IdxRecord and refers to its string
+ *  values by their offset in the string pool file (index.str). A string pool
+ *  file consists of a header and a sequence of zero terminated strings, and
+ *  it is only appended to, i.e.\ a string is never modified once it has been
+ *  written. Records of the same series usually share the strings of the
+ *  values they have in common. A record is unused if its filename is empty.
+ */
+struct DCMTK_DCMQRDB_EXPORT DB_CompactRecord
+{
+    /// time the instance was recorded, see IdxRecord::RecordedDate
+    double  RecordedDate ;
+
+    /// size of the instance file, see IdxRecord::ImageSize
+    Uint32  ImageSize ;
+
+    /// status of the instance, see IdxRecord::hstat
+    Uint32  hstat ;
+
+    /** offsets of the filename, SOPClassUID, InstanceDescription and the
+     *  parameter values (in this order) in the string pool file.
+     *  0 denotes an empty string.
+     */
+    Uint32  strings [DB_COMPACT_STRINGS] ;
+};
+
 
 #endif
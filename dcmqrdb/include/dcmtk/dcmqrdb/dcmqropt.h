@@ -87,6 +87,9 @@ public:
   /// maximum PDU size
   OFCmdUnsignedInt  maxPDU_;
 
+  /// maximum number of parallel sub-associations for the C-STORE sub-operations of a C-MOVE
+  OFCmdUnsignedInt  maxSubAssociations_;
+
   /// pointer to network structure used for requesting C-STORE sub-associations
   T_ASC_Network *   net_;
 
@@ -101,6 +104,9 @@ public:
   /// padding algorithm for writing DICOM files
   E_PaddingEncoding paddingType_;
 
+  /// number of files loaded in advance for the C-STORE sub-operations of a C-MOVE or C-GET
+  OFCmdUnsignedInt  prefetchCount_;
+
   /* refuse storage presentation contexts in incoming associations
    * if a storage presentation context for the application entity already exists
    */
@@ -130,6 +136,9 @@ public:
   /// single process mode
   OFBool            singleProcess_;
 
+  /// threaded mode, i.e. handle associations in a pool of threads instead of child processes
+  OFBool            threadedMode_;
+
   /// support for patient root q/r model
   OFBool            supportPatientRoot_;
 
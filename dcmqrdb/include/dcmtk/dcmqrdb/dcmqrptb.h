@@ -79,13 +79,15 @@ public:
    */
   OFBool haveProcessWithWriteAccess(const char *calledAETitle) const;
 
-private:
-
-  /** remove the process with the given process ID from the table
+  /** remove the process with the given process ID from the table. Used
+   *  for associations handled by a thread, which are entered into the
+   *  table with a negative number instead of a process ID.
    *  @param pid process ID
    */
   void removeProcessFromTable(int pid);
 
+private:
+
   /// the list of process entries maintained by this object.
   OFList<DcmQueryRetrieveProcessSlot *> table_;
 };
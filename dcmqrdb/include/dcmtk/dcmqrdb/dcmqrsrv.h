@@ -33,6 +33,7 @@ class DcmQueryRetrieveConfig;
 class DcmQueryRetrieveOptions;
 class DcmQueryRetrieveDatabaseHandle;
 class DcmQueryRetrieveDatabaseHandleFactory;
+class DcmQueryRetrieveAssociationPool;
 class DcmTLSOptions;
 
 /// enumeration describing reasons for refusing an association request
@@ -71,12 +72,13 @@ public:
     const DcmAssociationConfiguration& associationConfiguration,
     DcmTLSOptions& tlsOptions);
 
-  /// destructor
-  virtual ~DcmQueryRetrieveSCP() { }
+  /// destructor, waits until all associations handled by threads are finished
+  virtual ~DcmQueryRetrieveSCP();
 
   /** wait for incoming A-ASSOCIATE requests, perform association negotiation
-   *  and serve the requests. May fork child processes depending on availability
-   *  of the fork() system function and configuration options.
+   *  and serve the requests. May fork child processes or hand the association
+   *  over to a thread depending on availability of the fork() system function,
+   *  thread support and configuration options.
    *  @param theNet network structure for listen socket
    *  @return EC_Normal if successful, an error code otherwise
    */
@@ -90,12 +92,16 @@ public:
     OFBool dbCheckFindIdentifier,
     OFBool dbCheckMoveIdentifier);
 
-  /** clean up terminated child processes.
+  /** clean up terminated child processes and finished association threads.
    */
   void cleanChildren();
 
 private:
 
+  /// the thread pool and its handlers access the process table and call handleAssociation()
+  friend class DcmQueryRetrieveAssociationPool;
+  friend class DcmQueryRetrieveAssociationHandler;
+
   /// private undefined copy constructor
   DcmQueryRetrieveSCP(const DcmQueryRetrieveSCP& other);
 
@@ -112,9 +118,18 @@ private:
 
   OFCondition refuseAssociation(T_ASC_Association ** pAssoc, CTN_RefuseReason reason);
 
+  /** serve the requests of an acknowledged association until it is released
+   *  or aborted, then drop and destroy the association.
+   *  @param assoc association, set to NULL when destroyed
+   *  @param correctUIDPadding correct invalid UID padding in received datasets if true
+   *  @param dbHandle database handle to be used for all requests, a new handle
+   *    is created by the factory if NULL
+   *  @return EC_Normal if successful, an error code otherwise
+   */
   OFCondition handleAssociation(
     T_ASC_Association ** assoc,
-    OFBool correctUIDPadding);
+    OFBool correctUIDPadding,
+    DcmQueryRetrieveDatabaseHandle *dbHandle = NULL);
 
   OFCondition echoSCP(
     T_ASC_Association * assoc,
@@ -148,7 +163,8 @@ private:
 
   OFCondition dispatch(
     T_ASC_Association *assoc,
-    OFBool correctUIDPadding);
+    OFBool correctUIDPadding,
+    DcmQueryRetrieveDatabaseHandle *dbHandle = NULL);
 
   static void refuseAnyStorageContexts(T_ASC_Association *assoc);
 
@@ -175,6 +191,9 @@ private:
 
   /// reference to object managing the TLS options
   DcmTLSOptions& tlsOptions_;
+
+  /// thread pool serving the associations in threaded mode, NULL until needed
+  DcmQueryRetrieveAssociationPool *threadPool_;
 };
 
 #endif
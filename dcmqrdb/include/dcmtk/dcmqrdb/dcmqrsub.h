@@ -0,0 +1,243 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: classes DcmQueryRetrieveSubOperation, DcmQueryRetrieveSubOperationQueue
+ *
+ */
+
+#ifndef DCMQRSUB_H
+#define DCMQRSUB_H
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofstring.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmnet/dicom.h"
+#include "dcmtk/dcmqrdb/qrdefine.h"
+
+class DcmQueryRetrieveSubOperationLoader;
+
+/** This class describes a C-STORE sub-operation of a C-MOVE or C-GET
+ *  operation, i.e.\ a SOP instance that is to be sent. The file containing
+ *  the SOP instance can be loaded in advance by one of the loader threads of
+ *  the DcmQueryRetrieveSubOperationQueue, so that reading (and parsing) the
+ *  next files overlaps with the network transfer of the current one.
+ */
+class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveSubOperation
+{
+public:
+
+  /** constructor
+   *  @param sopClass SOP Class UID of the instance
+   *  @param sopInstance SOP Instance UID of the instance
+   *  @param filename name of the file containing the instance
+   */
+  DcmQueryRetrieveSubOperation(const char *sopClass, const char *sopInstance, const char *filename);
+
+  /// destructor, waits until a loader thread (if any) has finished loading the file
+  ~DcmQueryRetrieveSubOperation();
+
+  /** wait until the file has been loaded by a loader thread. If no loader
+   *  thread has started loading the file yet, it is loaded in the calling
+   *  thread.
+   *  @return EC_Normal if the file has been loaded, an error code otherwise
+   */
+  OFCondition wait();
+
+  /** get the dataset loaded in advance. Must only be called after wait().
+   *  @return pointer to the dataset, NULL if the file has not been loaded
+   */
+  DcmDataset *getDataset();
+
+  /** check whether the file is loaded in advance, i.e.\ whether wait() and
+   *  getDataset() are to be used
+   *  @return OFTrue if the file is loaded in advance, OFFalse otherwise
+   */
+  OFBool isPrefetched() const;
+
+  /// SOP Class UID of the instance
+  DIC_UI sopClass;
+
+  /// SOP Instance UID of the instance
+  DIC_UI sopInstance;
+
+  /// name of the file containing the instance
+  char filename[MAXPATHLEN + 1];
+
+private:
+
+  friend class DcmQueryRetrieveSubOperationQueue;
+  friend class DcmQueryRetrieveSubOperationLoader;
+
+  /// private undefined copy constructor
+  DcmQueryRetrieveSubOperation(const DcmQueryRetrieveSubOperation& other);
+
+  /// private undefined assignment operator
+  DcmQueryRetrieveSubOperation& operator=(const DcmQueryRetrieveSubOperation& other);
+
+  /// load the file in the calling thread unless it has already been loaded
+  void load();
+
+  /// file format object the instance is loaded into
+  DcmFileFormat fileFormat_;
+
+  /// status of the load operation
+  OFCondition status_;
+
+  /// true if the file is loaded in advance
+  OFBool prefetched_;
+
+  /// true if load() has been called
+  OFBool loaded_;
+
+#ifdef WITH_THREADS
+  /// mutex held while the file is being loaded, protects fileFormat_, status_ and loaded_
+  OFMutex loadMutex_;
+#endif
+};
+
+
+/** This class implements the queue of C-STORE sub-operations of a C-MOVE or
+ *  C-GET operation that have been retrieved from the database but not yet
+ *  performed. Sub-operations are added by the thread that processes the
+ *  C-MOVE or C-GET request and removed either by the same thread or by
+ *  threads that perform the sub-operations on parallel sub-associations.
+ *  If prefetching is enabled, the files of the queued sub-operations are
+ *  loaded in advance by a bounded set of loader threads, which are started
+ *  on demand and reused for the following sub-operations.
+ */
+class DCMTK_DCMQRDB_EXPORT DcmQueryRetrieveSubOperationQueue
+{
+public:
+
+  /** constructor
+   *  @param capacity maximum number of sub-operations that are queued or
+   *    being performed at the same time
+   *  @param prefetchCount maximum number of loader threads, i.e.\ files
+   *    loaded at the same time. Prefetching is disabled if 0.
+   */
+  DcmQueryRetrieveSubOperationQueue(size_t capacity, size_t prefetchCount);
+
+  /** destructor, stops the loader threads and deletes all sub-operations
+   *  still in the queue
+   */
+  ~DcmQueryRetrieveSubOperationQueue();
+
+  /** add a sub-operation to the end of the queue and hand its file over to
+   *  the loader threads if prefetching is enabled. The caller must make sure
+   *  that the capacity of the queue is not exceeded.
+   *  @param subOp sub-operation, the queue takes ownership
+   */
+  void push(DcmQueryRetrieveSubOperation *subOp);
+
+  /** remove the first sub-operation from the queue. Blocks until a
+   *  sub-operation is available or the queue is closed.
+   *  @return sub-operation (the caller takes ownership), NULL if the queue
+   *    is closed and empty
+   */
+  DcmQueryRetrieveSubOperation *pop();
+
+  /** close the queue, i.e.\ pop() returns NULL once all sub-operations
+   *  have been removed
+   */
+  void close();
+
+  /** mark the remaining sub-operations as cancelled, i.e.\ they are still
+   *  removed from the queue and reported as processed, but not performed
+   */
+  void cancel();
+
+  /** check whether cancel() has been called
+   *  @return OFTrue if the sub-operations are cancelled, OFFalse otherwise
+   */
+  OFBool isCancelled();
+
+  /// report that a sub-operation removed from the queue has been processed
+  void processed();
+
+  /// wait until a sub-operation has been reported as processed
+  void waitProcessed();
+
+  /** get the number of sub-operations in the queue
+   *  @return number of sub-operations
+   */
+  size_t size();
+
+private:
+
+  friend class DcmQueryRetrieveSubOperationLoader;
+
+#ifdef WITH_THREADS
+  /** wait for the next sub-operation whose file is to be loaded, called by
+   *  the loader threads. The file of the sub-operation is locked for the
+   *  calling thread.
+   *  @return sub-operation, NULL if the queue is being destroyed
+   */
+  DcmQueryRetrieveSubOperation *nextLoad();
+
+  /// report that a loader thread has finished loading a file
+  void loadFinished();
+#endif
+
+  /// private undefined copy constructor
+  DcmQueryRetrieveSubOperationQueue(const DcmQueryRetrieveSubOperationQueue& other);
+
+  /// private undefined assignment operator
+  DcmQueryRetrieveSubOperationQueue& operator=(const DcmQueryRetrieveSubOperationQueue& other);
+
+  /// sub-operations in the queue
+  OFList<DcmQueryRetrieveSubOperation *> queue_;
+
+  /// maximum number of loader threads, 0 if prefetching is disabled
+  size_t prefetchCount_;
+
+  /// true if the queue has been closed
+  OFBool closed_;
+
+  /// true if the remaining sub-operations are cancelled
+  OFBool cancelled_;
+
+#ifdef WITH_THREADS
+  /// sub-operations in the queue whose files have not been claimed by a loader thread yet
+  OFList<DcmQueryRetrieveSubOperation *> loadQueue_;
+
+  /// loader threads started so far
+  OFList<DcmQueryRetrieveSubOperationLoader *> loaders_;
+
+  /// number of loader threads waiting for a file to load
+  size_t idleLoaders_;
+
+  /// true if the loader threads are to terminate
+  OFBool shutdown_;
+
+  /// mutex protecting the members of this object
+  OFMutex mutex_;
+
+  /// semaphore counting the entries of loadQueue_ and the shutdown requests
+  OFSemaphore loadAvailable_;
+
+  /// semaphore counting the sub-operations available in the queue
+  OFSemaphore available_;
+
+  /// semaphore counting the sub-operations that have been processed
+  OFSemaphore processed_;
+#endif
+};
+
+#endif
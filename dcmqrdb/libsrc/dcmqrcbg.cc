@@ -30,6 +30,7 @@
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmqrdb/dcmqrdbs.h"
 #include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/dcmqrdb/dcmqrsub.h"
 #include "dcmtk/ofstd/ofstd.h"
 
 BEGIN_EXTERN_C
@@ -64,6 +65,12 @@ static void getSubOpProgressCallback(void * /* callbackData */,
   }
 }
 
+DcmQueryRetrieveGetContext::~DcmQueryRetrieveGetContext()
+{
+    delete subOps;
+    free(failedUIDs);
+}
+
 void DcmQueryRetrieveGetContext::callbackHandler(
     /* in */
     OFBool cancelled, T_DIMSE_C_GetRQ *request,
@@ -86,6 +93,10 @@ void DcmQueryRetrieveGetContext::callbackHandler(
                 << DU_cmoveStatusString(dbStatus.status()) << "): "
                 << DimseCondition::dump(temp_str, dbcond));
         }
+        if (dbStatus.status() == STATUS_Pending) {
+            /* the sub-operation being performed plus the ones to be prefetched */
+            subOps = new DcmQueryRetrieveSubOperationQueue(1 + options_.prefetchCount_, options_.prefetchCount_);
+        }
     }
 
     /* only cancel if we have pending status */
@@ -99,6 +110,10 @@ void DcmQueryRetrieveGetContext::callbackHandler(
 
     if (dbStatus.status() != STATUS_Pending) {
 
+        /* the queued sub-operations (if any) will not be performed */
+        delete subOps;
+        subOps = NULL;
+
         /*
          * Need to adjust the final status if any sub-operations failed or
          * had warnings
@@ -129,6 +144,7 @@ void DcmQueryRetrieveGetContext::callbackHandler(
     }
 
     /* set response status */
+    nRemaining = OFstatic_cast(DIC_US, nRemainingInDB + nOutstanding);
     response->DimseStatus = dbStatus.status();
     response->NumberOfRemainingSubOperations = nRemaining;
     response->NumberOfCompletedSubOperations = nCompleted;
@@ -161,7 +177,7 @@ void DcmQueryRetrieveGetContext::addFailedUIDInstance(const char *sopInstance)
     }
 }
 
-OFCondition DcmQueryRetrieveGetContext::performGetSubOp(DIC_UI sopClass, DIC_UI sopInstance, char *fname)
+OFCondition DcmQueryRetrieveGetContext::performGetSubOp(DcmQueryRetrieveSubOperation *subOp)
 {
     OFCondition cond = EC_Normal;
     T_DIMSE_C_StoreRQ req;
@@ -169,26 +185,10 @@ OFCondition DcmQueryRetrieveGetContext::performGetSubOp(DIC_UI sopClass, DIC_UI
     DIC_US msgId;
     T_ASC_PresentationContextID presId;
     DcmDataset *stDetail = NULL;
-
-#ifdef LOCK_IMAGE_FILES
-    /* shared lock image file */
-    int lockfd;
-#ifdef O_BINARY
-    lockfd = open(fname, O_RDONLY | O_BINARY, 0666);
-#else
-    lockfd = open(fname, O_RDONLY , 0666);
-#endif
-    if (lockfd < 0) {
-        /* due to quota system the file could have been deleted */
-        DCMQRDB_ERROR("Get SCP: storeSCU: [file: " << fname << "]: " << OFStandard::getLastSystemErrorCode().message());
-        nFailed++;
-        addFailedUIDInstance(sopInstance);
-        return EC_Normal;
-    }
-    dcmtk_flock(lockfd, LOCK_SH);
-#endif
-
-    msgId = origAssoc->nextMsgID++;
+    DcmDataset *dataset = NULL;
+    const char *fname = subOp->filename;
+    const char *sopClass = subOp->sopClass;
+    const char *sopInstance = subOp->sopInstance;
 
     /* which presentation context should be used */
     presId = ASC_findAcceptedPresentationContextID(origAssoc,
@@ -214,6 +214,40 @@ OFCondition DcmQueryRetrieveGetContext::performGetSubOp(DIC_UI sopClass, DIC_UI
         }
     }
 
+    if (subOp->isPrefetched()) {
+        /* the file has been loaded (and locked while being read) in advance */
+        cond = subOp->wait();
+        if (cond.bad()) {
+            DCMQRDB_ERROR("Get SCP: storeSCU: [file: " << fname << "]: " << cond.text());
+            nFailed++;
+            addFailedUIDInstance(sopInstance);
+            return EC_Normal;
+        }
+        dataset = subOp->getDataset();
+    }
+
+#ifdef LOCK_IMAGE_FILES
+    /* shared lock image file */
+    int lockfd = -1;
+    if (dataset == NULL) {
+#ifdef O_BINARY
+        lockfd = open(fname, O_RDONLY | O_BINARY, 0666);
+#else
+        lockfd = open(fname, O_RDONLY , 0666);
+#endif
+        if (lockfd < 0) {
+            /* due to quota system the file could have been deleted */
+            DCMQRDB_ERROR("Get SCP: storeSCU: [file: " << fname << "]: " << OFStandard::getLastSystemErrorCode().message());
+            nFailed++;
+            addFailedUIDInstance(sopInstance);
+            return EC_Normal;
+        }
+        dcmtk_flock(lockfd, LOCK_SH);
+    }
+#endif
+
+    msgId = origAssoc->nextMsgID++;
+
     req.MessageID = msgId;
     OFStandard::strlcpy(req.AffectedSOPClassUID, sopClass, DIC_UI_LEN + 1);
     OFStandard::strlcpy(req.AffectedSOPInstanceUID, sopInstance, DIC_UI_LEN + 1);
@@ -227,13 +261,15 @@ OFCondition DcmQueryRetrieveGetContext::performGetSubOp(DIC_UI sopClass, DIC_UI
     T_DIMSE_DetectedCancelParameters cancelParameters;
 
     cond = DIMSE_storeUser(origAssoc, presId, &req,
-        fname, NULL, getSubOpProgressCallback, this, options_.blockMode_, options_.dimse_timeout_,
+        (dataset == NULL) ? fname : NULL, dataset, getSubOpProgressCallback, this, options_.blockMode_, options_.dimse_timeout_,
         &rsp, &stDetail, &cancelParameters);
 
 #ifdef LOCK_IMAGE_FILES
     /* unlock image file */
-    dcmtk_flock(lockfd, LOCK_UN);
-    close(lockfd);
+    if (lockfd >= 0) {
+        dcmtk_flock(lockfd, LOCK_UN);
+        close(lockfd);
+    }
 #endif
 
     if (cond.good()) {
@@ -276,41 +312,64 @@ OFCondition DcmQueryRetrieveGetContext::performGetSubOp(DIC_UI sopClass, DIC_UI
     return cond;
 }
 
-void DcmQueryRetrieveGetContext::getNextImage(DcmQueryRetrieveDatabaseStatus * dbStatus)
+void DcmQueryRetrieveGetContext::fillSubOperationQueue()
 {
-    OFCondition cond = EC_Normal;
-    OFCondition dbcond = EC_Normal;
     DIC_UI subImgSOPClass;      /* sub-operation image SOP Class */
     DIC_UI subImgSOPInstance;   /* sub-operation image SOP Instance */
     char subImgFileName[MAXPATHLEN + 1];    /* sub-operation image file */
 
-    /* clear out strings */
-    memset(subImgFileName, 0, sizeof(subImgFileName));
-    memset(subImgSOPClass, 0, sizeof(subImgSOPClass));
-    memset(subImgSOPInstance, 0, sizeof(subImgSOPInstance));
-
-    /* get DB response */
-    dbcond = dbHandle.nextMoveResponse(
-        subImgSOPClass, sizeof(subImgSOPClass), subImgSOPInstance, sizeof(subImgSOPInstance), subImgFileName, sizeof(subImgFileName), &nRemaining, dbStatus);
-    if (dbcond.bad()) {
-        DCMQRDB_ERROR("getSCP: Database: nextMoveResponse Failed ("
-            << DU_cmoveStatusString(dbStatus->status()) << "):");
+    /* the sub-operation to be performed next plus the ones to be prefetched */
+    while (!dbFinished && nOutstanding < 1 + options_.prefetchCount_) {
+        /* clear out strings */
+        memset(subImgFileName, 0, sizeof(subImgFileName));
+        memset(subImgSOPClass, 0, sizeof(subImgSOPClass));
+        memset(subImgSOPInstance, 0, sizeof(subImgSOPInstance));
+
+        /* get DB response */
+        DcmQueryRetrieveDatabaseStatus dbStatus(priorStatus);
+        OFCondition dbcond = dbHandle.nextMoveResponse(
+            subImgSOPClass, sizeof(subImgSOPClass), subImgSOPInstance, sizeof(subImgSOPInstance), subImgFileName, sizeof(subImgFileName), &nRemainingInDB, &dbStatus);
+        if (dbcond.bad()) {
+            DCMQRDB_ERROR("getSCP: Database: nextMoveResponse Failed ("
+                << DU_cmoveStatusString(dbStatus.status()) << "):");
+        }
+
+        if (dbStatus.status() == STATUS_Pending) {
+            subOps->push(new DcmQueryRetrieveSubOperation(subImgSOPClass, subImgSOPInstance, subImgFileName));
+            nOutstanding++;
+        } else {
+            dbFinished = OFTrue;
+            dbFinalStatus = dbStatus;
+        }
     }
+}
 
-    if (dbStatus->status() == STATUS_Pending) {
-        /* perform sub-op */
-        cond = performGetSubOp(subImgSOPClass, subImgSOPInstance, subImgFileName);
+void DcmQueryRetrieveGetContext::getNextImage(DcmQueryRetrieveDatabaseStatus * dbStatus)
+{
+    /* retrieve the next instances from the database and start prefetching them */
+    fillSubOperationQueue();
 
-        if (getCancelled) {
-            dbStatus->setStatus(STATUS_GET_Cancel_SubOperationsTerminatedDueToCancelIndication);
-            DCMQRDB_INFO("Get SCP: Received C-Cancel RQ");
-       }
+    if (nOutstanding == 0) {
+        /* all sub-operations have been performed */
+        *dbStatus = dbFinalStatus;
+        return;
+    }
 
-        if (cond != EC_Normal) {
-            OFString temp_str;
-            DCMQRDB_ERROR("getSCP: Get Sub-Op Failed: " << DimseCondition::dump(temp_str, cond));
-            /* clear condition stack */
-        }
+    /* perform sub-op */
+    DcmQueryRetrieveSubOperation *subOp = subOps->pop();
+    nOutstanding--;
+    OFCondition cond = performGetSubOp(subOp);
+    delete subOp;
+
+    if (getCancelled) {
+        dbStatus->setStatus(STATUS_GET_Cancel_SubOperationsTerminatedDueToCancelIndication);
+        DCMQRDB_INFO("Get SCP: Received C-Cancel RQ");
+    }
+
+    if (cond != EC_Normal) {
+        OFString temp_str;
+        DCMQRDB_ERROR("getSCP: Get Sub-Op Failed: " << DimseCondition::dump(temp_str, cond));
+        /* clear condition stack */
     }
 }
 
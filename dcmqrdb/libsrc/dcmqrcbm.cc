@@ -31,6 +31,7 @@
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmqrdb/dcmqrdbs.h"
 #include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/dcmqrdb/dcmqrsub.h"
 #include "dcmtk/ofstd/ofstd.h"
 
 BEGIN_EXTERN_C
@@ -66,6 +67,54 @@ static void moveSubOpProgressCallback(void * /* callbackData */,
   }
 }
 
+#ifdef WITH_THREADS
+
+/* thread performing the C-STORE sub-operations of a C-MOVE operation on one
+ * of the parallel sub-associations
+ */
+class DcmQueryRetrieveMoveSubAssociation : public OFThread
+{
+public:
+    DcmQueryRetrieveMoveSubAssociation(DcmQueryRetrieveMoveContext& context, T_ASC_Association *assoc, OFBool owner)
+    : OFThread()
+    , assoc_(assoc)
+    , owner_(owner)
+    , context_(context)
+    {
+    }
+
+    /// sub-association used by this thread
+    T_ASC_Association *assoc_;
+
+    /// true if the sub-association is owned by this thread (and not the context's subAssoc)
+    OFBool owner_;
+
+private:
+    virtual void run()
+    {
+        context_.performSubOperations(assoc_);
+    }
+
+    /// the move context
+    DcmQueryRetrieveMoveContext& context_;
+
+    // private undefined copy constructor
+    DcmQueryRetrieveMoveSubAssociation(const DcmQueryRetrieveMoveSubAssociation&);
+
+    // private undefined assignment operator
+    DcmQueryRetrieveMoveSubAssociation& operator=(const DcmQueryRetrieveMoveSubAssociation&);
+};
+
+#endif
+
+DcmQueryRetrieveMoveContext::~DcmQueryRetrieveMoveContext()
+{
+    /* usually already done by the last call of callbackHandler() */
+    finishSubOperations(OFTrue);
+    closeSubAssociation();
+    free(failedUIDs);
+}
+
 void DcmQueryRetrieveMoveContext::callbackHandler(
     /* in */
     OFBool cancelled, T_DIMSE_C_MoveRQ *request,
@@ -105,6 +154,8 @@ void DcmQueryRetrieveMoveContext::callbackHandler(
     /* only cancel if we have pending status */
     if (cancelled && dbStatus.status() == STATUS_Pending) {
         dbHandle.cancelMoveRequest(&dbStatus);
+        /* sub-operations already being performed are completed */
+        finishSubOperations(OFTrue);
     }
 
     if (dbStatus.status() == STATUS_Pending) {
@@ -115,6 +166,7 @@ void DcmQueryRetrieveMoveContext::callbackHandler(
         /*
          * Tear down sub-association (if it exists).
          */
+        finishSubOperations(OFFalse);
         closeSubAssociation();
 
         /*
@@ -143,12 +195,15 @@ void DcmQueryRetrieveMoveContext::callbackHandler(
         buildFailedInstanceList(responseIdentifiers);
     }
 
-    /* set response status */
+    /* set response status, the counters may be modified by parallel sub-operations */
+    lockCounters();
+    nRemaining = OFstatic_cast(DIC_US, nRemainingInDB + nUnprocessed + nCancelled);
     response->DimseStatus = dbStatus.status();
     response->NumberOfRemainingSubOperations = nRemaining;
     response->NumberOfCompletedSubOperations = nCompleted;
     response->NumberOfFailedSubOperations = nFailed;
     response->NumberOfWarningSubOperations = nWarning;
+    unlockCounters();
     *stDetail = dbStatus.extractStatusDetail();
 
     OFString str;
@@ -186,7 +241,21 @@ void DcmQueryRetrieveMoveContext::addFailedUIDInstance(const char *sopInstance)
     }
 }
 
-OFCondition DcmQueryRetrieveMoveContext::performMoveSubOp(DIC_UI sopClass, DIC_UI sopInstance, char *fname)
+void DcmQueryRetrieveMoveContext::lockCounters()
+{
+#ifdef WITH_THREADS
+    mutex.lock();
+#endif
+}
+
+void DcmQueryRetrieveMoveContext::unlockCounters()
+{
+#ifdef WITH_THREADS
+    mutex.unlock();
+#endif
+}
+
+OFCondition DcmQueryRetrieveMoveContext::performMoveSubOp(T_ASC_Association *assoc, DcmQueryRetrieveSubOperation *subOp)
 {
     OFCondition cond = EC_Normal;
     T_DIMSE_C_StoreRQ req;
@@ -194,39 +263,63 @@ OFCondition DcmQueryRetrieveMoveContext::performMoveSubOp(DIC_UI sopClass, DIC_U
     DIC_US msgId;
     T_ASC_PresentationContextID presId;
     DcmDataset *stDetail = NULL;
-
-#ifdef LOCK_IMAGE_FILES
-    /* shared lock image file */
-    int lockfd;
-#ifdef O_BINARY
-    lockfd = open(fname, O_RDONLY | O_BINARY, 0666);
-#else
-    lockfd = open(fname, O_RDONLY , 0666);
-#endif
-    if (lockfd < 0) {
-        /* due to quota system the file could have been deleted */
-        DCMQRDB_ERROR("Move SCP: storeSCU: [file: " << fname << "]: "
-            << OFStandard::getLastSystemErrorCode().message());
-        nFailed++;
-        addFailedUIDInstance(sopInstance);
-        return EC_Normal;
-    }
-    dcmtk_flock(lockfd, LOCK_SH);
-#endif
-
-    msgId = subAssoc->nextMsgID++;
+    DcmDataset *dataset = NULL;
+    const char *fname = subOp->filename;
+    const char *sopClass = subOp->sopClass;
+    const char *sopInstance = subOp->sopInstance;
 
     /* which presentation context should be used */
-    presId = ASC_findAcceptedPresentationContextID(subAssoc,
+    presId = ASC_findAcceptedPresentationContextID(assoc,
         sopClass);
     if (presId == 0) {
+        lockCounters();
         nFailed++;
         addFailedUIDInstance(sopInstance);
+        unlockCounters();
         DCMQRDB_ERROR("Move SCP: storeSCU: [file: " << fname << "] No presentation context for: ("
             << dcmSOPClassUIDToModality(sopClass, "OT") << ") " << sopClass);
         return DIMSE_NOVALIDPRESENTATIONCONTEXTID;
     }
 
+    if (subOp->isPrefetched()) {
+        /* the file has been loaded (and locked while being read) in advance */
+        cond = subOp->wait();
+        if (cond.bad()) {
+            DCMQRDB_ERROR("Move SCP: storeSCU: [file: " << fname << "]: " << cond.text());
+            lockCounters();
+            nFailed++;
+            addFailedUIDInstance(sopInstance);
+            unlockCounters();
+            return EC_Normal;
+        }
+        dataset = subOp->getDataset();
+    }
+
+#ifdef LOCK_IMAGE_FILES
+    /* shared lock image file */
+    int lockfd = -1;
+    if (dataset == NULL) {
+#ifdef O_BINARY
+        lockfd = open(fname, O_RDONLY | O_BINARY, 0666);
+#else
+        lockfd = open(fname, O_RDONLY , 0666);
+#endif
+        if (lockfd < 0) {
+            /* due to quota system the file could have been deleted */
+            DCMQRDB_ERROR("Move SCP: storeSCU: [file: " << fname << "]: "
+                << OFStandard::getLastSystemErrorCode().message());
+            lockCounters();
+            nFailed++;
+            addFailedUIDInstance(sopInstance);
+            unlockCounters();
+            return EC_Normal;
+        }
+        dcmtk_flock(lockfd, LOCK_SH);
+    }
+#endif
+
+    msgId = assoc->nextMsgID++;
+
     req.MessageID = msgId;
     OFStandard::strlcpy(req.AffectedSOPClassUID, sopClass, DIC_UI_LEN + 1); // see declaration of DIC_UI in dcmtk/dcmnet/dicom.h
     OFStandard::strlcpy(req.AffectedSOPInstanceUID, sopInstance, DIC_UI_LEN + 1);
@@ -239,17 +332,20 @@ OFCondition DcmQueryRetrieveMoveContext::performMoveSubOp(DIC_UI sopClass, DIC_U
     DCMQRDB_INFO("Store SCU RQ: MsgID " << msgId << ", ("
         << dcmSOPClassUIDToModality(sopClass, "OT") << ")");
 
-    cond = DIMSE_storeUser(subAssoc, presId, &req,
-        fname, NULL, moveSubOpProgressCallback, this,
+    cond = DIMSE_storeUser(assoc, presId, &req,
+        (dataset == NULL) ? fname : NULL, dataset, moveSubOpProgressCallback, this,
         options_.blockMode_, options_.dimse_timeout_,
         &rsp, &stDetail);
 
 #ifdef LOCK_IMAGE_FILES
     /* unlock image file */
-    dcmtk_flock(lockfd, LOCK_UN);
-    close(lockfd);
+    if (lockfd >= 0) {
+        dcmtk_flock(lockfd, LOCK_UN);
+        close(lockfd);
+    }
 #endif
 
+    lockCounters();
     if (cond.good()) {
         DCMQRDB_INFO("Move SCP: Received Store SCU RSP [Status="
             << DU_cstoreStatusString(rsp.DimseStatus) << "]");
@@ -274,6 +370,7 @@ OFCondition DcmQueryRetrieveMoveContext::performMoveSubOp(DIC_UI sopClass, DIC_U
         OFString temp_str;
         DCMQRDB_ERROR("Move SCP: storeSCU: Store Request Failed: " << DimseCondition::dump(temp_str, cond));
     }
+    unlockCounters();
     if (stDetail != NULL) {
         DCMQRDB_INFO("  Status Detail:" << OFendl << DcmObject::PrintHelper(*stDetail));
         delete stDetail;
@@ -287,8 +384,6 @@ OFCondition DcmQueryRetrieveMoveContext::buildSubAssociation(T_DIMSE_C_MoveRQ *r
     DIC_NODENAME dstHostName;
     DIC_NODENAME dstHostNamePlusPort;
     int dstPortNumber;
-    T_ASC_Parameters *params = NULL;
-    OFString temp_str;
 
     OFStandard::strlcpy(dstAETitle, request->MoveDestination, DIC_AE_LEN + 1);
 
@@ -309,11 +404,26 @@ OFCondition DcmQueryRetrieveMoveContext::buildSubAssociation(T_DIMSE_C_MoveRQ *r
         request->MoveDestination, dstHostName, DIC_NODENAME_LEN + 1, &dstPortNumber)) {
         return QR_EC_InvalidPeer;
     }
+    OFStandard::snprintf(dstHostNamePlusPort, sizeof(DIC_NODENAME), "%s:%d", dstHostName, dstPortNumber);
+
+    cond = requestSubAssociation(dstHostNamePlusPort, &subAssoc);
     if (cond.good()) {
-        cond = ASC_createAssociationParameters(&params, ASC_DEFAULTMAXPDU, dcmConnectionTimeout.get());
-        if (cond.bad()) {
-            DCMQRDB_ERROR("moveSCP: Cannot create Association-params for sub-ops: " << DimseCondition::dump(temp_str, cond));
-        }
+        assocStarted = OFTrue;
+        startSubOperations(dstHostNamePlusPort);
+    }
+
+    return cond;
+}
+
+OFCondition DcmQueryRetrieveMoveContext::requestSubAssociation(const char *dstPeerAddress, T_ASC_Association **assoc)
+{
+    OFCondition cond = EC_Normal;
+    T_ASC_Parameters *params = NULL;
+    OFString temp_str;
+
+    cond = ASC_createAssociationParameters(&params, ASC_DEFAULTMAXPDU, dcmConnectionTimeout.get());
+    if (cond.bad()) {
+        DCMQRDB_ERROR("moveSCP: Cannot create Association-params for sub-ops: " << DimseCondition::dump(temp_str, cond));
     }
 
     if (cond.good()) {
@@ -324,9 +434,8 @@ OFCondition DcmQueryRetrieveMoveContext::buildSubAssociation(T_DIMSE_C_MoveRQ *r
     }
 
     if (cond.good()) {
-        OFStandard::snprintf(dstHostNamePlusPort, sizeof(DIC_NODENAME), "%s:%d", dstHostName, dstPortNumber);
         ASC_setPresentationAddresses(params, OFStandard::getHostName().c_str(),
-            dstHostNamePlusPort);
+            dstPeerAddress);
         ASC_setAPTitles(params, ourAETitle.c_str(), dstAETitle,NULL);
 
         if (options_.outgoingProfile.empty()) {
@@ -342,7 +451,7 @@ OFCondition DcmQueryRetrieveMoveContext::buildSubAssociation(T_DIMSE_C_MoveRQ *r
     if (cond.good()) {
         /* create association */
         DCMQRDB_INFO("Requesting Sub-Association");
-        cond = ASC_requestAssociation(options_.net_, params, &subAssoc);
+        cond = ASC_requestAssociation(options_.net_, params, assoc);
         if (cond.bad()) {
             if (cond == DUL_ASSOCIATIONREJECTED) {
                 T_ASC_RejectParameters rej;
@@ -355,10 +464,6 @@ OFCondition DcmQueryRetrieveMoveContext::buildSubAssociation(T_DIMSE_C_MoveRQ *r
         }
     }
 
-    if (cond.good()) {
-        assocStarted = OFTrue;
-    }
-
     return cond;
 }
 
@@ -391,35 +496,186 @@ OFCondition DcmQueryRetrieveMoveContext::closeSubAssociation()
     return cond;
 }
 
-void DcmQueryRetrieveMoveContext::moveNextImage(DcmQueryRetrieveDatabaseStatus * dbStatus)
+void DcmQueryRetrieveMoveContext::startSubOperations(const char *dstPeerAddress)
+{
+    size_t numAssocs = 1;
+#ifdef WITH_THREADS
+    /* request additional sub-associations, the first one already exists */
+    if (options_.maxSubAssociations_ > 1) {
+        OFVector<T_ASC_Association *> assocs;
+        assocs.push_back(subAssoc);
+        while (assocs.size() < options_.maxSubAssociations_) {
+            T_ASC_Association *assoc = NULL;
+            if (requestSubAssociation(dstPeerAddress, &assoc).bad()) {
+                DCMQRDB_WARN("moveSCP: cannot request additional Sub-Association, using "
+                    << assocs.size() << " Sub-Association(s)");
+                break;
+            }
+            assocs.push_back(assoc);
+        }
+        if (assocs.size() > 1) {
+            numAssocs = assocs.size();
+            subOps = new DcmQueryRetrieveSubOperationQueue(numAssocs + options_.prefetchCount_, options_.prefetchCount_);
+            for (size_t i = 0; i < assocs.size(); ++i) {
+                DcmQueryRetrieveMoveSubAssociation *thread = new DcmQueryRetrieveMoveSubAssociation(*this, assocs[i], i > 0);
+                if (thread->start() != 0) {
+                    DCMQRDB_WARN("moveSCP: cannot start thread for Sub-Association");
+                    delete thread;
+                    if (i > 0) releaseSubAssociation(&assocs[i]);
+                } else {
+                    subAssocThreads.push_back(thread);
+                }
+            }
+            if (subAssocThreads.empty()) {
+                /* fall back to performing the sub-operations in this thread */
+                delete subOps;
+                subOps = NULL;
+                numAssocs = 1;
+            }
+        }
+    }
+#else
+    (void) dstPeerAddress;
+#endif
+    if (subOps == NULL)
+        subOps = new DcmQueryRetrieveSubOperationQueue(1 + options_.prefetchCount_, options_.prefetchCount_);
+    DCMQRDB_DEBUG("moveSCP: performing sub-operations on " << numAssocs << " Sub-Association(s), prefetching "
+        << options_.prefetchCount_ << " file(s)");
+}
+
+void DcmQueryRetrieveMoveContext::releaseSubAssociation(T_ASC_Association **assoc)
+{
+    if (*assoc != NULL) {
+        OFString temp_str;
+        OFCondition cond = ASC_releaseAssociation(*assoc);
+        if (cond.bad()) {
+            DCMQRDB_ERROR("moveSCP: Sub-Association Release Failed: " << DimseCondition::dump(temp_str, cond));
+        }
+        ASC_dropAssociation(*assoc);
+        ASC_destroyAssociation(assoc);
+    }
+}
+
+void DcmQueryRetrieveMoveContext::fillSubOperationQueue()
 {
-    OFCondition cond = EC_Normal;
-    OFCondition dbcond = EC_Normal;
     DIC_UI subImgSOPClass;      /* sub-operation image SOP Class */
     DIC_UI subImgSOPInstance;   /* sub-operation image SOP Instance */
     char subImgFileName[MAXPATHLEN + 1];    /* sub-operation image file */
 
-    /* clear out strings */
-    memset(subImgFileName, 0, sizeof(subImgFileName));
-    memset(subImgSOPClass, 0, sizeof(subImgSOPClass));
-    memset(subImgSOPInstance,0, sizeof(subImgSOPInstance));
+    /* the sub-operations being performed plus the ones to be prefetched */
+    const size_t capacity = (subAssocThreads.empty() ? 1 : subAssocThreads.size()) + options_.prefetchCount_;
+    while (!dbFinished && nOutstanding < capacity) {
+        /* clear out strings */
+        memset(subImgFileName, 0, sizeof(subImgFileName));
+        memset(subImgSOPClass, 0, sizeof(subImgSOPClass));
+        memset(subImgSOPInstance, 0, sizeof(subImgSOPInstance));
 
-    /* get DB response */
-    dbcond = dbHandle.nextMoveResponse(
-        subImgSOPClass, sizeof(subImgSOPClass), subImgSOPInstance, sizeof(subImgSOPInstance), subImgFileName, sizeof(subImgFileName), &nRemaining, dbStatus);
-    if (dbcond.bad()) {
-        DCMQRDB_ERROR("moveSCP: Database: nextMoveResponse Failed ("
-                << DU_cmoveStatusString(dbStatus->status()) << "):");
+        /* get DB response */
+        DcmQueryRetrieveDatabaseStatus dbStatus(priorStatus);
+        DIC_US remaining = 0;
+        OFCondition dbcond = dbHandle.nextMoveResponse(
+            subImgSOPClass, sizeof(subImgSOPClass), subImgSOPInstance, sizeof(subImgSOPInstance), subImgFileName, sizeof(subImgFileName), &remaining, &dbStatus);
+        if (dbcond.bad()) {
+            DCMQRDB_ERROR("moveSCP: Database: nextMoveResponse Failed ("
+                    << DU_cmoveStatusString(dbStatus.status()) << "):");
+        }
+
+        lockCounters();
+        if (dbStatus.status() == STATUS_Pending) {
+            nRemainingInDB = remaining;
+            nOutstanding++;
+            nUnprocessed++;
+        } else {
+            dbFinished = OFTrue;
+            dbFinalStatus = dbStatus;
+        }
+        unlockCounters();
+        if (!dbFinished)
+            subOps->push(new DcmQueryRetrieveSubOperation(subImgSOPClass, subImgSOPInstance, subImgFileName));
     }
+}
 
-    if (dbStatus->status() == STATUS_Pending) {
+void DcmQueryRetrieveMoveContext::performSubOperations(T_ASC_Association *assoc)
+{
+    DcmQueryRetrieveSubOperation *subOp;
+    while ((subOp = subOps->pop()) != NULL) {
+        const OFBool cancelled = subOps->isCancelled();
+        if (!cancelled) {
+            OFCondition cond = performMoveSubOp(assoc, subOp);
+            if (cond != EC_Normal) {
+                OFString temp_str;
+                DCMQRDB_ERROR("moveSCP: Move Sub-Op Failed: " << DimseCondition::dump(temp_str, cond));
+            }
+        }
+        delete subOp;
+        lockCounters();
+        if (cancelled)
+            nCancelled++;
+        nUnprocessed--;
+        unlockCounters();
+        subOps->processed();
+    }
+}
+
+void DcmQueryRetrieveMoveContext::finishSubOperations(OFBool cancel)
+{
+    if (subOps == NULL)
+        return;
+    if (cancel)
+        subOps->cancel();
+    if (subAssocThreads.empty()) {
+        /* the queued sub-operations will not be performed */
+        nCancelled = OFstatic_cast(DIC_US, nCancelled + nUnprocessed);
+        nOutstanding = 0;
+        nUnprocessed = 0;
+    } else {
+        /* wait until the threads have processed all queued sub-operations */
+        subOps->close();
+        while (nOutstanding > 0) {
+            subOps->waitProcessed();
+            nOutstanding--;
+        }
+#ifdef WITH_THREADS
+        for (size_t i = 0; i < subAssocThreads.size(); ++i) {
+            subAssocThreads[i]->join();
+            if (subAssocThreads[i]->owner_)
+                releaseSubAssociation(&subAssocThreads[i]->assoc_);
+            delete subAssocThreads[i];
+        }
+#endif
+        subAssocThreads.clear();
+    }
+    delete subOps;
+    subOps = NULL;
+}
+
+void DcmQueryRetrieveMoveContext::moveNextImage(DcmQueryRetrieveDatabaseStatus * dbStatus)
+{
+    /* retrieve the next instances from the database and start prefetching them */
+    fillSubOperationQueue();
+
+    if (nOutstanding == 0) {
+        /* all sub-operations have been performed */
+        *dbStatus = dbFinalStatus;
+        return;
+    }
+
+    if (subAssocThreads.empty()) {
         /* perform sub-op */
-        cond = performMoveSubOp(subImgSOPClass, subImgSOPInstance, subImgFileName);
+        DcmQueryRetrieveSubOperation *subOp = subOps->pop();
+        OFCondition cond = performMoveSubOp(subAssoc, subOp);
+        delete subOp;
+        nOutstanding--;
+        nUnprocessed--;
         if (cond != EC_Normal) {
             OFString temp_str;
             DCMQRDB_ERROR("moveSCP: Move Sub-Op Failed: " << DimseCondition::dump(temp_str, cond));
             /* clear condition stack */
         }
+    } else {
+        /* wait until one of the parallel sub-operations has been performed */
+        subOps->waitProcessed();
+        nOutstanding--;
     }
 }
 
@@ -438,7 +694,7 @@ void DcmQueryRetrieveMoveContext::failAllSubOperations(DcmQueryRetrieveDatabaseS
     while (dbStatus->status() == STATUS_Pending) {
         /* get DB response */
         dbcond = dbHandle.nextMoveResponse(
-            subImgSOPClass, sizeof(subImgSOPClass), subImgSOPInstance, sizeof(subImgSOPInstance), subImgFileName, sizeof(subImgFileName), &nRemaining, dbStatus);
+            subImgSOPClass, sizeof(subImgSOPClass), subImgSOPInstance, sizeof(subImgSOPInstance), subImgFileName, sizeof(subImgFileName), &nRemainingInDB, dbStatus);
         if (dbcond.bad()) {
             DCMQRDB_ERROR("moveSCP: Database: nextMoveResponse Failed ("
                 << DU_cmoveStatusString(dbStatus->status()) << "):");
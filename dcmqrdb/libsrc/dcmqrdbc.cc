@@ -0,0 +1,616 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: classes DcmQueryRetrieveUIDTable, DcmQueryRetrieveSummaryIndex
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmqrdb/dcmqrdbc.h"
+#include "dcmtk/dcmqrdb/dcmqrcnf.h"
+#include "dcmtk/dcmqrdb/dcmqridx.h"
+#include "dcmtk/dcmqrdb/dcmqrdbs.h"
+#include "dcmtk/dcmqrdb/dcmqropt.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+
+/// initial number of buckets of a DcmQueryRetrieveUIDTable, must be a power of two
+#define DB_UIDTABLE_INITIAL_BUCKETS 64
+
+
+/* ========================= static functions ========================= */
+
+BEGIN_EXTERN_C
+static int DB_SummaryCompareIdx(const void *ve1, const void *ve2)
+{
+    const Sint32 i1 = *OFstatic_cast(const Sint32 *, ve1);
+    const Sint32 i2 = *OFstatic_cast(const Sint32 *, ve2);
+    return (i1 < i2) ? -1 : ((i1 > i2) ? 1 : 0);
+}
+END_EXTERN_C
+
+/************
+**      Add a modality to a list of distinct modalities separated by backslashes
+ */
+
+static void DB_SummaryAddModality(char *list, const char *modality)
+{
+    const size_t length = strlen(modality);
+    if (length == 0)
+        return;
+    const char *pos = list;
+    while (*pos)
+    {
+        const char *end = strchr(pos, '\\');
+        const size_t valueLength = end ? OFstatic_cast(size_t, end - pos) : strlen(pos);
+        if ((valueLength == length) && (strncmp(pos, modality, length) == 0))
+            return;
+        pos += valueLength;
+        if (*pos) ++pos;
+    }
+    /* modalities that do not fit are silently ignored */
+    const size_t listLength = strlen(list);
+    if (listLength + length + (listLength ? 1 : 0) <= DB_SUMMARY_MODALITY_LENGTH)
+    {
+        if (listLength)
+            list[listLength] = '\\';
+        strcpy(list + listLength + (listLength ? 1 : 0), modality);
+    }
+}
+
+
+/* ========================= class DcmQueryRetrieveUIDTable ========================= */
+
+DcmQueryRetrieveUIDTable::DcmQueryRetrieveUIDTable()
+: buckets_(DB_UIDTABLE_INITIAL_BUCKETS)
+, size_(0)
+{
+}
+
+void DcmQueryRetrieveUIDTable::clear()
+{
+    OFVector<OFVector<Entry> > buckets(DB_UIDTABLE_INITIAL_BUCKETS);
+    buckets_.swap(buckets);
+    size_ = 0;
+}
+
+size_t DcmQueryRetrieveUIDTable::size() const
+{
+    return size_;
+}
+
+size_t DcmQueryRetrieveUIDTable::bucket(const OFString& key) const
+{
+    /* FNV-1a, the number of buckets is always a power of two */
+    Uint32 hash = 2166136261U;
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        hash ^= OFstatic_cast(unsigned char, key[i]);
+        hash *= 16777619U;
+    }
+    return OFstatic_cast(size_t, hash) & (buckets_.size() - 1);
+}
+
+void DcmQueryRetrieveUIDTable::grow()
+{
+    OFVector<OFVector<Entry> > buckets(buckets_.size() * 2);
+    buckets.swap(buckets_);
+    for (size_t i = 0; i < buckets.size(); i++)
+    {
+        for (size_t j = 0; j < buckets[i].size(); j++)
+            buckets_[bucket(buckets[i][j].key)].push_back(buckets[i][j]);
+    }
+}
+
+OFBool DcmQueryRetrieveUIDTable::insert(const OFString& key, Sint32 value)
+{
+    OFVector<Entry>& entries = buckets_[bucket(key)];
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].key == key)
+            return OFFalse;
+    }
+    Entry entry;
+    entry.key = key;
+    entry.value = value;
+    entries.push_back(entry);
+    /* keep the average number of entries per bucket small */
+    if (++size_ > 2 * buckets_.size())
+        grow();
+    return OFTrue;
+}
+
+OFBool DcmQueryRetrieveUIDTable::find(const OFString& key, Sint32& value) const
+{
+    const OFVector<Entry>& entries = buckets_[bucket(key)];
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].key == key)
+        {
+            value = entries[i].value;
+            return OFTrue;
+        }
+    }
+    return OFFalse;
+}
+
+OFBool DcmQueryRetrieveUIDTable::contains(const OFString& key) const
+{
+    Sint32 value;
+    return find(key, value);
+}
+
+OFBool DcmQueryRetrieveUIDTable::erase(const OFString& key)
+{
+    OFVector<Entry>& entries = buckets_[bucket(key)];
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if (entries[i].key == key)
+        {
+            entries[i] = entries.back();
+            entries.pop_back();
+            --size_;
+            return OFTrue;
+        }
+    }
+    return OFFalse;
+}
+
+
+/* ========================= class DcmQueryRetrieveSummaryIndex ========================= */
+
+DcmQueryRetrieveSummaryIndex::DcmQueryRetrieveSummaryIndex(const char *storageArea)
+: filename_()
+, file_()
+, header_()
+, entries_()
+, studies_()
+, series_()
+, unused_()
+, modified_()
+, updateDepth_(0)
+, cancelled_(OFFalse)
+, valid_(OFFalse)
+{
+    filename_ = storageArea;
+    filename_ += PATH_SEPARATOR;
+    filename_ += DBSUMMARYFILE;
+    memset(&header_, 0, sizeof(header_));
+}
+
+DcmQueryRetrieveSummaryIndex::~DcmQueryRetrieveSummaryIndex()
+{
+    close();
+}
+
+const OFString& DcmQueryRetrieveSummaryIndex::getFilename() const
+{
+    return filename_;
+}
+
+OFBool DcmQueryRetrieveSummaryIndex::isValid() const
+{
+    return valid_;
+}
+
+OFBool DcmQueryRetrieveSummaryIndex::isUpdating() const
+{
+    return updateDepth_ > 0;
+}
+
+OFBool DcmQueryRetrieveSummaryIndex::open(OFBool forUpdate)
+{
+    close();
+    if (!file_.fopen(filename_.c_str(), forUpdate ? "r+b" : "rb"))
+    {
+        DCMQRDB_DEBUG("summary index file not available: " << filename_);
+        valid_ = OFFalse;
+        return OFFalse;
+    }
+
+    DB_SummaryHeader header;
+    if ((file_.fread(&header, sizeof(header), 1) != 1) ||
+        (strncmp(header.magic, DBSUMMARYMAGIC, sizeof(header.magic)) != 0) ||
+        (header.version != DBSUMMARYVERSION))
+    {
+        DCMQRDB_WARN("invalid summary index file: " << filename_);
+        close();
+        valid_ = OFFalse;
+        return OFFalse;
+    }
+    if (header.dirty)
+    {
+        DCMQRDB_WARN("summary index file is not up-to-date: " << filename_);
+        close();
+        valid_ = OFFalse;
+        return OFFalse;
+    }
+
+    /* only read the entries if the file was modified since it was last read */
+    if (!valid_ || (header.generation != header_.generation) || (header.count != header_.count))
+    {
+        entries_.resize(header.count);
+        if ((header.count > 0) &&
+            (file_.fread(&entries_[0], sizeof(DB_SummaryRecord), header.count) != header.count))
+        {
+            DCMQRDB_WARN("cannot read summary index file: " << filename_);
+            close();
+            entries_.clear();
+            valid_ = OFFalse;
+            return OFFalse;
+        }
+        header_ = header;
+        buildTables();
+    }
+    valid_ = OFTrue;
+    return OFTrue;
+}
+
+void DcmQueryRetrieveSummaryIndex::close()
+{
+    if (file_.open())
+        file_.fclose();
+}
+
+void DcmQueryRetrieveSummaryIndex::buildTables()
+{
+    studies_.clear();
+    series_.clear();
+    unused_.clear();
+    for (size_t i = entries_.size(); i > 0; i--)
+    {
+        const Sint32 entry = OFstatic_cast(Sint32, i - 1);
+        DB_SummaryRecord& rec = entries_[entry];
+        /* the values are not necessarily zero terminated in a damaged file */
+        rec.StudyInstanceUID[DB_SUMMARY_UID_LENGTH] = '\0';
+        rec.SeriesInstanceUID[DB_SUMMARY_UID_LENGTH] = '\0';
+        rec.Modality[DB_SUMMARY_MODALITY_LENGTH] = '\0';
+        if (rec.kind == DB_SUMMARY_STUDY)
+            studies_.insert(rec.StudyInstanceUID, entry);
+        else if (rec.kind == DB_SUMMARY_SERIES)
+            series_.insert(rec.SeriesInstanceUID, entry);
+        else
+            unused_.push_back(entry);
+    }
+}
+
+OFCondition DcmQueryRetrieveSummaryIndex::writeHeader()
+{
+    if ((file_.fseek(0, SEEK_SET) != 0) ||
+        (file_.fwrite(&header_, sizeof(header_), 1) != 1) ||
+        (file_.fflush() != 0))
+    {
+        DCMQRDB_ERROR("cannot write summary index file: " << filename_);
+        return QR_EC_IndexDatabaseError;
+    }
+    return EC_Normal;
+}
+
+OFCondition DcmQueryRetrieveSummaryIndex::beginUpdate()
+{
+    if (updateDepth_++ > 0)
+        return cancelled_ ? QR_EC_IndexDatabaseError : EC_Normal;
+    cancelled_ = OFFalse;
+    modified_.clear();
+    if (!valid_ || !file_.open())
+    {
+        cancelled_ = OFTrue;
+        return QR_EC_IndexDatabaseError;
+    }
+    header_.dirty = 1;
+    OFCondition cond = writeHeader();
+    if (cond.bad())
+        cancelled_ = OFTrue;
+    return cond;
+}
+
+OFCondition DcmQueryRetrieveSummaryIndex::endUpdate()
+{
+    if (updateDepth_ == 0)
+        return QR_EC_IndexDatabaseError;
+    if (--updateDepth_ > 0)
+        return EC_Normal;
+    if (cancelled_ || !valid_ || !file_.open())
+    {
+        /* the file remains marked as being modified */
+        modified_.clear();
+        valid_ = OFFalse;
+        return QR_EC_IndexDatabaseError;
+    }
+
+    /* write the modified entries, entries appended at the end included */
+    OFBool ok = OFTrue;
+    for (size_t i = 0; ok && (i < modified_.size()); i++)
+    {
+        const offile_off_t offset = sizeof(header_) + OFstatic_cast(offile_off_t, modified_[i]) * sizeof(DB_SummaryRecord);
+        ok = (file_.fseek(offset, SEEK_SET) == 0) &&
+             (file_.fwrite(&entries_[modified_[i]], sizeof(DB_SummaryRecord), 1) == 1);
+    }
+    modified_.clear();
+    if (!ok)
+    {
+        DCMQRDB_ERROR("cannot write summary index file: " << filename_);
+        valid_ = OFFalse;
+        return QR_EC_IndexDatabaseError;
+    }
+    header_.count = OFstatic_cast(Uint32, entries_.size());
+    header_.dirty = 0;
+    header_.generation++;
+    OFCondition cond = writeHeader();
+    if (cond.bad())
+        valid_ = OFFalse;
+    return cond;
+}
+
+void DcmQueryRetrieveSummaryIndex::cancelUpdate()
+{
+    if (updateDepth_ > 0)
+        cancelled_ = OFTrue;
+}
+
+void DcmQueryRetrieveSummaryIndex::touch(Sint32 entry)
+{
+    /* entries are written by endUpdate() or writeIndex() */
+    if ((updateDepth_ > 0) && (modified_.empty() || (modified_.back() != entry)))
+        modified_.push_back(entry);
+}
+
+Sint32 DcmQueryRetrieveSummaryIndex::lookup(Uint32 kind, const char *studyUID, const char *seriesUID, OFBool create)
+{
+    DcmQueryRetrieveUIDTable& table = (kind == DB_SUMMARY_STUDY) ? studies_ : series_;
+    const OFString key((kind == DB_SUMMARY_STUDY) ? studyUID : seriesUID);
+    Sint32 entry = -1;
+    if (table.find(key, entry) || !create)
+        return entry;
+
+    if (unused_.empty())
+    {
+        entry = OFstatic_cast(Sint32, entries_.size());
+        entries_.resize(entries_.size() + 1);
+    }
+    else
+    {
+        entry = unused_.back();
+        unused_.pop_back();
+    }
+    DB_SummaryRecord& rec = entries_[entry];
+    memset(&rec, 0, sizeof(rec));
+    rec.kind = kind;
+    rec.idx = -1;
+    OFStandard::strlcpy(rec.StudyInstanceUID, studyUID, sizeof(rec.StudyInstanceUID));
+    if (kind == DB_SUMMARY_SERIES)
+        OFStandard::strlcpy(rec.SeriesInstanceUID, seriesUID, sizeof(rec.SeriesInstanceUID));
+    table.insert(key, entry);
+    touch(entry);
+    return entry;
+}
+
+void DcmQueryRetrieveSummaryIndex::release(Sint32 entry)
+{
+    DB_SummaryRecord& rec = entries_[entry];
+    if (rec.kind == DB_SUMMARY_STUDY)
+        studies_.erase(rec.StudyInstanceUID);
+    else if (rec.kind == DB_SUMMARY_SERIES)
+        series_.erase(rec.SeriesInstanceUID);
+    memset(&rec, 0, sizeof(rec));
+    unused_.push_back(entry);
+    touch(entry);
+}
+
+void DcmQueryRetrieveSummaryIndex::updateModalities(Sint32 study)
+{
+    DB_SummaryRecord& rec = entries_[study];
+    rec.Modality[0] = '\0';
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        if ((entries_[i].kind == DB_SUMMARY_SERIES) &&
+            (strcmp(entries_[i].StudyInstanceUID, rec.StudyInstanceUID) == 0))
+            DB_SummaryAddModality(rec.Modality, entries_[i].Modality);
+    }
+    touch(study);
+}
+
+void DcmQueryRetrieveSummaryIndex::addRecord(Sint32 idx, const IdxRecord& record)
+{
+    /* both entries have to be determined before references are taken */
+    const Sint32 study = lookup(DB_SUMMARY_STUDY, record.StudyInstanceUID, NULL, OFTrue);
+    const Sint32 series = lookup(DB_SUMMARY_SERIES, record.StudyInstanceUID, record.SeriesInstanceUID, OFTrue);
+    DB_SummaryRecord& studyRec = entries_[study];
+    DB_SummaryRecord& seriesRec = entries_[series];
+
+    if (seriesRec.numberOfInstances++ == 0)
+        studyRec.numberOfSeries++;
+    seriesRec.idx = idx;
+    OFStandard::strlcpy(seriesRec.Modality, record.Modality, sizeof(seriesRec.Modality));
+    studyRec.numberOfInstances++;
+    studyRec.idx = idx;
+    DB_SummaryAddModality(studyRec.Modality, seriesRec.Modality);
+    touch(series);
+    touch(study);
+}
+
+void DcmQueryRetrieveSummaryIndex::removeRecord(Sint32 idx, const IdxRecord& record)
+{
+    const Sint32 study = lookup(DB_SUMMARY_STUDY, record.StudyInstanceUID, NULL, OFFalse);
+    const Sint32 series = lookup(DB_SUMMARY_SERIES, record.StudyInstanceUID, record.SeriesInstanceUID, OFFalse);
+    OFBool seriesRemoved = OFFalse;
+
+    if (series >= 0)
+    {
+        DB_SummaryRecord& seriesRec = entries_[series];
+        if (seriesRec.numberOfInstances > 0)
+            seriesRec.numberOfInstances--;
+        if (seriesRec.numberOfInstances == 0)
+        {
+            release(series);
+            seriesRemoved = OFTrue;
+        }
+        else
+        {
+            if (seriesRec.idx == idx)
+                seriesRec.idx = -1;
+            touch(series);
+        }
+    }
+    if (study >= 0)
+    {
+        DB_SummaryRecord& studyRec = entries_[study];
+        if (studyRec.numberOfInstances > 0)
+            studyRec.numberOfInstances--;
+        if (seriesRemoved && (studyRec.numberOfSeries > 0))
+            studyRec.numberOfSeries--;
+        if (studyRec.numberOfInstances == 0)
+            release(study);
+        else
+        {
+            if (studyRec.idx == idx)
+                studyRec.idx = -1;
+            if (seriesRemoved)
+                updateModalities(study);
+            touch(study);
+        }
+    }
+}
+
+OFBool DcmQueryRetrieveSummaryIndex::isComplete() const
+{
+    if (!valid_)
+        return OFFalse;
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        if ((entries_[i].kind != DB_SUMMARY_UNUSED) && (entries_[i].idx < 0))
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+void DcmQueryRetrieveSummaryIndex::clear()
+{
+    entries_.clear();
+    modified_.clear();
+    buildTables();
+}
+
+OFCondition DcmQueryRetrieveSummaryIndex::writeIndex()
+{
+    close();
+
+    /* the generation must differ from the one of the file being replaced */
+    Uint32 generation = header_.generation;
+    DB_SummaryHeader header;
+    OFFile oldFile;
+    if (oldFile.fopen(filename_.c_str(), "rb"))
+    {
+        if ((oldFile.fread(&header, sizeof(header), 1) == 1) && (header.generation > generation))
+            generation = header.generation;
+        oldFile.fclose();
+    }
+
+    /* unused entries are not written */
+    OFVector<DB_SummaryRecord> entries;
+    entries.reserve(entries_.size() - unused_.size());
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        if (entries_[i].kind != DB_SUMMARY_UNUSED)
+            entries.push_back(entries_[i]);
+    }
+    entries_.swap(entries);
+    buildTables();
+    modified_.clear();
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DBSUMMARYMAGIC, sizeof(header.magic));
+    header.version = DBSUMMARYVERSION;
+    header.generation = generation + 1;
+    header.count = OFstatic_cast(Uint32, entries_.size());
+
+    /* write a temporary file first and replace the summary file afterwards */
+    const OFString tempFilename = filename_ + ".tmp";
+    OFFile file;
+    OFBool ok = file.fopen(tempFilename.c_str(), "wb");
+    if (ok)
+        ok = (file.fwrite(&header, sizeof(header), 1) == 1);
+    if (ok && !entries_.empty())
+        ok = (file.fwrite(&entries_[0], sizeof(DB_SummaryRecord), entries_.size()) == entries_.size());
+    if (file.open() && (file.fclose() != 0))
+        ok = OFFalse;
+    if (ok)
+    {
+        /* rename() does not replace an existing file on all systems */
+        OFStandard::deleteFile(filename_);
+        ok = OFStandard::renameFile(tempFilename, filename_);
+    }
+    if (!ok)
+    {
+        DCMQRDB_ERROR("cannot write summary index file: " << filename_ << ": "
+            << OFStandard::getLastSystemErrorCode().message());
+        OFStandard::deleteFile(tempFilename);
+        valid_ = OFFalse;
+        return QR_EC_IndexDatabaseError;
+    }
+    header_ = header;
+    valid_ = OFTrue;
+    return EC_Normal;
+}
+
+OFBool DcmQueryRetrieveSummaryIndex::getRepresentatives(OFBool seriesLevel, const OFVector<OFString>& studyUIDs, OFVector<Sint32>& records) const
+{
+    records.clear();
+    if (!valid_)
+        return OFFalse;
+
+    const Uint32 kind = seriesLevel ? DB_SUMMARY_SERIES : DB_SUMMARY_STUDY;
+    DcmQueryRetrieveUIDTable studies;
+    if (seriesLevel)
+    {
+        for (size_t i = 0; i < studyUIDs.size(); i++)
+            studies.insert(studyUIDs[i]);
+    }
+    for (size_t i = 0; i < entries_.size(); i++)
+    {
+        const DB_SummaryRecord& rec = entries_[i];
+        if ((rec.kind != kind) || ((studies.size() > 0) && !studies.contains(rec.StudyInstanceUID)))
+            continue;
+        if (rec.idx < 0)
+        {
+            records.clear();
+            return OFFalse;
+        }
+        records.push_back(rec.idx);
+    }
+    /* the records are read in ascending order */
+    if (!records.empty())
+        qsort(&records[0], records.size(), sizeof(Sint32), DB_SummaryCompareIdx);
+    return OFTrue;
+}
+
+const DB_SummaryRecord *DcmQueryRetrieveSummaryIndex::findStudy(const char *studyUID) const
+{
+    Sint32 entry;
+    if (valid_ && studies_.find(studyUID, entry))
+        return &entries_[entry];
+    return NULL;
+}
+
+const DB_SummaryRecord *DcmQueryRetrieveSummaryIndex::findSeries(const char *seriesUID) const
+{
+    Sint32 entry;
+    if (valid_ && series_.find(seriesUID, entry))
+        return &entries_[entry];
+    return NULL;
+}
@@ -28,9 +28,19 @@ BEGIN_EXTERN_C
 #ifdef HAVE_SYS_PARAM_H
 #include <sys/param.h>
 #endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 END_EXTERN_C
 
+#ifdef HAVE_SYS_MMAN_H
+/* read accesses to the index file are performed on a memory mapping */
+#define DB_MAP_INDEX_FILE
+#endif
+
 #include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/ofmap.h"
+#include "dcmtk/ofstd/ofthread.h"
 
 #include "dcmtk/dcmqrdb/dcmqrdbs.h"
 #include "dcmtk/dcmqrdb/dcmqrdbi.h"
@@ -38,6 +48,8 @@ END_EXTERN_C
 #include "dcmtk/dcmqrdb/dcmqropt.h"
 #include "dcmtk/ofstd/ofstdinc.h"
 #include "dcmtk/dcmqrdb/dcmqridx.h"
+#include "dcmtk/dcmqrdb/dcmqrdbx.h"
+#include "dcmtk/dcmqrdb/dcmqrdbc.h"
 #include "dcmtk/dcmnet/diutil.h"
 #include "dcmtk/dcmdata/dcfilefo.h"
 #include "dcmtk/dcmdata/dcmatch.h"
@@ -48,7 +60,9 @@ END_EXTERN_C
 
 /**** The TbFindAttr table contains the description of tags (keys) supported
  **** by the DB Module.
- **** Tags described here have to be present in the Index Record file.
+ **** Tags described here have to be present in the Index Record file,
+ **** except for the study and series aggregates (number of related series
+ **** and instances, modalities in study) determined from the summary index.
  **** The order is insignificant.
  ****
  **** Each element of this table is described by
@@ -86,9 +100,13 @@ static const DB_FindAttr TbFindAttr [] = {
         DB_FindAttr( DCM_PatientWeight,                         STUDY_LEVEL,    OPTIONAL_KEY ),
         DB_FindAttr( DCM_Occupation,                            STUDY_LEVEL,    OPTIONAL_KEY ),
         DB_FindAttr( DCM_AdditionalPatientHistory,              STUDY_LEVEL,    OPTIONAL_KEY ),
+        DB_FindAttr( DCM_ModalitiesInStudy,                     STUDY_LEVEL,    OPTIONAL_KEY ),
+        DB_FindAttr( DCM_NumberOfStudyRelatedSeries,            STUDY_LEVEL,    OPTIONAL_KEY ),
+        DB_FindAttr( DCM_NumberOfStudyRelatedInstances,         STUDY_LEVEL,    OPTIONAL_KEY ),
         DB_FindAttr( DCM_SeriesNumber,                          SERIE_LEVEL,    REQUIRED_KEY ),
         DB_FindAttr( DCM_SeriesInstanceUID,                     SERIE_LEVEL,    UNIQUE_KEY   ),
         DB_FindAttr( DCM_Modality,                              SERIE_LEVEL,    OPTIONAL_KEY ),
+        DB_FindAttr( DCM_NumberOfSeriesRelatedInstances,        SERIE_LEVEL,    OPTIONAL_KEY ),
         DB_FindAttr( DCM_InstanceNumber,                        IMAGE_LEVEL,    REQUIRED_KEY ),
         DB_FindAttr( DCM_SOPInstanceUID,                        IMAGE_LEVEL,    UNIQUE_KEY   )
   };
@@ -98,49 +116,59 @@ static const DB_FindAttr TbFindAttr [] = {
 
 static int NbFindAttr = ((sizeof (TbFindAttr)) / (sizeof (TbFindAttr [0])));
 
-/* ========================= static functions ========================= */
+#ifdef WITH_THREADS
+/**** The file locks acquired by DB_lock() do not necessarily exclude other
+ **** threads of the same process (e.g. if flock() is emulated using fcntl()),
+ **** so the database handles used by the threads of a process additionally
+ **** share this read/write lock. The DB_FilenameMutex protects the seed used
+ **** for creating new file names.
+ ***/
 
-static char *DB_strdup(const char* str)
-{
-    if (str == NULL) return NULL;
-    size_t buflen = strlen(str)+1;
-    char* s = (char*)malloc(buflen);
-    OFStandard::strlcpy(s, str, buflen);
-    return s;
-}
+static OFReadWriteLock DB_ThreadLock;
+static OFMutex DB_FilenameMutex;
+#endif
+
+/* ========================= static functions ========================= */
 
 /************
-**      Add UID in Index Record to the UID found list
+**      Create the key of an Index Record in the UID found table,
+**      i.e. the UIDs down to the query level separated by backslashes
  */
 
-static void DB_UIDAddFound (
+static OFString DB_UIDFoundKey (
                 DB_Private_Handle       *phandle,
                 IdxRecord               *idxRec
                 )
 {
-    DB_UidList *plist ;
+    OFString key ;
 
-    plist = (DB_UidList *) malloc (sizeof (DB_UidList)) ;
-    if (plist == NULL) {
-        DCMQRDB_ERROR("DB_UIDAddFound: out of memory");
-        return;
+    if ((int)phandle->queryLevel >= PATIENT_LEVEL)
+        key += idxRec->PatientID ;
+    if ((int)phandle->queryLevel >= STUDY_LEVEL) {
+        key += '\\' ;
+        key += idxRec->StudyInstanceUID ;
+    }
+    if ((int)phandle->queryLevel >= SERIE_LEVEL) {
+        key += '\\' ;
+        key += idxRec->SeriesInstanceUID ;
+    }
+    if ((int)phandle->queryLevel >= IMAGE_LEVEL) {
+        key += '\\' ;
+        key += idxRec->SOPInstanceUID ;
     }
-    plist->next = phandle->uidList ;
-    plist->patient = NULL ;
-    plist->study = NULL ;
-    plist->serie = NULL ;
-    plist->image = NULL ;
+    return key ;
+}
 
-    if ((int)phandle->queryLevel >= PATIENT_LEVEL)
-        plist->patient = DB_strdup ((char *) idxRec->PatientID) ;
-    if ((int)phandle->queryLevel >= STUDY_LEVEL)
-        plist->study = DB_strdup ((char *) idxRec->StudyInstanceUID) ;
-    if ((int)phandle->queryLevel >= SERIE_LEVEL)
-        plist->serie = DB_strdup ((char *) idxRec->SeriesInstanceUID) ;
-    if ((int)phandle->queryLevel >= IMAGE_LEVEL)
-        plist->image = DB_strdup ((char *) idxRec->SOPInstanceUID) ;
+/************
+**      Add UID in Index Record to the UID found table
+ */
 
-    phandle->uidList = plist ;
+static void DB_UIDAddFound (
+                DB_Private_Handle       *phandle,
+                IdxRecord               *idxRec
+                )
+{
+    phandle->uidTable.insert (DB_UIDFoundKey (phandle, idxRec)) ;
 }
 
 
@@ -153,28 +181,7 @@ static int DB_UIDAlreadyFound (
                 IdxRecord               *idxRec
                 )
 {
-    DB_UidList *plist ;
-
-    for (plist = phandle->uidList ; plist ; plist = plist->next) {
-        if (  ((int)phandle->queryLevel >= PATIENT_LEVEL)
-              && (strcmp (plist->patient, (char *) idxRec->PatientID) != 0)
-            )
-            continue ;
-        if (  ((int)phandle->queryLevel >= STUDY_LEVEL)
-              && (strcmp (plist->study, (char *) idxRec->StudyInstanceUID) != 0)
-            )
-            continue ;
-        if (  ((int)phandle->queryLevel >= SERIE_LEVEL)
-              && (strcmp (plist->serie, (char *) idxRec->SeriesInstanceUID) != 0)
-            )
-            continue ;
-        if (  ((int)phandle->queryLevel >= IMAGE_LEVEL)
-              && (strcmp (plist->image, (char *) idxRec->SOPInstanceUID) != 0)
-            )
-            continue ;
-        return (OFTrue) ;
-    }
-    return (OFFalse) ;
+    return phandle->uidTable.contains (DB_UIDFoundKey (phandle, idxRec)) ;
 }
 
 /************
@@ -392,10 +399,10 @@ static long DB_lseek(int fildes, long offset, int whence)
 
     /*
     ** print an alert if we are seeking to far
-    ** what is the limit? We don't expect the index file to be
-    ** larger than 32Mb
+    ** what is the limit? With compact records, we don't expect the
+    ** index file (or the string pool file) to be larger than 1Gb
     */
-    const long maxFileSize = 33554432;
+    const long maxFileSize = 1073741824L;
     if (pos > maxFileSize) {
         DCMQRDB_ERROR("*** DB ALERT: attempt to seek beyond " << maxFileSize << " bytes");
     }
@@ -412,72 +419,463 @@ static long DB_lseek(int fildes, long offset, int whence)
 }
 
 /******************************
- *      Read an Index record
+ *      Position of an Index record in the index file
  */
 
-OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxRead (int idx, IdxRecord *idxRec)
+static size_t DB_IdxOffset(int idx)
 {
+    return DBHEADERSIZE + SIZEOF_STUDYDESC + OFstatic_cast(size_t, idx) * SIZEOF_COMPACTRECORD;
+}
 
-    /*** Goto the right index in file
-    **/
+#ifdef DB_MAP_INDEX_FILE
 
-    DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC + idx * SIZEOF_IDXRECORD), SEEK_SET) ;
+/* position of the string pool offset of the filename within an Index record,
+ * used to check whether a record is in use without copying it
+ */
+#define DB_FILENAME_OFFSET (offsetof(DB_CompactRecord, strings))
 
-    /*** Read the record
-    **/
+/******************************
+ *      Unmap the index file
+ */
 
-    if (read (handle_ -> pidx, (char *) idxRec, SIZEOF_IDXRECORD) != SIZEOF_IDXRECORD)
-        return (QR_EC_IndexDatabaseError) ;
+static void DB_UnmapIndexFile(DB_Private_Handle *phandle)
+{
+    if (phandle -> mappedIndex != NULL)
+        munmap(phandle -> mappedIndex, phandle -> mappedSize) ;
+    phandle -> mappedIndex = NULL ;
+    phandle -> mappedSize = 0 ;
+}
 
-    DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET) ;
+/******************************
+ *      (Re-)Map the index file with its current size
+ *
+ * Other processes only append records to the index file and never truncate
+ * it, so an existing mapping remains valid and only has to be extended if a
+ * record beyond its end is accessed. The file is still modified by write(),
+ * which is coherent with shared mappings on all systems providing mmap().
+ * If the file cannot be mapped, mapping is disabled for this handle and the
+ * index file is accessed by read() again.
+ */
 
-    /*** Initialize record links
-    **/
+static void DB_RemapIndexFile(DB_Private_Handle *phandle)
+{
+    struct stat stat_buf ;
+    if (fstat(phandle -> pidx, &stat_buf) < 0) {
+        DCMQRDB_WARN("DB_RemapIndexFile: cannot determine size of index file: "
+            << OFStandard::getLastSystemErrorCode().message());
+        DB_UnmapIndexFile(phandle) ;
+        phandle -> mappingEnabled = OFFalse ;
+        return ;
+    }
+    const size_t fileSize = OFstatic_cast(size_t, stat_buf.st_size) ;
+    if (fileSize == phandle -> mappedSize)
+        return ;
+    DB_UnmapIndexFile(phandle) ;
+    if (fileSize == 0)
+        return ;
+    void *addr = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, phandle -> pidx, 0) ;
+    if (addr == MAP_FAILED) {
+        DCMQRDB_WARN("DB_RemapIndexFile: cannot map index file, using read() instead: "
+            << OFStandard::getLastSystemErrorCode().message());
+        phandle -> mappingEnabled = OFFalse ;
+        return ;
+    }
+    phandle -> mappedIndex = OFstatic_cast(char *, addr) ;
+    phandle -> mappedSize = fileSize ;
+}
+
+/******************************
+ *      Get the address of a range of the index file in the mapping
+ *      Returns NULL if the range is beyond the end of file or if mapping
+ *      has been disabled.
+ */
+
+static const char *DB_MapRange(DB_Private_Handle *phandle, size_t offset, size_t size)
+{
+    if (offset + size > phandle -> mappedSize)
+        DB_RemapIndexFile(phandle) ;
+    if (!phandle -> mappingEnabled || (offset + size > phandle -> mappedSize))
+        return NULL ;
+    return phandle -> mappedIndex + offset ;
+}
+
+#endif
+
+/******************************
+ *      Open the string pool file of a storage area
+ *      Creates the file if it does not exist yet. Must be called while the
+ *      index file is locked exclusively.
+ */
+
+static OFCondition DB_OpenStringPool(DB_Private_Handle *phandle)
+{
+    char poolFilename[DBC_MAXSTRING+1] ;
+    OFStandard::snprintf(poolFilename, sizeof(poolFilename), "%s%c%s", phandle -> storageArea, PATH_SEPARATOR, DBSTRINGPOOLFILE) ;
 
-    DB_IdxInitRecord (idxRec, 1) ;
+    /* create string pool file if it does not already exist */
+    FILE* f = fopen(poolFilename, "ab") ;
+    if (f != NULL) {
+        fclose(f) ;
+#ifdef O_BINARY
+        phandle -> pstr = open(poolFilename, O_RDWR | O_BINARY ) ;
+#else
+        phandle -> pstr = open(poolFilename, O_RDWR ) ;
+#endif
+    }
+    if (phandle -> pstr == (-1)) {
+        DCMQRDB_ERROR(poolFilename << ": " << OFStandard::getLastSystemErrorCode().message()) ;
+        return QR_EC_IndexDatabaseError ;
+    }
+
+    char header[DBHEADERSIZE+1] = {} ;
+    if (DB_lseek(phandle -> pstr, 0L, SEEK_END) == 0) {
+        /* new file, write magic word and version number */
+        OFStandard::snprintf(header, sizeof(header), DBSTRINGPOOLMAGIC "%.2X", DBVERSION) ;
+        if (write(phandle -> pstr, header, DBHEADERSIZE) != DBHEADERSIZE) {
+            DCMQRDB_ERROR(poolFilename << ": " << OFStandard::getLastSystemErrorCode().message()) ;
+            return QR_EC_IndexDatabaseError ;
+        }
+    } else {
+        unsigned int version = 0 ;
+        DB_lseek(phandle -> pstr, 0L, SEEK_SET) ;
+        if
+        (
+            read(phandle -> pstr, header, DBHEADERSIZE) != DBHEADERSIZE               ||
+            strncmp(header, DBSTRINGPOOLMAGIC, strlen(DBSTRINGPOOLMAGIC)) != 0        ||
+            sscanf(header + strlen(DBSTRINGPOOLMAGIC), "%x", &version) != 1           ||
+            version != DBVERSION
+        )
+        {
+            DCMQRDB_ERROR(poolFilename << ": invalid/unsupported string pool file") ;
+            return QR_EC_IndexDatabaseError ;
+        }
+    }
     return EC_Normal ;
 }
 
+/******************************
+ *      Release the (mapped or buffered) contents of the string pool file
+ */
+
+static void DB_ReleaseStringPool(DB_Private_Handle *phandle)
+{
+#ifdef DB_MAP_INDEX_FILE
+    if (phandle -> poolMapped)
+        munmap(phandle -> poolData, phandle -> poolSize) ;
+    else
+#endif
+        free(phandle -> poolData) ;
+    phandle -> poolData = NULL ;
+    phandle -> poolSize = 0 ;
+    phandle -> poolMapped = OFFalse ;
+}
 
 /******************************
- *      Add an Index record
- *      Returns the index allocated for this record
+ *      Bring the contents of the string pool file up to date
+ *
+ * The string pool file is only appended to, so strings that have already
+ * been read remain valid and only the strings appended by other processes
+ * have to be added: The file is mapped again with its new size or, if the
+ * file cannot be mapped, the new part is read into the buffer.
  */
 
-static OFCondition DB_IdxAdd (DB_Private_Handle *phandle, int *idx, IdxRecord *idxRec)
+static OFCondition DB_UpdateStringPool(DB_Private_Handle *phandle)
 {
-    IdxRecord   rec ;
-    OFCondition cond = EC_Normal;
+    struct stat stat_buf ;
+    if (fstat(phandle -> pstr, &stat_buf) < 0) {
+        DCMQRDB_ERROR("DB_UpdateStringPool: cannot determine size of string pool file: "
+            << OFStandard::getLastSystemErrorCode().message()) ;
+        return QR_EC_IndexDatabaseError ;
+    }
+    const size_t fileSize = OFstatic_cast(size_t, stat_buf.st_size) ;
+    if (fileSize <= phandle -> poolSize)
+        return EC_Normal ;
 
-    /*** Find free place for the record
-    *** A place is free if filename is empty
-    **/
+#ifdef DB_MAP_INDEX_FILE
+    if (phandle -> poolMapped || (phandle -> mappingEnabled && (phandle -> poolData == NULL))) {
+        void *addr = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, phandle -> pstr, 0) ;
+        DB_ReleaseStringPool(phandle) ;
+        if (addr != MAP_FAILED) {
+            phandle -> poolData = OFstatic_cast(char *, addr) ;
+            phandle -> poolSize = fileSize ;
+            phandle -> poolMapped = OFTrue ;
+            return EC_Normal ;
+        }
+        DCMQRDB_WARN("DB_UpdateStringPool: cannot map string pool file, using read() instead: "
+            << OFStandard::getLastSystemErrorCode().message()) ;
+    }
+#endif
 
-    *idx = 0 ;
+    char *data = OFstatic_cast(char *, realloc(phandle -> poolData, fileSize)) ;
+    if (data == NULL) {
+        DCMQRDB_ERROR("DB_UpdateStringPool: out of memory") ;
+        return QR_EC_IndexDatabaseError ;
+    }
+    phandle -> poolData = data ;
+    const size_t length = fileSize - phandle -> poolSize ;
+    if ((DB_lseek(phandle -> pstr, OFstatic_cast(long, phandle -> poolSize), SEEK_SET) < 0) ||
+        (OFstatic_cast(size_t, read(phandle -> pstr, data + phandle -> poolSize, length)) != length)) {
+        DCMQRDB_ERROR("DB_UpdateStringPool: cannot read string pool file") ;
+        return QR_EC_IndexDatabaseError ;
+    }
+    phandle -> poolSize = fileSize ;
+    return EC_Normal ;
+}
 
-    DB_lseek (phandle -> pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC), SEEK_SET) ;
-    while (read (phandle -> pidx, (char *) &rec, SIZEOF_IDXRECORD) == SIZEOF_IDXRECORD) {
-        if (rec. filename [0] == '\0')
-            break ;
-        (*idx)++ ;
+/******************************
+ *      Get a string from the string pool file
+ *      Returns NULL if the offset does not refer to a valid string
+ */
+
+static const char *DB_GetPoolString(DB_Private_Handle *phandle, Uint32 offset)
+{
+    if (offset == 0)
+        return "" ;
+    if ((offset >= phandle -> poolSize) && DB_UpdateStringPool(phandle).bad())
+        return NULL ;
+    if ((offset < DBHEADERSIZE) || (offset >= phandle -> poolSize) ||
+        (memchr(phandle -> poolData + offset, 0, phandle -> poolSize - offset) == NULL))
+        return NULL ;
+    return phandle -> poolData + offset ;
+}
+
+/******************************
+ *      Access the string values of an Index record in the order of
+ *      DB_CompactRecord::strings
+ */
+
+/* position of the first parameter value in DB_CompactRecord::strings */
+#define DB_FIRST_PARAM_STRING 3
+
+static const char *DB_GetRecordString(const IdxRecord *idxRec, int i)
+{
+    switch (i) {
+        case 0:
+            return idxRec -> filename ;
+        case 1:
+            return idxRec -> SOPClassUID ;
+        case 2:
+            return idxRec -> InstanceDescription ;
+    }
+    const char *value = idxRec -> param[i - DB_FIRST_PARAM_STRING]. PValueField ;
+    return (value != NULL) ? value : "" ;
+}
+
+static char *DB_GetRecordBuffer(IdxRecord *idxRec, int i, size_t *size)
+{
+    switch (i) {
+        case 0:
+            *size = sizeof(idxRec -> filename) ;
+            return idxRec -> filename ;
+        case 1:
+            *size = sizeof(idxRec -> SOPClassUID) ;
+            return idxRec -> SOPClassUID ;
+        case 2:
+            *size = sizeof(idxRec -> InstanceDescription) ;
+            return idxRec -> InstanceDescription ;
     }
+    /* DB_IdxInitRecord() sets the value length to the maximum length */
+    *size = OFstatic_cast(size_t, idxRec -> param[i - DB_FIRST_PARAM_STRING]. ValueLength) + 1 ;
+    return idxRec -> param[i - DB_FIRST_PARAM_STRING]. PValueField ;
+}
 
-    /*** We have either found a free place or we are at the end of file. **/
+/******************************
+ *      Read a compact record from the index file
+ */
 
+static OFCondition DB_ReadCompactRecord(DB_Private_Handle *phandle, int idx, DB_CompactRecord *crec)
+{
 
-    DB_lseek (phandle -> pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC + (*idx) * SIZEOF_IDXRECORD), SEEK_SET) ;
+#ifdef DB_MAP_INDEX_FILE
+    if (phandle -> mappingEnabled) {
+        const char *record = DB_MapRange (phandle, DB_IdxOffset (idx), SIZEOF_COMPACTRECORD) ;
+        if (record != NULL) {
+            memcpy ((char *) crec, record, SIZEOF_COMPACTRECORD) ;
+            return EC_Normal ;
+        }
+        if (phandle -> mappingEnabled)
+            return (QR_EC_IndexDatabaseError) ;
+    }
+#endif
 
-    if (write (phandle -> pidx, (char *) idxRec, SIZEOF_IDXRECORD) != SIZEOF_IDXRECORD)
+    OFCondition cond = EC_Normal ;
+    DB_lseek (phandle -> pidx, OFstatic_cast(long, DB_IdxOffset (idx)), SEEK_SET) ;
+    if (read (phandle -> pidx, (char *) crec, SIZEOF_COMPACTRECORD) != SIZEOF_COMPACTRECORD)
         cond = QR_EC_IndexDatabaseError ;
-    else
-        cond = EC_Normal ;
+    DB_lseek (phandle -> pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET) ;
+    return cond ;
+}
 
+/******************************
+ *      Write a compact record to the index file
+ */
+
+static OFCondition DB_WriteCompactRecord(DB_Private_Handle *phandle, int idx, const DB_CompactRecord *crec)
+{
+    OFCondition cond = EC_Normal ;
+    DB_lseek (phandle -> pidx, OFstatic_cast(long, DB_IdxOffset (idx)), SEEK_SET) ;
+    if (write (phandle -> pidx, (const char *) crec, SIZEOF_COMPACTRECORD) != SIZEOF_COMPACTRECORD)
+        cond = QR_EC_IndexDatabaseError ;
     DB_lseek (phandle -> pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET) ;
+    return cond ;
+}
+
+/******************************
+ *      Check whether a record of the index file is in use
+ *      Returns an error if the record is beyond the end of file
+ */
+
+static OFCondition DB_IdxInUse(DB_Private_Handle *phandle, int idx, OFBool *inUse)
+{
+
+#ifdef DB_MAP_INDEX_FILE
+    /* only the offset of the filename is copied */
+    if (phandle -> mappingEnabled) {
+        const char *record = DB_MapRange (phandle, DB_IdxOffset (idx), SIZEOF_COMPACTRECORD) ;
+        if (record != NULL) {
+            Uint32 filename ;
+            memcpy ((char *) &filename, record + DB_FILENAME_OFFSET, sizeof(filename)) ;
+            *inUse = (filename != 0) ;
+            return EC_Normal ;
+        }
+        if (phandle -> mappingEnabled)
+            return (QR_EC_IndexDatabaseError) ;
+    }
+#endif
+
+    DB_CompactRecord crec ;
+    OFCondition cond = DB_ReadCompactRecord (phandle, idx, &crec) ;
+    if (cond.good())
+        *inUse = (crec. strings[0] != 0) ;
+    return cond ;
+}
+
+/******************************
+ *      Convert a compact record into an Index record
+ */
+
+static OFCondition DB_IdxDecode(DB_Private_Handle *phandle, const DB_CompactRecord *crec, IdxRecord *idxRec)
+{
+    DB_IdxInitRecord (idxRec, 0) ;
+    idxRec -> RecordedDate = crec -> RecordedDate ;
+    idxRec -> ImageSize = crec -> ImageSize ;
+    idxRec -> hstat = OFstatic_cast(char, crec -> hstat) ;
+
+    size_t size = 0 ;
+    for (int i = 0 ; i < DB_COMPACT_STRINGS ; i++) {
+        const char *value = DB_GetPoolString (phandle, crec -> strings[i]) ;
+        if (value == NULL) {
+            DCMQRDB_ERROR("DB_IdxDecode: invalid reference to string pool file: " << crec -> strings[i]) ;
+            return QR_EC_IndexDatabaseError ;
+        }
+        char *buffer = DB_GetRecordBuffer (idxRec, i, &size) ;
+        OFStandard::strlcpy (buffer, value, size) ;
+    }
+
+    /* as in storeRequest(), the value length is the length of the value */
+    for (int j = 0 ; j < NBPARAMETERS ; j++)
+        idxRec -> param[j]. ValueLength = OFstatic_cast(Uint32, strlen (idxRec -> param[j]. PValueField)) ;
+    return EC_Normal ;
+}
+
+/******************************
+ *      Convert the numeric values of an Index record into a compact
+ *      record with empty strings
+ */
+
+static void DB_IdxEncodeNumbers(const IdxRecord *idxRec, DB_CompactRecord *crec)
+{
+    memset ((char *) crec, 0, SIZEOF_COMPACTRECORD) ;
+    crec -> RecordedDate = idxRec -> RecordedDate ;
+    crec -> ImageSize = idxRec -> ImageSize ;
+    crec -> hstat = OFstatic_cast(Uint32, OFstatic_cast(unsigned char, idxRec -> hstat)) ;
+}
+
+/******************************
+ *      Read an Index record
+ */
 
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxRead (int idx, IdxRecord *idxRec)
+{
+    DB_CompactRecord crec ;
+    OFCondition cond = DB_ReadCompactRecord (handle_, idx, &crec) ;
+    if (cond.good())
+        cond = DB_IdxDecode (handle_, &crec, idxRec) ;
     return cond ;
 }
 
 
+/******************************
+ *      Add an Index record
+ *      Returns the index allocated for this record
+ *      The strings that are equal to those of the record similarIdx (if
+ *      not negative) are shared, all others are appended to the string pool
+ */
+
+static OFCondition DB_IdxAdd (DB_Private_Handle *phandle, int *idx, IdxRecord *idxRec, int similarIdx)
+{
+    DB_CompactRecord    crec ;
+    DB_CompactRecord    similar ;
+    OFVector<char>      strings ;
+    OFBool              inUse = OFTrue ;
+
+    /*** New strings are appended to the end of the string pool file
+    **/
+
+    const long poolEnd = DB_lseek (phandle -> pstr, 0L, SEEK_END) ;
+    if (poolEnd < DBHEADERSIZE)
+        return QR_EC_IndexDatabaseError ;
+
+    const OFBool haveSimilar = (similarIdx >= 0) &&
+        (DB_ReadCompactRecord (phandle, similarIdx, &similar) == EC_Normal) &&
+        (similar. strings[0] != 0) ;
+
+    DB_IdxEncodeNumbers (idxRec, &crec) ;
+    for (int i = 0 ; i < DB_COMPACT_STRINGS ; i++) {
+        const char *value = DB_GetRecordString (idxRec, i) ;
+        if (value[0] == '\0')
+            continue ;
+        if (haveSimilar) {
+            const char *other = DB_GetPoolString (phandle, similar. strings[i]) ;
+            if ((other != NULL) && (strcmp (value, other) == 0)) {
+                crec. strings[i] = similar. strings[i] ;
+                continue ;
+            }
+        }
+        const size_t offset = OFstatic_cast(size_t, poolEnd) + strings. size() ;
+        const size_t length = strlen (value) + 1 ;
+        if (offset + length > 0xFFFFFFFFUL) {
+            DCMQRDB_ERROR("DB_IdxAdd: string pool file too large, use dcmqridx --upgrade to compact it") ;
+            return QR_EC_IndexDatabaseError ;
+        }
+        crec. strings[i] = OFstatic_cast(Uint32, offset) ;
+        for (size_t j = 0 ; j < length ; j++)
+            strings. push_back (value[j]) ;
+    }
+
+    /*** Write the strings before the record referring to them
+    **/
+
+    if (!strings. empty()) {
+        DB_lseek (phandle -> pstr, poolEnd, SEEK_SET) ;
+        if (OFstatic_cast(size_t, write (phandle -> pstr, &strings[0], strings. size())) != strings. size())
+            return QR_EC_IndexDatabaseError ;
+    }
+
+    /*** Find free place for the record
+    *** A place is free if filename is empty
+    **/
+
+    *idx = 0 ;
+    while ((DB_IdxInUse (phandle, *idx, &inUse) == EC_Normal) && inUse)
+        (*idx)++ ;
+
+    /*** We have either found a free place or we are at the end of file. **/
+
+    return DB_WriteCompactRecord (phandle, *idx, &crec) ;
+}
+
+
 /******************************
  *      Change the StudyDescRecord
  */
@@ -510,19 +908,39 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxInitLoop(int *idx)
 
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxGetNext(int *idx, IdxRecord *idxRec)
 {
+    OFBool inUse = OFFalse ;
 
     (*idx)++ ;
-    DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC + OFstatic_cast(long, *idx) * SIZEOF_IDXRECORD), SEEK_SET) ;
-    while (read (handle_ -> pidx, (char *) idxRec, SIZEOF_IDXRECORD) == SIZEOF_IDXRECORD) {
-        if (idxRec -> filename [0] != '\0') {
-            DB_IdxInitRecord (idxRec, 1) ;
 
-            return EC_Normal ;
-        }
+    /* unused records are skipped without decoding them */
+    while (DB_IdxInUse (handle_, *idx, &inUse) == EC_Normal) {
+        if (inUse)
+            return DB_IdxRead (*idx, idxRec) ;
         (*idx)++ ;
     }
 
-    DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET) ;
+    return QR_EC_IndexDatabaseError ;
+}
+
+
+/******************************
+ *      Get next Index record that may match the current query
+ *      On return, idx is initialized with the index of the record read
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxGetNextCandidate(int *idx, IdxRecord *idxRec)
+{
+    if (!handle_ -> useCandidateList)
+        return DB_IdxGetNext (idx, idxRec) ;
+
+    /*** Skip candidates that have been removed in the meantime
+    **/
+
+    while (handle_ -> candidateCounter < handle_ -> candidateList.size()) {
+        *idx = handle_ -> candidateList[handle_ -> candidateCounter++] ;
+        if ((DB_IdxRead (*idx, idxRec) == EC_Normal) && (idxRec -> filename [0] != '\0'))
+            return EC_Normal ;
+    }
 
     return QR_EC_IndexDatabaseError ;
 }
@@ -536,6 +954,18 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxGetNext(int *idx, IdxReco
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_GetStudyDesc (StudyDescRecord *pStudyDesc)
 {
 
+#ifdef DB_MAP_INDEX_FILE
+    if (handle_ -> mappingEnabled) {
+        const char *studyDesc = DB_MapRange (handle_, DBHEADERSIZE, SIZEOF_STUDYDESC) ;
+        if (studyDesc != NULL) {
+            memcpy ((char *) pStudyDesc, studyDesc, SIZEOF_STUDYDESC) ;
+            return EC_Normal ;
+        }
+        if (handle_ -> mappingEnabled)
+            return QR_EC_IndexDatabaseError ;
+    }
+#endif
+
     DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET) ;
     if ( read (handle_ -> pidx, (char *) pStudyDesc, SIZEOF_STUDYDESC) == SIZEOF_STUDYDESC )
         return EC_Normal ;
@@ -553,20 +983,28 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_GetStudyDesc (StudyDescRecor
 
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_IdxRemove(int idx)
 {
-    IdxRecord   rec ;
-    OFCondition cond = EC_Normal;
-
-    DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC + OFstatic_cast(long, idx) * SIZEOF_IDXRECORD), SEEK_SET) ;
-    DB_IdxInitRecord (&rec, 0) ;
-
-    rec. filename [0] = '\0' ;
-    if (write (handle_ -> pidx, (char *) &rec, SIZEOF_IDXRECORD) == SIZEOF_IDXRECORD)
-        cond = EC_Normal ;
-    else
-        cond = QR_EC_IndexDatabaseError ;
-
-    DB_lseek (handle_ -> pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET) ;
+    DB_CompactRecord crec ;
+    IdxRecord idxRec ;
 
+    /* the summary index is updated along with the index file, unless the
+     * caller already takes care of this
+     */
+    const OFBool ownUpdate = !summaryIndex_->isUpdating() ;
+    if (ownUpdate) {
+        summaryIndex_->open(OFTrue) ;
+        summaryIndex_->beginUpdate() ;
+    }
+    if (summaryIndex_->isValid() && (DB_IdxRead (idx, &idxRec) == EC_Normal))
+        summaryIndex_->removeRecord (idx, idxRec) ;
+
+    memset ((char *) &crec, 0, SIZEOF_COMPACTRECORD) ;
+    OFCondition cond = DB_WriteCompactRecord (handle_, idx, &crec) ;
+    if (cond.bad())
+        summaryIndex_->cancelUpdate() ;
+    if (ownUpdate) {
+        summaryIndex_->endUpdate() ;
+        summaryIndex_->close() ;
+    }
     return cond ;
 }
 
@@ -579,8 +1017,19 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_lock(OFBool exclusive)
     } else {
         lockmode = LOCK_SH;     /* shared lock */
     }
+#ifdef WITH_THREADS
+    /* a lock held by this handle cannot be converted, release it first */
+    if (handle_->lockMode == LOCK_EX) DB_ThreadLock.wrunlock();
+    else if (handle_->lockMode == LOCK_SH) DB_ThreadLock.rdunlock();
+    if (exclusive) DB_ThreadLock.wrlock(); else DB_ThreadLock.rdlock();
+#endif
+    handle_->lockMode = lockmode;
     if (dcmtk_flock(handle_->pidx, lockmode) < 0) {
         dcmtk_plockerr("DB_lock");
+#ifdef WITH_THREADS
+        if (exclusive) DB_ThreadLock.wrunlock(); else DB_ThreadLock.rdunlock();
+#endif
+        handle_->lockMode = 0;
         return QR_EC_IndexDatabaseError;
     }
     return EC_Normal;
@@ -588,6 +1037,11 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_lock(OFBool exclusive)
 
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_unlock()
 {
+#ifdef WITH_THREADS
+    if (handle_->lockMode == LOCK_EX) DB_ThreadLock.wrunlock();
+    else if (handle_->lockMode == LOCK_SH) DB_ThreadLock.rdunlock();
+#endif
+    handle_->lockMode = 0;
     if (dcmtk_flock(handle_->pidx, LOCK_UN) < 0) {
         dcmtk_plockerr("DB_unlock");
         return QR_EC_IndexDatabaseError;
@@ -599,30 +1053,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::DB_unlock()
  *    Free an element List
  */
 
-static OFCondition DB_FreeUidList (DB_UidList *lst)
-{
-    while (lst != NULL) {
-        if (lst -> patient)
-            free (lst -> patient);
-        if (lst -> study)
-            free (lst -> study);
-        if (lst -> serie)
-            free (lst -> serie);
-        if (lst -> image)
-            free (lst -> image);
-        DB_UidList *curlst = lst;
-        lst = lst->next;
-        free (curlst);
-    }
-    return EC_Normal;
-}
-
-
-/*******************
- *    Free a UID List
- */
-
-static OFCondition DB_FreeElementList (DB_ElementList *lst)
+static OFCondition DB_FreeElementList (DB_ElementList *lst)
 {
     if (lst == NULL) return EC_Normal;
 
@@ -973,6 +1404,7 @@ void DcmQueryRetrieveIndexDatabaseHandle::makeResponseList (
     DB_ElementList *pRequestList = NULL;
     DB_ElementList *plist = NULL;
     DB_ElementList *last = NULL;
+    OFString aggregate ;
 
     phandle->findResponseList = NULL ;
 
@@ -988,10 +1420,11 @@ void DcmQueryRetrieveIndexDatabaseHandle::makeResponseList (
             if (idxRec->param [i]. XTag == pRequestList->elem. XTag)
                 break ;
 
-        /*** If Tag not found, skip the element
+        /*** If Tag not found, it may be provided by the summary index,
+        *** otherwise skip the element
         **/
 
-        if (i >= NBPARAMETERS)
+        if ((i >= NBPARAMETERS) && !getAggregateValue (pRequestList->elem. XTag, idxRec, aggregate))
             continue ;
 
         /*** Append index record element to response list
@@ -1003,7 +1436,15 @@ void DcmQueryRetrieveIndexDatabaseHandle::makeResponseList (
             return;
         }
 
-        DB_DuplicateElement(&idxRec->param[i], &plist->elem);
+        if (i < NBPARAMETERS)
+            DB_DuplicateElement(&idxRec->param[i], &plist->elem);
+        else {
+            DB_SmallDcmElmt elem ;
+            elem. XTag = pRequestList->elem. XTag ;
+            elem. ValueLength = OFstatic_cast(Uint32, aggregate.length()) ;
+            elem. PValueField = OFconst_cast(char *, aggregate.c_str()) ;
+            DB_DuplicateElement(&elem, &plist->elem);
+        }
 
         if (phandle->findResponseList == NULL) {
             phandle->findResponseList = last = plist ;
@@ -1290,6 +1731,18 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::hierarchicalCompare (
                 if (idxRec->param [i]. XTag == plist->elem. XTag)
                     break ;
 
+            /** Keys not stored in the index record are compared
+            ** using the summary index (if at all)
+            */
+
+            if (i >= NBPARAMETERS) {
+                if (!matchAggregateKey(plist, idxRec)) {
+                    *match = OFFalse ;
+                    return EC_Normal ;
+                }
+                continue ;
+            }
+
             /** Compare with appropriate Matching.
             ** If Match fails, return OFFalse
             */
@@ -1312,6 +1765,281 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::hierarchicalCompare (
     return QR_EC_IndexDatabaseError;
 }
 
+/********************
+**      Determine candidate records using the secondary index
+**/
+
+void DcmQueryRetrieveIndexDatabaseHandle::selectCandidates(DB_LEVEL infLevel)
+{
+    OFList<DcmQueryRetrieveSecondaryIndex::QueryKey> keys ;
+    DB_ElementList *plist ;
+    DcmTagKey   XTag ;
+    DB_LEVEL    XTagLevel = PATIENT_LEVEL ;
+
+    handle_->useCandidateList = OFFalse ;
+    handle_->candidateList.clear() ;
+    handle_->candidateCounter = 0 ;
+
+    if (handle_->queryLevel < infLevel)
+        return ;
+
+    /**** Collect the keys compared by hierarchicalCompare(), i.e. the unique
+    **** keys of the levels above the query level ...
+    ***/
+
+    for (int level = infLevel ; level < handle_->queryLevel ; level++) {
+        DB_GetUIDTag (OFstatic_cast(DB_LEVEL, level), &XTag) ;
+        for (plist = handle_->findRequestList ; plist ; plist = plist->next)
+            if (plist->elem. XTag == XTag)
+                break ;
+        /* hierarchicalCompare() reports the missing key */
+        if (plist == NULL)
+            return ;
+        if (plist->elem. ValueLength > 0)
+            keys.push_back(DcmQueryRetrieveSecondaryIndex::QueryKey(XTag,
+                OFString(plist->elem. PValueField, plist->elem. ValueLength))) ;
+    }
+
+    /**** ... and the keys of the query level
+    ***/
+
+    for (plist = handle_->findRequestList ; plist ; plist = plist->next) {
+        if ((plist->elem. ValueLength == 0) || !DcmQueryRetrieveSecondaryIndex::isIndexedKey(plist->elem. XTag))
+            continue ;
+        DB_GetTagLevel (plist->elem. XTag, &XTagLevel) ;
+        if ((XTagLevel == handle_->queryLevel) ||
+            ((XTagLevel == PATIENT_LEVEL) && (handle_->queryLevel == STUDY_LEVEL) && (infLevel == STUDY_LEVEL)))
+            keys.push_back(DcmQueryRetrieveSecondaryIndex::QueryKey(plist->elem. XTag,
+                OFString(plist->elem. PValueField, plist->elem. ValueLength))) ;
+    }
+
+    if (!keys.empty() && secondaryIndex_->open(OFFalse)) {
+        handle_->useCandidateList = secondaryIndex_->findCandidates(keys, handle_->candidateList) ;
+        secondaryIndex_->close() ;
+    }
+}
+
+/********************
+**      Search records of a SOP instance or study using the secondary index
+**/
+
+OFBool DcmQueryRetrieveIndexDatabaseHandle::findUIDCandidates(const DcmTagKey& tag, const char *uid, OFVector<Sint32>& candidates)
+{
+    OFList<DcmQueryRetrieveSecondaryIndex::QueryKey> keys ;
+    keys.push_back(DcmQueryRetrieveSecondaryIndex::QueryKey(tag, uid)) ;
+
+    /* the index file may already be open for an update */
+    if (secondaryIndex_->isValid())
+        return secondaryIndex_->findCandidates(keys, candidates) ;
+
+    OFBool result = OFFalse ;
+    if (secondaryIndex_->open(OFFalse)) {
+        result = secondaryIndex_->findCandidates(keys, candidates) ;
+        secondaryIndex_->close() ;
+    }
+    return result ;
+}
+
+/********************
+**      Search a record of the same series or study using the secondary index
+**/
+
+int DcmQueryRetrieveIndexDatabaseHandle::findSimilarRecord(const IdxRecord *idxRec)
+{
+    const DcmTagKey tags[2] = { DCM_SeriesInstanceUID, DCM_StudyInstanceUID } ;
+    const char *values[2] = { idxRec->SeriesInstanceUID, idxRec->StudyInstanceUID } ;
+
+    for (int i = 0 ; i < 2 ; i++) {
+        if (values[i][0] == '\0')
+            continue ;
+        OFList<DcmQueryRetrieveSecondaryIndex::QueryKey> keys ;
+        OFVector<Sint32> candidates ;
+        keys.push_back(DcmQueryRetrieveSecondaryIndex::QueryKey(tags[i], values[i])) ;
+        /* the candidate with the highest record number was most likely added last */
+        if (secondaryIndex_->findCandidates(keys, candidates) && !candidates.empty())
+            return candidates.back() ;
+    }
+    return -1 ;
+}
+
+/********************
+**      Use the records representing studies or series as candidates
+**/
+
+void DcmQueryRetrieveIndexDatabaseHandle::selectSummaryCandidates()
+{
+    OFVector<OFString> studyUIDs ;
+    OFVector<Sint32> candidates ;
+    DB_ElementList *plist ;
+
+    /* the summary is also needed for the aggregate keys of the responses */
+    const OFBool valid = summaryIndex_->open(OFFalse) ;
+    summaryIndex_->close() ;
+    if (!valid || ((handle_->queryLevel != STUDY_LEVEL) && (handle_->queryLevel != SERIE_LEVEL)))
+        return ;
+
+    /**** Only the representative record of each study or series is compared,
+    **** so all other keys must be empty. Otherwise, a study or series would
+    **** not be found if the key matches another one of its records. The
+    **** Patient ID is the same for all records of a study, and it is the
+    **** unique key of the patient level in the Patient Root model.
+    ***/
+
+    for (plist = handle_->findRequestList ; plist ; plist = plist->next) {
+        if ((plist->elem. ValueLength == 0) ||
+            (plist->elem. XTag == DCM_PatientID) ||
+            (plist->elem. XTag == DCM_StudyInstanceUID) ||
+            (plist->elem. XTag == DCM_SeriesInstanceUID) ||
+            (plist->elem. XTag == DCM_ModalitiesInStudy) ||
+            (plist->elem. XTag == DCM_SpecificCharacterSet))
+            continue ;
+        /* a single asterisk matches any value */
+        if ((plist->elem. ValueLength == 1) && (plist->elem. PValueField[0] == '*'))
+            continue ;
+        return ;
+    }
+
+    /**** At series level, only the series of the studies given by the
+    **** unique key of the study level are candidates
+    ***/
+
+    if (handle_->queryLevel == SERIE_LEVEL) {
+        for (plist = handle_->findRequestList ; plist ; plist = plist->next)
+            if (plist->elem. XTag == DCM_StudyInstanceUID)
+                break ;
+        if ((plist != NULL) && (plist->elem. ValueLength > 0)) {
+            const OFString value(plist->elem. PValueField, plist->elem. ValueLength) ;
+            size_t pos = 0 ;
+            while (pos <= value.length()) {
+                size_t end = value.find('\\', pos) ;
+                if (end == OFString_npos)
+                    end = value.length() ;
+                const char *first = value.c_str() + pos ;
+                const char *last = value.c_str() + end ;
+                OFStandard::trimString(first, last) ;
+                studyUIDs.push_back(OFString(first, last - first)) ;
+                pos = end + 1 ;
+            }
+        }
+    }
+
+    /* e.g. the record representing a study or series has been removed */
+    if (!summaryIndex_->getRepresentatives(handle_->queryLevel == SERIE_LEVEL, studyUIDs, candidates))
+        return ;
+
+    /* the secondary index may yield fewer candidates, e.g. for a given patient */
+    if (handle_->useCandidateList && (handle_->candidateList.size() <= candidates.size()))
+        return ;
+
+    DCMQRDB_DEBUG("using " << candidates.size() << " records of the summary index file as candidates");
+    handle_->candidateList.swap(candidates) ;
+    handle_->candidateCounter = 0 ;
+    handle_->useCandidateList = OFTrue ;
+}
+
+/********************
+**      Compare a key that is not stored in the index records
+**/
+
+OFBool DcmQueryRetrieveIndexDatabaseHandle::matchAggregateKey(DB_ElementList *plist, const IdxRecord *idxRec)
+{
+    /* the number of related series and instances are return keys only,
+     * other keys that are not stored are not supported for matching
+     */
+    if ((plist->elem. ValueLength == 0) || !(plist->elem. XTag == DCM_ModalitiesInStudy))
+        return OFTrue ;
+
+    /* without the summary, all records of the study are compared, i.e. the
+     * study matches if the modality of any of its records matches
+     */
+    OFString modalities (idxRec->Modality) ;
+    const DB_SummaryRecord *study = summaryIndex_->findStudy (idxRec->StudyInstanceUID) ;
+    if (study != NULL)
+        modalities = study->Modality ;
+
+    /* the key matches if any query value matches any of the modalities */
+    const OFString query (plist->elem. PValueField, plist->elem. ValueLength) ;
+    size_t qpos = 0 ;
+    while (qpos <= query.length()) {
+        size_t qend = query.find('\\', qpos) ;
+        if (qend == OFString_npos)
+            qend = query.length() ;
+        const char *qfirst = query.c_str() + qpos ;
+        const char *qlast = query.c_str() + qend ;
+        OFStandard::trimString(qfirst, qlast) ;
+        size_t mpos = 0 ;
+        while (mpos < modalities.length()) {
+            size_t mend = modalities.find('\\', mpos) ;
+            if (mend == OFString_npos)
+                mend = modalities.length() ;
+            const char *mfirst = modalities.c_str() + mpos ;
+            const char *mlast = modalities.c_str() + mend ;
+            OFStandard::trimString(mfirst, mlast) ;
+            if (DcmAttributeMatching::wildCardMatching(qfirst, qlast - qfirst, mfirst, mlast - mfirst))
+                return OFTrue ;
+            mpos = mend + 1 ;
+        }
+        qpos = qend + 1 ;
+    }
+    return OFFalse ;
+}
+
+/********************
+**      Determine the value of a key provided by the summary index
+**/
+
+OFBool DcmQueryRetrieveIndexDatabaseHandle::getAggregateValue(const DcmTagKey& tag, const IdxRecord *idxRec, OFString& value)
+{
+    const DB_SummaryRecord *summary = NULL ;
+    char buf[32] ;
+
+    value.clear() ;
+    if (tag == DCM_NumberOfSeriesRelatedInstances) {
+        summary = summaryIndex_->findSeries (idxRec->SeriesInstanceUID) ;
+        if (summary != NULL) {
+            OFStandard::snprintf(buf, sizeof(buf), "%lu", OFstatic_cast(unsigned long, summary->numberOfInstances)) ;
+            value = buf ;
+        }
+    }
+    else if ((tag == DCM_NumberOfStudyRelatedSeries) || (tag == DCM_NumberOfStudyRelatedInstances) ||
+             (tag == DCM_ModalitiesInStudy)) {
+        summary = summaryIndex_->findStudy (idxRec->StudyInstanceUID) ;
+        if (summary == NULL)
+            return OFTrue ;
+        if (tag == DCM_ModalitiesInStudy)
+            value = summary->Modality ;
+        else {
+            OFStandard::snprintf(buf, sizeof(buf), "%lu", OFstatic_cast(unsigned long,
+                (tag == DCM_NumberOfStudyRelatedSeries) ? summary->numberOfSeries : summary->numberOfInstances)) ;
+            value = buf ;
+        }
+    }
+    else
+        return OFFalse ;
+    return OFTrue ;
+}
+
+/********************
+**      Begin and finish an update of the summary index
+**/
+
+void DcmQueryRetrieveIndexDatabaseHandle::beginSummaryUpdate()
+{
+    /* failures are handled by endSummaryUpdate() */
+    summaryIndex_->open(OFTrue) ;
+    summaryIndex_->beginUpdate() ;
+}
+
+void DcmQueryRetrieveIndexDatabaseHandle::endSummaryUpdate()
+{
+    if (summaryIndex_->endUpdate().bad() || !summaryIndex_->isComplete()) {
+        /* failure is not fatal, queries fall back to comparing all records */
+        if (rebuildSummaryIndex().bad())
+            DCMQRDB_WARN("cannot update summary index file: " << summaryIndex_->getFilename());
+    }
+    summaryIndex_->close() ;
+}
+
 /********************
 **      Start find in Database
 **/
@@ -1494,6 +2222,9 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
 
     DB_lock(OFFalse);
 
+    handle_->uidTable.clear() ;
+    selectCandidates (qLevel) ;
+    selectSummaryCandidates () ;
     DB_IdxInitLoop (&(handle_->idxCounter)) ;
     MatchFound = OFFalse ;
     cond = EC_Normal ;
@@ -1504,7 +2235,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
         /*** Exit loop if read error (or end of file)
         **/
 
-        if (DB_IdxGetNext (&(handle_->idxCounter), &idxRec) != EC_Normal)
+        if (DB_IdxGetNextCandidate (&(handle_->idxCounter), &idxRec) != EC_Normal)
             break ;
 
         /*** Exit loop if error or matching OK
@@ -1550,6 +2281,12 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startFindRequest(
         DCMQRDB_DEBUG("DB_startFindRequest () : STATUS_Pending");
 #endif
         status->setStatus(STATUS_Pending);
+
+        /* the lock is only held while searching the next match, so that
+         * other associations can modify the database in the meantime
+         */
+        DB_unlock();
+
         return (EC_Normal) ;
     }
 
@@ -1602,8 +2339,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
         *findResponseIdentifiers = NULL ;
         status->setStatus(STATUS_Success);
 
-        DB_unlock();
-
         return (EC_Normal) ;
     }
 
@@ -1742,8 +2477,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
 #endif
     } else {
 
-        DB_unlock();
-
         return (QR_EC_IndexDatabaseError) ;
     }
 
@@ -1765,13 +2498,15 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
     MatchFound = OFFalse ;
     cond = EC_Normal ;
 
+    DB_lock(OFFalse);
+
     CharsetConsideringMatcher dbmatch(*handle_);
     while (1) {
 
         /*** Exit loop if read error (or end of file)
         **/
 
-        if (DB_IdxGetNext (&(handle_->idxCounter), &idxRec) != EC_Normal)
+        if (DB_IdxGetNextCandidate (&(handle_->idxCounter), &idxRec) != EC_Normal)
             break ;
 
         /*** If Response already found
@@ -1815,6 +2550,8 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
     ****    prepare Response List in handle
     ***/
 
+    DB_unlock();
+
     if (MatchFound) {
         DB_UIDAddFound (handle_, &idxRec) ;
         makeResponseList (handle_, &idxRec) ;
@@ -1834,8 +2571,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::nextFindResponse (
         handle_->idxCounter = -1 ;
         DB_FreeElementList (handle_->findRequestList) ;
         handle_->findRequestList = NULL ;
-        DB_FreeUidList (handle_->uidList) ;
-        handle_->uidList = NULL ;
+        handle_->uidTable.clear() ;
     }
 
 #ifdef DEBUG
@@ -1857,13 +2593,10 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::cancelFindRequest (DcmQueryRetr
     handle_->findRequestList = NULL ;
     DB_FreeElementList (handle_->findResponseList) ;
     handle_->findResponseList = NULL ;
-    DB_FreeUidList (handle_->uidList) ;
-    handle_->uidList = NULL ;
+    handle_->uidTable.clear() ;
 
     status->setStatus(STATUS_FIND_Cancel_MatchingTerminatedDueToCancelRequest);
 
-    DB_unlock();
-
     return (EC_Normal) ;
 }
 
@@ -2186,13 +2919,14 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::startMoveRequest(
     DB_lock(OFFalse);
 
     CharsetConsideringMatcher dbmatch(*handle_);
+    selectCandidates (qLevel) ;
     DB_IdxInitLoop (&(handle_->idxCounter)) ;
     while (1) {
 
         /*** Exit loop if read error (or end of file)
         **/
 
-        if (DB_IdxGetNext (&(handle_->idxCounter), &idxRec) != EC_Normal)
+        if (DB_IdxGetNextCandidate (&(handle_->idxCounter), &idxRec) != EC_Normal)
             break ;
 
         /*** If matching found
@@ -2387,6 +3121,45 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::deleteImageFile(char* imgFile)
 }
 
 
+/*************************
+**   Collect the records of all images of a study
+ */
+
+void DcmQueryRetrieveIndexDatabaseHandle::findStudyImages(const char *StudyUID, OFVector<ImagesofStudyArray>& images)
+{
+    IdxRecord idxRec ;
+    ImagesofStudyArray image ;
+    OFVector<Sint32> candidates ;
+    int idx ;
+
+    images.clear() ;
+
+    /* only read the records determined by the secondary index, if possible */
+    if (findUIDCandidates(DCM_StudyInstanceUID, StudyUID, candidates)) {
+        for (size_t i = 0 ; i < candidates.size() ; i++) {
+            if ((DB_IdxRead (candidates[i], &idxRec) == EC_Normal) &&
+                (strcmp(idxRec. StudyInstanceUID, StudyUID) == 0)) {
+                image. idxCounter = OFstatic_cast(Uint32, candidates[i]) ;
+                image. RecordedDate = idxRec. RecordedDate ;
+                image. ImageSize = idxRec. ImageSize ;
+                images.push_back(image) ;
+            }
+        }
+        return ;
+    }
+
+    DB_IdxInitLoop (&idx) ;
+    while ( DB_IdxGetNext(&idx, &idxRec) == EC_Normal ) {
+        if (strcmp(idxRec. StudyInstanceUID, StudyUID) == 0) {
+            image. idxCounter = OFstatic_cast(Uint32, idx) ;
+            image. RecordedDate = idxRec. RecordedDate ;
+            image. ImageSize = idxRec. ImageSize ;
+            images.push_back(image) ;
+        }
+    }
+}
+
+
 /*************************
 **   Delete oldest study in database
  */
@@ -2397,9 +3170,8 @@ int DcmQueryRetrieveIndexDatabaseHandle::deleteOldestStudy(StudyDescRecord *pStu
     int oldestStudy ;
     double OldestDate ;
     int s ;
-    size_t n ;
-    int idx = 0 ;
     IdxRecord idxRec ;
+    OFVector<ImagesofStudyArray> images ;
 
     oldestStudy = 0 ;
     OldestDate = 0.0 ;
@@ -2408,6 +3180,7 @@ int DcmQueryRetrieveIndexDatabaseHandle::deleteOldestStudy(StudyDescRecord *pStu
     DCMQRDB_DEBUG("deleteOldestStudy");
 #endif
 
+    /* the study descriptor table is small and already in memory */
     for ( s = 0 ; s < handle_ -> maxStudiesAllowed ; s++ ) {
         if ( ( pStudyDesc[s]. NumberofRegistratedImages != 0 ) &&
             ( ( OldestDate == 0.0 ) || ( pStudyDesc[s]. LastRecordedDate < OldestDate ) ) ) {
@@ -2420,14 +3193,12 @@ int DcmQueryRetrieveIndexDatabaseHandle::deleteOldestStudy(StudyDescRecord *pStu
     DCMQRDB_DEBUG("deleteOldestStudy oldestStudy = " << oldestStudy);
 #endif
 
-    n = strlen(pStudyDesc[oldestStudy].StudyInstanceUID) ;
-    while ( DB_IdxRead (idx, &idxRec) == EC_Normal ) {
-
-    if ( ! ( strncmp(idxRec. StudyInstanceUID, pStudyDesc[oldestStudy].StudyInstanceUID, n) ) ) {
-        DB_IdxRemove (idx) ;
-        deleteImageFile(idxRec.filename);
-    }
-    idx++ ;
+    findStudyImages(pStudyDesc[oldestStudy].StudyInstanceUID, images) ;
+    for (size_t i = 0 ; i < images.size() ; i++) {
+        if (DB_IdxRead (images[i]. idxCounter, &idxRec) == EC_Normal) {
+            DB_IdxRemove (images[i]. idxCounter) ;
+            deleteImageFile(idxRec.filename);
+        }
     }
 
     pStudyDesc[oldestStudy].NumberofRegistratedImages = 0 ;
@@ -2445,45 +3216,28 @@ int DcmQueryRetrieveIndexDatabaseHandle::deleteOldestStudy(StudyDescRecord *pStu
 OFCondition DcmQueryRetrieveIndexDatabaseHandle::deleteOldestImages(StudyDescRecord *pStudyDesc, int StudyNum, char *StudyUID, long RequiredSize)
 {
 
-    ImagesofStudyArray *StudyArray ;
-    IdxRecord idxRec ;
-    int nbimages = 0 , s = 0;
-    size_t n ;
+    OFVector<ImagesofStudyArray> StudyArray ;
+    size_t s = 0 ;
     long DeletedSize ;
 
 #ifdef DEBUG
     DCMQRDB_DEBUG("deleteOldestImages RequiredSize = " << RequiredSize);
 #endif
-    n = strlen(StudyUID) ;
-    StudyArray = (ImagesofStudyArray *)malloc(MAX_NUMBER_OF_IMAGES * sizeof(ImagesofStudyArray)) ;
-
-    if (StudyArray == NULL) {
-        DCMQRDB_WARN("deleteOldestImages: out of memory");
-        return QR_EC_IndexDatabaseError;
-    }
 
     /** Find all images having the same StudyUID
      */
 
-    DB_IdxInitLoop (&(handle_ -> idxCounter)) ;
-    while ( DB_IdxGetNext(&(handle_ -> idxCounter), &idxRec) == EC_Normal ) {
-    if ( ! ( strncmp(idxRec. StudyInstanceUID, StudyUID, n) ) ) {
-
-        StudyArray[nbimages]. idxCounter = handle_ -> idxCounter ;
-        StudyArray[nbimages]. RecordedDate = idxRec. RecordedDate ;
-        StudyArray[nbimages++]. ImageSize = idxRec. ImageSize ;
-    }
-    }
+    findStudyImages(StudyUID, StudyArray) ;
 
     /** Sort the StudyArray in order to have the oldest images first
      */
-    qsort((char *)StudyArray, nbimages, sizeof(ImagesofStudyArray), DB_Compare) ;
+    if (!StudyArray.empty())
+        qsort((char *)&StudyArray[0], StudyArray.size(), sizeof(ImagesofStudyArray), DB_Compare) ;
 
 #ifdef DEBUG
     {
-        int i ;
         DCMQRDB_DEBUG("deleteOldestImages : Sorted images ref array");
-        for (i = 0 ; i < nbimages ; i++)
+        for (size_t i = 0 ; i < StudyArray.size() ; i++)
             DCMQRDB_DEBUG("[" << STD_NAMESPACE setw(2) << i << "] :   Size " << StudyArray[i].ImageSize
                 << "   Date " << STD_NAMESPACE setw(20) << STD_NAMESPACE setprecision(3) << StudyArray[i].RecordedDate
                 << "   Ref " << StudyArray[i].idxCounter);
@@ -2491,10 +3245,9 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::deleteOldestImages(StudyDescRec
     }
 #endif
 
-    s = 0 ;
     DeletedSize = 0 ;
 
-    while ( DeletedSize < RequiredSize ) {
+    while ( ( DeletedSize < RequiredSize ) && ( s < StudyArray.size() ) ) {
 
     IdxRecord idxRemoveRec ;
     DB_IdxRead (StudyArray[s]. idxCounter, &idxRemoveRec) ;
@@ -2512,7 +3265,6 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::deleteOldestImages(StudyDescRec
 #ifdef DEBUG
     DCMQRDB_DEBUG("deleteOldestImages DeletedSize = " << (int)DeletedSize);
 #endif
-    free(StudyArray) ;
     return( EC_Normal ) ;
 
 }
@@ -2628,6 +3380,8 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::removeDuplicateImage(
     int idx = 0;
     IdxRecord idxRec ;
     int studyIdx = 0;
+    OFVector<Sint32> candidates;
+    size_t candidate = 0;
 
     studyIdx = matchStudyUIDInStudyDesc (pStudyDesc, (char*)StudyInstanceUID,
                         (int)(handle_ -> maxStudiesAllowed)) ;
@@ -2637,7 +3391,18 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::removeDuplicateImage(
     return EC_Normal;
     }
 
-    while (DB_IdxRead(idx, &idxRec) == EC_Normal) {
+    /* only check the records determined by the secondary index, if possible */
+    const OFBool useCandidates = findUIDCandidates(DCM_SOPInstanceUID, SOPInstanceUID, candidates);
+
+    while (!useCandidates || (candidate < candidates.size())) {
+
+    if (useCandidates) {
+        idx = candidates[candidate++];
+    }
+    if (DB_IdxRead(idx, &idxRec) != EC_Normal) {
+        if (useCandidates) continue;
+        break;
+    }
 
     if (strcmp(idxRec.SOPInstanceUID, SOPInstanceUID) == 0) {
 
@@ -2664,54 +3429,15 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::removeDuplicateImage(
 
 
 /*************************
-**  Add data from imageFileName to database
+**  Set the values of an Index record from the dataset of an instance
  */
 
-OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
-    const char  *SOPClassUID,
-    const char  * /*SOPInstanceUID*/,
-    const char  *imageFileName,
-    DcmQueryRetrieveDatabaseStatus *status,
-    OFBool      isNew)
+static void DB_IdxSetValues(IdxRecord *idxRec, DcmDataset *dset, const char *SOPClassUID, OFBool isNew)
 {
-    IdxRecord        idxRec ;
-    StudyDescRecord  *pStudyDesc ;
-    int              i ;
-    struct stat      stat_buf ;
-
-    /**** Initialize an IdxRecord
-    ***/
-
-    memset((char*)&idxRec, 0, sizeof(idxRec));
-
-    DB_IdxInitRecord (&idxRec, 0) ;
-
-    strncpy(idxRec.filename, imageFileName, DBC_MAXSTRING);
-#ifdef DEBUG
-    DCMQRDB_DEBUG("DB_storeRequest () : storage request of file : " << idxRec.filename);
-#endif
-    strncpy (idxRec.SOPClassUID, SOPClassUID, UI_MAX_LENGTH);
-
-    /**** Get IdxRec values from ImageFile
-    ***/
-
-    DcmFileFormat dcmff;
-    if (dcmff.loadFile(imageFileName).bad())
-    {
-      DCMQRDB_WARN("DB: Cannot open file: " << imageFileName << ": "
-          << OFStandard::getLastSystemErrorCode().message());
-      status->setStatus(STATUS_STORE_Error_CannotUnderstand);
-      return (QR_EC_IndexDatabaseError) ;
-    }
-
-    DcmDataset *dset = dcmff.getDataset();
-
-    assert(dset);
-
     OFCondition ec;
 
-    for (i = 0 ; i < NBPARAMETERS ; i++ ) {
-        DB_SmallDcmElmt *se = idxRec.param + i;
+    for (int i = 0 ; i < NBPARAMETERS ; i++ ) {
+        DB_SmallDcmElmt *se = idxRec->param + i;
 
         const char *strPtr = NULL;
         ec = dset->findAndGetString(se->XTag, strPtr);
@@ -2728,7 +3454,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
     }
 
     /* InstanceStatus */
-    idxRec.hstat = OFstatic_cast(char, ((isNew) ? DVIF_objectIsNew : DVIF_objectIsNotNew));
+    idxRec->hstat = OFstatic_cast(char, ((isNew) ? DVIF_objectIsNew : DVIF_objectIsNotNew));
 
     /* InstanceDescription */
     OFBool useDescrTag = OFTrue;
@@ -2742,7 +3468,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
             descrTag = DCM_ContentDescription;
         } else if (strcmp(SOPClassUID, UID_RETIRED_HardcopyGrayscaleImageStorage) == 0)
         {
-            OFStandard::strlcpy(idxRec.InstanceDescription, "Hardcopy Grayscale Image", DESCRIPTION_MAX_LENGTH+1);
+            OFStandard::strlcpy(idxRec->InstanceDescription, "Hardcopy Grayscale Image", DESCRIPTION_MAX_LENGTH+1);
             useDescrTag = OFFalse;
         } else if (dcmGetPropertiesOfUID(SOPClassUID, properties) && (properties.uidType == EUT_SOPClass) &&
             (properties.subType == EUST_Storage) && (properties.iodType == EUIT_StructuredReport))
@@ -2768,11 +3494,11 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
                 description += ", ";
                 description += string;
             }
-            OFStandard::strlcpy(idxRec.InstanceDescription, description.c_str(), DESCRIPTION_MAX_LENGTH+1);
+            OFStandard::strlcpy(idxRec->InstanceDescription, description.c_str(), DESCRIPTION_MAX_LENGTH+1);
             useDescrTag = OFFalse;
         } else if (strcmp(SOPClassUID, UID_RETIRED_StoredPrintStorage) == 0)
         {
-            OFStandard::strlcpy(idxRec.InstanceDescription, "Stored Print", DESCRIPTION_MAX_LENGTH+1);
+            OFStandard::strlcpy(idxRec->InstanceDescription, "Stored Print", DESCRIPTION_MAX_LENGTH+1);
             useDescrTag = OFFalse;
         }
     }
@@ -2782,10 +3508,10 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
         OFString string;
         /* return value is irrelevant */
         dset->findAndGetOFString(descrTag, string);
-        strncpy(idxRec.InstanceDescription, string.c_str(), DESCRIPTION_MAX_LENGTH);
+        strncpy(idxRec->InstanceDescription, string.c_str(), DESCRIPTION_MAX_LENGTH);
     }
     /* is dataset digitally signed? */
-    if (strlen(idxRec.InstanceDescription) + 9 < DESCRIPTION_MAX_LENGTH)
+    if (strlen(idxRec->InstanceDescription) + 9 < DESCRIPTION_MAX_LENGTH)
     {
         DcmSequenceOfItems *signature_sequence = NULL;
         if (dset->findAndGetSequence(DCM_DigitalSignaturesSequence, signature_sequence, OFTrue /* searchIntoSub */).good() && signature_sequence)
@@ -2793,13 +3519,61 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
             /* in principle it should be checked whether there is _any_ non-empty digital signatures sequence, but ... */
             if (signature_sequence->card() > 0)
             {
-                if (strlen(idxRec.InstanceDescription) > 0)
-                    OFStandard::strlcat(idxRec.InstanceDescription, " (Signed)", DESCRIPTION_MAX_LENGTH+1);
+                if (strlen(idxRec->InstanceDescription) > 0)
+                    OFStandard::strlcat(idxRec->InstanceDescription, " (Signed)", DESCRIPTION_MAX_LENGTH+1);
                 else
-                    OFStandard::strlcpy(idxRec.InstanceDescription, "Signed Instance", DESCRIPTION_MAX_LENGTH+1);
+                    OFStandard::strlcpy(idxRec->InstanceDescription, "Signed Instance", DESCRIPTION_MAX_LENGTH+1);
             }
         }
     }
+}
+
+/*************************
+**  Add data from imageFileName to database
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
+    const char  *SOPClassUID,
+    const char  * /*SOPInstanceUID*/,
+    const char  *imageFileName,
+    DcmQueryRetrieveDatabaseStatus *status,
+    OFBool      isNew)
+{
+    IdxRecord        idxRec ;
+    StudyDescRecord  *pStudyDesc ;
+    int              i = 0 ;
+    struct stat      stat_buf ;
+
+    /**** Initialize an IdxRecord
+    ***/
+
+    memset((char*)&idxRec, 0, sizeof(idxRec));
+
+    DB_IdxInitRecord (&idxRec, 0) ;
+
+    strncpy(idxRec.filename, imageFileName, DBC_MAXSTRING);
+#ifdef DEBUG
+    DCMQRDB_DEBUG("DB_storeRequest () : storage request of file : " << idxRec.filename);
+#endif
+    strncpy (idxRec.SOPClassUID, SOPClassUID, UI_MAX_LENGTH);
+
+    /**** Get IdxRec values from ImageFile
+    ***/
+
+    DcmFileFormat dcmff;
+    if (dcmff.loadFile(imageFileName).bad())
+    {
+      DCMQRDB_WARN("DB: Cannot open file: " << imageFileName << ": "
+          << OFStandard::getLastSystemErrorCode().message());
+      status->setStatus(STATUS_STORE_Error_CannotUnderstand);
+      return (QR_EC_IndexDatabaseError) ;
+    }
+
+    DcmDataset *dset = dcmff.getDataset();
+
+    assert(dset);
+
+    DB_IdxSetValues(&idxRec, dset, SOPClassUID, isNew);
 
     /**** Print Elements
     ***/
@@ -2829,6 +3603,12 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
       return (QR_EC_IndexDatabaseError) ;
     }
 
+    /* the secondary index is updated along with the index file */
+    OFBool updateSecondaryIndex = secondaryIndex_->open(OFTrue);
+
+    /* so is the summary index, including the records removed below */
+    beginSummaryUpdate();
+
     memset((char *)pStudyDesc, 0, SIZEOF_STUDYDESC);
     DB_GetStudyDesc(pStudyDesc) ;
 
@@ -2852,6 +3632,8 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
         free (pStudyDesc) ;
         status->setStatus(STATUS_STORE_Refused_OutOfResources);
 
+        secondaryIndex_->close();
+        endSummaryUpdate();
         DB_unlock();
 
         return (QR_EC_IndexDatabaseError) ;
@@ -2859,14 +3641,35 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::storeRequest (
 
     free (pStudyDesc) ;
 
-    if (DB_IdxAdd (handle_, &i, &idxRec) == EC_Normal)
+    /* a record of the same series or study usually has most strings in common */
+    const int similarIdx = updateSecondaryIndex ? findSimilarRecord(&idxRec) : -1;
+
+    /* removed records need not be updated in the secondary index, but an
+     * added record must not be missing, so mark the index as being modified
+     */
+    if (updateSecondaryIndex)
+        updateSecondaryIndex = secondaryIndex_->beginUpdate().good();
+
+    if (DB_IdxAdd (handle_, &i, &idxRec, similarIdx) == EC_Normal)
     {
+        summaryIndex_->addRecord(i, idxRec);
+        endSummaryUpdate();
+        if (!updateSecondaryIndex || secondaryIndex_->addRecord(i, idxRec).bad() ||
+            secondaryIndex_->isRebuildRecommended())
+        {
+            /* failure is not fatal, queries fall back to scanning the index file */
+            if (rebuildSecondaryIndex().bad())
+                DCMQRDB_WARN("DB_storeRequest: cannot update secondary index file: " << secondaryIndex_->getFilename());
+        }
+        secondaryIndex_->close();
         status->setStatus(STATUS_Success);
         DB_unlock();
         return (EC_Normal) ;
     }
     else
     {
+        secondaryIndex_->close();
+        endSummaryUpdate();
         status->setStatus(STATUS_STORE_Refused_OutOfResources);
         DB_unlock();
     }
@@ -2897,6 +3700,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::pruneInvalidRecords()
 
     DB_GetStudyDesc(pStudyDesc) ;
 
+    beginSummaryUpdate();
     while (DB_IdxRead(idx, &idxRec) == EC_Normal)
     {
       if (access(idxRec.filename, R_OK) < 0)
@@ -2928,6 +3732,7 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::pruneInvalidRecords()
       idx++;
     }
 
+    endSummaryUpdate();
     DB_StudyDescChange (pStudyDesc);
     DB_unlock();
     free (pStudyDesc) ;
@@ -3023,9 +3828,13 @@ OFBool DcmQueryRetrieveIndexDatabaseHandle::findSOPInstance(const char *storeAre
 
     handle.DB_lock(OFFalse);
 
+    /* only check the records determined by the secondary index, if possible */
+    handle.handle_->useCandidateList = handle.findUIDCandidates(DCM_SOPInstanceUID, sopInstanceUID.c_str(), handle.handle_->candidateList);
+    handle.handle_->candidateCounter = 0;
+
     handle.DB_IdxInitLoop (&j) ;
     while (1) {
-        if (handle.DB_IdxGetNext(&j, &idxRec) != EC_Normal)
+        if (handle.DB_IdxGetNextCandidate(&j, &idxRec) != EC_Normal)
             break ;
         if (sopClassUID.compare(idxRec.SOPClassUID)==0 && sopInstanceUID.compare(idxRec.SOPInstanceUID)==0)
         {
@@ -3037,9 +3846,770 @@ OFBool DcmQueryRetrieveIndexDatabaseHandle::findSOPInstance(const char *storeAre
     return Found;
 }
 
+/*************************
+**  Rebuild the secondary index from the index file
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::rebuildSecondaryIndex()
+{
+    int idx ;
+    IdxRecord idxRec ;
+
+    DCMQRDB_DEBUG("rebuilding secondary index file: " << secondaryIndex_->getFilename());
+    secondaryIndex_->close();
+    secondaryIndex_->clear();
+    DB_IdxInitLoop (&idx) ;
+    while (DB_IdxGetNext(&idx, &idxRec) == EC_Normal)
+        secondaryIndex_->insertRecord(idx, idxRec);
+    return secondaryIndex_->writeIndex();
+}
+
+/*************************
+**  Rebuild the summary index from the index file
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::rebuildSummaryIndex()
+{
+    int idx ;
+    IdxRecord idxRec ;
+
+    DCMQRDB_DEBUG("rebuilding summary index file: " << summaryIndex_->getFilename());
+    summaryIndex_->close();
+    summaryIndex_->clear();
+    DB_IdxInitLoop (&idx) ;
+    while (DB_IdxGetNext(&idx, &idxRec) == EC_Normal)
+        summaryIndex_->addRecord(idx, idxRec);
+    return summaryIndex_->writeIndex();
+}
+
+/*************************
+**  Create a new index file and string pool file and write their headers
+ */
+
+static OFBool DB_CreateIndexFiles(
+    OFFile& indexFile,
+    const OFString& indexFilename,
+    OFFile& poolFile,
+    const OFString& poolFilename,
+    const StudyDescRecord *pStudyDesc)
+{
+    char header[DBHEADERSIZE + 1];
+    OFBool ok = indexFile.fopen(indexFilename.c_str(), "wb") && poolFile.fopen(poolFilename.c_str(), "wb");
+    if (ok)
+    {
+        OFStandard::snprintf(header, sizeof(header), DBMAGIC "%.2X", DBVERSION);
+        ok = (indexFile.fwrite(header, DBHEADERSIZE, 1) == 1) &&
+             (indexFile.fwrite(pStudyDesc, SIZEOF_STUDYDESC, 1) == 1);
+        OFStandard::snprintf(header, sizeof(header), DBSTRINGPOOLMAGIC "%.2X", DBVERSION);
+        ok = ok && (poolFile.fwrite(header, DBHEADERSIZE, 1) == 1);
+    }
+    return ok;
+}
+
+/*************************
+**  Append the string values of an Index record to a new string pool file
+**  and set their offsets in the compact record. All strings that may be
+**  shared by several records are written only once, strings that are
+**  unique for each instance are not looked up.
+ */
+
+static OFBool DB_WritePoolStrings(
+    const IdxRecord *idxRec,
+    DB_CompactRecord *crec,
+    OFFile& poolFile,
+    const char *poolFilename,
+    OFMap<OFString, Uint32>& dictionary,
+    size_t& poolSize)
+{
+    for (int i = 0; i < DB_COMPACT_STRINGS; i++)
+    {
+        const char *value = DB_GetRecordString(idxRec, i);
+        if (value[0] == '\0')
+            continue;
+        const OFBool unique = (i == 0) || (i == DB_FIRST_PARAM_STRING + RECORDIDX_SOPInstanceUID);
+        OFMap<OFString, Uint32>::iterator it = dictionary.end();
+        if (!unique)
+            it = dictionary.find(value);
+        if (it != dictionary.end())
+            crec->strings[i] = (*it).second;
+        else
+        {
+            const size_t length = strlen(value) + 1;
+            if (poolSize + length > 0xFFFFFFFFUL)
+            {
+                DCMQRDB_ERROR(poolFilename << ": string pool file too large");
+                return OFFalse;
+            }
+            if (poolFile.fwrite(value, length, 1) != 1)
+                return OFFalse;
+            crec->strings[i] = OFstatic_cast(Uint32, poolSize);
+            if (!unique)
+                dictionary[value] = crec->strings[i];
+            poolSize += length;
+        }
+    }
+    return OFTrue;
+}
+
+/*************************
+**  Write a compacted copy of an index file and its string pool file
+ */
+
+static OFCondition DB_ConvertIndexFile(
+    const char *indexFilename,
+    const char *poolFilename,
+    int pidx,
+    unsigned int version)
+{
+    const OFString tempIndexFilename = OFString(indexFilename) + ".tmp";
+    const OFString tempPoolFilename = OFString(poolFilename) + ".tmp";
+
+    /* records of the current version are decoded using a private handle */
+    DB_Private_Handle source;
+    source.pidx = pidx;
+    if (version == DBVERSION)
+    {
+#ifdef O_BINARY
+        source.pstr = open(poolFilename, O_RDONLY | O_BINARY );
+#else
+        source.pstr = open(poolFilename, O_RDONLY );
+#endif
+        if (source.pstr == (-1))
+        {
+            DCMQRDB_ERROR(poolFilename << ": " << OFStandard::getLastSystemErrorCode().message());
+            return QR_EC_IndexDatabaseError;
+        }
+    }
+
+    StudyDescRecord *pStudyDesc = (StudyDescRecord *)malloc (SIZEOF_STUDYDESC) ;
+    if (pStudyDesc == NULL)
+    {
+        DCMQRDB_ERROR("DB_ConvertIndexFile: out of memory");
+        if (source.pstr != (-1))
+            close(source.pstr);
+        return QR_EC_IndexDatabaseError;
+    }
+    /* a file containing only the header has no study descriptors yet */
+    memset((char *)pStudyDesc, 0, SIZEOF_STUDYDESC);
+    DB_lseek(pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET);
+    if (read(pidx, (char *)pStudyDesc, SIZEOF_STUDYDESC) != SIZEOF_STUDYDESC)
+        memset((char *)pStudyDesc, 0, SIZEOF_STUDYDESC);
+
+    OFFile indexFile;
+    OFFile poolFile;
+    OFBool ok = DB_CreateIndexFiles(indexFile, tempIndexFilename, poolFile, tempPoolFilename, pStudyDesc);
+    free(pStudyDesc);
+
+    OFMap<OFString, Uint32> dictionary;
+    size_t poolSize = DBHEADERSIZE;
+    unsigned long records = 0;
+    IdxRecord idxRec;
+    DB_CompactRecord crec;
+    for (int idx = 0; ok; idx++)
+    {
+        OFBool inUse = OFFalse;
+        if (version == DBVERSION)
+        {
+            if (DB_ReadCompactRecord(&source, idx, &crec).bad())
+                break;
+            inUse = (crec.strings[0] != 0);
+            if (inUse && DB_IdxDecode(&source, &crec, &idxRec).bad())
+            {
+                DCMQRDB_WARN(indexFilename << ": removing damaged record " << idx);
+                inUse = OFFalse;
+            }
+        }
+        else
+        {
+            /* previous versions store a binary copy of IdxRecord */
+            DB_lseek(pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC + OFstatic_cast(size_t, idx) * SIZEOF_IDXRECORD), SEEK_SET);
+            if (read(pidx, (char *)&idxRec, SIZEOF_IDXRECORD) != SIZEOF_IDXRECORD)
+                break;
+            inUse = (idxRec.filename[0] != '\0');
+            DB_IdxInitRecord(&idxRec, 1);
+        }
+
+        DB_IdxEncodeNumbers(&idxRec, &crec);
+        if (inUse)
+            ok = DB_WritePoolStrings(&idxRec, &crec, poolFile, poolFilename, dictionary, poolSize);
+        if (!inUse)
+            memset((char *)&crec, 0, SIZEOF_COMPACTRECORD);
+        else
+            records++;
+        ok = ok && (indexFile.fwrite(&crec, SIZEOF_COMPACTRECORD, 1) == 1);
+    }
+
+    DB_ReleaseStringPool(&source);
+    if (source.pstr != (-1))
+        close(source.pstr);
+    if (indexFile.open() && (indexFile.fclose() != 0))
+        ok = OFFalse;
+    if (poolFile.open() && (poolFile.fclose() != 0))
+        ok = OFFalse;
+    if (!ok)
+    {
+        DCMQRDB_ERROR(indexFilename << ": cannot write converted index file: "
+            << OFStandard::getLastSystemErrorCode().message());
+        OFStandard::deleteFile(tempIndexFilename);
+        OFStandard::deleteFile(tempPoolFilename);
+        return QR_EC_IndexDatabaseError;
+    }
+    DCMQRDB_INFO(indexFilename << ": converted " << records << " records, "
+        << poolSize << " bytes of strings (" << dictionary.size() << " shared values)");
+    return EC_Normal;
+}
+
+/*************************
+**  Replace a file by the temporary file written by DB_ConvertIndexFile()
+ */
+
+static OFCondition DB_ReplaceFile(const char *filename)
+{
+    const OFString tempFilename = OFString(filename) + ".tmp";
+    /* rename() does not replace an existing file on all systems */
+    OFStandard::deleteFile(filename);
+    if (!OFStandard::renameFile(tempFilename, filename))
+    {
+        DCMQRDB_ERROR(tempFilename << ": cannot rename to " << filename << ": "
+            << OFStandard::getLastSystemErrorCode().message());
+        return QR_EC_IndexDatabaseError;
+    }
+    return EC_Normal;
+}
+
+/*************************
+**  Upgrade the index file to the current version
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::upgradeIndexFile(const char *storeArea)
+{
+    char indexFilename[DBC_MAXSTRING+1];
+    char poolFilename[DBC_MAXSTRING+1];
+    OFStandard::snprintf(indexFilename, sizeof(indexFilename), "%s%c%s", storeArea, PATH_SEPARATOR, DBINDEXFILE);
+    OFStandard::snprintf(poolFilename, sizeof(poolFilename), "%s%c%s", storeArea, PATH_SEPARATOR, DBSTRINGPOOLFILE);
+
+    /* an index file that does not yet exist is created by the constructor */
+    if (OFStandard::fileExists(indexFilename))
+    {
+#ifdef O_BINARY
+        int pidx = open(indexFilename, O_RDWR | O_BINARY );
+#else
+        int pidx = open(indexFilename, O_RDWR );
+#endif
+        if (pidx == (-1))
+        {
+            DCMQRDB_ERROR(indexFilename << ": " << OFStandard::getLastSystemErrorCode().message());
+            return QR_EC_IndexDatabaseError;
+        }
+        if (dcmtk_flock(pidx, LOCK_EX) < 0)
+        {
+            dcmtk_plockerr("DB_lock");
+            close(pidx);
+            return QR_EC_IndexDatabaseError;
+        }
+
+        OFCondition result = EC_Normal;
+        OFBool converted = OFFalse;
+        char header[DBHEADERSIZE+1] = {};
+        unsigned int version = 0;
+        const int headerSize = OFstatic_cast(int, read( pidx, header, DBHEADERSIZE ));
+        if (headerSize == 0)
+        {
+            /* empty file, the header is written by the constructor */
+        }
+        else if
+        (
+            headerSize != DBHEADERSIZE                                    ||
+            strncmp( header, DBMAGIC, strlen(DBMAGIC) ) != 0              ||
+            sscanf( header + strlen(DBMAGIC), "%x", &version ) != 1
+        )
+        {
+            DCMQRDB_ERROR(indexFilename << ": unknown/legacy QRDB database file format");
+            result = QR_EC_IndexDatabaseError;
+        }
+        else if (version < DBVERSION - 2 || version > DBVERSION)
+        {
+            DCMQRDB_ERROR(indexFilename << ": invalid/unsupported QRDB database version " << version);
+            result = QR_EC_IndexDatabaseError;
+        }
+        else
+        {
+            /* versions 5 and 6 store the same uncompressed records, version 6
+             * only adds the secondary index, which is rebuilt below
+             */
+            result = DB_ConvertIndexFile(indexFilename, poolFilename, pidx, version);
+            converted = result.good();
+        }
+        dcmtk_flock(pidx, LOCK_UN);
+        close(pidx);
+
+        /* the string pool file is replaced first, it is not used by previous versions */
+        if (converted)
+        {
+            result = DB_ReplaceFile(poolFilename);
+            if (result.good())
+                result = DB_ReplaceFile(indexFilename);
+            if (result.good() && (version != DBVERSION))
+                DCMQRDB_INFO(indexFilename << ": upgraded QRDB database version " << version << " to " << DBVERSION);
+        }
+        if (result.bad())
+            return result;
+    }
+
+    OFCondition result;
+    DcmQueryRetrieveIndexDatabaseHandle handle(storeArea, -1, -1, result);
+    if (result.good())
+    {
+        result = handle.DB_lock(OFTrue);
+        if (result.good())
+        {
+            result = handle.rebuildSecondaryIndex();
+            if (result.good())
+                result = handle.rebuildSummaryIndex();
+            handle.DB_unlock();
+        }
+    }
+    return result;
+}
+
+/*************************
+**  Bulk loading of the index file, see rebuildIndexFile()
+ */
+
+/* number of files that a parser thread takes from the list at a time */
+#define DB_BULK_CHUNK 16
+
+/* an instance parsed by the bulk loader: the numeric values and all string
+ * values of its Index record in the order of DB_CompactRecord::strings,
+ * each terminated by a null byte
+ */
+struct DB_BulkRecord
+{
+    DB_BulkRecord() : valid(OFFalse), numbers(), strings(), study(0), series(0), instance(0) {}
+
+    OFBool valid ;
+    DB_CompactRecord numbers ;
+    OFString strings ;
+
+    /* positions of the UIDs within the string values */
+    size_t study ;
+    size_t series ;
+    size_t instance ;
+};
+
+/* the list of files parsed by one or more threads */
+struct DB_BulkJob
+{
+    DB_BulkJob(const OFVector<OFString>& files, OFVector<DB_BulkRecord>& records, OFBool isNew, double recordedDate)
+    : files(files)
+    , records(records)
+    , isNew(isNew)
+    , recordedDate(recordedDate)
+    , next(0)
+    , done(0)
+    , nextProgress(0)
+#ifdef WITH_THREADS
+    , mutex()
+#endif
+    {
+    }
+
+    void parse();
+
+    const OFVector<OFString>& files ;
+    OFVector<DB_BulkRecord>& records ;
+    OFBool isNew ;
+    double recordedDate ;
+    size_t next ;
+    size_t done ;
+    size_t nextProgress ;
+#ifdef WITH_THREADS
+    OFMutex mutex ;
+#endif
+};
+
+/*************************
+**  Parse a DICOM file into a bulk record
+ */
+
+static OFBool DB_ParseBulkFile(const OFString& filename, OFBool isNew, double recordedDate, DB_BulkRecord& rec)
+{
+    if (filename.length() > DBC_MAXSTRING)
+    {
+        DCMQRDB_WARN("DB_ParseBulkFile: filename too long, ignoring: " << filename);
+        return OFFalse;
+    }
+
+    /* larger element values, e.g. the pixel data, are not read into memory */
+    DcmFileFormat dcmff;
+    if (dcmff.loadFile(filename).bad())
+    {
+        DCMQRDB_WARN("DB: Cannot open file: " << filename << ": "
+            << OFStandard::getLastSystemErrorCode().message());
+        return OFFalse;
+    }
+    DcmDataset *dset = dcmff.getDataset();
+    char sopClass[UI_MAX_LENGTH+1];
+    char sopInstance[UI_MAX_LENGTH+1];
+    if (!DU_findSOPClassAndInstanceInDataSet(dset, sopClass, sizeof(sopClass), sopInstance, sizeof(sopInstance)))
+    {
+        DCMQRDB_WARN("DB_ParseBulkFile: SOP Class or Instance UID missing, ignoring: " << filename);
+        return OFFalse;
+    }
+    struct stat stat_buf ;
+    if (stat(filename.c_str(), &stat_buf) != 0)
+    {
+        DCMQRDB_WARN("DB: Cannot open file: " << filename << ": "
+            << OFStandard::getLastSystemErrorCode().message());
+        return OFFalse;
+    }
+
+    IdxRecord idxRec ;
+    memset((char*)&idxRec, 0, sizeof(idxRec));
+    DB_IdxInitRecord (&idxRec, 0) ;
+    OFStandard::strlcpy(idxRec.filename, filename.c_str(), DBC_MAXSTRING+1);
+    OFStandard::strlcpy(idxRec.SOPClassUID, sopClass, UI_MAX_LENGTH+1);
+    DB_IdxSetValues(&idxRec, dset, sopClass, isNew);
+    idxRec. ImageSize = (int)(stat_buf. st_size) ;
+    idxRec. RecordedDate = recordedDate ;
+
+    DB_IdxEncodeNumbers(&idxRec, &rec.numbers);
+    rec.strings.clear();
+    for (int i = 0; i < DB_COMPACT_STRINGS; i++)
+    {
+        if (i == DB_FIRST_PARAM_STRING + RECORDIDX_StudyInstanceUID)
+            rec.study = rec.strings.length();
+        else if (i == DB_FIRST_PARAM_STRING + RECORDIDX_SeriesInstanceUID)
+            rec.series = rec.strings.length();
+        else if (i == DB_FIRST_PARAM_STRING + RECORDIDX_SOPInstanceUID)
+            rec.instance = rec.strings.length();
+        rec.strings += DB_GetRecordString(&idxRec, i);
+        rec.strings += '\0';
+    }
+    return OFTrue;
+}
+
+/*************************
+**  Convert a bulk record into an Index record
+ */
+
+static void DB_DecodeBulkRecord(const DB_BulkRecord& rec, IdxRecord *idxRec)
+{
+    DB_IdxInitRecord (idxRec, 0) ;
+    idxRec -> RecordedDate = rec. numbers. RecordedDate ;
+    idxRec -> ImageSize = rec. numbers. ImageSize ;
+    idxRec -> hstat = OFstatic_cast(char, rec. numbers. hstat) ;
+
+    size_t size = 0 ;
+    const char *value = rec. strings. c_str() ;
+    for (int i = 0 ; i < DB_COMPACT_STRINGS ; i++) {
+        char *buffer = DB_GetRecordBuffer (idxRec, i, &size) ;
+        OFStandard::strlcpy (buffer, value, size) ;
+        value += strlen (value) + 1 ;
+    }
+    for (int j = 0 ; j < NBPARAMETERS ; j++)
+        idxRec -> param[j]. ValueLength = OFstatic_cast(Uint32, strlen (idxRec -> param[j]. PValueField)) ;
+}
+
+/*************************
+**  Parse the files of a bulk job until none are left
+ */
+
+void DB_BulkJob::parse()
+{
+    size_t first = 0;
+    size_t count = 0;
+    for (;;)
+    {
+#ifdef WITH_THREADS
+        mutex.lock();
+#endif
+        /* report the progress for the previous chunk */
+        done += count;
+        if ((done >= nextProgress || done == files.size()) && (count > 0))
+        {
+            DCMQRDB_INFO("parsed " << done << " of " << files.size() << " files ("
+                << (done * 100 / files.size()) << "%)");
+            nextProgress = done + (files.size() + 9) / 10;
+        }
+        first = next;
+        count = (files.size() - next < DB_BULK_CHUNK) ? files.size() - next : DB_BULK_CHUNK;
+        next += count;
+#ifdef WITH_THREADS
+        mutex.unlock();
+#endif
+        if (count == 0)
+            break;
+        for (size_t i = first; i < first + count; i++)
+            records[i].valid = DB_ParseBulkFile(files[i], isNew, recordedDate, records[i]);
+    }
+}
+
+#ifdef WITH_THREADS
+
+/* a thread parsing the files of a bulk job */
+class DB_BulkParser : public OFThread
+{
+public:
+    DB_BulkParser(DB_BulkJob& job) : OFThread(), job_(job) {}
+
+protected:
+    virtual void run() { job_.parse(); }
+
+private:
+    DB_BulkJob& job_;
+};
+
+#endif
+
+/*************************
+**  Compare two bulk records by study, series and input position
+ */
+
+struct DB_BulkSortEntry
+{
+    const char *study ;
+    const char *series ;
+    size_t pos ;
+};
+
+extern "C" int DB_BulkCompare(const void *a, const void *b)
+{
+    const DB_BulkSortEntry *ea = OFstatic_cast(const DB_BulkSortEntry *, a);
+    const DB_BulkSortEntry *eb = OFstatic_cast(const DB_BulkSortEntry *, b);
+    int result = strcmp(ea->study, eb->study);
+    if (result == 0)
+        result = strcmp(ea->series, eb->series);
+    if (result == 0)
+        result = (ea->pos < eb->pos) ? -1 : ((ea->pos > eb->pos) ? 1 : 0);
+    return result;
+}
+
+/*************************
+**  Write a new index file from a list of DICOM files
+ */
+
+OFCondition DcmQueryRetrieveIndexDatabaseHandle::rebuildIndexFile(
+    const char *storeArea,
+    const OFList<OFString>& files,
+    OFBool isNew,
+    size_t numThreads)
+{
+    char indexFilename[DBC_MAXSTRING+1];
+    char poolFilename[DBC_MAXSTRING+1];
+    OFStandard::snprintf(indexFilename, sizeof(indexFilename), "%s%c%s", storeArea, PATH_SEPARATOR, DBINDEXFILE);
+    OFStandard::snprintf(poolFilename, sizeof(poolFilename), "%s%c%s", storeArea, PATH_SEPARATOR, DBSTRINGPOOLFILE);
+    const OFString tempIndexFilename = OFString(indexFilename) + ".tmp";
+    const OFString tempPoolFilename = OFString(poolFilename) + ".tmp";
+
+    /* parse all files, in parallel if possible */
+    OFVector<OFString> fileVector;
+    fileVector.reserve(files.size());
+    for (OFListConstIterator(OFString) it = files.begin(); it != files.end(); ++it)
+        fileVector.push_back(*it);
+    OFVector<DB_BulkRecord> records(fileVector.size());
+    /* we only have second accuracy */
+    DB_BulkJob job(fileVector, records, isNew, (double) time(NULL));
+    if (!fileVector.empty())
+    {
+#ifdef WITH_THREADS
+        if (numThreads > fileVector.size() / DB_BULK_CHUNK + 1)
+            numThreads = fileVector.size() / DB_BULK_CHUNK + 1;
+        OFVector<DB_BulkParser *> parsers;
+        for (size_t t = 1; t < numThreads; t++)
+        {
+            DB_BulkParser *parser = new DB_BulkParser(job);
+            if (parser->start() == 0)
+                parsers.push_back(parser);
+            else
+            {
+                DCMQRDB_WARN("rebuildIndexFile: cannot start parser thread");
+                delete parser;
+                break;
+            }
+        }
+        DCMQRDB_DEBUG("rebuildIndexFile: parsing " << fileVector.size() << " files with "
+            << (parsers.size() + 1) << " threads");
+        job.parse();
+        for (size_t t = 0; t < parsers.size(); t++)
+        {
+            parsers[t]->join();
+            delete parsers[t];
+        }
+#else
+        (void) numThreads;
+        job.parse();
+#endif
+    }
+
+    /* select the records that sequential registration of the files would
+     * leave in the database: a later file replaces an earlier one with the
+     * same SOP Instance UID, the most recently registered studies are kept
+     * and the oldest images of a study are removed if it is too large
+     */
+    DcmQueryRetrieveUIDTable instances;
+    DcmQueryRetrieveUIDTable studies;
+    OFVector<Uint32> studySize;
+    OFVector<OFBool> studyFull;
+    OFVector<DB_BulkSortEntry> entries;
+    size_t rejected = 0;
+    for (size_t i = records.size(); i-- > 0; )
+    {
+        DB_BulkRecord& rec = records[i];
+        if (!rec.valid)
+        {
+            rejected++;
+            continue;
+        }
+        const char *strings = rec.strings.c_str();
+        if (!instances.insert(strings + rec.instance, OFstatic_cast(Sint32, i)))
+        {
+            DCMQRDB_DEBUG("rebuildIndexFile: instance replaced by later file: " << fileVector[i]);
+            continue;
+        }
+        Sint32 s = 0;
+        if (!studies.find(strings + rec.study, s))
+        {
+            s = OFstatic_cast(Sint32, studySize.size());
+            studies.insert(strings + rec.study, s);
+            studySize.push_back(0);
+            studyFull.push_back(OFFalse);
+        }
+        if (OFstatic_cast(size_t, s) >= DB_UpperMaxStudies)
+        {
+            DCMQRDB_WARN("rebuildIndexFile: too many studies, ignoring: " << fileVector[i]);
+            rejected++;
+            continue;
+        }
+        if (OFstatic_cast(size_t, rec.numbers.ImageSize) > OFstatic_cast(size_t, DB_UpperMaxBytesPerStudy))
+        {
+            DCMQRDB_WARN("rebuildIndexFile: image too large, ignoring: " << fileVector[i]);
+            rejected++;
+            continue;
+        }
+        if (studyFull[s] || (OFstatic_cast(size_t, studySize[s]) + rec.numbers.ImageSize > OFstatic_cast(size_t, DB_UpperMaxBytesPerStudy)))
+        {
+            DCMQRDB_WARN("rebuildIndexFile: study too large, ignoring: " << fileVector[i]);
+            studyFull[s] = OFTrue;
+            rejected++;
+            continue;
+        }
+        studySize[s] += rec.numbers.ImageSize;
+        DB_BulkSortEntry entry;
+        entry.study = strings + rec.study;
+        entry.series = strings + rec.series;
+        entry.pos = i;
+        entries.push_back(entry);
+    }
+
+    /* records of the same study and series are stored next to each other */
+    if (!entries.empty())
+        qsort(&entries[0], entries.size(), sizeof(DB_BulkSortEntry), DB_BulkCompare);
+
+    StudyDescRecord *pStudyDesc = (StudyDescRecord *)malloc (SIZEOF_STUDYDESC) ;
+    if (pStudyDesc == NULL)
+    {
+        DCMQRDB_ERROR("rebuildIndexFile: out of memory");
+        return QR_EC_IndexDatabaseError;
+    }
+    memset((char *)pStudyDesc, 0, SIZEOF_STUDYDESC);
+    int s = -1;
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        if ((s < 0) || (strcmp(pStudyDesc[s].StudyInstanceUID, entries[i].study) != 0))
+        {
+            s++;
+            OFStandard::strlcpy(pStudyDesc[s].StudyInstanceUID, entries[i].study, UI_MAX_LENGTH+1);
+            pStudyDesc[s].LastRecordedDate = records[entries[i].pos].numbers.RecordedDate;
+        }
+        pStudyDesc[s].StudySize += records[entries[i].pos].numbers.ImageSize;
+        pStudyDesc[s].NumberofRegistratedImages++;
+    }
+
+    /* write the new index file in one sequential pass */
+    OFFile indexFile;
+    OFFile poolFile;
+    OFBool ok = DB_CreateIndexFiles(indexFile, tempIndexFilename, poolFile, tempPoolFilename, pStudyDesc);
+    free(pStudyDesc);
+
+    OFMap<OFString, Uint32> dictionary;
+    size_t poolSize = DBHEADERSIZE;
+    IdxRecord idxRec;
+    DB_CompactRecord crec;
+    for (size_t i = 0; ok && (i < entries.size()); i++)
+    {
+        DB_BulkRecord& rec = records[entries[i].pos];
+        DB_DecodeBulkRecord(rec, &idxRec);
+        crec = rec.numbers;
+        ok = DB_WritePoolStrings(&idxRec, &crec, poolFile, poolFilename, dictionary, poolSize) &&
+             (indexFile.fwrite(&crec, SIZEOF_COMPACTRECORD, 1) == 1);
+    }
+    if (indexFile.open() && (indexFile.fclose() != 0))
+        ok = OFFalse;
+    if (poolFile.open() && (poolFile.fclose() != 0))
+        ok = OFFalse;
+    if (!ok)
+    {
+        DCMQRDB_ERROR(indexFilename << ": cannot write index file: "
+            << OFStandard::getLastSystemErrorCode().message());
+        OFStandard::deleteFile(tempIndexFilename);
+        OFStandard::deleteFile(tempPoolFilename);
+        return QR_EC_IndexDatabaseError;
+    }
+    DCMQRDB_INFO(indexFilename << ": wrote " << entries.size() << " records of " << (s + 1) << " studies, "
+        << rejected << " files not registered, " << poolSize << " bytes of strings");
+
+    /* replace the existing files while holding the lock of the index file */
+    FILE* f = fopen(indexFilename, "ab");
+    if (f != NULL)
+        fclose(f);
+#ifdef O_BINARY
+    int pidx = open(indexFilename, O_RDWR | O_BINARY );
+#else
+    int pidx = open(indexFilename, O_RDWR );
+#endif
+    if (pidx == (-1))
+    {
+        DCMQRDB_ERROR(indexFilename << ": " << OFStandard::getLastSystemErrorCode().message());
+        OFStandard::deleteFile(tempIndexFilename);
+        OFStandard::deleteFile(tempPoolFilename);
+        return QR_EC_IndexDatabaseError;
+    }
+    if (dcmtk_flock(pidx, LOCK_EX) < 0)
+    {
+        dcmtk_plockerr("DB_lock");
+        close(pidx);
+        OFStandard::deleteFile(tempIndexFilename);
+        OFStandard::deleteFile(tempPoolFilename);
+        return QR_EC_IndexDatabaseError;
+    }
+    OFCondition result = DB_ReplaceFile(poolFilename);
+    if (result.good())
+        result = DB_ReplaceFile(indexFilename);
+    dcmtk_flock(pidx, LOCK_UN);
+    close(pidx);
+    if (result.bad())
+        return result;
+
+    /* the secondary and summary index are written from the new index file */
+    DcmQueryRetrieveIndexDatabaseHandle handle(storeArea, -1, -1, result);
+    if (result.good())
+    {
+        result = handle.DB_lock(OFTrue);
+        if (result.good())
+        {
+            result = handle.rebuildSecondaryIndex();
+            if (result.good())
+                result = handle.rebuildSummaryIndex();
+            handle.DB_unlock();
+        }
+    }
+    return result;
+}
+
+
+/* ========================= UTILS ========================= */
 
-/* ========================= UTILS ========================= */
-
 
 const char *DcmQueryRetrieveIndexDatabaseHandle::getStorageArea() const
 {
@@ -3068,6 +4638,8 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
     long maxBytesPerStudy,
     OFCondition& result)
 : handle_(NULL)
+, secondaryIndex_(new DcmQueryRetrieveSecondaryIndex(storageArea))
+, summaryIndex_(new DcmQueryRetrieveSummaryIndex(storageArea))
 , quotaSystemEnabled(OFTrue)
 , doCheckFindIdentifier(OFFalse)
 , doCheckMoveIdentifier(OFFalse)
@@ -3127,6 +4699,9 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
         }
         else
         {
+#ifdef DB_MAP_INDEX_FILE
+            handle_ -> mappingEnabled = OFTrue;
+#endif
             result = DB_lock(OFTrue);
             if ( result.bad() )
                 return;
@@ -3149,7 +4724,10 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
                 )
                 {
                     DB_unlock();
-                    if ( version )
+                    if ( version >= DBVERSION - 2 && version < DBVERSION )
+                        DCMQRDB_ERROR(handle_->indexFilename << ": QRDB database version " << version
+                            << " must be upgraded to version " << DBVERSION << " using dcmqridx --upgrade");
+                    else if ( version )
                         DCMQRDB_ERROR(handle_->indexFilename << ": invalid/unsupported QRDB database version " << version);
                     else
                         DCMQRDB_ERROR(handle_->indexFilename << ": unknown/legacy QRDB database file format");
@@ -3170,6 +4748,20 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
                     result = QR_EC_IndexDatabaseError;
                     return;
                 }
+                // create an empty secondary index, a missing one would be
+                // rebuilt by the next store operation anyway
+                if ( secondaryIndex_->writeIndex().bad() )
+                    DCMQRDB_WARN(secondaryIndex_->getFilename() << ": cannot create secondary index file");
+                if ( summaryIndex_->writeIndex().bad() )
+                    DCMQRDB_WARN(summaryIndex_->getFilename() << ": cannot create summary index file");
+            }
+
+            // the string values of the records are stored in the string pool file
+            result = DB_OpenStringPool(handle_);
+            if ( result.bad() )
+            {
+                DB_unlock();
+                return;
             }
 
             DB_unlock();
@@ -3179,7 +4771,6 @@ DcmQueryRetrieveIndexDatabaseHandle::DcmQueryRetrieveIndexDatabaseHandle(
             handle_ -> findResponseList = NULL;
             handle_ -> maxBytesPerStudy = maxBytesPerStudy;
             handle_ -> maxStudiesAllowed = maxStudiesPerStorageArea;
-            handle_ -> uidList = NULL;
             result = EC_Normal;
             return;
         }
@@ -3206,16 +4797,25 @@ DcmQueryRetrieveIndexDatabaseHandle::~DcmQueryRetrieveIndexDatabaseHandle()
        * and this gives an unnecessary error message on stderr.
        */
       DB_unlock();
+#else
+      if (handle_->lockMode != 0) DB_unlock();
+#endif
+#ifdef DB_MAP_INDEX_FILE
+      DB_UnmapIndexFile(handle_);
 #endif
+      DB_ReleaseStringPool(handle_);
+      if (handle_ -> pstr != (-1))
+        close( handle_ -> pstr);
       close( handle_ -> pidx);
 
       /* Free lists */
       DB_FreeElementList (handle_ -> findRequestList);
       DB_FreeElementList (handle_ -> findResponseList);
-      DB_FreeUidList (handle_ -> uidList);
 
       delete handle_;
     }
+    delete secondaryIndex_;
+    delete summaryIndex_;
 }
 
 /**********************************
@@ -3243,7 +4843,14 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::makeNewStoreFileName(
     // resulting in more "randomness" when called within the same second.
     static unsigned int seed = (unsigned int)time(NULL);
     newImageFileName[0]=0; // return empty string in case of error
-    if (! fnamecreator.makeFilename(seed, handle_->storageArea, prefix, ".dcm", filename))
+#ifdef WITH_THREADS
+    DB_FilenameMutex.lock();
+#endif
+    const OFBool created = fnamecreator.makeFilename(seed, handle_->storageArea, prefix, ".dcm", filename);
+#ifdef WITH_THREADS
+    DB_FilenameMutex.unlock();
+#endif
+    if (! created)
         return QR_EC_IndexDatabaseError;
 
     OFStandard::strlcpy(newImageFileName, filename.c_str(), newImageFileNameLen);
@@ -3266,11 +4873,14 @@ OFCondition DcmQueryRetrieveIndexDatabaseHandle::instanceReviewed(int idx)
       result = DB_lock(OFTrue);
       if (result.bad()) return result;
 
-      record.hstat = DVIF_objectIsNotNew;
-      DB_lseek(handle_->pidx, OFstatic_cast(long, DBHEADERSIZE + SIZEOF_STUDYDESC + idx * SIZEOF_IDXRECORD), SEEK_SET);
-      if (write(handle_->pidx, OFreinterpret_cast(char *, &record), SIZEOF_IDXRECORD) != SIZEOF_IDXRECORD)
-          result = QR_EC_IndexDatabaseError;
-      DB_lseek(handle_->pidx, OFstatic_cast(long, DBHEADERSIZE), SEEK_SET);
+      // only the status of the compact record is changed, the strings are kept
+      DB_CompactRecord crec;
+      result = DB_ReadCompactRecord(handle_, idx, &crec);
+      if (result.good())
+      {
+          crec.hstat = DVIF_objectIsNotNew;
+          result = DB_WriteCompactRecord(handle_, idx, &crec);
+      }
       DB_unlock();
     }
 
@@ -0,0 +1,647 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: class DcmQueryRetrieveSecondaryIndex
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmqrdb/dcmqrdbx.h"
+#include "dcmtk/dcmqrdb/dcmqrcnf.h"
+#include "dcmtk/dcmqrdb/dcmqridx.h"
+#include "dcmtk/dcmqrdb/dcmqrdbs.h"
+#include "dcmtk/dcmqrdb/dcmqropt.h"
+#include "dcmtk/dcmdata/dcmatch.h"
+#include "dcmtk/dcmdata/dcvrda.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+
+/* ========================= static data ========================= */
+
+/** kinds of values stored in a table of the secondary index
+ */
+enum DB_KeyIndexKind
+{
+    /// string value, looked up using single value or wild card matching
+    DB_KEYINDEX_STRING,
+    /// string value affected by the specific character set
+    DB_KEYINDEX_CHARSET_STRING,
+    /// UID, looked up using list of UID matching
+    DB_KEYINDEX_UID,
+    /// date, stored as YYYYMMDD and looked up using range matching
+    DB_KEYINDEX_DATE,
+    /// specific character set of records using code extensions (ISO 2022)
+    DB_KEYINDEX_CODE_EXTENSIONS
+};
+
+/** description of a table of the secondary index
+ */
+struct DB_KeyIndexTableDef
+{
+    DcmTagKey tag ;
+    int param ;
+    DB_KeyIndexKind kind ;
+
+    /* to passify some C++ compilers */
+    DB_KeyIndexTableDef(const DcmTagKey& t, int p, DB_KeyIndexKind k)
+        : tag(t), param(p), kind(k) { }
+};
+
+/**** The TbKeyIndexTables table describes the tables of the secondary index
+ **** file, in the order in which they are stored. The number of elements
+ **** must be DB_KEYINDEX_TABLES.
+ ***/
+
+static const DB_KeyIndexTableDef TbKeyIndexTables [DB_KEYINDEX_TABLES] = {
+        DB_KeyIndexTableDef( DCM_PatientID,             RECORDIDX_PatientID,            DB_KEYINDEX_CHARSET_STRING  ),
+        DB_KeyIndexTableDef( DCM_PatientName,           RECORDIDX_PatientName,          DB_KEYINDEX_CHARSET_STRING  ),
+        DB_KeyIndexTableDef( DCM_StudyInstanceUID,      RECORDIDX_StudyInstanceUID,     DB_KEYINDEX_UID             ),
+        DB_KeyIndexTableDef( DCM_SeriesInstanceUID,     RECORDIDX_SeriesInstanceUID,    DB_KEYINDEX_UID             ),
+        DB_KeyIndexTableDef( DCM_SOPInstanceUID,        RECORDIDX_SOPInstanceUID,       DB_KEYINDEX_UID             ),
+        DB_KeyIndexTableDef( DCM_StudyDate,             RECORDIDX_StudyDate,            DB_KEYINDEX_DATE            ),
+        DB_KeyIndexTableDef( DCM_Modality,              RECORDIDX_Modality,             DB_KEYINDEX_STRING          ),
+        DB_KeyIndexTableDef( DCM_SpecificCharacterSet,  RECORDIDX_SpecificCharacterSet, DB_KEYINDEX_CODE_EXTENSIONS )
+  };
+
+/// number of the table listing the records with code extensions
+#define DB_KEYINDEX_CODE_EXTENSIONS_TABLE 7
+
+/* ========================= static functions ========================= */
+
+BEGIN_EXTERN_C
+static int DB_KeyIndexCompare(const void *ve1, const void *ve2)
+{
+    const DB_KeyIndexEntry *e1 = OFstatic_cast(const DB_KeyIndexEntry *, ve1);
+    const DB_KeyIndexEntry *e2 = OFstatic_cast(const DB_KeyIndexEntry *, ve2);
+    int result = memcmp(e1->key, e2->key, DB_KEYINDEX_MAX_KEY_LENGTH);
+    if (result == 0)
+        result = (e1->idx < e2->idx) ? -1 : ((e1->idx > e2->idx) ? 1 : 0);
+    return result;
+}
+
+static int DB_KeyIndexCompareIdx(const void *ve1, const void *ve2)
+{
+    const Sint32 i1 = *OFstatic_cast(const Sint32 *, ve1);
+    const Sint32 i2 = *OFstatic_cast(const Sint32 *, ve2);
+    return (i1 < i2) ? -1 : ((i1 > i2) ? 1 : 0);
+}
+END_EXTERN_C
+
+/************
+**      Normalize a date value to YYYYMMDD
+ */
+
+static OFBool DB_KeyIndexNormalizeDate(const char *value, size_t length, char *key)
+{
+    OFDate date;
+    if ((length == 0) || DcmDate::getOFDateFromString(value, length, date).bad())
+        return OFFalse;
+    char buf[16];
+    OFStandard::snprintf(buf, sizeof(buf), "%04u%02u%02u", date.getYear(), date.getMonth(), date.getDay());
+    memcpy(key, buf, 8);
+    return OFTrue;
+}
+
+/************
+**      Check whether a value only consists of 7-bit characters without escape sequences
+ */
+
+static OFBool DB_KeyIndexIsASCII(const char *value, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        const unsigned char c = OFstatic_cast(unsigned char, value[i]);
+        if ((c >= 0x80) || (c == 0x1b))
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+/* ========================= class implementation ========================= */
+
+DcmQueryRetrieveSecondaryIndex::DcmQueryRetrieveSecondaryIndex(const char *storageArea)
+: filename_()
+, file_()
+, header_()
+, deltas_()
+, valid_(OFFalse)
+{
+    filename_ = storageArea;
+    filename_ += PATH_SEPARATOR;
+    filename_ += DBKEYINDEXFILE;
+    memset(&header_, 0, sizeof(header_));
+}
+
+DcmQueryRetrieveSecondaryIndex::~DcmQueryRetrieveSecondaryIndex()
+{
+    close();
+}
+
+const OFString& DcmQueryRetrieveSecondaryIndex::getFilename() const
+{
+    return filename_;
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::isValid() const
+{
+    return valid_;
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::isIndexedKey(const DcmTagKey& tag)
+{
+    const int table = findTable(tag);
+    return (table >= 0) && (TbKeyIndexTables[table].kind != DB_KEYINDEX_CODE_EXTENSIONS);
+}
+
+int DcmQueryRetrieveSecondaryIndex::findTable(const DcmTagKey& tag)
+{
+    for (int i = 0; i < DB_KEYINDEX_TABLES; i++)
+    {
+        if (TbKeyIndexTables[i].tag == tag)
+            return i;
+    }
+    return -1;
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::open(OFBool forUpdate)
+{
+    close();
+    if (!file_.fopen(filename_.c_str(), forUpdate ? "r+b" : "rb"))
+    {
+        DCMQRDB_DEBUG("secondary index file not available: " << filename_);
+        return OFFalse;
+    }
+
+    OFBool valid = (file_.fread(&header_, sizeof(header_), 1) == 1)
+        && (strncmp(header_.magic, DBKEYINDEXMAGIC, sizeof(header_.magic)) == 0)
+        && (header_.version == DBKEYINDEXVERSION);
+    for (int i = 0; valid && (i < DB_KEYINDEX_TABLES); i++)
+    {
+        valid = (DcmTagKey(header_.tables[i].group, header_.tables[i].element) == TbKeyIndexTables[i].tag);
+    }
+    if (!valid)
+    {
+        DCMQRDB_WARN("invalid secondary index file: " << filename_);
+        close();
+        return OFFalse;
+    }
+    if (header_.dirty)
+    {
+        DCMQRDB_WARN("secondary index file is not up-to-date: " << filename_);
+        close();
+        return OFFalse;
+    }
+
+    /* read the delta entries following the sorted tables */
+    offile_off_t offset = sizeof(header_);
+    for (int i = 0; i < DB_KEYINDEX_TABLES; i++)
+        offset += OFstatic_cast(offile_off_t, header_.tables[i].count) * sizeof(DB_KeyIndexEntry);
+    deltas_.resize(header_.deltaCount);
+    if ((header_.deltaCount > 0) &&
+        ((file_.fseek(offset, SEEK_SET) != 0) ||
+         (file_.fread(&deltas_[0], sizeof(DB_KeyIndexEntry), header_.deltaCount) != header_.deltaCount)))
+    {
+        DCMQRDB_WARN("cannot read secondary index file: " << filename_);
+        close();
+        return OFFalse;
+    }
+    valid_ = OFTrue;
+    return OFTrue;
+}
+
+void DcmQueryRetrieveSecondaryIndex::close()
+{
+    if (file_.open())
+        file_.fclose();
+    deltas_.clear();
+    valid_ = OFFalse;
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::makeKey(int table, const char *value, char *key)
+{
+    memset(key, 0, DB_KEYINDEX_MAX_KEY_LENGTH);
+    if (value == NULL)
+        return OFFalse;
+    /* leading and trailing spaces are not significant for matching */
+    const char *begin = value;
+    const char *end = value + strlen(value);
+    OFStandard::trimString(begin, end);
+    const size_t length = OFstatic_cast(size_t, end - begin);
+    if (length == 0)
+        return OFFalse;
+    switch (TbKeyIndexTables[table].kind)
+    {
+      case DB_KEYINDEX_DATE:
+        return DB_KeyIndexNormalizeDate(begin, length, key);
+      case DB_KEYINDEX_CODE_EXTENSIONS:
+        if (OFString(begin, length).find("2022") == OFString_npos)
+          return OFFalse;
+        break;
+      default:
+        break;
+    }
+    memcpy(key, begin, (length < DB_KEYINDEX_MAX_KEY_LENGTH) ? length : DB_KEYINDEX_MAX_KEY_LENGTH);
+    return OFTrue;
+}
+
+void DcmQueryRetrieveSecondaryIndex::makeEntries(Sint32 idx, const IdxRecord& record, OFVector<DB_KeyIndexEntry>& entries)
+{
+    DB_KeyIndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.idx = idx;
+    for (int i = 0; i < DB_KEYINDEX_TABLES; i++)
+    {
+        if (makeKey(i, record.param[TbKeyIndexTables[i].param].PValueField, entry.key))
+        {
+            entry.table = OFstatic_cast(Uint16, i);
+            entries.push_back(entry);
+        }
+    }
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::makeLookup(const QueryKey& key, TableLookup& lookup)
+{
+    lookup.table = findTable(key.tag);
+    lookup.ranges.clear();
+    lookup.codeExtensions = OFFalse;
+    lookup.count = 0;
+    if ((lookup.table < 0) || (TbKeyIndexTables[lookup.table].kind == DB_KEYINDEX_CODE_EXTENSIONS))
+        return OFFalse;
+
+    const char *begin = key.value.c_str();
+    const char *end = begin + key.value.size();
+    OFStandard::trimString(begin, end);
+    if (begin == end)
+    {
+        /* universal matching */
+        return OFFalse;
+    }
+
+    KeyRange range;
+    switch (TbKeyIndexTables[lookup.table].kind)
+    {
+      case DB_KEYINDEX_UID:
+        /* list of UID matching, one range per UID */
+        while (begin <= end)
+        {
+            const char *next = begin;
+            while ((next != end) && (*next != '\\'))
+                ++next;
+            const char *valueEnd = next;
+            OFStandard::trimString(begin, valueEnd);
+            if (!makeKey(lookup.table, OFString(begin, OFstatic_cast(size_t, valueEnd - begin)).c_str(), range.lower))
+                return OFFalse;
+            memcpy(range.upper, range.lower, DB_KEYINDEX_MAX_KEY_LENGTH);
+            range.length = DB_KEYINDEX_MAX_KEY_LENGTH;
+            lookup.ranges.push_back(range);
+            begin = next + 1;
+        }
+        return OFTrue;
+
+      case DB_KEYINDEX_DATE:
+      {
+        /* single value or range matching on the normalized date */
+        DcmAttributeMatching::Range dateRange(begin, OFstatic_cast(size_t, end - begin));
+        memset(range.lower, 0, DB_KEYINDEX_MAX_KEY_LENGTH);
+        memset(range.upper, 0xff, DB_KEYINDEX_MAX_KEY_LENGTH);
+        range.length = 8;
+        if (!dateRange.hasOpenBeginning() && !DB_KeyIndexNormalizeDate(dateRange.first, dateRange.firstSize, range.lower))
+            return OFFalse;
+        if (!dateRange.isRange())
+            memcpy(range.upper, range.lower, DB_KEYINDEX_MAX_KEY_LENGTH);
+        else if (!dateRange.hasOpenEnd() && !DB_KeyIndexNormalizeDate(dateRange.second, dateRange.secondSize, range.upper))
+            return OFFalse;
+        lookup.ranges.push_back(range);
+        return OFTrue;
+      }
+
+      default:
+      {
+        /* single value matching or, if the value contains wildcards,
+         * a lookup of the characters preceding the first wildcard
+         */
+        const char *wildcard = begin;
+        while ((wildcard != end) && (*wildcard != '*') && (*wildcard != '?'))
+            ++wildcard;
+        size_t length = OFstatic_cast(size_t, wildcard - begin);
+        if (length == 0)
+            return OFFalse;
+        if (TbKeyIndexTables[lookup.table].kind == DB_KEYINDEX_CHARSET_STRING)
+        {
+            /* values of records using a different character set may be
+             * converted before matching. Non-ASCII characters are never
+             * looked up, and records using code extensions are always
+             * considered as candidates.
+             */
+            if (!DB_KeyIndexIsASCII(begin, length))
+                return OFFalse;
+            lookup.codeExtensions = OFTrue;
+        }
+        if (length > DB_KEYINDEX_MAX_KEY_LENGTH)
+            length = DB_KEYINDEX_MAX_KEY_LENGTH;
+        memset(range.lower, 0, DB_KEYINDEX_MAX_KEY_LENGTH);
+        memcpy(range.lower, begin, length);
+        memcpy(range.upper, range.lower, DB_KEYINDEX_MAX_KEY_LENGTH);
+        range.length = (wildcard == end) ? DB_KEYINDEX_MAX_KEY_LENGTH : length;
+        lookup.ranges.push_back(range);
+        return OFTrue;
+      }
+    }
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::readEntries(int table, Uint32 first, Uint32 count, OFVector<DB_KeyIndexEntry>& entries)
+{
+    if (count == 0)
+        return EC_Normal;
+    offile_off_t offset = sizeof(header_);
+    for (int i = 0; i < table; i++)
+        offset += OFstatic_cast(offile_off_t, header_.tables[i].count) * sizeof(DB_KeyIndexEntry);
+    offset += OFstatic_cast(offile_off_t, first) * sizeof(DB_KeyIndexEntry);
+    const size_t pos = entries.size();
+    entries.resize(pos + count);
+    if ((file_.fseek(offset, SEEK_SET) != 0) ||
+        (file_.fread(&entries[pos], sizeof(DB_KeyIndexEntry), count) != count))
+    {
+        DCMQRDB_WARN("cannot read secondary index file: " << filename_);
+        entries.resize(pos);
+        return QR_EC_IndexDatabaseError;
+    }
+    return EC_Normal;
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::findRange(int table, const KeyRange& range, Uint32& first, Uint32& last)
+{
+    OFVector<DB_KeyIndexEntry> entry;
+    OFCondition cond = EC_Normal;
+    Uint32 low = 0;
+    Uint32 high = header_.tables[table].count;
+
+    /* binary search for the first entry not less than the lower bound */
+    while (low < high)
+    {
+        const Uint32 mid = low + (high - low) / 2;
+        entry.clear();
+        cond = readEntries(table, mid, 1, entry);
+        if (cond.bad())
+            return cond;
+        if (memcmp(entry[0].key, range.lower, range.length) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    first = low;
+
+    /* binary search for the first entry greater than the upper bound */
+    high = header_.tables[table].count;
+    while (low < high)
+    {
+        const Uint32 mid = low + (high - low) / 2;
+        entry.clear();
+        cond = readEntries(table, mid, 1, entry);
+        if (cond.bad())
+            return cond;
+        if (memcmp(entry[0].key, range.upper, range.length) <= 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    last = low;
+    return EC_Normal;
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::findCandidates(const OFList<QueryKey>& keys, OFVector<Sint32>& candidates)
+{
+    candidates.clear();
+    if (!valid_)
+        return OFFalse;
+
+    /* determine the most selective key */
+    TableLookup best;
+    best.table = -1;
+    best.count = 0;
+    OFListConstIterator(QueryKey) it = keys.begin();
+    while (it != keys.end())
+    {
+        TableLookup lookup;
+        if (makeLookup(*it, lookup))
+        {
+            for (size_t r = 0; r < lookup.ranges.size(); r++)
+            {
+                Uint32 first = 0;
+                Uint32 last = 0;
+                if (findRange(lookup.table, lookup.ranges[r], first, last).bad())
+                    return OFFalse;
+                lookup.first.push_back(first);
+                lookup.last.push_back(last);
+                lookup.count += last - first;
+            }
+            for (size_t d = 0; d < deltas_.size(); d++)
+            {
+                if (deltas_[d].table == lookup.table)
+                {
+                    for (size_t r = 0; r < lookup.ranges.size(); r++)
+                    {
+                        if ((memcmp(deltas_[d].key, lookup.ranges[r].lower, lookup.ranges[r].length) >= 0) &&
+                            (memcmp(deltas_[d].key, lookup.ranges[r].upper, lookup.ranges[r].length) <= 0))
+                        {
+                            ++lookup.count;
+                            break;
+                        }
+                    }
+                }
+                else if (lookup.codeExtensions && (deltas_[d].table == DB_KEYINDEX_CODE_EXTENSIONS_TABLE))
+                    ++lookup.count;
+            }
+            if (lookup.codeExtensions)
+                lookup.count += header_.tables[DB_KEYINDEX_CODE_EXTENSIONS_TABLE].count;
+            if ((best.table < 0) || (lookup.count < best.count))
+                best = lookup;
+        }
+        ++it;
+    }
+    if (best.table < 0)
+        return OFFalse;
+
+    /* collect the record numbers of the candidates */
+    OFVector<DB_KeyIndexEntry> entries;
+    for (size_t r = 0; r < best.ranges.size(); r++)
+    {
+        if (readEntries(best.table, best.first[r], best.last[r] - best.first[r], entries).bad())
+            return OFFalse;
+    }
+    if (best.codeExtensions &&
+        readEntries(DB_KEYINDEX_CODE_EXTENSIONS_TABLE, 0, header_.tables[DB_KEYINDEX_CODE_EXTENSIONS_TABLE].count, entries).bad())
+        return OFFalse;
+    candidates.reserve(best.count);
+    for (size_t e = 0; e < entries.size(); e++)
+        candidates.push_back(entries[e].idx);
+    for (size_t d = 0; d < deltas_.size(); d++)
+    {
+        if (deltas_[d].table == best.table)
+        {
+            for (size_t r = 0; r < best.ranges.size(); r++)
+            {
+                if ((memcmp(deltas_[d].key, best.ranges[r].lower, best.ranges[r].length) >= 0) &&
+                    (memcmp(deltas_[d].key, best.ranges[r].upper, best.ranges[r].length) <= 0))
+                {
+                    candidates.push_back(deltas_[d].idx);
+                    break;
+                }
+            }
+        }
+        else if (best.codeExtensions && (deltas_[d].table == DB_KEYINDEX_CODE_EXTENSIONS_TABLE))
+            candidates.push_back(deltas_[d].idx);
+    }
+
+    /* sort the record numbers and remove duplicates */
+    if (!candidates.empty())
+    {
+        qsort(&candidates[0], candidates.size(), sizeof(Sint32), DB_KeyIndexCompareIdx);
+        size_t count = 1;
+        for (size_t c = 1; c < candidates.size(); c++)
+        {
+            if (candidates[c] != candidates[count - 1])
+                candidates[count++] = candidates[c];
+        }
+        candidates.resize(count);
+    }
+    DCMQRDB_DEBUG("secondary index: " << candidates.size() << " candidate records for "
+        << TbKeyIndexTables[best.table].tag);
+    return OFTrue;
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::writeHeader()
+{
+    if ((file_.fseek(0, SEEK_SET) != 0) ||
+        (file_.fwrite(&header_, sizeof(header_), 1) != 1) ||
+        (file_.fflush() != 0))
+    {
+        DCMQRDB_ERROR("cannot write secondary index file: " << filename_);
+        return QR_EC_IndexDatabaseError;
+    }
+    return EC_Normal;
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::beginUpdate()
+{
+    if (!valid_)
+        return QR_EC_IndexDatabaseError;
+    header_.dirty = 1;
+    return writeHeader();
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::addRecord(Sint32 idx, const IdxRecord& record)
+{
+    if (!valid_)
+        return QR_EC_IndexDatabaseError;
+
+    OFVector<DB_KeyIndexEntry> entries;
+    makeEntries(idx, record, entries);
+    for (size_t i = 0; i < entries.size(); i++)
+        deltas_.push_back(entries[i]);
+
+    /* append the new entries to the delta entries */
+    if (!entries.empty())
+    {
+        offile_off_t offset = sizeof(header_);
+        for (int i = 0; i < DB_KEYINDEX_TABLES; i++)
+            offset += OFstatic_cast(offile_off_t, header_.tables[i].count) * sizeof(DB_KeyIndexEntry);
+        offset += OFstatic_cast(offile_off_t, header_.deltaCount) * sizeof(DB_KeyIndexEntry);
+        if ((file_.fseek(offset, SEEK_SET) != 0) ||
+            (file_.fwrite(&entries[0], sizeof(DB_KeyIndexEntry), entries.size()) != entries.size()))
+        {
+            DCMQRDB_ERROR("cannot write secondary index file: " << filename_);
+            return QR_EC_IndexDatabaseError;
+        }
+    }
+    header_.deltaCount = OFstatic_cast(Uint32, deltas_.size());
+    header_.dirty = 0;
+    return writeHeader();
+}
+
+OFBool DcmQueryRetrieveSecondaryIndex::isRebuildRecommended() const
+{
+    return valid_ && (deltas_.size() > DB_KEYINDEX_MAX_DELTAS);
+}
+
+void DcmQueryRetrieveSecondaryIndex::clear()
+{
+    for (int i = 0; i < DB_KEYINDEX_TABLES; i++)
+        pending_[i].clear();
+}
+
+void DcmQueryRetrieveSecondaryIndex::insertRecord(Sint32 idx, const IdxRecord& record)
+{
+    OFVector<DB_KeyIndexEntry> entries;
+    makeEntries(idx, record, entries);
+    for (size_t i = 0; i < entries.size(); i++)
+        pending_[entries[i].table].push_back(entries[i]);
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::writeIndex()
+{
+    close();
+    OFCondition cond = writeFile(pending_);
+    clear();
+    return cond;
+}
+
+OFCondition DcmQueryRetrieveSecondaryIndex::writeFile(OFVector<DB_KeyIndexEntry> *tables)
+{
+    DB_KeyIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DBKEYINDEXMAGIC, sizeof(header.magic));
+    header.version = DBKEYINDEXVERSION;
+    for (int i = 0; i < DB_KEYINDEX_TABLES; i++)
+    {
+        if (!tables[i].empty())
+            qsort(&tables[i][0], tables[i].size(), sizeof(DB_KeyIndexEntry), DB_KeyIndexCompare);
+        header.tables[i].group = TbKeyIndexTables[i].tag.getGroup();
+        header.tables[i].element = TbKeyIndexTables[i].tag.getElement();
+        header.tables[i].count = OFstatic_cast(Uint32, tables[i].size());
+    }
+
+    /* write a temporary file first and replace the index file afterwards */
+    const OFString tempFilename = filename_ + ".tmp";
+    OFFile file;
+    OFBool ok = file.fopen(tempFilename.c_str(), "wb");
+    if (ok)
+        ok = (file.fwrite(&header, sizeof(header), 1) == 1);
+    for (int i = 0; ok && (i < DB_KEYINDEX_TABLES); i++)
+    {
+        if (!tables[i].empty())
+            ok = (file.fwrite(&tables[i][0], sizeof(DB_KeyIndexEntry), tables[i].size()) == tables[i].size());
+    }
+    if (file.open() && (file.fclose() != 0))
+        ok = OFFalse;
+    if (ok)
+    {
+        /* rename() does not replace an existing file on all systems */
+        OFStandard::deleteFile(filename_);
+        ok = OFStandard::renameFile(tempFilename, filename_);
+    }
+    if (!ok)
+    {
+        DCMQRDB_ERROR("cannot write secondary index file: " << filename_ << ": "
+            << OFStandard::getLastSystemErrorCode().message());
+        OFStandard::deleteFile(tempFilename);
+        return QR_EC_IndexDatabaseError;
+    }
+    return EC_Normal;
+}
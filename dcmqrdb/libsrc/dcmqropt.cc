@@ -36,12 +36,14 @@ DcmQueryRetrieveOptions::DcmQueryRetrieveOptions()
 , itempad_(0)
 , maxAssociations_(20)
 , maxPDU_(ASC_DEFAULTMAXPDU)
+, maxSubAssociations_(1)
 , net_(NULL)
 , networkTransferSyntax_(EXS_Unknown)
 #ifndef DISABLE_COMPRESSION_EXTENSION
 ,  networkTransferSyntaxOut_(EXS_Unknown)
 #endif
 , paddingType_(EPD_withoutPadding)
+, prefetchCount_(0)
 , refuseMultipleStorageAssociations_(OFFalse)
 , refuse_(OFFalse)
 , rejectWhenNoImplementationClassUID_(OFFalse)
@@ -55,6 +57,7 @@ DcmQueryRetrieveOptions::DcmQueryRetrieveOptions()
 #else
 , singleProcess_(OFTrue)
 #endif
+, threadedMode_(OFFalse)
 , supportPatientRoot_(OFTrue)
 #ifdef NO_PATIENTSTUDYONLY_SUPPORT
 , supportPatientStudyOnly_(OFFalse)
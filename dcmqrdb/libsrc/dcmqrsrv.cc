@@ -31,6 +31,8 @@
 #include "dcmtk/dcmqrdb/dcmqrcbg.h"    /* for class DcmQueryRetrieveGetContext */
 #include "dcmtk/dcmqrdb/dcmqrcbs.h"    /* for class DcmQueryRetrieveStoreContext */
 #include "dcmtk/dcmtls/tlsopt.h"       /* for DcmTLSOptions */
+#include "dcmtk/dcmnet/dthrpool.h"     /* for class DcmAssociationThreadPool */
+#include "dcmtk/ofstd/ofvector.h"
 
 static void findCallback(
   /* in */
@@ -91,6 +93,140 @@ static void storeCallback(
 }
 
 
+#ifdef WITH_THREADS
+
+/* handler of a thread of the pool serving the associations in threaded mode.
+ * The handler keeps the database handles it has created, so that subsequent
+ * associations of the same peer reuse them (and the index data cached by
+ * them) instead of opening the database again.
+ */
+class DcmQueryRetrieveAssociationHandler : public DcmAssociationHandler
+{
+public:
+    DcmQueryRetrieveAssociationHandler(DcmQueryRetrieveSCP& scp)
+    : DcmAssociationHandler()
+    , scp_(scp)
+    , peers_()
+    , dbHandles_()
+    {
+    }
+
+    virtual ~DcmQueryRetrieveAssociationHandler();
+
+    virtual void handleAssociation(T_ASC_Association *assoc);
+
+private:
+    /// the SCP whose associations are served
+    DcmQueryRetrieveSCP& scp_;
+
+    /// calling and called AE title of the peers the database handles were created for
+    OFVector<OFString> peers_;
+
+    /// database handles created by this thread
+    OFVector<DcmQueryRetrieveDatabaseHandle *> dbHandles_;
+
+    // private undefined copy constructor
+    DcmQueryRetrieveAssociationHandler(const DcmQueryRetrieveAssociationHandler&);
+
+    // private undefined assignment operator
+    DcmQueryRetrieveAssociationHandler& operator=(const DcmQueryRetrieveAssociationHandler&);
+};
+
+
+/* pool of threads serving the associations accepted by the main thread in
+ * threaded mode. The associations are entered into the process table of the
+ * SCP with negative numbers instead of process IDs.
+ */
+class DcmQueryRetrieveAssociationPool : public DcmAssociationThreadPool
+{
+public:
+    DcmQueryRetrieveAssociationPool(DcmQueryRetrieveSCP& scp, size_t maxThreads)
+    : DcmAssociationThreadPool(maxThreads)
+    , scp_(scp)
+    {
+    }
+
+protected:
+    virtual DcmAssociationHandler *createHandler(OFCondition& /* cond */)
+    {
+        return new DcmQueryRetrieveAssociationHandler(scp_);
+    }
+
+    virtual void addProcess(const int id, T_ASC_Association *assoc)
+    {
+        scp_.processtable_.addProcessToTable(id, assoc);
+    }
+
+    virtual void removeProcess(const int id)
+    {
+        scp_.processtable_.removeProcessFromTable(id);
+    }
+
+private:
+    /// the SCP whose associations are served
+    DcmQueryRetrieveSCP& scp_;
+
+    // private undefined copy constructor
+    DcmQueryRetrieveAssociationPool(const DcmQueryRetrieveAssociationPool&);
+
+    // private undefined assignment operator
+    DcmQueryRetrieveAssociationPool& operator=(const DcmQueryRetrieveAssociationPool&);
+};
+
+
+DcmQueryRetrieveAssociationHandler::~DcmQueryRetrieveAssociationHandler()
+{
+    for (size_t i = 0; i < dbHandles_.size(); ++i)
+        delete dbHandles_[i];
+}
+
+void DcmQueryRetrieveAssociationHandler::handleAssociation(T_ASC_Association *assoc)
+{
+    DcmQueryRetrieveDatabaseHandle *dbHandle = NULL;
+    if (scp_.options_.keepDBHandleDuringAssociation_)
+    {
+        OFString peer = assoc->params->DULparams.callingAPTitle;
+        peer += '\\';
+        peer += assoc->params->DULparams.calledAPTitle;
+        for (size_t i = 0; (i < peers_.size()) && (dbHandle == NULL); ++i)
+        {
+            if (peers_[i] == peer) dbHandle = dbHandles_[i];
+        }
+        if (dbHandle == NULL)
+        {
+            OFCondition cond;
+            dbHandle = scp_.factory_.createDBHandle(
+                assoc->params->DULparams.callingAPTitle,
+                assoc->params->DULparams.calledAPTitle, cond);
+            if (cond.good() && dbHandle)
+            {
+                peers_.push_back(peer);
+                dbHandles_.push_back(dbHandle);
+            }
+            else
+            {
+                /* dispatch() tries again and reports the error */
+                delete dbHandle;
+                dbHandle = NULL;
+            }
+        }
+        else DCMQRDB_DEBUG("Reusing database handle for " << peer);
+    }
+
+    scp_.handleAssociation(&assoc, scp_.options_.correctUIDPadding_, dbHandle);
+
+    /* discard the state of any request interrupted by the end of the association */
+    if (dbHandle)
+    {
+        DcmQueryRetrieveDatabaseStatus dbStatus;
+        dbHandle->cancelFindRequest(&dbStatus);
+        dbHandle->cancelMoveRequest(&dbStatus);
+    }
+}
+
+#endif
+
+
 /*
  * ============================================================================================================
  */
@@ -110,11 +246,21 @@ DcmQueryRetrieveSCP::DcmQueryRetrieveSCP(
 , options_(options)
 , associationConfiguration_(associationConfiguration)
 , tlsOptions_(tlsOptions)
+, threadPool_(NULL)
+{
+}
+
+
+DcmQueryRetrieveSCP::~DcmQueryRetrieveSCP()
 {
+#ifdef WITH_THREADS
+  delete threadPool_;
+#endif
 }
 
 
-OFCondition DcmQueryRetrieveSCP::dispatch(T_ASC_Association *assoc, OFBool correctUIDPadding)
+OFCondition DcmQueryRetrieveSCP::dispatch(T_ASC_Association *assoc, OFBool correctUIDPadding,
+    DcmQueryRetrieveDatabaseHandle *sharedDBHandle)
 {
     OFCondition cond = EC_Normal;
     T_DIMSE_Message msg;
@@ -124,25 +270,30 @@ OFCondition DcmQueryRetrieveSCP::dispatch(T_ASC_Association *assoc, OFBool corre
     // this while loop is executed exactly once unless the "keepDBHandleDuringAssociation_"
     // flag is not set, in which case the inner loop is executed only once and this loop
     // repeats for each incoming DIMSE command. In this case, the DB handle is created
-    // and released for each DIMSE command.
+    // and released for each DIMSE command. A DB handle passed by the caller is used
+    // for the complete association and not released.
     while (cond.good())
     {
-        /* Create a database handle for this association */
-        DcmQueryRetrieveDatabaseHandle *dbHandle = factory_.createDBHandle(
-              assoc->params->DULparams.callingAPTitle,
-          assoc->params->DULparams.calledAPTitle, cond);
-
-        if (cond.bad())
-        {
-          DCMQRDB_ERROR("dispatch: cannot create DB Handle");
-          return cond;
-        }
-
+        DcmQueryRetrieveDatabaseHandle *dbHandle = sharedDBHandle;
         if (dbHandle == NULL)
         {
-          // this should not happen, but we check it anyway
-          DCMQRDB_ERROR("dispatch: cannot create DB Handle");
-          return EC_IllegalCall;
+          /* Create a database handle for this association */
+          dbHandle = factory_.createDBHandle(
+                assoc->params->DULparams.callingAPTitle,
+            assoc->params->DULparams.calledAPTitle, cond);
+
+          if (cond.bad())
+          {
+            DCMQRDB_ERROR("dispatch: cannot create DB Handle");
+            return cond;
+          }
+
+          if (dbHandle == NULL)
+          {
+            // this should not happen, but we check it anyway
+            DCMQRDB_ERROR("dispatch: cannot create DB Handle");
+            return EC_IllegalCall;
+          }
         }
 
         dbHandle->setIdentifierChecking(dbCheckFindIdentifier_, dbCheckMoveIdentifier_);
@@ -151,7 +302,7 @@ OFCondition DcmQueryRetrieveSCP::dispatch(T_ASC_Association *assoc, OFBool corre
         // this while loop is executed exactly once unless the "keepDBHandleDuringAssociation_"
         // flag is set, in which case the DB handle remains open until something goes wrong
         // or the remote peer closes the association
-        while (cond.good() && (firstLoop || options_.keepDBHandleDuringAssociation_) )
+        while (cond.good() && (firstLoop || options_.keepDBHandleDuringAssociation_ || sharedDBHandle) )
         {
             firstLoop = OFFalse;
             cond = DIMSE_receiveCommand(assoc, DIMSE_BLOCKING, 0, &presID, &msg, NULL);
@@ -199,7 +350,7 @@ OFCondition DcmQueryRetrieveSCP::dispatch(T_ASC_Association *assoc, OFBool corre
         }
 
         // release DB handle
-        delete dbHandle;
+        if (dbHandle != sharedDBHandle) delete dbHandle;
     }
 
     // Association done
@@ -207,7 +358,8 @@ OFCondition DcmQueryRetrieveSCP::dispatch(T_ASC_Association *assoc, OFBool corre
 }
 
 
-OFCondition DcmQueryRetrieveSCP::handleAssociation(T_ASC_Association ** pAssoc, OFBool correctUIDPadding)
+OFCondition DcmQueryRetrieveSCP::handleAssociation(T_ASC_Association ** pAssoc, OFBool correctUIDPadding,
+    DcmQueryRetrieveDatabaseHandle *dbHandle)
 {
     OFCondition         cond = EC_Normal;
     DIC_NODENAME        peerHostName;
@@ -225,7 +377,7 @@ OFCondition DcmQueryRetrieveSCP::handleAssociation(T_ASC_Association ** pAssoc,
     ASC_getAPTitles(assoc->params, peerAETitle, sizeof(peerAETitle), myAETitle, sizeof(myAETitle), NULL, 0);
 
     /* now do the real work */
-    cond = dispatch(assoc, correctUIDPadding);
+    cond = dispatch(assoc, correctUIDPadding, dbHandle);
 
     /* clean up on association termination */
     if (cond == DUL_PEERREQUESTEDRELEASE) {
@@ -1106,6 +1258,24 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
             /* don't spawn a sub-process to handle the association */
             cond = handleAssociation(&assoc, options_.correctUIDPadding_);
         }
+#ifdef WITH_THREADS
+        else if (options_.threadedMode_)
+        {
+            /* hand the association over to a thread of the pool */
+            if (threadPool_ == NULL)
+                threadPool_ = new DcmQueryRetrieveAssociationPool(*this, OFstatic_cast(size_t, options_.maxAssociations_));
+            cond = threadPool_->addAssociation(assoc);
+            if (cond.good())
+            {
+                // the association is now owned by the thread pool
+                assoc = NULL;
+            }
+            else
+            {
+                cond = ASC_abortAssociation(assoc);
+            }
+        }
+#endif
 #ifdef HAVE_FORK
         else
         {
@@ -1162,6 +1332,9 @@ OFCondition DcmQueryRetrieveSCP::waitForAssociation(T_ASC_Network * theNet)
 
 void DcmQueryRetrieveSCP::cleanChildren()
 {
+#ifdef WITH_THREADS
+  if (threadPool_) threadPool_->cleanFinishedAssociations();
+#endif
   processtable_.cleanChildren();
 }
 
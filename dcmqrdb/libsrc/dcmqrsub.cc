@@ -0,0 +1,385 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: classes DcmQueryRetrieveSubOperation, DcmQueryRetrieveSubOperationQueue
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/dcmqrdb/dcmqrsub.h"
+#include "dcmtk/dcmqrdb/dcmqrcnf.h"
+#include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/ofstd/ofstd.h"
+
+BEGIN_EXTERN_C
+#include <fcntl.h>       /* needed on Solaris for O_RDONLY */
+END_EXTERN_C
+
+
+#ifdef WITH_THREADS
+
+/** Thread loading the files of the sub-operations of a
+ *  DcmQueryRetrieveSubOperationQueue
+ */
+class DcmQueryRetrieveSubOperationLoader : public OFThread
+{
+public:
+
+    DcmQueryRetrieveSubOperationLoader(DcmQueryRetrieveSubOperationQueue& queue)
+    : OFThread()
+    , queue_(queue)
+    {
+    }
+
+private:
+
+    virtual void run()
+    {
+        DcmQueryRetrieveSubOperation *subOp;
+        while ((subOp = queue_.nextLoad()) != NULL)
+        {
+            subOp->load();
+            subOp->loadMutex_.unlock();
+            queue_.loadFinished();
+        }
+    }
+
+    /// the queue whose files are loaded
+    DcmQueryRetrieveSubOperationQueue& queue_;
+
+    /// private undefined copy constructor
+    DcmQueryRetrieveSubOperationLoader(const DcmQueryRetrieveSubOperationLoader& other);
+
+    /// private undefined assignment operator
+    DcmQueryRetrieveSubOperationLoader& operator=(const DcmQueryRetrieveSubOperationLoader& other);
+};
+
+#endif
+
+
+DcmQueryRetrieveSubOperation::DcmQueryRetrieveSubOperation(
+  const char *sopClassUID,
+  const char *sopInstanceUID,
+  const char *fname)
+: fileFormat_()
+, status_(EC_Normal)
+, prefetched_(OFFalse)
+, loaded_(OFFalse)
+#ifdef WITH_THREADS
+, loadMutex_()
+#endif
+{
+    OFStandard::strlcpy(sopClass, sopClassUID, sizeof(sopClass));
+    OFStandard::strlcpy(sopInstance, sopInstanceUID, sizeof(sopInstance));
+    OFStandard::strlcpy(filename, fname, sizeof(filename));
+}
+
+DcmQueryRetrieveSubOperation::~DcmQueryRetrieveSubOperation()
+{
+#ifdef WITH_THREADS
+    /* make sure that no loader thread is reading the file any more */
+    loadMutex_.lock();
+    loadMutex_.unlock();
+#endif
+}
+
+void DcmQueryRetrieveSubOperation::load()
+{
+    if (loaded_)
+        return;
+    loaded_ = OFTrue;
+
+#ifdef LOCK_IMAGE_FILES
+    /* shared lock image file while it is read */
+    int lockfd;
+#ifdef O_BINARY
+    lockfd = open(filename, O_RDONLY | O_BINARY, 0666);
+#else
+    lockfd = open(filename, O_RDONLY , 0666);
+#endif
+    if (lockfd < 0) {
+        /* due to quota system the file could have been deleted */
+        status_ = makeOFCondition(OFM_dcmqrdb, 3, OF_error, OFStandard::getLastSystemErrorCode().message().c_str());
+        return;
+    }
+    dcmtk_flock(lockfd, LOCK_SH);
+#endif
+
+    status_ = fileFormat_.loadFile(filename, EXS_Unknown);
+
+#ifdef LOCK_IMAGE_FILES
+    /* unlock image file */
+    dcmtk_flock(lockfd, LOCK_UN);
+    close(lockfd);
+#endif
+}
+
+OFCondition DcmQueryRetrieveSubOperation::wait()
+{
+    if (!prefetched_)
+        return status_;
+#ifdef WITH_THREADS
+    /* blocks while a loader thread is reading the file */
+    loadMutex_.lock();
+#endif
+    /* no loader thread has claimed the file (yet), so read it here */
+    load();
+    const OFCondition result = status_;
+#ifdef WITH_THREADS
+    loadMutex_.unlock();
+#endif
+    return result;
+}
+
+DcmDataset *DcmQueryRetrieveSubOperation::getDataset()
+{
+    if (prefetched_ && loaded_ && status_.good())
+        return fileFormat_.getDataset();
+    return NULL;
+}
+
+OFBool DcmQueryRetrieveSubOperation::isPrefetched() const
+{
+    return prefetched_;
+}
+
+
+/* the semaphores are created and drained like the one of the
+ * DcmAssociationThreadPool (see dcmnet/libsrc/dthrpool.cc)
+ */
+DcmQueryRetrieveSubOperationQueue::DcmQueryRetrieveSubOperationQueue(size_t capacity, size_t prefetchCount)
+: queue_()
+, prefetchCount_(prefetchCount)
+, closed_(OFFalse)
+, cancelled_(OFFalse)
+#ifdef WITH_THREADS
+, loadQueue_()
+, loaders_()
+, idleLoaders_(0)
+, shutdown_(OFFalse)
+, mutex_()
+, loadAvailable_(OFstatic_cast(unsigned int, capacity + prefetchCount + 1))
+, available_(OFstatic_cast(unsigned int, capacity + 1))
+, processed_(OFstatic_cast(unsigned int, capacity + 1))
+#endif
+{
+#ifdef WITH_THREADS
+    size_t i;
+    for (i = 0; i <= capacity; ++i)
+    {
+        available_.wait();
+        processed_.wait();
+    }
+    for (i = 0; i <= capacity + prefetchCount; ++i)
+        loadAvailable_.wait();
+#else
+    (void) capacity;
+#endif
+}
+
+DcmQueryRetrieveSubOperationQueue::~DcmQueryRetrieveSubOperationQueue()
+{
+#ifdef WITH_THREADS
+    mutex_.lock();
+    shutdown_ = OFTrue;
+    mutex_.unlock();
+    OFListIterator(DcmQueryRetrieveSubOperationLoader *) loader;
+    for (loader = loaders_.begin(); loader != loaders_.end(); ++loader)
+        loadAvailable_.post();
+    for (loader = loaders_.begin(); loader != loaders_.end(); ++loader)
+    {
+        (*loader)->join();
+        delete *loader;
+    }
+#endif
+
+    OFListIterator(DcmQueryRetrieveSubOperation *) it = queue_.begin();
+    while (it != queue_.end())
+    {
+        delete *it;
+        ++it;
+    }
+}
+
+void DcmQueryRetrieveSubOperationQueue::push(DcmQueryRetrieveSubOperation *subOp)
+{
+    subOp->prefetched_ = (prefetchCount_ > 0);
+#ifdef WITH_THREADS
+    mutex_.lock();
+    queue_.push_back(subOp);
+    if (subOp->prefetched_)
+    {
+        /* start another loader thread if all of them are busy */
+        if ((idleLoaders_ <= loadQueue_.size()) && (loaders_.size() < prefetchCount_))
+        {
+            DcmQueryRetrieveSubOperationLoader *loader = new DcmQueryRetrieveSubOperationLoader(*this);
+            if (loader->start() == 0)
+            {
+                loaders_.push_back(loader);
+                ++idleLoaders_;
+            }
+            else
+            {
+                DCMQRDB_DEBUG("cannot start loader thread, files are loaded when they are sent");
+                delete loader;
+            }
+        }
+        if (!loaders_.empty())
+        {
+            loadQueue_.push_back(subOp);
+            loadAvailable_.post();
+        }
+    }
+    mutex_.unlock();
+    available_.post();
+#else
+    /* the file is loaded by wait() */
+    queue_.push_back(subOp);
+#endif
+}
+
+DcmQueryRetrieveSubOperation *DcmQueryRetrieveSubOperationQueue::pop()
+{
+    DcmQueryRetrieveSubOperation *subOp = NULL;
+#ifdef WITH_THREADS
+    available_.wait();
+    mutex_.lock();
+#endif
+    if (!queue_.empty())
+    {
+        subOp = queue_.front();
+        queue_.pop_front();
+#ifdef WITH_THREADS
+        /* the file is loaded by the caller if no loader thread has claimed it yet */
+        if (!loadQueue_.empty() && (loadQueue_.front() == subOp))
+        {
+            loadQueue_.pop_front();
+            loadAvailable_.trywait();
+        }
+#endif
+    }
+#ifdef WITH_THREADS
+    mutex_.unlock();
+    /* the queue is closed, wake up the next thread waiting in pop() */
+    if (subOp == NULL)
+        available_.post();
+#endif
+    return subOp;
+}
+
+void DcmQueryRetrieveSubOperationQueue::close()
+{
+#ifdef WITH_THREADS
+    mutex_.lock();
+    const OFBool wasClosed = closed_;
+    closed_ = OFTrue;
+    mutex_.unlock();
+    if (!wasClosed)
+        available_.post();
+#else
+    closed_ = OFTrue;
+#endif
+}
+
+void DcmQueryRetrieveSubOperationQueue::cancel()
+{
+#ifdef WITH_THREADS
+    mutex_.lock();
+#endif
+    cancelled_ = OFTrue;
+#ifdef WITH_THREADS
+    mutex_.unlock();
+#endif
+}
+
+OFBool DcmQueryRetrieveSubOperationQueue::isCancelled()
+{
+#ifdef WITH_THREADS
+    mutex_.lock();
+#endif
+    const OFBool result = cancelled_;
+#ifdef WITH_THREADS
+    mutex_.unlock();
+#endif
+    return result;
+}
+
+void DcmQueryRetrieveSubOperationQueue::processed()
+{
+#ifdef WITH_THREADS
+    processed_.post();
+#endif
+}
+
+void DcmQueryRetrieveSubOperationQueue::waitProcessed()
+{
+#ifdef WITH_THREADS
+    processed_.wait();
+#endif
+}
+
+size_t DcmQueryRetrieveSubOperationQueue::size()
+{
+#ifdef WITH_THREADS
+    mutex_.lock();
+#endif
+    const size_t result = queue_.size();
+#ifdef WITH_THREADS
+    mutex_.unlock();
+#endif
+    return result;
+}
+
+#ifdef WITH_THREADS
+
+DcmQueryRetrieveSubOperation *DcmQueryRetrieveSubOperationQueue::nextLoad()
+{
+    while (1)
+    {
+        loadAvailable_.wait();
+        mutex_.lock();
+        if (shutdown_)
+        {
+            mutex_.unlock();
+            return NULL;
+        }
+        /* the entry may have been removed by pop() in the meantime */
+        if (!loadQueue_.empty())
+        {
+            DcmQueryRetrieveSubOperation *subOp = loadQueue_.front();
+            loadQueue_.pop_front();
+            /* claimed while the mutex is held, so the sub-operation cannot be deleted before */
+            if (subOp->loadMutex_.trylock() == 0)
+            {
+                --idleLoaders_;
+                mutex_.unlock();
+                return subOp;
+            }
+        }
+        mutex_.unlock();
+    }
+}
+
+void DcmQueryRetrieveSubOperationQueue::loadFinished()
+{
+    mutex_.lock();
+    ++idleLoaders_;
+    mutex_.unlock();
+}
+
+#endif
@@ -0,0 +1,31 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: main test program
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftest.h"
+
+OFTEST_REGISTER(dcmqrdb_find_summary_study_level);
+OFTEST_REGISTER(dcmqrdb_find_summary_series_level);
+OFTEST_REGISTER(dcmqrdb_find_summary_patient_root);
+OFTEST_REGISTER(dcmqrdb_rebuild_index);
+
+OFTEST_MAIN("dcmqrdb")
@@ -0,0 +1,403 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmqrdb
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for the C-FIND processing of class
+ *           DcmQueryRetrieveIndexDatabaseHandle
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/offilsys.h"
+#include "dcmtk/ofstd/oflist.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcuid.h"
+#include "dcmtk/dcmqrdb/dcmqrdbi.h"
+#include "dcmtk/dcmqrdb/dcmqrdbs.h"
+#include "dcmtk/dcmqrdb/dcmqrcnf.h"
+
+#define STORAGE_AREA "dcmqrdb_test_db"
+#define REBUILD_STORAGE_AREA "dcmqrdb_test_db_rebuild"
+#define STUDY_A "1.2.276.0.7230010.3.1.2.0.10"
+#define STUDY_B "1.2.276.0.7230010.3.1.2.0.11"
+#define SERIES_A1 "1.2.276.0.7230010.3.1.3.0.10"
+#define SERIES_A2 "1.2.276.0.7230010.3.1.3.0.11"
+#define SERIES_B1 "1.2.276.0.7230010.3.1.3.0.12"
+
+
+/** delete all files of a storage area and the storage area itself
+ *  @param storageArea name of the storage area
+ */
+static void removeStorageArea(const char *storageArea = STORAGE_AREA)
+{
+    OFVector<OFString> files;
+    for (OFdirectory_iterator it(storageArea); it != OFdirectory_iterator(); ++it)
+        files.push_back(it->path().native());
+    for (size_t i = 0; i < files.size(); ++i)
+        OFStandard::deleteFile(files[i]);
+    /* removes the (now empty) directory on most systems */
+    remove(storageArea);
+}
+
+
+/** create a DICOM file in the storage area and add it to the index
+ *  @param handle database handle
+ *  @param number number of the instance, used for the SOP Instance UID and the filename
+ *  @param patientID patient ID
+ *  @param studyUID study instance UID
+ *  @param seriesUID series instance UID
+ *  @param modality modality of the series
+ *  @param seriesNumber series number
+ */
+static void storeInstance(DcmQueryRetrieveIndexDatabaseHandle& handle,
+                          const unsigned int number,
+                          const char *patientID,
+                          const char *studyUID,
+                          const char *seriesUID,
+                          const char *modality,
+                          const char *seriesNumber)
+{
+    char sopInstanceUID[65];
+    char filename[64];
+    OFStandard::snprintf(sopInstanceUID, sizeof(sopInstanceUID), "1.2.276.0.7230010.3.1.4.0.%u", number);
+    OFStandard::snprintf(filename, sizeof(filename), "%s%c%u.dcm", STORAGE_AREA, PATH_SEPARATOR, number);
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    OFCHECK(dataset->putAndInsertString(DCM_SOPClassUID, UID_SecondaryCaptureImageStorage).good());
+    OFCHECK(dataset->putAndInsertString(DCM_SOPInstanceUID, sopInstanceUID).good());
+    OFCHECK(dataset->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(dataset->putAndInsertString(DCM_PatientID, patientID).good());
+    OFCHECK(dataset->putAndInsertString(DCM_StudyInstanceUID, studyUID).good());
+    OFCHECK(dataset->putAndInsertString(DCM_StudyDate, "20260101").good());
+    OFCHECK(dataset->putAndInsertString(DCM_SeriesInstanceUID, seriesUID).good());
+    OFCHECK(dataset->putAndInsertString(DCM_Modality, modality).good());
+    OFCHECK(dataset->putAndInsertString(DCM_SeriesNumber, seriesNumber).good());
+    OFCHECK(fileformat.saveFile(filename, EXS_LittleEndianExplicit).good());
+    DcmQueryRetrieveDatabaseStatus status;
+    OFCondition result;
+    OFCHECK_MSG((result = handle.storeRequest(UID_SecondaryCaptureImageStorage, sopInstanceUID, filename, &status)).good(), result.text());
+    OFCHECK_EQUAL(status.status(), STATUS_Success);
+}
+
+
+/** create the storage area with the following instances (stored in this order):
+ *  study A of patient P1 with series A1 (CT, two instances with different
+ *  series numbers) and A2 (MR, one instance), study B of patient P2 with
+ *  series B1 (CT, one instance)
+ */
+static void createStorageArea()
+{
+    removeStorageArea();
+    OFCHECK(OFStandard::createDirectory(STORAGE_AREA, "").good());
+    OFCondition result;
+    DcmQueryRetrieveIndexDatabaseHandle handle(STORAGE_AREA, -1, -1, result);
+    OFCHECK_MSG(result.good(), result.text());
+    handle.enableQuotaSystem(OFFalse);
+    storeInstance(handle, 1, "P1", STUDY_A, SERIES_A1, "CT", "99");
+    storeInstance(handle, 2, "P1", STUDY_A, SERIES_A1, "CT", "1");
+    storeInstance(handle, 3, "P1", STUDY_A, SERIES_A2, "MR", "2");
+    storeInstance(handle, 4, "P2", STUDY_B, SERIES_B1, "CT", "1");
+}
+
+
+/** perform a C-FIND request and describe each response by the values of
+ *  the given keys
+ *  @param query request identifier
+ *  @param keys tags of the keys that describe a response
+ *  @param storageArea name of the storage area
+ *  @param model SOP class UID of the query/retrieve information model
+ *  @return sorted descriptions of the responses
+ */
+static OFVector<OFString> find(DcmDataset& query,
+                               const OFVector<DcmTagKey>& keys,
+                               const char *storageArea = STORAGE_AREA,
+                               const char *model = UID_FINDStudyRootQueryRetrieveInformationModel)
+{
+    OFVector<OFString> responses;
+    OFCondition result;
+    DcmQueryRetrieveIndexDatabaseHandle handle(storageArea, -1, -1, result);
+    OFCHECK_MSG(result.good(), result.text());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (!query.tagExists(keys[i]))
+            OFCHECK(query.insertEmptyElement(keys[i]).good());
+    }
+    DcmQueryRetrieveDatabaseStatus status;
+    OFCHECK_MSG((result = handle.startFindRequest(model, &query, &status)).good(), result.text());
+    const DcmQueryRetrieveCharacterSetOptions characterSetOptions;
+    while (status.status() == STATUS_Pending)
+    {
+        DcmDataset *response = NULL;
+        OFCHECK_MSG((result = handle.nextFindResponse(&response, &status, characterSetOptions)).good(), result.text());
+        if (response == NULL)
+            break;
+        OFString description, value;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            value.clear();
+            response->findAndGetOFStringArray(keys[i], value);
+            description += value + "|";
+        }
+        delete response;
+        // keep the responses sorted, the order depends on the candidates
+        OFVector<OFString>::iterator pos = responses.begin();
+        while ((pos != responses.end()) && (*pos < description))
+            ++pos;
+        responses.insert(pos, description);
+    }
+    OFCHECK(status.status() == STATUS_Success);
+    return responses;
+}
+
+
+/** check whether two C-FIND requests returned the same responses
+ *  @param first responses of the first request
+ *  @param second responses of the second request
+ *  @return OFTrue if the responses are equal, OFFalse otherwise
+ */
+static OFBool sameResponses(const OFVector<OFString>& first,
+                            const OFVector<OFString>& second)
+{
+    if (first.size() != second.size())
+        return OFFalse;
+    for (size_t i = 0; i < first.size(); ++i)
+    {
+        if (first[i] != second[i])
+            return OFFalse;
+    }
+    return OFTrue;
+}
+
+
+OFTEST(dcmqrdb_find_summary_study_level)
+{
+    createStorageArea();
+    OFVector<DcmTagKey> keys;
+    keys.push_back(DCM_StudyInstanceUID);
+    keys.push_back(DCM_PatientID);
+    keys.push_back(DCM_ModalitiesInStudy);
+    keys.push_back(DCM_NumberOfStudyRelatedSeries);
+    keys.push_back(DCM_NumberOfStudyRelatedInstances);
+
+    // only return keys, i.e. the records representing the studies are compared
+    DcmDataset query;
+    OFCHECK(query.putAndInsertString(DCM_QueryRetrieveLevel, "STUDY").good());
+    const OFVector<OFString> summary = find(query, keys);
+    OFCHECK_EQUAL(summary.size(), 2);
+    if (summary.size() == 2)
+    {
+        OFCHECK_EQUAL(summary[0], STUDY_A "|P1|CT\\MR|2|3|");
+        OFCHECK_EQUAL(summary[1], STUDY_B "|P2|CT|1|1|");
+    }
+
+    // the patient ID is the same for all records of a study
+    OFCHECK(query.putAndInsertString(DCM_PatientID, "P?").good());
+    OFCHECK(sameResponses(find(query, keys), summary));
+
+    // any other matching key that is not a UID requires all records to be compared
+    OFCHECK(query.putAndInsertString(DCM_PatientID, "").good());
+    OFCHECK(query.putAndInsertString(DCM_PatientName, "Doe*").good());
+    OFCHECK(sameResponses(find(query, keys), summary));
+
+    // only the study with an MR series matches, even though its first
+    // series is a CT series
+    OFCHECK(query.putAndInsertString(DCM_PatientName, "").good());
+    OFCHECK(query.putAndInsertString(DCM_ModalitiesInStudy, "MR").good());
+    const OFVector<OFString> modality = find(query, keys);
+    OFCHECK_EQUAL(modality.size(), 1);
+    if (modality.size() == 1)
+        OFCHECK_EQUAL(modality[0], summary[0]);
+    OFCHECK(query.putAndInsertString(DCM_PatientID, "P1").good());
+    OFCHECK(sameResponses(find(query, keys), modality));
+    removeStorageArea();
+}
+
+
+OFTEST(dcmqrdb_find_summary_series_level)
+{
+    createStorageArea();
+    OFVector<DcmTagKey> keys;
+    keys.push_back(DCM_SeriesInstanceUID);
+    keys.push_back(DCM_Modality);
+    keys.push_back(DCM_NumberOfSeriesRelatedInstances);
+
+    // only the unique key of the study level, i.e. the records representing
+    // the series are compared
+    DcmDataset query;
+    OFCHECK(query.putAndInsertString(DCM_QueryRetrieveLevel, "SERIES").good());
+    OFCHECK(query.putAndInsertString(DCM_StudyInstanceUID, STUDY_A).good());
+    const OFVector<OFString> summary = find(query, keys);
+    OFCHECK_EQUAL(summary.size(), 2);
+    if (summary.size() == 2)
+    {
+        OFCHECK_EQUAL(summary[0], SERIES_A1 "|CT|2|");
+        OFCHECK_EQUAL(summary[1], SERIES_A2 "|MR|1|");
+    }
+
+    // a matching key that is not a UID requires all records to be compared
+    OFCHECK(query.putAndInsertString(DCM_Modality, "??").good());
+    OFCHECK(sameResponses(find(query, keys), summary));
+
+    // the series number only matches the first instance of series A1,
+    // which does not represent the series in the summary index
+    OFCHECK(query.putAndInsertString(DCM_Modality, "").good());
+    OFCHECK(query.putAndInsertString(DCM_SeriesNumber, "99").good());
+    const OFVector<OFString> description = find(query, keys);
+    OFCHECK_EQUAL(description.size(), 1);
+    if (description.size() == 1)
+        OFCHECK_EQUAL(description[0], summary[0]);
+    removeStorageArea();
+}
+
+
+OFTEST(dcmqrdb_find_summary_patient_root)
+{
+    createStorageArea();
+    OFVector<DcmTagKey> studyKeys;
+    studyKeys.push_back(DCM_StudyInstanceUID);
+    studyKeys.push_back(DCM_ModalitiesInStudy);
+    studyKeys.push_back(DCM_NumberOfStudyRelatedSeries);
+    studyKeys.push_back(DCM_NumberOfStudyRelatedInstances);
+    OFVector<DcmTagKey> seriesKeys;
+    seriesKeys.push_back(DCM_SeriesInstanceUID);
+    seriesKeys.push_back(DCM_Modality);
+    seriesKeys.push_back(DCM_NumberOfSeriesRelatedInstances);
+
+    // the unique key of the patient level is required in the Patient Root
+    // model, the responses are the same as in the Study Root model
+    DcmDataset query;
+    OFCHECK(query.putAndInsertString(DCM_QueryRetrieveLevel, "STUDY").good());
+    OFCHECK(query.putAndInsertString(DCM_PatientID, "P1").good());
+    const OFVector<OFString> studies = find(query, studyKeys, STORAGE_AREA, UID_FINDPatientRootQueryRetrieveInformationModel);
+    OFCHECK_EQUAL(studies.size(), 1);
+    if (studies.size() == 1)
+        OFCHECK_EQUAL(studies[0], STUDY_A "|CT\\MR|2|3|");
+    OFCHECK(sameResponses(find(query, studyKeys), studies));
+
+    OFCHECK(query.putAndInsertString(DCM_QueryRetrieveLevel, "SERIES").good());
+    OFCHECK(query.putAndInsertString(DCM_StudyInstanceUID, STUDY_A).good());
+    const OFVector<OFString> series = find(query, seriesKeys, STORAGE_AREA, UID_FINDPatientRootQueryRetrieveInformationModel);
+    OFCHECK_EQUAL(series.size(), 2);
+    if (series.size() == 2)
+    {
+        OFCHECK_EQUAL(series[0], SERIES_A1 "|CT|2|");
+        OFCHECK_EQUAL(series[1], SERIES_A2 "|MR|1|");
+    }
+    OFCHECK(query.putAndInsertString(DCM_PatientID, "").good());
+    OFCHECK(sameResponses(find(query, seriesKeys), series));
+
+    // the study of another patient is not found
+    OFCHECK(query.putAndInsertString(DCM_PatientID, "P2").good());
+    OFCHECK(find(query, seriesKeys, STORAGE_AREA, UID_FINDPatientRootQueryRetrieveInformationModel).empty());
+    removeStorageArea();
+}
+
+
+/** describe all records of a storage area by C-FIND requests at study,
+ *  series and image level
+ *  @param storageArea name of the storage area
+ *  @return descriptions of the responses, sorted per level
+ */
+static OFVector<OFString> findAll(const char *storageArea)
+{
+    OFVector<OFString> all;
+    OFVector<DcmTagKey> studyKeys;
+    studyKeys.push_back(DCM_StudyInstanceUID);
+    studyKeys.push_back(DCM_PatientID);
+    studyKeys.push_back(DCM_StudyDate);
+    studyKeys.push_back(DCM_ModalitiesInStudy);
+    studyKeys.push_back(DCM_NumberOfStudyRelatedSeries);
+    studyKeys.push_back(DCM_NumberOfStudyRelatedInstances);
+    OFVector<DcmTagKey> seriesKeys;
+    seriesKeys.push_back(DCM_SeriesInstanceUID);
+    seriesKeys.push_back(DCM_Modality);
+    seriesKeys.push_back(DCM_SeriesNumber);
+    seriesKeys.push_back(DCM_NumberOfSeriesRelatedInstances);
+    OFVector<DcmTagKey> imageKeys;
+    imageKeys.push_back(DCM_SOPInstanceUID);
+
+    DcmDataset studyQuery;
+    OFCHECK(studyQuery.putAndInsertString(DCM_QueryRetrieveLevel, "STUDY").good());
+    const OFVector<OFString> studies = find(studyQuery, studyKeys, storageArea);
+    for (size_t i = 0; i < studies.size(); ++i)
+    {
+        all.push_back(studies[i]);
+        const OFString studyUID = studies[i].substr(0, studies[i].find('|'));
+        DcmDataset seriesQuery;
+        OFCHECK(seriesQuery.putAndInsertString(DCM_QueryRetrieveLevel, "SERIES").good());
+        OFCHECK(seriesQuery.putAndInsertString(DCM_StudyInstanceUID, studyUID.c_str()).good());
+        const OFVector<OFString> series = find(seriesQuery, seriesKeys, storageArea);
+        for (size_t j = 0; j < series.size(); ++j)
+        {
+            all.push_back(series[j]);
+            const OFString seriesUID = series[j].substr(0, series[j].find('|'));
+            DcmDataset imageQuery;
+            OFCHECK(imageQuery.putAndInsertString(DCM_QueryRetrieveLevel, "IMAGE").good());
+            OFCHECK(imageQuery.putAndInsertString(DCM_StudyInstanceUID, studyUID.c_str()).good());
+            OFCHECK(imageQuery.putAndInsertString(DCM_SeriesInstanceUID, seriesUID.c_str()).good());
+            const OFVector<OFString> images = find(imageQuery, imageKeys, storageArea);
+            all.insert(all.end(), images.begin(), images.end());
+        }
+    }
+    return all;
+}
+
+
+OFTEST(dcmqrdb_rebuild_index)
+{
+    // index the files of the storage area one by one
+    createStorageArea();
+    OFList<OFString> files;
+    for (unsigned int i = 1; i <= 4; ++i)
+    {
+        char filename[64];
+        OFStandard::snprintf(filename, sizeof(filename), "%s%c%u.dcm", STORAGE_AREA, PATH_SEPARATOR, i);
+        files.push_back(filename);
+    }
+
+    // index the same files in one pass, as "dcmqridx --rebuild" does
+    removeStorageArea(REBUILD_STORAGE_AREA);
+    OFCHECK(OFStandard::createDirectory(REBUILD_STORAGE_AREA, "").good());
+    OFCondition result;
+    OFCHECK_MSG((result = DcmQueryRetrieveIndexDatabaseHandle::rebuildIndexFile(REBUILD_STORAGE_AREA, files, OFTrue, 2)).good(), result.text());
+
+    // both indexes describe the same studies, series and instances
+    const OFVector<OFString> sequential = findAll(STORAGE_AREA);
+    const OFVector<OFString> rebuilt = findAll(REBUILD_STORAGE_AREA);
+    OFCHECK_EQUAL(sequential.size(), 2 + 3 + 4);
+    OFCHECK(sameResponses(sequential, rebuilt));
+
+    // the secondary and summary index are used by queries with a UID
+    OFVector<DcmTagKey> keys;
+    keys.push_back(DCM_SeriesInstanceUID);
+    keys.push_back(DCM_Modality);
+    keys.push_back(DCM_NumberOfSeriesRelatedInstances);
+    DcmDataset query;
+    OFCHECK(query.putAndInsertString(DCM_QueryRetrieveLevel, "SERIES").good());
+    OFCHECK(query.putAndInsertString(DCM_StudyInstanceUID, STUDY_A).good());
+    OFCHECK(query.putAndInsertString(DCM_SeriesInstanceUID, SERIES_A1).good());
+    const OFVector<OFString> series = find(query, keys, REBUILD_STORAGE_AREA);
+    OFCHECK(sameResponses(series, find(query, keys)));
+    OFCHECK_EQUAL(series.size(), 1);
+    removeStorageArea(REBUILD_STORAGE_AREA);
+    removeStorageArea();
+}
@@ -24,5 +24,6 @@
 
 OFTEST_REGISTER(dcmtls_scp_tls);
 OFTEST_REGISTER(dcmtls_scp_pool_tls);
+OFTEST_REGISTER(dcmtls_scu_association_pool_tls);
 
 OFTEST_MAIN("dcmtls")
@@ -15,7 +15,7 @@
  *
  *  Authors:  Michel Amat, Damien Lerat
  *
- *  Purpose: TLS test for classes DcmSCP and DcmSCPPool
+ *  Purpose: TLS test for classes DcmSCP, DcmSCPPool and DcmSCUAssociationPool
  *
  *  Note: This test will fail after 2029-02-25 due to certificate expiry.
  *        The keys embedded in this file should be replaced then (see below).
@@ -31,6 +31,7 @@
 #include "dcmtk/dcmnet/scp.h"
 #include "dcmtk/dcmnet/scu.h"
 #include "dcmtk/dcmnet/scppool.h"
+#include "dcmtk/dcmnet/scupool.h"
 #include "dcmtk/dcmnet/dcmlayer.h"
 #include "dcmtk/dcmtls/tlsscu.h"
 #include <cmath>
@@ -483,6 +484,73 @@ OFTEST_FLAGS(dcmtls_scp_pool_tls, EF_None)
     pool.join();
 }
 
+
+// Test case that checks whether the SCU association pool negotiates TLS
+// associations with the given transport layer and hands them over again
+OFTEST_FLAGS(dcmtls_scu_association_pool_tls, EF_None)
+{
+    /// Write key and cert files
+    write_temp_key_cert_files();
+
+    /// Init scp tls layer
+    OFCondition result;
+    DcmTLSTransportLayer scpTlsLayer(NET_ACCEPTOR, NULL, OFTrue);
+    scpTlsLayer.setPrivateKeyPasswd(PRIVATE_KEY_PWD);
+    result = scpTlsLayer.setPrivateKeyFile(PRIVATE_KEY_FILENAME, DCF_Filetype_PEM);
+    OFCHECK(result.good());
+    result = scpTlsLayer.setCertificateFile(PUBLIC_SELFSIGNED_CERT_FILENAME, DCF_Filetype_PEM, TSP_Profile_BCP_195_RFC_8996);
+    OFCHECK(result.good());
+    OFCHECK(scpTlsLayer.checkPrivateKeyMatchesCertificate());
+    scpTlsLayer.setCertificateVerification(DCV_ignoreCertificate);
+
+    /// Init and run Scp server with tls, which does not accept a second association
+    TestSCP scp;
+    DcmSCPConfig& config = scp.getConfig();
+    config.setAETitle("ACCEPTOR");
+    config.setACSETimeout(30);
+    config.setHostLookupEnabled(false);
+    config.setConnectionBlockingMode(DUL_BLOCK);
+    config.setPort(0);
+    OFList<OFString> xfers;
+    xfers.push_back(UID_LittleEndianImplicitTransferSyntax);
+    OFCHECK(config.addPresentationContext(UID_VerificationSOPClass, xfers, ASC_SC_ROLE_DEFAULT).good());
+    config.setTransportLayer(&scpTlsLayer);
+    scp.m_set_stop_after_assoc = OFTrue;
+    if (scp.openListenPort().bad()) BAILOUT("Cannot open listen port of the SCP");
+    const Uint16 port_number = config.getPort();
+    scp.start();
+    force_sleep(1);
+
+    /// Init scu tls layer, which must outlive the pooled association
+    DcmTLSTransportLayer scuTlsLayer(NET_REQUESTOR, NULL, OFTrue);
+    scuTlsLayer.setCertificateVerification(DCV_ignoreCertificate);
+
+    DcmSCUAssociationPool pool;
+    for (int i = 0; i < 2; ++i)
+    {
+        DcmSCU scu;
+        scu.setAETitle("REQUESTOR");
+        scu.setPeerAETitle("ACCEPTOR");
+        scu.setPeerHostName("localhost");
+        scu.setPeerPort(port_number);
+        OFCHECK(scu.addPresentationContext(UID_VerificationSOPClass, xfers).good());
+        // the transport layer is part of the key, a plain association would not match
+        OFCHECK(DcmSCUAssociationPool::createKey(scu, &scuTlsLayer) != DcmSCUAssociationPool::createKey(scu));
+        OFCHECK_MSG((result = pool.connect(scu, &scuTlsLayer)).good(), result.text());
+        OFCHECK(scu.getTLSEnabled());
+        OFCHECK_MSG((result = scu.sendECHORequest(0)).good(), result.text());
+        OFCHECK_MSG((result = pool.release(scu)).good(), result.text());
+        OFCHECK_EQUAL(pool.getNumberOfIdleAssociations(), 1);
+    }
+    OFCHECK_EQUAL(pool.getNumberOfCreatedAssociations(), 1);
+    OFCHECK_EQUAL(pool.getNumberOfReusedAssociations(), 1);
+
+    // releasing the idle association ends the SCP
+    pool.clear();
+    scp.join();
+    OFCHECK(scp.m_listen_result == NET_EC_StopAfterAssociation);
+}
+
 #endif // WITH_OPENSSL
 
 #endif // WITH_THREADS
@@ -498,6 +566,10 @@ OFTEST(dcmtls_scp_pool_tls)
 {
 }
 
+OFTEST(dcmtls_scu_association_pool_tls)
+{
+}
+
 // This dummy function creates a dependency on libdcmnet that is required when compiling
 // on NetBSD with libwrap support enabled and OpenSSL support disabled. Otherwise there
 // would be a linker error complaining about unresolved symbols allow_severity and deny_severity.
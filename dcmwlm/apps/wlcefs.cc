@@ -75,7 +75,7 @@ WlmConsoleEngineFileSystem::WlmConsoleEngineFileSystem( int argc, char *argv[],
     opt_maxPDU( ASC_DEFAULTMAXPDU ), opt_networkTransferSyntax( EXS_Unknown ),
     opt_failInvalidQuery( OFTrue ), opt_singleProcess( OFTrue ),
     opt_forkedChild( OFFalse ), opt_maxAssociations( 50 ), opt_noSequenceExpansion( OFFalse ),
-    opt_enableRejectionOfIncompleteWlFiles( OFTrue ), opt_blockMode(DIMSE_BLOCKING),
+    opt_enableRejectionOfIncompleteWlFiles( OFTrue ), opt_enableWorklistCache( OFTrue ), opt_threadedMode( OFFalse ), opt_blockMode(DIMSE_BLOCKING),
     opt_dimse_timeout(0), opt_acse_timeout(30), app( NULL ), cmd( NULL ), command_argc( argc ),
     command_argv(argv), dataSource( dataSourcev )
 {
@@ -107,10 +107,15 @@ WlmConsoleEngineFileSystem::WlmConsoleEngineFileSystem( int argc, char *argv[],
     cmd->addOption("--version",                          "print version information and exit", OFCommandLine::AF_Exclusive);
     OFLog::addOptions(*cmd);
 
-#if defined(HAVE_FORK) || defined(_WIN32)
+#if defined(HAVE_FORK) || defined(_WIN32) || defined(WITH_THREADS)
   cmd->addGroup("multi-process options:", LONGCOL, SHORTCOL + 2);
     cmd->addOption("--single-process",        "-s",      "single process mode");
+#if defined(HAVE_FORK) || defined(_WIN32)
     cmd->addOption("--fork",                             "fork child process for each association (def.)");
+#endif
+#ifdef WITH_THREADS
+    cmd->addOption("--threads",               "-th",     "handle associations in a pool of threads");
+#endif
 #ifdef _WIN32
     cmd->addOption("--forked-child",                     "process is forked child, internal use only", OFCommandLine::AF_Internal);
 #endif
@@ -126,6 +131,8 @@ WlmConsoleEngineFileSystem::WlmConsoleEngineFileSystem( int argc, char *argv[],
     cmd->addSubGroup("handling of worklist files:");
       cmd->addOption("--enable-file-reject",  "-efr",    "enable rejection of incomplete worklist files\n(default)");
       cmd->addOption("--disable-file-reject", "-dfr",    "disable rejection of incomplete worklist files");
+      cmd->addOption("--enable-file-cache",   "-efc",    "keep worklist files in memory and only read\nmodified files for each query (default)");
+      cmd->addOption("--disable-file-cache",  "-dfc",    "read all worklist files for each query");
 
   cmd->addGroup("processing options:");
     cmd->addSubGroup("returned character set:");
@@ -227,10 +234,27 @@ WlmConsoleEngineFileSystem::WlmConsoleEngineFileSystem( int argc, char *argv[],
     OFLog::configureFromCommandLine(*cmd, *app);
 
     // general options
-#if defined(HAVE_FORK) || defined(_WIN32)
+#if defined(HAVE_FORK) || defined(_WIN32) || defined(WITH_THREADS)
     cmd->beginOptionBlock();
-    if (cmd->findOption("--single-process")) opt_singleProcess = OFTrue;
-    if (cmd->findOption("--fork")) opt_singleProcess = OFFalse;
+    if (cmd->findOption("--single-process"))
+    {
+      opt_singleProcess = OFTrue;
+      opt_threadedMode = OFFalse;
+    }
+#if defined(HAVE_FORK) || defined(_WIN32)
+    if (cmd->findOption("--fork"))
+    {
+      opt_singleProcess = OFFalse;
+      opt_threadedMode = OFFalse;
+    }
+#endif
+#ifdef WITH_THREADS
+    if (cmd->findOption("--threads"))
+    {
+      opt_singleProcess = OFFalse;
+      opt_threadedMode = OFTrue;
+    }
+#endif
     cmd->endOptionBlock();
 #ifdef _WIN32
     if (cmd->findOption("--forked-child")) opt_forkedChild = OFTrue;
@@ -245,6 +269,11 @@ WlmConsoleEngineFileSystem::WlmConsoleEngineFileSystem( int argc, char *argv[],
     if( cmd->findOption("--disable-file-reject") ) opt_enableRejectionOfIncompleteWlFiles = OFFalse;
     cmd->endOptionBlock();
 
+    cmd->beginOptionBlock();
+    if( cmd->findOption("--enable-file-cache") ) opt_enableWorklistCache = OFTrue;
+    if( cmd->findOption("--disable-file-cache") ) opt_enableWorklistCache = OFFalse;
+    cmd->endOptionBlock();
+
     // processing options
     cmd->beginOptionBlock();
     if( cmd->findOption("--return-no-char-set") ) opt_returnedCharacterSet = RETURN_NO_CHARACTER_SET;
@@ -341,6 +370,7 @@ WlmConsoleEngineFileSystem::WlmConsoleEngineFileSystem( int argc, char *argv[],
   // set specific parameters in data source object
   dataSource->SetDfPath( opt_dfPath );
   dataSource->SetEnableRejectionOfIncompleteWlFiles( opt_enableRejectionOfIncompleteWlFiles );
+  dataSource->SetEnableWorklistCache( opt_enableWorklistCache );
 }
 
 // ----------------------------------------------------------------------------
@@ -411,6 +441,8 @@ int WlmConsoleEngineFileSystem::StartProvidingService()
       return( 1 );
   }
 
+  activityManager->setThreadedMode( opt_threadedMode );
+
   cond = activityManager->StartProvidingService();
   if( cond.bad() )
   {
@@ -80,6 +80,10 @@ class WlmConsoleEngineFileSystem
     OFBool opt_noSequenceExpansion;
     /// indicates if wl-files which are lacking return type 1 attributes or information in such attributes shall be rejected or not
     OFBool opt_enableRejectionOfIncompleteWlFiles;
+    /// indicates if the wl-files are cached in memory or read for each query
+    OFBool opt_enableWorklistCache;
+    /// indicates if associations are handled in a pool of threads
+    OFBool opt_threadedMode;
     /// blocking mode for DIMSE operations
     T_DIMSE_BlockingMode opt_blockMode;
     /// timeout for DIMSE operations
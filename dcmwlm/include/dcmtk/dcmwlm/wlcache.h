@@ -0,0 +1,195 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for caching and indexing the worklist files of a directory.
+ *
+ */
+
+#ifndef WlmWorklistCache_h
+#define WlmWorklistCache_h
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/ofstd/ofstring.h"
+#include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/ofmap.h"
+#include "dcmtk/ofstd/ofmem.h"
+#include "dcmtk/ofstd/offilsys.h"
+#include "dcmtk/dcmwlm/wldefine.h"
+
+class DcmDataset;
+class DcmItem;
+class DcmTagKey;
+
+/** This class keeps the datasets of all worklist files (*.wl) of a directory
+ *  in memory, so that the files are only read again after they have been
+ *  modified. The datasets are indexed by Patient ID, Accession Number and the
+ *  Scheduled Station AE Title, Modality and Scheduled Procedure Step Start Date
+ *  of the Scheduled Procedure Step Sequence items, which allows for determining
+ *  the candidates of a query without comparing all datasets with the search
+ *  mask. Modified, added and removed files are detected by comparing the
+ *  modification time, status change time, size and file serial number (inode)
+ *  of each file with those recorded when it was read. Since these times only
+ *  have a resolution of one second, a file that was modified in the same second
+ *  in which it was read is read again on the next refresh.
+ */
+class DCMTK_DCMWLM_EXPORT WlmWorklistCache
+{
+  public:
+    /** A worklist file of the directory. */
+    struct DCMTK_DCMWLM_EXPORT Entry
+    {
+      /// default constructor
+      Entry();
+
+      /// path of the worklist file
+      OFpath path;
+      /// modification time of the file when it was read
+      Uint64 modificationTime;
+      /// status change time of the file when it was read
+      Uint64 changeTime;
+      /// size of the file when it was read
+      Uint64 size;
+      /// file serial number (inode) of the file when it was read
+      Uint64 fileID;
+      /// indicates whether the file might have been modified after it was read
+      /// without changing its modification time, i.e. in the same second
+      OFBool racy;
+      /// dataset of the file, empty if the file could not be read
+      OFshared_ptr<DcmDataset> dataset;
+      /// indicates whether the dataset has been checked for completeness
+      OFBool completenessChecked;
+      /// result of the completeness check, if any
+      OFBool complete;
+    };
+
+      /** constructor.
+       *  @param directory directory containing the worklist files
+       */
+    WlmWorklistCache( const OFpath& directory );
+
+      /** destructor
+       */
+    ~WlmWorklistCache();
+
+      /** Reads all worklist files of the directory that have been added or
+       *  modified since the last call and forgets about the removed files.
+       *  Files that were modified in the second in which they were read last
+       *  time are always read again.
+       *  The index is rebuilt if any file has changed.
+       *  @return The number of files that have been read.
+       */
+    size_t Refresh();
+
+      /** Returns the number of worklist files of the directory, including
+       *  those that could not be read.
+       *  @return The number of worklist files.
+       */
+    size_t GetNumberOfEntries() const;
+
+      /** Determines the entries whose datasets may match the given search mask.
+       *  Only one indexed attribute of the search mask is used, i.e. the
+       *  candidates still have to be compared with the search mask. If none
+       *  of the indexed attributes can be used, all entries with a dataset are
+       *  candidates.
+       *  @param searchMask The search mask.
+       *  @param candidates Returns the candidate entries in the order of the
+       *    directory.
+       */
+    void DetermineCandidates( DcmItem& searchMask, OFVector<Entry*>& candidates );
+
+  private:
+    /** The entries of each value of an indexed attribute. */
+    struct Index
+    {
+      /// positions of the entries with a given (trimmed) value
+      OFMap<OFString, OFVector<size_t> > values;
+      /// positions of the entries with an empty value, which are always candidates
+      OFVector<size_t> unindexed;
+    };
+
+    /** A Scheduled Procedure Step Start Date of an entry. */
+    struct DateEntry
+    {
+      /// date as a number YYYYMMDD
+      Uint32 date;
+      /// position of the entry
+      size_t pos;
+    };
+
+      /** Privately defined copy constructor.
+       *  @param old Object which shall be copied.
+       */
+    WlmWorklistCache( const WlmWorklistCache &old );
+
+      /** Privately defined assignment operator.
+       *  @param obj Object which shall be copied.
+       *  @return Reference to this.
+       */
+    WlmWorklistCache &operator=( const WlmWorklistCache &obj );
+
+      /** Rebuilds the indexes from the datasets of all entries.
+       */
+    void BuildIndexes();
+
+      /** Adds the value of an attribute of the given item to an index. Items
+       *  without the attribute are not added, since they never match a
+       *  query that specifies a value for the attribute.
+       *  @param index The index.
+       *  @param item The item containing the attribute.
+       *  @param tag The attribute.
+       *  @param pos Position of the entry.
+       */
+    static void AddToIndex( Index& index, DcmItem& item, const DcmTagKey& tag, size_t pos );
+
+      /** Determines the entries of the given index that may match the value
+       *  of the given attribute in the query item.
+       *  @param index The index.
+       *  @param query The query item.
+       *  @param tag The attribute.
+       *  @param result Returns the positions of the entries.
+       *  @return OFTrue if the index could be used, OFFalse otherwise.
+       */
+    static OFBool LookupIndex( const Index& index, DcmItem& query, const DcmTagKey& tag, OFVector<size_t>& result );
+
+      /** Determines the entries that may match the Scheduled Procedure Step
+       *  Start Date of the given query item using the date index.
+       *  @param query The query item.
+       *  @param result Returns the positions of the entries.
+       *  @return OFTrue if the index could be used, OFFalse otherwise.
+       */
+    OFBool LookupDates( DcmItem& query, OFVector<size_t>& result ) const;
+
+    /// directory containing the worklist files
+    OFpath directory;
+    /// entries of the directory in the order of the directory
+    OFVector<Entry> entries;
+    /// index of Patient ID
+    Index patientIDIndex;
+    /// index of Accession Number
+    Index accessionNumberIndex;
+    /// index of Scheduled Station AE Title
+    Index stationAETitleIndex;
+    /// index of Modality
+    Index modalityIndex;
+    /// Scheduled Procedure Step Start Dates of the entries, sorted by date
+    OFVector<DateEntry> dates;
+    /// positions of the entries with a date that cannot be indexed
+    OFVector<size_t> undated;
+};
+
+#endif
@@ -335,6 +335,12 @@ class DCMTK_DCMWLM_EXPORT WlmDataSource
        */
     WlmDataSource &operator=( const WlmDataSource &Src );
 
+      /** Copies the general settings of this object (i.e. those which are
+       *  not specific to a certain type of data source) to the given object.
+       *  @param instance The object receiving the settings.
+       */
+    void CopyGeneralSettingsTo( WlmDataSource &instance ) const;
+
 
   public:
       /** default constructor.
@@ -360,6 +366,16 @@ class DCMTK_DCMWLM_EXPORT WlmDataSource
        */
     virtual OFCondition DisconnectFromDataSource() = 0;
 
+      /** Creates a new, unconnected data source object of the same type and with
+       *  the same settings as this object, which can be used in another thread
+       *  concurrently to this object (e.g. for serving another association).
+       *  Data shared by the objects, like an in-memory worklist table, remains
+       *  shared. The caller is responsible for deleting the returned object.
+       *  @return The new data source object, or NULL if the data source does not
+       *          support concurrent use.
+       */
+    virtual WlmDataSource *CreateConcurrentInstance() { return NULL; }
+
       /** Set value in member variable.
        *  @param value The value to set.
        */
@@ -474,6 +490,10 @@ class DCMTK_DCMWLM_EXPORT WlmDataSource
        */
     virtual void SetEnableRejectionOfIncompleteWlFiles( OFBool /*value*/ ) {}
 
+      /** Set value in a member variable in a derived class.
+       */
+    virtual void SetEnableWorklistCache( OFBool /*value*/ ) {}
+
       /** Set value in a member variable in a derived class.
        */
     virtual void SetCreateNullvalues( OFBool /*value*/ ) {}
@@ -45,6 +45,8 @@ class DCMTK_DCMWLM_EXPORT WlmDataSourceFileSystem : public WlmDataSource
     OFString dfPath;
     /// indicates if wl-files which are lacking return type 1 attributes or information in such attributes shall be rejected or not
     OFBool enableRejectionOfIncompleteWlFiles;
+    /// indicates if the wl-files are cached in memory or read for each query
+    OFBool enableWorklistCache;
     /// handle to the read lock file
     int handleToReadLockFile;
 
@@ -52,12 +54,25 @@ class DCMTK_DCMWLM_EXPORT WlmDataSourceFileSystem : public WlmDataSource
        *  that is specified through dfPath and calledApplicationEntityTitle.
        *  @return true in case the read lock has been set successfully, false otherwise.
        */
-    OFBool SetReadlock();
+    virtual OFBool SetReadlock();
 
       /** This function releases a read lock on the LOCKFILE in the given directory.
        *  @return true in case the read lock has been released successfully, false otherwise.
        */
-    OFBool ReleaseReadlock();
+    virtual OFBool ReleaseReadlock();
+
+      /** This function determines the records of the data source which match the
+       *  given search mask and stores them in the fileSystemInteractionManager, from
+       *  where they are retrieved when creating the result datasets.
+       *  @param searchMask The search mask.
+       *  @return The number of matching records.
+       */
+    virtual size_t DetermineMatchingRecords( DcmDataset *searchMask );
+
+      /** Copies the settings of this object to the given object.
+       *  @param instance The object receiving the settings.
+       */
+    void CopySettingsTo( WlmDataSourceFileSystem &instance ) const;
 
       /** This function takes care of handling a certain non-sequence element within
        *  the structure of a certain result dataset. This function assumes that all
@@ -112,6 +127,13 @@ class DCMTK_DCMWLM_EXPORT WlmDataSourceFileSystem : public WlmDataSource
        */
     OFCondition DisconnectFromDataSource();
 
+      /** Creates a new, unconnected data source object with the same settings
+       *  as this object, which can be used in another thread concurrently to
+       *  this object. Each object reads (and caches) the worklist files itself.
+       *  @return The new data source object, to be deleted by the caller.
+       */
+    WlmDataSource *CreateConcurrentInstance();
+
       /** Set value in member variable.
        *  @param value The value to set.
        */
@@ -122,6 +144,11 @@ class DCMTK_DCMWLM_EXPORT WlmDataSourceFileSystem : public WlmDataSource
        */
     void SetEnableRejectionOfIncompleteWlFiles( OFBool value );
 
+      /** Set value in member variable.
+       *  @param value The value to set.
+       */
+    void SetEnableWorklistCache( OFBool value );
+
       /** Checks if the called application entity title is supported. This function expects
        *  that the called application entity title was made available for this instance through
        *  WlmDataSource::SetCalledApplicationEntityTitle(). If this is not the case, OFFalse
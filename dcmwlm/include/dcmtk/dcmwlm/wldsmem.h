@@ -0,0 +1,125 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for connecting to an in-memory data source.
+ *
+ */
+
+#ifndef WlmDataSourceMemory_h
+#define WlmDataSourceMemory_h
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/ofstd/ofmap.h"
+#include "dcmtk/dcmwlm/wldsfs.h"
+#include "dcmtk/dcmwlm/wlmemtab.h"
+
+/** This class encapsulates data structures and operations for connecting to an
+ *  in-memory data source in the framework of the DICOM basic worklist management
+ *  service. The worklist items are kept in a WlmWorklistTable, which is maintained
+ *  by the application through its insert, update and delete methods and can be
+ *  shared by several data source objects, e.g. one per thread of a WlmActivityManager
+ *  in threaded mode. Each C-FIND request is answered from the state the table had
+ *  when the request was received. Apart from reading the worklist items from the
+ *  table instead of the worklist files, queries are processed in the same way as
+ *  by WlmDataSourceFileSystem. Any called application entity title is accepted.
+ */
+class DCMTK_DCMWLM_EXPORT WlmDataSourceMemory : public WlmDataSourceFileSystem
+{
+  protected:
+    /** A copy of the dataset of a worklist item. */
+    struct DatasetCopy
+    {
+      /// default constructor
+      DatasetCopy() : revision( 0 ), dataset() {}
+
+      /// revision of the item the copy was created from
+      Uint64 revision;
+      /// the copy
+      OFshared_ptr<DcmDataset> dataset;
+    };
+
+    /// table containing the worklist items
+    WlmWorklistTable &table;
+    /// copies of the datasets of the worklist items by key. Since even reading a
+    /// dataset is not thread-safe, each object matches its own copies, which are
+    /// only created again after the corresponding item has been updated.
+    OFMap<OFString, DatasetCopy> datasetCopies;
+
+      /** Nothing to lock, since each query operates on a snapshot of the table.
+       *  @return Always OFTrue.
+       */
+    virtual OFBool SetReadlock();
+
+      /** Nothing to unlock, since each query operates on a snapshot of the table.
+       *  @return Always OFTrue.
+       */
+    virtual OFBool ReleaseReadlock();
+
+      /** This function determines the worklist items of the current state of the
+       *  table which match the given search mask.
+       *  @param searchMask The search mask.
+       *  @return The number of matching records.
+       */
+    virtual size_t DetermineMatchingRecords( DcmDataset *searchMask );
+
+      /** Protected undefined copy-constructor. Shall never be called.
+       *  @param Src Source object.
+       */
+    WlmDataSourceMemory( const WlmDataSourceMemory &Src );
+
+      /** Protected undefined operator=. Shall never be called.
+       *  @param Src Source object.
+       *  @return Reference to this.
+       */
+    WlmDataSourceMemory &operator=( const WlmDataSourceMemory &Src );
+
+  public:
+      /** constructor.
+       *  @param tablev The table containing the worklist items, which must exist
+       *    as long as this object.
+       */
+    WlmDataSourceMemory( WlmWorklistTable &tablev );
+
+      /** destructor
+       */
+    ~WlmDataSourceMemory();
+
+      /** Connects to the data source.
+       * @return Always EC_Normal.
+       */
+    OFCondition ConnectToDataSource();
+
+      /** Disconnects from the data source.
+       * @return Always EC_Normal.
+       */
+    OFCondition DisconnectFromDataSource();
+
+      /** Creates a new, unconnected data source object with the same settings
+       *  as this object, which uses the same table and can be used in another
+       *  thread concurrently to this object.
+       *  @return The new data source object, to be deleted by the caller.
+       */
+    WlmDataSource *CreateConcurrentInstance();
+
+      /** Checks if the called application entity title is supported.
+       *  @return OFTrue, if a called application entity title is given,
+       *          OFFalse otherwise.
+       */
+    OFBool IsCalledApplicationEntityTitleSupported();
+};
+
+#endif
@@ -27,7 +27,9 @@
 #include "dcmtk/ofstd/oftypes.h"   /* for OFBool */
 #include "dcmtk/ofstd/ofvector.h"
 #include "dcmtk/ofstd/ofmem.h"
+#include "dcmtk/ofstd/ofmap.h"
 #include "dcmtk/dcmwlm/wldefine.h"
+#include "dcmtk/dcmwlm/wlcache.h"
 
 struct WlmSuperiorSequenceInfoType;
 class DcmDataset;
@@ -66,47 +68,31 @@ class DCMTK_DCMWLM_EXPORT WlmFileSystemInteractionManager
     OFString calledApplicationEntityTitle;
     /// matching records
     OFVector<OFshared_ptr<DcmDataset> > matchingRecords;
+    /// indicates if the worklist files are cached in memory or read for each query
+    OFBool enableWorklistCache;
+    /// cache of the worklist files of each called application entity title
+    OFMap<OFString, OFshared_ptr<WlmWorklistCache> > worklistCaches;
 
       /** Increment the given directory iterator until it refers to a worklist file (or past-the-end).
        *  @param it A reference to an OFdirectory_iterator.
        */
     OFdirectory_iterator& FindNextWorklistFile( OFdirectory_iterator& it );
 
-      /** This function checks if the given dataset (which represents the information from a
-       *  worklist file) contains all necessary return type 1 information. According to the
-       *  DICOM standard part 4 annex K, the following attributes are type 1 attributes in
-       *  C-Find RSP messages:
-       *        Attribute                             Tag      Return Key Type
-       *    SpecificCharacterSet                  (0008,0005)        1C (will be checked in WlmDataSourceFileSystem::StartFindRequest(...); this attribute does not have to be checked here)
-       *    ScheduledProcedureStepSequence        (0040,0100)        1
-       *     > ScheduledStationAETitle            (0040,0001)        1
-       *     > ScheduledProcedureStepStartDate    (0040,0002)        1
-       *     > ScheduledProcedureStepStartTime    (0040,0003)        1
-       *     > Modality                           (0008,0060)        1
-       *     > ScheduledProcedureStepDescription  (0040,0007)        1C (The ScheduledProcedureStepDescription (0040,0007) or the ScheduledProtocolCodeSequence (0040,0008) or both shall be supported by the SCP; we actually support both, so we have to check if at least one of the two attributes contains valid information.)
-       *     > ScheduledProtocolCodeSequence      (0040,0008)        1C (see abobve)
-       *     > > CodeValue                        (0008,0100)        1
-       *     > > CodingSchemeDesignator           (0008,0102)        1
-       *     > ScheduledProcedureStepID           (0040,0009)        1
-       *    RequestedProcedureID                  (0040,1001)        1
-       *    RequestedProcedureDescription         (0032,1060)        1C (The RequestedProcedureDescription (0032,1060) or the RequestedProcedureCodeSequence (0032,1064) or both shall be supported by the SCP; we actually support both, so we have to check if at least one of the two attributes contains valid information.)
-       *    RequestedProcedureCodeSequence        (0032,1064)        1C (see abobve)
-       *     > > CodeValue                        (0008,0100)        1
-       *     > > CodingSchemeDesignator           (0008,0102)        1
-       *    StudyInstanceUID                      (0020,000D)        1
-       *    ReferencedStudySequence               (0008,1110)        2
-       *     > ReferencedSOPClassUID              (0008,1150)        1C (Required if a sequence item is present)
-       *     > ReferencedSOPInstanceUID           (0008,1155)        1C (Required if a sequence item is present)
-       *    ReferencedPatientSequence             (0008,1120)        2
-       *     > ReferencedSOPClassUID              (0008,1150)        1C (Required if a sequence item is present)
-       *     > ReferencedSOPInstanceUID           (0008,1155)        1C (Required if a sequence item is present)
-       *    PatientName                           (0010,0010)        1
-       *    PatientID                             (0010,0020)        1
-       *  @param dataset - [in] The dataset of the worklist file which is currently examined.
-       *  @return OFTrue in case the given dataset contains all necessary return type 1 information,
-       *          OFFalse otherwise.
+      /** Check whether the dataset of a worklist file is complete, if the
+       *  rejection of incomplete worklist files is enabled.
+       *  @param dataset The dataset of the worklist file.
+       *  @param worklistFile The path of the worklist file.
+       *  @return OFFalse if the worklist file shall be rejected, OFTrue otherwise.
        */
-    OFBool DatasetIsComplete( DcmDataset *dataset );
+    OFBool AcceptWorklistDataset( DcmDataset *dataset, const OFpath& worklistFile );
+
+      /** Compare the dataset of a worklist file with the search mask. If the
+       *  dataset matches, it will be added to the matching records member variable.
+       *  @param searchMask A reference to the search mask.
+       *  @param pDataset The dataset of the worklist file.
+       *  @param worklistFile The path of the worklist file.
+       */
+    void MatchWorklistDataset( DcmDataset& searchMask, const OFshared_ptr<DcmDataset>& pDataset, const OFpath& worklistFile );
 
       /** This function checks if the specified sequence attribute is absent or existent but non-empty
        *  and incomplete in the given dataset.
@@ -115,7 +101,7 @@ class DCMTK_DCMWLM_EXPORT WlmFileSystemInteractionManager
        *  @return OFTrue in case the sequence attribute is absent (and cannot be added to the dataset)
        *          or existent but non-empty and incomplete, OFFalse otherwise.
        */
-    OFBool ReferencedStudyOrPatientSequenceIsAbsentOrExistentButNonEmptyAndIncomplete( DcmTagKey sequenceTagKey, DcmItem *dset );
+    static OFBool ReferencedStudyOrPatientSequenceIsAbsentOrExistentButNonEmptyAndIncomplete( DcmTagKey sequenceTagKey, DcmItem *dset );
 
       /** This method ensures that either code or description is set to a non-empty value,
        *  and at the same time none of the attributes is present with a zero-length value.
@@ -127,14 +113,14 @@ class DCMTK_DCMWLM_EXPORT WlmFileSystemInteractionManager
        *          one of both attributes has a non-empty, valid value, and none
        *          is set to an empty value. OFTrue otherwise.
        */
-    OFBool DescriptionAndCodeSequenceAttributesAreIncomplete( DcmTagKey descriptionTagKey, DcmTagKey codeSequenceTagKey, DcmItem *dset );
+    static OFBool DescriptionAndCodeSequenceAttributesAreIncomplete( DcmTagKey descriptionTagKey, DcmTagKey codeSequenceTagKey, DcmItem *dset );
 
       /** This function checks if the specified attribute is absent or contains an empty value in the given dataset.
        *  @param elemTagKey The attribute which shall be checked.
        *  @param dset The dataset in which the attribute is contained.
        *  @return OFTrue in case the attribute is absent or contains an empty value, OFFalse otherwise.
        */
-    OFBool AttributeIsAbsentOrEmpty( DcmTagKey elemTagKey, DcmItem *dset );
+    static OFBool AttributeIsAbsentOrEmpty( DcmTagKey elemTagKey, DcmItem *dset );
 
       /** This function returns OFTrue, if the matching key attribute values in the one of the items of the candidate sequence
        *  match the matching key attribute values in at least one of the items of the query sequence.
@@ -186,6 +172,15 @@ class DCMTK_DCMWLM_EXPORT WlmFileSystemInteractionManager
        */
     void SetEnableRejectionOfIncompleteWlFiles( OFBool value );
 
+      /** Enable or disable caching of the worklist files. If enabled (the default),
+       *  the worklist files of each called application entity title are read only
+       *  once and then kept in memory together with an index of the most commonly
+       *  queried attributes; a file is only read again after its modification time
+       *  or size has changed. If disabled, all worklist files are read for each query.
+       *  @param value The value to set.
+       */
+    void SetEnableWorklistCache( OFBool value );
+
       /** Connects to the worklist file system database.
        *  @param dfPathv Path to worklist file system database.
        *  @return Indicates if the connection could be established or not.
@@ -227,6 +222,54 @@ class DCMTK_DCMWLM_EXPORT WlmFileSystemInteractionManager
        */
     void MatchWorklistFile( DcmDataset& searchMask, const OFpath& worklistFile );
 
+      /** This function determines the records from the given datasets that match
+       *  the given search mask instead of reading the worklist files, and returns
+       *  the number of matching records. The matching records are stored inside
+       *  the member variable matchingRecords, i.e. the datasets are shared with
+       *  the caller and must not be modified until ClearMatchingRecords() is called.
+       *  @param searchMask A pointer to the search mask.
+       *  @param datasets The datasets to be compared with the search mask.
+       *  @return The number of matching records.
+       */
+    size_t DetermineMatchingRecords( DcmDataset* searchMask, const OFVector<OFshared_ptr<DcmDataset> >& datasets );
+
+      /** This function checks if the given dataset (which represents the information from a
+       *  worklist file) contains all necessary return type 1 information. According to the
+       *  DICOM standard part 4 annex K, the following attributes are type 1 attributes in
+       *  C-Find RSP messages:
+       *        Attribute                             Tag      Return Key Type
+       *    SpecificCharacterSet                  (0008,0005)        1C (will be checked in WlmDataSourceFileSystem::StartFindRequest(...); this attribute does not have to be checked here)
+       *    ScheduledProcedureStepSequence        (0040,0100)        1
+       *     > ScheduledStationAETitle            (0040,0001)        1
+       *     > ScheduledProcedureStepStartDate    (0040,0002)        1
+       *     > ScheduledProcedureStepStartTime    (0040,0003)        1
+       *     > Modality                           (0008,0060)        1
+       *     > ScheduledProcedureStepDescription  (0040,0007)        1C (The ScheduledProcedureStepDescription (0040,0007) or the ScheduledProtocolCodeSequence (0040,0008) or both shall be supported by the SCP; we actually support both, so we have to check if at least one of the two attributes contains valid information.)
+       *     > ScheduledProtocolCodeSequence      (0040,0008)        1C (see abobve)
+       *     > > CodeValue                        (0008,0100)        1
+       *     > > CodingSchemeDesignator           (0008,0102)        1
+       *     > ScheduledProcedureStepID           (0040,0009)        1
+       *    RequestedProcedureID                  (0040,1001)        1
+       *    RequestedProcedureDescription         (0032,1060)        1C (The RequestedProcedureDescription (0032,1060) or the RequestedProcedureCodeSequence (0032,1064) or both shall be supported by the SCP; we actually support both, so we have to check if at least one of the two attributes contains valid information.)
+       *    RequestedProcedureCodeSequence        (0032,1064)        1C (see abobve)
+       *     > > CodeValue                        (0008,0100)        1
+       *     > > CodingSchemeDesignator           (0008,0102)        1
+       *    StudyInstanceUID                      (0020,000D)        1
+       *    ReferencedStudySequence               (0008,1110)        2
+       *     > ReferencedSOPClassUID              (0008,1150)        1C (Required if a sequence item is present)
+       *     > ReferencedSOPInstanceUID           (0008,1155)        1C (Required if a sequence item is present)
+       *    ReferencedPatientSequence             (0008,1120)        2
+       *     > ReferencedSOPClassUID              (0008,1150)        1C (Required if a sequence item is present)
+       *     > ReferencedSOPInstanceUID           (0008,1155)        1C (Required if a sequence item is present)
+       *    PatientName                           (0010,0010)        1
+       *    PatientID                             (0010,0020)        1
+       *  Missing type 2 sequence attributes are added to the dataset.
+       *  @param dataset - [in] The dataset of the worklist file which is currently examined.
+       *  @return OFTrue in case the given dataset contains all necessary return type 1 information,
+       *          OFFalse otherwise.
+       */
+    static OFBool DatasetIsComplete( DcmDataset *dataset );
+
       /** For the matching record that is identified through idx, this function returns the number
        *  of items that are contained in the sequence element that is referred to by sequenceTag.
        *  In case this sequence element is itself contained in a certain item of another superior
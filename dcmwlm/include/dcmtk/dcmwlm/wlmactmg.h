@@ -30,6 +30,7 @@
 #include "dcmtk/dcmwlm/wltypdef.h" /* for WlmRefuseReasonType */
 
 class WlmDataSource;
+class WlmAssociationPool;
 class OFCondition;
 
 /** This class encapsulates data structures and operations for basic worklist management service
@@ -37,6 +38,11 @@ class OFCondition;
  */
 class DCMTK_DCMWLM_EXPORT WlmActivityManager
 {
+  private:
+    /// the thread pool and its handlers access the process table and call HandleAssociation()
+    friend class WlmAssociationPool;
+    friend class WlmAssociationHandler;
+
   protected:
     /// data source connection object
     WlmDataSource *dataSource;
@@ -60,6 +66,10 @@ class DCMTK_DCMWLM_EXPORT WlmActivityManager
     OFBool opt_failInvalidQuery;
     /// indicates if the application is run in single process mode or not
     OFBool opt_singleProcess;
+    /// indicates if associations are handled by a pool of threads
+    OFBool opt_threadedMode;
+    /// pool of threads handling the associations in threaded mode
+    WlmAssociationPool *threadPool;
     /// indicates, that this process was spawn as child from a parent process
     /// needed for multiprocess mode on WIN32
     OFBool opt_forkedChild;
@@ -132,17 +142,21 @@ class DCMTK_DCMWLM_EXPORT WlmActivityManager
       /** This function takes care of handling the other DICOM application's request. After
        *  having accomplished all necessary steps, the association will be dropped and destroyed.
        *  @param assoc The association (network connection to another DICOM application).
+       *  @param associationDataSource The data source to be used for this association,
+       *                               the data source of this object is used if NULL.
        */
-    void HandleAssociation( T_ASC_Association *assoc );
+    void HandleAssociation( T_ASC_Association *assoc, WlmDataSource *associationDataSource = NULL );
 
       /** This function takes care of handling the other DICOM application's request.
        *  @param assoc The association (network connection to another DICOM application).
+       *  @param associationDataSource The data source to be used for this association,
+       *                               the data source of this object is used if NULL.
        *  @return An OFCondition value 'cond' for which 'cond.bad()' will always be set
        *          indicating that either some kind of error occurred, or that the peer aborted
        *          the association (DUL_PEERABORTEDASSOCIATION), or that the peer requested the
        *          release of the association (DUL_PEERREQUESTEDRELEASE).
        */
-    OFCondition ReceiveAndHandleCommands( T_ASC_Association *assoc );
+    OFCondition ReceiveAndHandleCommands( T_ASC_Association *assoc, WlmDataSource *associationDataSource = NULL );
 
       /** Having received a DIMSE C-ECHO-RQ message, this function takes care of sending a
        *  DIMSE C-ECHO-RSP message over the network connection.
@@ -160,9 +174,11 @@ class DCMTK_DCMWLM_EXPORT WlmActivityManager
        *  @param request The DIMSE C-FIND-RQ message that was received.
        *  @param presID  The ID of the presentation context which was specified in the PDV
        *                 which contained the DIMSE command.
+       *  @param associationDataSource The data source to be used for this request,
+       *                               the data source of this object is used if NULL.
        *  @return OFCondition value denoting success or error.
        */
-    OFCondition HandleFindSCP( T_ASC_Association *assoc, T_DIMSE_C_FindRQ *request, T_ASC_PresentationContextID presID );
+    OFCondition HandleFindSCP( T_ASC_Association *assoc, T_DIMSE_C_FindRQ *request, T_ASC_PresentationContextID presID, WlmDataSource *associationDataSource = NULL );
 
       /** Protected undefined copy-constructor. Shall never be called.
        *  @param Src Source object.
@@ -243,6 +259,18 @@ class DCMTK_DCMWLM_EXPORT WlmActivityManager
        *  @return       OFTrue if path is accepted, OFFalse otherwise
        */
     OFBool setRequestFilePath(const OFString& path="", const OFString& format="#t.dump");
+
+      /** Enable or disable threaded mode. In threaded mode, associations are not handled
+       *  by child processes but by a pool of threads, which are started on demand up to
+       *  the maximum number of concurrent associations. Each thread uses its own data
+       *  source object created by WlmDataSource::CreateConcurrentInstance(), so the data
+       *  source must support concurrent use. Threaded mode takes precedence over the
+       *  single process mode specified in the constructor.
+       *  @param enabled Specifies if threaded mode shall be enabled.
+       *  @return OFTrue if successful, OFFalse if threaded mode is not available because
+       *          DCMTK has been compiled without thread support.
+       */
+    OFBool setThreadedMode(OFBool enabled);
 };
 
 #endif
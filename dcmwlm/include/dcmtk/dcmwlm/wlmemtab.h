@@ -0,0 +1,244 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for an in-memory table of worklist items.
+ *
+ */
+
+#ifndef WlmWorklistTable_h
+#define WlmWorklistTable_h
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/ofstd/ofstring.h"
+#include "dcmtk/ofstd/oftypes.h"
+#include "dcmtk/ofstd/ofvector.h"
+#include "dcmtk/ofstd/ofmem.h"
+#include "dcmtk/ofstd/ofthread.h"
+#include "dcmtk/ofstd/ofcond.h"
+#include "dcmtk/dcmwlm/wldefine.h"
+
+class DcmDataset;
+
+/** This class manages the worklist items of an in-memory worklist data source
+ *  (see WlmDataSourceMemory). An application can insert, update and delete
+ *  items while the table is queried by other threads. Each item is identified
+ *  by a key chosen by the application, e.g. the accession number or the
+ *  scheduled procedure step ID.
+ *  Changes are never applied to the current state of the table. Instead, a new
+ *  state is created and published atomically, while queries operate on the
+ *  state (snapshot) the table had when the query started. Several changes can
+ *  be combined in a transaction, so that queries either see all or none of
+ *  them. The datasets stored in the table are never modified after they have
+ *  been published; they are only read through CopyDataset().
+ */
+class DCMTK_DCMWLM_EXPORT WlmWorklistTable
+{
+  public:
+    /** A worklist item of the table. */
+    class DCMTK_DCMWLM_EXPORT Item
+    {
+      public:
+          /** default constructor.
+           */
+        Item();
+
+          /** Returns the key of the item.
+           *  @return The key of the item.
+           */
+        const OFString& GetKey() const { return key; }
+
+          /** Returns the revision of the item, which is different for each
+           *  inserted or updated dataset.
+           *  @return The revision of the item.
+           */
+        Uint64 GetRevision() const { return revision; }
+
+      private:
+        friend class WlmWorklistTable;
+
+        /// key of the item
+        OFString key;
+        /// revision of the item
+        Uint64 revision;
+        /// dataset of the item, which is never modified
+        OFshared_ptr<DcmDataset> dataset;
+    };
+
+    /// the state of the table at a point in time, sorted by key
+    typedef OFshared_ptr<const OFVector<Item> > Snapshot;
+
+    /** A list of changes that is applied to the table atomically.
+     */
+    class DCMTK_DCMWLM_EXPORT Transaction
+    {
+      public:
+          /** default constructor.
+           */
+        Transaction();
+
+          /** Adds the insertion of a new item to the transaction.
+           *  @param key The key of the new item.
+           *  @param dataset The dataset of the new item, which is copied.
+           */
+        void InsertItem( const OFString& key, const DcmDataset& dataset );
+
+          /** Adds the replacement of the dataset of an existing item to the transaction.
+           *  @param key The key of the item.
+           *  @param dataset The new dataset of the item, which is copied.
+           */
+        void UpdateItem( const OFString& key, const DcmDataset& dataset );
+
+          /** Adds the deletion of an existing item to the transaction.
+           *  @param key The key of the item.
+           */
+        void DeleteItem( const OFString& key );
+
+          /** Returns the number of changes of the transaction.
+           *  @return The number of changes.
+           */
+        size_t GetNumberOfChanges() const;
+
+          /** Discards all changes of the transaction.
+           */
+        void Clear();
+
+      private:
+        friend class WlmWorklistTable;
+
+        /** A change of the transaction. */
+        struct Change
+        {
+          /// type of the change
+          enum Type { INSERT_ITEM, UPDATE_ITEM, DELETE_ITEM } type;
+          /// key of the item
+          OFString key;
+          /// new dataset of the item (insert and update only)
+          OFshared_ptr<DcmDataset> dataset;
+        };
+
+        /// changes in the order they have been added
+        OFVector<Change> changes;
+    };
+
+      /** default constructor.
+       */
+    WlmWorklistTable();
+
+      /** destructor
+       */
+    ~WlmWorklistTable();
+
+      /** Enable or disable the rejection of items which are lacking return type 1
+       *  attributes or information in such attributes (enabled by default). The
+       *  check is the same as for incomplete worklist files.
+       *  @param value The value to set.
+       */
+    void SetEnableRejectionOfIncompleteItems( OFBool value );
+
+      /** Inserts a new item into the table.
+       *  @param key The key of the new item.
+       *  @param dataset The dataset of the new item, which is copied.
+       *  @return EC_Normal if successful, WLM_EC_WorklistItemAlreadyExists or
+       *    WLM_EC_IncompleteWorklistItem otherwise.
+       */
+    OFCondition InsertItem( const OFString& key, const DcmDataset& dataset );
+
+      /** Replaces the dataset of an existing item of the table.
+       *  @param key The key of the item.
+       *  @param dataset The new dataset of the item, which is copied.
+       *  @return EC_Normal if successful, WLM_EC_WorklistItemNotFound or
+       *    WLM_EC_IncompleteWorklistItem otherwise.
+       */
+    OFCondition UpdateItem( const OFString& key, const DcmDataset& dataset );
+
+      /** Deletes an item from the table.
+       *  @param key The key of the item.
+       *  @return EC_Normal if successful, WLM_EC_WorklistItemNotFound otherwise.
+       */
+    OFCondition DeleteItem( const OFString& key );
+
+      /** Applies all changes of the given transaction to the table at once. If
+       *  any of the changes fails, none of them is applied.
+       *  @param transaction The transaction, which is cleared if successful.
+       *  @return EC_Normal if successful, the error of the first change that
+       *    failed otherwise.
+       */
+    OFCondition Commit( Transaction& transaction );
+
+      /** Deletes all items from the table.
+       */
+    void Clear();
+
+      /** Returns the number of items of the table.
+       *  @return The number of items.
+       */
+    size_t GetNumberOfItems() const;
+
+      /** Retrieves a copy of the dataset of an item.
+       *  @param key The key of the item.
+       *  @param dataset Returns a copy of the dataset of the item.
+       *  @return EC_Normal if successful, WLM_EC_WorklistItemNotFound otherwise.
+       */
+    OFCondition GetItem( const OFString& key, DcmDataset& dataset ) const;
+
+      /** Returns the current state of the table, which is not affected by
+       *  subsequent changes.
+       *  @return The current state of the table.
+       */
+    Snapshot GetSnapshot() const;
+
+      /** Creates a copy of the dataset of an item of a snapshot. The copies are
+       *  created one at a time, since even reading a dataset is not thread-safe.
+       *  @param item The item.
+       *  @return The copy of the dataset, to be deleted by the caller.
+       */
+    DcmDataset *CopyDataset( const Item& item ) const;
+
+  private:
+      /** Privately defined copy constructor.
+       *  @param old Object which shall be copied.
+       */
+    WlmWorklistTable( const WlmWorklistTable &old );
+
+      /** Privately defined assignment operator.
+       *  @param obj Object which shall be copied.
+       *  @return Reference to this.
+       */
+    WlmWorklistTable &operator=( const WlmWorklistTable &obj );
+
+      /** Applies a single change to the given items.
+       *  @param items The items, sorted by key.
+       *  @param change The change.
+       *  @return EC_Normal if successful, an error code otherwise.
+       */
+    OFCondition Apply( OFVector<Item>& items, Transaction::Change& change );
+
+    /// serializes the changes of the table
+    OFMutex writeMutex;
+    /// protects the current state of the table
+    mutable OFMutex snapshotMutex;
+    /// serializes the copying of datasets
+    mutable OFMutex copyMutex;
+    /// current state of the table
+    Snapshot current;
+    /// last revision assigned to an item
+    Uint64 lastRevision;
+    /// indicates if incomplete items shall be rejected
+    OFBool enableRejectionOfIncompleteItems;
+};
+
+#endif
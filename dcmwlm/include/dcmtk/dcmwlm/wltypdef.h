@@ -106,6 +106,10 @@ makeOFConditionConst(WLM_EC_InitializationOfNetworkConnectionFailed, OFM_dcmwlm,
 makeOFConditionConst(WLM_EC_TerminationOfNetworkConnectionFailed,    OFM_dcmwlm,  3, OF_error, "Termination of network connection failed.");
 makeOFConditionConst(WLM_EC_DatabaseStatementConfigFilesNotExistent, OFM_dcmwlm,  4, OF_error, "Database statement configuration files not existent.");
 makeOFConditionConst(WLM_EC_CannotConnectToDataSource,               OFM_dcmwlm,  5, OF_error, "Cannot connect to data source.");
+makeOFConditionConst(WLM_EC_WorklistItemAlreadyExists,               OFM_dcmwlm,  6, OF_error, "Worklist item already exists.");
+makeOFConditionConst(WLM_EC_WorklistItemNotFound,                    OFM_dcmwlm,  7, OF_error, "Worklist item not found.");
+makeOFConditionConst(WLM_EC_IncompleteWorklistItem,                  OFM_dcmwlm,  8, OF_error, "Worklist item is incomplete.");
+makeOFConditionConst(WLM_EC_ThreadedModeNotSupported,                OFM_dcmwlm,  9, OF_error, "Threaded mode not supported by data source.");
 
 /// number of currently supported matching key attributes
 #define NUMBER_OF_SUPPORTED_MATCHING_KEY_ATTRIBUTES 20
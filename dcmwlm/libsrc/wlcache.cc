@@ -0,0 +1,410 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for caching and indexing the worklist files of a directory.
+ *
+ */
+
+// ----------------------------------------------------------------------------
+
+#include "dcmtk/config/osconfig.h"
+
+#include <ctime>
+
+BEGIN_EXTERN_C
+#include <sys/stat.h>
+END_EXTERN_C
+
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcsequen.h"
+#include "dcmtk/dcmwlm/wltypdef.h"
+#include "dcmtk/dcmwlm/wlds.h"
+#include "dcmtk/dcmwlm/wlcache.h"
+
+// ----------------------------------------------------------------------------
+
+/* compare function for qsort, sorts the dates in ascending order */
+extern "C" int WlmCompareDateEntries( const void *a, const void *b )
+{
+  const Uint32 da = *OFstatic_cast( const Uint32 *, a );
+  const Uint32 db = *OFstatic_cast( const Uint32 *, b );
+  return ( da < db ) ? -1 : ( ( da > db ) ? 1 : 0 );
+}
+
+/* compare function for qsort, sorts entry positions in ascending order */
+extern "C" int WlmComparePositions( const void *a, const void *b )
+{
+  const size_t pa = *OFstatic_cast( const size_t *, a );
+  const size_t pb = *OFstatic_cast( const size_t *, b );
+  return ( pa < pb ) ? -1 : ( ( pa > pb ) ? 1 : 0 );
+}
+
+// ----------------------------------------------------------------------------
+
+/* determine the value of an attribute without leading and trailing spaces */
+static OFBool WlmGetTrimmedValue( DcmItem& item, const DcmTagKey& tag, OFString& value, OFBool& universal )
+{
+  DcmElement *elem = NULL;
+  if( item.findAndGetElement( tag, elem, OFFalse ).bad() || !elem )
+    return OFFalse;
+  universal = elem->isUniversalMatch();
+  OFString str;
+  elem->getOFStringArray( str );
+  const char *begin = str.c_str();
+  const char *end = begin + str.length();
+  OFStandard::trimString( begin, end );
+  value.assign( begin, end - begin );
+  return OFTrue;
+}
+
+/* check whether a value of a query can be looked up in an index, i.e. it is
+ * a single value without wild cards
+ */
+static OFBool WlmIsIndexableValue( const OFString& value )
+{
+  return !value.empty() && value.find_first_of( "*?\\" ) == OFString_npos;
+}
+
+/* convert a date of the form YYYYMMDD to a number, returns OFFalse for all
+ * other forms
+ */
+static OFBool WlmParseDate( const OFString& value, Uint32& date )
+{
+  if( value.length() != 8 )
+    return OFFalse;
+  date = 0;
+  for( size_t i = 0; i < 8; i++ )
+  {
+    if( value[i] < '0' || value[i] > '9' )
+      return OFFalse;
+    date = date * 10 + OFstatic_cast( Uint32, value[i] - '0' );
+  }
+  return OFTrue;
+}
+
+/* sort positions and remove duplicates */
+static void WlmSortPositions( OFVector<size_t>& positions )
+{
+  if( positions.empty() )
+    return;
+  qsort( &positions[0], positions.size(), sizeof( size_t ), WlmComparePositions );
+  size_t n = 1;
+  for( size_t i = 1; i < positions.size(); i++ )
+  {
+    if( positions[i] != positions[n-1] )
+      positions[n++] = positions[i];
+  }
+  positions.resize( n );
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistCache::Entry::Entry()
+: path()
+, modificationTime( 0 )
+, changeTime( 0 )
+, size( 0 )
+, fileID( 0 )
+, racy( OFFalse )
+, dataset()
+, completenessChecked( OFFalse )
+, complete( OFFalse )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistCache::WlmWorklistCache( const OFpath& directoryv )
+: directory( directoryv )
+, entries()
+, patientIDIndex()
+, accessionNumberIndex()
+, stationAETitleIndex()
+, modalityIndex()
+, dates()
+, undated()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistCache::~WlmWorklistCache()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+size_t WlmWorklistCache::Refresh()
+{
+  // remember where the files that have already been read are stored
+  OFMap<OFString, size_t> known;
+  for( size_t i = 0; i < entries.size(); i++ )
+    known[ entries[i].path.native() ] = i;
+
+  OFVector<Entry> current;
+  size_t numRead = 0;
+  for( OFdirectory_iterator it( directory ); it != OFdirectory_iterator(); ++it )
+  {
+    const OFpath& path = it->path();
+    if( ".wl" != path.extension() )
+      continue;
+    // the file may have been removed in the meantime
+    const Uint64 now = OFstatic_cast( Uint64, time( NULL ) );
+    struct stat info;
+    if( stat( path.c_str(), &info ) != 0 )
+      continue;
+    const Uint64 modificationTime = OFstatic_cast( Uint64, info.st_mtime );
+    const Uint64 changeTime = OFstatic_cast( Uint64, info.st_ctime );
+    const Uint64 size = OFstatic_cast( Uint64, info.st_size );
+    const Uint64 fileID = OFstatic_cast( Uint64, info.st_ino );
+    OFMap<OFString, size_t>::iterator k = known.find( path.native() );
+    if( k != known.end() )
+    {
+      const Entry& knownEntry = entries[(*k).second];
+      if( !knownEntry.racy && knownEntry.modificationTime == modificationTime && knownEntry.changeTime == changeTime &&
+          knownEntry.size == size && knownEntry.fileID == fileID )
+      {
+        current.push_back( knownEntry );
+        continue;
+      }
+    }
+
+    // read the new or modified file
+    Entry entry;
+    entry.path = path;
+    entry.modificationTime = modificationTime;
+    entry.changeTime = changeTime;
+    entry.size = size;
+    entry.fileID = fileID;
+    // a modification in the current second would not change the times
+    entry.racy = ( modificationTime >= now ) || ( changeTime >= now );
+    DcmFileFormat file;
+    OFCondition status = file.loadFile( path );
+    if( status.bad() )
+      DCMWLM_WARN("Could not read worklist file " << path << ", file will be ignored: " << status.text());
+    else
+    {
+      entry.dataset.reset( file.getAndRemoveDataset() );
+      if( !entry.dataset )
+        DCMWLM_WARN("Worklist file " << path << " is empty, file will be ignored");
+    }
+    DCMWLM_DEBUG("Worklist file " << path << " read into cache");
+    current.push_back( entry );
+    ++numRead;
+  }
+
+  // files have been modified, added or removed
+  const OFBool changed = ( numRead > 0 ) || ( current.size() != entries.size() );
+  entries.swap( current );
+  if( changed )
+  {
+    DCMWLM_DEBUG("Rebuilding worklist cache index of " << entries.size() << " files in " << directory);
+    BuildIndexes();
+  }
+  return numRead;
+}
+
+// ----------------------------------------------------------------------------
+
+size_t WlmWorklistCache::GetNumberOfEntries() const
+{
+  return entries.size();
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistCache::BuildIndexes()
+{
+  Index *indexes[4] = { &patientIDIndex, &accessionNumberIndex, &stationAETitleIndex, &modalityIndex };
+  for( size_t i = 0; i < 4; i++ )
+  {
+    indexes[i]->values.clear();
+    indexes[i]->unindexed.clear();
+  }
+  dates.clear();
+  undated.clear();
+
+  for( size_t pos = 0; pos < entries.size(); pos++ )
+  {
+    DcmDataset *dataset = entries[pos].dataset.get();
+    if( !dataset )
+      continue;
+    AddToIndex( patientIDIndex, *dataset, DCM_PatientID, pos );
+    AddToIndex( accessionNumberIndex, *dataset, DCM_AccessionNumber, pos );
+
+    // a dataset matches if any of its scheduled procedure steps matches
+    DcmSequenceOfItems *sequence = NULL;
+    if( dataset->findAndGetSequence( DCM_ScheduledProcedureStepSequence, sequence, OFFalse ).bad() || !sequence )
+      continue;
+    for( unsigned long i = 0; i < sequence->card(); i++ )
+    {
+      DcmItem *item = sequence->getItem( i );
+      AddToIndex( stationAETitleIndex, *item, DCM_ScheduledStationAETitle, pos );
+      AddToIndex( modalityIndex, *item, DCM_Modality, pos );
+      OFString value;
+      OFBool universal;
+      if( WlmGetTrimmedValue( *item, DCM_ScheduledProcedureStepStartDate, value, universal ) )
+      {
+        DateEntry entry;
+        entry.pos = pos;
+        if( WlmParseDate( value, entry.date ) )
+          dates.push_back( entry );
+        else if( undated.empty() || undated.back() != pos )
+          undated.push_back( pos );
+      }
+    }
+  }
+  if( !dates.empty() )
+    qsort( &dates[0], dates.size(), sizeof( DateEntry ), WlmCompareDateEntries );
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistCache::AddToIndex( Index& index, DcmItem& item, const DcmTagKey& tag, size_t pos )
+{
+  OFString value;
+  OFBool universal;
+  if( !WlmGetTrimmedValue( item, tag, value, universal ) )
+    return;
+  // empty and multiple values are compared with every query
+  OFVector<size_t>& positions = ( value.empty() || value.find( '\\' ) != OFString_npos ) ? index.unindexed : index.values[value];
+  // the same value may occur in several items of the same dataset
+  if( positions.empty() || positions.back() != pos )
+    positions.push_back( pos );
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool WlmWorklistCache::LookupIndex( const Index& index, DcmItem& query, const DcmTagKey& tag, OFVector<size_t>& result )
+{
+  OFString value;
+  OFBool universal;
+  if( !WlmGetTrimmedValue( query, tag, value, universal ) || universal || !WlmIsIndexableValue( value ) )
+    return OFFalse;
+  result = index.unindexed;
+  OFMap<OFString, OFVector<size_t> >::const_iterator it = index.values.find( value );
+  if( it != index.values.end() )
+    result.insert( result.end(), (*it).second.begin(), (*it).second.end() );
+  return OFTrue;
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool WlmWorklistCache::LookupDates( DcmItem& query, OFVector<size_t>& result ) const
+{
+  OFString value;
+  OFBool universal;
+  if( !WlmGetTrimmedValue( query, DCM_ScheduledProcedureStepStartDate, value, universal ) || universal || value.empty() )
+    return OFFalse;
+
+  // single date or range of dates, either end of the range may be open
+  Uint32 first = 0;
+  Uint32 last = 99999999;
+  const size_t dash = value.find( '-' );
+  if( dash == OFString_npos )
+  {
+    if( !WlmParseDate( value, first ) )
+      return OFFalse;
+    last = first;
+  }
+  else
+  {
+    if( dash > 0 && !WlmParseDate( value.substr( 0, dash ), first ) )
+      return OFFalse;
+    if( dash + 1 < value.length() && !WlmParseDate( value.substr( dash + 1 ), last ) )
+      return OFFalse;
+  }
+
+  // find the first date of the range by binary search
+  size_t lo = 0;
+  size_t hi = dates.size();
+  while( lo < hi )
+  {
+    const size_t mid = lo + ( hi - lo ) / 2;
+    if( dates[mid].date < first )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  result = undated;
+  for( ; lo < dates.size() && dates[lo].date <= last; lo++ )
+    result.push_back( dates[lo].pos );
+  return OFTrue;
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistCache::DetermineCandidates( DcmItem& searchMask, OFVector<Entry*>& candidates )
+{
+  candidates.clear();
+
+  // use the index that results in the smallest number of candidates
+  OFVector<size_t> best;
+  OFVector<size_t> positions;
+  OFBool indexed = OFFalse;
+  if( LookupIndex( patientIDIndex, searchMask, DCM_PatientID, positions ) )
+  {
+    best.swap( positions );
+    indexed = OFTrue;
+  }
+  if( LookupIndex( accessionNumberIndex, searchMask, DCM_AccessionNumber, positions ) && ( !indexed || positions.size() < best.size() ) )
+  {
+    best.swap( positions );
+    indexed = OFTrue;
+  }
+
+  // the keys of the scheduled procedure step can only be used for a single item
+  DcmSequenceOfItems *sequence = NULL;
+  if( searchMask.findAndGetSequence( DCM_ScheduledProcedureStepSequence, sequence, OFFalse ).good() && sequence && sequence->card() == 1 )
+  {
+    DcmItem *item = sequence->getItem( 0 );
+    if( LookupIndex( stationAETitleIndex, *item, DCM_ScheduledStationAETitle, positions ) && ( !indexed || positions.size() < best.size() ) )
+    {
+      best.swap( positions );
+      indexed = OFTrue;
+    }
+    if( LookupIndex( modalityIndex, *item, DCM_Modality, positions ) && ( !indexed || positions.size() < best.size() ) )
+    {
+      best.swap( positions );
+      indexed = OFTrue;
+    }
+    if( LookupDates( *item, positions ) && ( !indexed || positions.size() < best.size() ) )
+    {
+      best.swap( positions );
+      indexed = OFTrue;
+    }
+  }
+
+  if( indexed )
+  {
+    WlmSortPositions( best );
+    DCMWLM_DEBUG("Worklist cache index selects " << best.size() << " of " << entries.size() << " files");
+    for( size_t i = 0; i < best.size(); i++ )
+      candidates.push_back( &entries[ best[i] ] );
+  }
+  else
+  {
+    for( size_t i = 0; i < entries.size(); i++ )
+    {
+      if( entries[i].dataset )
+        candidates.push_back( &entries[i] );
+    }
+  }
+}
@@ -140,6 +140,15 @@ void WlmDataSource::SetReturnedCharacterSet( WlmReturnedCharacterSetType value )
 
 // ----------------------------------------------------------------------------
 
+void WlmDataSource::CopyGeneralSettingsTo( WlmDataSource &instance ) const
+{
+  instance.SetFailOnInvalidQuery( failOnInvalidQuery );
+  instance.SetNoSequenceExpansion( noSequenceExpansion );
+  instance.SetReturnedCharacterSet( returnedCharacterSet );
+}
+
+// ----------------------------------------------------------------------------
+
 OFBool WlmDataSource::CheckSearchMask( DcmDataset *searchMask )
 // Date         : March 18, 2001
 // Author       : Thomas Wilkens
@@ -51,7 +51,7 @@ WlmDataSourceFileSystem::WlmDataSourceFileSystem()
 // Task         : Constructor.
 // Parameters   : none.
 // Return Value : none.
-  : fileSystemInteractionManager( ), dfPath( "" ), enableRejectionOfIncompleteWlFiles( OFTrue ), handleToReadLockFile( 0 )
+  : fileSystemInteractionManager( ), dfPath( "" ), enableRejectionOfIncompleteWlFiles( OFTrue ), enableWorklistCache( OFTrue ), handleToReadLockFile( 0 )
 {
 }
 
@@ -80,6 +80,7 @@ OFCondition WlmDataSourceFileSystem::ConnectToDataSource()
 {
   // set variables in fileSystemInteractionManager object
   fileSystemInteractionManager.SetEnableRejectionOfIncompleteWlFiles( enableRejectionOfIncompleteWlFiles );
+  fileSystemInteractionManager.SetEnableWorklistCache( enableWorklistCache );
 
   // connect to file system
   OFCondition cond = fileSystemInteractionManager.ConnectToFileSystem( dfPath );
@@ -105,6 +106,25 @@ OFCondition WlmDataSourceFileSystem::DisconnectFromDataSource()
 }
 
 
+// ----------------------------------------------------------------------------
+
+WlmDataSource *WlmDataSourceFileSystem::CreateConcurrentInstance()
+{
+  WlmDataSourceFileSystem *instance = new WlmDataSourceFileSystem();
+  CopySettingsTo( *instance );
+  return instance;
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmDataSourceFileSystem::CopySettingsTo( WlmDataSourceFileSystem &instance ) const
+{
+  CopyGeneralSettingsTo( instance );
+  instance.SetDfPath( dfPath );
+  instance.SetEnableRejectionOfIncompleteWlFiles( enableRejectionOfIncompleteWlFiles );
+  instance.SetEnableWorklistCache( enableWorklistCache );
+}
+
 // ----------------------------------------------------------------------------
 
 void WlmDataSourceFileSystem::SetDfPath( const OFString& value )
@@ -131,6 +151,13 @@ void WlmDataSourceFileSystem::SetEnableRejectionOfIncompleteWlFiles( OFBool valu
 
 // ----------------------------------------------------------------------------
 
+void WlmDataSourceFileSystem::SetEnableWorklistCache( OFBool value )
+{
+  enableWorklistCache = value;
+}
+
+// ----------------------------------------------------------------------------
+
 OFBool WlmDataSourceFileSystem::IsCalledApplicationEntityTitleSupported()
 // Date         : December 10, 2001
 // Author       : Thomas Wilkens
@@ -311,7 +338,7 @@ WlmDataSourceStatusType WlmDataSourceFileSystem::StartFindRequest( const DcmData
   DCMWLM_INFO("Determining matching records from worklist files");
 
   // Determine records from worklist files which match the search mask
-  unsigned long numOfMatchingRecords = OFstatic_cast(unsigned long, fileSystemInteractionManager.DetermineMatchingRecords( identifiers ));
+  unsigned long numOfMatchingRecords = OFstatic_cast(unsigned long, DetermineMatchingRecords( identifiers ));
 
   // dump some information if required
   DCMWLM_INFO("Matching results: " << numOfMatchingRecords << " matching records found in worklist files");
@@ -420,6 +447,13 @@ WlmDataSourceStatusType WlmDataSourceFileSystem::StartFindRequest( const DcmData
 
 // ----------------------------------------------------------------------------
 
+size_t WlmDataSourceFileSystem::DetermineMatchingRecords( DcmDataset *searchMask )
+{
+  return fileSystemInteractionManager.DetermineMatchingRecords( searchMask );
+}
+
+// ----------------------------------------------------------------------------
+
 DcmDataset *WlmDataSourceFileSystem::NextFindResponse( WlmDataSourceStatusType &rStatus )
 // Date         : July 11, 2002
 // Author       : Thomas Wilkens
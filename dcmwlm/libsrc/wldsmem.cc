@@ -0,0 +1,120 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for connecting to an in-memory data source.
+ *
+ */
+
+// ----------------------------------------------------------------------------
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmwlm/wltypdef.h"
+#include "dcmtk/dcmwlm/wlds.h"
+#include "dcmtk/dcmwlm/wldsmem.h"
+
+// ----------------------------------------------------------------------------
+
+WlmDataSourceMemory::WlmDataSourceMemory( WlmWorklistTable &tablev )
+  : WlmDataSourceFileSystem(), table( tablev ), datasetCopies()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+WlmDataSourceMemory::~WlmDataSourceMemory()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmDataSourceMemory::ConnectToDataSource()
+{
+  return( EC_Normal );
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmDataSourceMemory::DisconnectFromDataSource()
+{
+  // forget the copies of the worklist items
+  datasetCopies.clear();
+  return( EC_Normal );
+}
+
+// ----------------------------------------------------------------------------
+
+WlmDataSource *WlmDataSourceMemory::CreateConcurrentInstance()
+{
+  WlmDataSourceMemory *instance = new WlmDataSourceMemory( table );
+  CopySettingsTo( *instance );
+  return instance;
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool WlmDataSourceMemory::IsCalledApplicationEntityTitleSupported()
+{
+  return( !calledApplicationEntityTitle.empty() );
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool WlmDataSourceMemory::SetReadlock()
+{
+  return( OFTrue );
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool WlmDataSourceMemory::ReleaseReadlock()
+{
+  return( OFTrue );
+}
+
+// ----------------------------------------------------------------------------
+
+size_t WlmDataSourceMemory::DetermineMatchingRecords( DcmDataset *searchMask )
+{
+  // all datasets of this query are taken from the same state of the table
+  WlmWorklistTable::Snapshot snapshot = table.GetSnapshot();
+
+  // bring the copies up to date, copies of deleted items are dropped
+  OFMap<OFString, DatasetCopy> copies;
+  OFVector<OFshared_ptr<DcmDataset> > datasets;
+  datasets.reserve( snapshot->size() );
+  size_t numCopied = 0;
+  for( size_t i = 0; i < snapshot->size(); i++ )
+  {
+    const WlmWorklistTable::Item& item = (*snapshot)[i];
+    DatasetCopy& copy = copies[item.GetKey()];
+    OFMap<OFString, DatasetCopy>::iterator it = datasetCopies.find( item.GetKey() );
+    if( it != datasetCopies.end() && (*it).second.revision == item.GetRevision() )
+      copy = (*it).second;
+    else
+    {
+      copy.revision = item.GetRevision();
+      copy.dataset.reset( table.CopyDataset( item ) );
+      numCopied++;
+    }
+    datasets.push_back( copy.dataset );
+  }
+  datasetCopies.swap( copies );
+  DCMWLM_DEBUG( "Worklist table contains " << snapshot->size() << " items, " << numCopied << " of them copied for this query" );
+
+  return( fileSystemInteractionManager.DetermineMatchingRecords( searchMask, datasets ) );
+}
@@ -88,6 +88,8 @@ WlmFileSystemInteractionManager::WlmFileSystemInteractionManager()
 , enableRejectionOfIncompleteWlFiles( OFTrue )
 , calledApplicationEntityTitle()
 , matchingRecords()
+, enableWorklistCache( OFTrue )
+, worklistCaches()
 {
 
 }
@@ -117,6 +119,13 @@ void WlmFileSystemInteractionManager::SetEnableRejectionOfIncompleteWlFiles( OFB
 
 // ----------------------------------------------------------------------------
 
+void WlmFileSystemInteractionManager::SetEnableWorklistCache( OFBool value )
+{
+  enableWorklistCache = value;
+}
+
+// ----------------------------------------------------------------------------
+
 OFCondition WlmFileSystemInteractionManager::ConnectToFileSystem( const OFString& dfPathv )
 // Date         : July 11, 2002
 // Author       : Thomas Wilkens
@@ -188,6 +197,32 @@ size_t WlmFileSystemInteractionManager::DetermineMatchingRecords( DcmDataset* se
 {
     assert( searchMask );
     matchingRecords.clear();
+    if( enableWorklistCache )
+    {
+        // only read the files that have been modified since the last query
+        OFshared_ptr<WlmWorklistCache>& cache = worklistCaches[calledApplicationEntityTitle];
+        if( !cache )
+            cache.reset( new WlmWorklistCache( dfPath / calledApplicationEntityTitle ) );
+        const size_t numRead = cache->Refresh();
+        DCMWLM_DEBUG( "Worklist cache contains " << cache->GetNumberOfEntries() << " files, " << numRead << " of them read for this query" );
+        if( cache->GetNumberOfEntries() == 0 )
+            DCMWLM_INFO( "<no files found>" );
+        OFVector<WlmWorklistCache::Entry*> candidates;
+        cache->DetermineCandidates( *searchMask, candidates );
+        for( size_t i = 0; i < candidates.size(); i++ )
+        {
+            WlmWorklistCache::Entry& entry = *candidates[i];
+            // the completeness of a file is only checked once
+            if( !entry.completenessChecked )
+            {
+                entry.complete = AcceptWorklistDataset( entry.dataset.get(), entry.path );
+                entry.completenessChecked = OFTrue;
+            }
+            if( entry.complete )
+                MatchWorklistDataset( *searchMask, entry.dataset, entry.path );
+        }
+        return matchingRecords.size();
+    }
     OFdirectory_iterator it( dfPath / calledApplicationEntityTitle );
     if( FindNextWorklistFile( it ) != OFdirectory_iterator() )
     {
@@ -201,6 +236,19 @@ size_t WlmFileSystemInteractionManager::DetermineMatchingRecords( DcmDataset* se
 
 // ----------------------------------------------------------------------------
 
+size_t WlmFileSystemInteractionManager::DetermineMatchingRecords( DcmDataset* searchMask,
+                                                                  const OFVector<OFshared_ptr<DcmDataset> >& datasets )
+{
+    assert( searchMask );
+    matchingRecords.clear();
+    for( size_t i = 0; i < datasets.size(); i++ )
+    {
+        if( datasets[i] && DatasetMatchesSearchMask( *datasets[i], *searchMask, MatchingKeys::root ) )
+            matchingRecords.push_back( datasets[i] );
+    }
+    return matchingRecords.size();
+}
+
 void WlmFileSystemInteractionManager::MatchWorklistFile( DcmDataset& searchMask,
                                                          const OFpath& worklistFile )
 {
@@ -216,30 +264,48 @@ void WlmFileSystemInteractionManager::MatchWorklistFile( DcmDataset& searchMask,
     // storing it into an OFshared_ptr ensures it will be freed in the end not matter what
     if( OFshared_ptr<DcmDataset> pDataset = OFshared_ptr<DcmDataset>( file.getAndRemoveDataset() ) )
     {
-        if( enableRejectionOfIncompleteWlFiles )
-        {
-            DCMWLM_INFO("Checking whether worklist file " << worklistFile << " is complete");
-            // in case option --enable-file-reject is set, we have to check if the current
-            // .wl-file meets certain conditions; in detail, the file's dataset has to be
-            // checked whether it contains all necessary return type 1 attributes and contains
-            // information in all these attributes; if this is condition is not met, the
-            // .wl-file shall be rejected
-            if( !DatasetIsComplete( pDataset.get() ) )
-            {
-                DCMWLM_WARN("Worklist file " << worklistFile << " is incomplete, file will be ignored");
-                return;
-            }
-        }
-        // check if the current dataset matches the matching key attribute values
-        if( DatasetMatchesSearchMask( *pDataset, searchMask, MatchingKeys::root ) )
+        if( AcceptWorklistDataset( pDataset.get(), worklistFile ) )
+            MatchWorklistDataset( searchMask, pDataset, worklistFile );
+    }
+    else DCMWLM_WARN("Worklist file " << worklistFile << " is empty, file will be ignored");
+}
+
+// ----------------------------------------------------------------------------
+
+OFBool WlmFileSystemInteractionManager::AcceptWorklistDataset( DcmDataset *dataset,
+                                                               const OFpath& worklistFile )
+{
+    if( enableRejectionOfIncompleteWlFiles )
+    {
+        DCMWLM_INFO("Checking whether worklist file " << worklistFile << " is complete");
+        // in case option --enable-file-reject is set, we have to check if the current
+        // .wl-file meets certain conditions; in detail, the file's dataset has to be
+        // checked whether it contains all necessary return type 1 attributes and contains
+        // information in all these attributes; if this is condition is not met, the
+        // .wl-file shall be rejected
+        if( !DatasetIsComplete( dataset ) )
         {
-            DCMWLM_INFO("Information from worklist file " << worklistFile << " matches query");
-            // insert the matching dataset into matchingRecords
-            matchingRecords.push_back( pDataset );
+            DCMWLM_WARN("Worklist file " << worklistFile << " is incomplete, file will be ignored");
+            return OFFalse;
         }
-        else DCMWLM_INFO("Information from worklist file " << worklistFile << " does not match query");
     }
-    else DCMWLM_WARN("Worklist file " << worklistFile << " is empty, file will be ignored");
+    return OFTrue;
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmFileSystemInteractionManager::MatchWorklistDataset( DcmDataset& searchMask,
+                                                            const OFshared_ptr<DcmDataset>& pDataset,
+                                                            const OFpath& worklistFile )
+{
+    // check if the current dataset matches the matching key attribute values
+    if( DatasetMatchesSearchMask( *pDataset, searchMask, MatchingKeys::root ) )
+    {
+        DCMWLM_INFO("Information from worklist file " << worklistFile << " matches query");
+        // insert the matching dataset into matchingRecords
+        matchingRecords.push_back( pDataset );
+    }
+    else DCMWLM_INFO("Information from worklist file " << worklistFile << " does not match query");
 }
 
 // ----------------------------------------------------------------------------
@@ -44,6 +44,7 @@
 #include "dcmtk/oflog/internal/env.h"
 #include "dcmtk/dcmwlm/wlmactmg.h"
 #include "dcmtk/ofstd/ofstdinc.h"
+#include "dcmtk/dcmnet/dthrpool.h"
 #include <ctime>
 
 
@@ -95,6 +96,113 @@ static void storeRequestToFile(DcmDataset& request, const OFString& callingAE, c
 // Return Value: none
 
 
+#ifdef WITH_THREADS
+
+// ----------------------------------------------------------------------------
+
+class WlmAssociationHandler : public DcmAssociationHandler
+// Task         : Handler of a thread of the pool handling the associations in threaded mode.
+//                Each thread uses its own data source object.
+{
+  public:
+    WlmAssociationHandler( WlmActivityManager &managerv, WlmDataSource *dataSourcev )
+      : DcmAssociationHandler(), manager( managerv ), dataSource( dataSourcev )
+    {
+    }
+
+    ~WlmAssociationHandler()
+    {
+      dataSource->DisconnectFromDataSource();
+      delete dataSource;
+    }
+
+    virtual void handleAssociation( T_ASC_Association *assoc );
+
+  private:
+    /// the activity manager whose associations are handled
+    WlmActivityManager &manager;
+    /// data source used by this thread
+    WlmDataSource *dataSource;
+
+    // private undefined copy constructor
+    WlmAssociationHandler( const WlmAssociationHandler & );
+
+    // private undefined assignment operator
+    WlmAssociationHandler &operator=( const WlmAssociationHandler & );
+};
+
+// ----------------------------------------------------------------------------
+
+class WlmAssociationPool : public DcmAssociationThreadPool
+// Task         : Pool of threads handling the associations accepted by the main thread in threaded
+//                mode. The associations are entered into the process table of the activity manager
+//                with negative numbers instead of process IDs.
+{
+  public:
+    WlmAssociationPool( WlmActivityManager &managerv, size_t maxThreadsv )
+      : DcmAssociationThreadPool( maxThreadsv ), manager( managerv )
+    {
+    }
+
+  protected:
+    // each thread gets its own data source object, created by the main thread
+    virtual DcmAssociationHandler *createHandler( OFCondition &cond );
+
+    virtual void addProcess( const int id, T_ASC_Association *assoc )
+    {
+      manager.AddProcessToTable( id, assoc );
+    }
+
+    virtual void removeProcess( const int id )
+    {
+      manager.RemoveProcessFromTable( id );
+    }
+
+  private:
+    /// the activity manager whose associations are handled
+    WlmActivityManager &manager;
+
+    // private undefined copy constructor
+    WlmAssociationPool( const WlmAssociationPool & );
+
+    // private undefined assignment operator
+    WlmAssociationPool &operator=( const WlmAssociationPool & );
+};
+
+// ----------------------------------------------------------------------------
+
+void WlmAssociationHandler::handleAssociation( T_ASC_Association *assoc )
+{
+  // the called application entity title has already been checked by the main thread,
+  // but the data source of this thread may have to prepare itself for it
+  dataSource->SetCalledApplicationEntityTitle( assoc->params->DULparams.calledAPTitle );
+  if( dataSource->IsCalledApplicationEntityTitleSupported() )
+    manager.HandleAssociation( assoc, dataSource );
+  else
+  {
+    DCMWLM_ERROR("Called application entity title no longer supported, aborting association");
+    ASC_abortAssociation( assoc );
+    ASC_dropAssociation( assoc );
+    ASC_destroyAssociation( &assoc );
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+DcmAssociationHandler *WlmAssociationPool::createHandler( OFCondition &cond )
+{
+  WlmDataSource *dataSource = manager.dataSource->CreateConcurrentInstance();
+  cond = ( dataSource != NULL ) ? dataSource->ConnectToDataSource() : WLM_EC_ThreadedModeNotSupported;
+  if( cond.bad() )
+  {
+    delete dataSource;
+    return NULL;
+  }
+  return new WlmAssociationHandler( manager, dataSource );
+}
+
+#endif // WITH_THREADS
+
 // ----------------------------------------------------------------------------
 
 WlmActivityManager::WlmActivityManager(
@@ -140,7 +248,8 @@ WlmActivityManager::WlmActivityManager(
     opt_sleepAfterFind( opt_sleepAfterFindv ), opt_sleepDuringFind( opt_sleepDuringFindv ),
     opt_maxPDU( opt_maxPDUv ), opt_networkTransferSyntax( opt_networkTransferSyntaxv ),
     opt_failInvalidQuery( opt_failInvalidQueryv ),
-    opt_singleProcess( opt_singleProcessv ),  opt_forkedChild( opt_forkedChildv ), cmd_argc( argcv ),
+    opt_singleProcess( opt_singleProcessv ), opt_threadedMode( OFFalse ), threadPool( NULL ),
+    opt_forkedChild( opt_forkedChildv ), cmd_argc( argcv ),
     cmd_argv( argvv ), opt_maxAssociations( opt_maxAssociationsv ),
     opt_blockMode(opt_blockModev), opt_dimse_timeout(opt_dimse_timeoutv), opt_acse_timeout(opt_acse_timeoutv),
     supportedAbstractSyntaxes( NULL ), numberOfSupportedAbstractSyntaxes( 0 ),
@@ -174,6 +283,11 @@ WlmActivityManager::~WlmActivityManager()
 // Parameters   : none.
 // Return Value : none.
 {
+#ifdef WITH_THREADS
+  // wait until all associations handled by threads are finished
+  delete threadPool;
+#endif
+
   // free memory
   delete[] supportedAbstractSyntaxes[0];
   delete[] supportedAbstractSyntaxes[1];
@@ -214,6 +328,22 @@ OFBool WlmActivityManager::setRequestFilePath(const OFString& path, const OFStri
 }
 
 
+// ----------------------------------------------------------------------------
+
+OFBool WlmActivityManager::setThreadedMode(OFBool enabled)
+// Task         : Enable or disable threaded mode.
+// Parameters   : enabled - [in] Specifies if threaded mode shall be enabled.
+// Return Value : OFTrue if successful, OFFalse if DCMTK has been compiled without thread support.
+{
+#ifdef WITH_THREADS
+  opt_threadedMode = enabled;
+  return OFTrue;
+#else
+  opt_threadedMode = OFFalse;
+  return !enabled;
+#endif
+}
+
 // ----------------------------------------------------------------------------
 
 OFCondition WlmActivityManager::StartProvidingService()
@@ -242,6 +372,18 @@ OFCondition WlmActivityManager::StartProvidingService()
 #endif
 #endif
 
+#ifdef WITH_THREADS
+  // In threaded mode, each thread needs its own data source object
+  if( opt_threadedMode && threadPool == NULL )
+  {
+    WlmDataSource *instance = dataSource->CreateConcurrentInstance();
+    if( instance == NULL )
+      return( WLM_EC_ThreadedModeNotSupported );
+    delete instance;
+    threadPool = new WlmAssociationPool( *this, opt_maxAssociations > 0 ? OFstatic_cast(size_t, opt_maxAssociations) : 1 );
+  }
+#endif
+
 #ifdef _WIN32
   /* if this process was started by CreateProcess, opt_forkedChild is set */
   if (opt_forkedChild)
@@ -252,7 +394,7 @@ OFCondition WlmActivityManager::StartProvidingService()
   else
   {
     // parent process
-    if (!opt_singleProcess)
+    if (!opt_singleProcess && !opt_threadedMode)
       DUL_requestForkOnTransportConnectionReceipt(cmd_argc, cmd_argv);
   }
 #endif
@@ -279,6 +421,12 @@ OFCondition WlmActivityManager::StartProvidingService()
     // the calling applications correspondingly.
     cond = WaitForAssociation( net );
 
+#ifdef WITH_THREADS
+    // Remove associations handled completely by threads from the process table.
+    if( threadPool != NULL )
+      threadPool->cleanFinishedAssociations();
+#endif
+
     // Clean up any child processes if the execution is not limited to a single process.
     // (On windows platform, children are not handled via the process table,
     // so there's no need to clean up children)
@@ -291,6 +439,13 @@ OFCondition WlmActivityManager::StartProvidingService()
     if (DUL_processIsForkedChild()) break;
 #endif
   }
+
+#ifdef WITH_THREADS
+  // Wait until the associations handled by threads are finished.
+  delete threadPool;
+  threadPool = NULL;
+#endif
+
   // Drop the network, i.e. free memory of T_ASC_Network* structure. This call
   // is the counterpart of ASC_initializeNetwork(...) which was called above.
   cond = ASC_dropNetwork( &net );
@@ -535,6 +690,19 @@ OFCondition WlmActivityManager::WaitForAssociation( T_ASC_Network * net )
   // Depending on if this execution shall be limited to one process or not, spawn a sub-
   // process to handle the association or don't. (Note: For windows dcmnet is handling
   // the creation for a new subprocess, so we can call HandleAssociation directly, too)
+#ifdef WITH_THREADS
+  if( threadPool != NULL )
+  {
+    // Hand the association over to a thread of the pool.
+    if( threadPool->addAssociation( assoc ).bad() )
+    {
+      ASC_abortAssociation( assoc );
+      ASC_dropAssociation( assoc );
+      ASC_destroyAssociation( &assoc );
+    }
+  }
+  else
+#endif
   if( opt_singleProcess || opt_forkedChild )
   {
     // Go ahead and handle the association (i.e. handle the callers requests) in this process.
@@ -651,12 +819,13 @@ OFCondition WlmActivityManager::NegotiateAssociation( T_ASC_Association *assoc )
 
 // ----------------------------------------------------------------------------
 
-void WlmActivityManager::HandleAssociation( T_ASC_Association *assoc )
+void WlmActivityManager::HandleAssociation( T_ASC_Association *assoc, WlmDataSource *associationDataSource )
 // Date         : December 10, 2001
 // Author       : Thomas Wilkens
 // Task         : This function takes care of handling the other DICOM application's request. After
 //                having accomplished all necessary steps, the association will be dropped and destroyed.
-// Parameters   : assoc - [in] The association (network connection to another DICOM application).
+// Parameters   : assoc                 - [in] The association (network connection to another DICOM application).
+//                associationDataSource - [in] The data source to be used for this association, if not NULL.
 // Return Value : none.
 {
   // Receive a DIMSE command and perform all the necessary actions. (Note that ReceiveAndHandleCommands()
@@ -664,7 +833,7 @@ void WlmActivityManager::HandleAssociation( T_ASC_Association *assoc )
   // some kind of error occurred, or that the peer aborted the association (DUL_PEERABORTEDASSOCIATION),
   // or that the peer requested the release of the association (DUL_PEERREQUESTEDRELEASE).) (Also note
   // that ReceiveAndHandleCommands() will never return EC_Normal.)
-  OFCondition cond = ReceiveAndHandleCommands( assoc );
+  OFCondition cond = ReceiveAndHandleCommands( assoc, associationDataSource );
 
   // Clean up on association termination.
   if( cond == DUL_PEERREQUESTEDRELEASE )
@@ -694,11 +863,12 @@ void WlmActivityManager::HandleAssociation( T_ASC_Association *assoc )
 
 // ----------------------------------------------------------------------------
 
-OFCondition WlmActivityManager::ReceiveAndHandleCommands( T_ASC_Association *assoc )
+OFCondition WlmActivityManager::ReceiveAndHandleCommands( T_ASC_Association *assoc, WlmDataSource *associationDataSource )
 // Date         : December 10, 2001
 // Author       : Thomas Wilkens
 // Task         : This function takes care of handling the other DICOM application's request.
-// Parameters   : assoc - [in] The association (network connection to another DICOM application).
+// Parameters   : assoc                 - [in] The association (network connection to another DICOM application).
+//                associationDataSource - [in] The data source to be used for this association, if not NULL.
 // Return Value : An OFCondition value 'cond' for which 'cond.bad()' will always be set
 //                indicating that either some kind of error occurred, or that the peer aborted
 //                the association (DUL_PEERABORTEDASSOCIATION), or that the peer requested the
@@ -709,7 +879,8 @@ OFCondition WlmActivityManager::ReceiveAndHandleCommands( T_ASC_Association *ass
   T_ASC_PresentationContextID presID;
 
   // Tell object that manages the data source if it should fail on an invalid query or not.
-  dataSource->SetFailOnInvalidQuery( opt_failInvalidQuery );
+  WlmDataSource *source = ( associationDataSource != NULL ) ? associationDataSource : dataSource;
+  source->SetFailOnInvalidQuery( opt_failInvalidQuery );
 
   // start a loop to be able to receive more than one DIMSE command
   while( cond.good() )
@@ -730,7 +901,7 @@ OFCondition WlmActivityManager::ReceiveAndHandleCommands( T_ASC_Association *ass
           break;
         case DIMSE_C_FIND_RQ:
           // Process C-FIND-Request
-          cond = HandleFindSCP( assoc, &msg.msg.CFindRQ, presID );
+          cond = HandleFindSCP( assoc, &msg.msg.CFindRQ, presID, source );
           break;
         case DIMSE_C_CANCEL_RQ:
           // Process C-CANCEL-Request
@@ -821,7 +992,7 @@ struct WlmFindContextType
 
 // ----------------------------------------------------------------------------
 
-OFCondition WlmActivityManager::HandleFindSCP( T_ASC_Association *assoc, T_DIMSE_C_FindRQ *request, T_ASC_PresentationContextID presID )
+OFCondition WlmActivityManager::HandleFindSCP( T_ASC_Association *assoc, T_DIMSE_C_FindRQ *request, T_ASC_PresentationContextID presID, WlmDataSource *associationDataSource )
 // Date         : December 10, 2001
 // Author       : Thomas Wilkens
 // Task         : This function processes a DIMSE C-FIND-RQ command that was
@@ -830,12 +1001,13 @@ OFCondition WlmActivityManager::HandleFindSCP( T_ASC_Association *assoc, T_DIMSE
 //                request  - [in] The DIMSE C-FIND-RQ message that was received.
 //                presID   - [in] The ID of the presentation context which was specified in the PDV
 //                                which contained the DIMSE command.
+//                associationDataSource - [in] The data source to be used for this request, if not NULL.
 // Return Value : OFCondition value denoting success or error.
 {
   // Create callback data which needs to be passed to DIMSE_findProvider later.
   OFString temp_str;
   WlmFindContextType context;
-  context.dataSource = dataSource;
+  context.dataSource = ( associationDataSource != NULL ) ? associationDataSource : dataSource;
   context.priorStatus = WLM_PENDING;
   ASC_getAPTitles( assoc->params, context.theirAETitle, sizeof(context.theirAETitle), context.ourAETitle, sizeof(context.ourAETitle), NULL, 0);
   context.opt_sleepDuringFind = opt_sleepDuringFind;
@@ -0,0 +1,284 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: Class for an in-memory table of worklist items.
+ *
+ */
+
+// ----------------------------------------------------------------------------
+
+#include "dcmtk/config/osconfig.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmwlm/wltypdef.h"
+#include "dcmtk/dcmwlm/wlds.h"
+#include "dcmtk/dcmwlm/wlfsim.h"
+#include "dcmtk/dcmwlm/wlmemtab.h"
+
+// ----------------------------------------------------------------------------
+
+/* determine the position of the item with the given key in the sorted list of
+ * items, or the position where such an item would have to be inserted
+ */
+static OFBool WlmFindItem( const OFVector<WlmWorklistTable::Item>& items, const OFString& key, size_t& pos )
+{
+  size_t low = 0;
+  size_t high = items.size();
+  while( low < high )
+  {
+    const size_t mid = low + ( high - low ) / 2;
+    if( items[mid].GetKey() < key )
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  pos = low;
+  return ( pos < items.size() ) && ( items[pos].GetKey() == key );
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistTable::Item::Item()
+: key()
+, revision( 0 )
+, dataset()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistTable::Transaction::Transaction()
+: changes()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistTable::Transaction::InsertItem( const OFString& key, const DcmDataset& dataset )
+{
+  Change change;
+  change.type = Change::INSERT_ITEM;
+  change.key = key;
+  change.dataset.reset( new DcmDataset( dataset ) );
+  changes.push_back( change );
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistTable::Transaction::UpdateItem( const OFString& key, const DcmDataset& dataset )
+{
+  Change change;
+  change.type = Change::UPDATE_ITEM;
+  change.key = key;
+  change.dataset.reset( new DcmDataset( dataset ) );
+  changes.push_back( change );
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistTable::Transaction::DeleteItem( const OFString& key )
+{
+  Change change;
+  change.type = Change::DELETE_ITEM;
+  change.key = key;
+  changes.push_back( change );
+}
+
+// ----------------------------------------------------------------------------
+
+size_t WlmWorklistTable::Transaction::GetNumberOfChanges() const
+{
+  return changes.size();
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistTable::Transaction::Clear()
+{
+  changes.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistTable::WlmWorklistTable()
+: writeMutex()
+, snapshotMutex()
+, copyMutex()
+, current( new OFVector<Item>() )
+, lastRevision( 0 )
+, enableRejectionOfIncompleteItems( OFTrue )
+{
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistTable::~WlmWorklistTable()
+{
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistTable::SetEnableRejectionOfIncompleteItems( OFBool value )
+{
+  writeMutex.lock();
+  enableRejectionOfIncompleteItems = value;
+  writeMutex.unlock();
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmWorklistTable::InsertItem( const OFString& key, const DcmDataset& dataset )
+{
+  Transaction transaction;
+  transaction.InsertItem( key, dataset );
+  return Commit( transaction );
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmWorklistTable::UpdateItem( const OFString& key, const DcmDataset& dataset )
+{
+  Transaction transaction;
+  transaction.UpdateItem( key, dataset );
+  return Commit( transaction );
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmWorklistTable::DeleteItem( const OFString& key )
+{
+  Transaction transaction;
+  transaction.DeleteItem( key );
+  return Commit( transaction );
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmWorklistTable::Apply( OFVector<Item>& items, Transaction::Change& change )
+{
+  size_t pos;
+  const OFBool found = WlmFindItem( items, change.key, pos );
+  if( change.type == Transaction::Change::DELETE_ITEM )
+  {
+    if( !found )
+      return WLM_EC_WorklistItemNotFound;
+    items.erase( items.begin() + pos );
+    return EC_Normal;
+  }
+  if( change.type == Transaction::Change::INSERT_ITEM && found )
+    return WLM_EC_WorklistItemAlreadyExists;
+  if( change.type == Transaction::Change::UPDATE_ITEM && !found )
+    return WLM_EC_WorklistItemNotFound;
+  // the dataset of the change is not shared yet, so it may still be modified
+  if( enableRejectionOfIncompleteItems && !WlmFileSystemInteractionManager::DatasetIsComplete( change.dataset.get() ) )
+  {
+    DCMWLM_WARN( "Worklist item " << change.key << " is incomplete, item will be rejected" );
+    return WLM_EC_IncompleteWorklistItem;
+  }
+  Item item;
+  item.key = change.key;
+  item.revision = ++lastRevision;
+  item.dataset = change.dataset;
+  if( found )
+    items[pos] = item;
+  else
+    items.insert( items.begin() + pos, item );
+  return EC_Normal;
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmWorklistTable::Commit( Transaction& transaction )
+{
+  OFCondition cond = EC_Normal;
+  writeMutex.lock();
+  // only this thread creates new states, so the current one can be read without a lock
+  OFVector<Item> *items = new OFVector<Item>( *current );
+  const Uint64 revision = lastRevision;
+  for( size_t i = 0; ( i < transaction.changes.size() ) && cond.good(); i++ )
+    cond = Apply( *items, transaction.changes[i] );
+  if( cond.good() )
+  {
+    Snapshot snapshot( items );
+    snapshotMutex.lock();
+    current = snapshot;
+    snapshotMutex.unlock();
+    transaction.Clear();
+  }
+  else
+  {
+    delete items;
+    lastRevision = revision;
+  }
+  writeMutex.unlock();
+  return cond;
+}
+
+// ----------------------------------------------------------------------------
+
+void WlmWorklistTable::Clear()
+{
+  Snapshot snapshot( new OFVector<Item>() );
+  // the old state is released outside of the locks
+  Snapshot previous;
+  writeMutex.lock();
+  snapshotMutex.lock();
+  previous = current;
+  current = snapshot;
+  snapshotMutex.unlock();
+  writeMutex.unlock();
+}
+
+// ----------------------------------------------------------------------------
+
+size_t WlmWorklistTable::GetNumberOfItems() const
+{
+  return GetSnapshot()->size();
+}
+
+// ----------------------------------------------------------------------------
+
+OFCondition WlmWorklistTable::GetItem( const OFString& key, DcmDataset& dataset ) const
+{
+  Snapshot snapshot = GetSnapshot();
+  size_t pos;
+  if( !WlmFindItem( *snapshot, key, pos ) )
+    return WLM_EC_WorklistItemNotFound;
+  copyMutex.lock();
+  dataset = *(*snapshot)[pos].dataset;
+  copyMutex.unlock();
+  return EC_Normal;
+}
+
+// ----------------------------------------------------------------------------
+
+WlmWorklistTable::Snapshot WlmWorklistTable::GetSnapshot() const
+{
+  snapshotMutex.lock();
+  Snapshot snapshot = current;
+  snapshotMutex.unlock();
+  return snapshot;
+}
+
+// ----------------------------------------------------------------------------
+
+DcmDataset *WlmWorklistTable::CopyDataset( const Item& item ) const
+{
+  copyMutex.lock();
+  DcmDataset *dataset = new DcmDataset( *item.dataset );
+  copyMutex.unlock();
+  return dataset;
+}
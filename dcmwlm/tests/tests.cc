@@ -0,0 +1,32 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: main test program
+ *
+ */
+
+#include "dcmtk/config/osconfig.h"
+
+#include "dcmtk/ofstd/oftest.h"
+
+OFTEST_REGISTER(dcmwlm_worklist_table_insert_existing);
+OFTEST_REGISTER(dcmwlm_worklist_table_missing_key);
+OFTEST_REGISTER(dcmwlm_worklist_table_incomplete_item);
+OFTEST_REGISTER(dcmwlm_worklist_table_commit_rollback);
+OFTEST_REGISTER(dcmwlm_worklist_cache_refresh);
+
+OFTEST_MAIN("dcmwlm")
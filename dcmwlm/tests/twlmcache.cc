@@ -0,0 +1,136 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class WlmWorklistCache
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/ofstd/ofstd.h"
+#include "dcmtk/ofstd/offilsys.h"
+#include "dcmtk/dcmdata/dcfilefo.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmwlm/wlcache.h"
+
+#define WORKLIST_DIR "dcmwlm_test_wl"
+
+
+/** delete all files of the worklist directory and the directory itself
+ */
+static void removeWorklistDirectory()
+{
+    OFVector<OFString> files;
+    for (OFdirectory_iterator it(WORKLIST_DIR); it != OFdirectory_iterator(); ++it)
+        files.push_back(it->path().native());
+    for (size_t i = 0; i < files.size(); ++i)
+        OFStandard::deleteFile(files[i]);
+    /* removes the (now empty) directory on most systems */
+    remove(WORKLIST_DIR);
+}
+
+
+/** write a worklist file to the worklist directory
+ *  @param filename name of the file
+ *  @param patientID value of the patient ID
+ */
+static void writeFile(const char *filename, const char *patientID)
+{
+    OFString path;
+    OFStandard::combineDirAndFilename(path, WORKLIST_DIR, filename);
+    DcmFileFormat fileformat;
+    DcmDataset *dataset = fileformat.getDataset();
+    DcmItem *sps = NULL;
+    OFCHECK(dataset->findOrCreateSequenceItem(DCM_ScheduledProcedureStepSequence, sps).good());
+    if (sps != NULL)
+    {
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledStationAETitle, "MODALITY").good());
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledProcedureStepStartDate, "20260101").good());
+        OFCHECK(sps->putAndInsertString(DCM_Modality, "CT").good());
+    }
+    OFCHECK(dataset->putAndInsertString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(dataset->putAndInsertString(DCM_PatientID, patientID).good());
+    OFCHECK(fileformat.saveFile(path, EXS_LittleEndianExplicit).good());
+}
+
+
+/** determine the candidates for a query by patient ID
+ *  @param cache the worklist cache
+ *  @param patientID value of the patient ID
+ *  @return patient IDs of the candidates that match the query
+ */
+static OFString findPatient(WlmWorklistCache& cache, const char *patientID)
+{
+    DcmDataset searchMask;
+    OFCHECK(searchMask.putAndInsertString(DCM_PatientID, patientID).good());
+    OFVector<WlmWorklistCache::Entry*> candidates;
+    cache.DetermineCandidates(searchMask, candidates);
+    OFString result;
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        OFString value;
+        if (candidates[i]->dataset)
+            candidates[i]->dataset->findAndGetOFString(DCM_PatientID, value);
+        // the index only selects candidates, the values still have to be compared
+        if (value == patientID)
+            result += value + "|";
+    }
+    return result;
+}
+
+
+OFTEST(dcmwlm_worklist_cache_refresh)
+{
+    removeWorklistDirectory();
+    OFCHECK(OFStandard::createDirectory(WORKLIST_DIR, "").good());
+    writeFile("a.wl", "P1");
+    writeFile("b.wl", "P2");
+    writeFile("c.txt", "P9");
+
+    // only files with extension .wl are read
+    WlmWorklistCache cache(WORKLIST_DIR);
+    OFCHECK_EQUAL(cache.Refresh(), 2);
+    OFCHECK_EQUAL(cache.GetNumberOfEntries(), 2);
+    OFCHECK_EQUAL(findPatient(cache, "P1"), "P1|");
+    OFCHECK_EQUAL(findPatient(cache, "P2"), "P2|");
+    OFCHECK_EQUAL(findPatient(cache, "P9"), "");
+
+    // modify a file without changing its size, usually in the same second
+    writeFile("a.wl", "P3");
+    cache.Refresh();
+    OFCHECK_EQUAL(cache.GetNumberOfEntries(), 2);
+    OFCHECK_EQUAL(findPatient(cache, "P1"), "");
+    OFCHECK_EQUAL(findPatient(cache, "P3"), "P3|");
+
+    // remove a file and add another one
+    OFCHECK(OFStandard::deleteFile(WORKLIST_DIR "/b.wl"));
+    writeFile("d.wl", "P4");
+    cache.Refresh();
+    OFCHECK_EQUAL(cache.GetNumberOfEntries(), 2);
+    OFCHECK_EQUAL(findPatient(cache, "P2"), "");
+    OFCHECK_EQUAL(findPatient(cache, "P3"), "P3|");
+    OFCHECK_EQUAL(findPatient(cache, "P4"), "P4|");
+
+    // files are not read again once their modification time is in the past
+    OFStandard::forceSleep(2);
+    cache.Refresh();
+    OFCHECK_EQUAL(cache.Refresh(), 0);
+    OFCHECK_EQUAL(findPatient(cache, "P3"), "P3|");
+    removeWorklistDirectory();
+}
@@ -0,0 +1,179 @@
+/*
+ *
+ *  Copyright (C) 2026, OFFIS e.V.
+ *  All rights reserved.  See COPYRIGHT file for details.
+ *
+ *  This software and supporting documentation were developed by
+ *
+ *    OFFIS e.V.
+ *    R&D Division Health
+ *    Escherweg 2
+ *    D-26121 Oldenburg, Germany
+ *
+ *
+ *  Module:  dcmwlm
+ *
+ *  Author:  DCMTK team
+ *
+ *  Purpose: test program for class WlmWorklistTable
+ *
+ */
+
+
+#include "dcmtk/config/osconfig.h"    /* make sure OS specific configuration is included first */
+
+#include "dcmtk/ofstd/oftest.h"
+#include "dcmtk/dcmdata/dcdatset.h"
+#include "dcmtk/dcmdata/dcdeftag.h"
+#include "dcmtk/dcmwlm/wlds.h"
+#include "dcmtk/dcmwlm/wlmemtab.h"
+
+
+/** create a worklist item that contains all return type 1 attributes
+ *  @param dataset dataset receiving the attributes
+ *  @param patientID value of the patient ID
+ */
+static void createItem(DcmDataset& dataset, const char *patientID)
+{
+    DcmItem *sps = NULL;
+    OFCHECK(dataset.findOrCreateSequenceItem(DCM_ScheduledProcedureStepSequence, sps).good());
+    if (sps != NULL)
+    {
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledStationAETitle, "MODALITY").good());
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledProcedureStepStartDate, "20260101").good());
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledProcedureStepStartTime, "120000").good());
+        OFCHECK(sps->putAndInsertString(DCM_Modality, "CT").good());
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledProcedureStepID, "SPS1").good());
+        OFCHECK(sps->putAndInsertString(DCM_ScheduledProcedureStepDescription, "Scan").good());
+    }
+    OFCHECK(dataset.putAndInsertString(DCM_RequestedProcedureID, "RP1").good());
+    OFCHECK(dataset.putAndInsertString(DCM_RequestedProcedureDescription, "Procedure").good());
+    OFCHECK(dataset.putAndInsertString(DCM_StudyInstanceUID, "1.2.276.0.7230010.3.1.2.0.1").good());
+    OFCHECK(dataset.putAndInsertString(DCM_PatientName, "Doe^John").good());
+    OFCHECK(dataset.putAndInsertString(DCM_PatientID, patientID).good());
+}
+
+
+/** get the patient ID of an item of the table
+ *  @param table the worklist table
+ *  @param key key of the item
+ *  @return patient ID, empty if the item does not exist
+ */
+static OFString getPatientID(const WlmWorklistTable& table, const OFString& key)
+{
+    OFString patientID;
+    DcmDataset dataset;
+    if (table.GetItem(key, dataset).good())
+        dataset.findAndGetOFString(DCM_PatientID, patientID);
+    return patientID;
+}
+
+
+OFTEST(dcmwlm_worklist_table_insert_existing)
+{
+    WlmWorklistTable table;
+    DcmDataset first, second;
+    createItem(first, "P1");
+    createItem(second, "P2");
+    OFCHECK(table.InsertItem("A", first).good());
+    // inserting an item with the same key fails and keeps the existing item
+    OFCHECK(table.InsertItem("A", second) == WLM_EC_WorklistItemAlreadyExists);
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 1);
+    OFCHECK_EQUAL(getPatientID(table, "A"), "P1");
+    // a transaction must not insert the same key twice either
+    WlmWorklistTable::Transaction transaction;
+    transaction.InsertItem("B", first);
+    transaction.InsertItem("B", second);
+    OFCHECK(table.Commit(transaction) == WLM_EC_WorklistItemAlreadyExists);
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 1);
+}
+
+
+OFTEST(dcmwlm_worklist_table_missing_key)
+{
+    WlmWorklistTable table;
+    DcmDataset dataset;
+    createItem(dataset, "P1");
+    OFCHECK(table.UpdateItem("A", dataset) == WLM_EC_WorklistItemNotFound);
+    OFCHECK(table.DeleteItem("A") == WLM_EC_WorklistItemNotFound);
+    OFCHECK(table.GetItem("A", dataset) == WLM_EC_WorklistItemNotFound);
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 0);
+    // an item deleted by a transaction cannot be updated afterwards
+    OFCHECK(table.InsertItem("A", dataset).good());
+    WlmWorklistTable::Transaction transaction;
+    transaction.DeleteItem("A");
+    transaction.UpdateItem("A", dataset);
+    OFCHECK(table.Commit(transaction) == WLM_EC_WorklistItemNotFound);
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 1);
+    OFCHECK(table.DeleteItem("A").good());
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 0);
+}
+
+
+OFTEST(dcmwlm_worklist_table_incomplete_item)
+{
+    WlmWorklistTable table;
+    DcmDataset complete, incomplete;
+    createItem(complete, "P1");
+    createItem(incomplete, "P2");
+    OFCHECK(incomplete.findAndDeleteElement(DCM_PatientID).good());
+    OFCHECK(table.InsertItem("A", incomplete) == WLM_EC_IncompleteWorklistItem);
+    OFCHECK(table.InsertItem("A", complete).good());
+    OFCHECK(table.UpdateItem("A", incomplete) == WLM_EC_IncompleteWorklistItem);
+    OFCHECK_EQUAL(getPatientID(table, "A"), "P1");
+    // the check can be disabled
+    table.SetEnableRejectionOfIncompleteItems(OFFalse);
+    OFCHECK(table.UpdateItem("A", incomplete).good());
+    OFCHECK_EQUAL(getPatientID(table, "A"), "");
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 1);
+}
+
+
+OFTEST(dcmwlm_worklist_table_commit_rollback)
+{
+    WlmWorklistTable table;
+    DcmDataset first, second;
+    createItem(first, "P1");
+    createItem(second, "P2");
+    OFCHECK(table.InsertItem("A", first).good());
+    const WlmWorklistTable::Snapshot before = table.GetSnapshot();
+    OFCHECK_EQUAL(before->size(), 1);
+    const Uint64 revision = (*before)[0].GetRevision();
+
+    // the last change fails, so none of the changes is applied
+    WlmWorklistTable::Transaction transaction;
+    transaction.InsertItem("B", second);
+    transaction.UpdateItem("A", second);
+    transaction.DeleteItem("C");
+    OFCHECK(table.Commit(transaction) == WLM_EC_WorklistItemNotFound);
+    OFCHECK_EQUAL(transaction.GetNumberOfChanges(), 3);
+    OFCHECK_EQUAL(table.GetNumberOfItems(), 1);
+    OFCHECK_EQUAL(getPatientID(table, "A"), "P1");
+    OFCHECK_EQUAL((*table.GetSnapshot())[0].GetRevision(), revision);
+
+    // the revisions assigned by the failed transaction are handed out again
+    OFCHECK(table.UpdateItem("A", second).good());
+    const WlmWorklistTable::Snapshot after = table.GetSnapshot();
+    OFCHECK_EQUAL((*after)[0].GetRevision(), revision + 1);
+
+    // a successful transaction is cleared, earlier snapshots are not affected
+    transaction.Clear();
+    transaction.InsertItem("C", first);
+    transaction.InsertItem("B", second);
+    OFCHECK(table.Commit(transaction).good());
+    OFCHECK_EQUAL(transaction.GetNumberOfChanges(), 0);
+    const WlmWorklistTable::Snapshot last = table.GetSnapshot();
+    OFCHECK_EQUAL(last->size(), 3);
+    // items are sorted by key
+    OFCHECK_EQUAL((*last)[0].GetKey(), "A");
+    OFCHECK_EQUAL((*last)[1].GetKey(), "B");
+    OFCHECK_EQUAL((*last)[2].GetKey(), "C");
+    OFCHECK_EQUAL((*last)[2].GetRevision(), revision + 2);
+    OFCHECK_EQUAL((*last)[1].GetRevision(), revision + 3);
+    OFCHECK_EQUAL(before->size(), 1);
+    OFCHECK_EQUAL(after->size(), 1);
+    OFunique_ptr<DcmDataset> copy(table.CopyDataset((*before)[0]));
+    OFString patientID;
+    OFCHECK(copy->findAndGetOFString(DCM_PatientID, patientID).good());
+    OFCHECK_EQUAL(patientID, "P1");
+}